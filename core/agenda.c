@@ -38,6 +38,7 @@
 
 #include <stdio.h>
 #define _STDIO_INCLUDED_
+#include <stdlib.h>
 #include <string.h>
 
 #include "setup.h"
@@ -54,6 +55,7 @@
 #include "moduldef.h"
 #include "modulutl.h"
 #include "multifld.h"
+#include "prntutil.h"
 #include "reteutil.h"
 #include "retract.h"
 #include "router.h"
@@ -74,8 +76,10 @@
    static char                   *SalienceEvaluationName(int);
    static int                     EvaluateSalience(void *,EXEC_STATUS,void *);
    static struct salienceGroup   *ReuseOrCreateSalienceGroup(void *,EXEC_STATUS,struct defruleModule *,int);
-   static struct salienceGroup   *FindSalienceGroup(struct defruleModule *,int);
    static void                    RemoveActivationFromGroup(void *,EXEC_STATUS,struct activation *,struct defruleModule *);
+   static void                    ScheduleActivation(void *,EXEC_STATUS,struct activation *);
+   static void                    QueuePendingActivation(void *,EXEC_STATUS,struct activation *);
+   static void                    UnqueuePendingActivation(void *,EXEC_STATUS,struct activation *);
    
 /*************************************************/
 /* InitializeAgenda: Initializes the activations */
@@ -87,10 +91,19 @@ globle void InitializeAgenda(
   EXEC_STATUS)
   {   
    AllocateEnvironmentData(theEnv,execStatus,AGENDA_DATA,sizeof(struct agendaData),NULL);
+
+   if (apr_thread_mutex_create(&AgendaData(theEnv,execStatus)->lock,APR_THREAD_MUTEX_NESTED,
+                               Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+     {
+      SystemError(theEnv,execStatus,"AGENDA",2);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
    
    AgendaData(theEnv,execStatus)->SalienceEvaluation = WHEN_DEFINED;
 
    AgendaData(theEnv,execStatus)->Strategy = DEFAULT_STRATEGY;
+
+   AgendaData(theEnv,execStatus)->LazyAgenda = FALSE;
    
    EnvAddClearFunction(theEnv,execStatus,"agenda",AgendaClearFunction,0);
 #if DEBUGGING_FUNCTIONS
@@ -108,6 +121,10 @@ globle void InitializeAgenda(
                    PTIEF SetSalienceEvaluationCommand,
                    "SetSalienceEvaluationCommand",
                    "11w");
+   EnvDefineFunction2(theEnv,execStatus,"get-lazy-agenda",'b',
+                   PTIEF GetLazyAgendaCommand,"GetLazyAgendaCommand","00");
+   EnvDefineFunction2(theEnv,execStatus,"set-lazy-agenda",'b',
+                   PTIEF SetLazyAgendaCommand,"SetLazyAgendaCommand","11");
 
 #if DEBUGGING_FUNCTIONS
    EnvDefineFunction2(theEnv,execStatus,"agenda", 'v', PTIEF AgendaCommand, "AgendaCommand", "01w");
@@ -131,8 +148,8 @@ globle void AddActivation(
    struct activation *newActivation;
    struct defrule *theRule = (struct defrule *) vTheRule;
    struct partialMatch *binds = (struct partialMatch *) vBinds;
-   struct defruleModule *theModuleItem;
-   struct salienceGroup *theGroup;
+
+   apr_thread_mutex_lock(AgendaData(theEnv,execStatus)->lock);
 
    /*=======================================*/
    /* Focus on the module if the activation */
@@ -144,21 +161,24 @@ globle void AddActivation(
 
    /*=======================================================*/
    /* Create the activation. The activation stores pointers */
-   /* to its associated partial match and defrule. The      */
-   /* activation is given a time tag, its salience is       */
-   /* evaluated, and it is assigned a random number for use */
-   /* with the random conflict resolution strategy.         */
+   /* to its associated partial match and defrule and is    */
+   /* given a time tag.                                     */
    /*=======================================================*/
 
    newActivation = get_struct(theEnv,execStatus,activation);
    newActivation->theRule = theRule;
    newActivation->basis = binds;
    newActivation->timetag = AgendaData(theEnv,execStatus)->CurrentTimetag++;
-   newActivation->salience = EvaluateSalience(theEnv,execStatus,theRule);
-
+   newActivation->salience = theRule->salience;
    newActivation->randomID = genrand();
    newActivation->prev = NULL;
    newActivation->next = NULL;
+   newActivation->group = NULL;
+   newActivation->sortedTimetags = NULL;
+   newActivation->timetagCount = 0;
+   newActivation->indexLevel = 0;
+   newActivation->indexLinks = NULL;
+   newActivation->pending = FALSE;
 
    AgendaData(theEnv,execStatus)->NumberOfActivations++;
 
@@ -170,28 +190,167 @@ globle void AddActivation(
    binds->marker = (void *) newActivation;
 
    /*====================================================*/
-   /* If activations are being watch, display a message. */
+   /* In lazy agenda mode, the activation waits on its   */
+   /* rule until the agenda of the rule's module is      */
+   /* needed, unless something must be done as soon as   */
+   /* the rule is activated.                             */
    /*====================================================*/
 
+   if (AgendaData(theEnv,execStatus)->LazyAgenda &&
+       (! theRule->autoFocus) &&
 #if DEBUGGING_FUNCTIONS
-   if (newActivation->theRule->watchActivation)
+       (! theRule->watchActivation) &&
+#endif
+       (theRule->dynamicSalience == NULL))
+     { QueuePendingActivation(theEnv,execStatus,newActivation); }
+   else
      {
-      EnvPrintRouter(theEnv,execStatus,WTRACE,"==> Activation ");
-      PrintActivation(theEnv,execStatus,WTRACE,(void *) newActivation);
-      EnvPrintRouter(theEnv,execStatus,WTRACE,"\n");
-     }
+      ScheduleActivation(theEnv,execStatus,newActivation);
+
+      /*====================================================*/
+      /* If activations are being watch, display a message. */
+      /*====================================================*/
+
+#if DEBUGGING_FUNCTIONS
+      if (newActivation->theRule->watchActivation)
+        {
+         EnvPrintRouter(theEnv,execStatus,WTRACE,"==> Activation ");
+         PrintActivation(theEnv,execStatus,WTRACE,(void *) newActivation);
+         EnvPrintRouter(theEnv,execStatus,WTRACE,"\n");
+        }
 #endif
+     }
 
-    /*=====================================*/
-    /* Place the activation on the agenda. */
-    /*=====================================*/
+   apr_thread_mutex_unlock(AgendaData(theEnv,execStatus)->lock);
+  }
 
-    theModuleItem = (struct defruleModule *) theRule->header.whichModule;
+/*************************************************************/
+/* ScheduleActivation: Evaluates the salience of an          */
+/*   activation and places it on the agenda of its rule's    */
+/*   module. The random number used with the random conflict */
+/*   resolution strategy is assigned when the activation is  */
+/*   created, so that a lazy agenda draws the same numbers.  */
+/*************************************************************/
+static void ScheduleActivation(
+  void *theEnv,
+  EXEC_STATUS,
+  struct activation *theActivation)
+  {
+   struct defruleModule *theModuleItem;
+   struct salienceGroup *theGroup;
+
+   theActivation->salience = EvaluateSalience(theEnv,execStatus,theActivation->theRule);
+
+   /*=====================================*/
+   /* Place the activation on the agenda. */
+   /*=====================================*/
+
+   theModuleItem = (struct defruleModule *) theActivation->theRule->header.whichModule;
     
-    theGroup = ReuseOrCreateSalienceGroup(theEnv,execStatus,theModuleItem,newActivation->salience);
+   theGroup = ReuseOrCreateSalienceGroup(theEnv,execStatus,theModuleItem,theActivation->salience);
     
-    PlaceActivation(theEnv,execStatus,&(theModuleItem->agenda),newActivation,theGroup);
-   }
+   PlaceActivation(theEnv,execStatus,&(theModuleItem->agenda),theActivation,theGroup);
+  }
+
+/*************************************************************/
+/* QueuePendingActivation: Adds an activation to the pending */
+/*   activations of its rule. The rule is linked to its      */
+/*   module when it has no other pending activations.        */
+/*************************************************************/
+static void QueuePendingActivation(
+  void *theEnv,
+  EXEC_STATUS,
+  struct activation *theActivation)
+  {
+   struct defrule *theRule = theActivation->theRule;
+   struct defruleModule *theModuleItem;
+
+   theActivation->pending = TRUE;
+   theActivation->next = theRule->pendingActivations;
+   if (theActivation->next != NULL)
+     { theActivation->next->prev = theActivation; }
+   theRule->pendingActivations = theActivation;
+
+   if (theActivation->next == NULL)
+     {
+      theModuleItem = (struct defruleModule *) theRule->header.whichModule;
+      theRule->prevPending = NULL;
+      theRule->nextPending = theModuleItem->pendingRules;
+      if (theRule->nextPending != NULL)
+        { theRule->nextPending->prevPending = theRule; }
+      theModuleItem->pendingRules = theRule;
+     }
+
+   AgendaData(theEnv,execStatus)->AgendaChanged = TRUE;
+  }
+
+/****************************************************************/
+/* UnqueuePendingActivation: Removes an activation from the     */
+/*   pending activations of its rule. The rule is unlinked from */
+/*   its module when it has no pending activations left.        */
+/****************************************************************/
+static void UnqueuePendingActivation(
+  void *theEnv,
+  EXEC_STATUS,
+  struct activation *theActivation)
+  {
+   struct defrule *theRule = theActivation->theRule;
+   struct defruleModule *theModuleItem;
+
+   if (theActivation->prev == NULL)
+     { theRule->pendingActivations = theActivation->next; }
+   else
+     { theActivation->prev->next = theActivation->next; }
+
+   if (theActivation->next != NULL)
+     { theActivation->next->prev = theActivation->prev; }
+
+   theActivation->prev = NULL;
+   theActivation->next = NULL;
+   theActivation->pending = FALSE;
+
+   if (theRule->pendingActivations == NULL)
+     {
+      theModuleItem = (struct defruleModule *) theRule->header.whichModule;
+      if (theRule->prevPending == NULL)
+        { theModuleItem->pendingRules = theRule->nextPending; }
+      else
+        { theRule->prevPending->nextPending = theRule->nextPending; }
+
+      if (theRule->nextPending != NULL)
+        { theRule->nextPending->prevPending = theRule->prevPending; }
+
+      theRule->prevPending = NULL;
+      theRule->nextPending = NULL;
+     }
+
+   AgendaData(theEnv,execStatus)->AgendaChanged = TRUE;
+  }
+
+/******************************************************************/
+/* MaterializeActivations: Places the pending activations of the  */
+/*   rules of a module on the module's agenda. Called before the  */
+/*   agenda is used to select the next activation to fire or is   */
+/*   examined.                                                    */
+/******************************************************************/
+globle void MaterializeActivations(
+  void *theEnv,
+  EXEC_STATUS,
+  struct defruleModule *theModuleItem)
+  {
+   struct activation *theActivation;
+
+   apr_thread_mutex_lock(AgendaData(theEnv,execStatus)->lock);
+
+   while (theModuleItem->pendingRules != NULL)
+     {
+      theActivation = theModuleItem->pendingRules->pendingActivations;
+      UnqueuePendingActivation(theEnv,execStatus,theActivation);
+      ScheduleActivation(theEnv,execStatus,theActivation);
+     }
+
+   apr_thread_mutex_unlock(AgendaData(theEnv,execStatus)->lock);
+  }
 
 /***************************************************************/
 /* ReuseOrCreateSalienceGroup: */
@@ -203,6 +362,7 @@ static struct salienceGroup *ReuseOrCreateSalienceGroup(
   int salience)
   {
    struct salienceGroup *theGroup, *lastGroup, *newGroup;
+   int i;
    
    for (lastGroup = NULL, theGroup = theRuleModule->groupings;
         theGroup != NULL;
@@ -219,6 +379,8 @@ static struct salienceGroup *ReuseOrCreateSalienceGroup(
    newGroup->salience = salience;
    newGroup->first = NULL;
    newGroup->last = NULL;
+   for (i = 0; i < AGENDA_INDEX_LEVELS; i++)
+     { newGroup->index[i] = NULL; }
    newGroup->next = theGroup;
    newGroup->prev = lastGroup;
    
@@ -234,29 +396,6 @@ static struct salienceGroup *ReuseOrCreateSalienceGroup(
    return newGroup;
   }
 
-/***************************************************************/
-/* FindSalienceGroup: */
-/***************************************************************/
-static struct salienceGroup *FindSalienceGroup(
-  struct defruleModule *theRuleModule,
-  int salience)
-  {
-   struct salienceGroup *theGroup;
-   
-   for (theGroup = theRuleModule->groupings;
-        theGroup != NULL;
-        theGroup = theGroup->next)
-     {
-      if (theGroup->salience == salience)
-        { return(theGroup); }
-        
-      if (theGroup->salience < salience)
-        { break; }
-     }
-     
-   return NULL;
-  }
-  
 /***************************************************************/
 /* ClearRuleFromAgenda: Clears the agenda of a specified rule. */
 /***************************************************************/
@@ -269,6 +408,19 @@ globle void ClearRuleFromAgenda(
    struct defrule *tempRule;
    struct activation *agendaPtr, *agendaNext;
 
+   /*===============================================*/
+   /* Remove the pending activations of each of the */
+   /* disjuncts of the rule.                        */
+   /*===============================================*/
+
+   for (tempRule = theRule;
+        tempRule != NULL;
+        tempRule = tempRule->disjunct)
+     {
+      while (tempRule->pendingActivations != NULL)
+        { RemoveActivation(theEnv,execStatus,tempRule->pendingActivations,TRUE,TRUE); }
+     }
+
    /*============================================*/
    /* Get a pointer to the agenda for the module */
    /* in which the rule is contained.            */
@@ -322,6 +474,7 @@ globle void *EnvGetNextActivation(
      {
       theModuleItem = (struct defruleModule *) GetModuleItem(theEnv,execStatus,NULL,DefruleData(theEnv,execStatus)->DefruleModuleIndex);
       if (theModuleItem == NULL) return(NULL);
+      MaterializeActivations(theEnv,execStatus,theModuleItem);
       return((void *) theModuleItem->agenda);
      }
    else
@@ -431,6 +584,13 @@ globle intBool MoveActivationToTop(
 
    if (theActivation == theModuleItem->agenda) return(FALSE);
 
+   /*=================================================*/
+   /* The activation no longer belongs to its group's */
+   /* place in the agenda, so it leaves the group.    */
+   /*=================================================*/
+
+   RemoveActivationFromGroup(theEnv,execStatus,theActivation,theModuleItem);
+
    /*=================================================*/
    /* Update the pointers of the activation preceding */
    /* and following the activation being moved.       */
@@ -500,6 +660,8 @@ globle intBool DetachActivation(
 
    theModuleItem = (struct defruleModule *) theActivation->theRule->header.whichModule;
 
+   apr_thread_mutex_lock(AgendaData(theEnv,execStatus)->lock);
+
    RemoveActivationFromGroup(theEnv,execStatus,theActivation,theModuleItem);
 
    /*========================================================*/
@@ -537,6 +699,8 @@ globle intBool DetachActivation(
 
    AgendaData(theEnv,execStatus)->AgendaChanged = TRUE;
 
+   apr_thread_mutex_unlock(AgendaData(theEnv,execStatus)->lock);
+
    return(TRUE);
   }
 
@@ -598,28 +762,40 @@ globle void RemoveActivation(
 
    theModuleItem = (struct defruleModule *) theActivation->theRule->header.whichModule;
 
+   apr_thread_mutex_lock(AgendaData(theEnv,execStatus)->lock);
+
    /*=================================*/
    /* Update the agenda if necessary. */
    /*=================================*/
 
    if (updateAgenda == TRUE)
      {
-      RemoveActivationFromGroup(theEnv,execStatus,theActivation,theModuleItem);
-
       /*===============================================*/
-      /* Update the pointer links between activations. */
+      /* A pending activation is only removed from its */
+      /* rule's pending activations.                   */
       /*===============================================*/
 
-      if (theActivation->prev == NULL)
-        {
-         theModuleItem->agenda = theModuleItem->agenda->next;
-         if (theModuleItem->agenda != NULL) theModuleItem->agenda->prev = NULL;
-        }
+      if (theActivation->pending)
+        { UnqueuePendingActivation(theEnv,execStatus,theActivation); }
       else
         {
-         theActivation->prev->next = theActivation->next;
-         if (theActivation->next != NULL)
-           { theActivation->next->prev = theActivation->prev; }
+         RemoveActivationFromGroup(theEnv,execStatus,theActivation,theModuleItem);
+
+         /*===============================================*/
+         /* Update the pointer links between activations. */
+         /*===============================================*/
+
+         if (theActivation->prev == NULL)
+           {
+            theModuleItem->agenda = theModuleItem->agenda->next;
+            if (theModuleItem->agenda != NULL) theModuleItem->agenda->prev = NULL;
+           }
+         else
+           {
+            theActivation->prev->next = theActivation->next;
+            if (theActivation->next != NULL)
+              { theActivation->next->prev = theActivation->prev; }
+           }
         }
 
       /*===================================*/
@@ -656,7 +832,10 @@ globle void RemoveActivation(
 
    AgendaData(theEnv,execStatus)->NumberOfActivations--;
 
+   ReturnActivationIndex(theEnv,execStatus,theActivation);
    rtn_struct(theEnv,execStatus,activation,theActivation);
+
+   apr_thread_mutex_unlock(AgendaData(theEnv,execStatus)->lock);
   }
 
 /**************************************************************/
@@ -670,8 +849,10 @@ static void RemoveActivationFromGroup(
   {
    struct salienceGroup *theGroup;
    
-   theGroup = FindSalienceGroup(theRuleModule,theActivation->salience);
+   theGroup = theActivation->group;
    if (theGroup == NULL) return;
+
+   UnindexActivation(theActivation);
    
    if (theActivation == theGroup->first)
      {
@@ -742,6 +923,10 @@ globle void RemoveAllActivations(
   {
    struct activation *tempPtr, *theActivation;
    struct salienceGroup *theGroup, *tempGroup;
+   struct defrule *theRule;
+
+   while ((theRule = GetDefruleModuleItem(theEnv,execStatus,NULL)->pendingRules) != NULL)
+     { RemoveActivation(theEnv,execStatus,theRule->pendingActivations,TRUE,TRUE); }
 
    theActivation = GetDefruleModuleItem(theEnv,execStatus,NULL)->agenda;
    while (theActivation != NULL)
@@ -933,6 +1118,8 @@ globle intBool EnvRefresh(
       /* satisfies the LHS of the rule. */
       /*================================*/
 
+      CompleteBetaMemoryResize(theEnv,execStatus,rulePtr->lastJoin);
+
       for (b = 0; b < rulePtr->lastJoin->leftMemory->size; b++)
         {
          for (listOfMatches = rulePtr->lastJoin->leftMemory->beta[b];
@@ -1218,6 +1405,94 @@ globle intBool EnvSetSalienceEvaluation(
    return(ov);
   }
 
+/**************************************/
+/* EnvGetLazyAgenda: C access routine */
+/*   for the get-lazy-agenda command. */
+/**************************************/
+globle intBool EnvGetLazyAgenda(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(AgendaData(theEnv,execStatus)->LazyAgenda);
+  }
+
+/**************************************************/
+/* EnvSetLazyAgenda: C access routine for the     */
+/*   set-lazy-agenda command. When lazy agenda    */
+/*   mode is turned off, the pending activations  */
+/*   of every module are placed on its agenda.    */
+/**************************************************/
+globle intBool EnvSetLazyAgenda(
+  void *theEnv,
+  EXEC_STATUS,
+  intBool value)
+  {
+   intBool ov;
+   struct defmodule *theModule;
+
+   ov = AgendaData(theEnv,execStatus)->LazyAgenda;
+   AgendaData(theEnv,execStatus)->LazyAgenda = value;
+
+   if (value == FALSE)
+     {
+      for (theModule = (struct defmodule *) EnvGetNextDefmodule(theEnv,execStatus,NULL);
+           theModule != NULL;
+           theModule = (struct defmodule *) EnvGetNextDefmodule(theEnv,execStatus,theModule))
+        { MaterializeActivations(theEnv,execStatus,GetDefruleModuleItem(theEnv,execStatus,theModule)); }
+     }
+
+   return(ov);
+  }
+
+/***********************************************/
+/* SetLazyAgendaCommand: H/L access routine    */
+/*   for the set-lazy-agenda command.          */
+/***********************************************/
+globle int SetLazyAgendaCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   int oldValue;
+   DATA_OBJECT theValue;
+
+   oldValue = EnvGetLazyAgenda(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"set-lazy-agenda",EXACTLY,1) == -1)
+     { return(oldValue); }
+
+   EnvRtnUnknown(theEnv,execStatus,1,&theValue);
+
+   /*=========================================================*/
+   /* If the argument evaluated to FALSE, activations are     */
+   /* placed on the agenda as soon as rules are activated.    */
+   /*=========================================================*/
+
+   if ((theValue.value == EnvFalseSymbol(theEnv,execStatus)) && (theValue.type == SYMBOL))
+     { EnvSetLazyAgenda(theEnv,execStatus,FALSE); }
+   else
+     { EnvSetLazyAgenda(theEnv,execStatus,TRUE); }
+
+   return(oldValue);
+  }
+
+/***********************************************/
+/* GetLazyAgendaCommand: H/L access routine    */
+/*   for the get-lazy-agenda command.          */
+/***********************************************/
+globle int GetLazyAgendaCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   int currentValue;
+
+   currentValue = EnvGetLazyAgenda(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"get-lazy-agenda",EXACTLY,0) == -1)
+     { return(currentValue); }
+
+   return(currentValue);
+  }
+
 /*****************************************************************/
 /* EvaluateSalience: Returns the salience value of the specified */
 /*   defrule. If salience evaluation is currently set to         */
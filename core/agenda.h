@@ -47,6 +47,8 @@
 #include "match.h"
 #endif
 
+# include <apr_thread_mutex.h>
+
 #define WHEN_DEFINED 0
 #define WHEN_ACTIVATED 1
 #define EVERY_CYCLE 2
@@ -58,6 +60,20 @@
 /* DATA STRUCTURES */
 /*******************/
 
+/*==========================================================*/
+/* Besides being linked into the agenda, the activations of */
+/* a salience group are kept in a skiplist ordered by the   */
+/* current conflict resolution strategy, so that the place  */
+/* of a new activation is found without walking the group.  */
+/* An activation's links hold its successor at each of its  */
+/* levels followed by its predecessor at each of them (NULL */
+/* when it is the group's index itself). The timetags of    */
+/* its partial match, sorted in descending order, are kept  */
+/* for the lex and mea strategies.                          */
+/*==========================================================*/
+
+#define AGENDA_INDEX_LEVELS 12
+
 struct activation
   {
    struct defrule *theRule;
@@ -67,6 +83,12 @@ struct activation
    int randomID;
    struct activation *prev;
    struct activation *next;
+   struct salienceGroup *group;
+   unsigned long long *sortedTimetags;
+   unsigned short timetagCount;
+   unsigned short indexLevel;
+   struct activation **indexLinks;
+   unsigned int pending : 1;
   };
 
 struct salienceGroup
@@ -76,14 +98,24 @@ struct salienceGroup
    struct activation *last;
    struct salienceGroup *next;
    struct salienceGroup *prev;
+   int indexLevel;
+   struct activation *index[AGENDA_INDEX_LEVELS];
   };
 
 typedef struct activation ACTIVATION;
 
 #define AGENDA_DATA 17
 
+/*==========================================================*/
+/* The agenda lock is held while activations are added or   */
+/* removed, since the matcher workers activate rules        */
+/* concurrently. It is nested: watched activations and      */
+/* auto-focus rules call back into the agenda.              */
+/*==========================================================*/
+
 struct agendaData
   { 
+   apr_thread_mutex_t *lock;
 #if DEBUGGING_FUNCTIONS
    unsigned WatchActivations;
 #endif
@@ -92,6 +124,7 @@ struct agendaData
    int AgendaChanged;
    intBool SalienceEvaluation;
    int Strategy;
+   intBool LazyAgenda;
   };
 
 #define EnvGetActivationSalience(theEnv,execStatus,actPtr) (((struct activation *) actPtr)->salience)
@@ -119,6 +152,7 @@ struct agendaData
 #define GetActivationPPForm(a,b,c) EnvGetActivationPPForm(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b,c)
 #define GetActivationSalience(actPtr) (((struct activation *) actPtr)->salience)
 #define GetAgendaChanged() EnvGetAgendaChanged(GetCurrentEnvironment(),GetCurrentExecutionStatus())
+#define GetLazyAgenda() EnvGetLazyAgenda(GetCurrentEnvironment(),GetCurrentExecutionStatus())
 #define GetNextActivation(a) EnvGetNextActivation(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define GetSalienceEvaluation() EnvGetSalienceEvaluation(GetCurrentEnvironment(),GetCurrentExecutionStatus())
 #define Refresh(a) EnvRefresh(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
@@ -126,6 +160,7 @@ struct agendaData
 #define ReorderAgenda(a) EnvReorderAgenda(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define SetActivationSalience(a,b) EnvSetActivationSalience(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b)
 #define SetAgendaChanged(a) EnvSetAgendaChanged(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
+#define SetLazyAgenda(a) EnvSetLazyAgenda(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define SetSalienceEvaluation(a) EnvSetSalienceEvaluation(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 
    LOCALE void                    AddActivation               (void *,EXEC_STATUS,void *,void *);
@@ -154,6 +189,11 @@ struct agendaData
    LOCALE void                    RefreshAgendaCommand        (void *,EXEC_STATUS);
    LOCALE void                    RefreshCommand              (void *,EXEC_STATUS);
    LOCALE intBool                 EnvRefresh                  (void *,EXEC_STATUS,void *);
+   LOCALE void                    MaterializeActivations      (void *,EXEC_STATUS,struct defruleModule *);
+   LOCALE intBool                 EnvGetLazyAgenda            (void *,EXEC_STATUS);
+   LOCALE intBool                 EnvSetLazyAgenda            (void *,EXEC_STATUS,intBool);
+   LOCALE int                     GetLazyAgendaCommand        (void *,EXEC_STATUS);
+   LOCALE int                     SetLazyAgendaCommand        (void *,EXEC_STATUS);
 #if DEBUGGING_FUNCTIONS
    LOCALE void                    AgendaCommand               (void *,EXEC_STATUS);
 #endif
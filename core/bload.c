@@ -63,7 +63,7 @@ globle void InitializeBloadData(
    AddEnvironmentCleanupFunction(theEnv,execStatus,"bload",DeallocateBloadData,-1500);
 
    BloadData(theEnv,execStatus)->BinaryPrefixID = "\1\2\3\4CLIPS";
-   BloadData(theEnv,execStatus)->BinaryVersionID = "V6.30";
+   BloadData(theEnv,execStatus)->BinaryVersionID = "V6.31";
   }
   
 /************************************************/
@@ -390,6 +390,20 @@ globle void BloadandRefresh(
 
    if (objcnt == 0L) return;
 
+   /*===================================================*/
+   /* If the binary file is memory mapped, refresh the  */
+   /* objects from the records in the file, which saves */
+   /* allocating a buffer and copying them into it.     */
+   /*===================================================*/
+
+   buf = (char *) GenReadBinaryInPlace(theEnv,execStatus,objcnt * objsz,BinaryRecordAlignment(objsz));
+   if (buf != NULL)
+     {
+      for (i = 0L ; i < objcnt ; i++)
+        (*objupdate)(theEnv,execStatus,buf + objsz * i,i);
+      return;
+     }
+
    oldOutOfMemoryFunction = EnvSetOutOfMemoryFunction(theEnv,execStatus,BloadOutOfMemoryFunction);
    objsmaxread = objcnt;
    do
@@ -442,6 +456,7 @@ static struct FunctionDefinition **ReadNeededFunctions(
    long i;
    struct FunctionDefinition **newFunctionArray, *functionPtr;
    int functionsNotFound = 0;
+   intBool bufferAllocated = FALSE;
 
    /*===================================================*/
    /* Determine the number of function names to be read */
@@ -456,12 +471,19 @@ static struct FunctionDefinition **ReadNeededFunctions(
       return(NULL);
      }
 
-   /*=======================================*/
-   /* Allocate area for strings to be read. */
-   /*=======================================*/
+   /*=============================================*/
+   /* Use the names in place if the binary file   */
+   /* is memory mapped, otherwise allocate an     */
+   /* area for them and read them.                */
+   /*=============================================*/
 
-   functionNames = (char *) genalloc(theEnv,execStatus,space);
-   GenReadBinary(theEnv,execStatus,(void *) functionNames,space);
+   functionNames = (char *) GenReadBinaryInPlace(theEnv,execStatus,space,1);
+   if (functionNames == NULL)
+     {
+      functionNames = (char *) genalloc(theEnv,execStatus,space);
+      GenReadBinary(theEnv,execStatus,(void *) functionNames,space);
+      bufferAllocated = TRUE;
+     }
 
    /*====================================================*/
    /* Store the function pointers in the function array. */
@@ -496,7 +518,8 @@ static struct FunctionDefinition **ReadNeededFunctions(
    /* Free the memory used by the name buffer. */
    /*==========================================*/
 
-   genfree(theEnv,execStatus,(void *) functionNames,space);
+   if (bufferAllocated)
+     { genfree(theEnv,execStatus,(void *) functionNames,space); }
 
    /*==================================================*/
    /* If any of the required functions were not found, */
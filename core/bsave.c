@@ -350,7 +350,7 @@ static void WriteNeededFunctions(
    /* needed for the function names. */
    /*================================*/
 
-   space = FunctionBinarySize(theEnv,execStatus);
+   space = BinaryAlignedSize(FunctionBinarySize(theEnv,execStatus));
    GenWrite(&space,(unsigned long) sizeof(unsigned long int),fp);
 
    /*===============================*/
@@ -367,6 +367,8 @@ static void WriteNeededFunctions(
          GenWrite(ValueToString(functionList->callFunctionName),(unsigned long) length,fp);
         }
      }
+
+   WriteBinaryPadding(fp,FunctionBinarySize(theEnv,execStatus));
   }
 
 /*********************************************/
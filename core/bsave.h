@@ -73,7 +73,24 @@ typedef struct bsave_expr
    long value,arg_list,next_arg;
   } BSAVE_EXPRESSION;
 
-#define CONSTRUCT_HEADER_SIZE 20
+/*=====================================================*/
+/* Construct headers and the variable length parts of  */
+/* a binary image (function names, symbol text and     */
+/* bitmaps) take a multiple of BINARY_ALIGNMENT bytes. */
+/* The records following them then start at an aligned */
+/* offset and can be used in place when the image is   */
+/* memory mapped by bload.                             */
+/*=====================================================*/
+
+#define BINARY_ALIGNMENT sizeof(double)
+
+#define CONSTRUCT_HEADER_SIZE 24
+
+#define BinaryAlignedSize(size) \
+   (((size) + BINARY_ALIGNMENT - 1) & ~((size_t) BINARY_ALIGNMENT - 1))
+
+#define BinaryRecordAlignment(size) \
+   ((((size) & (~(size) + 1)) > BINARY_ALIGNMENT) ? BINARY_ALIGNMENT : ((size) & (~(size) + 1)))
 
 #define BSAVE_DATA 39
 
@@ -508,6 +508,7 @@ globle DEFCLASS *NewClass(
    cls->nxtHash = NULL;
    cls->scopeMap = NULL;
    ClearBitString(cls->traversalRecord,TRAVERSAL_BYTES);
+   cls->slotIndexList = NULL;
    return(cls);
   }
   
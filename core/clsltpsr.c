@@ -92,6 +92,11 @@
 #define OVERRIDE_MSG_FACET    "override-message"
 #define SLOT_DEFAULT_RLN      "DEFAULT"
 
+#define INDEX_FACET           "index"
+#define SLOT_NO_INDEX_RLN     "none"
+#define SLOT_HASH_INDEX_RLN   "hash"
+#define SLOT_ORDER_INDEX_RLN  "ordered"
+
 #define STORAGE_BIT           0
 #define FIELD_BIT             1
 #define ACCESS_BIT            2
@@ -103,6 +108,7 @@
 #define VISIBILITY_BIT        8
 #define CREATE_ACCESSOR_BIT   9
 #define OVERRIDE_MSG_BIT      10
+#define INDEX_BIT             11
 
 /* =========================================
    *****************************************
@@ -304,6 +310,18 @@ globle TEMP_SLOT_LINK *ParseSlot(
            }
          slot->overrideMessageSpecified = TRUE;
         }
+#if DEFCLASS_SLOT_INDEXES
+      else if (strcmp(DOToString(DefclassData(theEnv,execStatus)->ObjectParseToken),INDEX_FACET) == 0)
+        {
+         rtnCode = ParseSimpleFacet(theEnv,execStatus,readSource,specbits,INDEX_FACET,INDEX_BIT,
+                                    SLOT_NO_INDEX_RLN,SLOT_HASH_INDEX_RLN,SLOT_ORDER_INDEX_RLN,
+                                    NULL,NULL);
+         if (rtnCode == -1)
+           goto ParseSlotError;
+         slot->indexed = (rtnCode != 0) ? 1 : 0;
+         slot->orderedIndex = (rtnCode == 2) ? 1 : 0;
+        }
+#endif
       else if (StandardConstraint(DOToString(DefclassData(theEnv,execStatus)->ObjectParseToken)))
         {
          if (ParseStandardConstraint(theEnv,execStatus,readSource,DOToString(DefclassData(theEnv,execStatus)->ObjectParseToken),
@@ -433,6 +451,8 @@ static SLOT_DESC *NewSlot(
    slot->createReadAccessor = FALSE;
    slot->createWriteAccessor = FALSE;
    slot->overrideMessageSpecified = 0;
+   slot->indexed = 0;
+   slot->orderedIndex = 0;
    slot->cls = NULL;
    slot->defaultValue = NULL;
    slot->constraint = GetConstraintRecord(theEnv,execStatus);
@@ -492,7 +512,8 @@ static TEMP_SLOT_LINK *InsertSlot(
   NAME         : ParseSimpleFacet
   DESCRIPTION  : Parses the following facets for a slot:
                    access, source, propagation, storage,
-                   pattern-match, visibility and override-message
+                   pattern-match, visibility, override-message
+                   and index
   INPUTS       : 1) The input logical name
                  2) The bitmap indicating which facets have
                     already been parsed
@@ -742,6 +763,11 @@ static void BuildCompositeFacets(
          IncrementSymbolCount(sd->overrideMessage);
          sd->overrideMessageSpecified = TRUE;
         }
+      if (TestBitMap(specbits,INDEX_BIT) == 0)
+        {
+         sd->indexed = compslot->indexed;
+         sd->orderedIndex = compslot->orderedIndex;
+        }
       OverlayConstraint(theEnv,execStatus,parsedConstraint,sd->constraint,compslot->constraint);
      }
   }
@@ -800,6 +826,12 @@ static intBool CheckForFacetConflicts(
       EnvPrintRouter(theEnv,execStatus,WERROR,"no-inherit slots cannot also be public\n");
       return(FALSE);
      }
+   if (sd->indexed && (sd->multiple || sd->shared))
+     {
+      PrintErrorID(theEnv,execStatus,"CLSLTPSR",7,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"only local single-field slots can be indexed\n");
+      return(FALSE);
+     }
    return(TRUE);
   }
 
@@ -56,24 +56,29 @@
 #define GetMatchingItem(x,i) ((x->basis->binds[i].gm.theMatch != NULL) ? \
                               (x->basis->binds[i].gm.theMatch->matchingItem) : NULL)
 
+#define IndexNext(theGroup,actPtr,level) (((actPtr) == NULL) ? \
+                                          (theGroup)->index[level] : (actPtr)->indexLinks[level])
+#define IndexPrev(actPtr,level) ((actPtr)->indexLinks[(actPtr)->indexLevel + (level)])
+
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
 
-   static ACTIVATION             *PlaceDepthActivation(ACTIVATION *,struct salienceGroup *);
-   static ACTIVATION             *PlaceBreadthActivation(ACTIVATION *,struct salienceGroup *);
-   static ACTIVATION             *PlaceLEXActivation(void *,EXEC_STATUS,ACTIVATION *,struct salienceGroup *);
-   static ACTIVATION             *PlaceMEAActivation(void *,EXEC_STATUS,ACTIVATION *,struct salienceGroup *);
-   static ACTIVATION             *PlaceComplexityActivation(ACTIVATION *,struct salienceGroup *);
-   static ACTIVATION             *PlaceSimplicityActivation(ACTIVATION *,struct salienceGroup *);
-   static ACTIVATION             *PlaceRandomActivation(ACTIVATION *,struct salienceGroup *);
-   static int                     ComparePartialMatches(void *,EXEC_STATUS,ACTIVATION *,ACTIVATION *);
+   static int                     ActivationPrecedes(int,ACTIVATION *,ACTIVATION *);
+   static unsigned long long      MEAKey(ACTIVATION *);
+   static int                     ComparePartialMatches(ACTIVATION *,ACTIVATION *);
+   static unsigned short          ChooseIndexLevel(unsigned long long);
    static char                   *GetStrategyName(int);
    static unsigned long long     *SortPartialMatch(void *,EXEC_STATUS,struct partialMatch *);
    
 /******************************************************************/
 /* PlaceActivation: Coordinates placement of an activation on the */
 /*   Agenda based on the current conflict resolution strategy.    */
+/*   The activation is inserted into the index of its salience    */
+/*   group after the activations which the strategy orders before */
+/*   it, and then into the agenda after the one preceding it in   */
+/*   the index (or after the last activation of the previous      */
+/*   group if it is first in its group).                          */
 /******************************************************************/
 globle void PlaceActivation(
   void *theEnv,
@@ -82,7 +87,9 @@ globle void PlaceActivation(
   ACTIVATION *newActivation,
   struct salienceGroup *theGroup)
   {
-   ACTIVATION *placeAfter = NULL;
+   ACTIVATION *placeAfter, *actPtr;
+   ACTIVATION *preceding[AGENDA_INDEX_LEVELS];
+   int strategy, level;
 
    /*================================================*/
    /* Set the flag which indicates that a change has */
@@ -91,51 +98,89 @@ globle void PlaceActivation(
 
    EnvSetAgendaChanged(theEnv,execStatus,TRUE);
 
-   /*=============================================*/
-   /* Determine the location where the activation */
-   /* should be placed in the agenda based on the */
-   /* current conflict resolution strategy.       */
-   /*==============================================*/
+   /*=================================================*/
+   /* Compute the sorted timetags used by the lex and */
+   /* mea strategies and the links of the activation  */
+   /* in the index the first time it is placed.       */
+   /*=================================================*/
 
-   if (*whichAgenda != NULL) 
+   strategy = AgendaData(theEnv,execStatus)->Strategy;
+
+   if (((strategy == LEX_STRATEGY) || (strategy == MEA_STRATEGY)) &&
+       (newActivation->sortedTimetags == NULL))
      {
-      switch (AgendaData(theEnv,execStatus)->Strategy)
-        {
-         case DEPTH_STRATEGY:
-           placeAfter = PlaceDepthActivation(newActivation,theGroup);
-           break;
+      newActivation->timetagCount = newActivation->basis->bcount;
+      newActivation->sortedTimetags = SortPartialMatch(theEnv,execStatus,newActivation->basis);
+     }
 
-         case BREADTH_STRATEGY:
-           placeAfter = PlaceBreadthActivation(newActivation,theGroup);
-           break;
+   if (newActivation->indexLinks == NULL)
+     {
+      newActivation->indexLevel = ChooseIndexLevel(newActivation->timetag);
+      newActivation->indexLinks = (ACTIVATION **)
+         get_mem(theEnv,execStatus,sizeof(ACTIVATION *) * 2 * newActivation->indexLevel);
+     }
 
-         case LEX_STRATEGY:
-           placeAfter = PlaceLEXActivation(theEnv,execStatus,newActivation,theGroup);
-           break;
+   /*==========================================================*/
+   /* Find the activation preceding the new activation at each */
+   /* level of the index, starting from the sparsest level.    */
+   /* The activation is placed before activations of lower     */
+   /* salience and after activations of higher salience, so    */
+   /* only the activations of its group are searched.          */
+   /*==========================================================*/
 
-         case MEA_STRATEGY:
-           placeAfter = PlaceMEAActivation(theEnv,execStatus,newActivation,theGroup);
-           break;
+   actPtr = NULL;
+   for (level = AGENDA_INDEX_LEVELS - 1; level >= 0; level--)
+     {
+      while ((IndexNext(theGroup,actPtr,level) != NULL) &&
+             ActivationPrecedes(strategy,IndexNext(theGroup,actPtr,level),newActivation))
+        { actPtr = IndexNext(theGroup,actPtr,level); }
 
-         case COMPLEXITY_STRATEGY:
-           placeAfter = PlaceComplexityActivation(newActivation,theGroup);
-           break;
+      preceding[level] = actPtr;
+     }
 
-         case SIMPLICITY_STRATEGY:
-           placeAfter = PlaceSimplicityActivation(newActivation,theGroup);
-           break;
+   /*===========================================*/
+   /* Link the activation into the index at its */
+   /* own levels.                               */
+   /*===========================================*/
 
-         case RANDOM_STRATEGY:
-           placeAfter = PlaceRandomActivation(newActivation,theGroup);
-           break;
+   for (level = 0; level < (int) newActivation->indexLevel; level++)
+     {
+      if (preceding[level] == NULL)
+        {
+         newActivation->indexLinks[level] = theGroup->index[level];
+         theGroup->index[level] = newActivation;
+        }
+      else
+        {
+         newActivation->indexLinks[level] = preceding[level]->indexLinks[level];
+         preceding[level]->indexLinks[level] = newActivation;
         }
-     } 
+
+      IndexPrev(newActivation,level) = preceding[level];
+      if (newActivation->indexLinks[level] != NULL)
+        { IndexPrev(newActivation->indexLinks[level],level) = newActivation; }
+     }
+
+   newActivation->group = theGroup;
+
+   /*========================================*/
+   /* Update the salience group information. */
+   /*========================================*/
+
+   if (preceding[0] != NULL)
+     { placeAfter = preceding[0]; }
    else
      {
       theGroup->first = newActivation;
-      theGroup->last = newActivation;
+      if (theGroup->prev == NULL)
+        { placeAfter = NULL; }
+      else
+        { placeAfter = theGroup->prev->last; }
      }
 
+   if (newActivation->indexLinks[0] == NULL)
+     { theGroup->last = newActivation; }
+
    /*==============================================================*/
    /* Place the activation at the appropriate place in the agenda. */
    /*==============================================================*/
@@ -156,637 +201,206 @@ globle void PlaceActivation(
      }
   }
 
-/*******************************************************************/
-/* PlaceDepthActivation: Determines the location in the agenda     */
-/*    where a new activation should be placed for the depth        */
-/*    strategy. Returns a pointer to the activation after which    */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static ACTIVATION *PlaceDepthActivation(
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
+/***************************************************************/
+/* UnindexActivation: Removes an activation from the index of  */
+/*   its salience group. The first and last activations of the */
+/*   group are left for the caller to update.                  */
+/***************************************************************/
+globle void UnindexActivation(
+  ACTIVATION *theActivation)
   {
-   ACTIVATION *lastAct, *actPtr;
-   unsigned long long timetag;
-     
-   /*============================================*/
-   /* Set up initial information for the search. */
-   /*============================================*/
-
-   timetag = newActivation->timetag;
-   if (theGroup->prev == NULL)
-     { lastAct = NULL; }
-   else
-     { lastAct = theGroup->prev->last; }
+   struct salienceGroup *theGroup;
+   ACTIVATION *before, *after;
+   int level;
 
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the activation is placed before      */
-   /* activations with an equal or lower timetag (yielding    */
-   /* depth first traversal).                                 */
-   /*=========================================================*/
+   theGroup = theActivation->group;
+   if (theGroup == NULL) return;
 
-   actPtr = theGroup->first;
-   while (actPtr != NULL)
+   for (level = 0; level < (int) theActivation->indexLevel; level++)
      {
-      if (timetag < actPtr->timetag)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else
-        { break; }
-     }
-
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
-
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
+      before = IndexPrev(theActivation,level);
+      after = theActivation->indexLinks[level];
 
-   return(lastAct);
-  }
-
-/*******************************************************************/
-/* PlaceBreadthActivation: Determines the location in the agenda   */
-/*    where a new activation should be placed for the breadth      */
-/*    strategy. Returns a pointer to the activation after which    */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static ACTIVATION *PlaceBreadthActivation(
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
-  {
-   unsigned long long timetag;
-   ACTIVATION *lastAct, *actPtr;
-
-   /*============================================*/
-   /* Set up initial information for the search. */
-   /*============================================*/
-
-   timetag = newActivation->timetag;
-   if (theGroup->last == NULL)
-     {    
-      if (theGroup->prev == NULL)
-        { lastAct = NULL; }
+      if (before == NULL)
+        { theGroup->index[level] = after; }
       else
-        { lastAct = theGroup->prev->last; }
-     }
-   else
-     { lastAct = theGroup->last; }
-
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the activation is placed after       */
-   /* activations with a lessor timetag (yielding breadth     */
-   /* first traversal).                                       */
-   /*=========================================================*/
+        { before->indexLinks[level] = after; }
 
-   actPtr = theGroup->last;
-   while (actPtr != NULL)
-     {
-      if (timetag < actPtr->timetag)
-        {
-         if (actPtr == theGroup->first)
-           {
-            if (theGroup->prev == NULL)
-              { lastAct = NULL; }
-            else
-              { lastAct = theGroup->prev->last; }
-            break;
-           }
-         else 
-           { actPtr = actPtr->prev; }
-        }
-      else
-        {
-         lastAct = actPtr; 
-         break; 
-        }
+      if (after != NULL)
+        { IndexPrev(after,level) = before; }
      }
-     
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
-
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
 
-   return(lastAct);
+   theActivation->group = NULL;
   }
 
-/*******************************************************************/
-/* PlaceLEXActivation: Determines the location in the agenda       */
-/*    where a new activation should be placed for the lex          */
-/*    strategy. Returns a pointer to the activation after which    */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static ACTIVATION *PlaceLEXActivation(
+/*************************************************************/
+/* ReturnActivationIndex: Returns the index links and sorted */
+/*   timetags of an activation to the Memory Manager.        */
+/*************************************************************/
+globle void ReturnActivationIndex(
   void *theEnv,
   EXEC_STATUS,
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
+  ACTIVATION *theActivation)
   {
-   unsigned long long timetag;
-   ACTIVATION *lastAct, *actPtr;
-   int flag;
-
-   /*============================================*/
-   /* Set up initial information for the search. */
-   /*============================================*/
-
-   timetag = newActivation->timetag;
-   if (theGroup->prev == NULL)
-     { lastAct = NULL; }
-   else
-     { lastAct = theGroup->prev->last; }
-
-   /*================================================*/
-   /* Look first at the very end of the group to see */
-   /* if the activation should be placed there.      */
-   /*================================================*/
-   
-   actPtr = theGroup->last;
-   if (actPtr != NULL)
+   if (theActivation->sortedTimetags != NULL)
      {
-      flag = ComparePartialMatches(theEnv,execStatus,actPtr,newActivation);
-      
-      if ((flag == LESS_THAN) ||
-          ((flag == EQUAL) &&  (timetag > actPtr->timetag)))
-        {
-         theGroup->last = newActivation; 
-         
-         return(actPtr);
-        }
+      rtn_mem(theEnv,execStatus,sizeof(long long) * theActivation->timetagCount,
+              theActivation->sortedTimetags);
+      theActivation->sortedTimetags = NULL;
      }
-     
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the OPS5 lex strategy is used for    */
-   /* determining placement.                                  */
-   /*=========================================================*/
 
-   actPtr = theGroup->first;
-   while (actPtr != NULL)
+   if (theActivation->indexLinks != NULL)
      {
-      flag = ComparePartialMatches(theEnv,execStatus,actPtr,newActivation);
-
-      if (flag == LESS_THAN)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else if (flag == GREATER_THAN)
-        { break; }
-      else /* flag == EQUAL */
-        {
-         if (timetag > actPtr->timetag)
-           {
-            lastAct = actPtr;
-            if (actPtr == theGroup->last)
-              { break; }
-            else 
-              { actPtr = actPtr->next; }
-           }
-         else
-           { break; }
-        }
+      rtn_mem(theEnv,execStatus,sizeof(ACTIVATION *) * 2 * theActivation->indexLevel,
+              theActivation->indexLinks);
+      theActivation->indexLinks = NULL;
      }
-     
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
-
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
-
-   return(lastAct);
   }
 
-/*******************************************************************/
-/* PlaceMEAActivation: Determines the location in the agenda       */
-/*    where a new activation should be placed for the mea          */
-/*    strategy. Returns a pointer to the activation after which    */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static ACTIVATION *PlaceMEAActivation(
-  void *theEnv,
-  EXEC_STATUS,
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
+/*****************************************************************/
+/* ChooseIndexLevel: Returns the number of levels of the index   */
+/*   an activation is linked into. The levels are drawn from a   */
+/*   hash of the activation's timetag so that each level holds   */
+/*   about a quarter of the activations of the level below it    */
+/*   without drawing on the random number generator used by the  */
+/*   random strategy.                                            */
+/*****************************************************************/
+static unsigned short ChooseIndexLevel(
+  unsigned long long timetag)
   {
-   unsigned long long timetag;
-   ACTIVATION *lastAct, *actPtr;
-   int flag;
-   long long cWhoset = 0, oWhoset = 0;
-   intBool cSet, oSet;
+   unsigned long long bits;
+   unsigned short level = 1;
 
-   /*============================================*/
-   /* Set up initial information for the search. */
-   /*============================================*/
-
-   timetag = newActivation->timetag;
-   if (theGroup->prev == NULL)
-     { lastAct = NULL; }
-   else
-     { lastAct = theGroup->prev->last; }
+   bits = timetag + 0x9E3779B97F4A7C15ULL;
+   bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+   bits = bits ^ (bits >> 31);
 
-   /*================================================*/
-   /* Look first at the very end of the group to see */
-   /* if the activation should be placed there.      */
-   /*================================================*/
-   
-   actPtr = theGroup->last;
-   if (actPtr != NULL)
+   while (((bits & 3) == 0) && (level < AGENDA_INDEX_LEVELS))
      {
-      if (GetMatchingItem(newActivation,0) != NULL)
-        { 
-         cWhoset = GetMatchingItem(newActivation,0)->timeTag; 
-         cSet = TRUE;
-        }
-      else
-        { cSet = FALSE; }
-        
-      if (GetMatchingItem(actPtr,0) != NULL)
-        {
-         oWhoset = GetMatchingItem(actPtr,0)->timeTag; 
-         oSet = TRUE;
-        }
-      else
-        { oSet = FALSE; }
-        
-      if ((cSet == FALSE) && (oSet == FALSE))  
-        { flag = ComparePartialMatches(theEnv,execStatus,actPtr,newActivation); }
-      else if ((cSet == TRUE) && (oSet == FALSE))
-        { flag = GREATER_THAN; }
-      else if ((cSet == FALSE) && (oSet == TRUE))
-        { flag = LESS_THAN; }
-      else if (oWhoset < cWhoset)
-        { flag = GREATER_THAN; }
-      else if (oWhoset > cWhoset)
-        { flag = LESS_THAN; }
-      else
-        { flag = ComparePartialMatches(theEnv,execStatus,actPtr,newActivation); }
-
-      if ((flag == LESS_THAN) ||
-          ((flag == EQUAL) &&  (timetag > actPtr->timetag)))
-        {
-         theGroup->last = newActivation; 
-         
-         return(actPtr);
-        }
+      level++;
+      bits >>= 2;
      }
 
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the OPS5 mea strategy is used for    */
-   /* determining placement.                                  */
-   /*=========================================================*/
-
-   actPtr = theGroup->first;
-   while (actPtr != NULL)
-     {
-      cWhoset = -1;
-      oWhoset = -1;
-      if (GetMatchingItem(newActivation,0) != NULL)
-        { cWhoset = GetMatchingItem(newActivation,0)->timeTag; }
-        
-      if (GetMatchingItem(actPtr,0) != NULL)
-        { oWhoset = GetMatchingItem(actPtr,0)->timeTag; }
-        
-      if (oWhoset < cWhoset)
-        {
-         if (cWhoset > 0) flag = GREATER_THAN;
-         else flag = LESS_THAN;
-        }
-      else if (oWhoset > cWhoset)
-        {
-         if (oWhoset > 0) flag = LESS_THAN;
-         else flag = GREATER_THAN;
-        }
-      else
-        { flag = ComparePartialMatches(theEnv,execStatus,actPtr,newActivation); }
+   return(level);
+  }
 
-      if (flag == LESS_THAN)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else if (flag == GREATER_THAN)
-        { break; }
-      else /* flag == EQUAL */
-        {
-         if (timetag > actPtr->timetag)
-           {
-            lastAct = actPtr;
-            if (actPtr == theGroup->last)
-              { break; }
-            else 
-              { actPtr = actPtr->next; }
-           }
-         else
-           { break; }
-        }
-     }
-     
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
+/**************************************************************/
+/* ActivationPrecedes: Determines whether an activation of a  */
+/*   salience group is placed before a new activation of the  */
+/*   same group by the conflict resolution strategy. Among    */
+/*   activations which the strategy otherwise ranks equally,  */
+/*   the older activation is placed first (or the newer one   */
+/*   for the depth strategy).                                 */
+/**************************************************************/
+static int ActivationPrecedes(
+  int strategy,
+  ACTIVATION *actPtr,
+  ACTIVATION *newActivation)
+  {
+   unsigned long long actKey, newKey;
+   int flag;
 
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
+   switch (strategy)
+     {
+      /*=============================================*/
+      /* The depth strategy places newer activations */
+      /* first, the breadth strategy older ones.     */
+      /*=============================================*/
 
-   return(lastAct);
-  }
+      case DEPTH_STRATEGY:
+        return(actPtr->timetag > newActivation->timetag);
 
-/*********************************************************************/
-/* PlaceComplexityActivation: Determines the location in the agenda  */
-/*    where a new activation should be placed for the complexity     */
-/*    strategy. Returns a pointer to the activation  after which the */
-/*    new activation should be placed (or NULL if the activation     */
-/*    should be placed at the beginning of the agenda).              */
-/*********************************************************************/
-static ACTIVATION *PlaceComplexityActivation(
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
-  {
-   int complexity;
-   unsigned long long timetag;
-   ACTIVATION *lastAct, *actPtr;
+      case BREADTH_STRATEGY:
+        return(actPtr->timetag < newActivation->timetag);
 
-   /*========================================*/
-   /* Set up initial information for search. */
-   /*========================================*/
+      /*=====================================================*/
+      /* The lex strategy compares the sorted timetags. The  */
+      /* mea strategy first compares the timetags of the     */
+      /* facts or instances matching the first pattern.      */
+      /*=====================================================*/
 
-   timetag = newActivation->timetag;
-   complexity = newActivation->theRule->complexity;
-   if (theGroup->prev == NULL)
-     { lastAct = NULL; }
-   else
-     { lastAct = theGroup->prev->last; }
+      case LEX_STRATEGY:
+        flag = ComparePartialMatches(actPtr,newActivation);
+        break;
 
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the activation is placed before      */
-   /* activations of equal or lessor complexity.              */
-   /*=========================================================*/
+      case MEA_STRATEGY:
+        actKey = MEAKey(actPtr);
+        newKey = MEAKey(newActivation);
+        if (actKey != newKey)
+          { return(actKey > newKey); }
+        flag = ComparePartialMatches(actPtr,newActivation);
+        break;
 
-   actPtr = theGroup->first;
-   while (actPtr != NULL)
-     {
-      if (complexity < (int) actPtr->theRule->complexity)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else if (complexity > (int) actPtr->theRule->complexity)
-        { break; }
-      else if (timetag > actPtr->timetag)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else
-        { break; }
-     }
-     
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
+      /*=========================================*/
+      /* The complexity strategy places the      */
+      /* activations of more complex rules first */
+      /* and the simplicity strategy those of    */
+      /* simpler rules.                          */
+      /*=========================================*/
 
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
+      case COMPLEXITY_STRATEGY:
+        if (actPtr->theRule->complexity != newActivation->theRule->complexity)
+          { return((int) actPtr->theRule->complexity > (int) newActivation->theRule->complexity); }
+        flag = EQUAL;
+        break;
 
-   return(lastAct);
-  }
+      case SIMPLICITY_STRATEGY:
+        if (actPtr->theRule->complexity != newActivation->theRule->complexity)
+          { return((int) actPtr->theRule->complexity < (int) newActivation->theRule->complexity); }
+        flag = EQUAL;
+        break;
 
-/*********************************************************************/
-/* PlaceSimplicityActivation: Determines the location in the agenda  */
-/*    where a new activation should be placed for the simplicity     */
-/*    strategy. Returns a pointer to the activation  after which the */
-/*    new activation should be placed (or NULL if the activation     */
-/*    should be placed at the beginning of the agenda).              */
-/*********************************************************************/
-static ACTIVATION *PlaceSimplicityActivation(
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
-  {
-   int complexity;
-   unsigned long long timetag;
-   ACTIVATION *lastAct, *actPtr;
-
-   /*============================================*/
-   /* Set up initial information for the search. */
-   /*============================================*/
-
-   timetag = newActivation->timetag;
-   complexity = newActivation->theRule->complexity;
-   if (theGroup->prev == NULL)
-     { lastAct = NULL; }
-   else
-     { lastAct = theGroup->prev->last; }
+      /*=========================================*/
+      /* The random strategy places activations  */
+      /* by the random number each was assigned. */
+      /*=========================================*/
 
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the activation is placed after       */
-   /* activations of equal or greater complexity.             */
-   /*=========================================================*/
+      case RANDOM_STRATEGY:
+        if (actPtr->randomID != newActivation->randomID)
+          { return(actPtr->randomID < newActivation->randomID); }
+        flag = EQUAL;
+        break;
 
-   actPtr = theGroup->first;
-   while (actPtr != NULL)
-     {
-      if (complexity > (int) actPtr->theRule->complexity)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else if (complexity < (int) actPtr->theRule->complexity)
-        { break; }
-      else if (timetag > actPtr->timetag)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else
-       { break; }
+      default:
+        flag = EQUAL;
+        break;
      }
-     
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
 
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
+   if (flag == EQUAL)
+     { return(actPtr->timetag < newActivation->timetag); }
 
-   return(lastAct);
+   return(flag == LESS_THAN);
   }
 
-/*******************************************************************/
-/* PlaceRandomActivation: Determines the location in the agenda    */
-/*    where a new activation should be placed for the random       */
-/*    strategy. Returns a pointer to the activation  after which   */
-/*    the new activation should be placed (or NULL if the          */
-/*    activation should be placed at the beginning of the agenda). */
-/*******************************************************************/
-static ACTIVATION *PlaceRandomActivation(
-  ACTIVATION *newActivation,
-  struct salienceGroup *theGroup)
+/***************************************************************/
+/* MEAKey: Returns the value by which the mea strategy orders  */
+/*   an activation before comparing its sorted timetags. The   */
+/*   activation whose first pattern is matched by the newer    */
+/*   fact or instance has the larger value. An activation      */
+/*   whose first pattern is unmatched ranks after those with a */
+/*   matching fact or instance but before those whose matching */
+/*   fact or instance has a zero timetag.                      */
+/***************************************************************/
+static unsigned long long MEAKey(
+  ACTIVATION *theActivation)
   {
-   int randomID;
-   unsigned long long timetag;
-   ACTIVATION *lastAct, *actPtr;
-
-   /*============================================*/
-   /* Set up initial information for the search. */
-   /*============================================*/
-
-   timetag = newActivation->timetag;
-   randomID = newActivation->randomID;
-   if (theGroup->prev == NULL)
-     { lastAct = NULL; }
-   else
-     { lastAct = theGroup->prev->last; }
+   struct patternEntity *theItem;
 
-   /*=========================================================*/
-   /* Find the insertion point in the agenda. The activation  */
-   /* is placed before activations of lower salience and      */
-   /* after activations of higher salience. Among activations */
-   /* of equal salience, the placement of the activation is   */
-   /* determined through the generation of a random number.   */
-   /*=========================================================*/
+   theItem = GetMatchingItem(theActivation,0);
 
-   actPtr = theGroup->first;
-   while (actPtr != NULL)
-     {
-      if (randomID > actPtr->randomID)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else if (randomID < actPtr->randomID)
-       { break; }
-      else if (timetag > actPtr->timetag)
-        {
-         lastAct = actPtr;
-         if (actPtr == theGroup->last)
-           { break; }
-         else 
-           { actPtr = actPtr->next; }
-        }
-      else
-       { break; }
-     }
-     
-   /*========================================*/
-   /* Update the salience group information. */
-   /*========================================*/
-   
-   if ((lastAct == NULL) || 
-       ((theGroup->prev != NULL) && (theGroup->prev->last == lastAct)))
-     { theGroup->first = newActivation; }
-     
-   if ((theGroup->last == NULL) || (theGroup->last == lastAct))
-     { theGroup->last = newActivation; }
+   if (theItem == NULL)
+     { return(1); }
 
-   /*===========================================*/
-   /* Return the insertion point in the agenda. */
-   /*===========================================*/
+   if (theItem->timeTag == 0)
+     { return(0); }
 
-   return(lastAct);
+   return(theItem->timeTag + 1);
   }
 
 /*********************************************************/
 /* SortPartialMatch: Creates an array of sorted timetags */
-/*    in ascending order from a partial match.           */
+/*    in descending order from a partial match.          */
 /*********************************************************/
 static unsigned long long *SortPartialMatch(
   void *theEnv,
@@ -795,9 +409,11 @@ static unsigned long long *SortPartialMatch(
   {
    unsigned long long *nbinds;
    unsigned long long temp;
-   int flag;
    unsigned j, k;
 
+   if (binds->bcount == 0)
+     { return(NULL); }
+
    /*====================================================*/
    /* Copy the array. Use 0 to represent the timetags of */
    /* negated patterns. Patterns matching fact/instances */
@@ -819,21 +435,12 @@ static unsigned long long *SortPartialMatch(
    /* Sort the array. */
    /*=================*/
 
-   for (flag = TRUE, k = binds->bcount - 1;
-        flag == TRUE;
-        k--)
+   for (j = 1; j < (unsigned) binds->bcount; j++)
      {
-      flag = FALSE;
-      for (j = 0 ; j < k ; j++)
-        {
-         if (nbinds[j] < nbinds[j + 1])
-           {
-            temp = nbinds[j];
-            nbinds[j] = nbinds[j+1];
-            nbinds[j+1] = temp;
-            flag = TRUE;
-           }
-        }
+      temp = nbinds[j];
+      for (k = j; (k > 0) && (nbinds[k - 1] < temp); k--)
+        { nbinds[k] = nbinds[k - 1]; }
+      nbinds[k] = temp;
      }
 
    /*===================*/
@@ -847,33 +454,27 @@ static unsigned long long *SortPartialMatch(
 /* ComparePartialMatches: Compares two activations using the lex conflict */
 /*   resolution strategy to determine which activation should be placed   */
 /*   first on the agenda. This lexicographic comparison function is used  */
-/*   for both the lex and mea strategies.                                 */
+/*   for both the lex and mea strategies. Returns LESS_THAN if the new    */
+/*   activation is placed after the activation already on the agenda.     */
 /**************************************************************************/
 static int ComparePartialMatches(
-  void *theEnv,
-  EXEC_STATUS,
   ACTIVATION *actPtr,
   ACTIVATION *newActivation)
   {
    int cCount, oCount, mCount, i;
    unsigned long long *basis1, *basis2;
 
-   /*=================================================*/
-   /* If the activation already on the agenda doesn't */
-   /* have a set of sorted timetags, then create one. */
-   /*=================================================*/
-
-   basis1 = SortPartialMatch(theEnv,execStatus,newActivation->basis);
-   basis2 = SortPartialMatch(theEnv,execStatus,actPtr->basis);
-   
    /*==============================================================*/
    /* Determine the number of timetags in each of the activations. */
    /* The number of timetags to be compared is the lessor of these */
    /* two numbers.                                                 */
    /*==============================================================*/
 
-   cCount = newActivation->basis->bcount;
-   oCount = actPtr->basis->bcount;
+   basis1 = newActivation->sortedTimetags;
+   basis2 = actPtr->sortedTimetags;
+
+   cCount = newActivation->timetagCount;
+   oCount = actPtr->timetagCount;
  
    if (oCount > cCount) mCount = cCount;
    else mCount = oCount;
@@ -889,21 +490,10 @@ static int ComparePartialMatches(
    for (i = 0 ; i < mCount ; i++)
      {
       if (basis1[i] < basis2[i])
-        { 
-         rtn_mem(theEnv,execStatus,sizeof(long long) * cCount,basis1);
-         rtn_mem(theEnv,execStatus,sizeof(long long) * oCount,basis2);
-         return(LESS_THAN); 
-        }
+        { return(LESS_THAN); }
       else if (basis1[i] > basis2[i])
-        { 
-         rtn_mem(theEnv,execStatus,sizeof(long long) * cCount,basis1);
-         rtn_mem(theEnv,execStatus,sizeof(long long) * oCount,basis2);
-         return(GREATER_THAN); 
-        }
+        { return(GREATER_THAN); }
      }
-  
-   rtn_mem(theEnv,execStatus,sizeof(long long) * cCount,basis1);
-   rtn_mem(theEnv,execStatus,sizeof(long long) * oCount,basis2);
 
    /*==========================================================*/
    /* If the sorted timetags are identical up to the number of */
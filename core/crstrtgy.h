@@ -62,6 +62,8 @@
 #define SetStrategy(a) EnvSetStrategy(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 
    LOCALE void                           PlaceActivation(void *,EXEC_STATUS,ACTIVATION **,ACTIVATION *,struct salienceGroup *);
+   LOCALE void                           UnindexActivation(ACTIVATION *);
+   LOCALE void                           ReturnActivationIndex(void *,EXEC_STATUS,ACTIVATION *);
    LOCALE int                            EnvSetStrategy(void *,EXEC_STATUS,int);
    LOCALE int                            EnvGetStrategy(void *,EXEC_STATUS);
    LOCALE void                          *SetStrategyCommand(void *,EXEC_STATUS);
@@ -123,11 +123,11 @@ globle void PrimitiveTablesInfo(
   void *theEnv,
   EXEC_STATUS)
   {
-   unsigned long i;
-   SYMBOL_HN **symbolArray, *symbolPtr;
-   FLOAT_HN **floatArray, *floatPtr;
-   INTEGER_HN **integerArray, *integerPtr;
-   BITMAP_HN **bitMapArray, *bitMapPtr;
+   unsigned long i, tableSize;
+   SYMBOL_HN **symbolArray;
+   FLOAT_HN **floatArray;
+   INTEGER_HN **integerArray;
+   BITMAP_HN **bitMapArray;
    unsigned long int symbolCount = 0, integerCount = 0;
    unsigned long int floatCount = 0, bitMapCount = 0;
 
@@ -138,9 +138,10 @@ globle void PrimitiveTablesInfo(
    /*====================================*/
 
    symbolArray = GetSymbolTable(theEnv,execStatus);
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   tableSize = GetSymbolTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
      {
-      for (symbolPtr = symbolArray[i]; symbolPtr != NULL; symbolPtr = symbolPtr->next)
+      if (symbolArray[i] != NULL)
         { symbolCount++; }
      }
 
@@ -149,9 +150,10 @@ globle void PrimitiveTablesInfo(
    /*====================================*/
 
    integerArray = GetIntegerTable(theEnv,execStatus);
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   tableSize = GetIntegerTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
      {
-      for (integerPtr = integerArray[i]; integerPtr != NULL; integerPtr = integerPtr->next)
+      if (integerArray[i] != NULL)
         { integerCount++; }
      }
 
@@ -160,9 +162,10 @@ globle void PrimitiveTablesInfo(
    /*====================================*/
 
    floatArray = GetFloatTable(theEnv,execStatus);
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   tableSize = GetFloatTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
      {
-      for (floatPtr = floatArray[i]; floatPtr != NULL; floatPtr = floatPtr->next)
+      if (floatArray[i] != NULL)
         { floatCount++; }
      }
 
@@ -171,9 +174,10 @@ globle void PrimitiveTablesInfo(
    /*====================================*/
 
    bitMapArray = GetBitMapTable(theEnv,execStatus);
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   tableSize = GetBitMapTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
      {
-      for (bitMapPtr = bitMapArray[i]; bitMapPtr != NULL; bitMapPtr = bitMapPtr->next)
+      if (bitMapArray[i] != NULL)
         { bitMapCount++; }
      }
 
@@ -210,10 +214,10 @@ globle void PrimitiveTablesUsage(
   void *theEnv,
   EXEC_STATUS)
   {
-   unsigned long i;
+   unsigned long i, tableSize;
    int symbolCounts[COUNT_SIZE], floatCounts[COUNT_SIZE];
-   SYMBOL_HN **symbolArray, *symbolPtr;
-   FLOAT_HN **floatArray, *floatPtr;
+   SYMBOL_HN **symbolArray;
+   FLOAT_HN **floatArray;
    unsigned long int symbolCount, totalSymbolCount = 0;
    unsigned long int floatCount, totalFloatCount = 0;
 
@@ -225,44 +229,53 @@ globle void PrimitiveTablesUsage(
       floatCounts[i] = 0; 
      }
      
-   /*====================================*/
-   /* Count entries in the symbol table. */
-   /*====================================*/
+   /*=============================================*/
+   /* Count the runs of occupied slots preceding  */
+   /* each empty slot of the symbol table, which  */
+   /* are the entries probed by failed searches.  */
+   /*=============================================*/
 
    symbolArray = GetSymbolTable(theEnv,execStatus);
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   tableSize = GetSymbolTableSize(theEnv,execStatus);
+   symbolCount = 0;
+   for (i = 0; i <= tableSize; i++)
      {
-      symbolCount = 0;
-      for (symbolPtr = symbolArray[i]; symbolPtr != NULL; symbolPtr = symbolPtr->next)
+      if ((i < tableSize) && (symbolArray[i] != NULL))
         { 
          symbolCount++;
          totalSymbolCount++;
+         continue;
         }
            
       if (symbolCount < (COUNT_SIZE - 1))
         { symbolCounts[symbolCount]++; }
       else
         { symbolCounts[COUNT_SIZE - 1]++; }
+      symbolCount = 0;
      }
 
-   /*===================================*/
-   /* Count entries in the float table. */
-   /*===================================*/
+   /*============================================*/
+   /* Count the runs of occupied slots preceding */
+   /* each empty slot of the float table.        */
+   /*============================================*/
    
    floatArray = GetFloatTable(theEnv,execStatus);
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   tableSize = GetFloatTableSize(theEnv,execStatus);
+   floatCount = 0;
+   for (i = 0; i <= tableSize; i++)
      {
-      floatCount = 0;
-      for (floatPtr = floatArray[i]; floatPtr != NULL; floatPtr = floatPtr->next)
+      if ((i < tableSize) && (floatArray[i] != NULL))
         { 
          floatCount++;
          totalFloatCount++;
+         continue;
         }
            
       if (floatCount < (COUNT_SIZE - 1))
         { floatCounts[floatCount]++; }
       else
         { floatCounts[COUNT_SIZE - 1]++; }
+      floatCount = 0;
      }
 
 
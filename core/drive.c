@@ -51,12 +51,14 @@
 #include "engine.h"
 #include "envrnmnt.h"
 #include "memalloc.h"
+#include "ordmem.h"
 #include "prntutil.h"
 #include "reteutil.h"
 #include "retract.h"
 #include "router.h"
 #include "lgcldpnd.h"
 #include "incrrset.h"
+#include "proflfun.h"
 
 #include "drive.h"  
   
@@ -64,7 +66,10 @@
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
 
+   static void                    RightJoinDrive(void *,EXEC_STATUS,struct partialMatch *,struct joinNode *);
+   static void                    LeftJoinDrive(void *,EXEC_STATUS,struct partialMatch *,struct joinNode *);
    static void                    EmptyDrive(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *);
+   static void                    FirstJoinDrive(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *);
    static void                    JoinNetErrorMessage(void *,EXEC_STATUS,struct joinNode *);
    
 /************************************************/
@@ -108,7 +113,8 @@ globle void NetworkAssert(
 /*****************************************************/
 /* NetworkAssertRight: Primary routine for filtering */
 /*   a partial match through the join network from   */
-/*   the RHS of a join.                              */
+/*   the RHS of a join. When joins are profiled, the */
+/*   time spent in the join is charged to it.        */
 /*****************************************************/
 globle void NetworkAssertRight(
   void *theEnv,
@@ -116,11 +122,37 @@ globle void NetworkAssertRight(
   struct partialMatch *rhsBinds,
   struct joinNode *join)
   {
+#if PROFILING_FUNCTIONS
+   struct joinProfileFrame profileFrame;
+
+   if (ProfileFunctionData(theEnv,execStatus)->ProfileJoins && (! join->firstJoin))
+     {
+      StartJoinProfile(theEnv,execStatus,&profileFrame,join);
+      RightJoinDrive(theEnv,execStatus,rhsBinds,join);
+      EndJoinProfile(theEnv,execStatus,&profileFrame);
+      return;
+     }
+#endif
+
+   RightJoinDrive(theEnv,execStatus,rhsBinds,join);
+  }
+
+/****************************************************/
+/* RightJoinDrive: Filters a partial match entering */
+/*   a join from the RHS through the join network.  */
+/****************************************************/
+static void RightJoinDrive(
+  void *theEnv,
+  EXEC_STATUS,
+  struct partialMatch *rhsBinds,
+  struct joinNode *join)
+  {
    struct partialMatch *lhsBinds, *nextBind;
    int exprResult, restore = FALSE;
    struct partialMatch *oldLHSBinds = NULL;
    struct partialMatch *oldRHSBinds = NULL;
    struct joinNode *oldJoin = NULL;
+   struct rangeScan theScan;
 
    /*=========================================================*/
    /* If an incremental reset is being performed and the join */
@@ -136,13 +168,33 @@ globle void NetworkAssertRight(
       EmptyDrive(theEnv,execStatus,join,rhsBinds);
       return;
      }
+
+   /*=======================================================*/
+   /* The bucket of the join's memories for the hash value  */
+   /* is locked until the partial match has been compared   */
+   /* with the LHS partial matches, so that a partial match */
+   /* entering the join concurrently from the LHS is not    */
+   /* blocked or joined while this one is being processed.  */
+   /*=======================================================*/
+
+   LockJoinMemory(join,rhsBinds->hashValue);
+   join->rightActivations++;
   
    /*=====================================================*/
    /* The partial matches entering from the LHS of a join */
-   /* are stored in the left beta memory of the join.     */
+   /* are stored in the left beta memory of the join. If  */
+   /* the join has ordered memories, only those within    */
+   /* the range of the join's range tests are compared.   */
    /*=====================================================*/
 
-   lhsBinds = GetLeftBetaMemory(join,rhsBinds->hashValue);
+   if (join->rangeIndex != NULL)
+     {
+      AddToRangeIndex(theEnv,execStatus,join,rhsBinds,RHS);
+      StartRangeScan(theEnv,execStatus,join,rhsBinds,RHS,&theScan);
+      lhsBinds = NextRangeMatch(&theScan);
+     }
+   else
+     { lhsBinds = GetLeftBetaMemory(join,rhsBinds->hashValue); }
 
 #if DEVELOPER
    if (lhsBinds != NULL)
@@ -157,9 +209,9 @@ globle void NetworkAssertRight(
      {
       oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
       oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
-      oldJoin = EngineData(theEnv,execStatus)->GlobalJoin;
+      oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
       LocalEngineData(theEnv,execStatus).RHSBinds = rhsBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = join;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = join;
       restore = TRUE;
      }
     
@@ -172,7 +224,10 @@ globle void NetworkAssertRight(
 
    while (lhsBinds != NULL)
      {
-      nextBind = lhsBinds->nextInMemory;
+      if (join->rangeIndex != NULL)
+        { nextBind = NextRangeMatch(&theScan); }
+      else
+        { nextBind = lhsBinds->nextInMemory; }
       join->memoryCompares++;
       
       /*===========================================================*/
@@ -194,6 +249,22 @@ globle void NetworkAssertRight(
          lhsBinds = nextBind;
          continue;
         }
+
+      /*=========================================================*/
+      /* On a matcher worker, a LHS partial match added to the   */
+      /* memory after this partial match entered the network is  */
+      /* skipped: it is compared with this one when it enters    */
+      /* the join from the LHS. The ordered memories of a join   */
+      /* only hold the partial matches which have entered it.    */
+      /*=========================================================*/
+
+      if ((execStatus->MatchWorker != NULL) &&
+          (join->rangeIndex == NULL) &&
+          (lhsBinds->memoryTag > rhsBinds->memoryTag))
+        {
+         lhsBinds = nextBind;
+         continue;
+        }
         
       /*===============================================================*/
       /* If there already is an associated RHS partial match stored in */
@@ -267,16 +338,21 @@ globle void NetworkAssertRight(
         {
          if (join->patternIsExists)
            {
-            AddBlockedLink(lhsBinds,rhsBinds);
+            AddBlockedLink(theEnv,execStatus,lhsBinds,rhsBinds);
             PPDrive(theEnv,execStatus,lhsBinds,NULL,join);
            }
          else if (join->patternIsNegated || join->joinFromTheRight)
            {
-            AddBlockedLink(lhsBinds,rhsBinds);
+            AddBlockedLink(theEnv,execStatus,lhsBinds,rhsBinds);
             if (lhsBinds->children != NULL)
-              { PosEntryRetractBeta(theEnv,execStatus,lhsBinds,lhsBinds->children); }
+              {
+               if (execStatus->MatchWorker != NULL)
+                 { DeferRetractBeta(theEnv,execStatus,lhsBinds); }
+               else
+                 { PosEntryRetractBeta(theEnv,execStatus,lhsBinds,lhsBinds->children); }
+              }
             /*
-            if (lhsBinds->dependents != NULL) 
+            if (get_pm_dependents(lhsBinds) != NULL) 
               { RemoveLogicalSupport(theEnv,execStatus,lhsBinds); }
             */
            } 
@@ -299,8 +375,10 @@ globle void NetworkAssertRight(
      {
       LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
       LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
      }
+
+   UnlockJoinMemory(join,rhsBinds->hashValue);
      
    return;
   }
@@ -308,7 +386,9 @@ globle void NetworkAssertRight(
 /****************************************************/
 /* NetworkAssertLeft: Primary routine for filtering */
 /*   a partial match through the join network when  */
-/*   entering through the left side of a join.      */
+/*   entering through the left side of a join. When */
+/*   joins are profiled, the time spent in the join */
+/*   is charged to it.                              */
 /****************************************************/
 globle void NetworkAssertLeft(
   void *theEnv,
@@ -316,12 +396,38 @@ globle void NetworkAssertLeft(
   struct partialMatch *lhsBinds,
   struct joinNode *join)
   {
+#if PROFILING_FUNCTIONS
+   struct joinProfileFrame profileFrame;
+
+   if (ProfileFunctionData(theEnv,execStatus)->ProfileJoins)
+     {
+      StartJoinProfile(theEnv,execStatus,&profileFrame,join);
+      LeftJoinDrive(theEnv,execStatus,lhsBinds,join);
+      EndJoinProfile(theEnv,execStatus,&profileFrame);
+      return;
+     }
+#endif
+
+   LeftJoinDrive(theEnv,execStatus,lhsBinds,join);
+  }
+
+/***************************************************/
+/* LeftJoinDrive: Filters a partial match entering */
+/*   a join from the LHS through the join network. */
+/***************************************************/
+static void LeftJoinDrive(
+  void *theEnv,
+  EXEC_STATUS,
+  struct partialMatch *lhsBinds,
+  struct joinNode *join)
+  {
    struct partialMatch *rhsBinds;
    int exprResult, restore = FALSE;
    unsigned long entryHashValue;
    struct partialMatch *oldLHSBinds = NULL;
    struct partialMatch *oldRHSBinds = NULL;
    struct joinNode *oldJoin = NULL;
+   struct rangeScan theScan;
 
    /*=========================================================*/
    /* If an incremental reset is being performed and the join */
@@ -332,6 +438,8 @@ globle void NetworkAssertLeft(
    if (EngineData(theEnv,execStatus)->IncrementalResetInProgress && (join->initialize == FALSE)) return;
 #endif
 
+   join->leftActivations++;
+
    /*===================================*/
    /* The only action for the last join */
    /* of a rule is to activate it.      */
@@ -349,7 +457,32 @@ globle void NetworkAssertLeft(
    /*==================================================*/
 
    entryHashValue = lhsBinds->hashValue;
-   if (join->joinFromTheRight)
+
+   /*=========================================================*/
+   /* Lock the bucket of the join's memories for the hash     */
+   /* value. On a matcher worker, a partial match entering a  */
+   /* not/exists CE or a join from the right may already have */
+   /* been blocked by a RHS partial match which entered the   */
+   /* join after it was added to the left memory.             */
+   /*=========================================================*/
+
+   LockJoinMemory(join,entryHashValue);
+
+   if ((execStatus->MatchWorker != NULL) &&
+       (join->patternIsNegated || join->patternIsExists || join->joinFromTheRight) &&
+       (lhsBinds->marker != NULL))
+     {
+      UnlockJoinMemory(join,entryHashValue);
+      return;
+     }
+
+   if (join->rangeIndex != NULL)
+     {
+      AddToRangeIndex(theEnv,execStatus,join,lhsBinds,LHS);
+      StartRangeScan(theEnv,execStatus,join,lhsBinds,LHS,&theScan);
+      rhsBinds = NextRangeMatch(&theScan);
+     }
+   else if (join->joinFromTheRight)
      { rhsBinds = GetRightBetaMemory(join,entryHashValue); }
    else
      { rhsBinds = GetAlphaMemory(theEnv,execStatus,(struct patternNodeHeader *) join->rightSideEntryStructure,entryHashValue); }
@@ -367,9 +500,9 @@ globle void NetworkAssertLeft(
      {
       oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
       oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
-      oldJoin = EngineData(theEnv,execStatus)->GlobalJoin;
+      oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
       LocalEngineData(theEnv,execStatus).LHSBinds = lhsBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = join;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = join;
       restore = TRUE;
      }
   
@@ -382,6 +515,14 @@ globle void NetworkAssertLeft(
 
    while (rhsBinds != NULL)
      {
+      if ((execStatus->MatchWorker != NULL) &&
+          (join->rangeIndex == NULL) &&
+          (rhsBinds->memoryTag > lhsBinds->memoryTag))
+        {
+         rhsBinds = rhsBinds->nextInMemory;
+         continue;
+        }
+
       join->memoryCompares++;
 
       /*===================================================*/
@@ -448,11 +589,12 @@ globle void NetworkAssertLeft(
          
          else if (join->patternIsExists)
            { 
-            AddBlockedLink(lhsBinds,rhsBinds);
+            AddBlockedLink(theEnv,execStatus,lhsBinds,rhsBinds);
             PPDrive(theEnv,execStatus,lhsBinds,NULL,join);
             LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
             LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-            EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+            LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
+            UnlockJoinMemory(join,entryHashValue);
             return;
            }
            
@@ -469,7 +611,7 @@ globle void NetworkAssertLeft(
 
          else
            {
-            AddBlockedLink(lhsBinds,rhsBinds);
+            AddBlockedLink(theEnv,execStatus,lhsBinds,rhsBinds);
             break;
            }
         }
@@ -478,7 +620,10 @@ globle void NetworkAssertLeft(
       /* Move on to the next partial match. */
       /*====================================*/
 
-      rhsBinds = rhsBinds->nextInMemory;
+      if (join->rangeIndex != NULL)
+        { rhsBinds = NextRangeMatch(&theScan); }
+      else
+        { rhsBinds = rhsBinds->nextInMemory; }
      }
 
    /*==================================================================*/
@@ -519,9 +664,11 @@ globle void NetworkAssertLeft(
      {
       LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
       LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
      }
 
+   UnlockJoinMemory(join,entryHashValue);
+
    return;
   }
 
@@ -690,17 +837,17 @@ globle intBool EvaluateSecondaryNetworkTest(
 #endif
    oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
    oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
-   oldJoin = EngineData(theEnv,execStatus)->GlobalJoin;
+   oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
    LocalEngineData(theEnv,execStatus).LHSBinds = leftMatch;
    LocalEngineData(theEnv,execStatus).RHSBinds = NULL;
-   EngineData(theEnv,execStatus)->GlobalJoin = joinPtr;
+   LocalEngineData(theEnv,execStatus).GlobalJoin = joinPtr;
 
    joinExpr = EvaluateJoinExpression(theEnv,execStatus,joinPtr->secondaryNetworkTest,joinPtr);
    execStatus->EvaluationError = FALSE;
 
    LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
    LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-   EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+   LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
 
    return(joinExpr);
   }
@@ -736,10 +883,10 @@ globle unsigned long BetaMemoryHashValue(
 
    oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
    oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
-   oldJoin = EngineData(theEnv,execStatus)->GlobalJoin;
+   oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
    LocalEngineData(theEnv,execStatus).LHSBinds = lbinds;
    LocalEngineData(theEnv,execStatus).RHSBinds = rbinds;
-   EngineData(theEnv,execStatus)->GlobalJoin = joinPtr;
+   LocalEngineData(theEnv,execStatus).GlobalJoin = joinPtr;
 
    /*=========================================*/
    /* Evaluate each of the expressions linked */
@@ -771,22 +918,7 @@ globle unsigned long BetaMemoryHashValue(
       else
         { EvaluateExpression(theEnv,execStatus,hashExpr,&theResult); }
 
-      switch (theResult.type)
-        {
-         case STRING:
-         case SYMBOL:
-         case INSTANCE_NAME:
-           hashValue += (((SYMBOL_HN *) theResult.value)->bucket * multiplier);
-           break;
-             
-         case INTEGER:
-            hashValue += (((INTEGER_HN *) theResult.value)->bucket * multiplier);
-            break;
-             
-         case FLOAT:
-           hashValue += (((FLOAT_HN *) theResult.value)->bucket * multiplier);
-           break;
-        }
+      hashValue += HashJoinValue(&theResult) * multiplier;
 
       /*==============================================*/
       /* Move to the next expression to be evaluated. */
@@ -802,7 +934,7 @@ globle unsigned long BetaMemoryHashValue(
 
    LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
    LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-   EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+   LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
 
    /*=================================================*/
    /* Return the result of evaluating the expression. */
@@ -923,6 +1055,8 @@ globle void EPMDrive(
 /* EmptyDrive: Handles the entry of a alpha memory partial     */
 /*   match from the RHS of a join that is the first join of    */
 /*   a rule (i.e. a join that cannot be entered from the LHS). */
+/*   When joins are profiled, the time spent in the join is    */
+/*   charged to it.                                            */
 /***************************************************************/
 static void EmptyDrive(
   void *theEnv,
@@ -930,6 +1064,31 @@ static void EmptyDrive(
   struct joinNode *join,
   struct partialMatch *rhsBinds)
   {
+#if PROFILING_FUNCTIONS
+   struct joinProfileFrame profileFrame;
+
+   if (ProfileFunctionData(theEnv,execStatus)->ProfileJoins)
+     {
+      StartJoinProfile(theEnv,execStatus,&profileFrame,join);
+      FirstJoinDrive(theEnv,execStatus,join,rhsBinds);
+      EndJoinProfile(theEnv,execStatus,&profileFrame);
+      return;
+     }
+#endif
+
+   FirstJoinDrive(theEnv,execStatus,join,rhsBinds);
+  }
+
+/*************************************************************/
+/* FirstJoinDrive: Filters an alpha memory partial match     */
+/*   entering the first join of a rule through the network.  */
+/*************************************************************/
+static void FirstJoinDrive(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join,
+  struct partialMatch *rhsBinds)
+  {
    struct partialMatch *linker, *existsParent = NULL, *notParent;
    struct joinLink *listOfJoins;
    int joinExpr;
@@ -944,6 +1103,7 @@ static void EmptyDrive(
    /* action is taken.                                     */
    /*======================================================*/
 
+   join->rightActivations++;
    join->memoryCompares++;
 
    if (join->networkTest != NULL)
@@ -955,17 +1115,17 @@ static void EmptyDrive(
 #endif
       oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
       oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
-      oldJoin = EngineData(theEnv,execStatus)->GlobalJoin;
+      oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
       LocalEngineData(theEnv,execStatus).LHSBinds = NULL;
       LocalEngineData(theEnv,execStatus).RHSBinds = rhsBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = join;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = join;
 
       joinExpr = EvaluateJoinExpression(theEnv,execStatus,join->networkTest,join);
       execStatus->EvaluationError = FALSE;
 
       LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
       LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
 
       if (joinExpr == FALSE) return;
      }
@@ -976,16 +1136,26 @@ static void EmptyDrive(
 
    if (join->patternIsNegated || (join->joinFromTheRight && (! join->patternIsExists))) /* reorder to remove patternIsExists test */
      {
+      LockJoinMemory(join,0);
       notParent = join->leftMemory->beta[0];
       if (notParent->marker != NULL)
-        { return; }
+        {
+         UnlockJoinMemory(join,0);
+         return;
+        }
         
-      AddBlockedLink(notParent,rhsBinds);
+      AddBlockedLink(theEnv,execStatus,notParent,rhsBinds);
       
       if (notParent->children != NULL)
-        { PosEntryRetractBeta(theEnv,execStatus,notParent,notParent->children); }
+        {
+         if (execStatus->MatchWorker != NULL)
+           { DeferRetractBeta(theEnv,execStatus,notParent); }
+         else
+           { PosEntryRetractBeta(theEnv,execStatus,notParent,notParent->children); }
+        }
+      UnlockJoinMemory(join,0);
       /*
-      if (notParent->dependents != NULL) 
+      if (get_pm_dependents(notParent) != NULL) 
 		{ RemoveLogicalSupport(theEnv,execStatus,notParent); } 
         */
               
@@ -1001,10 +1171,15 @@ static void EmptyDrive(
   /* TBD reorder */
    if (join->patternIsExists)
      {
+      LockJoinMemory(join,0);
       existsParent = join->leftMemory->beta[0];
       if (existsParent->marker != NULL)
-        { return; }
-      AddBlockedLink(existsParent,rhsBinds);
+        {
+         UnlockJoinMemory(join,0);
+         return;
+        }
+      AddBlockedLink(theEnv,execStatus,existsParent,rhsBinds);
+      UnlockJoinMemory(join,0);
      }
 
    /*============================================*/
@@ -46,6 +46,7 @@
 
 #include <stdio.h>
 #define _STDIO_INCLUDED_
+#include <stdlib.h>
 #include <string.h>
 
 #include "setup.h"
@@ -57,11 +58,13 @@
 #include "constant.h"
 #include "envrnmnt.h"
 #include "fact/fact_manager.h"
+#include "fact/fact_events.h"
 #include "inscom.h"
 #include "memalloc.h"
 #include "modulutl.h"
 #include "prccode.h"
 #include "prcdrfun.h"
+#include "prntutil.h"
 #include "proflfun.h"
 #include "reteutil.h"
 #include "retract.h"
@@ -91,6 +94,14 @@ globle void InitializeEngine(
    AllocateEnvironmentData(theEnv,execStatus,ENGINE_DATA,sizeof(struct engineData),DeallocateEngineData);
 
    EngineData(theEnv,execStatus)->IncrementalResetFlag = TRUE;
+
+   if (apr_thread_mutex_create(&EngineData(theEnv,execStatus)->DeferredRetractionLock,
+                               APR_THREAD_MUTEX_DEFAULT,
+                               Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+     {
+      SystemError(theEnv,execStatus,"ENGINE",1);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
    
 #if DEBUGGING_FUNCTIONS
    AddWatchItem(theEnv,execStatus,"statistics",0,&EngineData(theEnv,execStatus)->WatchStatistics,20,NULL,NULL);
@@ -110,6 +121,9 @@ static void DeallocateEngineData(
    
    DeallocateCallList(theEnv,execStatus,EngineData(theEnv,execStatus)->ListOfRunFunctions);
 
+   if (EngineData(theEnv,execStatus)->DeferredRetractions != NULL)
+     { free(EngineData(theEnv,execStatus)->DeferredRetractions); }
+
    tmpPtr = EngineData(theEnv,execStatus)->CurrentFocus;
    while (tmpPtr != NULL)
      {
@@ -617,6 +631,17 @@ static struct activation *NextActivationToFire(
    struct activation *theActivation;
    struct defmodule *theModule;
 
+#if DEFTEMPLATE_CONSTRUCT
+   /*===================================================*/
+   /* Events handed to the fact threads must have been  */
+   /* matched before the next activation can be chosen. */
+   /*===================================================*/
+
+   EnvWaitForPendingEvents(theEnv,execStatus);
+#endif
+
+   apr_thread_mutex_lock(AgendaData(theEnv,execStatus)->lock);
+
    /*====================================*/
    /* If there is no current focus, then */
    /* focus on the MAIN module.          */
@@ -633,15 +658,24 @@ static struct activation *NextActivationToFire(
    /* focus. If the current focus has no activations on its     */
    /* agenda, then pop the focus off the focus stack until      */
    /* a focus that has an activation on its agenda is found.    */
+   /* Pending activations are placed on the agenda of a focus   */
+   /* before its top activation is determined.                  */
    /*===========================================================*/
 
+   MaterializeActivations(theEnv,execStatus,EngineData(theEnv,execStatus)->CurrentFocus->theDefruleModule);
    theActivation = EngineData(theEnv,execStatus)->CurrentFocus->theDefruleModule->agenda;
    while ((theActivation == NULL) && (EngineData(theEnv,execStatus)->CurrentFocus != NULL))
      {
       if (EngineData(theEnv,execStatus)->CurrentFocus != NULL) EnvPopFocus(theEnv,execStatus);
-      if (EngineData(theEnv,execStatus)->CurrentFocus != NULL) theActivation = EngineData(theEnv,execStatus)->CurrentFocus->theDefruleModule->agenda;
+      if (EngineData(theEnv,execStatus)->CurrentFocus != NULL)
+        {
+         MaterializeActivations(theEnv,execStatus,EngineData(theEnv,execStatus)->CurrentFocus->theDefruleModule);
+         theActivation = EngineData(theEnv,execStatus)->CurrentFocus->theDefruleModule->agenda;
+        }
      }
 
+   apr_thread_mutex_unlock(AgendaData(theEnv,execStatus)->lock);
+
    /*=========================================*/
    /* Return the next activation to be fired. */
    /*=========================================*/
@@ -56,6 +56,8 @@
 #include "retract.h"
 #endif
 
+# include <apr_thread_mutex.h>
+
 struct focus
   {
    struct defmodule *theModule;
@@ -63,6 +65,20 @@ struct focus
    struct focus *next;
   };
   
+/***************************************************************/
+/* DEFERREDRETRACTION STRUCTURE: A partial match which has     */
+/*   been blocked by a matcher worker and whose children still */
+/*   have to be retracted. The partial match is marked busy    */
+/*   until the retraction has been performed.                  */
+/***************************************************************/
+struct deferredRetraction
+  {
+   struct partialMatch *theMatch;
+   unsigned int wasBusy;
+  };
+
+#define INITIAL_DEFERRED_RETRACTIONS 64
+
 #define ENGINE_DATA 18
 
 struct engineData
@@ -83,9 +99,12 @@ struct engineData
    intBool IncrementalResetInProgress;
    intBool IncrementalResetFlag;
    intBool MatchOperationInProgress;
-   struct joinNode *GlobalJoin;
    struct partialMatch *GarbagePartialMatches;
    struct alphaMatch *GarbageAlphaMatches;
+   apr_thread_mutex_t *DeferredRetractionLock;
+   struct deferredRetraction *DeferredRetractions;
+   unsigned long DeferredRetractionCount;
+   unsigned long DeferredRetractionMax;
    int AlreadyRunning;
 #if DEVELOPER
    long leftToRightComparisons;
@@ -67,7 +67,9 @@
    static void                    RemoveEnvironmentCleanupFunctions(struct environmentData *, EXEC_STATUS);
    static void                   *CreateEnvironmentDriver(EXEC_STATUS,struct symbolHashNode **,struct floatHashNode **,
                                                           struct integerHashNode **,struct bitMapHashNode **,
-                                                          struct externalAddressHashNode **);
+                                                          struct externalAddressHashNode **,
+                                                          unsigned int,unsigned int);
+   static unsigned int            ThreadPoolSize(unsigned int);
 
 /***************************************/
 /* LOCAL INTERNAL VARIABLE DEFINITIONS */
@@ -298,7 +300,22 @@ static struct environmentData *FindEnvironment(
 /************************************************************/
 globle void *CreateEnvironment(EXEC_STATUS)
   {
-   return CreateEnvironmentDriver(execStatus,NULL,NULL,NULL,NULL,NULL);
+   return CreateEnvironmentDriver(execStatus,NULL,NULL,NULL,NULL,NULL,
+                                  ONLINE_CPU_THREADS,DEFAULT_FACT_THREADS);
+  }
+
+/****************************************************************/
+/* CreateEnvironmentWithThreads: Creates an environment whose   */
+/*   matcher and fact thread pools have the specified number of */
+/*   workers. A count of zero uses the number of online cores.  */
+/****************************************************************/
+globle void *CreateEnvironmentWithThreads(
+  EXEC_STATUS,
+  unsigned int matcherThreads,
+  unsigned int factThreads)
+  {
+   return CreateEnvironmentDriver(execStatus,NULL,NULL,NULL,NULL,NULL,
+                                  matcherThreads,factThreads);
   }
 
 /*********************************************************************/
@@ -314,7 +331,15 @@ globle struct executionStatus *CreateExecutionStatus()
   result->EvaluationError        = FALSE;
   result->CurrentExpression      = NULL;
   result->CurrentEvaluationDepth = 0;
-  result->DepthInReteNetwork     = 0;
+  result->MatchWorker            = NULL;
+  result->LocalEngineData.LHSBinds = NULL;
+  result->LocalEngineData.RHSBinds = NULL;
+  result->LocalEngineData.GlobalJoin = NULL;
+  result->LocalFactsData.CurrentPatternFact  = NULL;
+  result->LocalFactsData.CurrentPatternMarks = NULL;
+  result->MemoryCache                        = NULL;
+  result->ActiveJoinProfile                  = NULL;
+  result->Ephemerons                         = NULL;
   
 	return result;
 }
@@ -329,7 +354,8 @@ globle void *CreateRuntimeEnvironment(
   struct integerHashNode **integerTable,
   struct bitMapHashNode **bitmapTable)
   {
-   return CreateEnvironmentDriver(execStatus,symbolTable,floatTable,integerTable,bitmapTable,NULL);
+   return CreateEnvironmentDriver(execStatus,symbolTable,floatTable,integerTable,bitmapTable,NULL,
+                                  ONLINE_CPU_THREADS,DEFAULT_FACT_THREADS);
   }
   
 /*********************************************************/
@@ -342,7 +368,9 @@ globle void *CreateEnvironmentDriver(
   struct floatHashNode **floatTable,
   struct integerHashNode **integerTable,
   struct bitMapHashNode **bitmapTable,
-  struct externalAddressHashNode **externalAddressTable)
+  struct externalAddressHashNode **externalAddressTable,
+  unsigned int matcherThreads,
+  unsigned int factThreads)
   {
    struct environmentData *theEnvironment;
 	  
@@ -384,6 +412,8 @@ globle void *CreateEnvironmentDriver(
     theEnvironment->memoryPool = NULL;
     theEnvironment->matcherThreadPool = NULL;
     theEnvironment->factThreadPool = NULL;
+    theEnvironment->matcherThreads = ThreadPoolSize(matcherThreads);
+    theEnvironment->factThreads = ThreadPoolSize(factThreads);
     
     // STEFAN: initalize the thread-pool related data structures
     apr_status_t rv;
@@ -397,14 +427,16 @@ globle void *CreateEnvironmentDriver(
     }
     
     rv = apr_thread_pool_create(&theEnvironment->matcherThreadPool, 
-                                1, 1, theEnvironment->memoryPool);
+                                1, theEnvironment->matcherThreads,
+                                theEnvironment->memoryPool);
     if (rv) {
       printf("\n[ENVRNMNT_THREAD] Unable to create thread pool.\n");
       return(NULL);
     }
     
     rv = apr_thread_pool_create(&theEnvironment->factThreadPool,
-                                1, 1, theEnvironment->memoryPool);
+                                1, theEnvironment->factThreads,
+                                theEnvironment->memoryPool);
     if (rv) {
       printf("\n[ENVRNMNT_THREAD] Unable to create thread pool.\n");
       return(NULL);
@@ -634,6 +666,87 @@ globle void *SetEnvironmentCallbackContext(
    return oldCallbackContext;
   } 
   
+/***********************************************************/
+/* ThreadPoolSize: Maps a requested thread count onto the  */
+/*   number of workers used for a thread pool. A count of  */
+/*   zero selects one worker per online processor.         */
+/***********************************************************/
+static unsigned int ThreadPoolSize(
+  unsigned int requested)
+  {
+   if (requested == ONLINE_CPU_THREADS)
+     { return(genonlinecpus()); }
+
+   return(requested);
+  }
+
+/***************************************************/
+/* EnvGetMatcherThreads: Returns the maximum       */
+/*   number of workers in the matcher thread pool. */
+/***************************************************/
+globle unsigned int EnvGetMatcherThreads(
+  void *theEnvironment,
+  EXEC_STATUS)
+  {
+   return(((struct environmentData *) theEnvironment)->matcherThreads);
+  }
+
+/*****************************************************/
+/* EnvSetMatcherThreads: Resizes the matcher thread  */
+/*   pool used for parallel pattern matching. Extra  */
+/*   workers retire once their current task is done. */
+/*   Returns the previous number of workers.         */
+/*****************************************************/
+globle unsigned int EnvSetMatcherThreads(
+  void *vTheEnvironment,
+  EXEC_STATUS,
+  unsigned int matcherThreads)
+  {
+   struct environmentData *theEnvironment = (struct environmentData *) vTheEnvironment;
+   unsigned int oldThreads;
+
+   oldThreads = theEnvironment->matcherThreads;
+   theEnvironment->matcherThreads = ThreadPoolSize(matcherThreads);
+
+   apr_thread_pool_thread_max_set(theEnvironment->matcherThreadPool,theEnvironment->matcherThreads);
+   apr_thread_pool_idle_max_set(theEnvironment->matcherThreadPool,theEnvironment->matcherThreads);
+
+   return(oldThreads);
+  }
+
+/************************************************/
+/* EnvGetFactThreads: Returns the maximum       */
+/*   number of workers in the fact thread pool. */
+/************************************************/
+globle unsigned int EnvGetFactThreads(
+  void *theEnvironment,
+  EXEC_STATUS)
+  {
+   return(((struct environmentData *) theEnvironment)->factThreads);
+  }
+
+/***************************************************/
+/* EnvSetFactThreads: Resizes the fact thread pool */
+/*   which processes proc-event requests. Returns  */
+/*   the previous number of workers.               */
+/***************************************************/
+globle unsigned int EnvSetFactThreads(
+  void *vTheEnvironment,
+  EXEC_STATUS,
+  unsigned int factThreads)
+  {
+   struct environmentData *theEnvironment = (struct environmentData *) vTheEnvironment;
+   unsigned int oldThreads;
+
+   oldThreads = theEnvironment->factThreads;
+   theEnvironment->factThreads = ThreadPoolSize(factThreads);
+
+   apr_thread_pool_thread_max_set(theEnvironment->factThreadPool,theEnvironment->factThreads);
+   apr_thread_pool_idle_max_set(theEnvironment->factThreadPool,theEnvironment->factThreads);
+
+   return(oldThreads);
+  }
+
 /**********************************************/
 /* DestroyEnvironment: Destroys the specified */
 /*   environment returning all of its memory. */
@@ -675,6 +788,7 @@ globle intBool DestroyEnvironment(
 
    RemoveEnvironmentCleanupFunctions(theEnvironment,execStatus);
    
+   ReleaseAllMemoryCaches(theEnvironment,execStatus);
    EnvReleaseMem(theEnvironment,execStatus,-1,FALSE);
 
 #if ALLOW_ENVIRONMENT_GLOBALS
@@ -690,6 +804,7 @@ globle intBool DestroyEnvironment(
      }
      
    free(theMemData->MemoryTable);
+   free(theMemData->BatchTable);
 
 #if BLOCK_MEMORY
    ReturnAllBlocks(theEnvironment);
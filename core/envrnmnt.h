@@ -48,6 +48,19 @@
 #define USER_ENVIRONMENT_DATA 70
 #define MAXIMUM_ENVIRONMENT_POSITIONS 100
 
+/*=================================================*/
+/* A thread count of zero sizes a pool to the      */
+/* number of processors online. The fact thread    */
+/* serializes proc-event assertions and therefore  */
+/* defaults to a single worker. The matcher pool   */
+/* is given at most MAX_THREADS_PER_CPU workers    */
+/* for each processor online.                      */
+/*=================================================*/
+
+#define ONLINE_CPU_THREADS    0
+#define DEFAULT_FACT_THREADS  1
+#define MAX_THREADS_PER_CPU   16
+
 # include <apr_pools.h>
 # include <apr_thread_pool.h>
 # include <apr_thread_rwlock.h>
@@ -80,6 +93,8 @@ struct environmentData
     apr_pool_t        *memoryPool;
     apr_thread_pool_t *matcherThreadPool;
     apr_thread_pool_t *factThreadPool;
+    unsigned int       matcherThreads;
+    unsigned int       factThreads;
 	
 	// Lode: Added Reader/Writer Lock for Hash
 	apr_thread_rwlock_t *factHashLock;
@@ -104,6 +119,7 @@ typedef struct environmentData * ENVIRONMENT_DATA_PTR;
    LOCALE unsigned long                  GetEnvironmentIndex(void *,EXEC_STATUS);
 #endif
    LOCALE void                          *CreateEnvironment(EXEC_STATUS);
+   LOCALE void                          *CreateEnvironmentWithThreads(EXEC_STATUS,unsigned int,unsigned int);
    LOCALE struct executionStatus        *CreateExecutionStatus(void);
    LOCALE void                          *CreateRuntimeEnvironment(EXEC_STATUS,struct symbolHashNode **,struct floatHashNode **,
                                                                   struct integerHashNode **,struct bitMapHashNode **);
@@ -117,6 +133,10 @@ typedef struct environmentData * ENVIRONMENT_DATA_PTR;
    LOCALE void                          *SetEnvironmentFunctionContext(void *,EXEC_STATUS,void *);
    LOCALE void                          *GetEnvironmentCallbackContext(void *);
    LOCALE void                          *SetEnvironmentCallbackContext(void *,EXEC_STATUS,void *);
+   LOCALE unsigned int                   EnvGetMatcherThreads(void *,EXEC_STATUS);
+   LOCALE unsigned int                   EnvSetMatcherThreads(void *,EXEC_STATUS,unsigned int);
+   LOCALE unsigned int                   EnvGetFactThreads(void *,EXEC_STATUS);
+   LOCALE unsigned int                   EnvSetFactThreads(void *,EXEC_STATUS,unsigned int);
 
 #endif
 
@@ -13,6 +13,13 @@
 
 # include "expression.h"
 
+struct fact;
+struct multifieldMarker;
+struct matchWorker;
+struct memoryCache;
+struct joinProfileFrame;
+struct threadEphemerons;
+
 // STEFAN: new additional parameter that needs to be passed around similar to
 //         theEnv. But needs to be handled independently for different threads.
 struct executionStatus
@@ -22,18 +29,39 @@ struct executionStatus
   intBool      HaltExecution;
   int          CurrentEvaluationDepth;
   intBool      RunningInParallel;
-  int          DepthInReteNetwork;
+  struct matchWorker *MatchWorker;
   
   struct localEngineData {
     struct partialMatch *LHSBinds;
     struct partialMatch *RHSBinds;
+    struct joinNode     *GlobalJoin;
   } LocalEngineData;
+  
+  // The fact (and its multifield markers) currently matched against the
+  // pattern network. Kept per thread since every match task has its own.
+  struct localFactsData {
+    struct fact             *CurrentPatternFact;
+    struct multifieldMarker *CurrentPatternMarks;
+  } LocalFactsData;
+  
+  // Free memory blocks recycled by this thread without taking the lock of
+  // the shared memory table. Created on first use, see memalloc.c.
+  struct memoryCache *MemoryCache;
+  
+  // The join being profiled on this thread, which is charged with the
+  // time until another join is entered, see StartJoinProfile.
+  struct joinProfileFrame *ActiveJoinProfile;
+  
+  // The atoms left without references by this thread while it shares the
+  // atom tables with the thread running the environment, see EnterAtomTables.
+  struct threadEphemerons *Ephemerons;
 };
 
 // STEFAN: parameter macro for the new executionStatus
 #define EXEC_STATUS struct executionStatus* execStatus
 
 #define LocalEngineData(theEnv,execStatus) (execStatus->LocalEngineData)
+#define LocalFactsData(theEnv,execStatus) (execStatus->LocalFactsData)
 
 
 #endif
@@ -0,0 +1,1101 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                FACT BINARY FILE MODULE              */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Provides the save-facts-binary and               */
+/*   load-facts-binary commands. A binary fact file starts   */
+/*   with the symbols, floats and integers used by the saved */
+/*   facts, as written by bsave, followed by records of      */
+/*   consecutive facts sharing a deftemplate whose slot      */
+/*   values refer to those atoms by index. Loading a file    */
+/*   builds each fact directly from its record and asserts   */
+/*   it, without parsing or evaluating an assert command.    */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _FACTBFIL_SOURCE_
+
+#include <stdio.h>
+#define _STDIO_INCLUDED_
+#include <string.h>
+
+#include "setup.h"
+
+#if DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT && (BLOAD_FACTS || BSAVE_FACTS)
+
+#include "argacces.h"
+#include "bload.h"
+#include "constrct.h"
+#include "envrnmnt.h"
+#include "extnfunc.h"
+#include "filecom.h"
+#include "memalloc.h"
+#include "modulutl.h"
+#include "multifld.h"
+#include "prntutil.h"
+#include "router.h"
+#include "symblbin.h"
+#include "sysdep.h"
+#include "tmpltdef.h"
+#include "tmpltutl.h"
+#include "utility.h"
+
+#if OBJECT_SYSTEM
+#include "insmngr.h"
+#endif
+
+#include "fact_manager.h"
+#include "fact_command.h"
+#include "fact_binfile.h"
+
+/*=====================================================*/
+/* Bytes of the record being written or read, and the  */
+/* position of the next byte to decode. The buffer     */
+/* only grows, so a file with millions of facts is     */
+/* handled with a few allocations.                     */
+/*=====================================================*/
+
+struct factBinaryBuffer
+  {
+   unsigned char *bytes;
+   unsigned long size;
+   unsigned long used;
+   unsigned long position;
+  };
+
+/*===================================================*/
+/* Largest number of bytes taken by a count or index */
+/* stored seven bits per byte.                       */
+/*===================================================*/
+
+#define MAX_BINARY_NUMBER_SIZE ((sizeof(unsigned long) * 8 + 6) / 7)
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static void                    ReserveFactBinaryBuffer(void *,EXEC_STATUS,struct factBinaryBuffer *,unsigned long);
+   static void                    FreeFactBinaryBuffer(void *,EXEC_STATUS,struct factBinaryBuffer *);
+#if BSAVE_FACTS
+   static intBool                 FactIsSaved(struct fact *,int,struct defmodule *,
+                                              DATA_OBJECT_PTR,int,struct expr *);
+   static SYMBOL_HN              *AddressToSymbol(void *,EXEC_STATUS,int,void *,unsigned short *);
+   static void                    MarkNeededFactAtom(void *,EXEC_STATUS,int,void *);
+   static void                    PutBinaryNumber(struct factBinaryBuffer *,unsigned long);
+   static void                    PutBinaryAtom(void *,EXEC_STATUS,struct factBinaryBuffer *,int,void *);
+   static void                    EncodeBinaryFact(void *,EXEC_STATUS,struct factBinaryBuffer *,struct fact *);
+   static void                    WriteFactRecord(FILE *,struct fact *,unsigned long,struct factBinaryBuffer *);
+#endif
+#if BLOAD_FACTS
+   static intBool                 VerifyFactBinaryHeader(void *,EXEC_STATUS,char *);
+   static struct deftemplate     *FindRecordDeftemplate(void *,EXEC_STATUS,SYMBOL_HN *,int);
+   static long                    LoadFactRecord(void *,EXEC_STATUS,struct bsaveFactRecord *,
+                                                 struct factBinaryBuffer *,long);
+   static intBool                 GetBinaryNumber(struct factBinaryBuffer *,unsigned long *);
+   static intBool                 GetBinaryFactValue(void *,EXEC_STATUS,struct factBinaryBuffer *,struct field *);
+   static void                    BinaryLoadFactError(void *,EXEC_STATUS,struct deftemplate *,SYMBOL_HN *);
+#endif
+
+/****************************************************/
+/* FactBinaryFileDefinitions: Defines the commands  */
+/*   for saving and loading facts in binary format. */
+/****************************************************/
+globle void FactBinaryFileDefinitions(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+#if ! RUN_TIME
+#if BSAVE_FACTS
+   EnvDefineFunction2(theEnv,execStatus,"save-facts-binary",'g',PTIEF SaveFactsBinaryCommand,
+                      "SaveFactsBinaryCommand","1*wk");
+#endif
+#if BLOAD_FACTS
+   EnvDefineFunction2(theEnv,execStatus,"load-facts-binary",'g',PTIEF LoadFactsBinaryCommand,
+                      "LoadFactsBinaryCommand","11k");
+#endif
+#else
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus)
+#endif
+#endif
+  }
+
+/*******************************************************/
+/* ReserveFactBinaryBuffer: Makes sure that the buffer */
+/*   has room for the given number of bytes beyond the */
+/*   bytes already in use.                             */
+/*******************************************************/
+static void ReserveFactBinaryBuffer(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factBinaryBuffer *theBuffer,
+  unsigned long needed)
+  {
+   unsigned long newSize;
+   unsigned char *newBytes;
+
+   if (theBuffer->used + needed <= theBuffer->size) return;
+
+   newSize = theBuffer->size * 2;
+   if (newSize < theBuffer->used + needed) newSize = theBuffer->used + needed;
+   if (newSize < 4096) newSize = 4096;
+
+   newBytes = (unsigned char *) genalloc(theEnv,execStatus,newSize);
+   if (theBuffer->bytes != NULL)
+     {
+      memcpy(newBytes,theBuffer->bytes,theBuffer->used);
+      genfree(theEnv,execStatus,theBuffer->bytes,theBuffer->size);
+     }
+
+   theBuffer->bytes = newBytes;
+   theBuffer->size = newSize;
+  }
+
+/**************************************************/
+/* FreeFactBinaryBuffer: Frees the bytes used to  */
+/*   write or read records.                       */
+/**************************************************/
+static void FreeFactBinaryBuffer(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factBinaryBuffer *theBuffer)
+  {
+   if (theBuffer->bytes != NULL)
+     { genfree(theEnv,execStatus,theBuffer->bytes,theBuffer->size); }
+
+   theBuffer->bytes = NULL;
+   theBuffer->size = 0;
+   theBuffer->used = 0;
+  }
+
+#if BSAVE_FACTS
+
+/***************************************************/
+/* SaveFactsBinaryCommand: H/L access routine for  */
+/*   the save-facts-binary command. Returns the    */
+/*   number of facts saved or -1 on an error.      */
+/*   Syntax: (save-facts-binary <file>             */
+/*             [local | visible [<template>+]])    */
+/***************************************************/
+globle long SaveFactsBinaryCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   char *fileName;
+   int numArgs, saveCode = LOCAL_SAVE;
+   char *argument;
+   DATA_OBJECT theValue;
+   struct expr *theList = NULL;
+
+   if ((numArgs = EnvArgCountCheck(theEnv,execStatus,"save-facts-binary",AT_LEAST,1)) == -1) return(-1L);
+
+   if ((fileName = GetFileName(theEnv,execStatus,"save-facts-binary",1)) == NULL) return(-1L);
+
+   /*========================================*/
+   /* The optional arguments are the same as */
+   /* those of the save-facts command.       */
+   /*========================================*/
+
+   if (numArgs > 1)
+     {
+      if (EnvArgTypeCheck(theEnv,execStatus,"save-facts-binary",2,SYMBOL,&theValue) == FALSE) return(-1L);
+
+      argument = DOToString(theValue);
+
+      if (strcmp(argument,"local") == 0)
+        { saveCode = LOCAL_SAVE; }
+      else if (strcmp(argument,"visible") == 0)
+        { saveCode = VISIBLE_SAVE; }
+      else
+        {
+         ExpectedTypeError1(theEnv,execStatus,"save-facts-binary",2,"symbol with value local or visible");
+         return(-1L);
+        }
+     }
+
+   if (numArgs > 2) theList = GetFirstArgument()->nextArg->nextArg;
+
+   return(EnvSaveFactsBinary(theEnv,execStatus,fileName,saveCode,theList));
+  }
+
+/****************************************************/
+/* EnvSaveFactsBinary: C access routine for the     */
+/*   save-facts-binary command. The facts are       */
+/*   visited twice: once to mark the atoms they use */
+/*   and once to write them after the atom tables.  */
+/****************************************************/
+globle long EnvSaveFactsBinary(
+  void *theEnv,
+  EXEC_STATUS,
+  char *fileName,
+  int saveCode,
+  struct expr *theList)
+  {
+   struct fact *theFact, *firstFact = NULL;
+   struct defmodule *theModule;
+   struct deftemplate *lastTemplate = NULL;
+   struct templateSlot *slotPtr;
+   DATA_OBJECT_PTR theDOArray;
+   struct factBinaryBuffer theBuffer;
+   struct bsaveFactRecord endRecord;
+   FILE *filePtr;
+   int count, error;
+   unsigned long i, factCount = 0, runCount = 0;
+   struct field *theField;
+   struct multifield *theSegment;
+   long j;
+
+   /*===================================================*/
+   /* Determine the list of specific facts to be saved. */
+   /*===================================================*/
+
+   theDOArray = GetSaveFactsDeftemplateNames(theEnv,execStatus,theList,saveCode,&count,&error);
+   if (error) return(-1L);
+
+   theModule = ((struct defmodule *) EnvGetCurrentModule(theEnv,execStatus));
+
+   /*==============================================*/
+   /* Mark the atoms used by the facts to be       */
+   /* saved, including deftemplate and slot names. */
+   /*==============================================*/
+
+   EnvIncrementGCLocks(theEnv,execStatus);
+   InitAtomicValueNeededFlags(theEnv,execStatus);
+
+   for (theFact = (struct fact *) GetNextFactInScope(theEnv,execStatus,NULL);
+        theFact != NULL;
+        theFact = (struct fact *) GetNextFactInScope(theEnv,execStatus,theFact))
+     {
+      if (! FactIsSaved(theFact,saveCode,theModule,theDOArray,count,theList)) continue;
+
+      factCount++;
+      if (theFact->whichDeftemplate != lastTemplate)
+        {
+         lastTemplate = theFact->whichDeftemplate;
+         lastTemplate->header.name->neededSymbol = TRUE;
+         for (slotPtr = lastTemplate->slotList; slotPtr != NULL; slotPtr = slotPtr->next)
+           { slotPtr->slotName->neededSymbol = TRUE; }
+        }
+
+      theField = theFact->theProposition.theFields;
+      for (i = 0; i < theFact->theProposition.multifieldLength; i++)
+        {
+         if (theField[i].type == MULTIFIELD)
+           {
+            theSegment = (struct multifield *) theField[i].value;
+            for (j = 0; j < theSegment->multifieldLength; j++)
+              { MarkNeededFactAtom(theEnv,execStatus,theSegment->theFields[j].type,theSegment->theFields[j].value); }
+           }
+         else
+           { MarkNeededFactAtom(theEnv,execStatus,theField[i].type,theField[i].value); }
+        }
+     }
+
+   /*================*/
+   /* Open the file. */
+   /*================*/
+
+   if ((filePtr = GenOpen(theEnv,execStatus,fileName,"wb")) == NULL)
+     {
+      OpenErrorMessage(theEnv,execStatus,"save-facts-binary",fileName);
+      if (theList != NULL) rm3(theEnv,execStatus,theDOArray,(long) sizeof(DATA_OBJECT) * count);
+      EnvDecrementGCLocks(theEnv,execStatus);
+      return(-1L);
+     }
+
+   /*=====================================================*/
+   /* Write the header, the atom tables and the number of */
+   /* facts which follow.                                 */
+   /*=====================================================*/
+
+   GenWrite((void *) FACT_BINARY_PREFIX_ID,(unsigned long) (strlen(FACT_BINARY_PREFIX_ID) + 1),filePtr);
+   GenWrite((void *) FACT_BINARY_VERSION_ID,(unsigned long) (strlen(FACT_BINARY_VERSION_ID) + 1),filePtr);
+   WriteNeededAtomicValues(theEnv,execStatus,filePtr);
+   GenWrite(&factCount,(unsigned long) sizeof(unsigned long),filePtr);
+
+   /*==============================================*/
+   /* Write the facts, starting a new record       */
+   /* whenever the deftemplate changes or the      */
+   /* record holds FACT_BINARY_RECORD_FACTS facts. */
+   /*==============================================*/
+
+   SetAtomicValueIndices(theEnv,execStatus,FALSE);
+
+   memset(&theBuffer,0,sizeof(struct factBinaryBuffer));
+
+   for (theFact = (struct fact *) GetNextFactInScope(theEnv,execStatus,NULL);
+        theFact != NULL;
+        theFact = (struct fact *) GetNextFactInScope(theEnv,execStatus,theFact))
+     {
+      if (! FactIsSaved(theFact,saveCode,theModule,theDOArray,count,theList)) continue;
+
+      if ((firstFact != NULL) &&
+          ((theFact->whichDeftemplate != firstFact->whichDeftemplate) ||
+           (runCount == FACT_BINARY_RECORD_FACTS)))
+        {
+         WriteFactRecord(filePtr,firstFact,runCount,&theBuffer);
+         firstFact = NULL;
+        }
+
+      if (firstFact == NULL)
+        {
+         firstFact = theFact;
+         runCount = 0;
+        }
+
+      EncodeBinaryFact(theEnv,execStatus,&theBuffer,theFact);
+      runCount++;
+     }
+
+   if (firstFact != NULL)
+     { WriteFactRecord(filePtr,firstFact,runCount,&theBuffer); }
+
+   endRecord.templateName = -1L;
+   endRecord.slotCount = 0;
+   endRecord.implied = 0;
+   endRecord.factCount = 0;
+   endRecord.dataSize = 0;
+   GenWrite(&endRecord,(unsigned long) sizeof(struct bsaveFactRecord),filePtr);
+
+   RestoreAtomicValueBuckets(theEnv,execStatus);
+   FreeFactBinaryBuffer(theEnv,execStatus,&theBuffer);
+   EnvDecrementGCLocks(theEnv,execStatus);
+
+   /*=========================================*/
+   /* Close the file and free the deftemplate */
+   /* name array.                             */
+   /*=========================================*/
+
+   GenClose(theEnv,execStatus,filePtr);
+
+   if (theList != NULL) rm3(theEnv,execStatus,theDOArray,(long) sizeof(DATA_OBJECT) * count);
+
+   return((long) factCount);
+  }
+
+/*******************************************************/
+/* FactIsSaved: Determines whether a fact is saved by  */
+/*   save-facts-binary, following the same rules as    */
+/*   save-facts for local saves and deftemplate lists. */
+/*******************************************************/
+static intBool FactIsSaved(
+  struct fact *theFact,
+  int saveCode,
+  struct defmodule *theModule,
+  DATA_OBJECT_PTR theDOArray,
+  int count,
+  struct expr *theList)
+  {
+   int i;
+
+   if ((saveCode == LOCAL_SAVE) &&
+       (theFact->whichDeftemplate->header.whichModule->theModule != theModule))
+     { return(FALSE); }
+
+   if (theList == NULL) return(TRUE);
+
+   for (i = 0; i < count; i++)
+     {
+      if (theDOArray[i].value == (void *) theFact->whichDeftemplate)
+        { return(TRUE); }
+     }
+
+   return(FALSE);
+  }
+
+/*********************************************************/
+/* AddressToSymbol: Returns the symbol which replaces an */
+/*   address in a saved fact. As with save-facts, an     */
+/*   instance address is saved as the instance name and  */
+/*   any other address as its printed form in a string.  */
+/*********************************************************/
+static SYMBOL_HN *AddressToSymbol(
+  void *theEnv,
+  EXEC_STATUS,
+  int type,
+  void *value,
+  unsigned short *newType)
+  {
+   DATA_OBJECT theValue;
+
+#if OBJECT_SYSTEM
+   if (type == INSTANCE_ADDRESS)
+     {
+      *newType = INSTANCE_NAME;
+      return(GetFullInstanceName(theEnv,execStatus,(INSTANCE_TYPE *) value));
+     }
+#endif
+
+   theValue.type = (unsigned short) type;
+   theValue.value = value;
+   *newType = STRING;
+   return((SYMBOL_HN *) EnvAddSymbol(theEnv,execStatus,DataObjectToString(theEnv,execStatus,&theValue)));
+  }
+
+/*********************************************************/
+/* MarkNeededFactAtom: Marks a slot value of a saved     */
+/*   fact as needed in the atom tables of the file.      */
+/*********************************************************/
+static void MarkNeededFactAtom(
+  void *theEnv,
+  EXEC_STATUS,
+  int type,
+  void *value)
+  {
+   unsigned short newType;
+
+   switch (type)
+     {
+      case SYMBOL:
+      case STRING:
+      case INSTANCE_NAME:
+        ((SYMBOL_HN *) value)->neededSymbol = TRUE;
+        break;
+
+      case FLOAT:
+        ((FLOAT_HN *) value)->neededFloat = TRUE;
+        break;
+
+      case INTEGER:
+        ((INTEGER_HN *) value)->neededInteger = TRUE;
+        break;
+
+      default:
+        AddressToSymbol(theEnv,execStatus,type,value,&newType)->neededSymbol = TRUE;
+        break;
+     }
+  }
+
+/*****************************************************/
+/* PutBinaryNumber: Appends a count or atom index to */
+/*   the buffer, seven bits per byte.                */
+/*****************************************************/
+static void PutBinaryNumber(
+  struct factBinaryBuffer *theBuffer,
+  unsigned long theNumber)
+  {
+   while (theNumber >= 0x80)
+     {
+      theBuffer->bytes[theBuffer->used++] = (unsigned char) ((theNumber & 0x7F) | 0x80);
+      theNumber >>= 7;
+     }
+
+   theBuffer->bytes[theBuffer->used++] = (unsigned char) theNumber;
+  }
+
+/*********************************************************/
+/* PutBinaryAtom: Appends the type under which a slot    */
+/*   value is saved and its index in the atom tables.    */
+/*********************************************************/
+static void PutBinaryAtom(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factBinaryBuffer *theBuffer,
+  int type,
+  void *value)
+  {
+   unsigned short savedType = (unsigned short) type;
+   unsigned long index;
+
+   switch (type)
+     {
+      case SYMBOL:
+      case STRING:
+      case INSTANCE_NAME:
+        index = ((SYMBOL_HN *) value)->bucket;
+        break;
+
+      case FLOAT:
+        index = ((FLOAT_HN *) value)->bucket;
+        break;
+
+      case INTEGER:
+        index = ((INTEGER_HN *) value)->bucket;
+        break;
+
+      default:
+        index = AddressToSymbol(theEnv,execStatus,type,value,&savedType)->bucket;
+        break;
+     }
+
+   theBuffer->bytes[theBuffer->used++] = (unsigned char) savedType;
+   PutBinaryNumber(theBuffer,index);
+  }
+
+/*******************************************************/
+/* EncodeBinaryFact: Appends the value counts and the  */
+/*   values of a fact's slots to the record buffer.    */
+/*******************************************************/
+static void EncodeBinaryFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factBinaryBuffer *theBuffer,
+  struct fact *theFact)
+  {
+   unsigned long slotCount = theFact->theProposition.multifieldLength;
+   unsigned long i, valueCount = 0;
+   struct field *theField = theFact->theProposition.theFields;
+   struct multifield *theSegment;
+   long j;
+
+   for (i = 0; i < slotCount; i++)
+     {
+      if (theField[i].type == MULTIFIELD)
+        { valueCount += (unsigned long) ((struct multifield *) theField[i].value)->multifieldLength; }
+      else
+        { valueCount++; }
+     }
+
+   ReserveFactBinaryBuffer(theEnv,execStatus,theBuffer,
+                           (slotCount + valueCount) * MAX_BINARY_NUMBER_SIZE + valueCount);
+
+   for (i = 0; i < slotCount; i++)
+     {
+      if (theField[i].type == MULTIFIELD)
+        {
+         theSegment = (struct multifield *) theField[i].value;
+         PutBinaryNumber(theBuffer,(unsigned long) theSegment->multifieldLength);
+         for (j = 0; j < theSegment->multifieldLength; j++)
+           { PutBinaryAtom(theEnv,execStatus,theBuffer,theSegment->theFields[j].type,theSegment->theFields[j].value); }
+        }
+      else
+        {
+         PutBinaryNumber(theBuffer,1);
+         PutBinaryAtom(theEnv,execStatus,theBuffer,theField[i].type,theField[i].value);
+        }
+     }
+  }
+
+/*******************************************************/
+/* WriteFactRecord: Writes a record for a run of facts */
+/*   sharing the deftemplate of its first fact and     */
+/*   empties the record buffer.                        */
+/*******************************************************/
+static void WriteFactRecord(
+  FILE *filePtr,
+  struct fact *firstFact,
+  unsigned long runCount,
+  struct factBinaryBuffer *theBuffer)
+  {
+   struct deftemplate *theDeftemplate = firstFact->whichDeftemplate;
+   struct bsaveFactRecord theRecord;
+   struct templateSlot *slotPtr;
+   long slotName;
+
+   theRecord.templateName = (long) theDeftemplate->header.name->bucket;
+   theRecord.slotCount = (long) firstFact->theProposition.multifieldLength;
+   theRecord.implied = (long) theDeftemplate->implied;
+   theRecord.factCount = runCount;
+   theRecord.dataSize = theBuffer->used;
+   GenWrite(&theRecord,(unsigned long) sizeof(struct bsaveFactRecord),filePtr);
+
+   if (theDeftemplate->implied)
+     {
+      slotName = -1L;
+      GenWrite(&slotName,(unsigned long) sizeof(long),filePtr);
+     }
+   else
+     {
+      for (slotPtr = theDeftemplate->slotList; slotPtr != NULL; slotPtr = slotPtr->next)
+        {
+         slotName = (long) slotPtr->slotName->bucket;
+         GenWrite(&slotName,(unsigned long) sizeof(long),filePtr);
+        }
+     }
+
+   if (theBuffer->used > 0)
+     { GenWrite(theBuffer->bytes,theBuffer->used,filePtr); }
+   theBuffer->used = 0;
+  }
+
+#endif /* BSAVE_FACTS */
+
+#if BLOAD_FACTS
+
+/***************************************************/
+/* LoadFactsBinaryCommand: H/L access routine for  */
+/*   the load-facts-binary command. Returns the    */
+/*   number of facts loaded or -1 on an error.     */
+/*   Syntax: (load-facts-binary <file>)            */
+/***************************************************/
+globle long LoadFactsBinaryCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   char *fileName;
+
+   if (EnvArgCountCheck(theEnv,execStatus,"load-facts-binary",EXACTLY,1) == -1) return(-1L);
+
+   if ((fileName = GetFileName(theEnv,execStatus,"load-facts-binary",1)) == NULL) return(-1L);
+
+   return(EnvLoadFactsBinary(theEnv,execStatus,fileName));
+  }
+
+/*****************************************************/
+/* EnvLoadFactsBinary: C access routine for the      */
+/*   load-facts-binary command. Each record is read  */
+/*   with a single read and its facts are asserted   */
+/*   as they are decoded.                            */
+/*****************************************************/
+globle long EnvLoadFactsBinary(
+  void *theEnv,
+  EXEC_STATUS,
+  char *fileName)
+  {
+   unsigned long factCount;
+   struct factBinaryBuffer theBuffer;
+   struct bsaveFactRecord theRecord;
+   long loaded, total = 0, fileSize;
+
+   /*======================================*/
+   /* Open the file and verify its header. */
+   /*======================================*/
+
+   if (GenOpenReadBinary(theEnv,execStatus,"load-facts-binary",fileName) == 0)
+     {
+      SetEvaluationError(theEnv,execStatus,TRUE);
+      return(-1L);
+     }
+
+   if (VerifyFactBinaryHeader(theEnv,execStatus,fileName) == FALSE)
+     {
+      GenCloseBinary(theEnv,execStatus);
+      SetEvaluationError(theEnv,execStatus,TRUE);
+      return(-1L);
+     }
+
+   /*===============================================*/
+   /* Read the atom tables. The atoms are protected */
+   /* from garbage collection until the facts using */
+   /* them have been asserted.                      */
+   /*===============================================*/
+
+   GenSizeBinary(theEnv,execStatus,&fileSize);
+
+   EnvIncrementGCLocks(theEnv,execStatus);
+   ReadNeededAtomicValues(theEnv,execStatus);
+
+   GenReadBinary(theEnv,execStatus,&factCount,(unsigned long) sizeof(unsigned long));
+
+   /*==========================================*/
+   /* Load the records up to the end record.   */
+   /*==========================================*/
+
+   memset(&theBuffer,0,sizeof(struct factBinaryBuffer));
+
+   while (TRUE)
+     {
+      theRecord.templateName = -1L;
+      GenReadBinary(theEnv,execStatus,&theRecord,(unsigned long) sizeof(struct bsaveFactRecord));
+      if (theRecord.templateName == -1L) break;
+
+      loaded = LoadFactRecord(theEnv,execStatus,&theRecord,&theBuffer,fileSize);
+      if (loaded < 0)
+        {
+         SetEvaluationError(theEnv,execStatus,TRUE);
+         break;
+        }
+      total += loaded;
+     }
+
+   FreeFactBinaryBuffer(theEnv,execStatus,&theBuffer);
+   FreeAtomicValueStorage(theEnv,execStatus);
+   GenCloseBinary(theEnv,execStatus);
+   EnvDecrementGCLocks(theEnv,execStatus);
+
+   if (execStatus->EvaluationError) return(-1L);
+   return(total);
+  }
+
+/******************************************************/
+/* VerifyFactBinaryHeader: Reads the prefix and       */
+/*   version of a file to verify that it is a binary  */
+/*   facts file which can be read by this version.    */
+/******************************************************/
+static intBool VerifyFactBinaryHeader(
+  void *theEnv,
+  EXEC_STATUS,
+  char *fileName)
+  {
+   char buf[20];
+
+   GenReadBinary(theEnv,execStatus,(void *) buf,(unsigned long) (strlen(FACT_BINARY_PREFIX_ID) + 1));
+   if (memcmp(buf,FACT_BINARY_PREFIX_ID,strlen(FACT_BINARY_PREFIX_ID) + 1) != 0)
+     {
+      PrintErrorID(theEnv,execStatus,"FACTBFIL",1,FALSE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,fileName);
+      EnvPrintRouter(theEnv,execStatus,WERROR," file is not a binary facts file.\n");
+      return(FALSE);
+     }
+
+   GenReadBinary(theEnv,execStatus,(void *) buf,(unsigned long) (strlen(FACT_BINARY_VERSION_ID) + 1));
+   if (memcmp(buf,FACT_BINARY_VERSION_ID,strlen(FACT_BINARY_VERSION_ID) + 1) != 0)
+     {
+      PrintErrorID(theEnv,execStatus,"FACTBFIL",2,FALSE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,fileName);
+      EnvPrintRouter(theEnv,execStatus,WERROR," file is not a compatible binary facts file.\n");
+      return(FALSE);
+     }
+
+   return(TRUE);
+  }
+
+/**********************************************************/
+/* FindRecordDeftemplate: Finds the deftemplate named by  */
+/*   a record in the scope of the current module. As with */
+/*   load-facts, an implied deftemplate is created if it  */
+/*   does not exist yet.                                  */
+/**********************************************************/
+static struct deftemplate *FindRecordDeftemplate(
+  void *theEnv,
+  EXEC_STATUS,
+  SYMBOL_HN *templateName,
+  int implied)
+  {
+   struct deftemplate *theDeftemplate;
+   int count;
+
+   theDeftemplate = (struct deftemplate *)
+                    FindImportedConstruct(theEnv,execStatus,"deftemplate",NULL,ValueToString(templateName),
+                                          &count,TRUE,NULL);
+
+   if (count > 1)
+     {
+      AmbiguousReferenceErrorMessage(theEnv,execStatus,"deftemplate",ValueToString(templateName));
+      return(NULL);
+     }
+
+   if (theDeftemplate != NULL) return(theDeftemplate);
+
+#if (! BLOAD_ONLY) && (! RUN_TIME)
+   if (implied)
+     {
+#if BLOAD || BLOAD_AND_BSAVE
+      if (! Bloaded(theEnv,execStatus))
+#endif
+        { return(CreateImpliedDeftemplate(theEnv,execStatus,templateName,TRUE)); }
+     }
+#endif
+
+   CantFindItemErrorMessage(theEnv,execStatus,"deftemplate",ValueToString(templateName));
+   return(NULL);
+  }
+
+/**********************************************************/
+/* LoadFactRecord: Reads a record and asserts its facts.  */
+/*   The slots of the record are matched to the slots of  */
+/*   the deftemplate by name, and any deftemplate slot    */
+/*   missing from the record receives its default value.  */
+/*   Returns the number of facts asserted, or -1 if the   */
+/*   record does not fit the deftemplate, names a slot    */
+/*   twice, or runs past the end of the file.             */
+/**********************************************************/
+static long LoadFactRecord(
+  void *theEnv,
+  EXEC_STATUS,
+  struct bsaveFactRecord *theRecord,
+  struct factBinaryBuffer *theBuffer,
+  long fileSize)
+  {
+   struct deftemplate *theDeftemplate;
+   struct templateSlot *slotPtr;
+   struct fact *theFact;
+   struct multifield *theSegment;
+   short *slotMap = NULL;
+   char *slotSeen = NULL;
+   long slotName, i, factSize, asserted = 0, filePosition;
+   unsigned long f, j, valueCount;
+   short position;
+   intBool missingSlots = FALSE, error = FALSE;
+
+   if ((theRecord->templateName < 0) ||
+       (theRecord->templateName >= SymbolData(theEnv,execStatus)->NumberOfSymbols) ||
+       (theRecord->slotCount < 0) ||
+       (theRecord->slotCount > 32767) ||
+       (theRecord->factCount > FACT_BINARY_RECORD_FACTS))
+     {
+      BinaryLoadFactError(theEnv,execStatus,NULL,NULL);
+      return(-1L);
+     }
+
+   theDeftemplate = FindRecordDeftemplate(theEnv,execStatus,SymbolPointer(theRecord->templateName),
+                                          (int) theRecord->implied);
+   if (theDeftemplate == NULL) return(-1L);
+
+   if ((theDeftemplate->implied ? TRUE : FALSE) != (theRecord->implied ? TRUE : FALSE))
+     {
+      BinaryLoadFactError(theEnv,execStatus,theDeftemplate,NULL);
+      return(-1L);
+     }
+
+   /*==========================================*/
+   /* Map the slots of the record to the slots */
+   /* of the deftemplate.                      */
+   /*==========================================*/
+
+   if (theDeftemplate->implied)
+     {
+      factSize = 1;
+      GenReadBinary(theEnv,execStatus,&slotName,(unsigned long) sizeof(long));
+      if (theRecord->slotCount != 1)
+        {
+         BinaryLoadFactError(theEnv,execStatus,theDeftemplate,NULL);
+         return(-1L);
+        }
+     }
+   else
+     {
+      factSize = (long) theDeftemplate->numberOfSlots;
+      if (theRecord->slotCount > 0)
+        { slotMap = (short *) gm3(theEnv,execStatus,(long) (sizeof(short) * theRecord->slotCount)); }
+      if (factSize > 0)
+        {
+         slotSeen = (char *) gm3(theEnv,execStatus,factSize);
+         memset(slotSeen,0,(size_t) factSize);
+        }
+
+      for (i = 0; i < theRecord->slotCount; i++)
+        {
+         GenReadBinary(theEnv,execStatus,&slotName,(unsigned long) sizeof(long));
+         if (error) continue;
+
+         if ((slotName < 0) || (slotName >= SymbolData(theEnv,execStatus)->NumberOfSymbols))
+           {
+            BinaryLoadFactError(theEnv,execStatus,NULL,NULL);
+            error = TRUE;
+           }
+         else if (((slotPtr = FindSlot(theDeftemplate,SymbolPointer(slotName),&position)) == NULL) ||
+                  slotSeen[position - 1])
+           {
+            BinaryLoadFactError(theEnv,execStatus,theDeftemplate,SymbolPointer(slotName));
+            error = TRUE;
+           }
+         else
+           {
+            slotMap[i] = (short) (position - 1);
+            slotSeen[position - 1] = TRUE;
+           }
+        }
+
+      if (slotSeen != NULL) rm3(theEnv,execStatus,slotSeen,factSize);
+
+      if (error)
+        {
+         if (slotMap != NULL) rm3(theEnv,execStatus,slotMap,(long) (sizeof(short) * theRecord->slotCount));
+         return(-1L);
+        }
+
+      if (theRecord->slotCount != factSize) missingSlots = TRUE;
+     }
+
+   /*==============================================*/
+   /* Read the facts of the record in one read, if */
+   /* the file holds as many bytes as the record.  */
+   /*==============================================*/
+
+   GenTellBinary(theEnv,execStatus,&filePosition);
+   if ((filePosition < 0) || (filePosition > fileSize) ||
+       (theRecord->dataSize > (unsigned long) (fileSize - filePosition)))
+     {
+      if (slotMap != NULL) rm3(theEnv,execStatus,slotMap,(long) (sizeof(short) * theRecord->slotCount));
+      BinaryLoadFactError(theEnv,execStatus,theDeftemplate,NULL);
+      return(-1L);
+     }
+
+   theBuffer->used = 0;
+   ReserveFactBinaryBuffer(theEnv,execStatus,theBuffer,theRecord->dataSize);
+   if (theRecord->dataSize > 0)
+     { GenReadBinary(theEnv,execStatus,theBuffer->bytes,theRecord->dataSize); }
+   theBuffer->used = theRecord->dataSize;
+   theBuffer->position = 0;
+
+   /*=====================================*/
+   /* Decode, build and assert the facts. */
+   /*=====================================*/
+
+   for (f = 0; (f < theRecord->factCount) && (! error); f++)
+     {
+      theFact = CreateFactBySize(theEnv,execStatus,(unsigned) factSize);
+      theFact->whichDeftemplate = theDeftemplate;
+      for (i = 0; i < factSize; i++)
+        { theFact->theProposition.theFields[i].type = RVOID; }
+
+      for (i = 0; (i < theRecord->slotCount) && (! error); i++)
+        {
+         position = (short) (theDeftemplate->implied ? 0 : slotMap[i]);
+
+         if (! GetBinaryNumber(theBuffer,&valueCount))
+           { error = TRUE; }
+
+         /*=====================================*/
+         /* A multifield value for the implied  */
+         /* multifield slot or for a multislot. */
+         /*=====================================*/
+
+         else if (theDeftemplate->implied || GetNthSlot(theDeftemplate,position)->multislot)
+           {
+            if (valueCount > theBuffer->used - theBuffer->position)
+              {
+               error = TRUE;
+               continue;
+              }
+
+            theSegment = (struct multifield *) CreateMultifield2(theEnv,execStatus,(long) valueCount);
+            for (j = 0; (j < valueCount) && (! error); j++)
+              {
+               if (! GetBinaryFactValue(theEnv,execStatus,theBuffer,&theSegment->theFields[j]))
+                 { error = TRUE; }
+              }
+
+            if (error)
+              { ReturnMultifield(theEnv,execStatus,theSegment); }
+            else
+              {
+               theFact->theProposition.theFields[position].type = MULTIFIELD;
+               theFact->theProposition.theFields[position].value = (void *) theSegment;
+              }
+           }
+
+         /*============================*/
+         /* A value for a single slot. */
+         /*============================*/
+
+         else if ((valueCount != 1) ||
+                  (! GetBinaryFactValue(theEnv,execStatus,theBuffer,&theFact->theProposition.theFields[position])))
+           { error = TRUE; }
+        }
+
+      if (error)
+        {
+         ReturnFact(theEnv,execStatus,theFact);
+         BinaryLoadFactError(theEnv,execStatus,theDeftemplate,NULL);
+         break;
+        }
+
+      if (missingSlots) EnvAssignFactSlotDefaults(theEnv,execStatus,theFact);
+
+      if (EnvAssert(theEnv,execStatus,(void *) theFact,FALSE) != NULL)
+        { asserted++; }
+     }
+
+   if (slotMap != NULL) rm3(theEnv,execStatus,slotMap,(long) (sizeof(short) * theRecord->slotCount));
+
+   if (error) return(-1L);
+   return(asserted);
+  }
+
+/****************************************************/
+/* GetBinaryNumber: Decodes a count or atom index   */
+/*   stored seven bits per byte. Returns FALSE if   */
+/*   the number runs past the end of the record.    */
+/****************************************************/
+static intBool GetBinaryNumber(
+  struct factBinaryBuffer *theBuffer,
+  unsigned long *theNumber)
+  {
+   unsigned long value = 0;
+   unsigned int shift = 0;
+   unsigned char theByte;
+
+   do
+     {
+      if ((theBuffer->position >= theBuffer->used) ||
+          (shift >= sizeof(unsigned long) * 8))
+        { return(FALSE); }
+
+      theByte = theBuffer->bytes[theBuffer->position++];
+      value |= ((unsigned long) (theByte & 0x7F)) << shift;
+      shift += 7;
+     }
+   while (theByte & 0x80);
+
+   *theNumber = value;
+   return(TRUE);
+  }
+
+/*******************************************************/
+/* GetBinaryFactValue: Decodes the type and atom table */
+/*   index of a value and stores the atom in a field.  */
+/*   Returns FALSE if the type or index is invalid.    */
+/*******************************************************/
+static intBool GetBinaryFactValue(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factBinaryBuffer *theBuffer,
+  struct field *theField)
+  {
+   unsigned short type;
+   unsigned long value;
+
+   if (theBuffer->position >= theBuffer->used) return(FALSE);
+   type = theBuffer->bytes[theBuffer->position++];
+   if (! GetBinaryNumber(theBuffer,&value)) return(FALSE);
+
+   switch (type)
+     {
+      case SYMBOL:
+      case STRING:
+      case INSTANCE_NAME:
+        if (value >= (unsigned long) SymbolData(theEnv,execStatus)->NumberOfSymbols) return(FALSE);
+        theField->value = (void *) SymbolPointer(value);
+        break;
+
+      case FLOAT:
+        if (value >= (unsigned long) SymbolData(theEnv,execStatus)->NumberOfFloats) return(FALSE);
+        theField->value = (void *) FloatPointer(value);
+        break;
+
+      case INTEGER:
+        if (value >= (unsigned long) SymbolData(theEnv,execStatus)->NumberOfIntegers) return(FALSE);
+        theField->value = (void *) IntegerPointer(value);
+        break;
+
+      default:
+        return(FALSE);
+     }
+
+   theField->type = type;
+   return(TRUE);
+  }
+
+/*******************************************************/
+/* BinaryLoadFactError: Prints the error message for a */
+/*   record which can not be loaded.                   */
+/*******************************************************/
+static void BinaryLoadFactError(
+  void *theEnv,
+  EXEC_STATUS,
+  struct deftemplate *theDeftemplate,
+  SYMBOL_HN *slotName)
+  {
+   PrintErrorID(theEnv,execStatus,"FACTBFIL",3,FALSE);
+   EnvPrintRouter(theEnv,execStatus,WERROR,"Function load-facts-binary unable to load ");
+   if (theDeftemplate == NULL)
+     { EnvPrintRouter(theEnv,execStatus,WERROR,"a corrupted record.\n"); }
+   else
+     {
+      EnvPrintRouter(theEnv,execStatus,WERROR,"facts of deftemplate ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,ValueToString(theDeftemplate->header.name));
+      if (slotName != NULL)
+        {
+         EnvPrintRouter(theEnv,execStatus,WERROR," with slot ");
+         EnvPrintRouter(theEnv,execStatus,WERROR,ValueToString(slotName));
+        }
+      EnvPrintRouter(theEnv,execStatus,WERROR,".\n");
+     }
+  }
+
+#endif /* BLOAD_FACTS */
+
+#endif /* DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT && (BLOAD_FACTS || BSAVE_FACTS) */
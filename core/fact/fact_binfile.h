@@ -0,0 +1,96 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*             FACT BINARY FILE HEADER FILE            */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Saves facts to and loads facts from binary       */
+/*   files with the save-facts-binary and load-facts-binary  */
+/*   commands.                                               */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_factbfil
+
+#define _H_factbfil
+
+#ifndef _H_evaluatn
+#include "evaluatn.h"
+#endif
+#ifndef _H_expressn
+#include "expressn.h"
+#endif
+
+# include "execution_status.h"
+
+/*=====================================================*/
+/* The version identifier changes whenever the layout  */
+/* of the records below changes. Files are only        */
+/* portable between builds with the same type sizes    */
+/* and byte order, as for bsave and bsave-instances.   */
+/*=====================================================*/
+
+#define FACT_BINARY_PREFIX_ID  "\5\6\7FACTS"
+#define FACT_BINARY_VERSION_ID "V1.00"
+
+/*====================================================*/
+/* Number of facts after which a run of facts sharing */
+/* a deftemplate is continued in a new record.        */
+/*====================================================*/
+
+#define FACT_BINARY_RECORD_FACTS 4096
+
+/************************************************************/
+/* BSAVEFACTRECORD STRUCTURE: Starts a run of consecutive   */
+/*   facts of one deftemplate. It is followed by the symbol */
+/*   indices of the slot names (-1 for the multifield of an */
+/*   implied deftemplate) and by dataSize bytes holding the */
+/*   facts. For every slot of a fact the number of values   */
+/*   is stored, followed by the type (one byte) and atom    */
+/*   table index of each value. Counts and indices are      */
+/*   stored seven bits per byte, low bits first, with the   */
+/*   high bit set in all but the last byte. A record with a */
+/*   templateName of -1 ends the file.                      */
+/************************************************************/
+struct bsaveFactRecord
+  {
+   long templateName;
+   long slotCount;
+   long implied;
+   unsigned long factCount;
+   unsigned long dataSize;
+  };
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _FACTBFIL_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+#define SaveFactsBinary(a,b,c) EnvSaveFactsBinary(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b,c)
+#define LoadFactsBinary(a) EnvLoadFactsBinary(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
+
+   LOCALE void                           FactBinaryFileDefinitions(void *,EXEC_STATUS);
+#if BSAVE_FACTS
+   LOCALE long                           SaveFactsBinaryCommand(void *,EXEC_STATUS);
+   LOCALE long                           EnvSaveFactsBinary(void *,EXEC_STATUS,char *,int,struct expr *);
+#endif
+#if BLOAD_FACTS
+   LOCALE long                           LoadFactsBinaryCommand(void *,EXEC_STATUS);
+   LOCALE long                           EnvLoadFactsBinary(void *,EXEC_STATUS,char *);
+#endif
+
+#endif
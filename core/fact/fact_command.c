@@ -63,12 +63,12 @@
 #endif
 
 #include "fact_command.h"
+#include "fact_events.h"
+#include "fact_loader.h"
 
 #define INVALID     -2L
 #define UNSPECIFIED -1L
 
-# include <assert.h>
-# include <unistd.h>
 
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
@@ -76,12 +76,13 @@
 
 #if (! RUN_TIME)
    static struct expr            *AssertParse(void *,EXEC_STATUS,struct expr *,char *);
+   static struct expr            *AssertBatchParse(void *,EXEC_STATUS,struct expr *,char *);
 #endif
+   static struct fact            *BuildAssertedFact(void *,EXEC_STATUS,struct expr *);
 #if DEBUGGING_FUNCTIONS
    static long long               GetFactsArgument(void *,EXEC_STATUS,int,int);
 #endif
    static struct expr            *StandardLoadFact(void *,EXEC_STATUS,char *,struct token *);
-   static DATA_OBJECT_PTR         GetSaveFactsDeftemplateNames(void *,EXEC_STATUS,struct expr *,int,int *,int *);
 
 /***************************************/
 /* FactCommandDefinitions: Initializes */
@@ -97,6 +98,7 @@ globle void FactCommandDefinitions(
 #endif
 
    EnvDefineFunction(theEnv,execStatus,"assert", 'u', PTIEF AssertCommand,  "AssertCommand");
+   EnvDefineFunction(theEnv,execStatus,"assert-batch", 'g', PTIEF AssertBatchCommand,  "AssertBatchCommand");
    EnvDefineFunction2(theEnv,execStatus,"retract", 'v', PTIEF RetractCommand, "RetractCommand","1*z");
    EnvDefineFunction2(theEnv,execStatus,"assert-string", 'u', PTIEF AssertStringFunction,   "AssertStringFunction", "11s");
    EnvDefineFunction2(theEnv,execStatus,"str-assert", 'u', PTIEF AssertStringFunction,   "AssertStringFunction", "11s");
@@ -106,12 +108,24 @@ globle void FactCommandDefinitions(
    EnvDefineFunction2(theEnv,execStatus,"set-fact-duplication",'b',
                    SetFactDuplicationCommand,"SetFactDuplicationCommand", "11");
 
+   EnvDefineFunction2(theEnv,execStatus,"get-modify-in-place",'b',
+                   GetModifyInPlaceCommand,"GetModifyInPlaceCommand", "00");
+   EnvDefineFunction2(theEnv,execStatus,"set-modify-in-place",'b',
+                   SetModifyInPlaceCommand,"SetModifyInPlaceCommand", "11");
+
+   EnvDefineFunction2(theEnv,execStatus,"get-matcher-threads",'g',
+                   PTIEF GetMatcherThreadsCommand,"GetMatcherThreadsCommand", "00");
+   EnvDefineFunction2(theEnv,execStatus,"set-matcher-threads",'g',
+                   PTIEF SetMatcherThreadsCommand,"SetMatcherThreadsCommand", "11i");
+
    EnvDefineFunction2(theEnv,execStatus,"save-facts", 'b', PTIEF SaveFactsCommand, "SaveFactsCommand", "1*wk");
    EnvDefineFunction2(theEnv,execStatus,"load-facts", 'b', PTIEF LoadFactsCommand, "LoadFactsCommand", "11k");
    EnvDefineFunction2(theEnv,execStatus,"fact-index", 'g', PTIEF FactIndexFunction,"FactIndexFunction", "11y");
 
    AddFunctionParser(theEnv,execStatus,"assert",AssertParse);
    FuncSeqOvlFlags(theEnv,execStatus,"assert",FALSE,FALSE);
+   AddFunctionParser(theEnv,execStatus,"assert-batch",AssertBatchParse);
+   FuncSeqOvlFlags(theEnv,execStatus,"assert-batch",FALSE,FALSE);
 #else
 #if MAC_MCW || WIN_MCW || MAC_XCD
 #pragma unused(theEnv,execStatus)
@@ -119,35 +133,30 @@ globle void FactCommandDefinitions(
 #endif
   }
 
-static void AssertOrProcessEvent(
+/***************************************************************/
+/* BuildAssertedFact: Creates the fact described by the parsed */
+/*   RHS pattern of an assert (the deftemplate followed by the */
+/*   slot value expressions). Returns NULL if a slot value is  */
+/*   invalid.                                                  */
+/***************************************************************/
+static struct fact *BuildAssertedFact(
    void *theEnv,
    EXEC_STATUS,
-   DATA_OBJECT_PTR rv,
-   int doAssert)
+   struct expr *theExpression)
   {
    struct deftemplate *theDeftemplate;
    struct field *theField;
    DATA_OBJECT theValue;
-   struct expr *theExpression;
    struct templateSlot *slotPtr;
    struct fact *newFact;
    int error = FALSE;
    int i;
-   struct fact *theFact;
-   
-   /*===================================================*/
-   /* Set the default return value to the symbol FALSE. */
-   /*===================================================*/
-
-   SetpType(rv,SYMBOL);
-   SetpValue(rv,EnvFalseSymbol(theEnv,execStatus));
 
    /*================================*/
    /* Get the deftemplate associated */
    /* with the fact being asserted.  */
    /*================================*/
 
-   theExpression = GetFirstArgument();
    theDeftemplate = (struct deftemplate *) theExpression->value;
 
    /*=======================================*/
@@ -227,9 +236,36 @@ static void AssertOrProcessEvent(
    if (error)
      {
       ReturnFact(theEnv,execStatus,newFact);
-      return;
+      return(NULL);
      }
 
+   return(newFact);
+  }
+
+
+static void AssertOrProcessEvent(
+   void *theEnv,
+   EXEC_STATUS,
+   DATA_OBJECT_PTR rv,
+   int doAssert)
+  {
+   struct fact *newFact;
+   struct fact *theFact;
+   
+   /*===================================================*/
+   /* Set the default return value to the symbol FALSE. */
+   /*===================================================*/
+
+   SetpType(rv,SYMBOL);
+   SetpValue(rv,EnvFalseSymbol(theEnv,execStatus));
+
+   /*===============================================*/
+   /* Create the fact and evaluate its slot values. */
+   /*===============================================*/
+
+   newFact = BuildAssertedFact(theEnv,execStatus,GetFirstArgument());
+   if (newFact == NULL) return;
+
    /*================================*/
    /* Add the fact to the fact-list. */
    /*================================*/
@@ -262,15 +298,64 @@ globle void AssertCommand(
      AssertOrProcessEvent(theEnv,execStatus, rv, TRUE);
    }    
 
+/*******************************************/
+/* AssertBatchCommand: H/L access routine  */
+/*   for the assert-batch function. All of */
+/*   the facts are created first and then  */
+/*   asserted with a single batch assert.  */
+/*   Returns the number of facts asserted. */
+/*******************************************/
+globle long long AssertBatchCommand(
+   void *theEnv,
+   EXEC_STATUS)
+   {
+    struct expr *theArgument;
+    struct fact **facts;
+    size_t n = 0, count = 0;
+    long long asserted;
+
+    for (theArgument = GetFirstArgument();
+         theArgument != NULL;
+         theArgument = GetNextArgument(theArgument))
+      { n++; }
+
+    if (n == 0) return(0LL);
+
+    facts = (struct fact **) gm2(theEnv,execStatus,sizeof(struct fact *) * n);
+
+    /*=============================================*/
+    /* Each argument is the (unevaluated) assert   */
+    /* of a single fact. Facts with invalid slot   */
+    /* values are left out of the batch.           */
+    /*=============================================*/
+
+    for (theArgument = GetFirstArgument();
+         theArgument != NULL;
+         theArgument = GetNextArgument(theArgument))
+      {
+       facts[count] = BuildAssertedFact(theEnv,execStatus,theArgument->argList);
+       if (facts[count] != NULL) count++;
+      }
+
+    asserted = (long long) EnvAssertBatch(theEnv,execStatus,facts,count);
+
+    rm(theEnv,execStatus,facts,sizeof(struct fact *) * n);
+
+    return(asserted);
+   }
+
 
 /*
- * Used to transfer the parameters from EnvAssert to
- * the pattern matching and retracting process.
+ * Used to transfer the event from ProcessEventCommand to
+ * the fact thread asserting it.
  */
 struct paramsForProcessEvent
 {
   void *theEnv;
   struct executionStatus* execStatus;
+  struct fact *theFact;
+  struct field *theFields;     // slot values kept installed until asserted
+  long fieldCount;
 };
 
 
@@ -278,15 +363,30 @@ static void * APR_THREAD_FUNC ProcessEventOnFactThread(apr_thread_t *thread, voi
 {
   struct paramsForProcessEvent* const params = (struct paramsForProcessEvent*)parameters;
   
-  DATA_OBJECT result;
-  AssertOrProcessEvent(params->theEnv,params->execStatus, &result, FALSE);
+  long i;
+  
+  // values are interned and released concurrently with the thread running
+  // the environment, which must not remove atoms from the tables meanwhile
+  EnterAtomTables(params->theEnv,params->execStatus);
   
-  ExpressionDeinstall(params->theEnv,params->execStatus,
-                      params->execStatus->CurrentExpression);
+  EnvAssert(params->theEnv,params->execStatus,(void *) params->theFact,TRUE);
+  
+  // the fact now holds its own references to the slot values (or it was
+  // discarded as a duplicate), so the ones taken by the producer can go
+  for (i = 0; i < params->fieldCount; i++)
+    AtomDeinstall(params->theEnv,params->execStatus,
+                  params->theFields[i].type,params->theFields[i].value);
+  
+  LeaveAtomTables(params->theEnv,params->execStatus);
+  
+  free(params->theFields);
+  
+  // hand the memory blocks cached by this event back to the shared table
+  ReleaseMemoryCache(params->theEnv,params->execStatus);
+  
+  // the event is done: wake up blocked producers and waiting barriers
+  ReleaseEventSlot(params->theEnv,params->execStatus);
   
-  ReturnExpression(params->theEnv,params->execStatus,params->execStatus->CurrentExpression);
-  //rtn_struct(theEnv,execStatus,expr,tmp);
-  //free(params->execStatus->CurrentExpression);
   free(params->execStatus);
   free(params);
   
@@ -294,49 +394,89 @@ static void * APR_THREAD_FUNC ProcessEventOnFactThread(apr_thread_t *thread, voi
 }
 
 
-globle void ProcessEventCommand(
+globle intBool ProcessEventCommand(
    void *theEnv,EXEC_STATUS)
    {
      // STEFAN: hand over to the FactThread
+     
+     // Wait for room in the event queue (or give up on the event if the
+     // queue is configured to reject events once it is full).
+     if (! ReserveEventSlot(theEnv,execStatus)) {
+       PrintWarningID(theEnv,execStatus,"FACTCOM",1,FALSE);
+       EnvPrintRouter(theEnv,execStatus,WWARNING,"Event queue limit reached, event rejected.\n");
+       return(FALSE);
+     }
+     
+     // The slot values are evaluated here, since they may refer to
+     // variables of the caller which are gone once the fact thread runs.
+     struct fact *newFact = BuildAssertedFact(theEnv,execStatus,GetFirstArgument());
+     if (newFact == NULL) {
+       ReleaseEventSlot(theEnv,execStatus);
+       return(FALSE);
+     }
        
      struct paramsForProcessEvent * parameters = (struct paramsForProcessEvent *)malloc(sizeof(struct paramsForProcessEvent));
      
      if (!parameters) {
+       ReturnFact(theEnv,execStatus,newFact);
+       ReleaseEventSlot(theEnv,execStatus);
        SystemError(theEnv,execStatus,"malloc failed",1);
+       return(FALSE);
      }
-     else {
-       parameters->theEnv = theEnv;
-       
-       struct executionStatus* newExecStatus = CreateExecutionStatus();
-       *newExecStatus = *execStatus;  // copy the old one to the thread-local
-       
-       parameters->execStatus = newExecStatus;
-       
-       // Copy the expression to be independent of the main thread
-       EXPRESSION* newExpr = PackExpression(theEnv,execStatus,
-                                  parameters->execStatus->CurrentExpression);
-       
-       
-       // increase the reference pointer, as all allocations will be released
-       // by the thread that is receiving the task/job
-       ExpressionInstall(theEnv,execStatus,newExpr);
-       
-       apr_status_t apr_rv;
-       apr_rv = apr_thread_pool_push(Env(theEnv,execStatus)->factThreadPool,
-                                 ProcessEventOnFactThread,
-                                 parameters,
-                                 0, NULL);
-       if (apr_rv) {
-         SystemError(theEnv,execStatus,"Putting task on thread pool failed",1);
-       }
+     
+     parameters->theEnv = theEnv;
+     parameters->theFact = newFact;
+     
+     // Keep the slot values alive until the fact thread has asserted the
+     // fact, otherwise the garbage collection of this thread may reclaim
+     // them in the meantime.
+     parameters->fieldCount = newFact->theProposition.multifieldLength;
+     parameters->theFields = (struct field *)malloc(sizeof(struct field) *
+                                                    (parameters->fieldCount + 1));
+     if (!parameters->theFields) {
+       free(parameters);
+       ReturnFact(theEnv,execStatus,newFact);
+       ReleaseEventSlot(theEnv,execStatus);
+       SystemError(theEnv,execStatus,"malloc failed",1);
+       return(FALSE);
      }
      
-/*     while ((apr_thread_pool_tasks_count(Env(theEnv,execStatus)->factThreadPool) > 0)
-            || ((apr_thread_pool_busy_count(Env(theEnv,execStatus)->factThreadPool)) > 0)) {
-       usleep(100);
+     long i;
+     for (i = 0; i < parameters->fieldCount; i++) {
+       parameters->theFields[i] = newFact->theProposition.theFields[i];
+       AtomInstall(theEnv,execStatus,parameters->theFields[i].type,
+                   parameters->theFields[i].value);
      }
      
-     assert(apr_thread_pool_idle_count(Env(theEnv,execStatus)->factThreadPool) == 1);*/
+     struct executionStatus* newExecStatus = CreateExecutionStatus();
+     *newExecStatus = *execStatus;  // copy the old one to the thread-local
+     newExecStatus->MemoryCache = NULL;  // but not the caller's memory cache
+     newExecStatus->ActiveJoinProfile = NULL;
+     newExecStatus->Ephemerons = NULL;
+     
+     parameters->execStatus = newExecStatus;
+     
+     apr_status_t apr_rv;
+     apr_rv = apr_thread_pool_push(Env(theEnv,execStatus)->factThreadPool,
+                               ProcessEventOnFactThread,
+                               parameters,
+                               0, NULL);
+     if (apr_rv) {
+       for (i = 0; i < parameters->fieldCount; i++)
+         AtomDeinstall(theEnv,execStatus,parameters->theFields[i].type,
+                       parameters->theFields[i].value);
+       ReturnFact(theEnv,execStatus,newFact);
+       free(parameters->theFields);
+       free(newExecStatus);
+       free(parameters);
+       ReleaseEventSlot(theEnv,execStatus);
+       SystemError(theEnv,execStatus,"Putting task on thread pool failed",1);
+       return(FALSE);
+     }
+     
+     // Completion is awaited with (await-events) and by (run) before
+     // an activation is chosen, see EnvWaitForPendingEvents.
+     return(TRUE);
    }
 
 /****************************************/
@@ -514,6 +654,124 @@ globle int GetFactDuplicationCommand(
    return(currentValue);
   }
 
+/***************************************************/
+/* SetMatcherThreadsCommand: H/L access routine    */
+/*   for the set-matcher-threads command. A count  */
+/*   of zero uses one thread per online processor. */
+/*   At most MAX_THREADS_PER_CPU threads for each  */
+/*   online processor are allowed.                 */
+/***************************************************/
+globle long long SetMatcherThreadsCommand(
+  void *theEnv,EXEC_STATUS)
+  {
+   long long oldValue, newValue;
+   DATA_OBJECT theValue;
+   char expected[80];
+
+   /*==============================================*/
+   /* Get the old size of the matcher thread pool. */
+   /*==============================================*/
+
+   oldValue = (long long) EnvGetMatcherThreads(theEnv,execStatus);
+
+   /*=====================================*/
+   /* Check for the correct number and    */
+   /* type of arguments.                  */
+   /*=====================================*/
+
+   if (EnvArgCountCheck(theEnv,execStatus,"set-matcher-threads",EXACTLY,1) == -1)
+     { return(oldValue); }
+
+   if (EnvArgTypeCheck(theEnv,execStatus,"set-matcher-threads",1,INTEGER,&theValue) == FALSE)
+     { return(oldValue); }
+
+   /*==============================================*/
+   /* The thread count must not be negative, and   */
+   /* more than MAX_THREADS_PER_CPU workers for    */
+   /* each online processor would only add         */
+   /* contention.                                  */
+   /*==============================================*/
+
+   newValue = DOToLong(theValue);
+   if ((newValue < 0LL) ||
+       (newValue > (long long) MAX_THREADS_PER_CPU * (long long) genonlinecpus()))
+     {
+      gensprintf(expected,"integer (from 0 to %d times the number of online processors)",
+                 MAX_THREADS_PER_CPU);
+      ExpectedTypeError1(theEnv,execStatus,"set-matcher-threads",1,expected);
+      return(oldValue);
+     }
+
+   /*====================================================*/
+   /* Resize the pool and return its previous size. The  */
+   /* workers are resized at once, so the new size holds */
+   /* for all subsequent asserts, resets, and runs.      */
+   /*====================================================*/
+
+   EnvSetMatcherThreads(theEnv,execStatus,(unsigned int) newValue);
+
+   return(oldValue);
+  }
+
+/***************************************************/
+/* GetMatcherThreadsCommand: H/L access routine    */
+/*   for the get-matcher-threads command.          */
+/***************************************************/
+globle long long GetMatcherThreadsCommand(
+  void *theEnv,EXEC_STATUS)
+  {
+   EnvArgCountCheck(theEnv,execStatus,"get-matcher-threads",EXACTLY,0);
+
+   return((long long) EnvGetMatcherThreads(theEnv,execStatus));
+  }
+
+/***************************************************/
+/* SetModifyInPlaceCommand: H/L access routine     */
+/*   for the set-modify-in-place command.          */
+/***************************************************/
+globle int SetModifyInPlaceCommand(
+  void *theEnv,EXEC_STATUS)
+  {
+   int oldValue;
+   DATA_OBJECT theValue;
+
+   oldValue = EnvGetModifyInPlace(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"set-modify-in-place",EXACTLY,1) == -1)
+     { return(oldValue); }
+
+   EnvRtnUnknown(theEnv,execStatus,1,&theValue);
+
+   /*============================================================*/
+   /* If the argument evaluated to FALSE, modify retracts and    */
+   /* asserts facts, otherwise it changes them in place.         */
+   /*============================================================*/
+
+   if ((theValue.value == EnvFalseSymbol(theEnv,execStatus)) && (theValue.type == SYMBOL))
+     { EnvSetModifyInPlace(theEnv,execStatus,FALSE); }
+   else
+     { EnvSetModifyInPlace(theEnv,execStatus,TRUE); }
+
+   return(oldValue);
+  }
+
+/***************************************************/
+/* GetModifyInPlaceCommand: H/L access routine     */
+/*   for the get-modify-in-place command.          */
+/***************************************************/
+globle int GetModifyInPlaceCommand(
+  void *theEnv,EXEC_STATUS)
+  {
+   int currentValue;
+
+   currentValue = EnvGetModifyInPlace(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"get-modify-in-place",EXACTLY,0) == -1)
+     { return(currentValue); }
+
+   return(currentValue);
+  }
+
 /*******************************************/
 /* FactIndexFunction: H/L access routine   */
 /*   for the fact-index function.          */
@@ -1101,8 +1359,9 @@ globle intBool EnvSaveFacts(
 /*******************************************************************/
 /* GetSaveFactsDeftemplateNames: Retrieves the list of deftemplate */
 /*   names for saving specific facts with the save-facts command.  */
+/*   Also used by the save-facts-binary command.                   */
 /*******************************************************************/
-static DATA_OBJECT_PTR GetSaveFactsDeftemplateNames(
+globle DATA_OBJECT_PTR GetSaveFactsDeftemplateNames(
   void *theEnv,EXEC_STATUS,
   struct expr *theList,
   int saveCode,
@@ -1251,6 +1510,22 @@ globle intBool EnvLoadFacts(
       return(FALSE);
      }
 
+#if LOAD_FACTS_PIPELINE
+   /*=====================================================*/
+   /* Large files are tokenized by the fact threads while */
+   /* the facts already read are asserted in batches.     */
+   /*=====================================================*/
+
+   if (LoadFactsPipelineApplies(theEnv,execStatus,filePtr))
+     {
+      intBool loaded;
+
+      loaded = LoadFactsPipelined(theEnv,execStatus,fileName,filePtr);
+      GenClose(theEnv,execStatus,filePtr);
+      return(loaded);
+     }
+#endif
+
    SetFastLoad(theEnv,execStatus,filePtr);
 
    /*=================*/
@@ -1331,6 +1606,29 @@ globle intBool EnvLoadFactsFromString(
    return(TRUE);
   }
 
+/**************************************************************/
+/* LoadFactFromSource: Loads the next fact of the specified   */
+/*   logical name as load-facts does. Returns FALSE if no     */
+/*   fact was found, or if loading has to stop since the fact */
+/*   contains an error or variables.                          */
+/**************************************************************/
+globle intBool LoadFactFromSource(
+  void *theEnv,EXEC_STATUS,
+  char *logicalName)
+  {
+   struct token theToken;
+   struct expr *testPtr;
+   DATA_OBJECT rv;
+
+   testPtr = StandardLoadFact(theEnv,execStatus,logicalName,&theToken);
+   if (testPtr == NULL) return(FALSE);
+
+   EvaluateExpression(theEnv,execStatus,testPtr,&rv);
+   ReturnExpression(theEnv,execStatus,testPtr);
+
+   return(TRUE);
+  }
+
 /**************************************************************************/
 /* StandardLoadFact: Loads a single fact from the specified logical name. */
 /**************************************************************************/
@@ -1388,6 +1686,48 @@ static struct expr *AssertParse(
    return(rv);
   }
 
+/*************************************************************/
+/* AssertBatchParse: Driver routine for parsing the          */
+/*   assert-batch function. The facts are parsed as for the  */
+/*   assert function and each of them becomes an argument.   */
+/*************************************************************/
+static struct expr *AssertBatchParse(
+  void *theEnv,EXEC_STATUS,
+  struct expr *top,
+  char *logicalName)
+  {
+   int error;
+   struct expr *theFacts, *theProgn;
+   struct token theToken;
+
+   SavePPBuffer(theEnv,execStatus," ");
+   IncrementIndentDepth(theEnv,execStatus,14);
+   theFacts = BuildRHSAssert(theEnv,execStatus,logicalName,&theToken,&error,TRUE,TRUE,"assert-batch command","assert");
+   DecrementIndentDepth(theEnv,execStatus,14);
+
+   if (error)
+     {
+      ReturnExpression(theEnv,execStatus,top);
+      return(NULL);
+     }
+
+   /*====================================================*/
+   /* Several facts are wrapped within a progn call. Use */
+   /* the individual asserts as arguments instead.       */
+   /*====================================================*/
+
+   if (theFacts->value == (void *) FindFunction(theEnv,execStatus,"progn"))
+     {
+      theProgn = theFacts;
+      theFacts = theProgn->argList;
+      theProgn->argList = NULL;
+      ReturnExpression(theEnv,execStatus,theProgn);
+     }
+
+   top->argList = theFacts;
+   return(top);
+  }
+
 #endif /* (! RUN_TIME) */
 
 #endif /* DEFTEMPLATE_CONSTRUCT */
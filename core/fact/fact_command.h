@@ -42,18 +42,25 @@
 
    LOCALE void                           FactCommandDefinitions(void *, EXEC_STATUS);
    LOCALE void                           AssertCommand(void *,EXEC_STATUS,DATA_OBJECT_PTR);
+   LOCALE long long                      AssertBatchCommand(void *,EXEC_STATUS);
    LOCALE void                           RetractCommand(void *, EXEC_STATUS);
-   LOCALE void                           ProcessEventCommand(void *, EXEC_STATUS);
+   LOCALE intBool                        ProcessEventCommand(void *, EXEC_STATUS);
    LOCALE void                           AssertStringFunction(void *,EXEC_STATUS,DATA_OBJECT_PTR);
    LOCALE void                           FactsCommand(void *, EXEC_STATUS);
    LOCALE void                           EnvFacts(void *,EXEC_STATUS,char *,void *,long long,long long,long long);
    LOCALE int                            SetFactDuplicationCommand(void *, EXEC_STATUS);
    LOCALE int                            GetFactDuplicationCommand(void *, EXEC_STATUS);
+   LOCALE int                            SetModifyInPlaceCommand(void *, EXEC_STATUS);
+   LOCALE int                            GetModifyInPlaceCommand(void *, EXEC_STATUS);
+   LOCALE long long                      SetMatcherThreadsCommand(void *, EXEC_STATUS);
+   LOCALE long long                      GetMatcherThreadsCommand(void *, EXEC_STATUS);
    LOCALE int                            SaveFactsCommand(void *, EXEC_STATUS);
    LOCALE int                            LoadFactsCommand(void *, EXEC_STATUS);
    LOCALE int                            EnvSaveFacts(void *,EXEC_STATUS,char *,int,struct expr *);
+   LOCALE DATA_OBJECT_PTR                GetSaveFactsDeftemplateNames(void *,EXEC_STATUS,struct expr *,int,int *,int *);
    LOCALE int                            EnvLoadFacts(void *,EXEC_STATUS,char *);
    LOCALE int                            EnvLoadFactsFromString(void *,EXEC_STATUS,char *,int);
+   LOCALE intBool                        LoadFactFromSource(void *,EXEC_STATUS,char *);
    LOCALE long long                      FactIndexFunction(void *, EXEC_STATUS);
 
 #endif
@@ -0,0 +1,349 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                FACT EVENT QUEUE MODULE              */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Keeps track of the events which proc-event has   */
+/*   handed to the fact thread pool. The number of pending   */
+/*   events is bounded by a high-water mark: once it is      */
+/*   reached, producers are either blocked until an event    */
+/*   has been processed or their event is rejected. The      */
+/*   await-events command (and the run command before each   */
+/*   rule firing) waits until every pending event and the    */
+/*   match tasks it spawned have completed.                  */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _FACTEVNT_SOURCE_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "setup.h"
+
+#if DEFTEMPLATE_CONSTRUCT
+
+#include "argacces.h"
+#include "envrnmnt.h"
+#include "extnfunc.h"
+#include "router.h"
+#include "symbol.h"
+
+#include "fact_events.h"
+#include "fact_scheduler.h"
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static void                    DeallocateFactEventData(void *,EXEC_STATUS);
+
+/*****************************************************/
+/* InitializeFactEvents: Allocates the event queue   */
+/*   data and defines the event queue commands.      */
+/*****************************************************/
+globle void InitializeFactEvents(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct factEventData *theData;
+   apr_status_t rv;
+
+   AllocateEnvironmentData(theEnv,execStatus,FACT_EVENT_DATA,
+                           sizeof(struct factEventData),DeallocateFactEventData);
+
+   theData = FactEventData(theEnv,execStatus);
+   theData->queueLimit = DEFAULT_EVENT_QUEUE_LIMIT;
+   theData->overflowPolicy = EVENT_QUEUE_BLOCK;
+
+   rv = apr_thread_mutex_create(&theData->lock,APR_THREAD_MUTEX_DEFAULT,
+                                Env(theEnv,execStatus)->memoryPool);
+   if (rv == APR_SUCCESS)
+     { rv = apr_thread_cond_create(&theData->notFull,Env(theEnv,execStatus)->memoryPool); }
+   if (rv == APR_SUCCESS)
+     { rv = apr_thread_cond_create(&theData->drained,Env(theEnv,execStatus)->memoryPool); }
+
+   if (rv != APR_SUCCESS)
+     {
+      SystemError(theEnv,execStatus,"FACTEVNT",1);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
+
+#if ! RUN_TIME
+   EnvDefineFunction2(theEnv,execStatus,"await-events",'v',
+                      PTIEF AwaitEventsCommand,"AwaitEventsCommand","00");
+   EnvDefineFunction2(theEnv,execStatus,"get-event-queue-limit",'g',
+                      PTIEF GetEventQueueLimitCommand,"GetEventQueueLimitCommand","00");
+   EnvDefineFunction2(theEnv,execStatus,"set-event-queue-limit",'g',
+                      PTIEF SetEventQueueLimitCommand,"SetEventQueueLimitCommand","12wi");
+#endif
+  }
+
+/******************************************************/
+/* DeallocateFactEventData: Waits until the fact      */
+/*   threads have finished all events still pending.  */
+/******************************************************/
+static void DeallocateFactEventData(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct factEventData *theData = FactEventData(theEnv,execStatus);
+
+   apr_thread_mutex_lock(theData->lock);
+   while (theData->pendingEvents > 0)
+     { apr_thread_cond_wait(theData->drained,theData->lock); }
+   apr_thread_mutex_unlock(theData->lock);
+  }
+
+/*********************************************************/
+/* ReserveEventSlot: Accounts for an event about to be   */
+/*   handed to the fact thread pool. If the high-water   */
+/*   mark has been reached, the caller either waits      */
+/*   until an event has been processed or, if events are */
+/*   rejected on overflow, FALSE is returned.            */
+/*********************************************************/
+globle intBool ReserveEventSlot(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct factEventData *theData = FactEventData(theEnv,execStatus);
+
+   apr_thread_mutex_lock(theData->lock);
+
+   while ((theData->queueLimit != 0) &&
+          (theData->pendingEvents >= theData->queueLimit))
+     {
+      if (theData->overflowPolicy == EVENT_QUEUE_REJECT)
+        {
+         apr_thread_mutex_unlock(theData->lock);
+         return(FALSE);
+        }
+
+      apr_thread_cond_wait(theData->notFull,theData->lock);
+     }
+
+   theData->pendingEvents++;
+
+   apr_thread_mutex_unlock(theData->lock);
+
+   return(TRUE);
+  }
+
+/*******************************************************/
+/* ReleaseEventSlot: Called once an event has been     */
+/*   processed. Wakes up a blocked producer and, when  */
+/*   the last pending event is done, the threads       */
+/*   waiting in EnvWaitForPendingEvents.               */
+/*******************************************************/
+globle void ReleaseEventSlot(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct factEventData *theData = FactEventData(theEnv,execStatus);
+
+   apr_thread_mutex_lock(theData->lock);
+
+   theData->pendingEvents--;
+   apr_thread_cond_signal(theData->notFull);
+
+   if (theData->pendingEvents == 0)
+     { apr_thread_cond_broadcast(theData->drained); }
+
+   apr_thread_mutex_unlock(theData->lock);
+  }
+
+/**********************************************************/
+/* EnvWaitForPendingEvents: Blocks until all events have  */
+/*   been asserted and the match tasks they spawned have  */
+/*   completed. Match workers never wait, since they are  */
+/*   part of what is being waited for.                    */
+/**********************************************************/
+globle void EnvWaitForPendingEvents(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct factEventData *theData = FactEventData(theEnv,execStatus);
+
+   if (execStatus->MatchWorker != NULL) return;
+
+   apr_thread_mutex_lock(theData->lock);
+   while (theData->pendingEvents > 0)
+     { apr_thread_cond_wait(theData->drained,theData->lock); }
+   apr_thread_mutex_unlock(theData->lock);
+
+   WaitForMatchingTasks(theEnv,execStatus);
+  }
+
+/***********************************************/
+/* EnvGetEventQueueLimit: C access routine for */
+/*   the get-event-queue-limit command.        */
+/***********************************************/
+globle unsigned long EnvGetEventQueueLimit(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(FactEventData(theEnv,execStatus)->queueLimit);
+  }
+
+/****************************************************/
+/* EnvSetEventQueueLimit: C access routine for the  */
+/*   set-event-queue-limit command. A limit of zero */
+/*   removes the bound. Returns the old limit.      */
+/****************************************************/
+globle unsigned long EnvSetEventQueueLimit(
+  void *theEnv,
+  EXEC_STATUS,
+  unsigned long newLimit)
+  {
+   struct factEventData *theData = FactEventData(theEnv,execStatus);
+   unsigned long oldLimit;
+
+   apr_thread_mutex_lock(theData->lock);
+   oldLimit = theData->queueLimit;
+   theData->queueLimit = newLimit;
+   apr_thread_cond_broadcast(theData->notFull);
+   apr_thread_mutex_unlock(theData->lock);
+
+   return(oldLimit);
+  }
+
+/*****************************************************/
+/* EnvGetEventQueueOverflow: Returns the behavior of */
+/*   proc-event once the event queue limit has been  */
+/*   reached (EVENT_QUEUE_BLOCK/EVENT_QUEUE_REJECT). */
+/*****************************************************/
+globle int EnvGetEventQueueOverflow(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(FactEventData(theEnv,execStatus)->overflowPolicy);
+  }
+
+/*******************************************************/
+/* EnvSetEventQueueOverflow: Sets the behavior of      */
+/*   proc-event once the event queue limit has been    */
+/*   reached. Producers already blocked are woken up   */
+/*   when switching to rejection. Returns the old one. */
+/*******************************************************/
+globle int EnvSetEventQueueOverflow(
+  void *theEnv,
+  EXEC_STATUS,
+  int newPolicy)
+  {
+   struct factEventData *theData = FactEventData(theEnv,execStatus);
+   int oldPolicy;
+
+   apr_thread_mutex_lock(theData->lock);
+   oldPolicy = theData->overflowPolicy;
+   theData->overflowPolicy = newPolicy;
+   apr_thread_cond_broadcast(theData->notFull);
+   apr_thread_mutex_unlock(theData->lock);
+
+   return(oldPolicy);
+  }
+
+/******************************************/
+/* AwaitEventsCommand: H/L access routine */
+/*   for the await-events command.        */
+/******************************************/
+globle void AwaitEventsCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (EnvArgCountCheck(theEnv,execStatus,"await-events",EXACTLY,0) == -1) return;
+
+   EnvWaitForPendingEvents(theEnv,execStatus);
+  }
+
+/*************************************************/
+/* GetEventQueueLimitCommand: H/L access routine */
+/*   for the get-event-queue-limit command.      */
+/*************************************************/
+globle long long GetEventQueueLimitCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (EnvArgCountCheck(theEnv,execStatus,"get-event-queue-limit",EXACTLY,0) == -1)
+     { return((long long) EnvGetEventQueueLimit(theEnv,execStatus)); }
+
+   return((long long) EnvGetEventQueueLimit(theEnv,execStatus));
+  }
+
+/*************************************************/
+/* SetEventQueueLimitCommand: H/L access routine */
+/*   for the set-event-queue-limit command:      */
+/*                                               */
+/*   (set-event-queue-limit <integer>            */
+/*                          [block | reject])    */
+/*************************************************/
+globle long long SetEventQueueLimitCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   long long oldValue, newValue;
+   int numArgs, newPolicy;
+   DATA_OBJECT theValue;
+   char *policyName;
+
+   oldValue = (long long) EnvGetEventQueueLimit(theEnv,execStatus);
+
+   /*=====================================*/
+   /* Check for the correct number and    */
+   /* type of arguments.                  */
+   /*=====================================*/
+
+   if ((numArgs = EnvArgRangeCheck(theEnv,execStatus,"set-event-queue-limit",1,2)) == -1)
+     { return(oldValue); }
+
+   if (EnvArgTypeCheck(theEnv,execStatus,"set-event-queue-limit",1,INTEGER,&theValue) == FALSE)
+     { return(oldValue); }
+
+   newValue = DOToLong(theValue);
+   if (newValue < 0LL)
+     {
+      ExpectedTypeError1(theEnv,execStatus,"set-event-queue-limit",1,"integer (greater than or equal to 0)");
+      return(oldValue);
+     }
+
+   /*============================================*/
+   /* The optional second argument determines if */
+   /* producers are blocked or rejected once the */
+   /* limit has been reached.                    */
+   /*============================================*/
+
+   newPolicy = EnvGetEventQueueOverflow(theEnv,execStatus);
+   if (numArgs == 2)
+     {
+      if (EnvArgTypeCheck(theEnv,execStatus,"set-event-queue-limit",2,SYMBOL,&theValue) == FALSE)
+        { return(oldValue); }
+
+      policyName = DOToString(theValue);
+      if (strcmp(policyName,"block") == 0)
+        { newPolicy = EVENT_QUEUE_BLOCK; }
+      else if (strcmp(policyName,"reject") == 0)
+        { newPolicy = EVENT_QUEUE_REJECT; }
+      else
+        {
+         ExpectedTypeError1(theEnv,execStatus,"set-event-queue-limit",2,"symbol block or reject");
+         return(oldValue);
+        }
+     }
+
+   EnvSetEventQueueLimit(theEnv,execStatus,(unsigned long) newValue);
+   EnvSetEventQueueOverflow(theEnv,execStatus,newPolicy);
+
+   return(oldValue);
+  }
+
+#endif /* DEFTEMPLATE_CONSTRUCT */
@@ -0,0 +1,80 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*             FACT EVENT QUEUE HEADER FILE            */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Bounds the number of events handed to the fact   */
+/*   thread pool by proc-event and provides the barrier      */
+/*   which waits until all of them have been matched.        */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_factevnt
+
+#define _H_factevnt
+
+# include <apr_thread_mutex.h>
+# include <apr_thread_cond.h>
+
+# include "execution_status.h"
+
+#define FACT_EVENT_DATA 66
+
+/*======================================================*/
+/* Number of events which may be pending before further */
+/* producers are blocked (or rejected). Zero means that */
+/* the queue is unbounded.                              */
+/*======================================================*/
+
+#define DEFAULT_EVENT_QUEUE_LIMIT 10000
+
+#define EVENT_QUEUE_BLOCK  0
+#define EVENT_QUEUE_REJECT 1
+
+struct factEventData
+  {
+   apr_thread_mutex_t *lock;
+   apr_thread_cond_t *notFull;
+   apr_thread_cond_t *drained;
+   unsigned long pendingEvents;
+   unsigned long queueLimit;
+   int overflowPolicy;
+  };
+
+#define FactEventData(theEnv,execStatus) ((struct factEventData *) GetEnvironmentData(theEnv,execStatus,FACT_EVENT_DATA))
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _FACTEVNT_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+#define WaitForPendingEvents() EnvWaitForPendingEvents(GetCurrentEnvironment(),GetCurrentExecutionStatus())
+
+   LOCALE void                           InitializeFactEvents(void *,EXEC_STATUS);
+   LOCALE intBool                        ReserveEventSlot(void *,EXEC_STATUS);
+   LOCALE void                           ReleaseEventSlot(void *,EXEC_STATUS);
+   LOCALE void                           EnvWaitForPendingEvents(void *,EXEC_STATUS);
+   LOCALE unsigned long                  EnvGetEventQueueLimit(void *,EXEC_STATUS);
+   LOCALE unsigned long                  EnvSetEventQueueLimit(void *,EXEC_STATUS,unsigned long);
+   LOCALE int                            EnvGetEventQueueOverflow(void *,EXEC_STATUS);
+   LOCALE int                            EnvSetEventQueueOverflow(void *,EXEC_STATUS,int);
+   LOCALE void                           AwaitEventsCommand(void *,EXEC_STATUS);
+   LOCALE long long                      GetEventQueueLimitCommand(void *,EXEC_STATUS);
+   LOCALE long long                      SetEventQueueLimitCommand(void *,EXEC_STATUS);
+
+#endif
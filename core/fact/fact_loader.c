@@ -0,0 +1,1446 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                 FACT FILE LOADER MODULE             */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Loads large fact files for the load-facts        */
+/*   command in three stages. The calling thread reads the   */
+/*   file and cuts it into chunks of complete facts at top   */
+/*   level parenthesis boundaries. The chunks are tokenized  */
+/*   on the fact threads, which convert numbers and collect  */
+/*   the distinct atoms of a chunk in a table local to the   */
+/*   chunk, since the symbol table may only be changed by    */
+/*   the calling thread. The calling thread then takes the   */
+/*   chunks in file order, interns the atoms of each chunk   */
+/*   once, builds the facts directly from the tokens and     */
+/*   asserts them in batches. Facts which are not plain      */
+/*   constants, or which would raise an error, are handed    */
+/*   to the standard load-facts parser, so the facts         */
+/*   asserted and the messages printed are the same as for   */
+/*   the standard parser, followed by the line of the file   */
+/*   at which the fact in error starts.                      */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _FACTLOAD_SOURCE_
+
+#include <stdio.h>
+#define _STDIO_INCLUDED_
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "setup.h"
+
+#if DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT && LOAD_FACTS_PIPELINE
+
+#include "constant.h"
+#include "constrct.h"
+#include "constrnt.h"
+#include "cstrnchk.h"
+#include "envrnmnt.h"
+#include "memalloc.h"
+#include "modulutl.h"
+#include "multifld.h"
+#include "pattern.h"
+#include "prntutil.h"
+#include "router.h"
+#include "strngrtr.h"
+#include "symbol.h"
+#include "tmpltdef.h"
+#include "tmpltutl.h"
+
+#if DEFMODULE_CONSTRUCT
+#include "modulpsr.h"
+#endif
+
+#if BLOAD || BLOAD_AND_BSAVE
+#include "bload.h"
+#endif
+
+#include "fact_manager.h"
+#include "fact_command.h"
+#include "fact_loader.h"
+
+# include <apr_thread_mutex.h>
+# include <apr_thread_cond.h>
+# include <apr_thread_pool.h>
+
+/*=====================================================*/
+/* A fact found by the reader. Offsets are relative to */
+/* the text of the chunk. A fact whose tokens can not  */
+/* be built into a fact directly, or which ends with   */
+/* the file, is loaded by the standard parser.         */
+/*=====================================================*/
+
+#define FACT_ENTRY_TOKENS 0
+#define FACT_ENTRY_PARSE  1
+
+struct loadFactsEntry
+  {
+   size_t start;
+   size_t end;
+   long line;
+   size_t firstToken;
+   size_t tokenCount;
+   int kind;
+  };
+
+/*=====================================================*/
+/* A distinct atom of a chunk. The text of symbols and */
+/* strings is kept in the string buffer of the chunk.  */
+/* The value is only set once the ordered stage first  */
+/* uses the atom.                                      */
+/*=====================================================*/
+
+struct loadFactsAtom
+  {
+   unsigned short type;
+   size_t offset;
+   size_t length;
+   unsigned long hashValue;
+   long long integerValue;
+   double floatValue;
+   void *value;
+  };
+
+/*==================================================*/
+/* Tokens are indices into the atom table of the    */
+/* chunk, or one of the two parenthesis tokens.     */
+/*==================================================*/
+
+#define LOAD_TOKEN_LPAREN -1L
+#define LOAD_TOKEN_RPAREN -2L
+
+struct loadFactsChunk
+  {
+   struct loadFactsPipeline *pipeline;
+   char *text;
+   size_t textLength;
+   struct loadFactsEntry *entries;
+   size_t entryCount;
+   size_t entryMax;
+   long *tokens;
+   size_t tokenCount;
+   size_t tokenMax;
+   struct loadFactsAtom *atoms;
+   size_t atomCount;
+   size_t atomMax;
+   long *atomTable;
+   size_t atomTableSize;
+   char *strings;
+   size_t stringsUsed;
+   size_t stringsMax;
+   int parsed;
+   struct loadFactsChunk *next;
+  };
+
+/*=====================================================*/
+/* Deftemplates recently found by name. The names are  */
+/* compared by their symbol table address.             */
+/*=====================================================*/
+
+#define LOAD_FACTS_TEMPLATE_CACHE 8
+
+struct loadFactsTemplate
+  {
+   SYMBOL_HN *name;
+   struct deftemplate *theDeftemplate;
+  };
+
+struct loadFactsPipeline
+  {
+   FILE *file;
+   char *fileName;
+   char *buffer;
+   size_t bufferSize;
+   size_t used;
+   size_t position;
+   int depth;
+   int inString;
+   int escaped;
+   int inComment;
+   long line;
+   size_t factStart;
+   long factLine;
+   int endOfFile;
+   int finished;
+   int stopped;
+   apr_pool_t *pool;
+   apr_thread_mutex_t *lock;
+   apr_thread_cond_t *chunkParsed;
+   struct loadFactsChunk *firstChunk;
+   struct loadFactsChunk *lastChunk;
+   unsigned int chunksInFlight;
+   struct fact **batch;
+   size_t batchCount;
+   struct loadFactsTemplate templates[LOAD_FACTS_TEMPLATE_CACHE];
+   unsigned int nextTemplate;
+  };
+
+#define LOAD_FACTS_READ_SIZE 65536
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static struct loadFactsChunk  *ReadFactsChunk(struct loadFactsPipeline *);
+   static intBool                 FillReadBuffer(struct loadFactsPipeline *,size_t);
+   static intBool                 AddFactEntry(struct loadFactsChunk *,size_t,size_t,long,int);
+   static void                    SubmitFactsChunk(void *,EXEC_STATUS,struct loadFactsPipeline *,struct loadFactsChunk *);
+   static void * APR_THREAD_FUNC  ParseFactsChunkTask(apr_thread_t *,void *);
+   static void                    ParseFactsChunk(struct loadFactsChunk *);
+   static intBool                 TokenizeFactEntry(struct loadFactsChunk *,struct loadFactsEntry *);
+   static intBool                 AddChunkToken(struct loadFactsChunk *,long);
+   static long                    AddChunkAtom(struct loadFactsChunk *,unsigned short,size_t,size_t);
+   static intBool                 ReserveChunkStrings(struct loadFactsChunk *,size_t);
+   static unsigned short          ScanLoadedNumber(char *,size_t,long long *,double *);
+   static void                    WaitForFactsChunk(struct loadFactsPipeline *,struct loadFactsChunk *);
+   static void                    FreeFactsChunk(struct loadFactsChunk *);
+   static intBool                 AssertFactsChunk(void *,EXEC_STATUS,struct loadFactsPipeline *,struct loadFactsChunk *);
+   static int                     BuildLoadedFact(void *,EXEC_STATUS,struct loadFactsPipeline *,
+                                                  struct loadFactsChunk *,struct loadFactsEntry *);
+   static void                   *LoadedAtomValue(void *,EXEC_STATUS,struct loadFactsChunk *,long);
+   static intBool                 LoadedValueAllowed(void *,EXEC_STATUS,struct loadFactsChunk *,long,
+                                                     struct templateSlot *,struct field *);
+   static struct deftemplate     *FindLoadedDeftemplate(void *,EXEC_STATUS,struct loadFactsPipeline *,SYMBOL_HN *);
+   static void                    FlushLoadedFacts(void *,EXEC_STATUS,struct loadFactsPipeline *);
+   static intBool                 ParseFactEntry(void *,EXEC_STATUS,struct loadFactsPipeline *,
+                                                 struct loadFactsChunk *,struct loadFactsEntry *);
+
+/*=========================================*/
+/* Return codes of BuildLoadedFact. A fact */
+/* is either placed in the batch, or it    */
+/* has to be loaded by the standard parser.*/
+/*=========================================*/
+
+#define LOADED_FACT_BATCHED  0
+#define LOADED_FACT_ISOLATED 1
+#define LOADED_FACT_PARSE    2
+
+/*******************************************************/
+/* LoadFactsPipelineApplies: Determines if a fact file */
+/*   opened by load-facts is large enough to be loaded */
+/*   with the pipeline. The file is left positioned at */
+/*   its beginning.                                    */
+/*******************************************************/
+globle intBool LoadFactsPipelineApplies(
+  void *theEnv,
+  EXEC_STATUS,
+  FILE *theFile)
+  {
+   long fileSize;
+
+   if (fseek(theFile,0L,SEEK_END) != 0) return(FALSE);
+   fileSize = ftell(theFile);
+   if (fseek(theFile,0L,SEEK_SET) != 0) return(FALSE);
+
+   return(fileSize >= LOAD_FACTS_PIPELINE_MIN_SIZE);
+  }
+
+/*****************************************************/
+/* LoadFactsPipelined: Loads the facts of an opened  */
+/*   file with the pipeline. The file is read up to  */
+/*   a bounded number of chunks ahead of the chunk   */
+/*   whose facts are being asserted. Returns TRUE if */
+/*   no error occurred while loading the facts.      */
+/*****************************************************/
+globle intBool LoadFactsPipelined(
+  void *theEnv,
+  EXEC_STATUS,
+  char *fileName,
+  FILE *theFile)
+  {
+   struct loadFactsPipeline *thePipeline;
+   struct loadFactsChunk *theChunk;
+   unsigned int threads, window;
+
+   thePipeline = (struct loadFactsPipeline *) genalloc(theEnv,execStatus,sizeof(struct loadFactsPipeline));
+   memset(thePipeline,0,sizeof(struct loadFactsPipeline));
+   thePipeline->file = theFile;
+   thePipeline->fileName = fileName;
+   thePipeline->line = 1;
+
+   // STEFAN: the parser threads signal finished chunks through a
+   // condition variable allocated from a pool of this load only.
+   threads = EnvGetFactThreads(theEnv,execStatus);
+   if (threads > 0)
+     {
+      if ((apr_pool_create(&thePipeline->pool,Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS) ||
+          (apr_thread_mutex_create(&thePipeline->lock,APR_THREAD_MUTEX_DEFAULT,thePipeline->pool) != APR_SUCCESS) ||
+          (apr_thread_cond_create(&thePipeline->chunkParsed,thePipeline->pool) != APR_SUCCESS))
+        {
+         if (thePipeline->pool != NULL) apr_pool_destroy(thePipeline->pool);
+         genfree(theEnv,execStatus,thePipeline,sizeof(struct loadFactsPipeline));
+         SystemError(theEnv,execStatus,"FACTLOAD",1);
+         return(FALSE);
+        }
+     }
+   window = (threads * 2) + 2;
+
+   thePipeline->batch = (struct fact **)
+                        gm3(theEnv,execStatus,(long) (sizeof(struct fact *) * LOAD_FACTS_BATCH_SIZE));
+
+   /*============================================*/
+   /* The atoms of the facts built from a chunk  */
+   /* are protected from garbage collection      */
+   /* until the facts have been asserted.        */
+   /*============================================*/
+
+   EnvIncrementGCLocks(theEnv,execStatus);
+
+   while (TRUE)
+     {
+      /*=====================================*/
+      /* Keep the parser threads busy with   */
+      /* the chunks following the next one.  */
+      /*=====================================*/
+
+      while ((! thePipeline->finished) && (! thePipeline->stopped) &&
+             (thePipeline->chunksInFlight < window))
+        {
+         theChunk = ReadFactsChunk(thePipeline);
+         if (theChunk == NULL) break;
+         SubmitFactsChunk(theEnv,execStatus,thePipeline,theChunk);
+        }
+
+      theChunk = thePipeline->firstChunk;
+      if (theChunk == NULL) break;
+
+      /*========================================*/
+      /* Assert the facts of the oldest chunk.  */
+      /*========================================*/
+
+      WaitForFactsChunk(thePipeline,theChunk);
+      thePipeline->firstChunk = theChunk->next;
+      if (thePipeline->firstChunk == NULL) thePipeline->lastChunk = NULL;
+      thePipeline->chunksInFlight--;
+
+      if ((! thePipeline->stopped) &&
+          (AssertFactsChunk(theEnv,execStatus,thePipeline,theChunk) == FALSE))
+        { thePipeline->stopped = TRUE; }
+
+      FreeFactsChunk(theChunk);
+     }
+
+   FlushLoadedFacts(theEnv,execStatus,thePipeline);
+
+   EnvDecrementGCLocks(theEnv,execStatus);
+
+   if (thePipeline->buffer != NULL)
+     { free(thePipeline->buffer); }
+   if (thePipeline->pool != NULL)
+     { apr_pool_destroy(thePipeline->pool); }
+   rm3(theEnv,execStatus,thePipeline->batch,(long) (sizeof(struct fact *) * LOAD_FACTS_BATCH_SIZE));
+   genfree(theEnv,execStatus,thePipeline,sizeof(struct loadFactsPipeline));
+
+   if (execStatus->EvaluationError) return(FALSE);
+   return(TRUE);
+  }
+
+/*********************************************************/
+/* ReadFactsChunk: Reads the file up to the end of the   */
+/*   first fact ending after LOAD_FACTS_CHUNK_SIZE bytes */
+/*   and returns the facts found as a chunk. Strings and */
+/*   comments are skipped as by the scanner, so a chunk  */
+/*   always ends where the standard parser would finish  */
+/*   a fact. A token other than a left parenthesis at    */
+/*   top level ends the load, as does the end of file.   */
+/*   A fact cut off by the end of the file is left to    */
+/*   the standard parser, which reports the error.       */
+/*   Returns NULL if no facts are left.                  */
+/*********************************************************/
+static struct loadFactsChunk *ReadFactsChunk(
+  struct loadFactsPipeline *thePipeline)
+  {
+   struct loadFactsChunk *theChunk;
+   size_t chunkStart;
+   int inchar;
+   intBool full = FALSE;
+
+   theChunk = (struct loadFactsChunk *) calloc(1,sizeof(struct loadFactsChunk));
+   if (theChunk == NULL)
+     {
+      thePipeline->finished = TRUE;
+      return(NULL);
+     }
+   theChunk->pipeline = thePipeline;
+
+   chunkStart = thePipeline->position;
+
+   while ((! full) && (! thePipeline->finished))
+     {
+      /*====================================================*/
+      /* Read more of the file once the buffer is scanned.  */
+      /* The bytes of the chunk are moved to the front.     */
+      /*====================================================*/
+
+      if (thePipeline->position == thePipeline->used)
+        {
+         if (thePipeline->endOfFile ||
+             (FillReadBuffer(thePipeline,chunkStart) == FALSE))
+           {
+            thePipeline->endOfFile = TRUE;
+            thePipeline->finished = TRUE;
+            break;
+           }
+         chunkStart = 0;
+        }
+
+      inchar = (unsigned char) thePipeline->buffer[thePipeline->position++];
+      if (inchar == '\n') thePipeline->line++;
+
+      if (thePipeline->inComment)
+        {
+         if ((inchar == '\n') || (inchar == '\r'))
+           { thePipeline->inComment = FALSE; }
+         continue;
+        }
+
+      if (thePipeline->inString)
+        {
+         if (thePipeline->escaped)
+           { thePipeline->escaped = FALSE; }
+         else if (inchar == '\\')
+           { thePipeline->escaped = TRUE; }
+         else if (inchar == '"')
+           { thePipeline->inString = FALSE; }
+         continue;
+        }
+
+      /*=================================*/
+      /* Between facts only white space, */
+      /* comments and the opening        */
+      /* parenthesis of a fact may occur.*/
+      /*=================================*/
+
+      if (thePipeline->depth == 0)
+        {
+         if ((inchar == ' ') || (inchar == '\n') || (inchar == '\f') ||
+             (inchar == '\r') || (inchar == '\t'))
+           { continue; }
+
+         if (inchar == ';')
+           {
+            thePipeline->inComment = TRUE;
+            continue;
+           }
+
+         if (inchar != '(')
+           {
+            thePipeline->finished = TRUE;
+            break;
+           }
+
+         thePipeline->depth = 1;
+         thePipeline->factStart = thePipeline->position - 1;
+         thePipeline->factLine = thePipeline->line;
+         continue;
+        }
+
+      switch (inchar)
+        {
+         case '"':
+           thePipeline->inString = TRUE;
+           break;
+
+         case ';':
+           thePipeline->inComment = TRUE;
+           break;
+
+         case '(':
+           thePipeline->depth++;
+           break;
+
+         case ')':
+           if (--thePipeline->depth > 0) break;
+           if (AddFactEntry(theChunk,thePipeline->factStart - chunkStart,
+                            thePipeline->position - chunkStart,
+                            thePipeline->factLine,FACT_ENTRY_TOKENS) == FALSE)
+             {
+              thePipeline->finished = TRUE;
+              break;
+             }
+           if ((thePipeline->position - chunkStart) >= LOAD_FACTS_CHUNK_SIZE)
+             { full = TRUE; }
+           break;
+        }
+     }
+
+   /*============================================*/
+   /* A fact still open at the end of the file   */
+   /* is parsed by the standard parser as is.    */
+   /*============================================*/
+
+   if (thePipeline->endOfFile && (thePipeline->depth > 0))
+     {
+      AddFactEntry(theChunk,thePipeline->factStart - chunkStart,
+                   thePipeline->used - chunkStart,
+                   thePipeline->factLine,FACT_ENTRY_PARSE);
+      thePipeline->depth = 0;
+      thePipeline->position = thePipeline->used;
+     }
+
+   if (theChunk->entryCount == 0)
+     {
+      FreeFactsChunk(theChunk);
+      return(NULL);
+     }
+
+   /*=======================================*/
+   /* Copy the text of the facts, which the */
+   /* parser threads may work on while the  */
+   /* buffer is refilled.                   */
+   /*=======================================*/
+
+   theChunk->textLength = theChunk->entries[theChunk->entryCount - 1].end;
+   theChunk->text = (char *) malloc(theChunk->textLength + 1);
+   if (theChunk->text == NULL)
+     {
+      thePipeline->finished = TRUE;
+      FreeFactsChunk(theChunk);
+      return(NULL);
+     }
+   memcpy(theChunk->text,thePipeline->buffer + chunkStart,theChunk->textLength);
+   theChunk->text[theChunk->textLength] = EOS;
+
+   return(theChunk);
+  }
+
+/*****************************************************/
+/* FillReadBuffer: Moves the unprocessed bytes from  */
+/*   keepFrom on to the front of the read buffer and */
+/*   reads the next block of the file behind them.   */
+/*   Returns FALSE at the end of the file.           */
+/*****************************************************/
+static intBool FillReadBuffer(
+  struct loadFactsPipeline *thePipeline,
+  size_t keepFrom)
+  {
+   size_t kept, count;
+   char *newBuffer;
+
+   kept = thePipeline->used - keepFrom;
+   if (kept > 0)
+     { memmove(thePipeline->buffer,thePipeline->buffer + keepFrom,kept); }
+   thePipeline->factStart -= keepFrom;
+   thePipeline->used = kept;
+   thePipeline->position = kept;
+
+   if ((thePipeline->bufferSize - kept) < LOAD_FACTS_READ_SIZE)
+     {
+      newBuffer = (char *) realloc(thePipeline->buffer,kept + (LOAD_FACTS_READ_SIZE * 2));
+      if (newBuffer == NULL) return(FALSE);
+      thePipeline->buffer = newBuffer;
+      thePipeline->bufferSize = kept + (LOAD_FACTS_READ_SIZE * 2);
+     }
+
+   count = fread(thePipeline->buffer + kept,1,thePipeline->bufferSize - kept,thePipeline->file);
+   if (count == 0) return(FALSE);
+
+   thePipeline->used += count;
+   return(TRUE);
+  }
+
+/*********************************************/
+/* AddFactEntry: Adds a fact found by the    */
+/*   reader to a chunk. Returns FALSE if the */
+/*   entry could not be allocated.           */
+/*********************************************/
+static intBool AddFactEntry(
+  struct loadFactsChunk *theChunk,
+  size_t start,
+  size_t end,
+  long line,
+  int kind)
+  {
+   struct loadFactsEntry *newEntries;
+   size_t newMax;
+
+   if (theChunk->entryCount == theChunk->entryMax)
+     {
+      newMax = (theChunk->entryMax == 0) ? 256 : (theChunk->entryMax * 2);
+      newEntries = (struct loadFactsEntry *)
+                   realloc(theChunk->entries,sizeof(struct loadFactsEntry) * newMax);
+      if (newEntries == NULL) return(FALSE);
+      theChunk->entries = newEntries;
+      theChunk->entryMax = newMax;
+     }
+
+   theChunk->entries[theChunk->entryCount].start = start;
+   theChunk->entries[theChunk->entryCount].end = end;
+   theChunk->entries[theChunk->entryCount].line = line;
+   theChunk->entries[theChunk->entryCount].firstToken = 0;
+   theChunk->entries[theChunk->entryCount].tokenCount = 0;
+   theChunk->entries[theChunk->entryCount].kind = kind;
+   theChunk->entryCount++;
+
+   return(TRUE);
+  }
+
+/********************************************************/
+/* SubmitFactsChunk: Queues a chunk behind the chunks   */
+/*   being parsed and hands it to a fact thread. If no  */
+/*   fact threads are available the chunk is parsed by  */
+/*   the calling thread.                                */
+/********************************************************/
+static void SubmitFactsChunk(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsPipeline *thePipeline,
+  struct loadFactsChunk *theChunk)
+  {
+   if (thePipeline->lastChunk == NULL)
+     { thePipeline->firstChunk = theChunk; }
+   else
+     { thePipeline->lastChunk->next = theChunk; }
+   thePipeline->lastChunk = theChunk;
+   thePipeline->chunksInFlight++;
+
+   if ((thePipeline->lock == NULL) ||
+       (apr_thread_pool_push(Env(theEnv,execStatus)->factThreadPool,ParseFactsChunkTask,
+                             theChunk,APR_THREAD_TASK_PRIORITY_NORMAL,NULL) != APR_SUCCESS))
+     {
+      ParseFactsChunk(theChunk);
+      theChunk->parsed = TRUE;
+     }
+  }
+
+/***************************************************/
+/* ParseFactsChunkTask: Tokenizes a chunk on a     */
+/*   fact thread and signals the calling thread.   */
+/***************************************************/
+static void * APR_THREAD_FUNC ParseFactsChunkTask(
+  apr_thread_t *thread,
+  void *data)
+  {
+   struct loadFactsChunk *theChunk = (struct loadFactsChunk *) data;
+   struct loadFactsPipeline *thePipeline = theChunk->pipeline;
+
+   ParseFactsChunk(theChunk);
+
+   apr_thread_mutex_lock(thePipeline->lock);
+   theChunk->parsed = TRUE;
+   apr_thread_cond_broadcast(thePipeline->chunkParsed);
+   apr_thread_mutex_unlock(thePipeline->lock);
+
+   return(NULL);
+  }
+
+/***********************************************************/
+/* WaitForFactsChunk: Waits until a chunk has been parsed. */
+/***********************************************************/
+static void WaitForFactsChunk(
+  struct loadFactsPipeline *thePipeline,
+  struct loadFactsChunk *theChunk)
+  {
+   if (thePipeline->lock == NULL) return;
+
+   apr_thread_mutex_lock(thePipeline->lock);
+   while (! theChunk->parsed)
+     { apr_thread_cond_wait(thePipeline->chunkParsed,thePipeline->lock); }
+   apr_thread_mutex_unlock(thePipeline->lock);
+  }
+
+/*******************************************************/
+/* ParseFactsChunk: Tokenizes the facts of a chunk. It */
+/*   only uses memory of the chunk, so any number of   */
+/*   chunks can be parsed at the same time.            */
+/*******************************************************/
+static void ParseFactsChunk(
+  struct loadFactsChunk *theChunk)
+  {
+   size_t i;
+   struct loadFactsEntry *theEntry;
+
+   for (i = 0; i < theChunk->entryCount; i++)
+     {
+      theEntry = &theChunk->entries[i];
+      if (theEntry->kind != FACT_ENTRY_TOKENS) continue;
+
+      theEntry->firstToken = theChunk->tokenCount;
+      if (TokenizeFactEntry(theChunk,theEntry))
+        { theEntry->tokenCount = theChunk->tokenCount - theEntry->firstToken; }
+      else
+        {
+         theChunk->tokenCount = theEntry->firstToken;
+         theEntry->kind = FACT_ENTRY_PARSE;
+        }
+     }
+  }
+
+/************************************************************/
+/* TokenizeFactEntry: Converts the text of a fact into      */
+/*   parentheses and atoms, following the rules of the      */
+/*   scanner. Returns FALSE for any token other than a      */
+/*   parenthesis, symbol, string, integer or float, and for */
+/*   text the scanner would treat in a special way (such as */
+/*   variables, instance names, constraint characters,      */
+/*   non-ASCII characters or a warning about a number).     */
+/************************************************************/
+static intBool TokenizeFactEntry(
+  struct loadFactsChunk *theChunk,
+  struct loadFactsEntry *theEntry)
+  {
+   char *text = theChunk->text;
+   size_t i = theEntry->start, end = theEntry->end, runStart;
+   size_t stringStart;
+   int inchar;
+   long theAtom;
+   unsigned short type;
+   long long integerValue;
+   double floatValue;
+
+   while (i < end)
+     {
+      inchar = (unsigned char) text[i];
+
+      /*=======================================*/
+      /* Skip white space and comment lines.   */
+      /*=======================================*/
+
+      if ((inchar == ' ') || (inchar == '\n') || (inchar == '\f') ||
+          (inchar == '\r') || (inchar == '\t'))
+        {
+         i++;
+         continue;
+        }
+
+      if (inchar == ';')
+        {
+         while ((i < end) && (text[i] != '\n') && (text[i] != '\r'))
+           { i++; }
+         continue;
+        }
+
+      /*=================*/
+      /* Parentheses.    */
+      /*=================*/
+
+      if ((inchar == '(') || (inchar == ')'))
+        {
+         if (! AddChunkToken(theChunk,(inchar == '(') ? LOAD_TOKEN_LPAREN : LOAD_TOKEN_RPAREN))
+           { return(FALSE); }
+         i++;
+         continue;
+        }
+
+      /*==============================================*/
+      /* Strings. The character following a backslash */
+      /* is taken as is. A backspace character would  */
+      /* delete the previous character of the string. */
+      /*==============================================*/
+
+      if (inchar == '"')
+        {
+         i++;
+         if (! ReserveChunkStrings(theChunk,end - i + 1)) return(FALSE);
+         stringStart = theChunk->stringsUsed;
+         while ((i < end) && (text[i] != '"'))
+           {
+            if (text[i] == '\\')
+              {
+               i++;
+               if (i == end) return(FALSE);
+              }
+            if ((text[i] == '\b') || (text[i] == EOS)) return(FALSE);
+            theChunk->strings[theChunk->stringsUsed++] = text[i++];
+           }
+         if (i == end) return(FALSE);
+         i++;
+
+         theChunk->strings[theChunk->stringsUsed++] = EOS;
+         theAtom = AddChunkAtom(theChunk,STRING,stringStart,theChunk->stringsUsed - stringStart - 1);
+         if ((theAtom < 0) || (! AddChunkToken(theChunk,theAtom))) return(FALSE);
+         continue;
+        }
+
+      /*=====================================================*/
+      /* Symbols and numbers run up to the next delimiter.   */
+      /* Characters which may end a symbol in the middle     */
+      /* of a run, or which start a variable, an instance    */
+      /* name or a constraint, are left to the scanner.      */
+      /*=====================================================*/
+
+      runStart = i;
+      while (i < end)
+        {
+         inchar = (unsigned char) text[i];
+         if ((inchar == '(') || (inchar == ')') || (inchar == '"') ||
+             (inchar == ';') || (inchar == ' ') || (inchar == '\n') ||
+             (inchar == '\f') || (inchar == '\r') || (inchar == '\t'))
+           { break; }
+         if ((inchar < 33) || (inchar > 126) ||
+             (inchar == '<') || (inchar == '&') || (inchar == '|') || (inchar == '~'))
+           { return(FALSE); }
+         i++;
+        }
+
+      inchar = (unsigned char) text[runStart];
+      if ((inchar == '?') || (inchar == '[') ||
+          ((inchar == '$') && ((i - runStart) > 1) && (text[runStart + 1] == '?')))
+        { return(FALSE); }
+
+      type = SYMBOL;
+      if (((inchar >= '0') && (inchar <= '9')) ||
+          (inchar == '+') || (inchar == '-') || (inchar == '.'))
+        {
+         type = ScanLoadedNumber(text + runStart,i - runStart,&integerValue,&floatValue);
+         if (type == RVOID) return(FALSE);
+        }
+
+      if (! ReserveChunkStrings(theChunk,i - runStart + 1)) return(FALSE);
+      stringStart = theChunk->stringsUsed;
+      memcpy(theChunk->strings + stringStart,text + runStart,i - runStart);
+      theChunk->stringsUsed += i - runStart;
+      theChunk->strings[theChunk->stringsUsed++] = EOS;
+
+      theAtom = AddChunkAtom(theChunk,type,stringStart,i - runStart);
+      if (theAtom < 0) return(FALSE);
+
+      if (type == INTEGER)
+        { theChunk->atoms[theAtom].integerValue = integerValue; }
+      else if (type == FLOAT)
+        { theChunk->atoms[theAtom].floatValue = floatValue; }
+
+      if (! AddChunkToken(theChunk,theAtom)) return(FALSE);
+     }
+
+   return(TRUE);
+  }
+
+/************************************************************/
+/* ScanLoadedNumber: Classifies a run of characters which   */
+/*   starts like a number in the same way as the scanner:   */
+/*   an optional sign, integral digits, a decimal point     */
+/*   with decimal digits and an exponent. Anything else, or */
+/*   a number without integral or decimal digits, is a      */
+/*   symbol. Returns RVOID if the integer would overflow,   */
+/*   for which the scanner prints a warning.                */
+/************************************************************/
+static unsigned short ScanLoadedNumber(
+  char *text,
+  size_t length,
+  long long *integerValue,
+  double *floatValue)
+  {
+   char theNumber[64];
+   size_t i = 0;
+   int phase = -1;
+   int digitFound = FALSE, processFloat = FALSE;
+   int inchar;
+
+   for (i = 0; i < length; i++)
+     {
+      inchar = (unsigned char) text[i];
+
+      if ((phase == -1) && ((inchar == '+') || (inchar == '-')))
+        { phase = 0; }
+      else if ((phase <= 1) && (inchar >= '0') && (inchar <= '9'))
+        {
+         if (phase == -1) phase = 0;
+         digitFound = TRUE;
+        }
+      else if ((phase <= 0) && (inchar == '.'))
+        {
+         processFloat = TRUE;
+         phase = 1;
+        }
+      else if ((phase <= 1) && ((inchar == 'e') || (inchar == 'E')))
+        {
+         processFloat = TRUE;
+         phase = 2;
+        }
+      else if ((phase == 2) &&
+               (((inchar >= '0') && (inchar <= '9')) || (inchar == '+') || (inchar == '-')))
+        { phase = 3; }
+      else if ((phase == 3) && (inchar >= '0') && (inchar <= '9'))
+        { /* Do nothing */ }
+      else
+        { return(SYMBOL); }
+     }
+
+   if ((phase == 2) ||
+       ((phase == 3) && ((text[length - 1] == '+') || (text[length - 1] == '-'))))
+     { digitFound = FALSE; }
+
+   if ((! digitFound) || (length >= sizeof(theNumber)))
+     { return(digitFound ? RVOID : SYMBOL); }
+
+   memcpy(theNumber,text,length);
+   theNumber[length] = EOS;
+
+   if (processFloat)
+     {
+      *floatValue = atof(theNumber);
+      return(FLOAT);
+     }
+
+   errno = 0;
+   *integerValue = strtoll(theNumber,NULL,10);
+   if (errno) return(RVOID);
+
+   return(INTEGER);
+  }
+
+/***************************************************/
+/* AddChunkToken: Appends a token to a chunk.      */
+/***************************************************/
+static intBool AddChunkToken(
+  struct loadFactsChunk *theChunk,
+  long theToken)
+  {
+   long *newTokens;
+   size_t newMax;
+
+   if (theChunk->tokenCount == theChunk->tokenMax)
+     {
+      newMax = (theChunk->tokenMax == 0) ? 4096 : (theChunk->tokenMax * 2);
+      newTokens = (long *) realloc(theChunk->tokens,sizeof(long) * newMax);
+      if (newTokens == NULL) return(FALSE);
+      theChunk->tokens = newTokens;
+      theChunk->tokenMax = newMax;
+     }
+
+   theChunk->tokens[theChunk->tokenCount++] = theToken;
+   return(TRUE);
+  }
+
+/*****************************************************/
+/* ReserveChunkStrings: Makes room for the specified */
+/*   number of bytes in the string buffer of a chunk.*/
+/*****************************************************/
+static intBool ReserveChunkStrings(
+  struct loadFactsChunk *theChunk,
+  size_t size)
+  {
+   char *newStrings;
+   size_t newMax;
+
+   if ((theChunk->stringsMax - theChunk->stringsUsed) >= size) return(TRUE);
+
+   newMax = (theChunk->stringsMax == 0) ? 16384 : (theChunk->stringsMax * 2);
+   while ((newMax - theChunk->stringsUsed) < size)
+     { newMax *= 2; }
+
+   newStrings = (char *) realloc(theChunk->strings,newMax);
+   if (newStrings == NULL) return(FALSE);
+   theChunk->strings = newStrings;
+   theChunk->stringsMax = newMax;
+
+   return(TRUE);
+  }
+
+/************************************************************/
+/* AddChunkAtom: Returns the index of the atom whose text   */
+/*   was just added to the string buffer of the chunk. If   */
+/*   the chunk already has the atom, the text is removed    */
+/*   from the buffer again. Returns -1 if memory runs out.  */
+/************************************************************/
+static long AddChunkAtom(
+  struct loadFactsChunk *theChunk,
+  unsigned short type,
+  size_t offset,
+  size_t length)
+  {
+   unsigned long hashValue = 2166136261UL;
+   size_t i, slot, newSize;
+   long *newTable, theAtom;
+   struct loadFactsAtom *newAtoms;
+   char *text = theChunk->strings + offset;
+
+   for (i = 0; i < length; i++)
+     { hashValue = (hashValue ^ (unsigned char) text[i]) * 16777619UL; }
+   hashValue = (hashValue ^ type) * 16777619UL;
+
+   /*=============================================*/
+   /* Keep the table of atoms at most half full.  */
+   /*=============================================*/
+
+   if (((theChunk->atomCount + 1) * 2) > theChunk->atomTableSize)
+     {
+      newSize = (theChunk->atomTableSize == 0) ? 1024 : (theChunk->atomTableSize * 2);
+      newTable = (long *) malloc(sizeof(long) * newSize);
+      if (newTable == NULL) return(-1L);
+      for (i = 0; i < newSize; i++)
+        { newTable[i] = -1L; }
+      for (theAtom = 0; theAtom < (long) theChunk->atomCount; theAtom++)
+        {
+         slot = theChunk->atoms[theAtom].hashValue & (newSize - 1);
+         while (newTable[slot] != -1L)
+           { slot = (slot + 1) & (newSize - 1); }
+         newTable[slot] = theAtom;
+        }
+      if (theChunk->atomTable != NULL) free(theChunk->atomTable);
+      theChunk->atomTable = newTable;
+      theChunk->atomTableSize = newSize;
+     }
+
+   slot = hashValue & (theChunk->atomTableSize - 1);
+   while ((theAtom = theChunk->atomTable[slot]) != -1L)
+     {
+      if ((theChunk->atoms[theAtom].hashValue == hashValue) &&
+          (theChunk->atoms[theAtom].type == type) &&
+          (theChunk->atoms[theAtom].length == length) &&
+          (memcmp(theChunk->strings + theChunk->atoms[theAtom].offset,text,length) == 0))
+        {
+         theChunk->stringsUsed = offset;
+         return(theAtom);
+        }
+      slot = (slot + 1) & (theChunk->atomTableSize - 1);
+     }
+
+   if (theChunk->atomCount == theChunk->atomMax)
+     {
+      newSize = (theChunk->atomMax == 0) ? 512 : (theChunk->atomMax * 2);
+      newAtoms = (struct loadFactsAtom *) realloc(theChunk->atoms,sizeof(struct loadFactsAtom) * newSize);
+      if (newAtoms == NULL) return(-1L);
+      theChunk->atoms = newAtoms;
+      theChunk->atomMax = newSize;
+     }
+
+   theAtom = (long) theChunk->atomCount++;
+   theChunk->atoms[theAtom].type = type;
+   theChunk->atoms[theAtom].offset = offset;
+   theChunk->atoms[theAtom].length = length;
+   theChunk->atoms[theAtom].hashValue = hashValue;
+   theChunk->atoms[theAtom].integerValue = 0;
+   theChunk->atoms[theAtom].floatValue = 0.0;
+   theChunk->atoms[theAtom].value = NULL;
+   theChunk->atomTable[slot] = theAtom;
+
+   return(theAtom);
+  }
+
+/*******************************************/
+/* FreeFactsChunk: Frees a chunk after its */
+/*   facts have been asserted.             */
+/*******************************************/
+static void FreeFactsChunk(
+  struct loadFactsChunk *theChunk)
+  {
+   if (theChunk->text != NULL) free(theChunk->text);
+   if (theChunk->entries != NULL) free(theChunk->entries);
+   if (theChunk->tokens != NULL) free(theChunk->tokens);
+   if (theChunk->atoms != NULL) free(theChunk->atoms);
+   if (theChunk->atomTable != NULL) free(theChunk->atomTable);
+   if (theChunk->strings != NULL) free(theChunk->strings);
+   free(theChunk);
+  }
+
+/************************************************************/
+/* AssertFactsChunk: Asserts the facts of a parsed chunk in */
+/*   file order. Returns FALSE if loading has to stop.      */
+/************************************************************/
+static intBool AssertFactsChunk(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsPipeline *thePipeline,
+  struct loadFactsChunk *theChunk)
+  {
+   size_t i;
+   struct loadFactsEntry *theEntry;
+   int rv;
+
+   for (i = 0; i < theChunk->entryCount; i++)
+     {
+      theEntry = &theChunk->entries[i];
+
+      if (theEntry->kind == FACT_ENTRY_TOKENS)
+        {
+         rv = BuildLoadedFact(theEnv,execStatus,thePipeline,theChunk,theEntry);
+         if (rv == LOADED_FACT_BATCHED) continue;
+         if (rv == LOADED_FACT_ISOLATED)
+           {
+            FlushLoadedFacts(theEnv,execStatus,thePipeline);
+            continue;
+           }
+        }
+
+      /*==============================================*/
+      /* The facts before this one have to be         */
+      /* asserted before the standard parser runs.    */
+      /*==============================================*/
+
+      FlushLoadedFacts(theEnv,execStatus,thePipeline);
+      if (ParseFactEntry(theEnv,execStatus,thePipeline,theChunk,theEntry) == FALSE)
+        { return(FALSE); }
+     }
+
+   return(TRUE);
+  }
+
+/*************************************************************/
+/* BuildLoadedFact: Builds the fact of an entry from its     */
+/*   tokens and places it in the batch of facts to assert.   */
+/*   The fact has to be an ordered fact or a deftemplate     */
+/*   fact with constant values only, and must pass the       */
+/*   checks of the standard parser. Returns                  */
+/*   LOADED_FACT_PARSE otherwise, leaving the fact to the    */
+/*   standard parser.                                        */
+/*   A fact which needs a dynamic default evaluated is       */
+/*   asserted at once, since the evaluation could depend on  */
+/*   the facts asserted before it (LOADED_FACT_ISOLATED).    */
+/*************************************************************/
+static int BuildLoadedFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsPipeline *thePipeline,
+  struct loadFactsChunk *theChunk,
+  struct loadFactsEntry *theEntry)
+  {
+   long *tokens = theChunk->tokens + theEntry->firstToken;
+   size_t count = theEntry->tokenCount, i, j, valueCount;
+   struct deftemplate *theDeftemplate;
+   struct templateSlot *slotPtr;
+   struct fact *theFact;
+   struct multifield *theSegment;
+   SYMBOL_HN *theName;
+   char *slotName;
+   int position;
+   intBool missingSlots = FALSE, dynamicDefaults = FALSE;
+
+   /*========================================*/
+   /* The relation name has to be a symbol   */
+   /* other than = and :.                    */
+   /*========================================*/
+
+   if ((count < 3) || (tokens[1] < 0) ||
+       (theChunk->atoms[tokens[1]].type != SYMBOL))
+     { return(LOADED_FACT_PARSE); }
+
+   theName = (SYMBOL_HN *) LoadedAtomValue(theEnv,execStatus,theChunk,tokens[1]);
+   if ((strcmp(ValueToString(theName),"=") == 0) ||
+       (strcmp(ValueToString(theName),":") == 0))
+     { return(LOADED_FACT_PARSE); }
+
+   theDeftemplate = FindLoadedDeftemplate(theEnv,execStatus,thePipeline,theName);
+   if (theDeftemplate == NULL) return(LOADED_FACT_PARSE);
+
+   /*========================================*/
+   /* The values of an ordered fact go into  */
+   /* the implied multifield slot.           */
+   /*========================================*/
+
+   if (theDeftemplate->implied)
+     {
+      valueCount = count - 3;
+      for (i = 2; i < count - 1; i++)
+        {
+         if ((tokens[i] < 0) ||
+             ((theChunk->atoms[tokens[i]].type == SYMBOL) &&
+              (theChunk->atoms[tokens[i]].length == 1) &&
+              (theChunk->strings[theChunk->atoms[tokens[i]].offset] == '=')))
+           { return(LOADED_FACT_PARSE); }
+        }
+
+      theFact = CreateFactBySize(theEnv,execStatus,1);
+      theFact->whichDeftemplate = theDeftemplate;
+      theSegment = (struct multifield *) CreateMultifield2(theEnv,execStatus,(long) valueCount);
+      for (i = 0; i < valueCount; i++)
+        {
+         theSegment->theFields[i].type = theChunk->atoms[tokens[i + 2]].type;
+         theSegment->theFields[i].value = LoadedAtomValue(theEnv,execStatus,theChunk,tokens[i + 2]);
+        }
+      theFact->theProposition.theFields[0].type = MULTIFIELD;
+      theFact->theProposition.theFields[0].value = (void *) theSegment;
+
+      thePipeline->batch[thePipeline->batchCount++] = theFact;
+      if (thePipeline->batchCount == LOAD_FACTS_BATCH_SIZE)
+        { FlushLoadedFacts(theEnv,execStatus,thePipeline); }
+      return(LOADED_FACT_BATCHED);
+     }
+
+   /*=========================================*/
+   /* The slots of a deftemplate fact are     */
+   /* given as (<slot-name> <value>*) lists.  */
+   /*=========================================*/
+
+   theFact = CreateFactBySize(theEnv,execStatus,theDeftemplate->numberOfSlots);
+   theFact->whichDeftemplate = theDeftemplate;
+   for (i = 0; i < theDeftemplate->numberOfSlots; i++)
+     { theFact->theProposition.theFields[i].type = RVOID; }
+
+   i = 2;
+   while (tokens[i] != LOAD_TOKEN_RPAREN)
+     {
+      if ((tokens[i] != LOAD_TOKEN_LPAREN) || (tokens[i + 1] < 0) ||
+          (theChunk->atoms[tokens[i + 1]].type != SYMBOL))
+        {
+         ReturnFact(theEnv,execStatus,theFact);
+         return(LOADED_FACT_PARSE);
+        }
+
+      /*=====================================*/
+      /* Find the slot by name. A slot given */
+      /* twice is an error.                  */
+      /*=====================================*/
+
+      slotName = theChunk->strings + theChunk->atoms[tokens[i + 1]].offset;
+      for (slotPtr = theDeftemplate->slotList, position = 0;
+           slotPtr != NULL;
+           slotPtr = slotPtr->next, position++)
+        { if (strcmp(ValueToString(slotPtr->slotName),slotName) == 0) break; }
+
+      if ((slotPtr == NULL) ||
+          (theFact->theProposition.theFields[position].type != RVOID))
+        {
+         ReturnFact(theEnv,execStatus,theFact);
+         return(LOADED_FACT_PARSE);
+        }
+
+      i += 2;
+      for (valueCount = 0; tokens[i + valueCount] >= 0; valueCount++)
+        { /* Do nothing */ }
+
+      if ((tokens[i + valueCount] != LOAD_TOKEN_RPAREN) ||
+          ((! slotPtr->multislot) && (valueCount != 1)) ||
+          (slotPtr->multislot && EnvGetStaticConstraintChecking(theEnv,execStatus) &&
+           (! CheckCardinalityConstraint(theEnv,execStatus,(long) valueCount,slotPtr->constraints))))
+        {
+         ReturnFact(theEnv,execStatus,theFact);
+         return(LOADED_FACT_PARSE);
+        }
+
+      if (slotPtr->multislot)
+        {
+         theSegment = (struct multifield *) CreateMultifield2(theEnv,execStatus,(long) valueCount);
+         theFact->theProposition.theFields[position].type = MULTIFIELD;
+         theFact->theProposition.theFields[position].value = (void *) theSegment;
+         for (j = 0; j < valueCount; j++)
+           {
+            if (! LoadedValueAllowed(theEnv,execStatus,theChunk,tokens[i + j],slotPtr,
+                                     &theSegment->theFields[j]))
+              {
+               ReturnFact(theEnv,execStatus,theFact);
+               return(LOADED_FACT_PARSE);
+              }
+           }
+        }
+      else if (! LoadedValueAllowed(theEnv,execStatus,theChunk,tokens[i],slotPtr,
+                                    &theFact->theProposition.theFields[position]))
+        {
+         ReturnFact(theEnv,execStatus,theFact);
+         return(LOADED_FACT_PARSE);
+        }
+
+      i += valueCount + 1;
+     }
+
+   /*===============================================*/
+   /* Slots which were not given get their default  */
+   /* values. A slot without a default is an error. */
+   /*===============================================*/
+
+   for (slotPtr = theDeftemplate->slotList, position = 0;
+        slotPtr != NULL;
+        slotPtr = slotPtr->next, position++)
+     {
+      if (theFact->theProposition.theFields[position].type != RVOID) continue;
+
+      if (slotPtr->noDefault)
+        {
+         ReturnFact(theEnv,execStatus,theFact);
+         return(LOADED_FACT_PARSE);
+        }
+
+      missingSlots = TRUE;
+      if (slotPtr->defaultDynamic) dynamicDefaults = TRUE;
+     }
+
+   if (dynamicDefaults) FlushLoadedFacts(theEnv,execStatus,thePipeline);
+
+   if (missingSlots) EnvAssignFactSlotDefaults(theEnv,execStatus,theFact);
+
+   thePipeline->batch[thePipeline->batchCount++] = theFact;
+   if (dynamicDefaults) return(LOADED_FACT_ISOLATED);
+
+   if (thePipeline->batchCount == LOAD_FACTS_BATCH_SIZE)
+     { FlushLoadedFacts(theEnv,execStatus,thePipeline); }
+   return(LOADED_FACT_BATCHED);
+  }
+
+/************************************************************/
+/* LoadedAtomValue: Returns the symbol table entry of an    */
+/*   atom of a chunk, adding it on its first use.           */
+/************************************************************/
+static void *LoadedAtomValue(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsChunk *theChunk,
+  long theAtom)
+  {
+   struct loadFactsAtom *atomPtr = &theChunk->atoms[theAtom];
+
+   if (atomPtr->value != NULL) return(atomPtr->value);
+
+   switch (atomPtr->type)
+     {
+      case INTEGER:
+        atomPtr->value = EnvAddLong(theEnv,execStatus,atomPtr->integerValue);
+        break;
+
+      case FLOAT:
+        atomPtr->value = EnvAddDouble(theEnv,execStatus,atomPtr->floatValue);
+        break;
+
+      default:
+        atomPtr->value = EnvAddSymbol(theEnv,execStatus,theChunk->strings + atomPtr->offset);
+        break;
+     }
+
+   return(atomPtr->value);
+  }
+
+/************************************************************/
+/* LoadedValueAllowed: Stores an atom as the value of a     */
+/*   slot field. Returns FALSE if the atom can not be a     */
+/*   literal slot value (the = of a function call), or if   */
+/*   static constraint checking rejects it.                 */
+/************************************************************/
+static intBool LoadedValueAllowed(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsChunk *theChunk,
+  long theAtom,
+  struct templateSlot *slotPtr,
+  struct field *theField)
+  {
+   struct loadFactsAtom *atomPtr = &theChunk->atoms[theAtom];
+
+   theField->type = atomPtr->type;
+   theField->value = LoadedAtomValue(theEnv,execStatus,theChunk,theAtom);
+
+   if ((atomPtr->type == SYMBOL) && (atomPtr->length == 1) &&
+       (theChunk->strings[atomPtr->offset] == '='))
+     { return(FALSE); }
+
+   if (EnvGetStaticConstraintChecking(theEnv,execStatus) &&
+       (ConstraintCheckValue(theEnv,execStatus,theField->type,theField->value,
+                             slotPtr->constraints) != NO_VIOLATION))
+     { return(FALSE); }
+
+   return(TRUE);
+  }
+
+/************************************************************/
+/* FindLoadedDeftemplate: Finds the deftemplate of a fact   */
+/*   as the standard parser does, creating an implied       */
+/*   deftemplate if none exists. Returns NULL if the        */
+/*   standard parser would report an error for the name.    */
+/************************************************************/
+static struct deftemplate *FindLoadedDeftemplate(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsPipeline *thePipeline,
+  SYMBOL_HN *theName)
+  {
+   struct deftemplate *theDeftemplate;
+   unsigned int i;
+   int count;
+
+   for (i = 0; i < LOAD_FACTS_TEMPLATE_CACHE; i++)
+     {
+      if (thePipeline->templates[i].name == theName)
+        { return(thePipeline->templates[i].theDeftemplate); }
+     }
+
+   if (ReservedPatternSymbol(theEnv,execStatus,ValueToString(theName),NULL) ||
+       FindModuleSeparator(ValueToString(theName)))
+     { return(NULL); }
+
+   theDeftemplate = (struct deftemplate *)
+                    FindImportedConstruct(theEnv,execStatus,"deftemplate",NULL,ValueToString(theName),
+                                          &count,TRUE,NULL);
+   if (count > 1) return(NULL);
+
+   if (theDeftemplate == NULL)
+     {
+      if (ConstructData(theEnv,execStatus)->CheckSyntaxMode) return(NULL);
+#if BLOAD || BLOAD_AND_BSAVE
+      if (Bloaded(theEnv,execStatus)) return(NULL);
+#endif
+#if DEFMODULE_CONSTRUCT
+      if (FindImportExportConflict(theEnv,execStatus,"deftemplate",
+                                   (struct defmodule *) EnvGetCurrentModule(theEnv,execStatus),
+                                   ValueToString(theName)))
+        { return(NULL); }
+#endif
+      theDeftemplate = CreateImpliedDeftemplate(theEnv,execStatus,theName,TRUE);
+      if (theDeftemplate == NULL) return(NULL);
+     }
+
+   thePipeline->templates[thePipeline->nextTemplate].name = theName;
+   thePipeline->templates[thePipeline->nextTemplate].theDeftemplate = theDeftemplate;
+   thePipeline->nextTemplate = (thePipeline->nextTemplate + 1) % LOAD_FACTS_TEMPLATE_CACHE;
+
+   return(theDeftemplate);
+  }
+
+/***********************************************/
+/* FlushLoadedFacts: Asserts the facts built   */
+/*   so far in one batch.                      */
+/***********************************************/
+static void FlushLoadedFacts(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsPipeline *thePipeline)
+  {
+   if (thePipeline->batchCount == 0) return;
+
+   EnvAssertBatch(theEnv,execStatus,thePipeline->batch,thePipeline->batchCount);
+   thePipeline->batchCount = 0;
+  }
+
+/***********************************************************/
+/* ParseFactEntry: Loads a fact with the standard parser.  */
+/*   The text of the fact is read through a string router, */
+/*   so the fact is parsed and its errors are reported     */
+/*   exactly as when reading the file. If an error occurs, */
+/*   the line at which the fact starts is printed as well. */
+/*   Returns FALSE if loading has to stop.                 */
+/***********************************************************/
+static intBool ParseFactEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct loadFactsPipeline *thePipeline,
+  struct loadFactsChunk *theChunk,
+  struct loadFactsEntry *theEntry)
+  {
+   char *theStrRouter = "*** load-facts ***";
+   char printSpace[40];
+   intBool rv;
+
+   if (! OpenTextSource(theEnv,execStatus,theStrRouter,theChunk->text,
+                        theEntry->start,theEntry->end))
+     { return(FALSE); }
+
+   rv = LoadFactFromSource(theEnv,execStatus,theStrRouter);
+
+   CloseStringSource(theEnv,execStatus,theStrRouter);
+
+   if ((rv == FALSE) && execStatus->EvaluationError)
+     {
+      PrintErrorID(theEnv,execStatus,"FACTLOAD",1,FALSE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"The fact in error starts at line ");
+      gensprintf(printSpace,"%ld",theEntry->line);
+      EnvPrintRouter(theEnv,execStatus,WERROR,printSpace);
+      EnvPrintRouter(theEnv,execStatus,WERROR," of ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,thePipeline->fileName);
+      EnvPrintRouter(theEnv,execStatus,WERROR,".\n");
+     }
+
+   return(rv);
+  }
+
+#endif /* DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT && LOAD_FACTS_PIPELINE */
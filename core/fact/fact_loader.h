@@ -0,0 +1,70 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*               FACT FILE LOADER HEADER FILE          */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Loads large fact files for the load-facts        */
+/*   command with a pipeline which tokenizes the file on     */
+/*   the fact threads while the facts read so far are        */
+/*   asserted.                                               */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_factload
+
+#define _H_factload
+
+#ifndef _STDIO_INCLUDED_
+#define _STDIO_INCLUDED_
+#include <stdio.h>
+#endif
+
+#ifndef _H_evaluatn
+#include "evaluatn.h"
+#endif
+
+# include "execution_status.h"
+
+/*=====================================================*/
+/* Files smaller than this are loaded by the standard  */
+/* parser alone, since starting the pipeline does not  */
+/* pay off for a few hundred facts.                    */
+/*=====================================================*/
+
+#define LOAD_FACTS_PIPELINE_MIN_SIZE 65536L
+
+/*====================================================*/
+/* Number of bytes of fact text handed to a parser    */
+/* thread at a time, and number of facts asserted in  */
+/* one batch by the ordered stage.                    */
+/*====================================================*/
+
+#define LOAD_FACTS_CHUNK_SIZE        65536
+#define LOAD_FACTS_BATCH_SIZE        1024
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _FACTLOAD_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+#if LOAD_FACTS_PIPELINE
+   LOCALE intBool                        LoadFactsPipelineApplies(void *,EXEC_STATUS,FILE *);
+   LOCALE intBool                        LoadFactsPipelined(void *,EXEC_STATUS,char *,FILE *);
+#endif
+
+#endif
@@ -39,6 +39,7 @@
 
 #include <stdio.h>
 #define _STDIO_INCLUDED_
+#include <string.h>
 
 #include "setup.h"
 
@@ -68,11 +69,15 @@
 #include "utility.h"
 #include "factbin.h"
 #include "fact_manager.h"
+#include "fact_scheduler.h"
+#include "fact_events.h"
+#include "fact_binfile.h"
 #include "facthsh.h"
 #include "default.h"
 #include "commline.h"
 #include "envrnmnt.h"
 #include "sysdep.h"
+#include "tmpltidx.h"
 
 #include "engine.h"
 #include "lgcldpnd.h"
@@ -95,7 +100,14 @@
    static void                    ResetFacts(void *,EXEC_STATUS);
    static int                     ClearFactsReady(void *,EXEC_STATUS);
    static void                    RemoveGarbageFacts(void *,EXEC_STATUS);
+   static long                    FactBasisCount(void *,EXEC_STATUS,struct fact *);
    static void                    DeallocateFactData(void *,EXEC_STATUS);
+   static void                    ReplaceVoidFields(void *,EXEC_STATUS,struct fact *);
+   static void                    InstallAssertedFact(void *,EXEC_STATUS,struct fact *);
+   static void                    MatchFactBatch(void *,EXEC_STATUS,struct fact **,size_t);
+   static void                    AddIndexedFact(void *,EXEC_STATUS,struct fact *);
+   static void                    RemoveIndexedFact(void *,EXEC_STATUS,struct fact *);
+   static void                    ReleaseFactIndex(void *,EXEC_STATUS);
 
 /**************************************************************/
 /* InitializeFacts: Initializes the fact data representation. */
@@ -122,7 +134,7 @@ globle void InitializeFacts(
                                                  };
                                                  
    struct fact dummyFact = { { NULL, NULL, 0, 0L }, NULL, NULL, -1L, 0, 0, 1,
-                                  NULL, NULL, NULL, NULL, { 1, 0, 0UL, NULL, { { 0, NULL } } } };
+                                  NULL, NULL, NULL, NULL, NULL, { 1, 0, 0UL, NULL, { { 0, NULL } } } };
    
    AllocateEnvironmentData(theEnv,execStatus,FACTS_DATA,sizeof(struct factsData),DeallocateFactData);
 
@@ -138,6 +150,21 @@ globle void InitializeFacts(
 
    InitializeFactHashTable(theEnv,execStatus);
 
+   /*========================================*/
+   /* Initialize the scheduler which spreads */
+   /* the pattern matching of asserted facts */
+   /* over the matcher thread pool.          */
+   /*========================================*/
+
+   InitializeMatchScheduler(theEnv,execStatus);
+
+   /*=======================================*/
+   /* Initialize the bounded queue of facts */
+   /* handed to the fact threads as events. */
+   /*=======================================*/
+
+   InitializeFactEvents(theEnv,execStatus);
+
    /*============================================*/
    /* Initialize the fact callback functions for */
    /* use with the reset and clear commands.     */
@@ -174,6 +201,9 @@ globle void InitializeFacts(
 
    FactCommandDefinitions(theEnv,execStatus);
    FactFunctionDefinitions(theEnv,execStatus);
+#if BLOAD_FACTS || BSAVE_FACTS
+   FactBinaryFileDefinitions(theEnv,execStatus);
+#endif
    
    /*==============================*/
    /* Initialize fact set queries. */
@@ -210,25 +240,19 @@ static void DeallocateFactData(
   void *theEnv,
   EXEC_STATUS)
   {
-   struct factHashEntry *tmpFHEPtr, *nextFHEPtr;
    struct fact *tmpFactPtr, *nextFactPtr;
-   unsigned long i;
    struct patternMatch *theMatch, *tmpMatch;
+
+   /*==================================================*/
+   /* Facts may not be released while events are still */
+   /* pending or the matcher pool is still matching    */
+   /* them against the network.                        */
+   /*==================================================*/
+
+   EnvWaitForPendingEvents(theEnv,execStatus);
    
-   for (i = 0; i < FactData(theEnv,execStatus)->FactHashTableSize; i++) 
-     {
-      tmpFHEPtr = FactData(theEnv,execStatus)->FactHashTable[i];
-      
-      while (tmpFHEPtr != NULL)
-        {
-         nextFHEPtr = tmpFHEPtr->next;
-         rtn_struct(theEnv,execStatus,factHashEntry,tmpFHEPtr);
-         tmpFHEPtr = nextFHEPtr;
-        }
-     }
-  
-   rm3(theEnv,execStatus,FactData(theEnv,execStatus)->FactHashTable,
-       sizeof(struct factHashEntry *) * FactData(theEnv,execStatus)->FactHashTableSize);
+   DeallocateFactHashTable(theEnv,execStatus);
+   ReleaseFactIndex(theEnv,execStatus);
                  
    tmpFactPtr = FactData(theEnv,execStatus)->FactList;
    while (tmpFactPtr != NULL)
@@ -429,6 +453,7 @@ globle intBool EnvRetract(
   {
    struct fact *theFact = (struct fact *) vTheFact;
    struct deftemplate *theTemplate = theFact->whichDeftemplate;
+   double startTime;
 
    /*===========================================*/
    /* A fact can not be retracted while another */
@@ -453,6 +478,13 @@ globle intBool EnvRetract(
       return(TRUE);
      }
 
+   /*=================================================*/
+   /* Let the matcher pool finish matching previously */
+   /* asserted facts before unlinking the fact.       */
+   /*=================================================*/
+
+   WaitForMatchingTasks(theEnv,execStatus);
+
    /*======================================================*/
    /* Check to see if the fact has already been retracted. */
    /*======================================================*/
@@ -494,6 +526,22 @@ globle intBool EnvRetract(
 
    RemoveHashedFact(theEnv,execStatus,theFact);
 
+   /*============================================*/
+   /* Remove the fact from the fact index pages. */
+   /*============================================*/
+
+   RemoveIndexedFact(theEnv,execStatus,theFact);
+
+#if DEFINDEX_CONSTRUCT
+   /*===========================================*/
+   /* Remove the fact from the slot indexes of  */
+   /* its deftemplate.                          */
+   /*===========================================*/
+
+   if (theFact->indexEntries != NULL)
+     { RemoveFactFromDefindexes(theEnv,execStatus,theFact); }
+#endif
+
    /*=========================================*/
    /* Remove the fact from its template list. */
    /*=========================================*/
@@ -564,9 +612,16 @@ globle intBool EnvRetract(
    /* retract operation for each one.           */
    /*===========================================*/
 
+   startTime = gentime();
+
+   LockJoinNetwork(theEnv,execStatus);
    EngineData(theEnv,execStatus)->MatchOperationInProgress = TRUE;
    NetworkRetract(theEnv,execStatus,(struct patternMatch *) theFact->list);
    EngineData(theEnv,execStatus)->MatchOperationInProgress = FALSE;
+   UnlockJoinNetwork(theEnv,execStatus);
+
+   theTemplate->statistics.retracts++;
+   theTemplate->statistics.matchTime += gentime() - startTime;
 
    /*=========================================*/
    /* Free partial matches that were released */
@@ -581,178 +636,726 @@ globle intBool EnvRetract(
    /* dependent on the fact just retracted.   */
    /*=========================================*/
 
-   ForceLogicalRetractions(theEnv,execStatus);
+   ForceLogicalRetractions(theEnv,execStatus);
+
+   /*===========================================*/
+   /* Force periodic cleanup if the retract was */
+   /* executed from an embedded application.    */
+   /*===========================================*/
+
+   if ((execStatus->CurrentEvaluationDepth == 0) && (! CommandLineData(theEnv,execStatus)->EvaluatingTopLevelCommand) &&
+       (execStatus->CurrentExpression == NULL))
+     { PeriodicCleanup(theEnv,execStatus,TRUE,FALSE); }
+
+   /*==================================*/
+   /* Return TRUE to indicate the fact */
+   /* was successfully retracted.      */
+   /*==================================*/
+
+   return(TRUE);
+  }
+
+/*****************************************************************/
+/* ModifyFactInPlace: Gives a fact the slot values of a          */
+/*   replacement fact without retracting it. Only the alpha      */
+/*   matches of patterns which depend on a changed slot are      */
+/*   retracted, and the fact is matched again against these      */
+/*   patterns alone. The fact keeps its fact-index and gets a    */
+/*   new time tag. The replacement fact is returned to the       */
+/*   memory pool. Returns FALSE without changing anything when   */
+/*   the modify must be done as a retract followed by an assert: */
+/*   no slot value changes, the fact has logical support or      */
+/*   would get some, or the new values duplicate another fact.   */
+/*****************************************************************/
+globle intBool ModifyFactInPlace(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact,
+  struct fact *newFact)
+  {
+   struct patternMatch *theMatch, *nextMatch;
+   struct patternMatch *keptMatches = NULL, *lastKept = NULL, *changedMatches = NULL;
+   struct field *oldField, *newField;
+   char *slotMap;
+   unsigned mapSize;
+   unsigned short i, slotCount;
+   long basisCount, j;
+   intBool changed = FALSE;
+   double startTime;
+
+   if (EngineData(theEnv,execStatus)->MatchOperationInProgress)
+     { return(FALSE); }
+
+   WaitForMatchingTasks(theEnv,execStatus);
+
+   if (theFact->garbage ||
+       (theFact->factHeader.dependents != NULL) ||
+       (EngineData(theEnv,execStatus)->TheLogicalJoin != NULL))
+     { return(FALSE); }
+
+   /*==================================================*/
+   /* The values of a fact in the basis of the firing  */
+   /* rule have been installed once more for the rule, */
+   /* so they can be moved to the new values. Other    */
+   /* references to the fact may use the old values.   */
+   /*==================================================*/
+
+   basisCount = FactBasisCount(theEnv,execStatus,theFact);
+   if (theFact->factHeader.busyCount != (basisCount + 1))
+     { return(FALSE); }
+
+   /*=====================================*/
+   /* Determine which slots are changed.  */
+   /*=====================================*/
+
+   ReplaceVoidFields(theEnv,execStatus,newFact);
+
+   slotCount = (unsigned short) theFact->theProposition.multifieldLength;
+   mapSize = (unsigned) ((slotCount / BITS_PER_BYTE) + 1);
+   slotMap = (char *) gm2(theEnv,execStatus,mapSize);
+   ClearBitString((void *) slotMap,mapSize);
+
+   for (i = 0; i < slotCount; i++)
+     {
+      oldField = &theFact->theProposition.theFields[i];
+      newField = &newFact->theProposition.theFields[i];
+
+      if (oldField->type != newField->type)
+        { SetBitMap(slotMap,i); }
+      else if (oldField->type == MULTIFIELD)
+        {
+         if (! MultifieldsEqual((struct multifield *) oldField->value,
+                                (struct multifield *) newField->value))
+           { SetBitMap(slotMap,i); }
+        }
+      else if (oldField->value != newField->value)
+        { SetBitMap(slotMap,i); }
+
+      if (TestBitMap(slotMap,i))
+        { changed = TRUE; }
+     }
+
+   /*================================================*/
+   /* A modify which changes nothing is still a      */
+   /* retract and an assert: the fact gets a new     */
+   /* time tag and is matched again by every pattern */
+   /* so that rules it satisfies are reactivated.    */
+   /*================================================*/
+
+   if (! changed)
+     {
+      rm(theEnv,execStatus,(void *) slotMap,mapSize);
+      return(FALSE);
+     }
+
+   /*===========================================*/
+   /* A fact equal to the new values would be a */
+   /* duplicate, which a retract and an assert  */
+   /* handle according to fact-duplication.     */
+   /*===========================================*/
+
+   if ((! FactData(theEnv,execStatus)->FactDuplication) &&
+       (FindHashedFact(theEnv,execStatus,newFact) != NULL))
+     {
+      rm(theEnv,execStatus,(void *) slotMap,mapSize);
+      return(FALSE);
+     }
+
+   FactData(theEnv,execStatus)->ChangeToFactList = TRUE;
+
+   /*============================================*/
+   /* Take the fact out of the hash table and    */
+   /* the slot indexes while it has its old      */
+   /* values, which they are keyed on.           */
+   /*============================================*/
+
+   RemoveHashedFact(theEnv,execStatus,theFact);
+
+#if DEFINDEX_CONSTRUCT
+   if (theFact->indexEntries != NULL)
+     { RemoveFactFromDefindexes(theEnv,execStatus,theFact); }
+#endif
+
+   /*==============================================*/
+   /* Separate the alpha matches depending on the  */
+   /* changed slots from the ones which stay valid */
+   /* and retract them from the join network.      */
+   /*==============================================*/
+
+   for (theMatch = (struct patternMatch *) theFact->list;
+        theMatch != NULL;
+        theMatch = nextMatch)
+     {
+      nextMatch = theMatch->next;
+
+      if (FactPatternReadsSlots((struct factPatternNode *) theMatch->matchingPattern,slotMap,slotCount))
+        {
+         theMatch->next = changedMatches;
+         changedMatches = theMatch;
+        }
+      else
+        {
+         theMatch->next = NULL;
+         if (lastKept == NULL)
+           { keptMatches = theMatch; }
+         else
+           { lastKept->next = theMatch; }
+         lastKept = theMatch;
+        }
+     }
+
+   theFact->list = (void *) keptMatches;
+
+   SetEvaluationError(theEnv,execStatus,FALSE);
+
+   startTime = gentime();
+
+   LockJoinNetwork(theEnv,execStatus);
+   EngineData(theEnv,execStatus)->MatchOperationInProgress = TRUE;
+   NetworkRetract(theEnv,execStatus,changedMatches);
+   EngineData(theEnv,execStatus)->MatchOperationInProgress = FALSE;
+   UnlockJoinNetwork(theEnv,execStatus);
+
+   theFact->whichDeftemplate->statistics.matchTime += gentime() - startTime;
+
+   /*=====================================================*/
+   /* Store the new values. A replaced multifield may     */
+   /* still be referenced by the executing rule, so it is */
+   /* handed to the garbage collector rather than freed.  */
+   /*=====================================================*/
+
+   for (i = 0; i < slotCount; i++)
+     {
+      if (! TestBitMap(slotMap,i)) continue;
+
+      oldField = &theFact->theProposition.theFields[i];
+      newField = &newFact->theProposition.theFields[i];
+
+      for (j = 0; j <= basisCount; j++)
+        { AtomDeinstall(theEnv,execStatus,oldField->type,oldField->value); }
+      if (oldField->type == MULTIFIELD)
+        { AddToMultifieldList(theEnv,execStatus,(struct multifield *) oldField->value); }
+
+      oldField->type = newField->type;
+      oldField->value = newField->value;
+      for (j = 0; j <= basisCount; j++)
+        { AtomInstall(theEnv,execStatus,oldField->type,oldField->value); }
+
+      if (newField->type == MULTIFIELD)
+        {
+         newField->type = SYMBOL;
+         newField->value = EnvFalseSymbol(theEnv,execStatus);
+        }
+     }
+
+   ReturnFact(theEnv,execStatus,newFact);
+
+   AddHashedFact(theEnv,execStatus,theFact,HashFact(theFact));
+
+#if DEFINDEX_CONSTRUCT
+   if (theFact->whichDeftemplate->indexList != NULL)
+     { AddFactToDefindexes(theEnv,execStatus,theFact); }
+#endif
+
+   theFact->factHeader.timeTag = DefruleData(theEnv,execStatus)->CurrentEntityTimeTag++;
+
+#if DEBUGGING_FUNCTIONS
+   if (theFact->whichDeftemplate->watch)
+     {
+      EnvPrintRouter(theEnv,execStatus,WTRACE,"<=> ");
+      PrintFactWithIdentifier(theEnv,execStatus,WTRACE,theFact);
+      EnvPrintRouter(theEnv,execStatus,WTRACE,"\n");
+     }
+#endif
+
+   CheckTemplateFact(theEnv,execStatus,theFact);
+
+   /*==============================================*/
+   /* Match the fact again against the patterns    */
+   /* which depend on the changed slots. The other */
+   /* stop nodes are skipped by the matcher.       */
+   /*==============================================*/
+
+   SetEvaluationError(theEnv,execStatus,FALSE);
+
+   FactData(theEnv,execStatus)->ModifiedFact = theFact;
+   FactData(theEnv,execStatus)->ModifiedSlots = slotMap;
+
+   startTime = gentime();
+
+   LockJoinNetwork(theEnv,execStatus);
+   EngineData(theEnv,execStatus)->MatchOperationInProgress = TRUE;
+   FactPatternMatch(theEnv,execStatus,theFact,theFact->whichDeftemplate->patternNetwork,0,NULL,NULL);
+   EngineData(theEnv,execStatus)->MatchOperationInProgress = FALSE;
+   UnlockJoinNetwork(theEnv,execStatus);
+
+   theFact->whichDeftemplate->statistics.modifies++;
+   theFact->whichDeftemplate->statistics.matchTime += gentime() - startTime;
+
+   FactData(theEnv,execStatus)->ModifiedFact = NULL;
+   FactData(theEnv,execStatus)->ModifiedSlots = NULL;
+   rm(theEnv,execStatus,(void *) slotMap,mapSize);
+
+   /*=========================================*/
+   /* Free partial matches that were released */
+   /* and retract other facts that were       */
+   /* logically dependent on the old values.  */
+   /*=========================================*/
+
+   if (EngineData(theEnv,execStatus)->ExecutingRule == NULL)
+     { FlushGarbagePartialMatches(theEnv,execStatus); }
+
+   ForceLogicalRetractions(theEnv,execStatus);
+
+   if ((execStatus->CurrentEvaluationDepth == 0) && (! CommandLineData(theEnv,execStatus)->EvaluatingTopLevelCommand) &&
+       (execStatus->CurrentExpression == NULL))
+     { PeriodicCleanup(theEnv,execStatus,TRUE,FALSE); }
+
+   return(TRUE);
+  }
+
+/**************************************************************/
+/* FactBasisCount: Returns the number of times a fact is in   */
+/*   the basis of the executing rule. The values of the fact  */
+/*   have been installed once for each by the rule's firing.  */
+/**************************************************************/
+static long FactBasisCount(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct partialMatch *theBasis;
+   long count = 0;
+   unsigned short i;
+
+   if (EngineData(theEnv,execStatus)->ExecutingRule == NULL)
+     { return(0); }
+
+   theBasis = LocalEngineData(theEnv,execStatus).LHSBinds;
+   if (theBasis == NULL)
+     { return(0); }
+
+   for (i = 0; i < theBasis->bcount; i++)
+     {
+      if (theBasis->binds[i].gm.theMatch == NULL) continue;
+      if (theBasis->binds[i].gm.theMatch->matchingItem == (struct patternEntity *) theFact)
+        { count++; }
+     }
+
+   return(count);
+  }
+
+/******************************************/
+/* EnvGetModifyInPlace: C access routine  */
+/*   for the get-modify-in-place command. */
+/******************************************/
+globle intBool EnvGetModifyInPlace(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(FactData(theEnv,execStatus)->ModifyInPlace);
+  }
+
+/******************************************/
+/* EnvSetModifyInPlace: C access routine  */
+/*   for the set-modify-in-place command. */
+/******************************************/
+globle intBool EnvSetModifyInPlace(
+  void *theEnv,
+  EXEC_STATUS,
+  int value)
+  {
+   int ov;
+
+   ov = FactData(theEnv,execStatus)->ModifyInPlace;
+   FactData(theEnv,execStatus)->ModifyInPlace = value;
+   return(ov);
+  }
+
+/*******************************************************************/
+/* RemoveGarbageFacts: Returns facts that have been retracted to   */
+/*   the pool of available memory. It is necessary to postpone     */
+/*   returning the facts to memory because RHS actions retrieve    */
+/*   their variable bindings directly from the fact data structure */
+/*   and the facts may be in use in other data structures.         */
+/*******************************************************************/
+static void RemoveGarbageFacts(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct fact *factPtr, *nextPtr, *lastPtr = NULL;
+
+   factPtr = FactData(theEnv,execStatus)->GarbageFacts;
+
+   while (factPtr != NULL)
+     {
+      nextPtr = factPtr->nextFact;
+      if ((factPtr->factHeader.busyCount == 0) &&
+          (((int) factPtr->depth) > execStatus->CurrentEvaluationDepth))
+        {
+         UtilityData(theEnv,execStatus)->EphemeralItemCount--;
+         UtilityData(theEnv,execStatus)->EphemeralItemSize -= sizeof(struct fact) + (sizeof(struct field) * factPtr->theProposition.multifieldLength);
+         ReturnFact(theEnv,execStatus,factPtr);
+         if (lastPtr == NULL) FactData(theEnv,execStatus)->GarbageFacts = nextPtr;
+         else lastPtr->nextFact = nextPtr;
+        }
+      else
+        { lastPtr = factPtr; }
+
+      factPtr = nextPtr;
+     }
+  }
+
+
+
+/********************************************************/
+/* EnvAssert: C access routine for the assert function. */
+/********************************************************/
+globle void *EnvAssert(
+  void *theEnv,
+  EXEC_STATUS,
+  void *vTheFact,
+  int  goParallel)
+  {
+   struct fact *theFact = (struct fact *) vTheFact;
+   intBool duplicate;
+   double startTime;
+
+   /*==========================================*/
+   /* A fact can not be asserted while another */
+   /* fact is being asserted or retracted.     */
+   /*==========================================*/
+
+   if (EngineData(theEnv,execStatus)->MatchOperationInProgress)
+     {
+      ReturnFact(theEnv,execStatus,theFact);
+      PrintErrorID(theEnv,execStatus,"FACTMNGR",2,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"Facts may not be asserted during pattern-matching\n");
+      return(NULL);
+     }
+
+   /*=============================================================*/
+   /* Replace invalid data types in the fact with the symbol nil. */
+   /*=============================================================*/
+
+   ReplaceVoidFields(theEnv,execStatus,theFact);
+
+   /*========================================================*/
+   /* If fact assertions are being checked for duplications, */
+   /* then search the fact list for a duplicate fact. A fact */
+   /* which isn't a duplicate enters the fact hash table.    */
+   /*========================================================*/
+
+   HandleFactDuplication(theEnv,execStatus,theFact,&duplicate);
+   if (duplicate) return(NULL);
+
+   /*==========================================================*/
+   /* If necessary, add logical dependency links between the   */
+   /* fact and the partial match which is its logical support. */
+   /*==========================================================*/
+
+   if (AddLogicalDependencies(theEnv,execStatus,(struct patternEntity *) theFact,FALSE) == FALSE)
+     {
+      RemoveHashedFact(theEnv,execStatus,theFact);
+      ReturnFact(theEnv,execStatus,theFact);
+      return(NULL);
+     }
+
+   /*=============================================*/
+   /* Link the fact into the fact and deftemplate */
+   /* lists and give it its index and time tag.   */
+   /*=============================================*/
+
+   InstallAssertedFact(theEnv,execStatus,theFact);
+
+   /*===================================================*/
+   /* Reset the evaluation error flag since expressions */
+   /* will be evaluated as part of the assert .         */
+   /*===================================================*/
+
+   SetEvaluationError(theEnv,execStatus,FALSE);
+
+   /*=============================================*/
+   /* Pattern match the fact using the associated */
+   /* deftemplate's pattern network.              */
+   /*=============================================*/
+  
+    if (goParallel) {  
+      // STEFAN: Lets go parallel
+      struct factPatternNode *entryNodeOnRootLevel = 
+                                    theFact->whichDeftemplate->patternNetwork;
+      
+      while (entryNodeOnRootLevel) {
+        SpawnMatchingTask(theEnv,execStatus,theFact,entryNodeOnRootLevel,0,NULL,NULL);
+        entryNodeOnRootLevel = entryNodeOnRootLevel->rightNode;
+      }
+    }
+    else {
+      startTime = gentime();
+
+      LockJoinNetwork(theEnv,execStatus);
+      EngineData(theEnv,execStatus)->MatchOperationInProgress = TRUE;
+      
+      FactPatternMatch(theEnv,execStatus,
+                       theFact,
+                       theFact->whichDeftemplate->patternNetwork,
+                       0,
+                       NULL,
+                       NULL);
+      
+      EngineData(theEnv,execStatus)->MatchOperationInProgress = FALSE;
+      UnlockJoinNetwork(theEnv,execStatus);
+
+      theFact->whichDeftemplate->statistics.matchTime += gentime() - startTime;
+      
+      
+      /*===================================================*/
+      /* Retract other facts that were logically dependent */
+      /* on the non-existence of the fact just asserted.   */
+      /*===================================================*/
+      
+      ForceLogicalRetractions(theEnv,execStatus);
+    }
+
+   /*=========================================*/
+   /* Free partial matches that were released */
+   /* by the assertion of the fact. The match */
+   /* tasks spawned above never release any.  */
+   /*=========================================*/
+
+   if ((! goParallel) && (EngineData(theEnv,execStatus)->ExecutingRule == NULL))
+     { FlushGarbagePartialMatches(theEnv,execStatus); }
+
+   /*==========================================*/
+   /* Force periodic cleanup if the assert was */
+   /* executed from an embedded application.   */
+   /*==========================================*/
+
+   if ((execStatus->CurrentEvaluationDepth == 0) && (! CommandLineData(theEnv,execStatus)->EvaluatingTopLevelCommand) &&
+       (execStatus->CurrentExpression == NULL))
+     { PeriodicCleanup(theEnv,execStatus,TRUE,FALSE); }
+
+   /*===============================*/
+   /* Return a pointer to the fact. */
+   /*===============================*/
+
+   return((void *) theFact);
+  }
+
+/*************************************************************/
+/* EnvAssertBatch: C access routine for asserting a vector   */
+/*   of facts. Duplicate checking and hash table insertion   */
+/*   are done for the whole batch under a single lock, the   */
+/*   facts are pattern matched in one pass, and the cleanup  */
+/*   following an assert runs once per batch. Facts which    */
+/*   are not asserted (duplicates or facts without logical   */
+/*   support) are returned and replaced by NULL in the       */
+/*   array. Returns the number of facts asserted.            */
+/*************************************************************/
+globle size_t EnvAssertBatch(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact **facts,
+  size_t n)
+  {
+   struct fact **duplicates;
+   size_t i, count = 0;
+
+   if (n == 0) return(0);
+
+   /*==========================================*/
+   /* Facts can not be asserted while another  */
+   /* fact is being asserted or retracted.     */
+   /*==========================================*/
+
+   if (EngineData(theEnv,execStatus)->MatchOperationInProgress)
+     {
+      for (i = 0; i < n; i++)
+        {
+         if (facts[i] == NULL) continue;
+         ReturnFact(theEnv,execStatus,facts[i]);
+         facts[i] = NULL;
+        }
+      PrintErrorID(theEnv,execStatus,"FACTMNGR",2,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"Facts may not be asserted during pattern-matching\n");
+      return(0);
+     }
+
+   /*=============================================*/
+   /* Remove the empty entries from the batch and */
+   /* replace invalid data types with nil.        */
+   /*=============================================*/
+
+   for (i = 0; i < n; i++)
+     {
+      if (facts[i] == NULL) continue;
+      ReplaceVoidFields(theEnv,execStatus,facts[i]);
+      facts[count++] = facts[i];
+     }
+
+   for (i = count; i < n; i++)
+     { facts[i] = NULL; }
+
+   n = count;
+   if (n == 0) return(0);
+
+   /*==============================================*/
+   /* Check for duplicates and enter the remaining */
+   /* facts in the fact hash table in one go.      */
+   /*==============================================*/
+
+   duplicates = (struct fact **) gm2(theEnv,execStatus,sizeof(struct fact *) * n);
+
+   AddHashedFactBatch(theEnv,execStatus,facts,duplicates,n);
+
+   for (i = 0, count = 0; i < n; i++)
+     {
+      if (duplicates[i] != NULL)
+        {
+         ReturnFact(theEnv,execStatus,facts[i]);
+#if DEFRULE_CONSTRUCT
+         AddLogicalDependencies(theEnv,execStatus,(struct patternEntity *) duplicates[i],TRUE);
+#endif
+         facts[i] = NULL;
+         continue;
+        }
+
+      /*==========================================================*/
+      /* If necessary, add logical dependency links between the   */
+      /* fact and the partial match which is its logical support. */
+      /*==========================================================*/
+
+      if (AddLogicalDependencies(theEnv,execStatus,(struct patternEntity *) facts[i],FALSE) == FALSE)
+        {
+         RemoveHashedFact(theEnv,execStatus,facts[i]);
+         ReturnFact(theEnv,execStatus,facts[i]);
+         facts[i] = NULL;
+         continue;
+        }
+
+      InstallAssertedFact(theEnv,execStatus,facts[i]);
+      duplicates[count++] = facts[i];
+     }
+
+   /*===================================================*/
+   /* Reset the evaluation error flag since expressions */
+   /* will be evaluated as part of the assert .         */
+   /*===================================================*/
+
+   SetEvaluationError(theEnv,execStatus,FALSE);
+
+   /*==================================================*/
+   /* Pattern match the asserted facts (collected at   */
+   /* the front of the duplicates array) and retract   */
+   /* the facts which were logically dependent on the  */
+   /* non-existence of any of them.                    */
+   /*==================================================*/
+
+   EngineData(theEnv,execStatus)->MatchOperationInProgress = TRUE;
+
+   MatchFactBatch(theEnv,execStatus,duplicates,count);
+
+   EngineData(theEnv,execStatus)->MatchOperationInProgress = FALSE;
+
+   ForceLogicalRetractions(theEnv,execStatus);
+
+   rm(theEnv,execStatus,duplicates,sizeof(struct fact *) * n);
+
+   /*=========================================*/
+   /* Free partial matches that were released */
+   /* by the assertion of the facts.          */
+   /*=========================================*/
+
+   if (EngineData(theEnv,execStatus)->ExecutingRule == NULL) FlushGarbagePartialMatches(theEnv,execStatus);
 
-   /*===========================================*/
-   /* Force periodic cleanup if the retract was */
-   /* executed from an embedded application.    */
-   /*===========================================*/
+   /*==========================================*/
+   /* Force periodic cleanup if the assert was */
+   /* executed from an embedded application.   */
+   /*==========================================*/
 
    if ((execStatus->CurrentEvaluationDepth == 0) && (! CommandLineData(theEnv,execStatus)->EvaluatingTopLevelCommand) &&
        (execStatus->CurrentExpression == NULL))
      { PeriodicCleanup(theEnv,execStatus,TRUE,FALSE); }
 
-   /*==================================*/
-   /* Return TRUE to indicate the fact */
-   /* was successfully retracted.      */
-   /*==================================*/
-
-   return(TRUE);
+   return(count);
   }
 
-/*******************************************************************/
-/* RemoveGarbageFacts: Returns facts that have been retracted to   */
-/*   the pool of available memory. It is necessary to postpone     */
-/*   returning the facts to memory because RHS actions retrieve    */
-/*   their variable bindings directly from the fact data structure */
-/*   and the facts may be in use in other data structures.         */
-/*******************************************************************/
-static void RemoveGarbageFacts(
+/************************************************************/
+/* MatchFactBatch: Drives a batch of asserted facts through */
+/*   the pattern network. With more than one matcher thread */
+/*   the facts are partitioned by deftemplate and each      */
+/*   partition is handed to the match scheduler, so facts   */
+/*   of different deftemplates are matched in parallel.     */
+/*   Otherwise the facts are matched in assertion order.    */
+/************************************************************/
+static void MatchFactBatch(
   void *theEnv,
-  EXEC_STATUS)
+  EXEC_STATUS,
+  struct fact **facts,
+  size_t n)
   {
-   struct fact *factPtr, *nextPtr, *lastPtr = NULL;
+   struct fact **partitions;
+   struct deftemplate *theTemplate;
+   size_t i, j, start, count;
+   double startTime;
 
-   factPtr = FactData(theEnv,execStatus)->GarbageFacts;
+   if (n == 0) return;
 
-   while (factPtr != NULL)
+   if (EnvGetMatcherThreads(theEnv,execStatus) <= 1)
      {
-      nextPtr = factPtr->nextFact;
-      if ((factPtr->factHeader.busyCount == 0) &&
-          (((int) factPtr->depth) > execStatus->CurrentEvaluationDepth))
+      LockJoinNetwork(theEnv,execStatus);
+      for (i = 0; i < n; i++)
         {
-         UtilityData(theEnv,execStatus)->EphemeralItemCount--;
-         UtilityData(theEnv,execStatus)->EphemeralItemSize -= sizeof(struct fact) + (sizeof(struct field) * factPtr->theProposition.multifieldLength);
-         ReturnFact(theEnv,execStatus,factPtr);
-         if (lastPtr == NULL) FactData(theEnv,execStatus)->GarbageFacts = nextPtr;
-         else lastPtr->nextFact = nextPtr;
+         startTime = gentime();
+         FactPatternMatch(theEnv,execStatus,facts[i],
+                          facts[i]->whichDeftemplate->patternNetwork,
+                          0,NULL,NULL);
+         facts[i]->whichDeftemplate->statistics.matchTime += gentime() - startTime;
         }
-      else
-        { lastPtr = factPtr; }
-
-      factPtr = nextPtr;
+      UnlockJoinNetwork(theEnv,execStatus);
+      return;
      }
-  }
 
+   /*==================================================*/
+   /* Group the facts by deftemplate. The order of the */
+   /* facts within a group is the assertion order.     */
+   /*==================================================*/
+
+   partitions = (struct fact **) gm2(theEnv,execStatus,sizeof(struct fact *) * n);
 
+   for (i = 0, count = 0; i < n; i++)
+     {
+      if (facts[i] == NULL) continue;
 
-/*
- * Used to transfer the parameters from EnvAssert to
- * the pattern matching and retracting process.
- */
-struct paramsForFactMatchAndRetract
-{
-  void *theEnv;
-  struct executionStatus* execStatus;
-  struct fact *theFact;
-  struct factPatternNode *patternPtr;
-  int offset;
-  struct multifieldMarker *markers;
-  struct multifieldMarker *endMark;
-};
-
-
-/*************************************************************************/
-/* ParallelFactPatternMatch: Parallel Wrapper function for queued match  */
-/*                           jobs.                                       */
-/*************************************************************************/
-static void * APR_THREAD_FUNC ParallelFactMatchAndLogicRetract(apr_thread_t *thread, void *parameters)
-{
-  struct paramsForFactMatchAndRetract * const params = (struct paramsForFactMatchAndRetract*)parameters;
-  
-  struct executionStatus localExecStatus = { NULL };
-  localExecStatus.RunningInParallel = TRUE;
-  
-  FactPatternMatch(params->theEnv,
-                   (params->execStatus) ? params->execStatus : & localExecStatus,
-                   params->theFact,
-                   params->patternPtr,
-                   params->offset,
-                   params->markers,
-                   params->endMark);
-
-  // STEFAN: don't do that anymore for the moment
-  // EngineData(params->theEnv)->MatchOperationInProgress = FALSE;
-  
-  
-  /*===================================================*/
-  /* Retract other facts that were logically dependent */
-  /* on the non-existence of the fact just asserted.   */
-  /*===================================================*/
-  
-  ForceLogicalRetractions(params->theEnv, params->execStatus);
-  
-  if (params->execStatus)
-    free(params->execStatus);
-  
-  free(params);
-  
-  return NULL;
-}
-
-/******************************************************************/
-/* SpawnMatchingTask: Put a matching operation on the task queue. */
-/******************************************************************/
-globle void SpawnMatchingTask(void* theEnv,EXEC_STATUS,struct fact *theFact,
-                              struct factPatternNode *entryNodeOnRootLevel) {
-  struct paramsForFactMatchAndRetract *parameters = 
-        (struct paramsForFactMatchAndRetract *)malloc(sizeof(
-                                        struct paramsForFactMatchAndRetract));
-
-  if (!parameters) {
-    SystemError(theEnv,execStatus,"malloc failed",1);
-  }
-  else {
-    parameters->theEnv     = theEnv;
-    parameters->execStatus = NULL;
-    parameters->theFact    = theFact;
-    parameters->patternPtr = entryNodeOnRootLevel;
-    parameters->offset     = 0;
-    parameters->markers    = NULL;
-    parameters->endMark    = NULL;
-    
-    apr_status_t rv;
-    rv = apr_thread_pool_push(Env(theEnv,execStatus)->matcherThreadPool,
-                              ParallelFactMatchAndLogicRetract,
-                              parameters,
-                              0, NULL);
-    if (rv) {
-      SystemError(theEnv,execStatus,"Putting task on thread pool failed",1);
-    }
+      theTemplate = facts[i]->whichDeftemplate;
+      start = count;
+
+      for (j = i; j < n; j++)
+        {
+         if ((facts[j] == NULL) || (facts[j]->whichDeftemplate != theTemplate)) continue;
+         partitions[count++] = facts[j];
+         if (j != i) facts[j] = NULL;
+        }
+
+      SpawnMatchingBatch(theEnv,execStatus,&partitions[start],count - start);
+     }
+
+   WaitForMatchingTasks(theEnv,execStatus);
+
+   rm(theEnv,execStatus,partitions,sizeof(struct fact *) * n);
   }
-}
 
-/********************************************************/
-/* EnvAssert: C access routine for the assert function. */
-/********************************************************/
-globle void *EnvAssert(
+/***************************************************/
+/* ReplaceVoidFields: Replaces invalid data types  */
+/*   in a fact to be asserted with the symbol nil. */
+/***************************************************/
+static void ReplaceVoidFields(
   void *theEnv,
   EXEC_STATUS,
-  void *vTheFact,
-  int  goParallel)
+  struct fact *theFact)
   {
-   unsigned long hashValue;
    unsigned long length, i;
    struct field *theField;
-   struct fact *theFact = (struct fact *) vTheFact;
-   intBool duplicate;
-
-   /*==========================================*/
-   /* A fact can not be asserted while another */
-   /* fact is being asserted or retracted.     */
-   /*==========================================*/
-
-   if (EngineData(theEnv,execStatus)->MatchOperationInProgress)
-     {
-      ReturnFact(theEnv,execStatus,theFact);
-      PrintErrorID(theEnv,execStatus,"FACTMNGR",2,TRUE);
-      EnvPrintRouter(theEnv,execStatus,WERROR,"Facts may not be asserted during pattern-matching\n");
-      return(NULL);
-     }
-
-   /*=============================================================*/
-   /* Replace invalid data types in the fact with the symbol nil. */
-   /*=============================================================*/
 
    length = theFact->theProposition.multifieldLength;
    theField = theFact->theProposition.theFields;
@@ -765,34 +1368,19 @@ globle void *EnvAssert(
          theField[i].value = (void *) EnvAddSymbol(theEnv,execStatus,"nil");
         }
      }
+  }
 
-   /*========================================================*/
-   /* If fact assertions are being checked for duplications, */
-   /* then search the fact list for a duplicate fact.        */
-   /*========================================================*/
-
-   hashValue = HandleFactDuplication(theEnv,execStatus,theFact,&duplicate);
-   if (duplicate) return(NULL);
-
-   /*==========================================================*/
-   /* If necessary, add logical dependency links between the   */
-   /* fact and the partial match which is its logical support. */
-   /*==========================================================*/
-
-   if (AddLogicalDependencies(theEnv,execStatus,(struct patternEntity *) theFact,FALSE) == FALSE)
-     {
-      ReturnFact(theEnv,execStatus,theFact);
-      return(NULL);
-     }
-
-   /*======================================*/
-   /* Add the fact to the fact hash table. */
-   /*======================================*/
-
-    // STEFAN: GLOBAL STUFF...
-    
-   AddHashedFact(theEnv,execStatus,theFact,hashValue);
-
+/********************************************************/
+/* InstallAssertedFact: Adds a fact which passed the    */
+/*   duplication check to the fact list and the fact    */
+/*   list of its deftemplate, assigns the fact index    */
+/*   and time tag, and updates the busy counts.         */
+/********************************************************/
+static void InstallAssertedFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
    /*================================*/
    /* Add the fact to the fact list. */
    /*================================*/
@@ -832,12 +1420,19 @@ globle void *EnvAssert(
 
    theFact->factIndex = FactData(theEnv,execStatus)->NextFactIndex++;
    theFact->factHeader.timeTag = DefruleData(theEnv,execStatus)->CurrentEntityTimeTag++;
+   AddIndexedFact(theEnv,execStatus,theFact);
+
+#if DEFINDEX_CONSTRUCT
+   if (theFact->whichDeftemplate->indexList != NULL)
+     { AddFactToDefindexes(theEnv,execStatus,theFact); }
+#endif
 
    /*=====================*/
    /* Update busy counts. */
    /*=====================*/
 
    FactInstall(theEnv,execStatus,theFact);
+   theFact->whichDeftemplate->statistics.asserts++;
 
    /*==========================*/
    /* Print assert output if   */
@@ -865,71 +1460,6 @@ globle void *EnvAssert(
    /*==========================================*/
 
    CheckTemplateFact(theEnv,execStatus,theFact);
-
-   /*===================================================*/
-   /* Reset the evaluation error flag since expressions */
-   /* will be evaluated as part of the assert .         */
-   /*===================================================*/
-
-   SetEvaluationError(theEnv,execStatus,FALSE);
-
-   /*=============================================*/
-   /* Pattern match the fact using the associated */
-   /* deftemplate's pattern network.              */
-   /*=============================================*/
-  
-    if (goParallel) {  
-      // STEFAN: Lets go parallel
-      struct factPatternNode *entryNodeOnRootLevel = 
-                                    theFact->whichDeftemplate->patternNetwork;
-      
-      while (entryNodeOnRootLevel) {
-        SpawnMatchingTask(theEnv, execStatus, theFact, entryNodeOnRootLevel);
-        entryNodeOnRootLevel = entryNodeOnRootLevel->rightNode;
-      }
-    }
-    else {
-      EngineData(theEnv,execStatus)->MatchOperationInProgress = TRUE;
-      
-      FactPatternMatch(theEnv,execStatus,
-                       theFact,
-                       theFact->whichDeftemplate->patternNetwork,
-                       0,
-                       NULL,
-                       NULL);
-      
-      EngineData(theEnv,execStatus)->MatchOperationInProgress = FALSE;
-      
-      
-      /*===================================================*/
-      /* Retract other facts that were logically dependent */
-      /* on the non-existence of the fact just asserted.   */
-      /*===================================================*/
-      
-      ForceLogicalRetractions(theEnv,execStatus);
-    }
-
-   /*=========================================*/
-   /* Free partial matches that were released */
-   /* by the assertion of the fact.           */
-   /*=========================================*/
-
-   if (EngineData(theEnv,execStatus)->ExecutingRule == NULL) FlushGarbagePartialMatches(theEnv,execStatus);
-
-   /*==========================================*/
-   /* Force periodic cleanup if the assert was */
-   /* executed from an embedded application.   */
-   /*==========================================*/
-
-   if ((execStatus->CurrentEvaluationDepth == 0) && (! CommandLineData(theEnv,execStatus)->EvaluatingTopLevelCommand) &&
-       (execStatus->CurrentExpression == NULL))
-     { PeriodicCleanup(theEnv,execStatus,TRUE,FALSE); }
-
-   /*===============================*/
-   /* Return a pointer to the fact. */
-   /*===============================*/
-
-   return((void *) theFact);
   }
 
 /**************************************/
@@ -942,6 +1472,14 @@ globle void RemoveAllFacts(
   {
    while (FactData(theEnv,execStatus)->FactList != NULL)
      { EnvRetract(theEnv,execStatus,(void *) FactData(theEnv,execStatus)->FactList); }
+
+   /*================================================*/
+   /* Every page has been released with its facts,   */
+   /* but the directory may still be sized for the   */
+   /* highest fact index reached since the last one. */
+   /*================================================*/
+
+   ReleaseFactIndex(theEnv,execStatus);
   }
 
 /************************************************/
@@ -1377,6 +1915,7 @@ globle struct fact *CreateFactBySize(
    theFact->previousFact = NULL;
    theFact->previousTemplateFact = NULL;
    theFact->nextTemplateFact = NULL;
+   theFact->indexEntries = NULL;
    theFact->list = NULL;
 
    theFact->theProposition.multifieldLength = size;
@@ -1412,6 +1951,11 @@ globle void ReturnFact(
         }
      }
 
+#if DEFINDEX_CONSTRUCT
+   if (theFact->indexEntries != NULL)
+     { ReturnFactIndexEntries(theEnv,execStatus,theFact); }
+#endif
+
    if (theFact->theProposition.multifieldLength == 0) newSize = 1;
    else newSize = theFact->theProposition.multifieldLength;
       
@@ -1739,23 +2283,147 @@ static int ClearFactsReady(
 /***************************************************/
 /* FindIndexedFact: Returns a pointer to a fact in */
 /*   the fact list with the specified fact index.  */
+/*   The fact is looked up in the page of the fact */
+/*   index directory holding the index.            */
 /***************************************************/
 globle struct fact *FindIndexedFact(
   void *theEnv,
   EXEC_STATUS,
   long long factIndexSought)
   {
-   struct fact *theFact;
+   struct factIndexPage *thePage;
+   unsigned long pageIndex;
+
+   if (factIndexSought < 0) return(NULL);
+
+   pageIndex = (unsigned long) (factIndexSought >> FACT_INDEX_PAGE_BITS);
+   if (pageIndex >= FactData(theEnv,execStatus)->FactIndexPageCount)
+     { return(NULL); }
+
+   thePage = FactData(theEnv,execStatus)->FactIndexPages[pageIndex];
+   if (thePage == NULL) return(NULL);
+
+   return(thePage->facts[factIndexSought & (FACT_INDEX_PAGE_SIZE - 1)]);
+  }
+
+/*****************************************************/
+/* AddIndexedFact: Enters a fact which has just been */
+/*   given its fact index into the page of the fact  */
+/*   index directory holding the index. The          */
+/*   directory is doubled in size when the index is  */
+/*   beyond its last page.                           */
+/*****************************************************/
+static void AddIndexedFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct factIndexPage **newPages, *thePage;
+   unsigned long pageIndex, newCount, i;
+
+   pageIndex = (unsigned long) (theFact->factIndex >> FACT_INDEX_PAGE_BITS);
+
+   /*============================================*/
+   /* Grow the directory to cover the new index. */
+   /*============================================*/
 
-   for (theFact = (struct fact *) EnvGetNextFact(theEnv,execStatus,NULL);
-        theFact != NULL;
-        theFact = (struct fact *) EnvGetNextFact(theEnv,execStatus,theFact))
+   if (pageIndex >= FactData(theEnv,execStatus)->FactIndexPageCount)
      {
-      if (theFact->factIndex == factIndexSought)
-        { return(theFact); }
+      newCount = FactData(theEnv,execStatus)->FactIndexPageCount * 2;
+      if (newCount < FACT_INDEX_MIN_PAGES) newCount = FACT_INDEX_MIN_PAGES;
+      while (newCount <= pageIndex) newCount *= 2;
+
+      newPages = (struct factIndexPage **)
+                 gm3(theEnv,execStatus,(long) (sizeof(struct factIndexPage *) * newCount));
+
+      for (i = 0; i < FactData(theEnv,execStatus)->FactIndexPageCount; i++)
+        { newPages[i] = FactData(theEnv,execStatus)->FactIndexPages[i]; }
+      for ( ; i < newCount; i++)
+        { newPages[i] = NULL; }
+
+      if (FactData(theEnv,execStatus)->FactIndexPages != NULL)
+        {
+         rm3(theEnv,execStatus,FactData(theEnv,execStatus)->FactIndexPages,
+             (long) (sizeof(struct factIndexPage *) * FactData(theEnv,execStatus)->FactIndexPageCount));
+        }
+
+      FactData(theEnv,execStatus)->FactIndexPages = newPages;
+      FactData(theEnv,execStatus)->FactIndexPageCount = newCount;
      }
 
-   return(NULL);
+   /*==============================================*/
+   /* Allocate the page when it receives its first */
+   /* fact and store the fact in it.               */
+   /*==============================================*/
+
+   thePage = FactData(theEnv,execStatus)->FactIndexPages[pageIndex];
+   if (thePage == NULL)
+     {
+      thePage = (struct factIndexPage *) gm3(theEnv,execStatus,(long) sizeof(struct factIndexPage));
+      memset(thePage,0,sizeof(struct factIndexPage));
+      FactData(theEnv,execStatus)->FactIndexPages[pageIndex] = thePage;
+     }
+
+   thePage->facts[theFact->factIndex & (FACT_INDEX_PAGE_SIZE - 1)] = theFact;
+   thePage->count++;
+  }
+
+/*********************************************************/
+/* RemoveIndexedFact: Removes a fact being retracted     */
+/*   from the fact index directory and releases its page */
+/*   once the page no longer holds any facts.            */
+/*********************************************************/
+static void RemoveIndexedFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct factIndexPage *thePage;
+   unsigned long pageIndex;
+
+   pageIndex = (unsigned long) (theFact->factIndex >> FACT_INDEX_PAGE_BITS);
+   if (pageIndex >= FactData(theEnv,execStatus)->FactIndexPageCount) return;
+
+   thePage = FactData(theEnv,execStatus)->FactIndexPages[pageIndex];
+   if (thePage == NULL) return;
+
+   if (thePage->facts[theFact->factIndex & (FACT_INDEX_PAGE_SIZE - 1)] != theFact)
+     { return; }
+
+   thePage->facts[theFact->factIndex & (FACT_INDEX_PAGE_SIZE - 1)] = NULL;
+   if (--thePage->count == 0)
+     {
+      rm3(theEnv,execStatus,thePage,(long) sizeof(struct factIndexPage));
+      FactData(theEnv,execStatus)->FactIndexPages[pageIndex] = NULL;
+     }
+  }
+
+/******************************************************/
+/* ReleaseFactIndex: Releases the fact index          */
+/*   directory together with any pages still in it.   */
+/******************************************************/
+static void ReleaseFactIndex(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   unsigned long i;
+
+   if (FactData(theEnv,execStatus)->FactIndexPages == NULL) return;
+
+   for (i = 0; i < FactData(theEnv,execStatus)->FactIndexPageCount; i++)
+     {
+      if (FactData(theEnv,execStatus)->FactIndexPages[i] != NULL)
+        {
+         rm3(theEnv,execStatus,FactData(theEnv,execStatus)->FactIndexPages[i],
+             (long) sizeof(struct factIndexPage));
+        }
+     }
+
+   rm3(theEnv,execStatus,FactData(theEnv,execStatus)->FactIndexPages,
+       (long) (sizeof(struct factIndexPage *) * FactData(theEnv,execStatus)->FactIndexPageCount));
+
+   FactData(theEnv,execStatus)->FactIndexPages = NULL;
+   FactData(theEnv,execStatus)->FactIndexPageCount = 0;
   }
 
 #endif /* DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT */
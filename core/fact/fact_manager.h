@@ -27,6 +27,7 @@
 #define _H_factmngr
 
 struct fact;
+struct slotIndexEntry;
 
 #ifndef _H_facthsh
 #include "facthsh.h"
@@ -45,6 +46,9 @@ struct fact;
 #include "tmpltdef.h"
 #endif
 
+# include <apr_atomic.h>
+# include <apr_thread_mutex.h>
+
 struct fact
   {
    struct patternEntity factHeader;
@@ -58,11 +62,30 @@ struct fact
    struct fact *nextFact;
    struct fact *previousTemplateFact;
    struct fact *nextTemplateFact;
+   struct slotIndexEntry *indexEntries;
    struct multifield theProposition;
   };
   
 #define FACTS_DATA 3
 
+/*====================================================*/
+/* Facts are found by fact index through a directory  */
+/* of pages, each holding FACT_INDEX_PAGE_SIZE facts. */
+/* A page is released as soon as its last fact is     */
+/* retracted, since fact indices are never reused     */
+/* before the next reset or clear.                    */
+/*====================================================*/
+
+#define FACT_INDEX_PAGE_BITS 10
+#define FACT_INDEX_PAGE_SIZE (1L << FACT_INDEX_PAGE_BITS)
+#define FACT_INDEX_MIN_PAGES 16
+
+struct factIndexPage
+  {
+   unsigned long count;
+   struct fact *facts[FACT_INDEX_PAGE_SIZE];
+  };
+
 struct factsData
   {
    int ChangeToFactList;
@@ -82,13 +105,20 @@ struct factsData
 #if DEFRULE_CONSTRUCT && (! RUN_TIME) && DEFTEMPLATE_CONSTRUCT && CONSTRUCT_COMPILER
    struct CodeGeneratorItem *FactCodeItem;
 #endif
+   struct factIndexPage **FactIndexPages;
+   unsigned long FactIndexPageCount;
    struct factHashEntry **FactHashTable;
    unsigned long FactHashTableSize;
+   struct factHashEntry **OldFactHashTable;
+   unsigned long OldFactHashTableSize;
+   volatile apr_uint32_t FactHashCount;
+   volatile apr_uint32_t FactHashMigrateIndex;
+   volatile apr_uint32_t FactHashMigrated;
+   apr_thread_mutex_t *FactHashStripes[FACT_HASH_STRIPES];
    intBool FactDuplication;
-#if DEFRULE_CONSTRUCT
-   struct fact             *CurrentPatternFact;
-   struct multifieldMarker *CurrentPatternMarks;
-#endif
+   intBool ModifyInPlace;
+   struct fact *ModifiedFact;
+   char *ModifiedSlots;
    long LastModuleIndex;
   };
   
@@ -110,11 +140,13 @@ struct factsData
 #define DecrementFactCount(a) EnvDecrementFactCount(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define GetFactListChanged() EnvGetFactListChanged(GetCurrentEnvironment(),GetCurrentExecutionStatus())
 #define GetFactPPForm(a,b,c) EnvGetFactPPForm(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b,c)
+#define GetModifyInPlace() EnvGetModifyInPlace(GetCurrentEnvironment(),GetCurrentExecutionStatus())
 #define GetNextFact(a) EnvGetNextFact(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define IncrementFactCount(a) EnvIncrementFactCount(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define PutFactSlot(a,b,c) EnvPutFactSlot(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b,c)
 #define Retract(a) EnvRetract(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define SetFactListChanged(a) EnvSetFactListChanged(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
+#define SetModifyInPlace(a) EnvSetModifyInPlace(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 
 #if ALLOW_ENVIRONMENT_GLOBALS
    LOCALE intBool                        GetFactSlot(void *,char *,DATA_OBJECT *);
@@ -122,6 +154,7 @@ struct factsData
 #endif
 
    LOCALE void                          *EnvAssert(void *,EXEC_STATUS,void *, int);
+   LOCALE size_t                         EnvAssertBatch(void *,EXEC_STATUS,struct fact **,size_t);
    LOCALE void                          *EnvAssertString(void *,EXEC_STATUS,char *);
    LOCALE struct fact                   *EnvCreateFact(void *,EXEC_STATUS,void *);
    LOCALE void                           EnvDecrementFactCount(void *,EXEC_STATUS,void *);
@@ -131,6 +164,9 @@ struct factsData
    LOCALE void                           PrintFact(void *,EXEC_STATUS,char *,struct fact *,int,int);
    LOCALE void                           PrintFactIdentifierInLongForm(void *,EXEC_STATUS,char *,void *);
    LOCALE intBool                        EnvRetract(void *,EXEC_STATUS,void *);
+   LOCALE intBool                        ModifyFactInPlace(void *,EXEC_STATUS,struct fact *,struct fact *);
+   LOCALE intBool                        EnvGetModifyInPlace(void *,EXEC_STATUS);
+   LOCALE intBool                        EnvSetModifyInPlace(void *,EXEC_STATUS,int);
    LOCALE void                           RemoveAllFacts(void *,EXEC_STATUS);
    LOCALE struct fact                   *CreateFactBySize(void *,EXEC_STATUS,unsigned);
    LOCALE void                           FactInstall(void *,EXEC_STATUS,struct fact *);
@@ -0,0 +1,813 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*              FACT MATCH SCHEDULER MODULE            */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Distributes the sub-trees of the fact pattern    */
+/*   network over the workers of the matcher thread pool.    */
+/*   Every worker owns a deque of match tasks. A worker      */
+/*   pushes the tasks it spawns onto its own deque and pops  */
+/*   them in LIFO order, while workers which ran out of work */
+/*   steal the oldest tasks of the other workers. Tasks      */
+/*   submitted by threads outside the pool are placed on an  */
+/*   injection queue from which all workers steal. Task      */
+/*   descriptors are recycled through per-worker freelists.  */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _FACTSCHD_SOURCE_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "setup.h"
+
+#if DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT
+
+#include "engine.h"
+#include "envrnmnt.h"
+#include "memalloc.h"
+#include "match.h"
+#include "factmch.h"
+#include "lgcldpnd.h"
+#include "prntutil.h"
+#include "reteutil.h"
+#include "retract.h"
+#include "router.h"
+#include "symbol.h"
+
+#include "fact_scheduler.h"
+
+# include <apr_thread_proc.h>
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static void                    DeallocateMatchSchedulerData(void *,EXEC_STATUS);
+   static intBool                 InitializeMatchDeque(void *,EXEC_STATUS,struct matchDeque *);
+   static void                    DestroyMatchDeque(struct matchDeque *);
+   static void                    PushMatchTask(struct matchDeque *,struct factMatchTask *);
+   static struct factMatchTask   *PopMatchTask(struct matchDeque *);
+   static struct factMatchTask   *StealMatchTask(struct matchDeque *);
+   static void                    SubmitMatchTask(void *,EXEC_STATUS,struct factMatchTask *);
+   static struct factMatchTask   *GetMatchTask(void *,EXEC_STATUS);
+   static void                    ReleaseMatchTask(void *,EXEC_STATUS,struct factMatchTask *);
+   static struct factMatchTask   *FindMatchTask(void *,struct matchWorker *);
+   static void                    RunMatchTask(void *,EXEC_STATUS,struct factMatchTask *);
+   static void                    StartMatchWorker(void *,EXEC_STATUS);
+   static void                    ResizeMatchWorkers(void *,EXEC_STATUS,unsigned int);
+   static struct matchWorker     *ClaimMatchWorker(void *);
+   static void * APR_THREAD_FUNC  MatchWorkerLoop(apr_thread_t *,void *);
+
+/******************************************************/
+/* InitializeMatchScheduler: Allocates the scheduler  */
+/*   data and the injection queue. Workers are only   */
+/*   created once the first match task is submitted.  */
+/******************************************************/
+globle void InitializeMatchScheduler(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct matchSchedulerData *theScheduler;
+   apr_status_t rv;
+
+   AllocateEnvironmentData(theEnv,execStatus,MATCH_SCHEDULER_DATA,
+                           sizeof(struct matchSchedulerData),DeallocateMatchSchedulerData);
+
+   theScheduler = MatchSchedulerData(theEnv,execStatus);
+
+   rv = apr_thread_mutex_create(&theScheduler->lock,APR_THREAD_MUTEX_DEFAULT,
+                                Env(theEnv,execStatus)->memoryPool);
+   if (rv == APR_SUCCESS)
+     { rv = apr_thread_cond_create(&theScheduler->tasksDone,Env(theEnv,execStatus)->memoryPool); }
+   if (rv == APR_SUCCESS)
+     { rv = apr_thread_rwlock_create(&theScheduler->networkLock,Env(theEnv,execStatus)->memoryPool); }
+
+   if ((rv != APR_SUCCESS) ||
+       (InitializeMatchDeque(theEnv,execStatus,&theScheduler->injectQueue) == FALSE))
+     {
+      SystemError(theEnv,execStatus,"FACTSCHD",1);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
+  }
+
+/**************************************************/
+/* DeallocateMatchSchedulerData: Waits for all    */
+/*   outstanding match tasks and releases the     */
+/*   deques and task descriptors of the workers.  */
+/**************************************************/
+static void DeallocateMatchSchedulerData(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   struct factMatchTask *theTask;
+
+   apr_thread_mutex_lock(theScheduler->lock);
+   while ((apr_atomic_read32(&theScheduler->pendingTasks) > 0) ||
+          (apr_atomic_read32(&theScheduler->activeWorkers) > 0))
+     { apr_thread_cond_wait(theScheduler->tasksDone,theScheduler->lock); }
+   apr_thread_mutex_unlock(theScheduler->lock);
+
+   ResizeMatchWorkers(theEnv,execStatus,0);
+   DestroyMatchDeque(&theScheduler->injectQueue);
+
+   while (theScheduler->sharedFreeList != NULL)
+     {
+      theTask = theScheduler->sharedFreeList;
+      theScheduler->sharedFreeList = theTask->next;
+      free(theTask);
+     }
+  }
+
+/*********************************************************/
+/* SpawnMatchingTask: Submits a sub-tree of the pattern  */
+/*   network for matching against a fact. The multifield */
+/*   markers are copied since the caller releases its    */
+/*   markers once it backs out of the current binding.   */
+/*********************************************************/
+globle void SpawnMatchingTask(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact,
+  struct factPatternNode *patternPtr,
+  int offset,
+  struct multifieldMarker *markers,
+  struct multifieldMarker *endMark)
+  {
+   struct factMatchTask *theTask;
+
+   theTask = GetMatchTask(theEnv,execStatus);
+
+   theTask->theFact = theFact;
+   theTask->patternPtr = patternPtr;
+   theTask->offset = offset;
+   theTask->markers = NULL;
+   theTask->endMark = NULL;
+   theTask->factBatch = NULL;
+   theTask->batchSize = 0;
+
+   if (markers != NULL)
+     {
+      theTask->markers = CopyMultifieldMarkers(theEnv,execStatus,markers);
+      for (endMark = theTask->markers; endMark->next != NULL; endMark = endMark->next)
+        { /* Do Nothing */ }
+      theTask->endMark = endMark;
+     }
+
+   SubmitMatchTask(theEnv,execStatus,theTask);
+  }
+
+/*********************************************************/
+/* SpawnMatchingBatch: Submits a run of facts that have  */
+/*   to be matched against their pattern network as a    */
+/*   single task. The facts are expected to share their  */
+/*   deftemplate, so a batch touches one pattern network */
+/*   only. The array must stay valid until the task has  */
+/*   completed (see WaitForMatchingTasks).               */
+/*********************************************************/
+globle void SpawnMatchingBatch(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact **facts,
+  size_t n)
+  {
+   struct factMatchTask *theTask;
+
+   if (n == 0) return;
+
+   theTask = GetMatchTask(theEnv,execStatus);
+
+   theTask->theFact = NULL;
+   theTask->patternPtr = NULL;
+   theTask->offset = 0;
+   theTask->markers = NULL;
+   theTask->endMark = NULL;
+   theTask->factBatch = facts;
+   theTask->batchSize = n;
+
+   SubmitMatchTask(theEnv,execStatus,theTask);
+  }
+
+/*****************************************************/
+/* SubmitMatchTask: Places a task on the deque of    */
+/*   the submitting worker (or the injection queue)  */
+/*   and makes sure a worker is around to run it.    */
+/*****************************************************/
+static void SubmitMatchTask(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factMatchTask *theTask)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+
+   /*==========================================================*/
+   /* The counters are raised before the task becomes visible, */
+   /* so that a worker running out of work either finds the    */
+   /* task or sees that it has to keep looking for it.         */
+   /*==========================================================*/
+
+   apr_atomic_inc32(&theScheduler->pendingTasks);
+   apr_atomic_inc32(&theScheduler->queuedTasks);
+
+   if (execStatus->MatchWorker != NULL)
+     { PushMatchTask(&execStatus->MatchWorker->deque,theTask); }
+   else
+     { PushMatchTask(&theScheduler->injectQueue,theTask); }
+
+   StartMatchWorker(theEnv,execStatus);
+  }
+
+/*******************************************************/
+/* WaitForMatchingTasks: Blocks until every submitted  */
+/*   match task has completed and then performs the    */
+/*   retractions the workers had to defer. Workers     */
+/*   never wait on themselves, so the call is a no-op  */
+/*   inside a task.                                    */
+/*******************************************************/
+globle void WaitForMatchingTasks(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   intBool flushed;
+
+   if (execStatus->MatchWorker != NULL) return;
+
+   if (apr_atomic_read32(&theScheduler->pendingTasks) > 0)
+     {
+      apr_thread_mutex_lock(theScheduler->lock);
+      while (apr_atomic_read32(&theScheduler->pendingTasks) > 0)
+        { apr_thread_cond_wait(theScheduler->tasksDone,theScheduler->lock); }
+      apr_thread_mutex_unlock(theScheduler->lock);
+     }
+
+   if (EngineData(theEnv,execStatus)->DeferredRetractionCount == 0) return;
+
+   apr_thread_rwlock_wrlock(theScheduler->networkLock);
+   flushed = FlushDeferredRetractions(theEnv,execStatus);
+   apr_thread_rwlock_unlock(theScheduler->networkLock);
+
+   /*=================================================*/
+   /* Retract the facts that were logically dependent */
+   /* on the partial matches which have been blocked. */
+   /*=================================================*/
+
+   if (flushed && (! EngineData(theEnv,execStatus)->MatchOperationInProgress))
+     { ForceLogicalRetractions(theEnv,execStatus); }
+  }
+
+/************************************************************/
+/* LockJoinNetwork: Waits until no worker is running a task */
+/*   and keeps them from starting one, so that the caller   */
+/*   may remove partial matches from the join network. The  */
+/*   retractions deferred by the workers are performed      */
+/*   first. Within a task the join network is already       */
+/*   locked for reading, so the call is a no-op there.      */
+/************************************************************/
+globle void LockJoinNetwork(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (execStatus->MatchWorker != NULL) return;
+
+   apr_thread_rwlock_wrlock(MatchSchedulerData(theEnv,execStatus)->networkLock);
+   FlushDeferredRetractions(theEnv,execStatus);
+  }
+
+/************************************************/
+/* UnlockJoinNetwork: Releases the join network */
+/*   locked with LockJoinNetwork.               */
+/************************************************/
+globle void UnlockJoinNetwork(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (execStatus->MatchWorker != NULL) return;
+
+   apr_thread_rwlock_unlock(MatchSchedulerData(theEnv,execStatus)->networkLock);
+  }
+
+/******************************************************/
+/* StartMatchWorker: Hands another worker loop to the */
+/*   matcher thread pool unless the pool is already   */
+/*   running as many workers as it is allowed to.     */
+/******************************************************/
+static void StartMatchWorker(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   unsigned int limit;
+   apr_status_t rv;
+
+   limit = EnvGetMatcherThreads(theEnv,execStatus);
+
+   if (apr_atomic_read32(&theScheduler->activeWorkers) >= limit) return;
+
+   apr_thread_mutex_lock(theScheduler->lock);
+
+   /*=====================================================*/
+   /* The worker slots follow the size of the thread pool */
+   /* set with set-matcher-threads. They can only be      */
+   /* reallocated while no worker is draining tasks.      */
+   /*=====================================================*/
+
+   if ((theScheduler->activeWorkers == 0) && (theScheduler->workerCount != limit))
+     { ResizeMatchWorkers(theEnv,execStatus,limit); }
+
+   if ((theScheduler->activeWorkers < limit) &&
+       (theScheduler->activeWorkers < theScheduler->workerCount))
+     {
+      apr_atomic_inc32(&theScheduler->activeWorkers);
+      rv = apr_thread_pool_push(Env(theEnv,execStatus)->matcherThreadPool,
+                                MatchWorkerLoop,theEnv,0,NULL);
+      if (rv)
+        {
+         apr_atomic_dec32(&theScheduler->activeWorkers);
+         apr_thread_mutex_unlock(theScheduler->lock);
+         SystemError(theEnv,execStatus,"Putting task on thread pool failed",1);
+         return;
+        }
+     }
+
+   apr_thread_mutex_unlock(theScheduler->lock);
+  }
+
+/*******************************************************/
+/* ResizeMatchWorkers: Replaces the worker slots. Must */
+/*   be called with the scheduler lock held (or during */
+/*   deallocation) while no worker is active. The      */
+/*   deques of idle workers are empty, so only their   */
+/*   cached task descriptors need to be handed back.   */
+/*******************************************************/
+static void ResizeMatchWorkers(
+  void *theEnv,
+  EXEC_STATUS,
+  unsigned int newCount)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   struct matchWorker *newWorkers = NULL;
+   struct factMatchTask *theTask;
+   unsigned int i;
+
+   if (newCount > 0)
+     {
+      newWorkers = (struct matchWorker *) malloc(sizeof(struct matchWorker) * newCount);
+      if (newWorkers == NULL) return;
+
+      memset(newWorkers,0,sizeof(struct matchWorker) * newCount);
+      for (i = 0; i < newCount; i++)
+        {
+         if (InitializeMatchDeque(theEnv,execStatus,&newWorkers[i].deque) == FALSE)
+           {
+            while (i > 0) DestroyMatchDeque(&newWorkers[--i].deque);
+            free(newWorkers);
+            return;
+           }
+        }
+     }
+
+   for (i = 0; i < theScheduler->workerCount; i++)
+     {
+      while (theScheduler->workers[i].freeList != NULL)
+        {
+         theTask = theScheduler->workers[i].freeList;
+         theScheduler->workers[i].freeList = theTask->next;
+         theTask->next = theScheduler->sharedFreeList;
+         theScheduler->sharedFreeList = theTask;
+        }
+      DestroyMatchDeque(&theScheduler->workers[i].deque);
+     }
+
+   if (theScheduler->workers != NULL)
+     { free(theScheduler->workers); }
+
+   theScheduler->workers = newWorkers;
+   theScheduler->workerCount = newCount;
+  }
+
+/*******************************************************/
+/* MatchWorkerLoop: Body of a matcher pool thread. The */
+/*   worker claims a slot, drains its own deque, takes */
+/*   from the injection queue and the other workers,   */
+/*   and retires once no task is left to be taken.     */
+/*******************************************************/
+static void * APR_THREAD_FUNC MatchWorkerLoop(
+  apr_thread_t *thread,
+  void *theEnv)
+  {
+   struct executionStatus localExecStatus;
+   struct matchSchedulerData *theScheduler;
+   struct matchWorker *theWorker;
+   struct factMatchTask *theTask;
+   unsigned int limit;
+
+   memset(&localExecStatus,0,sizeof(struct executionStatus));
+   localExecStatus.RunningInParallel = TRUE;
+
+   theScheduler = MatchSchedulerData(theEnv,&localExecStatus);
+   theWorker = ClaimMatchWorker(theEnv);
+   localExecStatus.MatchWorker = theWorker;
+
+   while (TRUE)
+     {
+      theTask = FindMatchTask(theEnv,theWorker);
+
+      if (theTask != NULL)
+        {
+         apr_atomic_dec32(&theScheduler->queuedTasks);
+         RunMatchTask(theEnv,&localExecStatus,theTask);
+         continue;
+        }
+
+      /*==================================================*/
+      /* A task was announced but is not yet on a deque.  */
+      /*==================================================*/
+
+      if (apr_atomic_read32(&theScheduler->queuedTasks) > 0)
+        {
+         apr_thread_yield();
+         continue;
+        }
+
+      /*===========================================*/
+      /* Retire the worker. A task submitted while */
+      /* retiring either sees the reduced worker   */
+      /* count and starts a new worker, or it is   */
+      /* noticed by the check below.               */
+      /*===========================================*/
+
+      apr_atomic_set32(&theWorker->inUse,0);
+      localExecStatus.MatchWorker = NULL;
+      ReleaseMemoryCache(theEnv,&localExecStatus);
+
+      apr_thread_mutex_lock(theScheduler->lock);
+      apr_atomic_dec32(&theScheduler->activeWorkers);
+      apr_thread_cond_broadcast(theScheduler->tasksDone);
+      apr_thread_mutex_unlock(theScheduler->lock);
+
+      if (apr_atomic_read32(&theScheduler->queuedTasks) == 0)
+        { return NULL; }
+
+      limit = EnvGetMatcherThreads(theEnv,&localExecStatus);
+
+      apr_thread_mutex_lock(theScheduler->lock);
+      if ((theScheduler->activeWorkers >= limit) ||
+          (theScheduler->activeWorkers >= theScheduler->workerCount))
+        {
+         apr_thread_mutex_unlock(theScheduler->lock);
+         return NULL;
+        }
+      apr_atomic_inc32(&theScheduler->activeWorkers);
+      apr_thread_mutex_unlock(theScheduler->lock);
+
+      theWorker = ClaimMatchWorker(theEnv);
+      localExecStatus.MatchWorker = theWorker;
+     }
+  }
+
+/*****************************************************/
+/* ClaimMatchWorker: Reserves an unused worker slot. */
+/*   The number of active workers never exceeds the  */
+/*   number of slots, so a free slot always exists.  */
+/*****************************************************/
+static struct matchWorker *ClaimMatchWorker(
+  void *theEnv)
+  {
+   struct matchSchedulerData *theScheduler;
+   unsigned int i;
+
+   theScheduler = MatchSchedulerData(theEnv,NULL);
+
+   while (TRUE)
+     {
+      for (i = 0; i < theScheduler->workerCount; i++)
+        {
+         if (apr_atomic_cas32(&theScheduler->workers[i].inUse,1,0) == 0)
+           { return(&theScheduler->workers[i]); }
+        }
+
+      apr_thread_yield();
+     }
+  }
+
+/*****************************************************/
+/* FindMatchTask: Returns the next task for a worker */
+/*   from its own deque, the injection queue, or the */
+/*   deque of another worker (in that order).        */
+/*****************************************************/
+static struct factMatchTask *FindMatchTask(
+  void *theEnv,
+  struct matchWorker *theWorker)
+  {
+   struct matchSchedulerData *theScheduler;
+   struct factMatchTask *theTask;
+   unsigned int i, victim;
+
+   theScheduler = MatchSchedulerData(theEnv,NULL);
+
+   theTask = PopMatchTask(&theWorker->deque);
+   if (theTask != NULL) return(theTask);
+
+   theTask = StealMatchTask(&theScheduler->injectQueue);
+   if (theTask != NULL) return(theTask);
+
+   victim = apr_atomic_inc32(&theScheduler->nextVictim);
+   for (i = 0; i < theScheduler->workerCount; i++)
+     {
+      struct matchWorker *theVictim = &theScheduler->workers[(victim + i) % theScheduler->workerCount];
+
+      if (theVictim == theWorker) continue;
+
+      theTask = StealMatchTask(&theVictim->deque);
+      if (theTask != NULL) return(theTask);
+     }
+
+   return(NULL);
+  }
+
+/********************************************************/
+/* RunMatchTask: Matches the sub-tree of a task against */
+/*   its fact and recycles the task descriptor.         */
+/********************************************************/
+static void RunMatchTask(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factMatchTask *theTask)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   struct multifieldMarker *theMarker;
+
+   struct factPatternNode *entryNode;
+   size_t i;
+
+   apr_thread_rwlock_rdlock(theScheduler->networkLock);
+   EnterAtomTables(theEnv,execStatus);
+
+   if (theTask->factBatch != NULL)
+     {
+      /*====================================================*/
+      /* The root nodes are walked here. The side branches  */
+      /* further down are spawned as tasks once reached.    */
+      /*====================================================*/
+
+      for (i = 0; i < theTask->batchSize; i++)
+        {
+         for (entryNode = theTask->factBatch[i]->whichDeftemplate->patternNetwork;
+              entryNode != NULL;
+              entryNode = entryNode->rightNode)
+           { FactPatternMatch(theEnv,execStatus,theTask->factBatch[i],entryNode,0,NULL,NULL); }
+        }
+     }
+   else
+     {
+      FactPatternMatch(theEnv,execStatus,
+                       theTask->theFact,
+                       theTask->patternPtr,
+                       theTask->offset,
+                       theTask->markers,
+                       theTask->endMark);
+     }
+
+   LeaveAtomTables(theEnv,execStatus);
+   apr_thread_rwlock_unlock(theScheduler->networkLock);
+
+   /*=====================================================*/
+   /* Facts which were logically dependent on the partial */
+   /* matches blocked by the task are retracted by        */
+   /* WaitForMatchingTasks once the deferred retractions  */
+   /* have been performed.                                */
+   /*=====================================================*/
+
+   while (theTask->markers != NULL)
+     {
+      theMarker = theTask->markers;
+      theTask->markers = theMarker->next;
+      rtn_struct(theEnv,execStatus,multifieldMarker,theMarker);
+     }
+
+   ReleaseMatchTask(theEnv,execStatus,theTask);
+
+   if (apr_atomic_dec32(&theScheduler->pendingTasks) == 0)
+     {
+      apr_thread_mutex_lock(theScheduler->lock);
+      apr_thread_cond_broadcast(theScheduler->tasksDone);
+      apr_thread_mutex_unlock(theScheduler->lock);
+     }
+  }
+
+/********************************************************/
+/* GetMatchTask: Returns a task descriptor. Workers use */
+/*   their own freelist; other threads and workers with */
+/*   an empty freelist fall back to the shared freelist */
+/*   and finally to malloc.                             */
+/********************************************************/
+static struct factMatchTask *GetMatchTask(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   struct matchWorker *theWorker = execStatus->MatchWorker;
+   struct factMatchTask *theTask = NULL;
+
+   if ((theWorker != NULL) && (theWorker->freeList != NULL))
+     {
+      theTask = theWorker->freeList;
+      theWorker->freeList = theTask->next;
+      theWorker->freeCount--;
+      return(theTask);
+     }
+
+   if (theScheduler->sharedFreeList != NULL)
+     {
+      apr_thread_mutex_lock(theScheduler->injectQueue.lock);
+      if (theScheduler->sharedFreeList != NULL)
+        {
+         theTask = theScheduler->sharedFreeList;
+         theScheduler->sharedFreeList = theTask->next;
+        }
+      apr_thread_mutex_unlock(theScheduler->injectQueue.lock);
+     }
+
+   if (theTask == NULL)
+     {
+      theTask = (struct factMatchTask *) malloc(sizeof(struct factMatchTask));
+      if (theTask == NULL)
+        {
+         SystemError(theEnv,execStatus,"malloc failed",1);
+         EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+        }
+     }
+
+   return(theTask);
+  }
+
+/**********************************************************/
+/* ReleaseMatchTask: Puts a task descriptor on the worker */
+/*   freelist. Once the freelist grows beyond its limit,  */
+/*   half of it is moved to the shared freelist where the */
+/*   threads submitting root-level tasks pick it up.      */
+/**********************************************************/
+static void ReleaseMatchTask(
+  void *theEnv,
+  EXEC_STATUS,
+  struct factMatchTask *theTask)
+  {
+   struct matchSchedulerData *theScheduler = MatchSchedulerData(theEnv,execStatus);
+   struct matchWorker *theWorker = execStatus->MatchWorker;
+   struct factMatchTask *batch, *lastInBatch;
+   unsigned long i;
+
+   theTask->next = theWorker->freeList;
+   theWorker->freeList = theTask;
+   theWorker->freeCount++;
+
+   if (theWorker->freeCount <= MATCH_TASK_FREELIST_MAX) return;
+
+   batch = lastInBatch = theWorker->freeList;
+   for (i = 1; i < MATCH_TASK_FREELIST_MAX / 2; i++)
+     { lastInBatch = lastInBatch->next; }
+
+   theWorker->freeList = lastInBatch->next;
+   theWorker->freeCount -= MATCH_TASK_FREELIST_MAX / 2;
+
+   apr_thread_mutex_lock(theScheduler->injectQueue.lock);
+   lastInBatch->next = theScheduler->sharedFreeList;
+   theScheduler->sharedFreeList = batch;
+   apr_thread_mutex_unlock(theScheduler->injectQueue.lock);
+  }
+
+/***************************************************/
+/* InitializeMatchDeque: Creates an empty deque of */
+/*   match tasks with its lock.                    */
+/***************************************************/
+static intBool InitializeMatchDeque(
+  void *theEnv,
+  EXEC_STATUS,
+  struct matchDeque *theDeque)
+  {
+   if (apr_thread_mutex_create(&theDeque->lock,APR_THREAD_MUTEX_DEFAULT,
+                               Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+     { return(FALSE); }
+
+   theDeque->tasks = (struct factMatchTask **)
+                     malloc(sizeof(struct factMatchTask *) * INITIAL_MATCH_DEQUE_SIZE);
+   if (theDeque->tasks == NULL)
+     {
+      apr_thread_mutex_destroy(theDeque->lock);
+      return(FALSE);
+     }
+
+   theDeque->size = INITIAL_MATCH_DEQUE_SIZE;
+   theDeque->top = 0;
+   theDeque->bottom = 0;
+
+   return(TRUE);
+  }
+
+/****************************************************/
+/* DestroyMatchDeque: Releases an (empty) deque.    */
+/****************************************************/
+static void DestroyMatchDeque(
+  struct matchDeque *theDeque)
+  {
+   apr_thread_mutex_destroy(theDeque->lock);
+   free(theDeque->tasks);
+   theDeque->tasks = NULL;
+  }
+
+/*****************************************************/
+/* PushMatchTask: Adds a task at the bottom of a     */
+/*   deque. The ring is doubled in size when full.   */
+/*****************************************************/
+static void PushMatchTask(
+  struct matchDeque *theDeque,
+  struct factMatchTask *theTask)
+  {
+   struct factMatchTask **newTasks;
+   unsigned long i;
+
+   apr_thread_mutex_lock(theDeque->lock);
+
+   if ((theDeque->bottom - theDeque->top) == theDeque->size)
+     {
+      newTasks = (struct factMatchTask **)
+                 malloc(sizeof(struct factMatchTask *) * theDeque->size * 2);
+      if (newTasks == NULL)
+        {
+         apr_thread_mutex_unlock(theDeque->lock);
+         printf("\n[FACTSCHD2] Unable to grow match task deque.\n");
+         exit(EXIT_FAILURE);
+        }
+
+      for (i = theDeque->top; i < theDeque->bottom; i++)
+        { newTasks[i & ((theDeque->size * 2) - 1)] = theDeque->tasks[i & (theDeque->size - 1)]; }
+
+      free(theDeque->tasks);
+      theDeque->tasks = newTasks;
+      theDeque->size *= 2;
+     }
+
+   theDeque->tasks[theDeque->bottom & (theDeque->size - 1)] = theTask;
+   theDeque->bottom++;
+
+   apr_thread_mutex_unlock(theDeque->lock);
+  }
+
+/*****************************************************/
+/* PopMatchTask: Removes the most recently pushed    */
+/*   task from the bottom of a deque (owner side).   */
+/*****************************************************/
+static struct factMatchTask *PopMatchTask(
+  struct matchDeque *theDeque)
+  {
+   struct factMatchTask *theTask = NULL;
+
+   apr_thread_mutex_lock(theDeque->lock);
+   if (theDeque->bottom != theDeque->top)
+     {
+      theDeque->bottom--;
+      theTask = theDeque->tasks[theDeque->bottom & (theDeque->size - 1)];
+     }
+   apr_thread_mutex_unlock(theDeque->lock);
+
+   return(theTask);
+  }
+
+/*****************************************************/
+/* StealMatchTask: Removes the oldest task from the  */
+/*   top of a deque (thief side). Busy deques are    */
+/*   skipped rather than waited for.                 */
+/*****************************************************/
+static struct factMatchTask *StealMatchTask(
+  struct matchDeque *theDeque)
+  {
+   struct factMatchTask *theTask = NULL;
+
+   if (apr_thread_mutex_trylock(theDeque->lock) != APR_SUCCESS)
+     { return(NULL); }
+
+   if (theDeque->bottom != theDeque->top)
+     {
+      theTask = theDeque->tasks[theDeque->top & (theDeque->size - 1)];
+      theDeque->top++;
+     }
+   apr_thread_mutex_unlock(theDeque->lock);
+
+   return(theTask);
+  }
+
+#endif /* DEFTEMPLATE_CONSTRUCT && DEFRULE_CONSTRUCT */
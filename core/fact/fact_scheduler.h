@@ -0,0 +1,142 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*            FACT MATCH SCHEDULER HEADER FILE         */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Work-stealing scheduler for the parallel fact    */
+/*   pattern matcher.                                        */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_factschd
+
+#define _H_factschd
+
+struct factMatchTask;
+struct matchWorker;
+
+#ifndef _H_factmngr
+#include "fact_manager.h"
+#endif
+#ifndef _H_factbld
+#include "factbld.h"
+#endif
+
+# include <apr_atomic.h>
+# include <apr_thread_mutex.h>
+# include <apr_thread_cond.h>
+# include <apr_thread_rwlock.h>
+
+# include "execution_status.h"
+
+#define MATCH_SCHEDULER_DATA 65
+
+/*=====================================================*/
+/* Number of task descriptors a worker keeps cached    */
+/* before handing a batch back to the shared freelist. */
+/*=====================================================*/
+
+#define MATCH_TASK_FREELIST_MAX   256
+#define INITIAL_MATCH_DEQUE_SIZE  64
+
+/************************************************************/
+/* FACTMATCHTASK STRUCTURE: Describes a sub-tree of a fact  */
+/*   pattern network which has to be matched against a      */
+/*   fact, or a run of facts sharing a deftemplate which    */
+/*   have to be matched against their whole pattern network */
+/*   (factBatch != NULL). Tasks are recycled through        */
+/*   per-worker freelists.                                  */
+/************************************************************/
+struct factMatchTask
+  {
+   struct fact *theFact;
+   struct factPatternNode *patternPtr;
+   int offset;
+   struct multifieldMarker *markers;
+   struct multifieldMarker *endMark;
+   struct fact **factBatch;
+   size_t batchSize;
+   struct factMatchTask *next;
+  };
+
+/************************************************************/
+/* MATCHDEQUE STRUCTURE: A growable ring of tasks. The      */
+/*   owning worker pushes and pops at the bottom while idle */
+/*   workers steal the oldest tasks from the top.           */
+/************************************************************/
+struct matchDeque
+  {
+   apr_thread_mutex_t *lock;
+   struct factMatchTask **tasks;
+   unsigned long size;
+   unsigned long top;
+   unsigned long bottom;
+  };
+
+/************************************************************/
+/* MATCHWORKER STRUCTURE: The state owned by one worker of  */
+/*   the matcher thread pool while it is draining tasks.    */
+/************************************************************/
+struct matchWorker
+  {
+   volatile apr_uint32_t inUse;
+   struct matchDeque deque;
+   struct factMatchTask *freeList;
+   unsigned long freeCount;
+  };
+
+/************************************************************/
+/* The network lock is held for reading by the workers      */
+/* while they run a task, since they only add partial       */
+/* matches to the join network. Threads outside the pool    */
+/* hold it for writing while they modify the network in any */
+/* other way.                                               */
+/************************************************************/
+struct matchSchedulerData
+  {
+   apr_thread_mutex_t *lock;
+   apr_thread_cond_t *tasksDone;
+   apr_thread_rwlock_t *networkLock;
+   struct matchWorker *workers;
+   unsigned int workerCount;
+   struct matchDeque injectQueue;
+   struct factMatchTask *sharedFreeList;
+   volatile apr_uint32_t activeWorkers;
+   volatile apr_uint32_t queuedTasks;
+   volatile apr_uint32_t pendingTasks;
+   volatile apr_uint32_t nextVictim;
+  };
+
+#define MatchSchedulerData(theEnv,execStatus) ((struct matchSchedulerData *) GetEnvironmentData(theEnv,execStatus,MATCH_SCHEDULER_DATA))
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _FACTSCHD_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+   LOCALE void                           InitializeMatchScheduler(void *,EXEC_STATUS);
+   LOCALE void                           SpawnMatchingTask(void *,EXEC_STATUS,struct fact *,
+                                                           struct factPatternNode *,int,
+                                                           struct multifieldMarker *,
+                                                           struct multifieldMarker *);
+   LOCALE void                           SpawnMatchingBatch(void *,EXEC_STATUS,struct fact **,size_t);
+   LOCALE void                           WaitForMatchingTasks(void *,EXEC_STATUS);
+   LOCALE void                           LockJoinNetwork(void *,EXEC_STATUS);
+   LOCALE void                           UnlockJoinNetwork(void *,EXEC_STATUS);
+
+#endif
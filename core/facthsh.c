@@ -11,6 +11,14 @@
 /*   table so that duplication of facts can quickly be       */
 /*   determined.                                             */
 /*                                                           */
+/*   The buckets are guarded by a fixed set of stripe locks, */
+/*   so facts can be added, removed and checked for          */
+/*   duplicates from several threads at once. The table lock */
+/*   is only taken exclusively to swap tables: a resize      */
+/*   installs a table of twice the size and the buckets of   */
+/*   the old one are moved over a chunk at a time by every   */
+/*   later access, instead of in one stop-the-world pass.    */
+/*                                                           */
 /* Principal Programmer(s):                                  */
 /*      Gary D. Riley                                        */
 /*                                                           */
@@ -36,6 +44,7 @@
 
 #include "constant.h"
 #include "memalloc.h"
+#include "prntutil.h"
 #include "router.h"
 #include "sysdep.h"
 #include "envrnmnt.h"
@@ -46,14 +55,20 @@
 
 #include "facthsh.h"
 
+# include <apr_atomic.h>
+# include <apr_thread_mutex.h>
 # include <apr_thread_rwlock.h>
 
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
 
+   static unsigned long           MixFactHash(unsigned long);
    static struct fact            *FactExists(void *,EXEC_STATUS,struct fact *,unsigned long);
+   static struct fact            *EnterHashedFact(void *,EXEC_STATUS,struct fact *,unsigned long,intBool);
    static struct factHashEntry  **CreateFactHashTable(void *,EXEC_STATUS,unsigned long);
+   static intBool                 MigrateFactHashBuckets(void *,EXEC_STATUS);
+   static void                    MaintainFactHashTable(void *,EXEC_STATUS,intBool);
    static void                    ResizeFactHashTable(void *,EXEC_STATUS);
    static void                    ResetFactHashTable(void *,EXEC_STATUS);
    
@@ -91,37 +106,129 @@ unsigned long HashFact(
    return(count);
   }
 
+/*************************************************************/
+/* MixFactHash: Scrambles the bits of a fact hash value. The */
+/*   bucket and the stripe lock are taken from the low bits  */
+/*   of the result, which are poorly distributed otherwise.  */
+/*************************************************************/
+static unsigned long MixFactHash(
+  unsigned long hashValue)
+  {
+   hashValue ^= hashValue >> 16;
+   hashValue *= 0x45d9f3bUL;
+   hashValue ^= hashValue >> 16;
+
+   return(hashValue);
+  }
+
 /**********************************************/
 /* FactExists: Determines if a specified fact */
 /*   already exists in the fact hash table.   */
+/*   The caller must hold the table lock (for */
+/*   reading) and the fact's stripe lock.     */
 /**********************************************/
 static struct fact *FactExists(
   void *theEnv,
   EXEC_STATUS,
   struct fact *theFact,
-  unsigned long hashValue)
+  unsigned long mixedValue)
   {
    struct factHashEntry *theFactHash;
+   struct factHashEntry **theTable;
+   unsigned long theSize;
+   int i;
 
-   // Lode: warning! not thread-safe but only called from HandleFactDuplication and that one _is_ safe
-   hashValue = (hashValue % FactData(theEnv,execStatus)->FactHashTableSize);
+   /*===================================================*/
+   /* While a resize is in progress, the fact may still */
+   /* be in the bucket of the old table it hashes to.   */
+   /*===================================================*/
 
-   for (theFactHash = FactData(theEnv,execStatus)->FactHashTable[hashValue];
-        theFactHash != NULL;
-        theFactHash = theFactHash->next)
+   for (i = 0; i < 2; i++)
      {
-      if (theFact->hashValue != theFactHash->theFact->hashValue)
-        { continue; }
+      if (i == 0)
+        {
+         theTable = FactData(theEnv,execStatus)->FactHashTable;
+         theSize = FactData(theEnv,execStatus)->FactHashTableSize;
+        }
+      else
+        {
+         theTable = FactData(theEnv,execStatus)->OldFactHashTable;
+         theSize = FactData(theEnv,execStatus)->OldFactHashTableSize;
+         if (theTable == NULL) break;
+        }
+
+      for (theFactHash = theTable[mixedValue & (theSize - 1)];
+           theFactHash != NULL;
+           theFactHash = theFactHash->next)
+        {
+         if (theFact->hashValue != theFactHash->theFact->hashValue)
+           { continue; }
 
-      if ((theFact->whichDeftemplate == theFactHash->theFact->whichDeftemplate) ?
-          MultifieldsEqual(&theFact->theProposition,
-                           &theFactHash->theFact->theProposition) : FALSE)
-        { return(theFactHash->theFact); }
+         if ((theFact->whichDeftemplate == theFactHash->theFact->whichDeftemplate) ?
+             MultifieldsEqual(&theFact->theProposition,
+                              &theFactHash->theFact->theProposition) : FALSE)
+           { return(theFactHash->theFact); }
+        }
      }
 	  
    return(NULL);
   }
 
+/**************************************************************/
+/* EnterHashedFact: Adds a fact entry to the fact hash table. */
+/*   If checkDuplicates is TRUE, the fact is only added if no */
+/*   equal fact is found. The check and the insertion happen  */
+/*   under the same stripe lock, so two threads asserting the */
+/*   same fact can't both succeed. Returns the existing fact  */
+/*   if a duplicate was found and NULL otherwise.             */
+/**************************************************************/
+static struct fact *EnterHashedFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact,
+  unsigned long hashValue,
+  intBool checkDuplicates)
+  {
+   struct factHashEntry *newhash;
+   struct fact *existingFact = NULL;
+   apr_thread_mutex_t *theStripe;
+   unsigned long mixedValue, bucket;
+   intBool migrationDone;
+
+   newhash = get_struct(theEnv,execStatus,factHashEntry);
+   newhash->theFact = theFact;
+
+   mixedValue = MixFactHash(hashValue);
+   theStripe = FactData(theEnv,execStatus)->FactHashStripes[mixedValue & (FACT_HASH_STRIPES - 1)];
+
+   apr_thread_rwlock_rdlock(Env(theEnv,execStatus)->factHashLock);
+
+   migrationDone = MigrateFactHashBuckets(theEnv,execStatus);
+
+   apr_thread_mutex_lock(theStripe);
+
+   if (checkDuplicates)
+     { existingFact = FactExists(theEnv,execStatus,theFact,mixedValue); }
+
+   if (existingFact == NULL)
+     {
+      bucket = mixedValue & (FactData(theEnv,execStatus)->FactHashTableSize - 1);
+      newhash->next = FactData(theEnv,execStatus)->FactHashTable[bucket];
+      FactData(theEnv,execStatus)->FactHashTable[bucket] = newhash;
+      apr_atomic_inc32(&FactData(theEnv,execStatus)->FactHashCount);
+     }
+
+   apr_thread_mutex_unlock(theStripe);
+   apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
+
+   if (existingFact != NULL)
+     { rtn_struct(theEnv,execStatus,factHashEntry,newhash); }
+
+   MaintainFactHashTable(theEnv,execStatus,migrationDone);
+
+   return(existingFact);
+  }
+
 /************************************************************/
 /* AddHashedFact: Adds a fact entry to the fact hash table. */
 /************************************************************/
@@ -131,28 +238,38 @@ globle void AddHashedFact(
   struct fact *theFact,
   unsigned long hashValue)
   {
-   struct factHashEntry *newhash, *temp;
-	  
-	// Lode: Add a write lock to the FactHashTable
-	// XXX: could be removed?
-	apr_thread_rwlock_wrlock(Env(theEnv,execStatus)->factHashLock);
-	  
-   if (FactData(theEnv,execStatus)->NumberOfFacts > FactData(theEnv,execStatus)->FactHashTableSize)
-     { ResizeFactHashTable(theEnv,execStatus); }
+   EnterHashedFact(theEnv,execStatus,theFact,hashValue,FALSE);
+  }
 
-   newhash = get_struct(theEnv,execStatus,factHashEntry);
-   newhash->theFact = theFact;
-	  
-    
-   hashValue = (hashValue % FactData(theEnv,execStatus)->FactHashTableSize);  // not thread-safe, could be resized...
-   
-   temp = FactData(theEnv,execStatus)->FactHashTable[hashValue];
-   FactData(theEnv,execStatus)->FactHashTable[hashValue] = newhash;
-   newhash->next = temp;
-	  
-   // Lode: Unlock
-   apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
-	  
+/**************************************************************/
+/* AddHashedFactBatch: Checks a batch of facts for duplicates */
+/*   and adds the unique ones to the fact hash table. Facts   */
+/*   are entered one after the other, so a fact duplicating   */
+/*   an earlier fact of the same batch is detected as well.   */
+/*   The existing fact is stored in duplicates for every      */
+/*   duplicate found (NULL otherwise). Returns the number of  */
+/*   facts added.                                             */
+/**************************************************************/
+globle size_t AddHashedFactBatch(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact **facts,
+  struct fact **duplicates,
+  size_t n)
+  {
+   size_t i, added = 0;
+   intBool checkDuplicates;
+
+   checkDuplicates = ! FactData(theEnv,execStatus)->FactDuplication;
+
+   for (i = 0; i < n; i++)
+     {
+      duplicates[i] = EnterHashedFact(theEnv,execStatus,facts[i],
+                                      HashFact(facts[i]),checkDuplicates);
+      if (duplicates[i] == NULL) added++;
+     }
+
+   return(added);
   }
 
 /******************************************/
@@ -164,55 +281,116 @@ globle intBool RemoveHashedFact(
   EXEC_STATUS,
   struct fact *theFact)
   {
-   unsigned long hashValue;
-   struct factHashEntry *hptr, *prev;
-	  
-   hashValue = HashFact(theFact);
+   unsigned long mixedValue;
+   struct factHashEntry **theTable;
+   struct factHashEntry *hptr, *prev, *found = NULL;
+   apr_thread_mutex_t *theStripe;
+   intBool migrationDone, tableEmpty = FALSE;
+   int i;
 	  
-   // Lode: Add a write lock to the FactHashTable
-   apr_thread_rwlock_wrlock(Env(theEnv,execStatus)->factHashLock);
+   mixedValue = MixFactHash(HashFact(theFact));
+   theStripe = FactData(theEnv,execStatus)->FactHashStripes[mixedValue & (FACT_HASH_STRIPES - 1)];
 	  
-   hashValue = (hashValue % FactData(theEnv,execStatus)->FactHashTableSize);
+   apr_thread_rwlock_rdlock(Env(theEnv,execStatus)->factHashLock);
+
+   migrationDone = MigrateFactHashBuckets(theEnv,execStatus);
+
+   apr_thread_mutex_lock(theStripe);
 
-   for (hptr = FactData(theEnv,execStatus)->FactHashTable[hashValue], prev = NULL;
-        hptr != NULL;
-        hptr = hptr->next)
+   for (i = 0; (i < 2) && (found == NULL); i++)
      {
-      if (hptr->theFact == theFact)
+      if (i == 0)
+        {
+         theTable = FactData(theEnv,execStatus)->FactHashTable;
+         theTable += mixedValue & (FactData(theEnv,execStatus)->FactHashTableSize - 1);
+        }
+      else
+        {
+         theTable = FactData(theEnv,execStatus)->OldFactHashTable;
+         if (theTable == NULL) break;
+         theTable += mixedValue & (FactData(theEnv,execStatus)->OldFactHashTableSize - 1);
+        }
+
+      for (hptr = *theTable, prev = NULL;
+           hptr != NULL;
+           prev = hptr, hptr = hptr->next)
         {
+         if (hptr->theFact != theFact) continue;
+
          if (prev == NULL)
-           {
-            FactData(theEnv,execStatus)->FactHashTable[hashValue] = hptr->next;
-            rtn_struct(theEnv,execStatus,factHashEntry,hptr);
-            if (FactData(theEnv,execStatus)->NumberOfFacts == 1)
-              { ResetFactHashTable(theEnv,execStatus); }
-			apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock); // Lode: Unlock
-            return(1);
-           }
+           { *theTable = hptr->next; }
          else
-           {
-            prev->next = hptr->next;
-            rtn_struct(theEnv,execStatus,factHashEntry,hptr);
-            if (FactData(theEnv,execStatus)->NumberOfFacts == 1)
-              { ResetFactHashTable(theEnv,execStatus); }
-			apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock); // Lode: Unlock
-            return(1);
-           }
+           { prev->next = hptr->next; }
+
+         found = hptr;
+         tableEmpty = (apr_atomic_dec32(&FactData(theEnv,execStatus)->FactHashCount) == 0);
+         break;
         }
-      prev = hptr;
      }
-   
-   // Lode: Unlock FactHashTable
+
+   apr_thread_mutex_unlock(theStripe);
    apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
-   
-   return(0);
+
+   if (found == NULL)
+     {
+      MaintainFactHashTable(theEnv,execStatus,migrationDone);
+      return(0);
+     }
+
+   rtn_struct(theEnv,execStatus,factHashEntry,found);
+
+   MaintainFactHashTable(theEnv,execStatus,migrationDone);
+
+   /*==============================================*/
+   /* Shrink the table back to its original size   */
+   /* once the last fact has been removed from it. */
+   /*==============================================*/
+
+   if (tableEmpty)
+     {
+      apr_thread_rwlock_wrlock(Env(theEnv,execStatus)->factHashLock);
+      ResetFactHashTable(theEnv,execStatus);
+      apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
+     }
+
+   return(1);
+  }
+
+/**************************************************************/
+/* FindHashedFact: Returns a fact of the fact hash table      */
+/*   which is equal to the specified fact, or NULL if there   */
+/*   is none. The specified fact need not be in the table.    */
+/**************************************************************/
+globle struct fact *FindHashedFact(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct fact *existingFact;
+   apr_thread_mutex_t *theStripe;
+   unsigned long mixedValue;
+
+   mixedValue = MixFactHash(HashFact(theFact));
+   theStripe = FactData(theEnv,execStatus)->FactHashStripes[mixedValue & (FACT_HASH_STRIPES - 1)];
+
+   apr_thread_rwlock_rdlock(Env(theEnv,execStatus)->factHashLock);
+   apr_thread_mutex_lock(theStripe);
+
+   existingFact = FactExists(theEnv,execStatus,theFact,mixedValue);
+
+   apr_thread_mutex_unlock(theStripe);
+   apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
+
+   return(existingFact);
   }
 
 /*****************************************************/
 /* HandleFactDuplication: Determines if a fact to be */
 /*   added to the fact-list is a duplicate entry and */
 /*   takes appropriate action based on the current   */
-/*   setting of the fact-duplication flag.           */
+/*   setting of the fact-duplication flag. A fact    */
+/*   which isn't a duplicate is entered in the fact  */
+/*   hash table right away.                          */
 /*****************************************************/
 globle unsigned long HandleFactDuplication(
   void *theEnv,
@@ -224,24 +402,12 @@ globle unsigned long HandleFactDuplication(
    unsigned long hashValue;
    *duplicate = FALSE;
 	  
-   // Lode: Add a read lock to the FactHashTable
-   // XXX: could be removed?
-   apr_thread_rwlock_rdlock(Env(theEnv,execStatus)->factHashLock);
-	  
    hashValue = HashFact((struct fact *) theFact);
 
-   if (FactData(theEnv,execStatus)->FactDuplication) return(hashValue);
-
-   tempPtr = FactExists(theEnv,execStatus,(struct fact *) theFact,hashValue);
-	  if (tempPtr == NULL) {
-		  apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock); // Lode: Unlock
-		  return(hashValue);
-	  }
-	  
-	// Lode: Unlock FactHashTable
-	apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
+   tempPtr = EnterHashedFact(theEnv,execStatus,(struct fact *) theFact,hashValue,
+                             ! FactData(theEnv,execStatus)->FactDuplication);
+   if (tempPtr == NULL) return(hashValue);
 	  
-   // Lode: TODO check thread-safety
    ReturnFact(theEnv,execStatus,(struct fact *) theFact);
 #if DEFRULE_CONSTRUCT
    AddLogicalDependencies(theEnv,execStatus,(struct patternEntity *) tempPtr,TRUE);
@@ -280,14 +446,75 @@ globle intBool EnvSetFactDuplication(
 
 /**************************************************/
 /* InitializeFactHashTable: Initializes the table */
-/*   entries in the fact hash table to NULL.      */
+/*   entries in the fact hash table to NULL and   */
+/*   creates the stripe locks.                    */
 /**************************************************/
 globle void InitializeFactHashTable(
    void *theEnv,
   EXEC_STATUS)
    {
+    int i;
+
     FactData(theEnv,execStatus)->FactHashTable = CreateFactHashTable(theEnv,execStatus,SIZE_FACT_HASH);
     FactData(theEnv,execStatus)->FactHashTableSize = SIZE_FACT_HASH;
+
+    for (i = 0; i < FACT_HASH_STRIPES; i++)
+      {
+       if (apr_thread_mutex_create(&FactData(theEnv,execStatus)->FactHashStripes[i],
+                                   APR_THREAD_MUTEX_DEFAULT,
+                                   Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+         {
+          SystemError(theEnv,execStatus,"FACTHSH",1);
+          EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+         }
+      }
+   }
+
+/**********************************************************/
+/* DeallocateFactHashTable: Returns the entries and the   */
+/*   bucket arrays of the fact hash table, including the  */
+/*   old table of a resize which hasn't completed yet.    */
+/**********************************************************/
+globle void DeallocateFactHashTable(
+   void *theEnv,
+  EXEC_STATUS)
+   {
+    struct factHashEntry **theTable;
+    struct factHashEntry *theEntry, *nextEntry;
+    unsigned long i, theSize;
+    int j;
+
+    for (j = 0; j < 2; j++)
+      {
+       if (j == 0)
+         {
+          theTable = FactData(theEnv,execStatus)->FactHashTable;
+          theSize = FactData(theEnv,execStatus)->FactHashTableSize;
+         }
+       else
+         {
+          theTable = FactData(theEnv,execStatus)->OldFactHashTable;
+          theSize = FactData(theEnv,execStatus)->OldFactHashTableSize;
+         }
+
+       if (theTable == NULL) continue;
+
+       for (i = 0; i < theSize; i++)
+         {
+          theEntry = theTable[i];
+          while (theEntry != NULL)
+            {
+             nextEntry = theEntry->next;
+             rtn_struct(theEnv,execStatus,factHashEntry,theEntry);
+             theEntry = nextEntry;
+            }
+         }
+
+       rm3(theEnv,execStatus,theTable,sizeof(struct factHashEntry *) * theSize);
+      }
+
+    FactData(theEnv,execStatus)->FactHashTable = NULL;
+    FactData(theEnv,execStatus)->OldFactHashTable = NULL;
    }
 
 /*******************************************************************/
@@ -310,54 +537,131 @@ static struct factHashEntry **CreateFactHashTable(
     
     return(theTable);
    }
- 
-/*******************************************************************/
-/* ResizeFactHashTable: */
-/*******************************************************************/
-static void ResizeFactHashTable(
+
+/************************************************************/
+/* MigrateFactHashBuckets: If a resize is in progress, this */
+/*   claims the next chunk of buckets of the old table and  */
+/*   moves their entries to the new table. The caller must  */
+/*   hold the table lock for reading. Returns TRUE if the   */
+/*   chunk moved was the last one outstanding, in which     */
+/*   case the caller has to release the old table.          */
+/************************************************************/
+static intBool MigrateFactHashBuckets(
    void *theEnv,
   EXEC_STATUS)
    {
-    unsigned long i, newSize, newLocation;
-    struct factHashEntry **theTable, **newTable;
+    struct factHashEntry **oldTable, **newTable;
     struct factHashEntry *theEntry, *nextEntry;
-	   
-	// Lode: warning! not thread-safe but only called from AddHashedFact and that one _is_ safe
-    theTable = FactData(theEnv,execStatus)->FactHashTable;
-    
-    newSize = (FactData(theEnv,execStatus)->FactHashTableSize * 2) + 1;
-    newTable = CreateFactHashTable(theEnv,execStatus,newSize);
+    unsigned long i, first, last, newSize, newLocation;
+    apr_thread_mutex_t *theStripe;
 
-    /*========================================*/
-    /* Copy the old entries to the new table. */
-    /*========================================*/
-    
-    for (i = 0; i < FactData(theEnv,execStatus)->FactHashTableSize; i++)
+    oldTable = FactData(theEnv,execStatus)->OldFactHashTable;
+    if (oldTable == NULL) return(FALSE);
+
+    first = apr_atomic_add32(&FactData(theEnv,execStatus)->FactHashMigrateIndex,FACT_HASH_MIGRATE_CHUNK);
+    if (first >= FactData(theEnv,execStatus)->OldFactHashTableSize) return(FALSE);
+
+    last = first + FACT_HASH_MIGRATE_CHUNK;
+    if (last > FactData(theEnv,execStatus)->OldFactHashTableSize)
+      { last = FactData(theEnv,execStatus)->OldFactHashTableSize; }
+
+    newTable = FactData(theEnv,execStatus)->FactHashTable;
+    newSize = FactData(theEnv,execStatus)->FactHashTableSize;
+
+    /*=====================================================*/
+    /* Bucket i of the old table and the buckets its facts */
+    /* move to are guarded by the same stripe lock.        */
+    /*=====================================================*/
+
+    for (i = first; i < last; i++)
       {
-       theEntry = theTable[i];
+       theStripe = FactData(theEnv,execStatus)->FactHashStripes[i & (FACT_HASH_STRIPES - 1)];
+       apr_thread_mutex_lock(theStripe);
+
+       theEntry = oldTable[i];
        while (theEntry != NULL)
-         { 
+         {
           nextEntry = theEntry->next;
-          
-          newLocation = theEntry->theFact->hashValue % newSize;
+
+          newLocation = MixFactHash(theEntry->theFact->hashValue) & (newSize - 1);
           theEntry->next = newTable[newLocation];
           newTable[newLocation] = theEntry;
-          
+
           theEntry = nextEntry;
          }
+       oldTable[i] = NULL;
+
+       apr_thread_mutex_unlock(theStripe);
       }
-    
-    /*=====================================================*/
-    /* Replace the old hash table with the new hash table. */
-    /*=====================================================*/
-    
-    rm3(theEnv,execStatus,theTable,sizeof(struct factHashEntry *) * FactData(theEnv,execStatus)->FactHashTableSize);
+
+    return((apr_atomic_add32(&FactData(theEnv,execStatus)->FactHashMigrated,last - first) + (last - first)) ==
+           FactData(theEnv,execStatus)->OldFactHashTableSize);
+   }
+
+/***********************************************************/
+/* MaintainFactHashTable: Called without any locks held    */
+/*   after the table has been accessed. Releases the old   */
+/*   table once all of its buckets have been moved and     */
+/*   starts a resize if the table has become too crowded.  */
+/***********************************************************/
+static void MaintainFactHashTable(
+   void *theEnv,
+  EXEC_STATUS,
+   intBool migrationDone)
+   {
+    if (migrationDone)
+      {
+       apr_thread_rwlock_wrlock(Env(theEnv,execStatus)->factHashLock);
+       rm3(theEnv,execStatus,FactData(theEnv,execStatus)->OldFactHashTable,
+           sizeof(struct factHashEntry *) * FactData(theEnv,execStatus)->OldFactHashTableSize);
+       FactData(theEnv,execStatus)->OldFactHashTable = NULL;
+       FactData(theEnv,execStatus)->OldFactHashTableSize = 0;
+       apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
+      }
+
+    if ((apr_atomic_read32(&FactData(theEnv,execStatus)->FactHashCount) <= FactData(theEnv,execStatus)->FactHashTableSize) ||
+        (FactData(theEnv,execStatus)->OldFactHashTable != NULL))
+      { return; }
+
+    apr_thread_rwlock_wrlock(Env(theEnv,execStatus)->factHashLock);
+    ResizeFactHashTable(theEnv,execStatus);
+    apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
+   }
+ 
+/*******************************************************************/
+/* ResizeFactHashTable: Installs a table of twice the size. The    */
+/*   entries stay in the old table until MigrateFactHashBuckets    */
+/*   moves them. The caller must hold the table lock for writing.  */
+/*******************************************************************/
+static void ResizeFactHashTable(
+   void *theEnv,
+  EXEC_STATUS)
+   {
+    unsigned long newSize;
+
+    /*=============================================*/
+    /* Another thread may have started the resize  */
+    /* while this one was waiting for the lock.    */
+    /*=============================================*/
+
+    if ((FactData(theEnv,execStatus)->OldFactHashTable != NULL) ||
+        (apr_atomic_read32(&FactData(theEnv,execStatus)->FactHashCount) <= FactData(theEnv,execStatus)->FactHashTableSize))
+      { return; }
+
+    newSize = FactData(theEnv,execStatus)->FactHashTableSize * 2;
+
+    FactData(theEnv,execStatus)->OldFactHashTable = FactData(theEnv,execStatus)->FactHashTable;
+    FactData(theEnv,execStatus)->OldFactHashTableSize = FactData(theEnv,execStatus)->FactHashTableSize;
+    FactData(theEnv,execStatus)->FactHashTable = CreateFactHashTable(theEnv,execStatus,newSize);
     FactData(theEnv,execStatus)->FactHashTableSize = newSize;
-    FactData(theEnv,execStatus)->FactHashTable = newTable;
+    apr_atomic_set32(&FactData(theEnv,execStatus)->FactHashMigrateIndex,0);
+    apr_atomic_set32(&FactData(theEnv,execStatus)->FactHashMigrated,0);
    }
 
 /*******************************************************************/
-/* ResetFactHashTable: */
+/* ResetFactHashTable: Replaces an empty, expanded table with one  */
+/*   of the original size. The caller must hold the table lock for */
+/*   writing.                                                      */
 /*******************************************************************/
 static void ResetFactHashTable(
    void *theEnv,
@@ -367,10 +671,13 @@ static void ResetFactHashTable(
 
     /*=============================================*/
     /* Don't reset the table unless the hash table */
-    /* has been expanded from its original size.   */
+    /* has been expanded from its original size    */
+    /* and is still empty.                         */
     /*=============================================*/
     
-    if (FactData(theEnv,execStatus)->FactHashTableSize == SIZE_FACT_HASH)
+    if ((FactData(theEnv,execStatus)->FactHashTableSize == SIZE_FACT_HASH) ||
+        (FactData(theEnv,execStatus)->OldFactHashTable != NULL) ||
+        (apr_atomic_read32(&FactData(theEnv,execStatus)->FactHashCount) != 0))
       { return; }
           
     /*=======================*/
@@ -392,29 +699,52 @@ static void ResetFactHashTable(
 
 /*****************************************************/
 /* ShowFactHashTable: Displays the number of entries */
-/*   in each slot of the fact hash table.            */
+/*   in each slot of the fact hash table (and of the */
+/*   old table while a resize is in progress).       */
 /*****************************************************/
 globle void ShowFactHashTable(
    void *theEnv,
   EXEC_STATUS)
    {
-    int i, count;
+    unsigned long i, theSize;
+    int count, j;
+    struct factHashEntry **theTable;
     struct factHashEntry *theEntry;
-    char buffer[20];
+    char buffer[40];
+
+    apr_thread_rwlock_wrlock(Env(theEnv,execStatus)->factHashLock);
 
-    for (i = 0; i < FactData(theEnv,execStatus)->FactHashTableSize; i++)
+    for (j = 0; j < 2; j++)
       {
-       for (theEntry =  FactData(theEnv,execStatus)->FactHashTable[i], count = 0;
-            theEntry != NULL;
-            theEntry = theEntry->next)
-         { count++; }
+       if (j == 0)
+         {
+          theTable = FactData(theEnv,execStatus)->FactHashTable;
+          theSize = FactData(theEnv,execStatus)->FactHashTableSize;
+         }
+       else
+         {
+          theTable = FactData(theEnv,execStatus)->OldFactHashTable;
+          theSize = FactData(theEnv,execStatus)->OldFactHashTableSize;
+          if (theTable == NULL) break;
+          EnvPrintRouter(theEnv,execStatus,WDISPLAY,"Old table:\n");
+         }
 
-       if (count != 0)
+       for (i = 0; i < theSize; i++)
          {
-          gensprintf(buffer,"%4d: %4d\n",i,count);
-          EnvPrintRouter(theEnv,execStatus,WDISPLAY,buffer);
+          for (theEntry = theTable[i], count = 0;
+               theEntry != NULL;
+               theEntry = theEntry->next)
+            { count++; }
+
+          if (count != 0)
+            {
+             gensprintf(buffer,"%4lu: %4d\n",i,count);
+             EnvPrintRouter(theEnv,execStatus,WDISPLAY,buffer);
+            }
          }
       }
+
+    apr_thread_rwlock_unlock(Env(theEnv,execStatus)->factHashLock);
    }
 
 #endif /* DEVELOPER */
@@ -26,6 +26,18 @@
 
 struct factHashEntry;
 
+/*==========================================================*/
+/* The table size is a power of two and always a multiple   */
+/* of the number of lock stripes, so a fact stays under the */
+/* same stripe lock no matter how often the table grows.    */
+/* A resize moves FACT_HASH_MIGRATE_CHUNK buckets of the    */
+/* old table every time the table is accessed.              */
+/*==========================================================*/
+
+#define SIZE_FACT_HASH 16384
+#define FACT_HASH_STRIPES 64
+#define FACT_HASH_MIGRATE_CHUNK 16
+
 #ifndef _H_factmngr
 #include "fact/fact_manager.h"
 #endif
@@ -36,8 +48,6 @@ struct factHashEntry
    struct factHashEntry *next;
   };
 
-#define SIZE_FACT_HASH 16231
-
 #ifdef LOCALE
 #undef LOCALE
 #endif
@@ -51,11 +61,14 @@ struct factHashEntry
 #define SetFactDuplication(a) EnvSetFactDuplication(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 
    LOCALE void                           AddHashedFact(void *,EXEC_STATUS,struct fact *,unsigned long);
+   LOCALE size_t                         AddHashedFactBatch(void *,EXEC_STATUS,struct fact **,struct fact **,size_t);
    LOCALE intBool                        RemoveHashedFact(void *,EXEC_STATUS,struct fact *);
+   LOCALE struct fact                   *FindHashedFact(void *,EXEC_STATUS,struct fact *);
    LOCALE unsigned long                  HandleFactDuplication(void *,EXEC_STATUS,void *,intBool *);
    LOCALE intBool                        EnvGetFactDuplication(void *,EXEC_STATUS);
    LOCALE intBool                        EnvSetFactDuplication(void *,EXEC_STATUS,int);
    LOCALE void                           InitializeFactHashTable(void *,EXEC_STATUS);
+   LOCALE void                           DeallocateFactHashTable(void *,EXEC_STATUS);
    LOCALE void                           ShowFactHashTable(void *,EXEC_STATUS);
    LOCALE unsigned long                  HashFact(struct fact *);
 
@@ -31,7 +31,6 @@
 #define _FACTMCH_SOURCE_
 
 #include <stdio.h>
-# include <assert.h>
 
 #define _STDIO_INCLUDED_
 
@@ -51,6 +50,7 @@
 #include "router.h"
 #include "sysdep.h"
 #include "tmpltdef.h"
+#include "fact/fact_scheduler.h"
 
 #include "factmch.h"
 
@@ -69,6 +69,12 @@
                                                          struct multifieldMarker *,
                                                          struct multifieldMarker *,int);
    static void                     PatternNetErrorMessage(void *,EXEC_STATUS,struct factPatternNode *);
+   static void                     SpawnSiblingPatternMatches(void *,EXEC_STATUS,struct fact *,
+                                                              struct factPatternNode *,int,int,
+                                                              struct multifieldMarker *,
+                                                              struct multifieldMarker *);
+   static intBool                  JoinReadsSlots(struct joinNode *,char *,unsigned short);
+   static intBool                  ExpressionReadsSlots(struct expr *,char *,unsigned short);
 
 /*************************************************************************/
 /* FactPatternMatch: Implements the core loop for fact pattern matching. */
@@ -111,8 +117,8 @@ globle void FactPatternMatch(
    /* Rete access functions and general convenience. */
    /*================================================*/
 
-   FactData(theEnv,execStatus)->CurrentPatternFact = theFact;
-   FactData(theEnv,execStatus)->CurrentPatternMarks = markers;
+   LocalFactsData(theEnv,execStatus).CurrentPatternFact = theFact;
+   LocalFactsData(theEnv,execStatus).CurrentPatternMarks = markers;
 
    /*============================================*/
    /* Loop through each node in pattern network. */
@@ -160,14 +166,14 @@ globle void FactPatternMatch(
 
          int skipit = FALSE;
          if (patternPtr->header.endSlot &&
-             ((FactData(theEnv,execStatus)->CurrentPatternMarks == NULL) ?
+             ((LocalFactsData(theEnv,execStatus).CurrentPatternMarks == NULL) ?
               FALSE :
-              (FactData(theEnv,execStatus)->CurrentPatternMarks->where.whichSlotNumber == patternPtr->whichSlot)) &&
-             (FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields
+              (LocalFactsData(theEnv,execStatus).CurrentPatternMarks->where.whichSlotNumber == patternPtr->whichSlot)) &&
+             (LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields
                   [patternPtr->whichSlot].type == MULTIFIELD))
            {
             if ((patternPtr->leaveFields + theSlotField) != (int)
-               ((struct multifield *) FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields
+               ((struct multifield *) LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields
                                       [patternPtr->whichSlot].value)->multifieldLength)
               { skipit = TRUE; }
            }
@@ -193,6 +199,7 @@ globle void FactPatternMatch(
                  { ProcessFactAlphaMatch(theEnv,execStatus,theFact,markers,tempPtr); }
                
                patternPtr = GetFactPatternNodeFromNextLevelOrBackUp(theEnv,execStatus,tempPtr);
+               SpawnSiblingPatternMatches(theEnv,execStatus,theFact,patternPtr,offsetSlot,offset,markers,endMark);
               }
             else
               { patternPtr = GetFactPatternNodeOnThisLevelOrBackUp(theEnv,execStatus,patternPtr); }
@@ -218,6 +225,7 @@ globle void FactPatternMatch(
             /*===================================*/
 
             patternPtr = GetFactPatternNodeFromNextLevelOrBackUp(theEnv,execStatus,patternPtr);
+            SpawnSiblingPatternMatches(theEnv,execStatus,theFact,patternPtr,offsetSlot,offset,markers,endMark);
            }
 
          /*==============================================*/
@@ -290,7 +298,7 @@ static void ProcessMultifieldNode(
    /*========================================*/
 
    theSlotValue = (struct multifield *)
-     FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields[thePattern->whichSlot].value;
+     LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields[thePattern->whichSlot].value;
 
    /*===============================================*/
    /* Save the value of the markers already stored. */
@@ -312,7 +320,7 @@ static void ProcessMultifieldNode(
    if (endMark == NULL)
      {
       markers = newMark;
-      FactData(theEnv,execStatus)->CurrentPatternMarks = markers;
+      LocalFactsData(theEnv,execStatus).CurrentPatternMarks = markers;
      }
    else
      { endMark->next = newMark; }
@@ -371,15 +379,22 @@ static void ProcessMultifieldNode(
          /*=======================================================*/
 
          if (thePattern->header.stopNode)
-           { ProcessFactAlphaMatch(theEnv,execStatus,FactData(theEnv,execStatus)->CurrentPatternFact,FactData(theEnv,execStatus)->CurrentPatternMarks,thePattern); }
+           { ProcessFactAlphaMatch(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,LocalFactsData(theEnv,execStatus).CurrentPatternMarks,thePattern); }
 
          /*=============================================*/
          /* Recursively continue pattern matching based */
          /* on the multifield binding just generated.   */
          /*=============================================*/
 
-         FactPatternMatch(theEnv,execStatus,FactData(theEnv,execStatus)->CurrentPatternFact,
-                          thePattern->nextLevel,0,FactData(theEnv,execStatus)->CurrentPatternMarks,newMark);
+         if (thePattern->nextLevel != NULL)
+           {
+            SpawnSiblingPatternMatches(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,
+                                       thePattern->nextLevel,thePattern->nextLevel->whichSlot,0,
+                                       LocalFactsData(theEnv,execStatus).CurrentPatternMarks,newMark);
+           }
+
+         FactPatternMatch(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,
+                          thePattern->nextLevel,0,LocalFactsData(theEnv,execStatus).CurrentPatternMarks,newMark);
         }
 
       /*================================================*/
@@ -390,7 +405,7 @@ static void ProcessMultifieldNode(
 
       rtn_struct(theEnv,execStatus,multifieldMarker,newMark);
       if (endMark != NULL) endMark->next = NULL;
-      FactData(theEnv,execStatus)->CurrentPatternMarks = oldMark;
+      LocalFactsData(theEnv,execStatus).CurrentPatternMarks = oldMark;
       return;
      }
 
@@ -412,11 +427,16 @@ static void ProcessMultifieldNode(
             EvaluateExpression(theEnv,execStatus,thePattern->networkTest,&theResult);
          
             tempPtr = (struct factPatternNode *) FindHashedPatternNode(theEnv,execStatus,thePattern,theResult.type,theResult.value);
-            if (tempPtr != NULL)
+            if ((tempPtr != NULL) && (tempPtr->nextLevel != NULL))
               {
-               FactPatternMatch(theEnv,execStatus,FactData(theEnv,execStatus)->CurrentPatternFact,
+               SpawnSiblingPatternMatches(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,
+                                          tempPtr->nextLevel,tempPtr->nextLevel->whichSlot,
+                                          offset + repeatCount - 1,
+                                          LocalFactsData(theEnv,execStatus).CurrentPatternMarks,newMark);
+
+               FactPatternMatch(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,
                                 tempPtr->nextLevel,offset + repeatCount - 1,
-                                FactData(theEnv,execStatus)->CurrentPatternMarks,newMark);
+                                LocalFactsData(theEnv,execStatus).CurrentPatternMarks,newMark);
               }
            }
         }
@@ -424,9 +444,17 @@ static void ProcessMultifieldNode(
                TRUE :
                (EvaluatePatternExpression(theEnv,execStatus,thePattern,thePattern->networkTest)))
         {
-         FactPatternMatch(theEnv,execStatus,FactData(theEnv,execStatus)->CurrentPatternFact,
+         if (thePattern->nextLevel != NULL)
+           {
+            SpawnSiblingPatternMatches(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,
+                                       thePattern->nextLevel,thePattern->nextLevel->whichSlot,
+                                       offset + repeatCount - 1,
+                                       LocalFactsData(theEnv,execStatus).CurrentPatternMarks,newMark);
+           }
+
+         FactPatternMatch(theEnv,execStatus,LocalFactsData(theEnv,execStatus).CurrentPatternFact,
                           thePattern->nextLevel,offset + repeatCount - 1,
-                          FactData(theEnv,execStatus)->CurrentPatternMarks,newMark);
+                          LocalFactsData(theEnv,execStatus).CurrentPatternMarks,newMark);
         }
      }
 
@@ -436,9 +464,51 @@ static void ProcessMultifieldNode(
 
     rtn_struct(theEnv,execStatus,multifieldMarker,newMark);
     if (endMark != NULL) endMark->next = NULL;
-    FactData(theEnv,execStatus)->CurrentPatternMarks = oldMark;
+    LocalFactsData(theEnv,execStatus).CurrentPatternMarks = oldMark;
    }
 
+/*************************************************************/
+/* SpawnSiblingPatternMatches: When running in parallel, a   */
+/*   match task does not back up to the side branches of the */
+/*   nodes it descends to. Instead every side branch of the  */
+/*   entry node of a new level is handed to the scheduler as */
+/*   a task of its own with a copy of the current bindings.  */
+/*   The offset only applies to siblings matching the slot   */
+/*   for which the offset was computed.                      */
+/*************************************************************/
+static void SpawnSiblingPatternMatches(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact,
+  struct factPatternNode *firstNode,
+  int offsetSlot,
+  int offset,
+  struct multifieldMarker *markers,
+  struct multifieldMarker *endMark)
+  {
+   struct factPatternNode *theSibling;
+
+   if ((! execStatus->RunningInParallel) || (firstNode == NULL)) return;
+
+   /*==================================================*/
+   /* The children of a selector node are alternative  */
+   /* constants of which only the hashed one is taken. */
+   /*==================================================*/
+
+   if ((firstNode->lastLevel != NULL) &&
+       (firstNode->lastLevel->header.selector))
+     { return; }
+
+   for (theSibling = firstNode->rightNode;
+        theSibling != NULL;
+        theSibling = theSibling->rightNode)
+     {
+      SpawnMatchingTask(theEnv,execStatus,theFact,theSibling,
+                        (theSibling->whichSlot == offsetSlot) ? offset : 0,
+                        markers,endMark);
+     }
+  }
+
 /*===================================================*/
 /* If pattern matching was successful at the current */
 /* node in the tree and it's possible to go deeper   */
@@ -452,17 +522,7 @@ static struct factPatternNode *GetFactPatternNodeFromNextLevelOrBackUp(
 {
   execStatus->EvaluationError = FALSE;
   
-  if (execStatus->RunningInParallel) {
-    assert((execStatus->DepthInReteNetwork == 0)
-           ||
-           (   ( thePattern->nextLevel && !thePattern->rightNode)
-            || (!thePattern->nextLevel &&  thePattern->rightNode))
-           /* We need to spawn the rightNode to a new task/thread. 
-              We do not do backing up to the top in the parallel version */ );
-  }
-  
   if (thePattern->nextLevel != NULL) {
-    execStatus->DepthInReteNetwork++;
     return(thePattern->nextLevel);
   }
   
@@ -484,6 +544,16 @@ static struct factPatternNode *GetFactPatternNodeOnThisLevelOrBackUp(
   {
    execStatus->EvaluationError = FALSE;
 
+   /*=================================================*/
+   /* A parallel match task only covers the sub-tree  */
+   /* below its entry node. The side branches of the  */
+   /* nodes it visited have been spawned as tasks of  */
+   /* their own, so there is nothing left to back up  */
+   /* to.                                             */
+   /*=================================================*/
+
+   if (execStatus->RunningInParallel) return(NULL);
+
    /*================================================*/
    /* Keep backing up toward the root of the pattern */
    /* network until a side branch can be taken.      */
@@ -551,6 +621,19 @@ static void ProcessFactAlphaMatch(
    struct joinNode *listOfJoins;
    unsigned long hashValue;
 
+  /*=================================================*/
+  /* When a fact is modified in place, only patterns */
+  /* depending on one of its changed slots lost      */
+  /* their alpha matches and are matched again.      */
+  /*=================================================*/
+
+  if ((FactData(theEnv,execStatus)->ModifiedFact == theFact) &&
+      (! FactPatternReadsSlots(thePattern,FactData(theEnv,execStatus)->ModifiedSlots,
+                               (unsigned short) theFact->theProposition.multifieldLength)))
+    { return; }
+
+  theFact->whichDeftemplate->statistics.alphaMatches++;
+
   /*============================================*/
   /* Create the hash value for the alpha match. */
   /*============================================*/
@@ -568,11 +651,32 @@ static void ProcessFactAlphaMatch(
   /* Add the pattern to the list of matches for this fact. */
   /*=======================================================*/
 
-  listOfMatches = (struct patternMatch *) theFact->list;
-  theFact->list = (void *) get_struct(theEnv,execStatus,patternMatch);
-  ((struct patternMatch *) theFact->list)->next = listOfMatches;
-  ((struct patternMatch *) theFact->list)->matchingPattern = (struct patternNodeHeader *) thePattern;
-  ((struct patternMatch *) theFact->list)->theMatch = theMatch;
+  if (execStatus->RunningInParallel)
+    {
+     /*===================================================*/
+     /* Several match tasks may reach stop nodes for the  */
+     /* same fact, so the new entry is pushed atomically. */
+     /*===================================================*/
+
+     struct patternMatch *newMatch = get_struct(theEnv,execStatus,patternMatch);
+     newMatch->matchingPattern = (struct patternNodeHeader *) thePattern;
+     newMatch->theMatch = theMatch;
+
+     do
+       {
+        listOfMatches = (struct patternMatch *) theFact->list;
+        newMatch->next = listOfMatches;
+       }
+     while (apr_atomic_casptr((volatile void **) &theFact->list,newMatch,listOfMatches) != listOfMatches);
+    }
+  else
+    {
+     listOfMatches = (struct patternMatch *) theFact->list;
+     theFact->list = (void *) get_struct(theEnv,execStatus,patternMatch);
+     ((struct patternMatch *) theFact->list)->next = listOfMatches;
+     ((struct patternMatch *) theFact->list)->matchingPattern = (struct patternNodeHeader *) thePattern;
+     ((struct patternMatch *) theFact->list)->theMatch = theMatch;
+    }
 
   /*================================================================*/
   /* Send the partial match to the joins connected to this pattern. */
@@ -584,6 +688,167 @@ static void ProcessFactAlphaMatch(
      { NetworkAssert(theEnv,execStatus,theMatch,listOfJoins); }
   }
 
+/****************************************************************/
+/* FactPatternReadsSlots: Determines if the alpha matches of a  */
+/*   fact pattern stop node depend on any slot set in slotMap.  */
+/*   They do if a pattern node leading to the stop node tests   */
+/*   one of the slots or if one of the slots is retrieved by a  */
+/*   join which the alpha matches can reach. Join expressions   */
+/*   are only checked by slot position, so a slot of another    */
+/*   pattern in the same position counts as well.               */
+/****************************************************************/
+globle intBool FactPatternReadsSlots(
+  struct factPatternNode *thePattern,
+  char *slotMap,
+  unsigned short slotCount)
+  {
+   struct factPatternNode *patternPtr;
+   struct joinNode *theJoin;
+
+   if (ExpressionReadsSlots(thePattern->header.rightHash,slotMap,slotCount))
+     { return(TRUE); }
+
+   for (patternPtr = thePattern;
+        patternPtr != NULL;
+        patternPtr = patternPtr->lastLevel)
+     {
+      if ((patternPtr->whichSlot < slotCount) &&
+          TestBitMap(slotMap,patternPtr->whichSlot))
+        { return(TRUE); }
+
+      if (ExpressionReadsSlots(patternPtr->networkTest,slotMap,slotCount))
+        { return(TRUE); }
+     }
+
+   for (theJoin = thePattern->header.entryJoin;
+        theJoin != NULL;
+        theJoin = theJoin->rightMatchNode)
+     {
+      if (JoinReadsSlots(theJoin,slotMap,slotCount))
+        { return(TRUE); }
+     }
+
+   return(FALSE);
+  }
+
+/************************************************************/
+/* JoinReadsSlots: Determines if the expressions of a join  */
+/*   or of any join following it retrieve a slot set in     */
+/*   slotMap.                                               */
+/************************************************************/
+static intBool JoinReadsSlots(
+  struct joinNode *theJoin,
+  char *slotMap,
+  unsigned short slotCount)
+  {
+   struct joinLink *theLink;
+
+   if (ExpressionReadsSlots(theJoin->networkTest,slotMap,slotCount) ||
+       ExpressionReadsSlots(theJoin->secondaryNetworkTest,slotMap,slotCount) ||
+       ExpressionReadsSlots(theJoin->leftHash,slotMap,slotCount) ||
+       ExpressionReadsSlots(theJoin->rightHash,slotMap,slotCount))
+     { return(TRUE); }
+
+   for (theLink = theJoin->nextLinks;
+        theLink != NULL;
+        theLink = theLink->next)
+     {
+      if (JoinReadsSlots(theLink->join,slotMap,slotCount))
+        { return(TRUE); }
+     }
+
+   return(FALSE);
+  }
+
+/*****************************************************************/
+/* ExpressionReadsSlots: Determines if an expression retrieves   */
+/*   or compares a fact slot set in slotMap. Retrieving a fact   */
+/*   address counts as reading every slot.                       */
+/*****************************************************************/
+static intBool ExpressionReadsSlots(
+  struct expr *theExpression,
+  char *slotMap,
+  unsigned short slotCount)
+  {
+   unsigned short slot1, slot2;
+   void *theBitMap;
+
+   for (;
+        theExpression != NULL;
+        theExpression = theExpression->nextArg)
+     {
+      theBitMap = theExpression->value;
+      slot1 = slot2 = slotCount;
+
+      switch (theExpression->type)
+        {
+         case FACT_PN_CMP1:
+           slot1 = ((struct factCompVarsPN1Call *) ValueToBitMap(theBitMap))->field1;
+           slot2 = ((struct factCompVarsPN1Call *) ValueToBitMap(theBitMap))->field2;
+           break;
+
+         case FACT_JN_CMP1:
+           slot1 = ((struct factCompVarsJN1Call *) ValueToBitMap(theBitMap))->slot1;
+           slot2 = ((struct factCompVarsJN1Call *) ValueToBitMap(theBitMap))->slot2;
+           break;
+
+         case FACT_JN_CMP2:
+           slot1 = ((struct factCompVarsJN2Call *) ValueToBitMap(theBitMap))->slot1;
+           slot2 = ((struct factCompVarsJN2Call *) ValueToBitMap(theBitMap))->slot2;
+           break;
+
+         case FACT_SLOT_LENGTH:
+           slot1 = ((struct factCheckLengthPNCall *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_PN_VAR1:
+           if (((struct factGetVarPN1Call *) ValueToBitMap(theBitMap))->factAddress)
+             { return(TRUE); }
+           slot1 = ((struct factGetVarPN1Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_PN_VAR2:
+           slot1 = ((struct factGetVarPN2Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_PN_VAR3:
+           slot1 = ((struct factGetVarPN3Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_JN_VAR1:
+           if (((struct factGetVarJN1Call *) ValueToBitMap(theBitMap))->factAddress)
+             { return(TRUE); }
+           slot1 = ((struct factGetVarJN1Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_JN_VAR2:
+           slot1 = ((struct factGetVarJN2Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_JN_VAR3:
+           slot1 = ((struct factGetVarJN3Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_PN_CONSTANT1:
+           slot1 = ((struct factConstantPN1Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+
+         case FACT_PN_CONSTANT2:
+           slot1 = ((struct factConstantPN2Call *) ValueToBitMap(theBitMap))->whichSlot;
+           break;
+        }
+
+      if (((slot1 < slotCount) && TestBitMap(slotMap,slot1)) ||
+          ((slot2 < slotCount) && TestBitMap(slotMap,slot2)))
+        { return(TRUE); }
+
+      if (ExpressionReadsSlots(theExpression->argList,slotMap,slotCount))
+        { return(TRUE); }
+     }
+
+   return(FALSE);
+  }
+
 /*****************************************************************/
 /* EvaluatePatternExpression: Performs a faster evaluation for   */
 /*   fact pattern network expressions than if EvaluateExpression */
@@ -736,7 +1001,7 @@ static void PatternNetErrorMessage(
    PrintErrorID(theEnv,execStatus,"FACTMCH",1,TRUE);
    EnvPrintRouter(theEnv,execStatus,WERROR,"This error occurred in the fact pattern network\n");
    EnvPrintRouter(theEnv,execStatus,WERROR,"   Currently active fact: ");
-   PrintFact(theEnv,execStatus,WERROR,FactData(theEnv,execStatus)->CurrentPatternFact,FALSE,FALSE);
+   PrintFact(theEnv,execStatus,WERROR,LocalFactsData(theEnv,execStatus).CurrentPatternFact,FALSE,FALSE);
    EnvPrintRouter(theEnv,execStatus,WERROR,"\n");
 
    /*==============================================*/
@@ -744,11 +1009,11 @@ static void PatternNetErrorMessage(
    /* pattern from which the error originated.     */
    /*==============================================*/
 
-   if (FactData(theEnv,execStatus)->CurrentPatternFact->whichDeftemplate->implied)
+   if (LocalFactsData(theEnv,execStatus).CurrentPatternFact->whichDeftemplate->implied)
      { gensprintf(buffer,"   Problem resides in field #%d\n",patternPtr->whichField); }
    else
      {
-      theSlots = FactData(theEnv,execStatus)->CurrentPatternFact->whichDeftemplate->slotList;
+      theSlots = LocalFactsData(theEnv,execStatus).CurrentPatternFact->whichDeftemplate->slotList;
       for (i = 0; i < (int) patternPtr->whichSlot; i++) theSlots = theSlots->next;
       gensprintf(buffer,"   Problem resides in slot %s\n",ValueToString(theSlots->slotName));
      }
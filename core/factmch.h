@@ -48,6 +48,7 @@
                                                struct factPatternNode *,int,
                                                struct multifieldMarker *,
                                                struct multifieldMarker *);
+   LOCALE intBool                        FactPatternReadsSlots(struct factPatternNode *,char *,unsigned short);
    LOCALE void                           MarkFactPatternForIncrementalReset(void *,EXEC_STATUS,struct patternNodeHeader *,int);
    LOCALE void                           FactsIncrementalReset(void *,EXEC_STATUS);
 
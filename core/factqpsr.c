@@ -76,6 +76,12 @@
    static void                    ReplaceSlotReference(void *,EXEC_STATUS,EXPRESSION *,EXPRESSION *,
                                                        struct FunctionDefinition *,int);
    static int                     IsQueryFunction(EXPRESSION *);
+#if DEFINDEX_CONSTRUCT
+   static void                    PlanQueryIndexes(void *,EXEC_STATUS,EXPRESSION *);
+   static EXPRESSION             *PlanQueryTest(void *,EXEC_STATUS,EXPRESSION *,EXPRESSION *);
+   static intBool                 IsCurrentSlotReference(void *,EXEC_STATUS,EXPRESSION *);
+   static intBool                 IsIndexKeyExpression(EXPRESSION *);
+#endif
 
 /* =========================================
    *****************************************
@@ -148,6 +154,9 @@ globle EXPRESSION *FactParseQueryNoAction(
      
    ReplaceFactVariables(theEnv,execStatus,factQuerySetVars,top->argList,TRUE,0);
    ReturnExpression(theEnv,execStatus,factQuerySetVars);
+#if DEFINDEX_CONSTRUCT
+   PlanQueryIndexes(theEnv,execStatus,top);
+#endif
    
    return(top);
   }
@@ -226,6 +235,9 @@ globle EXPRESSION *FactParseQueryAction(
    ReplaceFactVariables(theEnv,execStatus,factQuerySetVars,top->argList,TRUE,0);
    ReplaceFactVariables(theEnv,execStatus,factQuerySetVars,top->argList->nextArg,FALSE,0);
    ReturnExpression(theEnv,execStatus,factQuerySetVars);
+#if DEFINDEX_CONSTRUCT
+   PlanQueryIndexes(theEnv,execStatus,top);
+#endif
    
    return(top);
   }
@@ -737,4 +749,197 @@ static int IsQueryFunction(
    return(FALSE);
   }
 
+#if DEFINDEX_CONSTRUCT
+
+/***********************************************************************
+  NAME         : PlanQueryIndexes
+  DESCRIPTION  : Looks for tests in the query expression which a
+                   defindex can answer and records them so that
+                   the query functions can fetch the candidate
+                   facts of a restriction from a slot index
+                   instead of scanning its templates
+  INPUTS       : The top node of the query function
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : A ((query-fact-plan) ...) call is appended to the
+                   end of the arguments of the query function when
+                   at least one test was found
+  NOTES        : Only the query expression itself or the arguments
+                   of a top level and are considered, since every
+                   one of them must hold for a fact set to satisfy
+                   the query.  A usable test has the form
+
+                   (<op> <fact-var>:<slot> <key>) or
+                   (<op> <key> <fact-var>:<slot>)
+
+                   where <op> is one of eq, =, <, <=, > or >= and
+                   <key> is a constant or a variable.  Each test is
+                   recorded as four arguments of the plan call :
+
+                   <restriction index> <slot-name> <op> <key>
+
+                   The key is recorded with the operator adjusted
+                   so that the slot is always on the left.
+ ***********************************************************************/
+static void PlanQueryIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  EXPRESSION *top)
+  {
+   EXPRESSION *query, *plan = NULL, *bexp, *lastArg;
+
+   query = top->argList;
+   if (query->type != FCALL)
+     { return; }
+
+   if (query->value == (void *) FindFunction(theEnv,execStatus,"and"))
+     {
+      for (bexp = query->argList ; bexp != NULL ; bexp = bexp->nextArg)
+        { plan = PlanQueryTest(theEnv,execStatus,bexp,plan); }
+     }
+   else
+     { plan = PlanQueryTest(theEnv,execStatus,query,plan); }
+
+   if (plan == NULL)
+     { return; }
+
+   for (lastArg = query ; lastArg->nextArg != NULL ; lastArg = lastArg->nextArg)
+     { /* Do Nothing */ }
+   lastArg->nextArg = plan;
+  }
+
+/***********************************************************************
+  NAME         : PlanQueryTest
+  DESCRIPTION  : Adds a test of the query expression to the index
+                   plan of a query function if a defindex can be
+                   used to answer it
+  INPUTS       : 1) The test expression
+                 2) The plan call built so far (NULL if none)
+  RETURNS      : The plan call
+  SIDE EFFECTS : The plan call is created for the first usable test
+  NOTES        : None
+ ***********************************************************************/
+static EXPRESSION *PlanQueryTest(
+  void *theEnv,
+  EXEC_STATUS,
+  EXPRESSION *test,
+  EXPRESSION *plan)
+  {
+   static char *operators[] = { "eq", "=", "<", "<=", ">", ">=" };
+   static char *flipped[] = { "eq", "=", ">", ">=", "<", "<=" };
+   EXPRESSION *slotRef, *key, *keyNext, *group, *lastArg;
+   char *op = NULL;
+   int i;
+
+   if ((test->type != FCALL) || (test->argList == NULL) ||
+       (test->argList->nextArg == NULL) ||
+       (test->argList->nextArg->nextArg != NULL))
+     { return(plan); }
+
+   for (i = 0 ; i < (int) (sizeof(operators) / sizeof(char *)) ; i++)
+     {
+      if (test->value == (void *) FindFunction(theEnv,execStatus,operators[i]))
+        { break; }
+     }
+   if (i == (int) (sizeof(operators) / sizeof(char *)))
+     { return(plan); }
+
+   if (IsCurrentSlotReference(theEnv,execStatus,test->argList) &&
+       IsIndexKeyExpression(test->argList->nextArg))
+     {
+      slotRef = test->argList;
+      key = test->argList->nextArg;
+      op = operators[i];
+     }
+   else if (IsCurrentSlotReference(theEnv,execStatus,test->argList->nextArg) &&
+            IsIndexKeyExpression(test->argList))
+     {
+      slotRef = test->argList->nextArg;
+      key = test->argList;
+      op = flipped[i];
+     }
+   else
+     { return(plan); }
+
+   group = GenConstant(theEnv,execStatus,INTEGER,slotRef->argList->nextArg->value);
+   group->nextArg = GenConstant(theEnv,execStatus,SYMBOL,slotRef->argList->nextArg->nextArg->value);
+   group->nextArg->nextArg = GenConstant(theEnv,execStatus,SYMBOL,EnvAddSymbol(theEnv,execStatus,op));
+   keyNext = key->nextArg;
+   key->nextArg = NULL;
+   group->nextArg->nextArg->nextArg = CopyExpression(theEnv,execStatus,key);
+   key->nextArg = keyNext;
+
+   if (plan == NULL)
+     {
+      plan = GenConstant(theEnv,execStatus,FCALL,(void *) FindFunction(theEnv,execStatus,"(query-fact-plan)"));
+      plan->argList = group;
+     }
+   else
+     {
+      for (lastArg = plan->argList ; lastArg->nextArg != NULL ; lastArg = lastArg->nextArg)
+        { /* Do Nothing */ }
+      lastArg->nextArg = group;
+     }
+
+   return(plan);
+  }
+
+/***************************************************************
+  NAME         : IsCurrentSlotReference
+  DESCRIPTION  : Determines if an expression references a slot
+                   of a fact variable of the query function
+                   being parsed
+  INPUTS       : The expression
+  RETURNS      : TRUE if the expression is of the form
+                   ((query-fact-slot) 0 <index> <slot-name>),
+                   FALSE otherwise
+  SIDE EFFECTS : None
+  NOTES        : None
+ ***************************************************************/
+static intBool IsCurrentSlotReference(
+  void *theEnv,
+  EXEC_STATUS,
+  EXPRESSION *theExp)
+  {
+   if ((theExp->type != FCALL) ||
+       (theExp->value != (void *) FindFunction(theEnv,execStatus,"(query-fact-slot)")))
+     { return(FALSE); }
+
+   if (ValueToLong(theExp->argList->value) != 0)
+     { return(FALSE); }
+
+   return((theExp->argList->nextArg->nextArg->type == SYMBOL) ? TRUE : FALSE);
+  }
+
+/***************************************************************
+  NAME         : IsIndexKeyExpression
+  DESCRIPTION  : Determines if an expression can be used as the
+                   key of an index probe, that is whether it can
+                   be evaluated once before the facts are visited
+  INPUTS       : The expression
+  RETURNS      : TRUE if the expression contains no function
+                   calls, FALSE otherwise
+  SIDE EFFECTS : None
+  NOTES        : Fact variables of enclosing queries are still
+                   unreplaced variables at this point
+ ***************************************************************/
+static intBool IsIndexKeyExpression(
+  EXPRESSION *theExp)
+  {
+   EXPRESSION *argPtr;
+
+   if ((theExp->type == FCALL) || (theExp->type == GCALL) ||
+       (theExp->type == PCALL))
+     { return(FALSE); }
+
+   for (argPtr = theExp->argList ; argPtr != NULL ; argPtr = argPtr->nextArg)
+     {
+      if (IsIndexKeyExpression(argPtr) == FALSE)
+        { return(FALSE); }
+     }
+
+   return(TRUE);
+  }
+
+#endif
+
 #endif
@@ -47,6 +47,8 @@
 #include "router.h"
 #include "utility.h"
 
+#include <string.h>
+
 #define _FACTQURY_SOURCE_
 #include "factqury.h"
 
@@ -61,11 +63,20 @@ static void PopQueryCore(void *,EXEC_STATUS);
 static QUERY_CORE *FindQueryCore(void *,EXEC_STATUS,int);
 static QUERY_TEMPLATE *DetermineQueryTemplates(void *,EXEC_STATUS,EXPRESSION *,char *,unsigned *);
 static QUERY_TEMPLATE *FormChain(void *,EXEC_STATUS,char *,DATA_OBJECT *);
+static QUERY_TEMPLATE *CreateQueryTemplate(void *,EXEC_STATUS,struct deftemplate *);
 static void DeleteQueryTemplates(void *,EXEC_STATUS,QUERY_TEMPLATE *);
+static void ReturnQueryTemplate(void *,EXEC_STATUS,QUERY_TEMPLATE *);
+static void PlanQueryTemplates(void *,EXEC_STATUS,QUERY_TEMPLATE *,EXPRESSION *);
 static int TestForFirstInChain(void *,EXEC_STATUS,QUERY_TEMPLATE *,int);
-static int TestForFirstFactInTemplate(void *,EXEC_STATUS,struct deftemplate *,QUERY_TEMPLATE *,int);
+static int TestForFirstFactInTemplate(void *,EXEC_STATUS,QUERY_TEMPLATE *,QUERY_TEMPLATE *,int);
 static void TestEntireChain(void *,EXEC_STATUS,QUERY_TEMPLATE *,int);
-static void TestEntireTemplate(void *,EXEC_STATUS,struct deftemplate *,QUERY_TEMPLATE *,int);
+static void TestEntireTemplate(void *,EXEC_STATUS,QUERY_TEMPLATE *,QUERY_TEMPLATE *,int);
+#if DEFINDEX_CONSTRUCT
+static intBool IsQueryPlan(EXPRESSION *);
+static struct fact *NextCandidateFact(struct fact **,unsigned long,unsigned long *);
+static long long LastTemplateFactIndex(struct deftemplate *);
+static struct fact *FactsAssertedAfter(struct deftemplate *,long long);
+#endif
 static void AddSolution(void *,EXEC_STATUS);
 static void PopQuerySoln(void *,EXEC_STATUS);
 
@@ -98,6 +109,11 @@ globle void SetupFactQuery(
    EnvDefineFunction2(theEnv,execStatus,"(query-fact-slot)",'u',
                   PTIEF GetQueryFactSlot,"GetQueryFactSlot",NULL);
 
+#if DEFINDEX_CONSTRUCT
+   EnvDefineFunction2(theEnv,execStatus,"(query-fact-plan)",'v',
+                  PTIEF QueryFactPlan,"QueryFactPlan",NULL);
+#endif
+
    EnvDefineFunction2(theEnv,execStatus,"any-factp",'b',PTIEF AnyFacts,"AnyFacts",NULL);
    AddFunctionParser(theEnv,execStatus,"any-factp",FactParseQueryNoAction);
 
@@ -209,6 +225,30 @@ globle void GetQueryFactSlot(
      }
   }
 
+#if DEFINDEX_CONSTRUCT
+
+/***************************************************************************
+  NAME         : QueryFactPlan
+  DESCRIPTION  : Internal function marking the index plan which the
+                   parser attaches to a fact-set query function
+  INPUTS       : None
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : None
+  NOTES        : H/L Syntax : ((query-fact-plan) <test>+)
+                 The call is never evaluated; its arguments are read
+                   by PlanQueryTemplates() when the query is run
+ **************************************************************************/
+globle void QueryFactPlan(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus)
+#endif
+  }
+
+#endif
+
 /* =============================================================================
    =============================================================================
    Following are the instance query functions :
@@ -233,6 +273,15 @@ globle void GetQueryFactSlot(
 
      For any one template, fact are examined in the order they were defined
 
+     If the query expression (or an argument of a top level and) compares
+       a slot of a query variable with a constant or a variable using eq,
+       =, <, <=, > or >=, and a defindex exists for that slot, only the
+       facts found in the index are examined.  They are still examined
+       in the order they were defined, and the key is evaluated only
+       once before the facts are visited.  Facts of the template asserted
+       by the query action after that are examined afterwards, as they
+       would be by a scan of the whole template.
+
      Example :
      (deftemplate a (slot v))
      (deftemplate b (slot v))
@@ -284,6 +333,7 @@ globle intBool AnyFacts(
    FactQueryData(theEnv,execStatus)->QueryCore = get_struct(theEnv,execStatus,query_core);
    FactQueryData(theEnv,execStatus)->QueryCore->solns = (struct fact **) gm2(theEnv,execStatus,(sizeof(struct fact *) * rcnt));
    FactQueryData(theEnv,execStatus)->QueryCore->query = GetFirstArgument();
+   PlanQueryTemplates(theEnv,execStatus,qtemplates,GetFirstArgument()->nextArg);
    TestResult = TestForFirstInChain(theEnv,execStatus,qtemplates,0);
    FactQueryData(theEnv,execStatus)->AbortQuery = FALSE;
    rm(theEnv,execStatus,(void *) FactQueryData(theEnv,execStatus)->QueryCore->solns,(sizeof(struct fact *) * rcnt));
@@ -328,6 +378,7 @@ globle void QueryFindFact(
    FactQueryData(theEnv,execStatus)->QueryCore->solns = (struct fact **)
                       gm2(theEnv,execStatus,(sizeof(struct fact *) * rcnt));
    FactQueryData(theEnv,execStatus)->QueryCore->query = GetFirstArgument();
+   PlanQueryTemplates(theEnv,execStatus,qtemplates,GetFirstArgument()->nextArg);
    if (TestForFirstInChain(theEnv,execStatus,qtemplates,0) == TRUE)
      {
       result->value = (void *) EnvCreateMultifield(theEnv,execStatus,rcnt);
@@ -388,6 +439,7 @@ globle void QueryFindAllFacts(
    FactQueryData(theEnv,execStatus)->QueryCore = get_struct(theEnv,execStatus,query_core);
    FactQueryData(theEnv,execStatus)->QueryCore->solns = (struct fact **) gm2(theEnv,execStatus,(sizeof(struct fact *) * rcnt));
    FactQueryData(theEnv,execStatus)->QueryCore->query = GetFirstArgument();
+   PlanQueryTemplates(theEnv,execStatus,qtemplates,GetFirstArgument()->nextArg);
    FactQueryData(theEnv,execStatus)->QueryCore->action = NULL;
    FactQueryData(theEnv,execStatus)->QueryCore->soln_set = NULL;
    FactQueryData(theEnv,execStatus)->QueryCore->soln_size = rcnt;
@@ -443,6 +495,7 @@ globle void QueryDoForFact(
    FactQueryData(theEnv,execStatus)->QueryCore = get_struct(theEnv,execStatus,query_core);
    FactQueryData(theEnv,execStatus)->QueryCore->solns = (struct fact **) gm2(theEnv,execStatus,(sizeof(struct fact *) * rcnt));
    FactQueryData(theEnv,execStatus)->QueryCore->query = GetFirstArgument();
+   PlanQueryTemplates(theEnv,execStatus,qtemplates,GetFirstArgument()->nextArg->nextArg);
    FactQueryData(theEnv,execStatus)->QueryCore->action = GetFirstArgument()->nextArg;
    if (TestForFirstInChain(theEnv,execStatus,qtemplates,0) == TRUE)
      EvaluateExpression(theEnv,execStatus,FactQueryData(theEnv,execStatus)->QueryCore->action,result);
@@ -485,6 +538,7 @@ globle void QueryDoForAllFacts(
    FactQueryData(theEnv,execStatus)->QueryCore = get_struct(theEnv,execStatus,query_core);
    FactQueryData(theEnv,execStatus)->QueryCore->solns = (struct fact **) gm2(theEnv,execStatus,(sizeof(struct fact *) * rcnt));
    FactQueryData(theEnv,execStatus)->QueryCore->query = GetFirstArgument();
+   PlanQueryTemplates(theEnv,execStatus,qtemplates,GetFirstArgument()->nextArg->nextArg);
    FactQueryData(theEnv,execStatus)->QueryCore->action = GetFirstArgument()->nextArg;
    FactQueryData(theEnv,execStatus)->QueryCore->result = result;
    ValueInstall(theEnv,execStatus,FactQueryData(theEnv,execStatus)->QueryCore->result);
@@ -535,6 +589,7 @@ globle void DelayedQueryDoForAllFacts(
    FactQueryData(theEnv,execStatus)->QueryCore = get_struct(theEnv,execStatus,query_core);
    FactQueryData(theEnv,execStatus)->QueryCore->solns = (struct fact **) gm2(theEnv,execStatus,(sizeof(struct fact *) * rcnt));
    FactQueryData(theEnv,execStatus)->QueryCore->query = GetFirstArgument();
+   PlanQueryTemplates(theEnv,execStatus,qtemplates,GetFirstArgument()->nextArg->nextArg);
    FactQueryData(theEnv,execStatus)->QueryCore->action = NULL;
    FactQueryData(theEnv,execStatus)->QueryCore->soln_set = NULL;
    FactQueryData(theEnv,execStatus)->QueryCore->soln_size = rcnt;
@@ -663,6 +718,8 @@ static QUERY_CORE *FindQueryCore(
                  Assumes classExp is not NULL and that each
                    restriction chain is terminated with
                    the QUERY_DELIMITER_SYMBOL "(QDS)"
+                 The index plan attached by the parser
+                   follows the last restriction
  **********************************************************/
 static QUERY_TEMPLATE *DetermineQueryTemplates(
   void *theEnv,
@@ -678,6 +735,10 @@ static QUERY_TEMPLATE *DetermineQueryTemplates(
    *rcnt = 0;
    while (templateExp != NULL)
      {
+#if DEFINDEX_CONSTRUCT
+      if (IsQueryPlan(templateExp))
+        break;
+#endif
       if (EvaluateExpression(theEnv,execStatus,templateExp,&temp))
         {
          DeleteQueryTemplates(theEnv,execStatus,clist);
@@ -741,15 +802,7 @@ static QUERY_TEMPLATE *FormChain(
    int count;
 
    if (val->type == DEFTEMPLATE_PTR)
-     {
-      IncrementDeftemplateBusyCount(theEnv,execStatus,(void *) val->value);
-      head = get_struct(theEnv,execStatus,query_template);
-      head->templatePtr = (struct deftemplate *) val->value;
-
-      head->chain = NULL;
-      head->nxt = NULL;
-      return(head);
-     }
+     { return(CreateQueryTemplate(theEnv,execStatus,(struct deftemplate *) val->value)); }
    if (val->type == SYMBOL)
      {
       /* ===============================================
@@ -767,13 +820,7 @@ static QUERY_TEMPLATE *FormChain(
          CantFindItemInFunctionErrorMessage(theEnv,execStatus,"deftemplate",DOPToString(val),func);
          return(NULL);
         }
-      IncrementDeftemplateBusyCount(theEnv,execStatus,(void *) templatePtr);
-      head = get_struct(theEnv,execStatus,query_template);
-      head->templatePtr = templatePtr;
-
-      head->chain = NULL;
-      head->nxt = NULL;
-      return(head);
+      return(CreateQueryTemplate(theEnv,execStatus,templatePtr));
      }
    if (val->type == MULTIFIELD)
      {
@@ -801,12 +848,7 @@ static QUERY_TEMPLATE *FormChain(
             DeleteQueryTemplates(theEnv,execStatus,head);
             return(NULL);
            }
-         IncrementDeftemplateBusyCount(theEnv,execStatus,(void *) templatePtr);
-         tmp = get_struct(theEnv,execStatus,query_template);
-         tmp->templatePtr = templatePtr;
-
-         tmp->chain = NULL;
-         tmp->nxt = NULL;
+         tmp = CreateQueryTemplate(theEnv,execStatus,templatePtr);
          if (head == NULL)
            head = tmp;
          else
@@ -818,6 +860,33 @@ static QUERY_TEMPLATE *FormChain(
    return(NULL);
   }
 
+/*************************************************************
+  NAME         : CreateQueryTemplate
+  DESCRIPTION  : Allocates a query chain node for a template
+  INPUTS       : The template
+  RETURNS      : The query chain node
+  SIDE EFFECTS : Busy count incremented for the template
+  NOTES        : None
+ *************************************************************/
+static QUERY_TEMPLATE *CreateQueryTemplate(
+  void *theEnv,
+  EXEC_STATUS,
+  struct deftemplate *templatePtr)
+  {
+   QUERY_TEMPLATE *qtemplate;
+
+   IncrementDeftemplateBusyCount(theEnv,execStatus,(void *) templatePtr);
+   qtemplate = get_struct(theEnv,execStatus,query_template);
+   qtemplate->templatePtr = templatePtr;
+#if DEFINDEX_CONSTRUCT
+   qtemplate->index = NULL;
+   qtemplate->probe = NULL;
+#endif
+   qtemplate->chain = NULL;
+   qtemplate->nxt = NULL;
+   return(qtemplate);
+  }
+
 /******************************************************
   NAME         : DeleteQueryTemplates
   DESCRIPTION  : Deletes a query class-list
@@ -840,16 +909,286 @@ static void DeleteQueryTemplates(
         {
          tmp = qlist->chain;
          qlist->chain = qlist->chain->chain;
-         DecrementDeftemplateBusyCount(theEnv,execStatus,(void *) tmp->templatePtr);
-         rtn_struct(theEnv,execStatus,query_template,tmp);
+         ReturnQueryTemplate(theEnv,execStatus,tmp);
         }
       tmp = qlist;
       qlist = qlist->nxt;
-      DecrementDeftemplateBusyCount(theEnv,execStatus,(void *) tmp->templatePtr);
-      rtn_struct(theEnv,execStatus,query_template,tmp);
+      ReturnQueryTemplate(theEnv,execStatus,tmp);
+     }
+  }
+
+/******************************************************
+  NAME         : ReturnQueryTemplate
+  DESCRIPTION  : Deallocates a query chain node
+  INPUTS       : The query chain node
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : Node and its index probe deallocated
+                 Busy count decremented for the template
+  NOTES        : None
+ ******************************************************/
+static void ReturnQueryTemplate(
+  void *theEnv,
+  EXEC_STATUS,
+  QUERY_TEMPLATE *qtemplate)
+  {
+#if DEFINDEX_CONSTRUCT
+   struct slotIndexProbe *probe = qtemplate->probe;
+
+   if (probe != NULL)
+     {
+      if (probe->kind == SLOT_INDEX_PROBE_EQ)
+        ValueDeinstall(theEnv,execStatus,&probe->key);
+      if (probe->lowerTest != SLOT_INDEX_NO_BOUND)
+        ValueDeinstall(theEnv,execStatus,&probe->lower);
+      if (probe->upperTest != SLOT_INDEX_NO_BOUND)
+        ValueDeinstall(theEnv,execStatus,&probe->upper);
+      rtn_struct(theEnv,execStatus,slotIndexProbe,probe);
+     }
+#endif
+   DecrementDeftemplateBusyCount(theEnv,execStatus,(void *) qtemplate->templatePtr);
+   rtn_struct(theEnv,execStatus,query_template,qtemplate);
+  }
+
+/***************************************************************
+  NAME         : PlanQueryTemplates
+  DESCRIPTION  : Chooses the defindex probe used to find the
+                   candidate facts of each query template
+  INPUTS       : 1) The query list
+                 2) The parse template expression chain, which
+                    may be followed by the index plan
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : Index probes allocated for query templates
+                   and their keys evaluated and installed
+  NOTES        : Must be called after the query core of the
+                   query has been pushed, since a key may refer
+                   to the facts of an enclosing query.
+                 An eq test on any defindex is preferred.
+                   Otherwise the bounds given by =, <, <=, >
+                   and >= tests on the slot of an ordered
+                   defindex are combined into a range.  A
+                   probe the index can not answer exactly
+                   (e.g. a range over non-numeric values) is
+                   dropped and the template is scanned.
+ ***************************************************************/
+static void PlanQueryTemplates(
+  void *theEnv,
+  EXEC_STATUS,
+  QUERY_TEMPLATE *qlist,
+  EXPRESSION *templateExp)
+  {
+#if DEFINDEX_CONSTRUCT
+   EXPRESSION *plan, *group, *keyExp;
+   QUERY_TEMPLATE *qptr;
+   struct defindex *theDefindex, *eqDefindex, *rangeDefindex;
+   struct slotIndexProbe probe;
+   DATA_OBJECT key;
+   long long rindex;
+   char *op;
+
+   for (plan = templateExp ; plan != NULL ; plan = plan->nextArg)
+     {
+      if (IsQueryPlan(plan))
+        break;
+     }
+   if (plan == NULL)
+     return;
+
+   for (rindex = 0 ; qlist != NULL ; qlist = qlist->nxt , rindex++)
+     {
+      for (qptr = qlist ; qptr != NULL ; qptr = qptr->chain)
+        {
+         if ((qptr->templatePtr->indexList == NULL) ||
+             (qptr->templatePtr->factList == NULL))
+           continue;
+
+         eqDefindex = rangeDefindex = NULL;
+         probe.kind = SLOT_INDEX_PROBE_RANGE;
+         probe.lowerTest = probe.upperTest = SLOT_INDEX_NO_BOUND;
+
+         /* =============================================
+            Each test is recorded as four arguments :
+            restriction index, slot name, operator, key
+            ============================================= */
+
+         for (group = plan->argList ;
+              (group != NULL) && (eqDefindex == NULL) ;
+              group = group->nextArg->nextArg->nextArg->nextArg)
+           {
+            if (ValueToLong(group->value) != rindex)
+              continue;
+            theDefindex = FindDefindex(qptr->templatePtr,(SYMBOL_HN *) group->nextArg->value);
+            if (theDefindex == NULL)
+              continue;
+            op = ValueToString(group->nextArg->nextArg->value);
+            keyExp = group->nextArg->nextArg->nextArg;
+
+            if (strcmp(op,"eq") != 0)
+              {
+               if ((theDefindex->theIndex->ordered == FALSE) ||
+                   ((rangeDefindex != NULL) && (rangeDefindex != theDefindex)))
+                 continue;
+              }
+
+            if (EvaluateExpression(theEnv,execStatus,keyExp,&key))
+              return;
+
+            if (strcmp(op,"eq") == 0)
+              {
+               if (key.type == MULTIFIELD)
+                 continue;
+               probe.kind = SLOT_INDEX_PROBE_EQ;
+               probe.key = key;
+               eqDefindex = theDefindex;
+               continue;
+              }
+
+            if ((key.type != INTEGER) && (key.type != FLOAT))
+              continue;
+
+            if (((op[0] == '>') || (op[0] == '=')) &&
+                (probe.lowerTest == SLOT_INDEX_NO_BOUND))
+              {
+               probe.lower = key;
+               probe.lowerTest = (strcmp(op,">") == 0) ? SLOT_INDEX_EXCLUSIVE : SLOT_INDEX_INCLUSIVE;
+               rangeDefindex = theDefindex;
+              }
+            if (((op[0] == '<') || (op[0] == '=')) &&
+                (probe.upperTest == SLOT_INDEX_NO_BOUND))
+              {
+               probe.upper = key;
+               probe.upperTest = (strcmp(op,"<") == 0) ? SLOT_INDEX_EXCLUSIVE : SLOT_INDEX_INCLUSIVE;
+               rangeDefindex = theDefindex;
+              }
+           }
+
+         if (eqDefindex != NULL)
+           {
+            probe.lowerTest = probe.upperTest = SLOT_INDEX_NO_BOUND;
+            theDefindex = eqDefindex;
+           }
+         else
+           theDefindex = rangeDefindex;
+
+         if ((theDefindex == NULL) ||
+             (SlotIndexProbeApplies(theDefindex->theIndex,&probe) == FALSE))
+           continue;
+
+         qptr->index = theDefindex;
+         qptr->probe = get_struct(theEnv,execStatus,slotIndexProbe);
+         *qptr->probe = probe;
+         if (probe.kind == SLOT_INDEX_PROBE_EQ)
+           ValueInstall(theEnv,execStatus,&qptr->probe->key);
+         if (probe.lowerTest != SLOT_INDEX_NO_BOUND)
+           ValueInstall(theEnv,execStatus,&qptr->probe->lower);
+         if (probe.upperTest != SLOT_INDEX_NO_BOUND)
+           ValueInstall(theEnv,execStatus,&qptr->probe->upper);
+        }
+     }
+#else
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus,qlist,templateExp)
+#endif
+#endif
+  }
+
+#if DEFINDEX_CONSTRUCT
+
+/***************************************************
+  NAME         : IsQueryPlan
+  DESCRIPTION  : Determines if an expression is the
+                   index plan of a query function
+  INPUTS       : The expression
+  RETURNS      : TRUE if it is, FALSE otherwise
+  SIDE EFFECTS : None
+  NOTES        : None
+ ***************************************************/
+static intBool IsQueryPlan(
+  EXPRESSION *theExp)
+  {
+   if (theExp->type != FCALL)
+     return(FALSE);
+   return((ExpressionFunctionPointer(theExp) == PTIF QueryFactPlan) ? TRUE : FALSE);
+  }
+
+/***************************************************
+  NAME         : NextCandidateFact
+  DESCRIPTION  : Finds the next candidate fact of
+                   an index probe which has not
+                   been retracted
+  INPUTS       : 1) The candidate facts
+                 2) The number of candidates
+                 3) Caller's buffer holding the
+                    position of the next candidate
+  RETURNS      : The fact, or NULL if none remain
+  SIDE EFFECTS : Position advanced
+  NOTES        : None
+ ***************************************************/
+static struct fact *NextCandidateFact(
+  struct fact **candidates,
+  unsigned long count,
+  unsigned long *next)
+  {
+   struct fact *theFact;
+
+   while (*next < count)
+     {
+      theFact = candidates[(*next)++];
+      if (theFact->garbage == 0)
+        return(theFact);
      }
+   return(NULL);
+  }
+
+/***************************************************
+  NAME         : LastTemplateFactIndex
+  DESCRIPTION  : Finds the fact-index of the most
+                   recently asserted fact of a
+                   template
+  INPUTS       : The template
+  RETURNS      : The fact-index, or -1 if the
+                   template has no facts
+  SIDE EFFECTS : None
+  NOTES        : None
+ ***************************************************/
+static long long LastTemplateFactIndex(
+  struct deftemplate *theDeftemplate)
+  {
+   if (theDeftemplate->lastFact == NULL)
+     return(-1LL);
+   return(theDeftemplate->lastFact->factIndex);
+  }
+
+/***************************************************
+  NAME         : FactsAssertedAfter
+  DESCRIPTION  : Finds the first fact of a template
+                   asserted after a given fact-index
+  INPUTS       : 1) The template
+                 2) The fact-index
+  RETURNS      : The fact, or NULL if none exists
+  SIDE EFFECTS : None
+  NOTES        : The facts of a template are kept
+                   in the order they were asserted,
+                   so they are searched backwards
+                   from the most recent one
+ ***************************************************/
+static struct fact *FactsAssertedAfter(
+  struct deftemplate *theDeftemplate,
+  long long factIndex)
+  {
+   struct fact *theFact, *firstFact = NULL;
+
+   for (theFact = theDeftemplate->lastFact ;
+        (theFact != NULL) ? (theFact->factIndex > factIndex) : FALSE ;
+        theFact = theFact->previousTemplateFact)
+     firstFact = theFact;
+
+   while ((firstFact != NULL) ? (firstFact->garbage == 1) : FALSE)
+     firstFact = firstFact->nextTemplateFact;
+   return(firstFact);
   }
 
+#endif
+
 /************************************************************
   NAME         : TestForFirstInChain
   DESCRIPTION  : Processes all templates in a restriction chain
@@ -875,7 +1214,7 @@ static int TestForFirstInChain(
      {
       FactQueryData(theEnv,execStatus)->AbortQuery = FALSE;
 
-      if (TestForFirstFactInTemplate(theEnv,execStatus,qptr->templatePtr,qchain,indx))
+      if (TestForFirstFactInTemplate(theEnv,execStatus,qptr,qchain,indx))
         { return(TRUE); }
         
       if ((execStatus->HaltExecution == TRUE) || (FactQueryData(theEnv,execStatus)->AbortQuery == TRUE))
@@ -887,10 +1226,9 @@ static int TestForFirstInChain(
 /*****************************************************************
   NAME         : TestForFirstFactInTemplate
   DESCRIPTION  : Processes all facts in a template
-  INPUTS       : 1) Visitation traversal id
-                 2) The template
-                 3) The current template restriction chain
-                 4) The index of the current restriction
+  INPUTS       : 1) The query chain node of the template
+                 2) The current template restriction chain
+                 3) The index of the current restriction
   RETURNS      : TRUE if query succeeds, FALSE otherwise
   SIDE EFFECTS : Fact variable values set
   NOTES        : None
@@ -898,14 +1236,28 @@ static int TestForFirstInChain(
 static int TestForFirstFactInTemplate(
   void *theEnv,
   EXEC_STATUS,
-  struct deftemplate *templatePtr,
+  QUERY_TEMPLATE *qtemplate,
   QUERY_TEMPLATE *qchain,
   int indx)
   {
    struct fact *theFact;
    DATA_OBJECT temp;
+#if DEFINDEX_CONSTRUCT
+   struct fact **candidates = NULL;
+   unsigned long candidateCount = 0, nextCandidate = 0;
+   intBool probing = FALSE;
+   long long lastIndex = -1LL;
 
-   theFact = templatePtr->factList;
+   if (qtemplate->probe != NULL)
+     {
+      lastIndex = LastTemplateFactIndex(qtemplate->templatePtr);
+      candidates = DefindexCandidates(theEnv,execStatus,qtemplate->index,qtemplate->probe,&candidateCount);
+      theFact = NextCandidateFact(candidates,candidateCount,&nextCandidate);
+      probing = TRUE;
+     }
+   else
+#endif
+   theFact = qtemplate->templatePtr->factList;
    while (theFact != NULL)
      {
       FactQueryData(theEnv,execStatus)->QueryCore->solns[indx] = theFact;
@@ -935,11 +1287,28 @@ static int TestForFirstFactInTemplate(
              (temp.value != EnvFalseSymbol(theEnv,execStatus)))
            break;
         }
+#if DEFINDEX_CONSTRUCT
+      if (probing)
+        {
+         theFact = NextCandidateFact(candidates,candidateCount,&nextCandidate);
+         if (theFact == NULL)
+           {
+            probing = FALSE;
+            theFact = FactsAssertedAfter(qtemplate->templatePtr,lastIndex);
+           }
+         continue;
+        }
+#endif
       theFact = theFact->nextTemplateFact;
       while ((theFact != NULL) ? (theFact->garbage == 1) : FALSE)
         theFact = theFact->nextTemplateFact;
      }
 
+#if DEFINDEX_CONSTRUCT
+   if (candidates != NULL)
+     ReturnDefindexCandidates(theEnv,execStatus,candidates,candidateCount);
+#endif
+
    if (theFact != NULL)
      return(((execStatus->HaltExecution == TRUE) || (FactQueryData(theEnv,execStatus)->AbortQuery == TRUE))
              ? FALSE : TRUE);
@@ -973,7 +1342,7 @@ static void TestEntireChain(
      {
       FactQueryData(theEnv,execStatus)->AbortQuery = FALSE;
 
-      TestEntireTemplate(theEnv,execStatus,qptr->templatePtr,qchain,indx);
+      TestEntireTemplate(theEnv,execStatus,qptr,qchain,indx);
 
       if ((execStatus->HaltExecution == TRUE) || (FactQueryData(theEnv,execStatus)->AbortQuery == TRUE))
         return;
@@ -983,11 +1352,9 @@ static void TestEntireChain(
 /*****************************************************************
   NAME         : TestEntireTemplate
   DESCRIPTION  : Processes all facts in a template
-  INPUTS       : 1) The module for which templates tested must be
-                    in scope
-                 3) The template
-                 4) The current template restriction chain
-                 5) The index of the current restriction
+  INPUTS       : 1) The query chain node of the template
+                 2) The current template restriction chain
+                 3) The index of the current restriction
   RETURNS      : Nothing useful
   SIDE EFFECTS : Instance variable values set
                  Solution sets stored in global list
@@ -996,14 +1363,28 @@ static void TestEntireChain(
 static void TestEntireTemplate(
   void *theEnv,
   EXEC_STATUS,
-  struct deftemplate *templatePtr,
+  QUERY_TEMPLATE *qtemplate,
   QUERY_TEMPLATE *qchain,
   int indx)
   {
    struct fact *theFact;
    DATA_OBJECT temp;
+#if DEFINDEX_CONSTRUCT
+   struct fact **candidates = NULL;
+   unsigned long candidateCount = 0, nextCandidate = 0;
+   intBool probing = FALSE;
+   long long lastIndex = -1LL;
 
-   theFact = templatePtr->factList;
+   if (qtemplate->probe != NULL)
+     {
+      lastIndex = LastTemplateFactIndex(qtemplate->templatePtr);
+      candidates = DefindexCandidates(theEnv,execStatus,qtemplate->index,qtemplate->probe,&candidateCount);
+      theFact = NextCandidateFact(candidates,candidateCount,&nextCandidate);
+      probing = TRUE;
+     }
+   else
+#endif
+   theFact = qtemplate->templatePtr->factList;
    while (theFact != NULL)
      {
       FactQueryData(theEnv,execStatus)->QueryCore->solns[indx] = theFact;
@@ -1051,10 +1432,27 @@ static void TestEntireTemplate(
            }
         }
         
+#if DEFINDEX_CONSTRUCT
+      if (probing)
+        {
+         theFact = NextCandidateFact(candidates,candidateCount,&nextCandidate);
+         if (theFact == NULL)
+           {
+            probing = FALSE;
+            theFact = FactsAssertedAfter(qtemplate->templatePtr,lastIndex);
+           }
+         continue;
+        }
+#endif
       theFact = theFact->nextTemplateFact;
       while ((theFact != NULL) ? (theFact->garbage == 1) : FALSE)
         theFact = theFact->nextTemplateFact;
      }
+
+#if DEFINDEX_CONSTRUCT
+   if (candidates != NULL)
+     ReturnDefindexCandidates(theEnv,execStatus,candidates,candidateCount);
+#endif
   }
 
 /***************************************************************************
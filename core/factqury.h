@@ -33,10 +33,19 @@
 #ifndef _H_factmngr
 #include "fact/fact_manager.h"
 #endif
+#if DEFINDEX_CONSTRUCT
+#ifndef _H_tmpltidx
+#include "tmpltidx.h"
+#endif
+#endif
 
 typedef struct query_template
   {
    struct deftemplate *templatePtr;
+#if DEFINDEX_CONSTRUCT
+   struct defindex *index;
+   struct slotIndexProbe *probe;
+#endif
    struct query_template *chain, *nxt;
   } QUERY_TEMPLATE;
 
@@ -90,6 +99,9 @@ struct factQueryData
 LOCALE void SetupFactQuery(void *,EXEC_STATUS);
 LOCALE void GetQueryFact(void *,EXEC_STATUS,DATA_OBJECT *);
 LOCALE void GetQueryFactSlot(void *,EXEC_STATUS,DATA_OBJECT *);
+#if DEFINDEX_CONSTRUCT
+LOCALE void QueryFactPlan(void *,EXEC_STATUS);
+#endif
 LOCALE intBool AnyFacts(void *,EXEC_STATUS);
 LOCALE void QueryFindFact(void *,EXEC_STATUS,DATA_OBJECT *);
 LOCALE void QueryFindAllFacts(void *,EXEC_STATUS,DATA_OBJECT *);
@@ -73,8 +73,8 @@ globle intBool FactPNGetVar1(
    /* Get the pointer to the fact from the partial match. */
    /*=====================================================*/
 
-   factPtr = FactData(theEnv,execStatus)->CurrentPatternFact;
-   marks = FactData(theEnv,execStatus)->CurrentPatternMarks;
+   factPtr = LocalFactsData(theEnv,execStatus).CurrentPatternFact;
+   marks = LocalFactsData(theEnv,execStatus).CurrentPatternMarks;
 
    /*==========================================================*/
    /* Determine if we want to retrieve the fact address of the */
@@ -181,7 +181,7 @@ globle intBool FactPNGetVar2(
    /* Get the pointer to the fact. */
    /*==============================*/
 
-   factPtr = FactData(theEnv,execStatus)->CurrentPatternFact;
+   factPtr = LocalFactsData(theEnv,execStatus).CurrentPatternFact;
 
    /*============================================*/
    /* Extract the value from the specified slot. */
@@ -221,7 +221,7 @@ globle intBool FactPNGetVar3(
    /* Get the pointer to the fact. */
    /*==============================*/
 
-   factPtr = FactData(theEnv,execStatus)->CurrentPatternFact;
+   factPtr = LocalFactsData(theEnv,execStatus).CurrentPatternFact;
 
    /*============================================================*/
    /* Get the multifield value from which the data is retrieved. */
@@ -289,7 +289,7 @@ globle intBool FactPNConstant1(
    /* Extract the value from the specified slot. */
    /*============================================*/
 
-   fieldPtr = &FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields[hack->whichSlot];
+   fieldPtr = &LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields[hack->whichSlot];
 
    /*====================================*/
    /* Compare the value to the constant. */
@@ -338,7 +338,7 @@ globle intBool FactPNConstant2(
    /* multifield slots.                                        */
    /*==========================================================*/
 
-   fieldPtr = &FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields[hack->whichSlot];
+   fieldPtr = &LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields[hack->whichSlot];
 
    if (fieldPtr->type == MULTIFIELD)
      {
@@ -406,7 +406,7 @@ globle intBool FactJNGetVar1(
       factPtr = (struct fact *) get_nth_pm_match(LocalEngineData(theEnv,execStatus).LHSBinds,hack->whichPattern)->matchingItem;
       marks = get_nth_pm_match(LocalEngineData(theEnv,execStatus).LHSBinds,hack->whichPattern)->markers;
      }
-   else if ((((unsigned short) (EngineData(theEnv,execStatus)->GlobalJoin->depth - 1))) == hack->whichPattern)
+   else if ((((unsigned short) (LocalEngineData(theEnv,execStatus).GlobalJoin->depth - 1))) == hack->whichPattern)
      {
       factPtr = (struct fact *) get_nth_pm_match(LocalEngineData(theEnv,execStatus).RHSBinds,0)->matchingItem;
       marks = get_nth_pm_match(LocalEngineData(theEnv,execStatus).RHSBinds,0)->markers;
@@ -547,7 +547,7 @@ globle intBool FactJNGetVar2(
        struct alphaMatch   *match          = get_nth_pm_match(globalLHSBinds,hack->whichPattern);
        factPtr                             = (struct fact *) match->matchingItem; 
      }
-   else if (((unsigned short) (EngineData(theEnv,execStatus)->GlobalJoin->depth - 1)) == hack->whichPattern)
+   else if (((unsigned short) (LocalEngineData(theEnv,execStatus).GlobalJoin->depth - 1)) == hack->whichPattern)
 	   { 
        struct partialMatch *globalRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
        struct alphaMatch   *match          = get_nth_pm_match(globalRHSBinds,0);
@@ -604,7 +604,7 @@ globle intBool FactJNGetVar3(
      { factPtr = (struct fact *) get_nth_pm_match(LocalEngineData(theEnv,execStatus).RHSBinds,hack->whichPattern)->matchingItem; }
    else if (LocalEngineData(theEnv,execStatus).RHSBinds == NULL)
      { factPtr = (struct fact *) get_nth_pm_match(LocalEngineData(theEnv,execStatus).LHSBinds,hack->whichPattern)->matchingItem; }
-   else if (((unsigned short) (EngineData(theEnv,execStatus)->GlobalJoin->depth - 1)) == hack->whichPattern)
+   else if (((unsigned short) (LocalEngineData(theEnv,execStatus).GlobalJoin->depth - 1)) == hack->whichPattern)
      { factPtr = (struct fact *) get_nth_pm_match(LocalEngineData(theEnv,execStatus).RHSBinds,0)->matchingItem; }
    else
      { factPtr = (struct fact *) get_nth_pm_match(LocalEngineData(theEnv,execStatus).LHSBinds,hack->whichPattern)->matchingItem; }
@@ -664,7 +664,7 @@ globle intBool FactSlotLength(
 
    hack = (struct factCheckLengthPNCall *) ValueToBitMap(theValue);
 
-   for (tempMark = FactData(theEnv,execStatus)->CurrentPatternMarks;
+   for (tempMark = LocalFactsData(theEnv,execStatus).CurrentPatternMarks;
         tempMark != NULL;
         tempMark = tempMark->next)
      {
@@ -672,7 +672,7 @@ globle intBool FactSlotLength(
       extraOffset += ((tempMark->endPosition - tempMark->startPosition) + 1);
      }
 
-   segmentPtr = (struct multifield *) FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields[hack->whichSlot].value;
+   segmentPtr = (struct multifield *) LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields[hack->whichSlot].value;
 
    if (segmentPtr->multifieldLength < (hack->minLength + extraOffset))
      { return(FALSE); }
@@ -849,8 +849,8 @@ globle int FactPNCompVars1(
    /*========================================*/
 
    hack = (struct factCompVarsPN1Call *) ValueToBitMap(theValue);
-   fieldPtr1 = &FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields[hack->field1];
-   fieldPtr2 = &FactData(theEnv,execStatus)->CurrentPatternFact->theProposition.theFields[hack->field2];
+   fieldPtr1 = &LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields[hack->field1];
+   fieldPtr2 = &LocalFactsData(theEnv,execStatus).CurrentPatternFact->theProposition.theFields[hack->field2];
 
    /*=====================*/
    /* Compare the values. */
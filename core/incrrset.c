@@ -316,7 +316,7 @@ static void PrimeJoinFromLeftMemory(
            {
             if (listOfHashNodes->alphaMemory != NULL)
               { 
-               AddBlockedLink(notParent,listOfHashNodes->alphaMemory);
+               AddBlockedLink(theEnv,execStatus,notParent,listOfHashNodes->alphaMemory);
                return; 
               }
            }
@@ -366,6 +366,8 @@ static void PrimeJoinFromLeftMemory(
    /* beta memory to the new join.               */
    /*============================================*/
 
+   CompleteBetaMemoryResize(theEnv,execStatus,tempLink->join);
+
    for (b = 0; b < theMemory->size; b++)
      {
       for (theList = theMemory->beta[b];
@@ -458,6 +460,8 @@ static void PrimeJoinFromRightMemory(
    /* beta memory to the new join.               */
    /*============================================*/
 
+   CompleteBetaMemoryResize(theEnv,execStatus,tempLink->join);
+
    for (b = 0; b < theMemory->size; b++)
      {
       for (theList = theMemory->beta[b];
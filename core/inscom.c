@@ -132,7 +132,7 @@ globle void SetupInstances(
    INSTANCE_TYPE dummyInstance = { { NULL, NULL, 0, 0L }, 
                                    NULL, NULL, 0, 1, 0, 0, 0, 
                                    NULL,  0, 0, 0, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL };
+                                   NULL, NULL, NULL, NULL, NULL, NULL };
 
    AllocateEnvironmentData(theEnv,execStatus,INSTANCE_DATA,sizeof(struct instanceData),DeallocateInstanceData);
    
@@ -49,6 +49,10 @@ struct instanceData
    INSTANCE_TYPE *CurrentInstance;
    INSTANCE_TYPE *InstanceListBottom;
    intBool ObjectModDupMsgValid;
+#if DEFCLASS_SLOT_INDEXES
+   long long NextSlotIndexOrder;
+   unsigned long SlotIndexChanges;
+#endif
   };
 
 #define InstanceData(theEnv,execStatus) ((struct instanceData *) GetEnvironmentData(theEnv,execStatus,INSTANCE_DATA))
@@ -73,6 +73,10 @@
 #include "objrtmch.h"
 #endif
 
+#if DEFCLASS_SLOT_INDEXES
+#include "insindx.h"
+#endif
+
 #define _INSFUN_SOURCE_
 #include "insfun.h"
 
@@ -638,6 +642,10 @@ globle int DirectPutSlotValue(
       AtomInstall(theEnv,execStatus,(int) sp->type,sp->value);
       SetpType(setVal,sp->type);
       SetpValue(setVal,sp->value);
+#if DEFCLASS_SLOT_INDEXES
+      if (sp->desc->indexed && (ins->indexEntries != NULL))
+        UpdateInstanceSlotIndex(theEnv,execStatus,ins,sp);
+#endif
      }
    else
      {
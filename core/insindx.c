@@ -0,0 +1,285 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*             INSTANCE SLOT INDEX MODULE              */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Maintains the slot indexes of the instances of   */
+/*   a class. A slot declared with (index hash) or           */
+/*   (index ordered) is indexed in every class which has it  */
+/*   as a local single field slot, including subclasses      */
+/*   inheriting it. The indexes of a class are built when    */
+/*   its first instance is created and released when its     */
+/*   last instance is deleted. An instance is entered when   */
+/*   it is put on the instance list of its class, moved      */
+/*   whenever one of its indexed slots is put, and removed   */
+/*   when it is taken off the instance list. Every change is */
+/*   counted, so that an instance query can tell when the    */
+/*   candidates it took from an index are out of date.       */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _INSINDX_SOURCE_
+
+#include "setup.h"
+
+#if DEFCLASS_SLOT_INDEXES
+
+#include "envrnmnt.h"
+#include "inscom.h"
+#include "memalloc.h"
+
+#include "insindx.h"
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static intBool                 BuildClassSlotIndexes(void *,EXEC_STATUS,DEFCLASS *);
+   static void                    ReturnClassSlotIndexes(void *,EXEC_STATUS,DEFCLASS *);
+
+/*************************************************************/
+/* AddInstanceToSlotIndexes: Enters an instance which has    */
+/*   just been put on the instance list of its class into    */
+/*   every slot index of the class. The entries are chained  */
+/*   to the instance so that they can be found again when a  */
+/*   slot is put or the instance is deleted.                 */
+/*************************************************************/
+globle void AddInstanceToSlotIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  INSTANCE_TYPE *theInstance)
+  {
+   struct classSlotIndex *theClassIndex;
+   struct slotIndexEntry *theEntry;
+   INSTANCE_SLOT *theSlot;
+   long long order;
+
+   if (theInstance->cls->slotIndexList == NULL)
+     {
+      if (BuildClassSlotIndexes(theEnv,execStatus,theInstance->cls) == FALSE)
+        { return; }
+     }
+
+   order = InstanceData(theEnv,execStatus)->NextSlotIndexOrder++;
+   InstanceData(theEnv,execStatus)->SlotIndexChanges++;
+
+   for (theClassIndex = theInstance->cls->slotIndexList;
+        theClassIndex != NULL;
+        theClassIndex = theClassIndex->next)
+     {
+      theSlot = theInstance->slotAddresses[theClassIndex->whichSlot];
+      theEntry = AddSlotIndexEntry(theEnv,execStatus,theClassIndex->theIndex,(void *) theInstance,
+                                   order,theSlot->type,theSlot->value);
+      theEntry->nextInOwner = theInstance->indexEntries;
+      theInstance->indexEntries = theEntry;
+     }
+  }
+
+/***************************************************************/
+/* UpdateInstanceSlotIndex: Moves an instance to the key of    */
+/*   the new value of one of its slots. The instance keeps its */
+/*   place in the order of the index. Nothing is done if the   */
+/*   slot is not indexed in the class of the instance.         */
+/***************************************************************/
+globle void UpdateInstanceSlotIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  INSTANCE_TYPE *theInstance,
+  INSTANCE_SLOT *theSlot)
+  {
+   struct classSlotIndex *theClassIndex;
+   struct slotIndexEntry *theEntry, *lastEntry = NULL, *newEntry;
+
+   theClassIndex = FindClassSlotIndex(theInstance->cls,theSlot->desc->slotName->name);
+   if (theClassIndex == NULL)
+     { return; }
+
+   for (theEntry = theInstance->indexEntries;
+        theEntry != NULL;
+        theEntry = theEntry->nextInOwner)
+     {
+      if (theEntry->theIndex == theClassIndex->theIndex) break;
+      lastEntry = theEntry;
+     }
+
+   if (theEntry == NULL)
+     { return; }
+
+   if ((theEntry->theKey->type == theSlot->type) &&
+       (theEntry->theKey->value == theSlot->value))
+     { return; }
+
+   InstanceData(theEnv,execStatus)->SlotIndexChanges++;
+
+   newEntry = AddSlotIndexEntry(theEnv,execStatus,theClassIndex->theIndex,(void *) theInstance,
+                                theEntry->order,theSlot->type,theSlot->value);
+   newEntry->nextInOwner = theEntry->nextInOwner;
+
+   if (lastEntry == NULL)
+     { theInstance->indexEntries = newEntry; }
+   else
+     { lastEntry->nextInOwner = newEntry; }
+
+   RemoveSlotIndexEntry(theEnv,execStatus,theEntry);
+  }
+
+/*************************************************************/
+/* RemoveInstanceFromSlotIndexes: Removes an instance which  */
+/*   has just been taken off the instance list of its class  */
+/*   from the slot indexes of the class. The indexes are     */
+/*   released once the class has no instances left.          */
+/*************************************************************/
+globle void RemoveInstanceFromSlotIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  INSTANCE_TYPE *theInstance)
+  {
+   struct slotIndexEntry *theEntry, *nextEntry;
+
+   if (theInstance->indexEntries != NULL)
+     { InstanceData(theEnv,execStatus)->SlotIndexChanges++; }
+
+   for (theEntry = theInstance->indexEntries; theEntry != NULL; theEntry = nextEntry)
+     {
+      nextEntry = theEntry->nextInOwner;
+      RemoveSlotIndexEntry(theEnv,execStatus,theEntry);
+     }
+
+   theInstance->indexEntries = NULL;
+
+   if (theInstance->cls->instanceList == NULL)
+     { ReturnClassSlotIndexes(theEnv,execStatus,theInstance->cls); }
+  }
+
+/****************************************************/
+/* FindClassSlotIndex: Returns the index of a slot  */
+/*   of a class, or NULL if it is not indexed.      */
+/****************************************************/
+globle struct classSlotIndex *FindClassSlotIndex(
+  DEFCLASS *theDefclass,
+  SYMBOL_HN *slotName)
+  {
+   struct classSlotIndex *theClassIndex;
+
+   for (theClassIndex = theDefclass->slotIndexList;
+        theClassIndex != NULL;
+        theClassIndex = theClassIndex->next)
+     {
+      if (theClassIndex->slotName == slotName)
+        { return(theClassIndex); }
+     }
+
+   return(NULL);
+  }
+
+/****************************************************************/
+/* ClassSlotIndexCandidates: Returns the instances selected by  */
+/*   a probe of a slot index in the order they were created,    */
+/*   and sets count to their number. Each instance is made busy */
+/*   so that it stays valid while a query action deletes        */
+/*   instances; it must still be checked for being garbage      */
+/*   before it is used.                                         */
+/****************************************************************/
+globle INSTANCE_TYPE **ClassSlotIndexCandidates(
+  void *theEnv,
+  EXEC_STATUS,
+  struct classSlotIndex *theClassIndex,
+  struct slotIndexProbe *theProbe,
+  unsigned long *count)
+  {
+   INSTANCE_TYPE **candidates;
+   unsigned long i;
+
+   candidates = (INSTANCE_TYPE **)
+                SlotIndexCandidates(theEnv,execStatus,theClassIndex->theIndex,theProbe,count);
+
+   for (i = 0; i < *count; i++)
+     { candidates[i]->busy++; }
+
+   return(candidates);
+  }
+
+/**********************************************************/
+/* ReturnClassSlotIndexCandidates: Releases the instances */
+/*   returned by ClassSlotIndexCandidates.                */
+/**********************************************************/
+globle void ReturnClassSlotIndexCandidates(
+  void *theEnv,
+  EXEC_STATUS,
+  INSTANCE_TYPE **candidates,
+  unsigned long count)
+  {
+   unsigned long i;
+
+   for (i = 0; i < count; i++)
+     { candidates[i]->busy--; }
+
+   ReturnSlotIndexCandidates(theEnv,execStatus,(void **) candidates,count);
+  }
+
+/**************************************************************/
+/* BuildClassSlotIndexes: Creates an index for every indexed  */
+/*   local single field slot of a class. Returns FALSE if the */
+/*   class has no such slot.                                  */
+/**************************************************************/
+static intBool BuildClassSlotIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  DEFCLASS *theDefclass)
+  {
+   struct classSlotIndex *theClassIndex;
+   SLOT_DESC *theDesc;
+   short i;
+
+   for (i = (short) (theDefclass->instanceSlotCount - 1) ; i >= 0 ; i--)
+     {
+      theDesc = theDefclass->instanceTemplate[i];
+      if ((theDesc->indexed == 0) || theDesc->shared || theDesc->multiple)
+        continue;
+
+      theClassIndex = get_struct(theEnv,execStatus,classSlotIndex);
+      theClassIndex->slotName = theDesc->slotName->name;
+      theClassIndex->whichSlot = (unsigned short) i;
+      theClassIndex->theIndex = CreateSlotIndex(theEnv,execStatus,(int) theDesc->orderedIndex);
+      theClassIndex->next = theDefclass->slotIndexList;
+      theDefclass->slotIndexList = theClassIndex;
+     }
+
+   return((theDefclass->slotIndexList != NULL) ? TRUE : FALSE);
+  }
+
+/***********************************************************/
+/* ReturnClassSlotIndexes: Releases the slot indexes of a  */
+/*   class. The instances of the class must already have   */
+/*   been removed from them.                               */
+/***********************************************************/
+static void ReturnClassSlotIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  DEFCLASS *theDefclass)
+  {
+   struct classSlotIndex *theClassIndex, *nextClassIndex;
+
+   for (theClassIndex = theDefclass->slotIndexList;
+        theClassIndex != NULL;
+        theClassIndex = nextClassIndex)
+     {
+      nextClassIndex = theClassIndex->next;
+      ReturnSlotIndex(theEnv,execStatus,theClassIndex->theIndex);
+      rtn_struct(theEnv,execStatus,classSlotIndex,theClassIndex);
+     }
+
+   theDefclass->slotIndexList = NULL;
+  }
+
+#endif /* DEFCLASS_SLOT_INDEXES */
@@ -0,0 +1,62 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*          INSTANCE SLOT INDEX HEADER FILE            */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Maintains the slot indexes of the instances of   */
+/*   a class for the slots declared with the index facet.    */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_insindx
+
+#define _H_insindx
+
+struct classSlotIndex;
+
+#ifndef _H_object
+#include "object.h"
+#endif
+#ifndef _H_slotindx
+#include "slotindx.h"
+#endif
+
+# include "execution_status.h"
+
+struct classSlotIndex
+  {
+   SYMBOL_HN *slotName;
+   unsigned short whichSlot;
+   struct slotIndex *theIndex;
+   struct classSlotIndex *next;
+  };
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _INSINDX_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+   LOCALE void                           AddInstanceToSlotIndexes(void *,EXEC_STATUS,INSTANCE_TYPE *);
+   LOCALE void                           UpdateInstanceSlotIndex(void *,EXEC_STATUS,INSTANCE_TYPE *,INSTANCE_SLOT *);
+   LOCALE void                           RemoveInstanceFromSlotIndexes(void *,EXEC_STATUS,INSTANCE_TYPE *);
+   LOCALE struct classSlotIndex         *FindClassSlotIndex(DEFCLASS *,SYMBOL_HN *);
+   LOCALE INSTANCE_TYPE                **ClassSlotIndexCandidates(void *,EXEC_STATUS,struct classSlotIndex *,
+                                                                 struct slotIndexProbe *,unsigned long *);
+   LOCALE void                           ReturnClassSlotIndexCandidates(void *,EXEC_STATUS,INSTANCE_TYPE **,unsigned long);
+
+#endif
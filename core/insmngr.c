@@ -64,6 +64,10 @@
 #include "inscom.h"
 #include "watch.h"
 
+#if DEFCLASS_SLOT_INDEXES
+#include "insindx.h"
+#endif
+
 /* =========================================
    *****************************************
                    CONSTANTS
@@ -389,6 +393,9 @@ globle INSTANCE_TYPE *BuildInstance(
      InstanceData(theEnv,execStatus)->CurrentInstance->cls->instanceListBottom->nxtClass = InstanceData(theEnv,execStatus)->CurrentInstance;
    InstanceData(theEnv,execStatus)->CurrentInstance->prvClass = InstanceData(theEnv,execStatus)->CurrentInstance->cls->instanceListBottom;
    InstanceData(theEnv,execStatus)->CurrentInstance->cls->instanceListBottom = InstanceData(theEnv,execStatus)->CurrentInstance;
+#if DEFCLASS_SLOT_INDEXES
+   AddInstanceToSlotIndexes(theEnv,execStatus,InstanceData(theEnv,execStatus)->CurrentInstance);
+#endif
 
    if (InstanceData(theEnv,execStatus)->InstanceList == NULL)
      InstanceData(theEnv,execStatus)->InstanceList = InstanceData(theEnv,execStatus)->CurrentInstance;
@@ -523,6 +530,9 @@ globle intBool QuashInstance(
      ins->nxtClass->prvClass = ins->prvClass;
    else
      ins->cls->instanceListBottom = ins->prvClass;
+#if DEFCLASS_SLOT_INDEXES
+   RemoveInstanceFromSlotIndexes(theEnv,execStatus,ins);
+#endif
 
    if (ins->prvList != NULL)
      ins->prvList->nxtList = ins->nxtList;
@@ -676,6 +686,7 @@ static INSTANCE_TYPE *NewInstance(
    instance->nxtHash = NULL;
    instance->prvList = NULL;
    instance->nxtList = NULL;
+   instance->indexEntries = NULL;
    return(instance);
   }
 
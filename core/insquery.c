@@ -34,6 +34,8 @@
 
 #if INSTANCE_SET_QUERIES
 
+#include <string.h>
+
 #include "argacces.h"
 #include "classcom.h"
 #include "classfun.h"
@@ -44,6 +46,10 @@
 #include "insmngr.h"
 #include "insqypsr.h"
 #include "prcdrfun.h"
+#if DEFCLASS_SLOT_INDEXES
+#include "inscom.h"
+#include "insindx.h"
+#endif
 #include "router.h"
 #include "utility.h"
 
@@ -61,7 +67,20 @@ static void PopQueryCore(void *,EXEC_STATUS);
 static QUERY_CORE *FindQueryCore(void *,EXEC_STATUS,int);
 static QUERY_CLASS *DetermineQueryClasses(void *,EXEC_STATUS,EXPRESSION *,char *,unsigned *);
 static QUERY_CLASS *FormChain(void *,EXEC_STATUS,char *,DATA_OBJECT *);
+static QUERY_CLASS *CreateQueryClass(void *,EXEC_STATUS,DEFCLASS *,struct defmodule *);
 static void DeleteQueryClasses(void *,EXEC_STATUS,QUERY_CLASS *);
+static void ReturnQueryClass(void *,EXEC_STATUS,QUERY_CLASS *);
+#if DEFCLASS_SLOT_INDEXES
+static intBool IsQueryPlan(EXPRESSION *);
+static void AttachQueryIndexTests(void *,EXEC_STATUS,QUERY_CLASS *,EXPRESSION *);
+static struct classSlotIndex *ChooseClassSlotIndex(void *,EXEC_STATUS,DEFCLASS *,QUERY_INDEX_TEST *,
+                                                   struct slotIndexProbe *);
+static intBool EvaluateQueryIndexKey(void *,EXEC_STATUS,QUERY_INDEX_TEST *);
+static INSTANCE_TYPE *NextCandidateInstance(INSTANCE_TYPE **,unsigned long,unsigned long *);
+static INSTANCE_TYPE *NextIndexedInstance(void *,EXEC_STATUS,DEFCLASS *,QUERY_CLASS *,struct slotIndexProbe *,
+                                          INSTANCE_TYPE ***,unsigned long *,unsigned long *,
+                                          unsigned long *,long long);
+#endif
 static int TestForFirstInChain(void *,EXEC_STATUS,QUERY_CLASS *,int);
 static int TestForFirstInstanceInClass(void *,EXEC_STATUS,struct defmodule *,int,DEFCLASS *,QUERY_CLASS *,int);
 static void TestEntireChain(void *,EXEC_STATUS,QUERY_CLASS *,int);
@@ -94,6 +113,11 @@ globle void SetupQuery(
    EnvDefineFunction2(theEnv,execStatus,"(query-instance-slot)",'u',
                   PTIEF GetQueryInstanceSlot,"GetQueryInstanceSlot",NULL);
 
+#if DEFCLASS_SLOT_INDEXES
+   EnvDefineFunction2(theEnv,execStatus,"(query-instance-plan)",'v',
+                  PTIEF QueryInstancePlan,"QueryInstancePlan",NULL);
+#endif
+
    EnvDefineFunction2(theEnv,execStatus,"any-instancep",'b',PTIEF AnyInstances,"AnyInstances",NULL);
    AddFunctionParser(theEnv,execStatus,"any-instancep",ParseQueryNoAction);
 
@@ -185,6 +209,30 @@ globle void GetQueryInstanceSlot(
      }
   }
 
+#if DEFCLASS_SLOT_INDEXES
+
+/***************************************************************************
+  NAME         : QueryInstancePlan
+  DESCRIPTION  : Internal function marking the index plan which the
+                   parser attaches to an instance-set query function
+  INPUTS       : None
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : None
+  NOTES        : H/L Syntax : ((query-instance-plan) <test>+)
+                 The call is never evaluated; its arguments are read
+                   by AttachQueryIndexTests() when the query is run
+ **************************************************************************/
+globle void QueryInstancePlan(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus)
+#endif
+  }
+
+#endif
+
 /* =============================================================================
    =============================================================================
    Following are the instance query functions :
@@ -659,6 +707,13 @@ static QUERY_CLASS *DetermineQueryClasses(
    *rcnt = 0;
    while (classExp != NULL)
      {
+#if DEFCLASS_SLOT_INDEXES
+      if (IsQueryPlan(classExp))
+        {
+         AttachQueryIndexTests(theEnv,execStatus,clist,classExp);
+         break;
+        }
+#endif
       if (EvaluateExpression(theEnv,execStatus,classExp,&temp))
         {
          DeleteQueryClasses(theEnv,execStatus,clist);
@@ -724,16 +779,7 @@ static QUERY_CLASS *FormChain(
    currentModule = ((struct defmodule *) EnvGetCurrentModule(theEnv,execStatus));
    if (val->type == DEFCLASS_PTR)
      {
-      IncrementDefclassBusyCount(theEnv,execStatus,(void *) val->value);
-      head = get_struct(theEnv,execStatus,query_class);
-      head->cls = (DEFCLASS *) val->value;
-      if (DefclassInScope(theEnv,execStatus,head->cls,currentModule))
-        head->theModule = currentModule;
-      else
-        head->theModule = head->cls->header.whichModule->theModule;
-      head->chain = NULL;
-      head->nxt = NULL;
-      return(head);
+      return(CreateQueryClass(theEnv,execStatus,(DEFCLASS *) val->value,currentModule));
      }
    if (val->type == SYMBOL)
      {
@@ -749,16 +795,7 @@ static QUERY_CLASS *FormChain(
          ClassExistError(theEnv,execStatus,func,DOPToString(val));
          return(NULL);
         }
-      IncrementDefclassBusyCount(theEnv,execStatus,(void *) cls);
-      head = get_struct(theEnv,execStatus,query_class);
-      head->cls = cls;
-      if (DefclassInScope(theEnv,execStatus,head->cls,currentModule))
-        head->theModule = currentModule;
-      else
-        head->theModule = head->cls->header.whichModule->theModule;
-      head->chain = NULL;
-      head->nxt = NULL;
-      return(head);
+      return(CreateQueryClass(theEnv,execStatus,cls,currentModule));
      }
    if (val->type == MULTIFIELD)
      {
@@ -782,15 +819,7 @@ static QUERY_CLASS *FormChain(
             DeleteQueryClasses(theEnv,execStatus,head);
             return(NULL);
            }
-         IncrementDefclassBusyCount(theEnv,execStatus,(void *) cls);
-         tmp = get_struct(theEnv,execStatus,query_class);
-         tmp->cls = cls;
-         if (DefclassInScope(theEnv,execStatus,tmp->cls,currentModule))
-           tmp->theModule = currentModule;
-         else
-           tmp->theModule = tmp->cls->header.whichModule->theModule;
-         tmp->chain = NULL;
-         tmp->nxt = NULL;
+         tmp = CreateQueryClass(theEnv,execStatus,cls,currentModule);
          if (head == NULL)
            head = tmp;
          else
@@ -802,6 +831,40 @@ static QUERY_CLASS *FormChain(
    return(NULL);
   }
 
+/*************************************************************
+  NAME         : CreateQueryClass
+  DESCRIPTION  : Allocates a node of a query class-list
+  INPUTS       : 1) The class
+                 2) The current module
+  RETURNS      : The new node
+  SIDE EFFECTS : Busy count incremented for the class
+  NOTES        : The classes are searched from the current
+                   module if the class is in scope there,
+                   otherwise from the module of the class
+ *************************************************************/
+static QUERY_CLASS *CreateQueryClass(
+  void *theEnv,
+  EXEC_STATUS,
+  DEFCLASS *cls,
+  struct defmodule *currentModule)
+  {
+   QUERY_CLASS *qclass;
+
+   IncrementDefclassBusyCount(theEnv,execStatus,(void *) cls);
+   qclass = get_struct(theEnv,execStatus,query_class);
+   qclass->cls = cls;
+   if (DefclassInScope(theEnv,execStatus,qclass->cls,currentModule))
+     qclass->theModule = currentModule;
+   else
+     qclass->theModule = qclass->cls->header.whichModule->theModule;
+#if DEFCLASS_SLOT_INDEXES
+   qclass->tests = NULL;
+#endif
+   qclass->chain = NULL;
+   qclass->nxt = NULL;
+   return(qclass);
+  }
+
 /******************************************************
   NAME         : DeleteQueryClasses
   DESCRIPTION  : Deletes a query class-list
@@ -824,16 +887,45 @@ static void DeleteQueryClasses(
         {
          tmp = qlist->chain;
          qlist->chain = qlist->chain->chain;
-         DecrementDefclassBusyCount(theEnv,execStatus,(void *) tmp->cls);
-         rtn_struct(theEnv,execStatus,query_class,tmp);
+         ReturnQueryClass(theEnv,execStatus,tmp);
         }
       tmp = qlist;
       qlist = qlist->nxt;
-      DecrementDefclassBusyCount(theEnv,execStatus,(void *) tmp->cls);
-      rtn_struct(theEnv,execStatus,query_class,tmp);
+      ReturnQueryClass(theEnv,execStatus,tmp);
      }
   }
 
+/******************************************************
+  NAME         : ReturnQueryClass
+  DESCRIPTION  : Deallocates a node of a query
+                   class-list
+  INPUTS       : The node
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : Node and its index tests deallocated
+                 Busy count decremented for the class
+  NOTES        : None
+ ******************************************************/
+static void ReturnQueryClass(
+  void *theEnv,
+  EXEC_STATUS,
+  QUERY_CLASS *qclass)
+  {
+#if DEFCLASS_SLOT_INDEXES
+   QUERY_INDEX_TEST *test;
+
+   while (qclass->tests != NULL)
+     {
+      test = qclass->tests;
+      qclass->tests = test->nxt;
+      if (test->keyState == 1)
+        ValueDeinstall(theEnv,execStatus,&test->key);
+      rtn_struct(theEnv,execStatus,query_index_test,test);
+     }
+#endif
+   DecrementDefclassBusyCount(theEnv,execStatus,(void *) qclass->cls);
+   rtn_struct(theEnv,execStatus,query_class,qclass);
+  }
+
 /************************************************************
   NAME         : TestForFirstInChain
   DESCRIPTION  : Processes all classes in a restriction chain
@@ -899,15 +991,36 @@ static int TestForFirstInstanceInClass(
    long i;
    INSTANCE_TYPE *ins;
    DATA_OBJECT temp;
+#if DEFCLASS_SLOT_INDEXES
+   struct classSlotIndex *theClassIndex;
+   struct slotIndexProbe probe;
+   INSTANCE_TYPE **candidates = NULL;
+   unsigned long candidateCount = 0, nextCandidate = 0, changes = 0;
+   long long lastOrder = 0LL;
+#endif
 
    if (TestTraversalID(cls->traversalRecord,id))
      return(FALSE);
    SetTraversalID(cls->traversalRecord,id);
    if (DefclassInScope(theEnv,execStatus,cls,theModule) == FALSE)
      return(FALSE);
+#if DEFCLASS_SLOT_INDEXES
+   theClassIndex = ChooseClassSlotIndex(theEnv,execStatus,cls,qchain->tests,&probe);
+   if (theClassIndex != NULL)
+     {
+      changes = InstanceData(theEnv,execStatus)->SlotIndexChanges;
+      candidates = ClassSlotIndexCandidates(theEnv,execStatus,theClassIndex,&probe,&candidateCount);
+      ins = NextCandidateInstance(candidates,candidateCount,&nextCandidate);
+     }
+   else
+#endif
    ins = cls->instanceList;
    while (ins != NULL)
      {
+#if DEFCLASS_SLOT_INDEXES
+      if (theClassIndex != NULL)
+        lastOrder = ins->indexEntries->order;
+#endif
       InstanceQueryData(theEnv,execStatus)->QueryCore->solns[indx] = ins;
       if (qchain->nxt != NULL)
         {
@@ -935,10 +1048,22 @@ static int TestForFirstInstanceInClass(
              (temp.value != EnvFalseSymbol(theEnv,execStatus)))
            break;
         }
+#if DEFCLASS_SLOT_INDEXES
+      if (theClassIndex != NULL)
+        {
+         ins = NextIndexedInstance(theEnv,execStatus,cls,qchain,&probe,&candidates,
+                                   &candidateCount,&nextCandidate,&changes,lastOrder);
+         continue;
+        }
+#endif
       ins = ins->nxtClass;
       while ((ins != NULL) ? (ins->garbage == 1) : FALSE)
         ins = ins->nxtClass;
      }
+#if DEFCLASS_SLOT_INDEXES
+   if (candidates != NULL)
+     ReturnClassSlotIndexCandidates(theEnv,execStatus,candidates,candidateCount);
+#endif
    if (ins != NULL)
      return(((execStatus->HaltExecution == TRUE) || (InstanceQueryData(theEnv,execStatus)->AbortQuery == TRUE))
              ? FALSE : TRUE);
@@ -1015,15 +1140,36 @@ static void TestEntireClass(
    long i;
    INSTANCE_TYPE *ins;
    DATA_OBJECT temp;
+#if DEFCLASS_SLOT_INDEXES
+   struct classSlotIndex *theClassIndex;
+   struct slotIndexProbe probe;
+   INSTANCE_TYPE **candidates = NULL;
+   unsigned long candidateCount = 0, nextCandidate = 0, changes = 0;
+   long long lastOrder = 0LL;
+#endif
 
    if (TestTraversalID(cls->traversalRecord,id))
      return;
    SetTraversalID(cls->traversalRecord,id);
    if (DefclassInScope(theEnv,execStatus,cls,theModule) == FALSE)
      return;
+#if DEFCLASS_SLOT_INDEXES
+   theClassIndex = ChooseClassSlotIndex(theEnv,execStatus,cls,qchain->tests,&probe);
+   if (theClassIndex != NULL)
+     {
+      changes = InstanceData(theEnv,execStatus)->SlotIndexChanges;
+      candidates = ClassSlotIndexCandidates(theEnv,execStatus,theClassIndex,&probe,&candidateCount);
+      ins = NextCandidateInstance(candidates,candidateCount,&nextCandidate);
+     }
+   else
+#endif
    ins = cls->instanceList;
    while (ins != NULL)
      {
+#if DEFCLASS_SLOT_INDEXES
+      if (theClassIndex != NULL)
+        lastOrder = ins->indexEntries->order;
+#endif
       InstanceQueryData(theEnv,execStatus)->QueryCore->solns[indx] = ins;
       if (qchain->nxt != NULL)
         {
@@ -1069,10 +1215,22 @@ static void TestEntireClass(
            }
         }
         
+#if DEFCLASS_SLOT_INDEXES
+      if (theClassIndex != NULL)
+        {
+         ins = NextIndexedInstance(theEnv,execStatus,cls,qchain,&probe,&candidates,
+                                   &candidateCount,&nextCandidate,&changes,lastOrder);
+         continue;
+        }
+#endif
       ins = ins->nxtClass;
       while ((ins != NULL) ? (ins->garbage == 1) : FALSE)
         ins = ins->nxtClass;
      }
+#if DEFCLASS_SLOT_INDEXES
+   if (candidates != NULL)
+     ReturnClassSlotIndexCandidates(theEnv,execStatus,candidates,candidateCount);
+#endif
    if (ins != NULL)
      return;
    for (i = 0 ; i < cls->directSubclasses.classCount ; i++)
@@ -1083,6 +1241,295 @@ static void TestEntireClass(
      }
   }
 
+#if DEFCLASS_SLOT_INDEXES
+
+/***************************************************
+  NAME         : IsQueryPlan
+  DESCRIPTION  : Determines if an expression is the
+                   index plan of a query function
+  INPUTS       : The expression
+  RETURNS      : TRUE if it is, FALSE otherwise
+  SIDE EFFECTS : None
+  NOTES        : None
+ ***************************************************/
+static intBool IsQueryPlan(
+  EXPRESSION *theExp)
+  {
+   if (theExp->type != FCALL)
+     return(FALSE);
+   return((ExpressionFunctionPointer(theExp) == PTIF QueryInstancePlan) ? TRUE : FALSE);
+  }
+
+/***************************************************************
+  NAME         : AttachQueryIndexTests
+  DESCRIPTION  : Gives each restriction of a query list the
+                   tests of the index plan which apply to it
+  INPUTS       : 1) The query list
+                 2) The index plan
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : Index tests allocated for the first class of
+                   each restriction chain
+  NOTES        : Each test is recorded as four arguments :
+                   restriction index, slot name, operator, key.
+                 The keys are not evaluated until a class
+                   with an index on the slot is visited, since
+                   they may refer to the instances of an
+                   enclosing query.
+ ***************************************************************/
+static void AttachQueryIndexTests(
+  void *theEnv,
+  EXEC_STATUS,
+  QUERY_CLASS *qlist,
+  EXPRESSION *plan)
+  {
+   EXPRESSION *group;
+   QUERY_INDEX_TEST *test, *lastTest;
+   long long rindex;
+
+   for (rindex = 0 ; qlist != NULL ; qlist = qlist->nxt , rindex++)
+     {
+      lastTest = NULL;
+      for (group = plan->argList ;
+           group != NULL ;
+           group = group->nextArg->nextArg->nextArg->nextArg)
+        {
+         if (ValueToLong(group->value) != rindex)
+           continue;
+         test = get_struct(theEnv,execStatus,query_index_test);
+         test->slotName = (SYMBOL_HN *) group->nextArg->value;
+         test->op = ValueToString(group->nextArg->nextArg->value);
+         test->keyExp = group->nextArg->nextArg->nextArg;
+         test->keyState = 0;
+         test->nxt = NULL;
+         if (lastTest == NULL)
+           qlist->tests = test;
+         else
+           lastTest->nxt = test;
+         lastTest = test;
+        }
+     }
+  }
+
+/***************************************************************
+  NAME         : ChooseClassSlotIndex
+  DESCRIPTION  : Chooses the slot index used to find the
+                   candidate instances of a class
+  INPUTS       : 1) The class
+                 2) The index tests of the restriction
+                 3) Caller's buffer for the probe
+  RETURNS      : The slot index, or NULL if the instances
+                   of the class must be scanned
+  SIDE EFFECTS : Keys of the tests evaluated and installed
+                   the first time they are needed
+  NOTES        : An eq test on any index is preferred.
+                   Otherwise the bounds given by =, <, <=, >
+                   and >= tests on the slot of an ordered
+                   index are combined into a range.  A probe
+                   the index can not answer exactly (e.g. a
+                   range over non-numeric values) is dropped
+                   and the class is scanned.
+ ***************************************************************/
+static struct classSlotIndex *ChooseClassSlotIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  DEFCLASS *cls,
+  QUERY_INDEX_TEST *tests,
+  struct slotIndexProbe *probe)
+  {
+   QUERY_INDEX_TEST *test;
+   struct classSlotIndex *theClassIndex, *eqIndex = NULL, *rangeIndex = NULL;
+   char *op;
+
+   if ((tests == NULL) || (cls->slotIndexList == NULL) ||
+       (cls->instanceList == NULL))
+     return(NULL);
+
+   probe->kind = SLOT_INDEX_PROBE_RANGE;
+   probe->lowerTest = probe->upperTest = SLOT_INDEX_NO_BOUND;
+
+   for (test = tests ; (test != NULL) && (eqIndex == NULL) ; test = test->nxt)
+     {
+      theClassIndex = FindClassSlotIndex(cls,test->slotName);
+      if (theClassIndex == NULL)
+        continue;
+      op = test->op;
+
+      if (strcmp(op,"eq") != 0)
+        {
+         if ((theClassIndex->theIndex->ordered == FALSE) ||
+             ((rangeIndex != NULL) && (rangeIndex != theClassIndex)))
+           continue;
+        }
+
+      if (EvaluateQueryIndexKey(theEnv,execStatus,test) == FALSE)
+        continue;
+
+      if (strcmp(op,"eq") == 0)
+        {
+         if (test->key.type == MULTIFIELD)
+           continue;
+         probe->kind = SLOT_INDEX_PROBE_EQ;
+         probe->key = test->key;
+         eqIndex = theClassIndex;
+         continue;
+        }
+
+      if ((test->key.type != INTEGER) && (test->key.type != FLOAT))
+        continue;
+
+      if (((op[0] == '>') || (op[0] == '=')) &&
+          (probe->lowerTest == SLOT_INDEX_NO_BOUND))
+        {
+         probe->lower = test->key;
+         probe->lowerTest = (strcmp(op,">") == 0) ? SLOT_INDEX_EXCLUSIVE : SLOT_INDEX_INCLUSIVE;
+         rangeIndex = theClassIndex;
+        }
+      if (((op[0] == '<') || (op[0] == '=')) &&
+          (probe->upperTest == SLOT_INDEX_NO_BOUND))
+        {
+         probe->upper = test->key;
+         probe->upperTest = (strcmp(op,"<") == 0) ? SLOT_INDEX_EXCLUSIVE : SLOT_INDEX_INCLUSIVE;
+         rangeIndex = theClassIndex;
+        }
+     }
+
+   if (eqIndex != NULL)
+     {
+      probe->lowerTest = probe->upperTest = SLOT_INDEX_NO_BOUND;
+      theClassIndex = eqIndex;
+     }
+   else
+     theClassIndex = rangeIndex;
+
+   if ((theClassIndex == NULL) ||
+       (SlotIndexProbeApplies(theClassIndex->theIndex,probe) == FALSE))
+     return(NULL);
+
+   return(theClassIndex);
+  }
+
+/***************************************************
+  NAME         : EvaluateQueryIndexKey
+  DESCRIPTION  : Evaluates the key of an index test
+                   the first time it is needed
+  INPUTS       : The index test
+  RETURNS      : TRUE if the key can be used,
+                   FALSE otherwise
+  SIDE EFFECTS : Key evaluated and installed
+  NOTES        : A key which could not be evaluated
+                   is not tried again
+ ***************************************************/
+static intBool EvaluateQueryIndexKey(
+  void *theEnv,
+  EXEC_STATUS,
+  QUERY_INDEX_TEST *test)
+  {
+   if (test->keyState == 0)
+     {
+      if (EvaluateExpression(theEnv,execStatus,test->keyExp,&test->key))
+        test->keyState = -1;
+      else
+        {
+         ValueInstall(theEnv,execStatus,&test->key);
+         test->keyState = 1;
+        }
+     }
+   return((test->keyState == 1) ? TRUE : FALSE);
+  }
+
+/***************************************************
+  NAME         : NextCandidateInstance
+  DESCRIPTION  : Finds the next candidate instance
+                   of an index probe which has not
+                   been deleted
+  INPUTS       : 1) The candidate instances
+                 2) The number of candidates
+                 3) Caller's buffer holding the
+                    position of the next candidate
+  RETURNS      : The instance, or NULL if none remain
+  SIDE EFFECTS : Position advanced
+  NOTES        : None
+ ***************************************************/
+static INSTANCE_TYPE *NextCandidateInstance(
+  INSTANCE_TYPE **candidates,
+  unsigned long count,
+  unsigned long *next)
+  {
+   INSTANCE_TYPE *ins;
+
+   while (*next < count)
+     {
+      ins = candidates[(*next)++];
+      if (ins->garbage == 0)
+        return(ins);
+     }
+   return(NULL);
+  }
+
+/***************************************************
+  NAME         : NextIndexedInstance
+  DESCRIPTION  : Finds the next instance of a class
+                   to examine after an instance
+                   selected by an index probe
+  INPUTS       : 1) The class
+                 2) The current class restriction chain
+                 3) The probe of the index
+                 4) Caller's buffer holding the
+                    candidate instances
+                 5) Caller's buffer holding the
+                    number of candidates
+                 6) Caller's buffer holding the
+                    position of the next candidate
+                 7) Caller's buffer holding the slot
+                    index change count at the time
+                    the candidates were taken
+                 8) The index order of the instance
+                    last examined
+  RETURNS      : The instance, or NULL if none remain
+  SIDE EFFECTS : Candidates taken again if the slot
+                   indexes changed, position advanced
+  NOTES        : A query action may create, change or
+                   delete instances.  The candidates
+                   are then taken again and the search
+                   resumes after the last instance
+                   examined, so that the instances
+                   seen are the ones a scan of the
+                   class would find matching
+ ***************************************************/
+static INSTANCE_TYPE *NextIndexedInstance(
+  void *theEnv,
+  EXEC_STATUS,
+  DEFCLASS *cls,
+  QUERY_CLASS *qchain,
+  struct slotIndexProbe *probe,
+  INSTANCE_TYPE ***candidates,
+  unsigned long *count,
+  unsigned long *next,
+  unsigned long *changes,
+  long long lastOrder)
+  {
+   struct classSlotIndex *theClassIndex;
+
+   if (*changes != InstanceData(theEnv,execStatus)->SlotIndexChanges)
+     {
+      ReturnClassSlotIndexCandidates(theEnv,execStatus,*candidates,*count);
+      *candidates = NULL;
+      *count = 0;
+      *next = 0;
+      *changes = InstanceData(theEnv,execStatus)->SlotIndexChanges;
+      theClassIndex = ChooseClassSlotIndex(theEnv,execStatus,cls,qchain->tests,probe);
+      if (theClassIndex != NULL)
+        {
+         *candidates = ClassSlotIndexCandidates(theEnv,execStatus,theClassIndex,probe,count);
+         while ((*next < *count) ? ((*candidates)[*next]->indexEntries->order <= lastOrder) : FALSE)
+           (*next)++;
+        }
+     }
+   return(NextCandidateInstance(*candidates,*count,next));
+  }
+
+#endif
+
 /***************************************************************************
   NAME         : AddSolution
   DESCRIPTION  : Adds the current instance set to a global list of
@@ -31,10 +31,25 @@
 #include "object.h"
 #endif
 
+#if DEFCLASS_SLOT_INDEXES
+typedef struct query_index_test
+  {
+   SYMBOL_HN *slotName;
+   char *op;
+   EXPRESSION *keyExp;
+   int keyState;
+   DATA_OBJECT key;
+   struct query_index_test *nxt;
+  } QUERY_INDEX_TEST;
+#endif
+
 typedef struct query_class
   {
    DEFCLASS *cls;
    struct defmodule *theModule;
+#if DEFCLASS_SLOT_INDEXES
+   QUERY_INDEX_TEST *tests;
+#endif
    struct query_class *chain,*nxt;
   } QUERY_CLASS;
 
@@ -87,6 +102,9 @@ struct instanceQueryData
 LOCALE void SetupQuery(void *,EXEC_STATUS);
 LOCALE void *GetQueryInstance(void *,EXEC_STATUS);
 LOCALE void GetQueryInstanceSlot(void *,EXEC_STATUS,DATA_OBJECT *);
+#if DEFCLASS_SLOT_INDEXES
+LOCALE void QueryInstancePlan(void *,EXEC_STATUS);
+#endif
 LOCALE intBool AnyInstances(void *,EXEC_STATUS);
 LOCALE void QueryFindInstance(void *,EXEC_STATUS,DATA_OBJECT *);
 LOCALE void QueryFindAllInstances(void *,EXEC_STATUS,DATA_OBJECT *);
@@ -70,6 +70,12 @@ static void ReplaceInstanceVariables(void *,EXEC_STATUS,EXPRESSION *,EXPRESSION
 static void ReplaceSlotReference(void *,EXEC_STATUS,EXPRESSION *,EXPRESSION *,
                                  struct FunctionDefinition *,int);
 static int IsQueryFunction(EXPRESSION *);
+#if DEFCLASS_SLOT_INDEXES
+static void PlanQueryIndexes(void *,EXEC_STATUS,EXPRESSION *);
+static EXPRESSION *PlanQueryTest(void *,EXEC_STATUS,EXPRESSION *,EXPRESSION *);
+static intBool IsCurrentSlotReference(void *,EXEC_STATUS,EXPRESSION *);
+static intBool IsIndexKeyExpression(EXPRESSION *);
+#endif
 
 /* =========================================
    *****************************************
@@ -137,6 +143,9 @@ globle EXPRESSION *ParseQueryNoAction(
      }
    ReplaceInstanceVariables(theEnv,execStatus,insQuerySetVars,top->argList,TRUE,0);
    ReturnExpression(theEnv,execStatus,insQuerySetVars);
+#if DEFCLASS_SLOT_INDEXES
+   PlanQueryIndexes(theEnv,execStatus,top);
+#endif
    return(top);
   }
 
@@ -208,6 +217,9 @@ globle EXPRESSION *ParseQueryAction(
    ReplaceInstanceVariables(theEnv,execStatus,insQuerySetVars,top->argList,TRUE,0);
    ReplaceInstanceVariables(theEnv,execStatus,insQuerySetVars,top->argList->nextArg,FALSE,0);
    ReturnExpression(theEnv,execStatus,insQuerySetVars);
+#if DEFCLASS_SLOT_INDEXES
+   PlanQueryIndexes(theEnv,execStatus,top);
+#endif
    return(top);
   }
 
@@ -668,6 +680,203 @@ static int IsQueryFunction(
    return(FALSE);
   }
 
+#if DEFCLASS_SLOT_INDEXES
+
+/***********************************************************************
+  NAME         : PlanQueryIndexes
+  DESCRIPTION  : Looks for tests in the query expression which the
+                   index of an instance slot can answer and records
+                   them so that the query functions can fetch the
+                   candidate instances of a class from a slot index
+                   instead of scanning its instance list
+  INPUTS       : The top node of the query function
+  RETURNS      : Nothing useful
+  SIDE EFFECTS : A ((query-instance-plan) ...) call is appended to
+                   the end of the arguments of the query function
+                   when at least one test was found
+  NOTES        : Only the query expression itself or the arguments
+                   of a top level and are considered, since every
+                   one of them must hold for an instance set to
+                   satisfy the query.  A usable test has the form
+
+                   (<op> <instance-var>:<slot> <key>) or
+                   (<op> <key> <instance-var>:<slot>)
+
+                   where <op> is one of eq, =, <, <=, > or >= and
+                   <key> is a constant or a variable.  Each test is
+                   recorded as four arguments of the plan call :
+
+                   <restriction index> <slot-name> <op> <key>
+
+                   The key is recorded with the operator adjusted
+                   so that the slot is always on the left.  Whether
+                   the slot is indexed is only known when the query
+                   is run, since the classes of the restrictions
+                   may be given by expressions.
+ ***********************************************************************/
+static void PlanQueryIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  EXPRESSION *top)
+  {
+   EXPRESSION *query, *plan = NULL, *bexp, *lastArg;
+
+   query = top->argList;
+   if (query->type != FCALL)
+     return;
+
+   if (query->value == (void *) FindFunction(theEnv,execStatus,"and"))
+     {
+      for (bexp = query->argList ; bexp != NULL ; bexp = bexp->nextArg)
+        plan = PlanQueryTest(theEnv,execStatus,bexp,plan);
+     }
+   else
+     plan = PlanQueryTest(theEnv,execStatus,query,plan);
+
+   if (plan == NULL)
+     return;
+
+   for (lastArg = query ; lastArg->nextArg != NULL ; lastArg = lastArg->nextArg)
+     { /* Do Nothing */ }
+   lastArg->nextArg = plan;
+  }
+
+/***********************************************************************
+  NAME         : PlanQueryTest
+  DESCRIPTION  : Adds a test of the query expression to the index
+                   plan of a query function if a slot index can be
+                   used to answer it
+  INPUTS       : 1) The test expression
+                 2) The plan call built so far (NULL if none)
+  RETURNS      : The plan call
+  SIDE EFFECTS : The plan call is created for the first usable test
+  NOTES        : None
+ ***********************************************************************/
+static EXPRESSION *PlanQueryTest(
+  void *theEnv,
+  EXEC_STATUS,
+  EXPRESSION *test,
+  EXPRESSION *plan)
+  {
+   static char *operators[] = { "eq", "=", "<", "<=", ">", ">=" };
+   static char *flipped[] = { "eq", "=", ">", ">=", "<", "<=" };
+   EXPRESSION *slotRef, *key, *keyNext, *group, *lastArg;
+   char *op = NULL;
+   int i;
+
+   if ((test->type != FCALL) || (test->argList == NULL) ||
+       (test->argList->nextArg == NULL) ||
+       (test->argList->nextArg->nextArg != NULL))
+     return(plan);
+
+   for (i = 0 ; i < (int) (sizeof(operators) / sizeof(char *)) ; i++)
+     {
+      if (test->value == (void *) FindFunction(theEnv,execStatus,operators[i]))
+        break;
+     }
+   if (i == (int) (sizeof(operators) / sizeof(char *)))
+     return(plan);
+
+   if (IsCurrentSlotReference(theEnv,execStatus,test->argList) &&
+       IsIndexKeyExpression(test->argList->nextArg))
+     {
+      slotRef = test->argList;
+      key = test->argList->nextArg;
+      op = operators[i];
+     }
+   else if (IsCurrentSlotReference(theEnv,execStatus,test->argList->nextArg) &&
+            IsIndexKeyExpression(test->argList))
+     {
+      slotRef = test->argList->nextArg;
+      key = test->argList;
+      op = flipped[i];
+     }
+   else
+     return(plan);
+
+   group = GenConstant(theEnv,execStatus,INTEGER,slotRef->argList->nextArg->value);
+   group->nextArg = GenConstant(theEnv,execStatus,SYMBOL,slotRef->argList->nextArg->nextArg->value);
+   group->nextArg->nextArg = GenConstant(theEnv,execStatus,SYMBOL,EnvAddSymbol(theEnv,execStatus,op));
+   keyNext = key->nextArg;
+   key->nextArg = NULL;
+   group->nextArg->nextArg->nextArg = CopyExpression(theEnv,execStatus,key);
+   key->nextArg = keyNext;
+
+   if (plan == NULL)
+     {
+      plan = GenConstant(theEnv,execStatus,FCALL,(void *) FindFunction(theEnv,execStatus,"(query-instance-plan)"));
+      plan->argList = group;
+     }
+   else
+     {
+      for (lastArg = plan->argList ; lastArg->nextArg != NULL ; lastArg = lastArg->nextArg)
+        { /* Do Nothing */ }
+      lastArg->nextArg = group;
+     }
+
+   return(plan);
+  }
+
+/***************************************************************
+  NAME         : IsCurrentSlotReference
+  DESCRIPTION  : Determines if an expression references a slot
+                   of an instance variable of the query function
+                   being parsed
+  INPUTS       : The expression
+  RETURNS      : TRUE if the expression is of the form
+                   ((query-instance-slot) 0 <index> <slot-name>),
+                   FALSE otherwise
+  SIDE EFFECTS : None
+  NOTES        : None
+ ***************************************************************/
+static intBool IsCurrentSlotReference(
+  void *theEnv,
+  EXEC_STATUS,
+  EXPRESSION *theExp)
+  {
+   if ((theExp->type != FCALL) ||
+       (theExp->value != (void *) FindFunction(theEnv,execStatus,"(query-instance-slot)")))
+     return(FALSE);
+
+   if (ValueToLong(theExp->argList->value) != 0)
+     return(FALSE);
+
+   return((theExp->argList->nextArg->nextArg->type == SYMBOL) ? TRUE : FALSE);
+  }
+
+/***************************************************************
+  NAME         : IsIndexKeyExpression
+  DESCRIPTION  : Determines if an expression can be used as the
+                   key of an index probe, that is whether it can
+                   be evaluated once before the instances are
+                   visited
+  INPUTS       : The expression
+  RETURNS      : TRUE if the expression contains no function
+                   calls, FALSE otherwise
+  SIDE EFFECTS : None
+  NOTES        : Instance variables of enclosing queries are
+                   still unreplaced variables at this point
+ ***************************************************************/
+static intBool IsIndexKeyExpression(
+  EXPRESSION *theExp)
+  {
+   EXPRESSION *argPtr;
+
+   if ((theExp->type == FCALL) || (theExp->type == GCALL) ||
+       (theExp->type == PCALL))
+     return(FALSE);
+
+   for (argPtr = theExp->argList ; argPtr != NULL ; argPtr = argPtr->nextArg)
+     {
+      if (IsIndexKeyExpression(argPtr) == FALSE)
+        return(FALSE);
+     }
+
+   return(TRUE);
+  }
+
+#endif
+
 #endif
 
 /***************************************************
@@ -120,8 +120,8 @@ globle intBool AddLogicalDependencies(
 
    newDependency = get_struct(theEnv,execStatus,dependency);
    newDependency->dPtr = (void *) theEntity;
-   newDependency->next = (struct dependency *) theBinds->dependents;
-   theBinds->dependents = (void *) newDependency;
+   newDependency->next = (struct dependency *) get_pm_dependents(theBinds);
+   GetPartialMatchLinks(theEnv,execStatus,theBinds)->dependents = (void *) newDependency;
 
    /*================================================================*/
    /* Add a dependency link between the entity and the partialMatch. */
@@ -208,9 +208,9 @@ globle void RemoveEntityDependencies(
       /*================================================================*/
 
       theBinds = (struct partialMatch *) fdPtr->dPtr;
-      theList = (struct dependency *) theBinds->dependents;
+      theList = (struct dependency *) get_pm_dependents(theBinds);
       theList = DetachAssociatedDependencies(theEnv,execStatus,theList,(void *) theEntity);
-      theBinds->dependents = (void *) theList;
+      theBinds->links->dependents = (void *) theList;
 
       /*========================*/
       /* Return the dependency. */
@@ -306,7 +306,7 @@ globle void RemovePMDependencies(
    struct dependency *fdPtr, *nextPtr, *theList;
    struct patternEntity *theEntity;
 
-   fdPtr = (struct dependency *) theBinds->dependents;
+   fdPtr = (struct dependency *) get_pm_dependents(theBinds);
 
    while (fdPtr != NULL)
      {
@@ -322,7 +322,8 @@ globle void RemovePMDependencies(
       fdPtr = nextPtr;
      }
 
-   theBinds->dependents = NULL;
+   if (theBinds->links != NULL)
+     { theBinds->links->dependents = NULL; }
   }
 
 /************************************************************/
@@ -336,7 +337,7 @@ globle void DestroyPMDependencies(
   {
    struct dependency *fdPtr, *nextPtr;
 
-   fdPtr = (struct dependency *) theBinds->dependents;
+   fdPtr = (struct dependency *) get_pm_dependents(theBinds);
 
    while (fdPtr != NULL)
      {
@@ -346,7 +347,8 @@ globle void DestroyPMDependencies(
       fdPtr = nextPtr;
      }
 
-   theBinds->dependents = NULL;
+   if (theBinds->links != NULL)
+     { theBinds->links->dependents = NULL; }
   }
 
 /************************************************************************/
@@ -372,14 +374,14 @@ globle void RemoveLogicalSupport(
    /* dependencies, then return.             */
    /*========================================*/
 
-   if (theBinds->dependents == NULL) return;
+   if (get_pm_dependents(theBinds) == NULL) return;
 
    /*=======================================*/
    /* Loop through each of the dependencies */
    /* attached to the partial match.        */
    /*=======================================*/
 
-   dlPtr = (struct dependency *) theBinds->dependents;
+   dlPtr = (struct dependency *) theBinds->links->dependents;
 
    while (dlPtr != NULL)
      {
@@ -429,7 +431,7 @@ globle void RemoveLogicalSupport(
    /* dependencies associated with it.    */
    /*=====================================*/
 
-   theBinds->dependents = NULL;
+   theBinds->links->dependents = NULL;
   }
 
 /********************************************************************/
@@ -63,7 +63,23 @@ struct genericMatch
   };
 
 /************************************************************/
-/* PARTIALMATCH STRUCTURE:                                  */
+/* PARTIALMATCHLINKS STRUCTURE: The links of a partial      */
+/*   match which are only used by joins with a negated or   */
+/*   existential CE (the block lists) and by logical CEs    */
+/*   (the dependencies). They are allocated on first use.   */
+/************************************************************/
+struct partialMatchLinks
+  {
+   void *dependents;
+   struct partialMatch *blockList;
+   struct partialMatch *nextBlocked;
+   struct partialMatch *prevBlocked;
+  };
+
+/************************************************************/
+/* PARTIALMATCH STRUCTURE: The fields read while scanning   */
+/*   a beta memory bucket (hashValue, nextInMemory and the  */
+/*   bindings) are kept together at the end.                */
 /************************************************************/
 struct partialMatch
   {
@@ -71,11 +87,10 @@ struct partialMatch
    unsigned int busy        :  1;
    unsigned int rhsMemory   :  1;
    unsigned short bcount; 
-   unsigned long hashValue;
+   unsigned long long memoryTag;
    void *owner;
    void *marker;
-   void *dependents;
-   struct partialMatch *nextInMemory;
+   struct partialMatchLinks *links;
    struct partialMatch *prevInMemory;
    struct partialMatch *children;
    struct partialMatch *rightParent;
@@ -84,9 +99,8 @@ struct partialMatch
    struct partialMatch *leftParent;
    struct partialMatch *nextLeftChild;
    struct partialMatch *prevLeftChild;
-   struct partialMatch *blockList;
-   struct partialMatch *nextBlocked;
-   struct partialMatch *prevBlocked;
+   unsigned long hashValue;
+   struct partialMatch *nextInMemory;
    struct genericMatch binds[1];
   };
 
@@ -126,6 +140,10 @@ struct multifieldMarker
 #define set_nth_pm_value(thePM,thePos,theVal) (thePM->binds[thePos].gm.theValue = (void *) theVal)
 #define set_nth_pm_match(thePM,thePos,theVal) (thePM->binds[thePos].gm.theMatch = theVal)
 
+#define get_pm_dependents(thePM) (((thePM)->links == NULL) ? NULL : (thePM)->links->dependents)
+#define get_pm_block_list(thePM) (((thePM)->links == NULL) ? NULL : (thePM)->links->blockList)
+#define get_pm_next_blocked(thePM) (((thePM)->links == NULL) ? NULL : (thePM)->links->nextBlocked)
+
 #endif
 
 
@@ -24,6 +24,10 @@
 /*                                                           */
 /*            Corrected code to remove compiler warnings.    */
 /*                                                           */
+/*      6.30: Small blocks are recycled through per-thread   */
+/*            caches which exchange blocks with the shared   */
+/*            memory table in batches.                       */
+/*                                                           */
 /*************************************************************/
 
 #define _MEMORY_SOURCE_
@@ -62,6 +66,12 @@
    static int                     AllocateBlock(void *,EXEC_STATUS,struct blockInfo *,unsigned int);
    static void                    AllocateChunk(void *,EXEC_STATUS,struct blockInfo *,struct chunkInfo *,size_t);
 #endif
+   static struct memoryCache     *ThreadMemoryCache(void *,EXEC_STATUS);
+   static struct memoryCache     *AttachMemoryCache(void *,EXEC_STATUS);
+   static struct memoryPtr       *RefillMemoryCache(void *,struct memoryCache *,size_t);
+   static void                    FlushMemoryCache(void *,struct memoryCache *,size_t,unsigned int);
+   static void                    EmptyMemoryCache(struct memoryData *,struct memoryCache *);
+   static void                    CountMemory(void *,EXEC_STATUS,long int,long int);
 
 /********************************************/
 /* InitializeMemory: Sets up memory tables. */
@@ -78,15 +88,30 @@ globle void InitializeMemory(
    
    MemoryData(theEnv,execStatus)->MemoryTable = (struct memoryPtr **)
                  malloc((STD_SIZE) (sizeof(struct memoryPtr *) * MEM_TABLE_SIZE));
+   MemoryData(theEnv,execStatus)->BatchTable = (struct memoryBatch **)
+                 malloc((STD_SIZE) (sizeof(struct memoryBatch *) * MEM_TABLE_SIZE));
 
-   if (MemoryData(theEnv,execStatus)->MemoryTable == NULL)
+   if ((MemoryData(theEnv,execStatus)->MemoryTable == NULL) ||
+       (MemoryData(theEnv,execStatus)->BatchTable == NULL))
      {
       PrintErrorID(theEnv,execStatus,"MEMORY",1,TRUE);
       EnvPrintRouter(theEnv,execStatus,WERROR,"Out of memory.\n");
       EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
      }
 
-   for (i = 0; i < MEM_TABLE_SIZE; i++) MemoryData(theEnv,execStatus)->MemoryTable[i] = NULL;
+   for (i = 0; i < MEM_TABLE_SIZE; i++)
+     {
+      MemoryData(theEnv,execStatus)->MemoryTable[i] = NULL;
+      MemoryData(theEnv,execStatus)->BatchTable[i] = NULL;
+     }
+
+   if (apr_thread_mutex_create(&MemoryData(theEnv,execStatus)->TableLock,APR_THREAD_MUTEX_DEFAULT,
+                               Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+     {
+      PrintErrorID(theEnv,execStatus,"MEMORY",1,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"Out of memory.\n");
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
   }
 
 /***************************************************/
@@ -138,8 +163,7 @@ globle void *genalloc(
      }
 #endif
 
-   MemoryData(theEnv,execStatus)->MemoryAmount += (long) size;
-   MemoryData(theEnv,execStatus)->MemoryCalls++;
+   CountMemory(theEnv,execStatus,(long) size,1L);
 
    return((void *) memPtr);
   }
@@ -202,8 +226,7 @@ globle int genfree(
    free(waste);
 #endif
 
-   MemoryData(theEnv,execStatus)->MemoryAmount -= (long) size;
-   MemoryData(theEnv,execStatus)->MemoryCalls--;
+   CountMemory(theEnv,execStatus,- (long) size,-1L);
 
    return(0);
   }
@@ -237,26 +260,48 @@ globle void *genrealloc(
    return((void *) newaddr);
   }
 
-/********************************/
-/* EnvMemUsed: C access routine */
-/*   for the mem-used command.  */
-/********************************/
+/**************************************************/
+/* EnvMemUsed: C access routine for the mem-used  */
+/*   command. The amounts counted by the caches of */
+/*   all threads are added to the shared amount.   */
+/**************************************************/
 globle long int EnvMemUsed(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(MemoryData(theEnv,execStatus)->MemoryAmount);
+   struct memoryData *theData = MemoryData(theEnv,execStatus);
+   struct memoryCache *theCache;
+   long int amount;
+
+   apr_thread_mutex_lock(theData->TableLock);
+   amount = theData->MemoryAmount;
+   for (theCache = theData->ListOfCaches; theCache != NULL; theCache = theCache->next)
+     { amount += theCache->MemoryAmount; }
+   apr_thread_mutex_unlock(theData->TableLock);
+
+   return(amount);
   }
 
-/************************************/
-/* EnvMemRequests: C access routine */
-/*   for the mem-requests command.  */
-/************************************/
+/****************************************************/
+/* EnvMemRequests: C access routine for the         */
+/*   mem-requests command. The requests counted by  */
+/*   the caches of all threads are added as well.   */
+/****************************************************/
 globle long int EnvMemRequests(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(MemoryData(theEnv,execStatus)->MemoryCalls);
+   struct memoryData *theData = MemoryData(theEnv,execStatus);
+   struct memoryCache *theCache;
+   long int calls;
+
+   apr_thread_mutex_lock(theData->TableLock);
+   calls = theData->MemoryCalls;
+   for (theCache = theData->ListOfCaches; theCache != NULL; theCache = theCache->next)
+     { calls += theCache->MemoryCalls; }
+   apr_thread_mutex_unlock(theData->TableLock);
+
+   return(calls);
   }
 
 /***************************************/
@@ -268,8 +313,8 @@ globle long int UpdateMemoryUsed(
   EXEC_STATUS,
   long int value)
   {
-   MemoryData(theEnv,execStatus)->MemoryAmount += value;
-   return(MemoryData(theEnv,execStatus)->MemoryAmount);
+   CountMemory(theEnv,execStatus,value,0L);
+   return(EnvMemUsed(theEnv,execStatus));
   }
 
 /*******************************************/
@@ -281,8 +326,8 @@ globle long int UpdateMemoryRequests(
   EXEC_STATUS,
   long int value)
   {
-   MemoryData(theEnv,execStatus)->MemoryCalls += value;
-   return(MemoryData(theEnv,execStatus)->MemoryCalls);
+   CountMemory(theEnv,execStatus,0L,value);
+   return(EnvMemRequests(theEnv,execStatus));
   }
 
 /***********************************/
@@ -295,29 +340,74 @@ globle long int EnvReleaseMem(
   long int maximum,
   int printMessage)
   {
+   struct memoryData *theData = MemoryData(theEnv,execStatus);
    struct memoryPtr *tmpPtr, *memPtr;
    int i;
    long int returns = 0;
    long int amount = 0;
+   long int released;
+   struct memoryBatch *theBatch;
 
    if (printMessage == TRUE)
      { EnvPrintRouter(theEnv,execStatus,WDIALOG,"\n*** DEALLOCATING MEMORY ***\n"); }
 
+   /*===============================================*/
+   /* The blocks cached by the calling thread are   */
+   /* released as well. Those of other threads are  */
+   /* left alone, since they may be in use.         */
+   /*===============================================*/
+
+   if ((execStatus != NULL) && (execStatus->MemoryCache != NULL) &&
+       (execStatus->MemoryCache->environment == theEnv))
+     {
+      for (i = (int) sizeof(char *) ; i < MEM_TABLE_SIZE ; i++)
+        {
+         if (execStatus->MemoryCache->count[i] > 0)
+           { FlushMemoryCache(theEnv,execStatus->MemoryCache,(size_t) i,execStatus->MemoryCache->count[i]); }
+        }
+     }
+
    for (i = (MEM_TABLE_SIZE - 1) ; i >= (int) sizeof(char *) ; i--)
      {
       YieldTime(theEnv,execStatus);
-      memPtr = MemoryData(theEnv,execStatus)->MemoryTable[i];
-      while (memPtr != NULL)
+
+      apr_thread_mutex_lock(theData->TableLock);
+      memPtr = theData->MemoryTable[i];
+      theData->MemoryTable[i] = NULL;
+      theBatch = theData->BatchTable[i];
+      theData->BatchTable[i] = NULL;
+      apr_thread_mutex_unlock(theData->TableLock);
+
+      for (released = 0 ; (memPtr != NULL) || (theBatch != NULL) ; released++)
         {
+         if (memPtr == NULL)
+           {
+            memPtr = (struct memoryPtr *) theBatch;
+            theBatch = theBatch->nextBatch;
+           }
+
          tmpPtr = memPtr->next;
-         genfree(theEnv,execStatus,(void *) memPtr,(unsigned) i);
+#if BLOCK_MEMORY
+         ReturnChunk(theEnv,execStatus,(void *) memPtr,(size_t) i);
+#else
+         free(memPtr);
+#endif
          memPtr = tmpPtr;
          amount += i;
          returns++;
          if ((returns % 100) == 0)
            { YieldTime(theEnv,execStatus); }
         }
-      MemoryData(theEnv,execStatus)->MemoryTable[i] = NULL;
+
+      /*================================================*/
+      /* The blocks are charged to the shared counters, */
+      /* so the calling thread is not given a cache     */
+      /* just for releasing memory.                     */
+      /*================================================*/
+
+      if (released > 0)
+        { CountMemory(theEnv,NULL,- (long) (released * i),- released); }
+
       if ((amount > maximum) && (maximum > 0))
         {
          if (printMessage == TRUE)
@@ -340,32 +430,14 @@ globle void *gm1(
   EXEC_STATUS,
   size_t size)
   {
-   struct memoryPtr *memPtr;
    char *tmpPtr;
    size_t i;
 
    if (size < (long) sizeof(char *)) size = sizeof(char *);
 
-   if (size >= MEM_TABLE_SIZE)
-     {
-      tmpPtr = (char *) genalloc(theEnv,execStatus,(unsigned) size);
-      for (i = 0 ; i < size ; i++)
-        { tmpPtr[i] = '\0'; }
-      return((void *) tmpPtr);
-     }
+   tmpPtr = (char *) GetPooledMemory(theEnv,execStatus,size);
+   if (tmpPtr == NULL) return(NULL);
 
-   memPtr = (struct memoryPtr *) MemoryData(theEnv,execStatus)->MemoryTable[size];
-   if (memPtr == NULL)
-     {
-      tmpPtr = (char *) genalloc(theEnv,execStatus,(unsigned) size);
-      for (i = 0 ; i < size ; i++)
-        { tmpPtr[i] = '\0'; }
-      return((void *) tmpPtr);
-     }
-
-   MemoryData(theEnv,execStatus)->MemoryTable[size] = memPtr->next;
-
-   tmpPtr = (char *) memPtr;
    for (i = 0 ; i < size ; i++)
      { tmpPtr[i] = '\0'; }
 
@@ -380,21 +452,9 @@ globle void *gm2(
   EXEC_STATUS,
   size_t size)
   {
-   struct memoryPtr *memPtr;
-   
    if (size < sizeof(char *)) size = sizeof(char *);
 
-   if (size >= MEM_TABLE_SIZE) return(genalloc(theEnv,execStatus,(unsigned) size));
-
-   memPtr = (struct memoryPtr *) MemoryData(theEnv,execStatus)->MemoryTable[size];
-   if (memPtr == NULL)
-     {
-      return(genalloc(theEnv,execStatus,(unsigned) size));
-     }
-
-   MemoryData(theEnv,execStatus)->MemoryTable[size] = memPtr->next;
-
-   return ((void *) memPtr);
+   return(GetPooledMemory(theEnv,execStatus,size));
   }
 
 /*****************************************************/
@@ -405,19 +465,9 @@ globle void *gm3(
   EXEC_STATUS,
   size_t size)
   {
-   struct memoryPtr *memPtr;
-
    if (size < (long) sizeof(char *)) size = sizeof(char *);
 
-   if (size >= MEM_TABLE_SIZE) return(genalloc(theEnv,execStatus,size));
-
-   memPtr = (struct memoryPtr *) MemoryData(theEnv,execStatus)->MemoryTable[(int) size];
-   if (memPtr == NULL)
-     { return(genalloc(theEnv,execStatus,size)); }
-
-   MemoryData(theEnv,execStatus)->MemoryTable[(int) size] = memPtr->next;
-
-   return ((void *) memPtr);
+   return(GetPooledMemory(theEnv,execStatus,size));
   }
 
 /****************************************/
@@ -430,8 +480,6 @@ globle int rm(
   void *str,
   size_t size)
   {
-   struct memoryPtr *memPtr;
-
    if (size == 0)
      {
       SystemError(theEnv,execStatus,"MEMORY",1);
@@ -442,9 +490,7 @@ globle int rm(
 
    if (size >= MEM_TABLE_SIZE) return(genfree(theEnv,execStatus,(void *) str,(unsigned) size));
 
-   memPtr = (struct memoryPtr *) str;
-   memPtr->next = MemoryData(theEnv,execStatus)->MemoryTable[size];
-   MemoryData(theEnv,execStatus)->MemoryTable[size] = memPtr;
+   ReturnPooledMemory(theEnv,execStatus,str,size);
    return(1);
   }
 
@@ -459,8 +505,6 @@ globle int rm3(
   void *str,
   size_t size)
   {
-   struct memoryPtr *memPtr;
-
    if (size == 0)
      {
       SystemError(theEnv,execStatus,"MEMORY",1);
@@ -471,12 +515,401 @@ globle int rm3(
 
    if (size >= MEM_TABLE_SIZE) return(genfree(theEnv,execStatus,(void *) str,(unsigned long) size));
 
-   memPtr = (struct memoryPtr *) str;
-   memPtr->next = MemoryData(theEnv,execStatus)->MemoryTable[(int) size];
-   MemoryData(theEnv,execStatus)->MemoryTable[(int) size] = memPtr;
+   ReturnPooledMemory(theEnv,execStatus,str,size);
    return(1);
   }
 
+/*****************************************************/
+/* GetPooledMemory: Allocates a block of memory. A   */
+/*   small block is taken from the cache of the      */
+/*   calling thread, which is refilled from the      */
+/*   shared memory table when it has run empty.      */
+/*****************************************************/
+globle void *GetPooledMemory(
+  void *theEnv,
+  EXEC_STATUS,
+  size_t size)
+  {
+   struct memoryCache *theCache;
+   struct memoryPtr *memPtr;
+   struct memoryData *theData;
+
+   if (size >= MEM_TABLE_SIZE) return(genalloc(theEnv,execStatus,size));
+
+   theCache = ThreadMemoryCache(theEnv,execStatus);
+
+   /*===============================================*/
+   /* Without a cache the shared table is accessed  */
+   /* directly, which requires its lock to be held. */
+   /*===============================================*/
+
+   if (theCache == NULL)
+     {
+      theData = MemoryData(theEnv,execStatus);
+      apr_thread_mutex_lock(theData->TableLock);
+      memPtr = theData->MemoryTable[size];
+      if (memPtr != NULL)
+        { theData->MemoryTable[size] = memPtr->next; }
+      apr_thread_mutex_unlock(theData->TableLock);
+
+      if (memPtr == NULL) return(genalloc(theEnv,execStatus,size));
+      return((void *) memPtr);
+     }
+
+   memPtr = theCache->freeList[size];
+   if (memPtr == NULL)
+     {
+      memPtr = RefillMemoryCache(theEnv,theCache,size);
+      if (memPtr == NULL) return(genalloc(theEnv,execStatus,size));
+     }
+
+   theCache->freeList[size] = memPtr->next;
+   theCache->count[size]--;
+
+   return((void *) memPtr);
+  }
+
+/*****************************************************/
+/* ReturnPooledMemory: Returns a block of memory. A  */
+/*   small block is kept in the cache of the calling */
+/*   thread. Once the cache holds too many blocks of */
+/*   that size, a batch of them is handed back to    */
+/*   the shared memory table.                        */
+/*****************************************************/
+globle void ReturnPooledMemory(
+  void *theEnv,
+  EXEC_STATUS,
+  void *str,
+  size_t size)
+  {
+   struct memoryCache *theCache;
+   struct memoryPtr *memPtr;
+   struct memoryData *theData;
+
+   if (size >= MEM_TABLE_SIZE)
+     {
+      genfree(theEnv,execStatus,str,size);
+      return;
+     }
+
+   memPtr = (struct memoryPtr *) str;
+   theCache = ThreadMemoryCache(theEnv,execStatus);
+
+   if (theCache == NULL)
+     {
+      theData = MemoryData(theEnv,execStatus);
+      apr_thread_mutex_lock(theData->TableLock);
+      memPtr->next = theData->MemoryTable[size];
+      theData->MemoryTable[size] = memPtr;
+      apr_thread_mutex_unlock(theData->TableLock);
+      return;
+     }
+
+   memPtr->next = theCache->freeList[size];
+   theCache->freeList[size] = memPtr;
+
+   if (++theCache->count[size] > MEMORY_CACHE_LIMIT)
+     { FlushMemoryCache(theEnv,theCache,size,MEMORY_CACHE_BATCH); }
+  }
+
+/***********************************************************/
+/* ReleaseMemoryCache: Hands the blocks cached by the      */
+/*   thread of an execution status back to the shared      */
+/*   memory table and adds the amounts counted by the      */
+/*   cache to the shared counters. Called by threads that  */
+/*   are done with an environment. The cache belongs to    */
+/*   the environment it was created for, which need not    */
+/*   be the one passed in.                                 */
+/***********************************************************/
+#if WIN_BTC
+#pragma argsused
+#endif
+globle void ReleaseMemoryCache(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct memoryCache *theCache;
+   struct memoryData *theData;
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv)
+#endif
+
+   if ((execStatus == NULL) || (execStatus->MemoryCache == NULL)) return;
+
+   theCache = execStatus->MemoryCache;
+   theData = MemoryData(theCache->environment,execStatus);
+
+   apr_thread_mutex_lock(theData->TableLock);
+   EmptyMemoryCache(theData,theCache);
+   apr_thread_mutex_unlock(theData->TableLock);
+
+   execStatus->MemoryCache = NULL;
+   free(theCache);
+  }
+
+/**********************************************************/
+/* ReleaseAllMemoryCaches: Releases the caches of all     */
+/*   threads which have used the environment. Only safe   */
+/*   while no other thread is using it, i.e. when the     */
+/*   environment is destroyed.                            */
+/**********************************************************/
+globle void ReleaseAllMemoryCaches(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct memoryData *theData = MemoryData(theEnv,execStatus);
+   struct memoryCache *theCache;
+
+   apr_thread_mutex_lock(theData->TableLock);
+   while ((theCache = theData->ListOfCaches) != NULL)
+     {
+      EmptyMemoryCache(theData,theCache);
+      theCache->owner->MemoryCache = NULL;
+      free(theCache);
+     }
+   apr_thread_mutex_unlock(theData->TableLock);
+  }
+
+/*******************************************************/
+/* ThreadMemoryCache: Returns the memory cache of the  */
+/*   calling thread for the environment, creating it   */
+/*   if necessary. NULL is returned if the thread has  */
+/*   no execution status or a cache can't be created.  */
+/*******************************************************/
+static struct memoryCache *ThreadMemoryCache(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (execStatus == NULL) return(NULL);
+
+   if ((execStatus->MemoryCache != NULL) &&
+       (execStatus->MemoryCache->environment == theEnv))
+     { return(execStatus->MemoryCache); }
+
+   return(AttachMemoryCache(theEnv,execStatus));
+  }
+
+/******************************************************/
+/* AttachMemoryCache: Creates a memory cache for the  */
+/*   thread of an execution status. A cache the       */
+/*   thread has for another environment is released.  */
+/******************************************************/
+static struct memoryCache *AttachMemoryCache(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct memoryData *theData = MemoryData(theEnv,execStatus);
+   struct memoryCache *theCache;
+
+   ReleaseMemoryCache(theEnv,execStatus);
+
+   /*================================================*/
+   /* The cache itself is not taken from the memory  */
+   /* it manages, so it doesn't show up in mem-used. */
+   /*================================================*/
+
+   theCache = (struct memoryCache *) malloc(sizeof(struct memoryCache));
+   if (theCache == NULL) return(NULL);
+
+   memset(theCache,0,sizeof(struct memoryCache));
+   theCache->environment = theEnv;
+   theCache->owner = execStatus;
+
+   apr_thread_mutex_lock(theData->TableLock);
+   theCache->next = theData->ListOfCaches;
+   if (theData->ListOfCaches != NULL)
+     { theData->ListOfCaches->prev = theCache; }
+   theData->ListOfCaches = theCache;
+   apr_thread_mutex_unlock(theData->TableLock);
+
+   execStatus->MemoryCache = theCache;
+
+   return(theCache);
+  }
+
+/*****************************************************/
+/* RefillMemoryCache: Moves a batch of blocks of the */
+/*   given size from the shared memory table to an   */
+/*   empty cache. If no batch is available, up to    */
+/*   MEMORY_CACHE_BATCH single blocks are moved.     */
+/*   Returns the first block moved or NULL if the    */
+/*   shared table had none.                          */
+/*****************************************************/
+static struct memoryPtr *RefillMemoryCache(
+  void *theEnv,
+  struct memoryCache *theCache,
+  size_t size)
+  {
+   struct memoryData *theData = MemoryData(theEnv,NULL);
+   struct memoryPtr *first, *last;
+   struct memoryBatch *theBatch;
+   unsigned short moved;
+
+   apr_thread_mutex_lock(theData->TableLock);
+
+   theBatch = theData->BatchTable[size];
+   if (theBatch != NULL)
+     {
+      theData->BatchTable[size] = theBatch->nextBatch;
+      apr_thread_mutex_unlock(theData->TableLock);
+
+      theCache->freeList[size] = (struct memoryPtr *) theBatch;
+      theCache->count[size] = MEMORY_CACHE_BATCH;
+      return((struct memoryPtr *) theBatch);
+     }
+
+   first = last = theData->MemoryTable[size];
+   if (first == NULL)
+     {
+      apr_thread_mutex_unlock(theData->TableLock);
+      return(NULL);
+     }
+
+   for (moved = 1; (moved < MEMORY_CACHE_BATCH) && (last->next != NULL); moved++)
+     { last = last->next; }
+
+   theData->MemoryTable[size] = last->next;
+
+   apr_thread_mutex_unlock(theData->TableLock);
+
+   last->next = NULL;
+   theCache->freeList[size] = first;
+   theCache->count[size] = moved;
+
+   return(first);
+  }
+
+/****************************************************/
+/* FlushMemoryCache: Moves the given number of      */
+/*   blocks of the given size from a cache to the   */
+/*   shared memory table. The blocks returned least */
+/*   recently are moved, since the others are more  */
+/*   likely to still be in the processor's cache.   */
+/*   They are unlinked before the lock is taken and */
+/*   handed over as a batch if there are exactly    */
+/*   MEMORY_CACHE_BATCH of them.                    */
+/****************************************************/
+static void FlushMemoryCache(
+  void *theEnv,
+  struct memoryCache *theCache,
+  size_t size,
+  unsigned int amount)
+  {
+   struct memoryData *theData = MemoryData(theEnv,NULL);
+   struct memoryPtr *first, *last;
+   struct memoryBatch *theBatch;
+   unsigned int kept;
+
+   if ((amount == 0) || (theCache->freeList[size] == NULL)) return;
+
+   if (amount >= theCache->count[size])
+     {
+      amount = theCache->count[size];
+      first = theCache->freeList[size];
+      theCache->freeList[size] = NULL;
+      theCache->count[size] = 0;
+     }
+   else
+     {
+      kept = theCache->count[size] - amount;
+      for (last = theCache->freeList[size]; kept > 1; kept--)
+        { last = last->next; }
+      first = last->next;
+      last->next = NULL;
+      theCache->count[size] -= (unsigned short) amount;
+     }
+
+   if ((amount == MEMORY_CACHE_BATCH) && (size >= sizeof(struct memoryBatch)))
+     {
+      theBatch = (struct memoryBatch *) first;
+      apr_thread_mutex_lock(theData->TableLock);
+      theBatch->nextBatch = theData->BatchTable[size];
+      theData->BatchTable[size] = theBatch;
+      apr_thread_mutex_unlock(theData->TableLock);
+      return;
+     }
+
+   for (last = first; last->next != NULL; last = last->next)
+     { /* Do Nothing */ }
+
+   apr_thread_mutex_lock(theData->TableLock);
+   last->next = theData->MemoryTable[size];
+   theData->MemoryTable[size] = first;
+   apr_thread_mutex_unlock(theData->TableLock);
+  }
+
+/*****************************************************/
+/* EmptyMemoryCache: Moves all blocks of a cache to  */
+/*   the shared memory table, adds its counters to   */
+/*   the shared ones and unlinks it from the list of */
+/*   caches. The lock of the table must be held.     */
+/*****************************************************/
+static void EmptyMemoryCache(
+  struct memoryData *theData,
+  struct memoryCache *theCache)
+  {
+   struct memoryPtr *memPtr, *nextPtr;
+   int i;
+
+   for (i = 0; i < MEM_TABLE_SIZE; i++)
+     {
+      for (memPtr = theCache->freeList[i]; memPtr != NULL; memPtr = nextPtr)
+        {
+         nextPtr = memPtr->next;
+         memPtr->next = theData->MemoryTable[i];
+         theData->MemoryTable[i] = memPtr;
+        }
+      theCache->freeList[i] = NULL;
+      theCache->count[i] = 0;
+     }
+
+   theData->MemoryAmount += theCache->MemoryAmount;
+   theData->MemoryCalls += theCache->MemoryCalls;
+   theCache->MemoryAmount = 0;
+   theCache->MemoryCalls = 0;
+
+   if (theCache->prev == NULL)
+     { theData->ListOfCaches = theCache->next; }
+   else
+     { theCache->prev->next = theCache->next; }
+
+   if (theCache->next != NULL)
+     { theCache->next->prev = theCache->prev; }
+
+   theCache->prev = NULL;
+   theCache->next = NULL;
+  }
+
+/***************************************************/
+/* CountMemory: Updates the memory statistics. The */
+/*   counters of the calling thread's cache are    */
+/*   used if there is one, otherwise the shared    */
+/*   counters are updated while holding the lock.  */
+/***************************************************/
+static void CountMemory(
+  void *theEnv,
+  EXEC_STATUS,
+  long int amount,
+  long int calls)
+  {
+   struct memoryCache *theCache;
+   struct memoryData *theData;
+
+   theCache = ThreadMemoryCache(theEnv,execStatus);
+   if (theCache != NULL)
+     {
+      theCache->MemoryAmount += amount;
+      theCache->MemoryCalls += calls;
+      return;
+     }
+
+   theData = MemoryData(theEnv,execStatus);
+   apr_thread_mutex_lock(theData->TableLock);
+   theData->MemoryAmount += amount;
+   theData->MemoryCalls += calls;
+   apr_thread_mutex_unlock(theData->TableLock);
+  }
+
 /***************************************************/
 /* PoolSize: Returns number of bytes in free pool. */
 /***************************************************/
@@ -486,8 +919,10 @@ globle unsigned long PoolSize(
   {
    register int i;
    struct memoryPtr *memPtr;
+   struct memoryBatch *theBatch;
    unsigned long cnt = 0;
 
+   apr_thread_mutex_lock(MemoryData(theEnv,execStatus)->TableLock);
    for (i = sizeof(char *) ; i < MEM_TABLE_SIZE ; i++)
      {
       memPtr = MemoryData(theEnv,execStatus)->MemoryTable[i];
@@ -496,7 +931,15 @@ globle unsigned long PoolSize(
          cnt += (unsigned long) i;
          memPtr = memPtr->next;
         }
+
+      theBatch = MemoryData(theEnv,execStatus)->BatchTable[i];
+      while (theBatch != NULL)
+        {
+         cnt += (unsigned long) i * MEMORY_CACHE_BATCH;
+         theBatch = theBatch->nextBatch;
+        }
      }
+   apr_thread_mutex_unlock(MemoryData(theEnv,execStatus)->TableLock);
    return(cnt);
   }
 
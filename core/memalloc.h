@@ -20,6 +20,8 @@
 /*                                                           */
 /*      6.30: Added get_mem and rtn_mem macros.              */
 /*                                                           */
+/*            Added per-thread memory caches.                */
+/*                                                           */
 /*************************************************************/
 
 #ifndef _H_memalloc
@@ -31,9 +33,13 @@
 struct chunkInfo;
 struct blockInfo;
 struct memoryPtr;
+struct memoryBatch;
+struct memoryCache;
 
 #define MEM_TABLE_SIZE 500
 
+# include <apr_thread_mutex.h>
+
 #ifdef LOCALE
 #undef LOCALE
 #endif
@@ -65,56 +71,103 @@ struct memoryPtr
    struct memoryPtr *next;
   };
 
-// STEFAN: TODO: make those thread-safe
+/*==========================================================*/
+/* A thread keeps at most MEMORY_CACHE_LIMIT free blocks of */
+/* each size. Blocks move between a cache and the shared    */
+/* memory table MEMORY_CACHE_BATCH blocks at a time.        */
+/*==========================================================*/
+
+#define MEMORY_CACHE_LIMIT 64
+#define MEMORY_CACHE_BATCH 32
+
+/************************************************************/
+/* MEMORYBATCH STRUCTURE: Overlays the first block of a     */
+/*   batch of MEMORY_CACHE_BATCH free blocks handed to the  */
+/*   shared memory table. The blocks of the batch stay      */
+/*   linked, so the batch can be moved to another cache     */
+/*   without walking its blocks. Only blocks large enough   */
+/*   for the structure are kept in batches.                 */
+/************************************************************/
+struct memoryBatch
+  {
+   struct memoryPtr *next;
+   struct memoryBatch *nextBatch;
+  };
+
+/************************************************************/
+/* MEMORYCACHE STRUCTURE: The free blocks and the memory    */
+/*   statistics of one thread using an environment. Caches  */
+/*   are linked to the execution status of their thread.    */
+/************************************************************/
+struct memoryCache
+  {
+   void *environment;
+   struct executionStatus *owner;
+   long int MemoryAmount;
+   long int MemoryCalls;
+   struct memoryPtr *TempMemoryPtr;
+   size_t TempSize;
+   struct memoryCache *prev;
+   struct memoryCache *next;
+   unsigned short count[MEM_TABLE_SIZE];
+   struct memoryPtr *freeList[MEM_TABLE_SIZE];
+  };
+
+/*==========================================================*/
+/* Blocks smaller than MEM_TABLE_SIZE are recycled through  */
+/* a cache owned by the calling thread. The caches exchange */
+/* blocks with the shared memory table in batches. Taking a */
+/* block from or returning it to the cache is done inline,  */
+/* everything else by GetPooledMemory/ReturnPooledMemory.   */
+/*==========================================================*/
+
+#define ThreadCache(theEnv,execStatus) \
+  (((execStatus) != NULL) && ((execStatus)->MemoryCache != NULL) && \
+   ((execStatus)->MemoryCache->environment == (theEnv)))
+
+#define CachedBlock(theEnv,execStatus,size) \
+  (ThreadCache(theEnv,execStatus) && \
+   (((execStatus)->MemoryCache->TempMemoryPtr = (execStatus)->MemoryCache->freeList[size]) != NULL))
+
+#define PopCachedBlock(execStatus,size) \
+  ((execStatus)->MemoryCache->freeList[size] = (execStatus)->MemoryCache->TempMemoryPtr->next, \
+   (execStatus)->MemoryCache->count[size]--, \
+   (void *) (execStatus)->MemoryCache->TempMemoryPtr)
+
+#define PushCachedBlock(execStatus,size,ptr) \
+  ((execStatus)->MemoryCache->TempSize = (size), \
+   (execStatus)->MemoryCache->TempMemoryPtr = (struct memoryPtr *) (ptr), \
+   (execStatus)->MemoryCache->TempMemoryPtr->next = (execStatus)->MemoryCache->freeList[(execStatus)->MemoryCache->TempSize], \
+   (execStatus)->MemoryCache->freeList[(execStatus)->MemoryCache->TempSize] = (execStatus)->MemoryCache->TempMemoryPtr, \
+   (execStatus)->MemoryCache->count[(execStatus)->MemoryCache->TempSize]++)
 
 #define get_struct(theEnv,execStatus,type) \
-  ((MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type)] == NULL) \
-    ? ((struct type *) genalloc(theEnv,execStatus,sizeof(struct type))) \
-    : ((MemoryData(theEnv,execStatus)->TempMemoryPtr = MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type)]),\
-    MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type)] = MemoryData(theEnv,execStatus)->TempMemoryPtr->next,\
-    ((struct type *) MemoryData(theEnv,execStatus)->TempMemoryPtr)))
+  ((struct type *) (CachedBlock(theEnv,execStatus,sizeof(struct type)) \
+    ? PopCachedBlock(execStatus,sizeof(struct type)) \
+    : GetPooledMemory(theEnv,execStatus,sizeof(struct type))))
 
 #define rtn_struct(theEnv,execStatus,type,struct_ptr) \
-  (MemoryData(theEnv,execStatus)->TempMemoryPtr = (struct memoryPtr *) struct_ptr,\
-   MemoryData(theEnv,execStatus)->TempMemoryPtr->next = MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type)], \
-   MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type)] = MemoryData(theEnv,execStatus)->TempMemoryPtr)
+  rtn_mem(theEnv,execStatus,sizeof(struct type),struct_ptr)
 
 #define rtn_sized_struct(theEnv,execStatus,size,struct_ptr) \
-  (MemoryData(theEnv,execStatus)->TempMemoryPtr = (struct memoryPtr *) struct_ptr,\
-   MemoryData(theEnv,execStatus)->TempMemoryPtr->next = MemoryData(theEnv,execStatus)->MemoryTable[size], \
-   MemoryData(theEnv,execStatus)->MemoryTable[size] = MemoryData(theEnv,execStatus)->TempMemoryPtr)
+  rtn_mem(theEnv,execStatus,size,struct_ptr)
 
 #define get_var_struct(theEnv,execStatus,type,vsize) \
-  ((((sizeof(struct type) + vsize) <  MEM_TABLE_SIZE) ? \
-    (MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type) + vsize] == NULL) : 1) ? \
-   ((struct type *) genalloc(theEnv,execStatus,(sizeof(struct type) + vsize))) :\
-   ((MemoryData(theEnv,execStatus)->TempMemoryPtr = MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type) + vsize]),\
-    MemoryData(theEnv,execStatus)->MemoryTable[sizeof(struct type) + vsize] = MemoryData(theEnv,execStatus)->TempMemoryPtr->next,\
-    ((struct type *) MemoryData(theEnv,execStatus)->TempMemoryPtr)))
+  ((struct type *) get_mem(theEnv,execStatus,(sizeof(struct type) + vsize)))
 
 #define rtn_var_struct(theEnv,execStatus,type,vsize,struct_ptr) \
-  (MemoryData(theEnv,execStatus)->TempSize = sizeof(struct type) + vsize, \
-   ((MemoryData(theEnv,execStatus)->TempSize < MEM_TABLE_SIZE) ? \
-    (MemoryData(theEnv,execStatus)->TempMemoryPtr = (struct memoryPtr *) struct_ptr,\
-     MemoryData(theEnv,execStatus)->TempMemoryPtr->next = MemoryData(theEnv,execStatus)->MemoryTable[MemoryData(theEnv,execStatus)->TempSize], \
-     MemoryData(theEnv,execStatus)->MemoryTable[MemoryData(theEnv,execStatus)->TempSize] =  MemoryData(theEnv,execStatus)->TempMemoryPtr) : \
-    (genfree(theEnv,execStatus,(void *) struct_ptr,MemoryData(theEnv,execStatus)->TempSize),(struct memoryPtr *) struct_ptr)))
+  rtn_mem(theEnv,execStatus,(sizeof(struct type) + vsize),struct_ptr)
 
 #define get_mem(theEnv,execStatus,size) \
-  (((size <  MEM_TABLE_SIZE) ? \
-    (MemoryData(theEnv,execStatus)->MemoryTable[size] == NULL) : 1) ? \
-   ((struct type *) genalloc(theEnv,execStatus,(size_t) (size))) :\
-   ((MemoryData(theEnv,execStatus)->TempMemoryPtr = MemoryData(theEnv,execStatus)->MemoryTable[size]),\
-    MemoryData(theEnv,execStatus)->MemoryTable[size] = MemoryData(theEnv,execStatus)->TempMemoryPtr->next,\
-    ((struct type *) MemoryData(theEnv,execStatus)->TempMemoryPtr)))
+  ((((size_t) (size) < MEM_TABLE_SIZE) && CachedBlock(theEnv,execStatus,size)) \
+    ? PopCachedBlock(execStatus,size) \
+    : GetPooledMemory(theEnv,execStatus,(size_t) (size)))
 
 #define rtn_mem(theEnv,execStatus,size,ptr) \
-  (MemoryData(theEnv,execStatus)->TempSize = size, \
-   ((MemoryData(theEnv,execStatus)->TempSize < MEM_TABLE_SIZE) ? \
-    (MemoryData(theEnv,execStatus)->TempMemoryPtr = (struct memoryPtr *) ptr,\
-     MemoryData(theEnv,execStatus)->TempMemoryPtr->next = MemoryData(theEnv,execStatus)->MemoryTable[MemoryData(theEnv,execStatus)->TempSize], \
-     MemoryData(theEnv,execStatus)->MemoryTable[MemoryData(theEnv,execStatus)->TempSize] =  MemoryData(theEnv,execStatus)->TempMemoryPtr) : \
-    (genfree(theEnv,execStatus,(void *) ptr,MemoryData(theEnv,execStatus)->TempSize),(struct memoryPtr *) ptr)))
+  ((((size_t) (size) < MEM_TABLE_SIZE) && ThreadCache(theEnv,execStatus) && \
+    ((execStatus)->MemoryCache->count[size] < MEMORY_CACHE_LIMIT)) \
+    ? (void) PushCachedBlock(execStatus,size,ptr) \
+    : ReturnPooledMemory(theEnv,execStatus,(void *) (ptr),(size_t) (size)))
 
 #define GenCopyMemory(type,cnt,dst,src) \
    memcpy((void *) (dst),(void *) (src),sizeof(type) * (size_t) (cnt))
@@ -133,9 +186,10 @@ struct memoryData
    int ChunkInfoSize;
    int BlockMemoryInitialized;
 #endif
-   struct memoryPtr *TempMemoryPtr;
    struct memoryPtr **MemoryTable;
-   size_t TempSize;
+   struct memoryBatch **BatchTable;
+   apr_thread_mutex_t *TableLock;
+   struct memoryCache *ListOfCaches;
   };
 
 #define MemoryData(theEnv,execStatus) ((struct memoryData *) GetEnvironmentData(theEnv,execStatus,MEMORY_DATA))
@@ -172,6 +226,10 @@ struct memoryData
    LOCALE intBool                        EnvGetConserveMemory(void *,EXEC_STATUS);
    LOCALE void                           genmemcpy(char *,char *,unsigned long);
    LOCALE void                           ReturnAllBlocks(void *,EXEC_STATUS);
+   LOCALE void                          *GetPooledMemory(void *,EXEC_STATUS,size_t);
+   LOCALE void                           ReturnPooledMemory(void *,EXEC_STATUS,void *,size_t);
+   LOCALE void                           ReleaseMemoryCache(void *,EXEC_STATUS);
+   LOCALE void                           ReleaseAllMemoryCaches(void *,EXEC_STATUS);
 
 #endif
 
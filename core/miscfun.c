@@ -102,6 +102,9 @@ globle void MiscFunctionDefinitions(
    EnvDefineFunction2(theEnv,execStatus,"mem-used",         'g', PTIEF MemUsedCommand,      "MemUsedCommand", "00");
    EnvDefineFunction2(theEnv,execStatus,"mem-requests",     'g', PTIEF MemRequestsCommand,  "MemRequestsCommand", "00");
 #endif
+   EnvDefineFunction2(theEnv,execStatus,"set-gc-time-budget",'g', PTIEF SetGCTimeBudgetCommand,"SetGCTimeBudgetCommand", "11i");
+   EnvDefineFunction2(theEnv,execStatus,"get-gc-time-budget",'g', PTIEF GetGCTimeBudgetCommand,"GetGCTimeBudgetCommand", "00");
+   EnvDefineFunction2(theEnv,execStatus,"gc-stats",         'v', PTIEF GCStatsCommand,      "GCStatsCommand", "00");
    EnvDefineFunction2(theEnv,execStatus,"options",          'v', PTIEF OptionsCommand,      "OptionsCommand", "00");
    EnvDefineFunction2(theEnv,execStatus,"operating-system", 'w', PTIEF OperatingSystemFunction,"OperatingSystemFunction", "00");
    EnvDefineFunction2(theEnv,execStatus,"(expansion-call)", 'u', PTIEF ExpandFuncCall,      "ExpandFuncCall",NULL);
@@ -501,6 +504,98 @@ globle long long MemRequestsCommand(
 
 #endif
 
+/**********************************************/
+/* SetGCTimeBudgetCommand: H/L access routine */
+/*   for the set-gc-time-budget command.      */
+/**********************************************/
+globle long long SetGCTimeBudgetCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   long long oldValue, newValue;
+   DATA_OBJECT argPtr;
+
+   oldValue = (long long) EnvGetGarbageCollectionTimeBudget(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"set-gc-time-budget",EXACTLY,1) == -1)
+     { return(oldValue); }
+
+   if (EnvArgTypeCheck(theEnv,execStatus,"set-gc-time-budget",1,INTEGER,&argPtr) == FALSE)
+     { return(oldValue); }
+
+   newValue = DOToLong(argPtr);
+   if (newValue < 0LL)
+     {
+      ExpectedTypeError1(theEnv,execStatus,"set-gc-time-budget",1,"integer (greater than or equal to 0)");
+      return(oldValue);
+     }
+
+   EnvSetGarbageCollectionTimeBudget(theEnv,execStatus,(long) newValue);
+
+   return(oldValue);
+  }
+
+/**********************************************/
+/* GetGCTimeBudgetCommand: H/L access routine */
+/*   for the get-gc-time-budget command.      */
+/**********************************************/
+globle long long GetGCTimeBudgetCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (EnvArgCountCheck(theEnv,execStatus,"get-gc-time-budget",EXACTLY,0) == -1)
+     { return(0LL); }
+
+   return((long long) EnvGetGarbageCollectionTimeBudget(theEnv,execStatus));
+  }
+
+/**************************************/
+/* GCStatsCommand: H/L access routine */
+/*   for the gc-stats command.        */
+/**************************************/
+globle void GCStatsCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct garbageCollectionStatistics theStatistics;
+   char printSpace[120];
+   long long collections;
+   static char *pauseClasses[GC_PAUSE_CLASSES] =
+     { "<= 0.1 ms", "<= 1 ms", "<= 10 ms", "<= 100 ms", "> 100 ms" };
+   int i;
+
+   if (EnvArgCountCheck(theEnv,execStatus,"gc-stats",EXACTLY,0) == -1) return;
+
+   EnvGetGarbageCollectionStatistics(theEnv,execStatus,&theStatistics);
+
+   collections = theStatistics.fullCollections + theStatistics.incrementalSteps;
+
+   gensprintf(printSpace,"Full collections:  %12lld\n",theStatistics.fullCollections);
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+   gensprintf(printSpace,"Incremental steps: %12lld\n",theStatistics.incrementalSteps);
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+   gensprintf(printSpace,"Completed cycles:  %12lld\n",theStatistics.completedCycles);
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+   gensprintf(printSpace,"Items scanned:     %12lld\n",theStatistics.itemsScanned);
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+   gensprintf(printSpace,"Ephemeral items:   %12ld (%ld bytes)\n",
+              UtilityData(theEnv,execStatus)->EphemeralItemCount,
+              UtilityData(theEnv,execStatus)->EphemeralItemSize);
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+
+   gensprintf(printSpace,"Pause time:        %12.6f total %12.6f average %12.6f longest %12.6f last\n",
+              theStatistics.totalPause,
+              (collections > 0) ? (theStatistics.totalPause / (double) collections) : 0.0,
+              theStatistics.longestPause,theStatistics.lastPause);
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+
+   for (i = 0; i < GC_PAUSE_CLASSES; i++)
+     {
+      gensprintf(printSpace,"Pauses %-10s %12lld\n",pauseClasses[i],theStatistics.pauses[i]);
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+     }
+  }
+
 /****************************************/
 /* AproposCommand: H/L access routine   */
 /*   for the apropos command.           */
@@ -698,6 +793,20 @@ EnvPrintRouter(theEnv,execStatus,WDISPLAY,"  Binary saving of instances is ");
   EnvPrintRouter(theEnv,execStatus,WDISPLAY,"OFF\n");
 #endif
 
+EnvPrintRouter(theEnv,execStatus,WDISPLAY,"  Binary loading of facts is ");
+#if BLOAD_FACTS
+  EnvPrintRouter(theEnv,execStatus,WDISPLAY,"ON\n");
+#else
+  EnvPrintRouter(theEnv,execStatus,WDISPLAY,"OFF\n");
+#endif
+
+EnvPrintRouter(theEnv,execStatus,WDISPLAY,"  Binary saving of facts is ");
+#if BSAVE_FACTS
+  EnvPrintRouter(theEnv,execStatus,WDISPLAY,"ON\n");
+#else
+  EnvPrintRouter(theEnv,execStatus,WDISPLAY,"OFF\n");
+#endif
+
 #endif
 
 EnvPrintRouter(theEnv,execStatus,WDISPLAY,"Extended math function package is ");
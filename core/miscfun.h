@@ -48,6 +48,9 @@
    LOCALE long long                      ReleaseMemCommand(void *,EXEC_STATUS);
    LOCALE long long                      MemUsedCommand(void *,EXEC_STATUS);
    LOCALE long long                      MemRequestsCommand(void *,EXEC_STATUS);
+   LOCALE long long                      SetGCTimeBudgetCommand(void *,EXEC_STATUS);
+   LOCALE long long                      GetGCTimeBudgetCommand(void *,EXEC_STATUS);
+   LOCALE void                           GCStatsCommand(void *,EXEC_STATUS);
    LOCALE void                           OptionsCommand(void *,EXEC_STATUS);
    LOCALE void                          *OperatingSystemFunction(void *,EXEC_STATUS);
    LOCALE void                           ExpandFuncCall(void *,EXEC_STATUS,DATA_OBJECT *);
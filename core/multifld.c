@@ -51,6 +51,8 @@
 /***************************************/
 
    static void                    DeallocateMultifieldData(void *,EXEC_STATUS);
+   static void                    ReturnMultifieldList(void *,EXEC_STATUS,struct multifield *);
+   static struct multifield      *AppendMultifieldList(struct multifield *,struct multifield *);
 
 /***************************************************/
 /* InitializeMultifieldData: Allocates environment */
@@ -71,9 +73,21 @@ static void DeallocateMultifieldData(
   void *theEnv,
   EXEC_STATUS)
   {
-   struct multifield *tmpPtr, *nextPtr; 
+   ReturnMultifieldList(theEnv,execStatus,MultifieldData(theEnv,execStatus)->ListOfMultifields);
+   ReturnMultifieldList(theEnv,execStatus,MultifieldData(theEnv,execStatus)->ScannedMultifields);
+   ReturnMultifieldList(theEnv,execStatus,MultifieldData(theEnv,execStatus)->TenuredMultifields);
+  }
+
+/********************************************************/
+/* ReturnMultifieldList: Returns a list of multifields. */
+/********************************************************/
+static void ReturnMultifieldList(
+  void *theEnv,
+  EXEC_STATUS,
+  struct multifield *tmpPtr)
+  {
+   struct multifield *nextPtr; 
    
-   tmpPtr = MultifieldData(theEnv,execStatus)->ListOfMultifields;
    while (tmpPtr != NULL)
      {
       nextPtr = tmpPtr->next;
@@ -310,20 +324,48 @@ globle void AddToMultifieldList(
    UtilityData(theEnv,execStatus)->EphemeralItemSize += sizeof(struct multifield) + (sizeof(struct field) * theSegment->multifieldLength);
   }
 
-/***********************************************************/
-/* FlushMultifields:                                         */
-/***********************************************************/
-globle void FlushMultifields(
+/*************************************************************/
+/* FlushMultifields: Returns the ephemeral multifields which */
+/*   are no longer in use to the pool of free memory. A      */
+/*   garbage collection cycle takes the new multifields over */
+/*   as the multifields to scan, together with the tenured   */
+/*   ones if the evaluation depth has dropped below the      */
+/*   deepest of them. Multifields created at or below the    */
+/*   current evaluation depth are tenured, busy multifields  */
+/*   are scanned again by the next cycle. Returns FALSE if   */
+/*   the budget of the garbage collection ran out before the */
+/*   scan was completed.                                     */
+/*************************************************************/
+globle intBool FlushMultifields(
   void *theEnv,
   EXEC_STATUS)
   {
-   struct multifield *theSegment, *nextPtr, *lastPtr = NULL;
+   struct multifieldData *theData = MultifieldData(theEnv,execStatus);
+   struct multifield *theSegment;
    unsigned long newSize;
 
-   theSegment = MultifieldData(theEnv,execStatus)->ListOfMultifields;
-   while (theSegment != NULL)
+   if (GarbageCollectionCycleStart(theEnv,execStatus))
+     {
+      theData->ScannedMultifields = AppendMultifieldList(theData->ListOfMultifields,
+                                                         theData->ScannedMultifields);
+      theData->ListOfMultifields = NULL;
+
+      if ((theData->TenuredMultifields != NULL) &&
+          (theData->TenuredMultifieldDepth > execStatus->CurrentEvaluationDepth))
+        {
+         theData->ScannedMultifields = AppendMultifieldList(theData->TenuredMultifields,
+                                                            theData->ScannedMultifields);
+         theData->TenuredMultifields = NULL;
+        }
+     }
+
+   while ((theSegment = theData->ScannedMultifields) != NULL)
      {
-      nextPtr = theSegment->next;
+      if (! GarbageCollectionBudgetLeft(theEnv,execStatus))
+        { return(FALSE); }
+
+      theData->ScannedMultifields = theSegment->next;
+
       if ((theSegment->depth > execStatus->CurrentEvaluationDepth) && (theSegment->busyCount == 0))
         {
          UtilityData(theEnv,execStatus)->EphemeralItemCount--;
@@ -332,14 +374,46 @@ globle void FlushMultifields(
          if (theSegment->multifieldLength == 0) newSize = 1;
          else newSize = theSegment->multifieldLength;
          rtn_var_struct(theEnv,execStatus,multifield,sizeof(struct field) * (newSize - 1),theSegment);
-         if (lastPtr == NULL) MultifieldData(theEnv,execStatus)->ListOfMultifields = nextPtr;
-         else lastPtr->next = nextPtr;
+        }
+      else if (theSegment->depth > execStatus->CurrentEvaluationDepth)
+        {
+         theSegment->next = theData->ListOfMultifields;
+         theData->ListOfMultifields = theSegment;
         }
       else
-        { lastPtr = theSegment; }
+        {
+         if ((theData->TenuredMultifields == NULL) ||
+             (theSegment->depth > theData->TenuredMultifieldDepth))
+           { theData->TenuredMultifieldDepth = theSegment->depth; }
 
-      theSegment = nextPtr;
+         theSegment->next = theData->TenuredMultifields;
+         theData->TenuredMultifields = theSegment;
+        }
      }
+
+   return(TRUE);
+  }
+
+/****************************************************/
+/* AppendMultifieldList: Appends the second list of */
+/*   multifields to the first and returns the       */
+/*   combined list.                                 */
+/****************************************************/
+static struct multifield *AppendMultifieldList(
+  struct multifield *theList,
+  struct multifield *theTail)
+  {
+   struct multifield *theSegment;
+
+   if (theList == NULL) return(theTail);
+   if (theTail == NULL) return(theList);
+
+   for (theSegment = theList; theSegment->next != NULL; theSegment = theSegment->next)
+     { /* Do Nothing */ }
+
+   theSegment->next = theTail;
+
+   return(theList);
   }
 
 /*********************************************************************/
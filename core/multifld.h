@@ -78,6 +78,9 @@ typedef struct field * FIELD_PTR;
 struct multifieldData
   { 
    struct multifield *ListOfMultifields;
+   struct multifield *ScannedMultifields;
+   struct multifield *TenuredMultifields;
+   int TenuredMultifieldDepth;
   };
 
 #define MultifieldData(theEnv,execStatus) ((struct multifieldData *) GetEnvironmentData(theEnv,execStatus,MULTIFIELD_DATA))
@@ -101,7 +104,7 @@ struct multifieldData
    LOCALE struct multifield             *StringToMultifield(void *,EXEC_STATUS,char *);
    LOCALE void                          *EnvCreateMultifield(void *,EXEC_STATUS,long);
    LOCALE void                           AddToMultifieldList(void *,EXEC_STATUS,struct multifield *);
-   LOCALE void                           FlushMultifields(void *,EXEC_STATUS);
+   LOCALE intBool                        FlushMultifields(void *,EXEC_STATUS);
    LOCALE void                           DuplicateMultifield(void *,EXEC_STATUS,struct dataObject *,struct dataObject *);
    LOCALE void                           PrintMultifield(void *,EXEC_STATUS,char *,SEGMENT_PTR,long,long,int);
    LOCALE intBool                        MultifieldDOsEqual(DATA_OBJECT_PTR,DATA_OBJECT_PTR);
@@ -0,0 +1,327 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*              NETWORK STATISTICS MODULE              */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Provides the network-stats command and the C     */
+/*   access routines for the counters kept for deftemplates  */
+/*   and joins. A deftemplate counts the asserts, retracts,  */
+/*   and in place modifies of its facts, the alpha matches   */
+/*   of its facts, and the time spent matching its facts on  */
+/*   the thread which asserted, modified, or retracted them. */
+/*   A join counts the partial matches entering it from the  */
+/*   left and from the right, the comparisons between them,  */
+/*   and the partial matches added to and deleted from its   */
+/*   memories. The sizes of the memories are determined      */
+/*   when the statistics are requested. The counters are     */
+/*   updated without locking, so they may fall short while   */
+/*   facts are matched on several threads.                   */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _NETSTATS_SOURCE_
+
+#include <stdio.h>
+#define _STDIO_INCLUDED_
+
+#include "setup.h"
+
+#if DEFRULE_CONSTRUCT
+
+#include "argacces.h"
+#include "envrnmnt.h"
+#include "extnfunc.h"
+#include "memalloc.h"
+#include "reteutil.h"
+#include "router.h"
+#include "ruledef.h"
+#include "sysdep.h"
+#include "fact/fact_scheduler.h"
+
+#if DEFTEMPLATE_CONSTRUCT
+#include "tmpltdef.h"
+#endif
+
+#include "netstats.h"
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static long                    CollectJoinStatistics(void *,EXEC_STATUS,struct joinNode *,
+                                                        struct joinStatistics *,long,long);
+   static void                    BetaMemoryStatistics(struct betaMemory *,unsigned long *,
+                                                       unsigned long *,unsigned long *);
+#if DEFTEMPLATE_CONSTRUCT
+   static void                    PrintDeftemplateStatistics(void *,EXEC_STATUS);
+#endif
+   static void                    PrintJoinStatistics(void *,EXEC_STATUS);
+
+/****************************************************/
+/* NetworkStatisticsCommands: Initializes the       */
+/*   network statistics commands and functions.     */
+/****************************************************/
+globle void NetworkStatisticsCommands(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+#if ! RUN_TIME
+   EnvDefineFunction2(theEnv,execStatus,"network-stats",'v',PTIEF NetworkStatsCommand,"NetworkStatsCommand","00");
+#else
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus)
+#endif
+#endif
+  }
+
+/*******************************************/
+/* NetworkStatsCommand: H/L access routine */
+/*   for the network-stats command.        */
+/*******************************************/
+globle void NetworkStatsCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   if (EnvArgCountCheck(theEnv,execStatus,"network-stats",EXACTLY,0) == -1) return;
+
+   WaitForMatchingTasks(theEnv,execStatus);
+
+#if DEFTEMPLATE_CONSTRUCT
+   PrintDeftemplateStatistics(theEnv,execStatus);
+#endif
+   PrintJoinStatistics(theEnv,execStatus);
+  }
+
+#if DEFTEMPLATE_CONSTRUCT
+
+/************************************************/
+/* EnvGetDeftemplateStatistics: C access        */
+/*   routine for the counters of a deftemplate. */
+/************************************************/
+globle void EnvGetDeftemplateStatistics(
+  void *theEnv,
+  EXEC_STATUS,
+  void *theDeftemplate,
+  struct deftemplateStatistics *theStatistics)
+  {
+   WaitForMatchingTasks(theEnv,execStatus);
+
+   *theStatistics = ((struct deftemplate *) theDeftemplate)->statistics;
+  }
+
+#endif
+
+/************************************************************/
+/* EnvGetJoinStatistics: C access routine for the counters  */
+/*   of the joins of a defrule, including the joins of its  */
+/*   disjuncts. Up to maxJoins entries are stored in        */
+/*   theStatistics, ordered from the first join of each     */
+/*   disjunct to its last. Returns the number of joins,     */
+/*   which may be larger than maxJoins.                     */
+/************************************************************/
+globle long EnvGetJoinStatistics(
+  void *theEnv,
+  EXEC_STATUS,
+  void *theRule,
+  struct joinStatistics *theStatistics,
+  long maxJoins)
+  {
+   struct defrule *rulePtr;
+   long count = 0;
+
+   WaitForMatchingTasks(theEnv,execStatus);
+
+   for (rulePtr = (struct defrule *) theRule;
+        rulePtr != NULL;
+        rulePtr = rulePtr->disjunct)
+     { count = CollectJoinStatistics(theEnv,execStatus,rulePtr->lastJoin,theStatistics,maxJoins,count); }
+
+   return(count);
+  }
+
+/****************************************************************/
+/* CollectJoinStatistics: Stores the statistics of a join after */
+/*   those of the joins preceding it, which are the joins on    */
+/*   its left and, for a join from the right, the joins of the  */
+/*   subnetwork on its right. Returns the new number of joins.  */
+/****************************************************************/
+static long CollectJoinStatistics(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin,
+  struct joinStatistics *theStatistics,
+  long maxJoins,
+  long count)
+  {
+   struct joinStatistics *theEntry;
+
+   if (theJoin == NULL)
+     { return(count); }
+
+   count = CollectJoinStatistics(theEnv,execStatus,theJoin->lastLevel,theStatistics,maxJoins,count);
+
+   if (theJoin->joinFromTheRight)
+     {
+      count = CollectJoinStatistics(theEnv,execStatus,(struct joinNode *) theJoin->rightSideEntryStructure,
+                                    theStatistics,maxJoins,count);
+     }
+
+   if (count < maxJoins)
+     {
+      theEntry = &theStatistics[count];
+
+      theEntry->depth = (unsigned short) theJoin->depth;
+      theEntry->leftActivations = theJoin->leftActivations;
+      theEntry->rightActivations = theJoin->rightActivations;
+      theEntry->comparisons = theJoin->memoryCompares;
+      theEntry->memoryAdds = theJoin->memoryAdds;
+      theEntry->memoryDeletes = theJoin->memoryDeletes;
+
+      CompleteBetaMemoryResize(theEnv,execStatus,theJoin);
+
+      BetaMemoryStatistics(theJoin->leftMemory,&theEntry->leftCount,
+                           &theEntry->leftBuckets,&theEntry->leftLongestChain);
+      BetaMemoryStatistics(theJoin->rightMemory,&theEntry->rightCount,
+                           &theEntry->rightBuckets,&theEntry->rightLongestChain);
+     }
+
+   return(count + 1);
+  }
+
+/*************************************************************/
+/* BetaMemoryStatistics: Determines the number of partial    */
+/*   matches in a beta memory, its number of buckets, and    */
+/*   the number of partial matches in its longest bucket.    */
+/*************************************************************/
+static void BetaMemoryStatistics(
+  struct betaMemory *theMemory,
+  unsigned long *count,
+  unsigned long *buckets,
+  unsigned long *longestChain)
+  {
+   struct partialMatch *listOfMatches;
+   unsigned long b, length;
+
+   *count = 0;
+   *buckets = 0;
+   *longestChain = 0;
+
+   if (theMemory == NULL)
+     { return; }
+
+   *buckets = theMemory->size;
+
+   for (b = 0; b < theMemory->size; b++)
+     {
+      length = 0;
+      for (listOfMatches = theMemory->beta[b];
+           listOfMatches != NULL;
+           listOfMatches = listOfMatches->nextInMemory)
+        { length++; }
+
+      *count += length;
+      if (length > *longestChain)
+        { *longestChain = length; }
+     }
+  }
+
+#if DEFTEMPLATE_CONSTRUCT
+
+/**************************************************************/
+/* PrintDeftemplateStatistics: Prints the counters of each    */
+/*   deftemplate of the current module which has had a fact.  */
+/**************************************************************/
+static void PrintDeftemplateStatistics(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct deftemplate *theDeftemplate;
+   struct deftemplateStatistics *theStatistics;
+   char printSpace[120];
+   int headerPrinted = FALSE;
+
+   for (theDeftemplate = (struct deftemplate *) EnvGetNextDeftemplate(theEnv,execStatus,NULL);
+        theDeftemplate != NULL;
+        theDeftemplate = (struct deftemplate *) EnvGetNextDeftemplate(theEnv,execStatus,theDeftemplate))
+     {
+      theStatistics = &theDeftemplate->statistics;
+      if ((theStatistics->asserts == 0) && (theStatistics->modifies == 0))
+        { continue; }
+
+      if (! headerPrinted)
+        {
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,
+                        "   Asserts  Retracts  Modifies  Alpha hits  Match time  Deftemplate\n");
+         headerPrinted = TRUE;
+        }
+
+      gensprintf(printSpace,"%10lld%10lld%10lld%12lld%12.6f  ",
+                 theStatistics->asserts,theStatistics->retracts,theStatistics->modifies,
+                 theStatistics->alphaMatches,theStatistics->matchTime);
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,ValueToString(theDeftemplate->header.name));
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,"\n");
+     }
+  }
+
+#endif
+
+/*************************************************************/
+/* PrintJoinStatistics: Prints the statistics of the joins   */
+/*   of each defrule of the current module. Joins shared by  */
+/*   several defrules are printed for each of them.          */
+/*************************************************************/
+static void PrintJoinStatistics(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct defrule *theDefrule;
+   struct joinStatistics *theStatistics;
+   char printSpace[120];
+   long count, i;
+
+   for (theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,NULL);
+        theDefrule != NULL;
+        theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,theDefrule))
+     {
+      count = EnvGetJoinStatistics(theEnv,execStatus,theDefrule,NULL,0);
+      if (count == 0) continue;
+
+      theStatistics = (struct joinStatistics *)
+                      genalloc(theEnv,execStatus,sizeof(struct joinStatistics) * (size_t) count);
+      EnvGetJoinStatistics(theEnv,execStatus,theDefrule,theStatistics,count);
+
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,"Defrule ");
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,ValueToString(theDefrule->header.name));
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,"\n");
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,
+                     "   Depth   Left in  Right in  Compares      Adds   Deletes"
+                     "  Left mem (chain)  Right mem (chain)\n");
+
+      for (i = 0; i < count; i++)
+        {
+         gensprintf(printSpace,"%8u%10lld%10lld%10lld%10lld%10lld%10lu (%5lu)%11lu (%5lu)\n",
+                    (unsigned) theStatistics[i].depth,
+                    theStatistics[i].leftActivations,theStatistics[i].rightActivations,
+                    theStatistics[i].comparisons,
+                    theStatistics[i].memoryAdds,theStatistics[i].memoryDeletes,
+                    theStatistics[i].leftCount,theStatistics[i].leftLongestChain,
+                    theStatistics[i].rightCount,theStatistics[i].rightLongestChain);
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,printSpace);
+        }
+
+      genfree(theEnv,execStatus,theStatistics,sizeof(struct joinStatistics) * (size_t) count);
+     }
+  }
+
+#endif /* DEFRULE_CONSTRUCT */
@@ -0,0 +1,83 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*          NETWORK STATISTICS HEADER FILE             */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Provides the network-stats command and the C     */
+/*   access routines for the counters kept for deftemplates  */
+/*   and joins.                                              */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_netstats
+
+#define _H_netstats
+
+struct joinStatistics;
+
+#ifndef _H_network
+#include "network.h"
+#endif
+#if DEFTEMPLATE_CONSTRUCT
+#ifndef _H_tmpltdef
+#include "tmpltdef.h"
+#endif
+#endif
+
+# include "execution_status.h"
+
+/*****************************************************/
+/* joinStatistics: The counters of a join and the    */
+/*   number of partial matches in its beta memories, */
+/*   the number of buckets of the memories, and the  */
+/*   length of their longest bucket.                 */
+/*****************************************************/
+struct joinStatistics
+  {
+   unsigned short depth;
+   long long leftActivations;
+   long long rightActivations;
+   long long comparisons;
+   long long memoryAdds;
+   long long memoryDeletes;
+   unsigned long leftCount;
+   unsigned long leftBuckets;
+   unsigned long leftLongestChain;
+   unsigned long rightCount;
+   unsigned long rightBuckets;
+   unsigned long rightLongestChain;
+  };
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _NETSTATS_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+#define GetJoinStatistics(a,b,c) EnvGetJoinStatistics(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b,c)
+#if DEFTEMPLATE_CONSTRUCT
+#define GetDeftemplateStatistics(a,b) EnvGetDeftemplateStatistics(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a,b)
+#endif
+
+   LOCALE void                           NetworkStatisticsCommands(void *,EXEC_STATUS);
+   LOCALE void                           NetworkStatsCommand(void *,EXEC_STATUS);
+   LOCALE long                           EnvGetJoinStatistics(void *,EXEC_STATUS,void *,struct joinStatistics *,long);
+#if DEFTEMPLATE_CONSTRUCT
+   LOCALE void                           EnvGetDeftemplateStatistics(void *,EXEC_STATUS,void *,struct deftemplateStatistics *);
+#endif
+
+#endif
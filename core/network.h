@@ -27,6 +27,7 @@
 struct patternNodeHeader;
 struct joinNode;
 struct alphaMemoryHash;
+struct joinRangeIndex;
 
 #ifndef _H_match
 #include "match.h"
@@ -36,6 +37,9 @@ struct alphaMemoryHash;
 #include "expressn.h"
 #endif
 
+# include <apr_atomic.h>
+# include <apr_thread_mutex.h>
+
 struct patternNodeHeader
   {
    struct alphaMemoryHash *firstHash;
@@ -81,7 +85,36 @@ typedef struct alphaMemoryHash ALPHA_MEMORY_HASH;
 #include "ruledef.h"
 #endif
 
-#define INITIAL_BETA_HASH_SIZE 17
+/*==========================================================*/
+/* The partial matches of a beta memory are guarded by one  */
+/* of BETA_MEMORY_LOCKS locks chosen by their hash value.   */
+/* Since a beta memory only ever grows (or shrinks back) to */
+/* a multiple of its initial size, the partial matches of a */
+/* bucket always share the same lock.                       */
+/*==========================================================*/
+
+#define BETA_MEMORY_LOCKS 17
+#define INITIAL_BETA_HASH_SIZE BETA_MEMORY_LOCKS
+
+/*==========================================================*/
+/* A beta memory is resized incrementally: the old buckets  */
+/* are kept until each of them has been moved to the new    */
+/* table. The old buckets guarded by the same lock form a   */
+/* stripe, which is moved in order by the threads holding   */
+/* that lock. A bucket has been moved once its index within */
+/* its stripe is lower than the stripe's moved count.       */
+/*==========================================================*/
+
+#define BETA_RESIZE_STEP 4
+
+struct betaResize
+  {
+   unsigned long oldSize;
+   struct partialMatch **oldBeta;
+   struct partialMatch **oldLast;
+   unsigned long moved[BETA_MEMORY_LOCKS];
+   volatile apr_uint32_t pendingStripes;
+  };
 
 struct betaMemory
   {
@@ -89,6 +122,13 @@ struct betaMemory
    unsigned long count;
    struct partialMatch **beta;
    struct partialMatch **last;
+   struct betaResize *resize;
+  };
+
+struct joinLocks
+  {
+   apr_thread_mutex_t *shard[BETA_MEMORY_LOCKS];
+   struct joinLocks *next;
   };
 
 struct joinLink
@@ -114,8 +154,15 @@ struct joinNode
    long long memoryAdds;
    long long memoryDeletes;
    long long memoryCompares;
+   long long leftActivations;
+   long long rightActivations;
+   long long profileEntries;
+   long long profileCompares;
+   double profileTime;
    struct betaMemory *leftMemory;
    struct betaMemory *rightMemory;
+   struct joinLocks *memoryLocks;
+   struct joinRangeIndex *rangeIndex;
    struct expr *networkTest;
    struct expr *secondaryNetworkTest;
    struct expr *leftHash;
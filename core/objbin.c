@@ -122,6 +122,8 @@ typedef struct bsaveSlotDescriptor
    unsigned publicVisibility    : 1;
    unsigned createReadAccessor  : 1;
    unsigned createWriteAccessor : 1;
+   unsigned indexed             : 1;
+   unsigned orderedIndex        : 1;
    long cls,
         slotName,
         defaultValue,
@@ -884,6 +886,8 @@ static void BsaveSlots(
       dummy_slot.publicVisibility = sp->publicVisibility;
       dummy_slot.createReadAccessor = sp->createReadAccessor;
       dummy_slot.createWriteAccessor = sp->createWriteAccessor;
+      dummy_slot.indexed = sp->indexed;
+      dummy_slot.orderedIndex = sp->orderedIndex;
       dummy_slot.cls = DefclassIndex(sp->cls);
       dummy_slot.slotName = SlotNameIndex(sp->slotName);
       dummy_slot.overrideMessage = (long) sp->overrideMessage->bucket;
@@ -1250,6 +1254,7 @@ static void UpdateDefclass(
    cls->busy = 0;
    cls->instanceList = NULL;
    cls->instanceListBottom = NULL;
+   cls->slotIndexList = NULL;
 #if DEFMODULE_CONSTRUCT
    cls->scopeMap = BitMapPointer(bcls->scopeMap);
    IncrementBitMapCount(cls->scopeMap);
@@ -1294,6 +1299,8 @@ static void UpdateSlot(
    sp->publicVisibility = bsp->publicVisibility;
    sp->createReadAccessor = bsp->createReadAccessor;
    sp->createWriteAccessor = bsp->createWriteAccessor;
+   sp->indexed = bsp->indexed;
+   sp->orderedIndex = bsp->orderedIndex;
    sp->cls = DefclassPointer(bsp->cls);
    sp->slotName = SlotNamePointer(bsp->slotName);
    sp->overrideMessage = SymbolPointer(bsp->overrideMessage);
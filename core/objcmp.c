@@ -957,7 +957,7 @@ static void SingleDefclassToCode(
    PrintClassReference(theEnv,execStatus,theFile,theDefclass->nxtHash,imageID,maxIndices);
    fprintf(theFile,",");
    PrintBitMapReference(theEnv,execStatus,theFile,theDefclass->scopeMap);
-   fprintf(theFile,",\"\"}");
+   fprintf(theFile,",\"\",NULL}");
   }
 
 /***********************************************************
@@ -1127,14 +1127,15 @@ static intBool SlotsToCode(
       sd = &theDefclass->slots[i];
       if (i > 0)
         fprintf(*slotFile,",\n");
-      fprintf(*slotFile,"{ %u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,",
+      fprintf(*slotFile,"{ %u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,",
                         sd->shared,sd->multiple,
                         sd->composite,sd->noInherit,
                         sd->noWrite,sd->initializeOnly,
                         sd->dynamicDefault,sd->defaultSpecified,
                         sd->noDefault,sd->reactive,
                         sd->publicVisibility,sd->createReadAccessor,
-                        sd->createWriteAccessor,sd->overrideMessageSpecified);
+                        sd->createWriteAccessor,sd->overrideMessageSpecified,
+                        sd->indexed,sd->orderedIndex);
       PrintClassReference(theEnv,execStatus,*slotFile,sd->cls,imageID,maxIndices);
       fprintf(*slotFile,",");
       PrintSlotNameReference(theEnv,execStatus,*slotFile,sd->slotName,imageID,maxIndices);
@@ -32,6 +32,9 @@ typedef struct messageHandler HANDLER;
 typedef struct instance INSTANCE_TYPE;
 typedef struct instanceSlot INSTANCE_SLOT;
 
+struct classSlotIndex;
+struct slotIndexEntry;
+
 /* Maximum # of simultaneous class hierarchy traversals
    should be a multiple of BITS_PER_BYTE and less than MAX_INT      */
 
@@ -114,6 +117,7 @@ struct defclass
    DEFCLASS *nxtHash;
    BITMAP_HN *scopeMap;
    char traversalRecord[TRAVERSAL_BYTES];
+   struct classSlotIndex *slotIndexList;
   };
 
 struct classLink
@@ -158,6 +162,8 @@ struct slotDescriptor
    unsigned createReadAccessor       : 1;
    unsigned createWriteAccessor      : 1;
    unsigned overrideMessageSpecified : 1;
+   unsigned indexed                  : 1;
+   unsigned orderedIndex             : 1;
    DEFCLASS *cls;
    SLOT_NAME *slotName;
    SYMBOL_HN *overrideMessage;
@@ -188,6 +194,7 @@ struct instance
                  *prvList,*nxtList;
    INSTANCE_SLOT **slotAddresses,
                  *slots;
+   struct slotIndexEntry *indexEntries;
   };
 
 struct messageHandler
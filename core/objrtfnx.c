@@ -1078,7 +1078,7 @@ static void GetPatternObjectAndMarks(
       *theMarkers =
         get_nth_pm_match(LocalEngineData(theEnv,execStatus).LHSBinds,pattern)->markers;
      }
-   else if ((((int) EngineData(theEnv,execStatus)->GlobalJoin->depth) - 1) == pattern)
+   else if ((((int) LocalEngineData(theEnv,execStatus).GlobalJoin->depth) - 1) == pattern)
      {
       *theInstance = (INSTANCE_TYPE *) 
         get_nth_pm_match(LocalEngineData(theEnv,execStatus).RHSBinds,0)->matchingItem;
@@ -0,0 +1,1118 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*             ORDERED JOIN MEMORY MODULE              */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Keeps the partial matches of joins with range    */
+/*   tests (<, >, <=, >=, or =) between the LHS and the RHS  */
+/*   sorted by the value tested, so that a partial match     */
+/*   entering the join is only compared with the partial     */
+/*   matches on the other side within the tested range.      */
+/*   Only joins of positive patterns whose memories are not  */
+/*   hashed are indexed. Once a join is indexed, the partial */
+/*   matches are added to its ordered memories when they     */
+/*   enter the join, with the bucket of the join locked, so  */
+/*   each pair of partial matches is compared exactly once   */
+/*   by the one of them entering the join last. The range    */
+/*   found for a partial match is only a filter: the join's  */
+/*   network test is still evaluated for each partial match  */
+/*   within it.                                              */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _ORDMEM_SOURCE_
+
+#include <stdio.h>
+#define _STDIO_INCLUDED_
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "setup.h"
+
+#if DEFRULE_CONSTRUCT
+
+#include "constant.h"
+#include "engine.h"
+#include "envrnmnt.h"
+#include "evaluatn.h"
+#include "extnfunc.h"
+#include "memalloc.h"
+#include "network.h"
+#include "reteutil.h"
+
+#if DEFTEMPLATE_CONSTRUCT
+#include "factgen.h"
+#endif
+
+#if OBJECT_SYSTEM
+#include "objrtfnx.h"
+#endif
+
+#include "ordmem.h"
+
+/***************************************/
+/* LOCAL INTERNAL CONSTANT DEFINITIONS */
+/***************************************/
+
+#define NO_SIDE       0
+#define LEFT_SIDE     1
+#define RIGHT_SIDE    2
+#define INVALID_SIDE  4
+
+#define RANGE_LT      0
+#define RANGE_LE      1
+#define RANGE_GT      2
+#define RANGE_GE      3
+#define RANGE_EQ      4
+
+#define INITIAL_ORDERED_SIZE 16
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static intBool                 IndexableJoin(struct joinNode *);
+   static int                     RangeRelation(struct expr *);
+   static int                     ExpressionSide(struct joinNode *,struct expr *);
+   static int                     VariableSide(struct joinNode *,struct expr *);
+   static intBool                 IsKeyVariable(struct expr *);
+   static struct expr            *OffsetVariable(struct expr *,double *);
+   static intBool                 ConstantValue(struct expr *,double *);
+   static intBool                 SameVariable(struct expr *,struct expr *);
+   static void                    FindRangeKeys(struct joinNode *,struct expr *,struct joinRangeIndex *);
+   static void                    FindRangeBounds(void *,EXEC_STATUS,struct joinNode *,struct expr *,struct joinRangeIndex *);
+   static void                    AddRangeBound(void *,EXEC_STATUS,struct orderedMemory *,struct expr *,double,int,int);
+   static intBool                 RangeValue(void *,EXEC_STATUS,struct expr *,double *);
+   static intBool                 PartialMatchValue(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *,
+                                                    int,struct expr *,double *);
+   static unsigned long           LowerBound(struct orderedMemory *,double);
+   static unsigned long           UpperBound(struct orderedMemory *,double);
+   static void                    AddOrderedEntry(void *,EXEC_STATUS,struct orderedMemory *,double,struct partialMatch *);
+   static void                    AddUnorderedEntry(void *,EXEC_STATUS,struct orderedMemory *,struct partialMatch *);
+   static intBool                 RemoveOrderedEntry(void *,EXEC_STATUS,struct orderedMemory *,unsigned long,
+                                                     unsigned long,struct partialMatch *);
+   static intBool                 RemoveUnorderedEntry(void *,EXEC_STATUS,struct orderedMemory *,struct partialMatch *);
+   static void                    ReturnOrderedMemory(void *,EXEC_STATUS,struct orderedMemory *);
+
+/**********************************************************/
+/* CreateJoinRangeIndex: Creates the ordered memories of  */
+/*   a join if its network test compares values from the  */
+/*   LHS and the RHS of the join with a range test. The   */
+/*   right memory is filled with the partial matches      */
+/*   already in the alpha memory of the join's pattern.   */
+/**********************************************************/
+globle void CreateJoinRangeIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join)
+  {
+   struct joinRangeIndex *theIndex;
+   struct alphaMemoryHash *theHash;
+   struct partialMatch *theMatch;
+   struct expr *theTest;
+
+   join->rangeIndex = NULL;
+
+   if (! IndexableJoin(join)) return;
+
+   theIndex = (struct joinRangeIndex *) genalloc(theEnv,execStatus,sizeof(struct joinRangeIndex));
+   memset(theIndex,0,sizeof(struct joinRangeIndex));
+
+   /*=====================================================*/
+   /* The keys are the first variables of each side found */
+   /* in a range test. Each test comparing a key with an  */
+   /* expression of the other side then bounds the range  */
+   /* of the key for the partial matches of that side.    */
+   /*=====================================================*/
+
+   if ((join->networkTest->type == FCALL) &&
+       (join->networkTest->value == ExpressionData(theEnv,execStatus)->PTR_AND))
+     {
+      for (theTest = join->networkTest->argList; theTest != NULL; theTest = theTest->nextArg)
+        { FindRangeKeys(join,theTest,theIndex); }
+      for (theTest = join->networkTest->argList; theTest != NULL; theTest = theTest->nextArg)
+        { FindRangeBounds(theEnv,execStatus,join,theTest,theIndex); }
+     }
+   else
+     {
+      FindRangeKeys(join,join->networkTest,theIndex);
+      FindRangeBounds(theEnv,execStatus,join,join->networkTest,theIndex);
+     }
+
+   if ((theIndex->left.bounds == NULL) && (theIndex->right.bounds == NULL))
+     {
+      genfree(theEnv,execStatus,theIndex,sizeof(struct joinRangeIndex));
+      return;
+     }
+
+   join->rangeIndex = theIndex;
+
+   /*======================================================*/
+   /* Partial matches entering the join from the RHS after */
+   /* this are added when they enter the join. The left    */
+   /* memory of a new join is filled by its LHS joins.     */
+   /*======================================================*/
+
+   for (theHash = ((struct patternNodeHeader *) join->rightSideEntryStructure)->firstHash;
+        theHash != NULL;
+        theHash = theHash->nextHash)
+     {
+      for (theMatch = theHash->alphaMemory;
+           theMatch != NULL;
+           theMatch = theMatch->nextInMemory)
+        { AddToRangeIndex(theEnv,execStatus,join,theMatch,RHS); }
+     }
+  }
+
+/*******************************************************/
+/* ReturnJoinRangeIndex: Frees the ordered memories of */
+/*   a join.                                           */
+/*******************************************************/
+globle void ReturnJoinRangeIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join)
+  {
+   if (join->rangeIndex == NULL) return;
+
+   ReturnOrderedMemory(theEnv,execStatus,&join->rangeIndex->left);
+   ReturnOrderedMemory(theEnv,execStatus,&join->rangeIndex->right);
+   genfree(theEnv,execStatus,join->rangeIndex,sizeof(struct joinRangeIndex));
+   join->rangeIndex = NULL;
+  }
+
+/**********************************************************/
+/* AddToRangeIndex: Adds a partial match entering a join  */
+/*   from the LHS or the RHS to the join's left or right  */
+/*   ordered memory. The bucket of the join must be       */
+/*   locked.                                              */
+/**********************************************************/
+globle void AddToRangeIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join,
+  struct partialMatch *theMatch,
+  int side)
+  {
+   struct orderedMemory *theMemory;
+   double key;
+
+   if (side == LHS)
+     { theMemory = &join->rangeIndex->left; }
+   else
+     { theMemory = &join->rangeIndex->right; }
+
+   if ((theMemory->key != NULL) &&
+       PartialMatchValue(theEnv,execStatus,join,theMatch,side,theMemory->key,&key))
+     { AddOrderedEntry(theEnv,execStatus,theMemory,key,theMatch); }
+   else
+     { AddUnorderedEntry(theEnv,execStatus,theMemory,theMatch); }
+  }
+
+/*********************************************************/
+/* RemoveFromRangeIndex: Removes a partial match leaving */
+/*   the left or right memory of a join from the join's  */
+/*   ordered memory. If the key of the partial match has */
+/*   changed since it was added (as the slots of an      */
+/*   instance may have), the memory is searched for it.  */
+/*********************************************************/
+globle void RemoveFromRangeIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join,
+  struct partialMatch *theMatch,
+  int side)
+  {
+   struct orderedMemory *theMemory;
+   double key;
+
+   if (side == LHS)
+     { theMemory = &join->rangeIndex->left; }
+   else
+     { theMemory = &join->rangeIndex->right; }
+
+   if ((theMemory->key != NULL) &&
+       PartialMatchValue(theEnv,execStatus,join,theMatch,side,theMemory->key,&key))
+     {
+      if (RemoveOrderedEntry(theEnv,execStatus,theMemory,LowerBound(theMemory,key),
+                             UpperBound(theMemory,key),theMatch))
+        { return; }
+     }
+   else if (RemoveUnorderedEntry(theEnv,execStatus,theMemory,theMatch))
+     { return; }
+
+   if (RemoveOrderedEntry(theEnv,execStatus,theMemory,0,theMemory->count,theMatch))
+     { return; }
+
+   RemoveUnorderedEntry(theEnv,execStatus,theMemory,theMatch);
+  }
+
+/*************************************************************/
+/* RemoveAlphaMatchFromRangeIndexes: Removes a partial match */
+/*   leaving an alpha memory from the right ordered memory   */
+/*   of each join entered from the pattern.                  */
+/*************************************************************/
+globle void RemoveAlphaMatchFromRangeIndexes(
+  void *theEnv,
+  EXEC_STATUS,
+  struct patternNodeHeader *theHeader,
+  struct partialMatch *theMatch)
+  {
+   struct joinNode *join;
+
+   for (join = theHeader->entryJoin;
+        join != NULL;
+        join = join->rightMatchNode)
+     {
+      if (join->rangeIndex != NULL)
+        { RemoveFromRangeIndex(theEnv,execStatus,join,theMatch,RHS); }
+     }
+  }
+
+/***********************************************************/
+/* StartRangeScan: Determines the partial matches of the   */
+/*   ordered memory opposite to the side from which a      */
+/*   partial match entered a join which are within the     */
+/*   range given by the bounds for the partial match. The  */
+/*   unordered partial matches are always part of a scan.  */
+/*   The bounds are widened slightly to allow for rounding */
+/*   when integers are compared as floats.                 */
+/***********************************************************/
+globle void StartRangeScan(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join,
+  struct partialMatch *theMatch,
+  int side,
+  struct rangeScan *theScan)
+  {
+   struct orderedMemory *theMemory;
+   struct rangeBound *theBound;
+   double lower = -HUGE_VAL, upper = HUGE_VAL, value, margin;
+
+   if (side == LHS)
+     { theMemory = &join->rangeIndex->right; }
+   else
+     { theMemory = &join->rangeIndex->left; }
+
+   for (theBound = theMemory->bounds;
+        theBound != NULL;
+        theBound = theBound->next)
+     {
+      if (! PartialMatchValue(theEnv,execStatus,join,theMatch,side,theBound->theExpression,&value))
+        { continue; }
+      value -= theBound->offset;
+
+      margin = fabs(value) * 4 * DBL_EPSILON;
+      if (theBound->lower && ((value - margin) > lower))
+        { lower = value - margin; }
+      if (theBound->upper && ((value + margin) < upper))
+        { upper = value + margin; }
+     }
+
+   theScan->theMemory = theMemory;
+   theScan->nextUnordered = theMemory->unorderedFirst;
+
+   if (lower > upper)
+     {
+      theScan->nextEntry = 0;
+      theScan->endEntry = 0;
+     }
+   else
+     {
+      theScan->nextEntry = LowerBound(theMemory,lower);
+      theScan->endEntry = UpperBound(theMemory,upper);
+     }
+  }
+
+/*********************************************************/
+/* NextRangeMatch: Returns the next partial match of a   */
+/*   range scan or NULL when the scan is complete.       */
+/*********************************************************/
+globle struct partialMatch *NextRangeMatch(
+  struct rangeScan *theScan)
+  {
+   struct orderedMemory *theMemory = theScan->theMemory;
+   struct partialMatch *theMatch;
+
+   while (theScan->nextUnordered < theMemory->unorderedCount)
+     {
+      theMatch = theMemory->unordered[theScan->nextUnordered++];
+      if (theMatch != NULL) return(theMatch);
+     }
+
+   while (theScan->nextEntry < theScan->endEntry)
+     {
+      theMatch = theMemory->entries[theScan->nextEntry++].theMatch;
+      if (theMatch != NULL) return(theMatch);
+     }
+
+   return(NULL);
+  }
+
+/*********************************************************/
+/* IndexableJoin: Determines whether a join can be given */
+/*   ordered memories. The join must be entered from the */
+/*   RHS by a positive pattern and not be hashed.        */
+/*********************************************************/
+static intBool IndexableJoin(
+  struct joinNode *join)
+  {
+   if (join->firstJoin || join->joinFromTheRight ||
+       join->patternIsNegated || join->patternIsExists)
+     { return(FALSE); }
+
+   if ((join->ruleToActivate != NULL) ||
+       (join->networkTest == NULL) ||
+       (join->rightSideEntryStructure == NULL) ||
+       (join->leftHash != NULL) ||
+       (((struct patternNodeHeader *) join->rightSideEntryStructure)->rightHash != NULL))
+     { return(FALSE); }
+
+   return(TRUE);
+  }
+
+/***********************************************************/
+/* RangeRelation: Returns the relation of a range test     */
+/*   with two arguments or -1 if the expression isn't one. */
+/***********************************************************/
+static int RangeRelation(
+  struct expr *theTest)
+  {
+   char *name;
+
+   if ((theTest->type != FCALL) ||
+       (theTest->argList == NULL) ||
+       (theTest->argList->nextArg == NULL) ||
+       (theTest->argList->nextArg->nextArg != NULL))
+     { return(-1); }
+
+   name = ValueToString(ExpressionFunctionCallName(theTest));
+
+   if (strcmp(name,"<") == 0) return(RANGE_LT);
+   if (strcmp(name,"<=") == 0) return(RANGE_LE);
+   if (strcmp(name,">") == 0) return(RANGE_GT);
+   if (strcmp(name,">=") == 0) return(RANGE_GE);
+   if (strcmp(name,"=") == 0) return(RANGE_EQ);
+
+   return(-1);
+  }
+
+/************************************************************/
+/* ExpressionSide: Determines whether the values of an      */
+/*   expression come from the LHS, the RHS, or both sides   */
+/*   of a join. Only variables, numbers, and sums and       */
+/*   differences of them are allowed in a range expression. */
+/************************************************************/
+static int ExpressionSide(
+  struct joinNode *join,
+  struct expr *theExpression)
+  {
+   struct expr *theArgument;
+   char *name;
+   int side;
+
+   switch (theExpression->type)
+     {
+      case INTEGER:
+      case FLOAT:
+        return(NO_SIDE);
+
+      case FACT_JN_VAR1:
+      case FACT_JN_VAR2:
+      case FACT_JN_VAR3:
+      case OBJ_GET_SLOT_JNVAR1:
+      case OBJ_GET_SLOT_JNVAR2:
+        return(VariableSide(join,theExpression));
+
+      case FCALL:
+        name = ValueToString(ExpressionFunctionCallName(theExpression));
+        if (((strcmp(name,"+") != 0) && (strcmp(name,"-") != 0)) ||
+            (theExpression->argList == NULL) ||
+            (theExpression->argList->nextArg == NULL))
+          { return(INVALID_SIDE); }
+
+        side = NO_SIDE;
+        for (theArgument = theExpression->argList;
+             theArgument != NULL;
+             theArgument = theArgument->nextArg)
+          { side |= ExpressionSide(join,theArgument); }
+        return(side);
+     }
+
+   return(INVALID_SIDE);
+  }
+
+/*******************************************************/
+/* VariableSide: Determines from which side of a join  */
+/*   the value of a join network variable is fetched.  */
+/*******************************************************/
+static int VariableSide(
+  struct joinNode *join,
+  struct expr *theVariable)
+  {
+   unsigned short whichPattern;
+   unsigned int lhs, rhs;
+
+   switch (theVariable->type)
+     {
+#if DEFTEMPLATE_CONSTRUCT
+      case FACT_JN_VAR1:
+        {
+         struct factGetVarJN1Call *hack = (struct factGetVarJN1Call *) ValueToBitMap(theVariable->value);
+         lhs = hack->lhs; rhs = hack->rhs; whichPattern = hack->whichPattern;
+         break;
+        }
+
+      case FACT_JN_VAR2:
+        {
+         struct factGetVarJN2Call *hack = (struct factGetVarJN2Call *) ValueToBitMap(theVariable->value);
+         lhs = hack->lhs; rhs = hack->rhs; whichPattern = hack->whichPattern;
+         break;
+        }
+
+      case FACT_JN_VAR3:
+        {
+         struct factGetVarJN3Call *hack = (struct factGetVarJN3Call *) ValueToBitMap(theVariable->value);
+         lhs = hack->lhs; rhs = hack->rhs; whichPattern = hack->whichPattern;
+         break;
+        }
+#endif
+
+#if OBJECT_SYSTEM
+      case OBJ_GET_SLOT_JNVAR1:
+        {
+         struct ObjectMatchVar1 *hack = (struct ObjectMatchVar1 *) ValueToBitMap(theVariable->value);
+         lhs = hack->lhs; rhs = hack->rhs; whichPattern = hack->whichPattern;
+         break;
+        }
+
+      case OBJ_GET_SLOT_JNVAR2:
+        {
+         struct ObjectMatchVar2 *hack = (struct ObjectMatchVar2 *) ValueToBitMap(theVariable->value);
+         lhs = hack->lhs; rhs = hack->rhs; whichPattern = hack->whichPattern;
+         break;
+        }
+#endif
+
+      default:
+        return(INVALID_SIDE);
+     }
+
+   /*===================================================*/
+   /* A variable not marked for either side is fetched  */
+   /* from the RHS if it belongs to the join's pattern. */
+   /*===================================================*/
+
+   if (lhs) return(LEFT_SIDE);
+   if (rhs) return(RIGHT_SIDE);
+   if (whichPattern == (unsigned short) (join->depth - 1)) return(RIGHT_SIDE);
+   return(LEFT_SIDE);
+  }
+
+/******************************************************/
+/* IsKeyVariable: Determines whether an expression is */
+/*   a variable which can be used as the key of an    */
+/*   ordered memory.                                  */
+/******************************************************/
+static intBool IsKeyVariable(
+  struct expr *theExpression)
+  {
+   switch (theExpression->type)
+     {
+      case FACT_JN_VAR1:
+      case FACT_JN_VAR2:
+      case FACT_JN_VAR3:
+      case OBJ_GET_SLOT_JNVAR1:
+      case OBJ_GET_SLOT_JNVAR2:
+        return(TRUE);
+     }
+
+   return(FALSE);
+  }
+
+/*************************************************************/
+/* OffsetVariable: Returns the variable of an expression     */
+/*   which is a variable, or the sum or difference of a      */
+/*   variable and numbers, so that a test of the expression  */
+/*   can be turned into a test of the variable. The numbers  */
+/*   added to the variable are returned as its offset.       */
+/*************************************************************/
+static struct expr *OffsetVariable(
+  struct expr *theExpression,
+  double *offset)
+  {
+   struct expr *theArgument, *theVariable = NULL;
+   double value;
+   intBool plus;
+
+   *offset = 0.0;
+
+   if (IsKeyVariable(theExpression)) return(theExpression);
+
+   if (theExpression->type != FCALL) return(NULL);
+
+   if (strcmp(ValueToString(ExpressionFunctionCallName(theExpression)),"+") == 0)
+     { plus = TRUE; }
+   else if (strcmp(ValueToString(ExpressionFunctionCallName(theExpression)),"-") == 0)
+     { plus = FALSE; }
+   else
+     { return(NULL); }
+
+   /*=================================================*/
+   /* The variable must be the first argument of a    */
+   /* difference but may be any argument of a sum.    */
+   /* All of the other arguments must be numbers.     */
+   /*=================================================*/
+
+   for (theArgument = theExpression->argList;
+        theArgument != NULL;
+        theArgument = theArgument->nextArg)
+     {
+      if (ConstantValue(theArgument,&value))
+        {
+         if (plus || (theArgument == theExpression->argList))
+           { *offset += value; }
+         else
+           { *offset -= value; }
+        }
+      else if ((theVariable == NULL) && IsKeyVariable(theArgument) &&
+               (plus || (theArgument == theExpression->argList)))
+        { theVariable = theArgument; }
+      else
+        { return(NULL); }
+     }
+
+   return(theVariable);
+  }
+
+/*****************************************************/
+/* ConstantValue: Returns the value of an expression */
+/*   which is an integer or float constant.          */
+/*****************************************************/
+static intBool ConstantValue(
+  struct expr *theExpression,
+  double *theValue)
+  {
+   if (theExpression->type == INTEGER)
+     { *theValue = (double) ValueToLong(theExpression->value); }
+   else if (theExpression->type == FLOAT)
+     { *theValue = ValueToDouble(theExpression->value); }
+   else
+     { return(FALSE); }
+
+   return(TRUE);
+  }
+
+/****************************************************/
+/* SameVariable: Determines whether two expressions */
+/*   fetch the same variable. The arguments of the  */
+/*   fetches are shared bitmaps.                    */
+/****************************************************/
+static intBool SameVariable(
+  struct expr *var1,
+  struct expr *var2)
+  {
+   return((var1->type == var2->type) && (var1->value == var2->value));
+  }
+
+/*********************************************************/
+/* FindRangeKeys: Uses the variables compared by a range */
+/*   test as the keys of the ordered memories of a join  */
+/*   if they haven't been determined yet.                */
+/*********************************************************/
+static void FindRangeKeys(
+  struct joinNode *join,
+  struct expr *theTest,
+  struct joinRangeIndex *theIndex)
+  {
+   struct expr *arg1, *arg2, *theVariable;
+   int side1, side2;
+   double offset;
+
+   if (RangeRelation(theTest) < 0) return;
+
+   arg1 = theTest->argList;
+   arg2 = arg1->nextArg;
+   side1 = ExpressionSide(join,arg1);
+   side2 = ExpressionSide(join,arg2);
+
+   if ((side1 == LEFT_SIDE) && (side2 == RIGHT_SIDE))
+     { /* Do Nothing */ }
+   else if ((side1 == RIGHT_SIDE) && (side2 == LEFT_SIDE))
+     {
+      arg1 = arg2;
+      arg2 = theTest->argList;
+     }
+   else
+     { return; }
+
+   if ((theIndex->left.key == NULL) &&
+       ((theVariable = OffsetVariable(arg1,&offset)) != NULL))
+     { theIndex->left.key = theVariable; }
+
+   if ((theIndex->right.key == NULL) &&
+       ((theVariable = OffsetVariable(arg2,&offset)) != NULL))
+     { theIndex->right.key = theVariable; }
+  }
+
+/***********************************************************/
+/* FindRangeBounds: Adds the bounds given by a range test  */
+/*   comparing the key of an ordered memory with an        */
+/*   expression of the other side of the join. The test is */
+/*   first written as LHS expression REL RHS expression.   */
+/***********************************************************/
+static void FindRangeBounds(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join,
+  struct expr *theTest,
+  struct joinRangeIndex *theIndex)
+  {
+   struct expr *leftSide, *rightSide, *theVariable;
+   int relation, side1, side2;
+   double offset;
+
+   if ((relation = RangeRelation(theTest)) < 0) return;
+
+   leftSide = theTest->argList;
+   rightSide = leftSide->nextArg;
+   side1 = ExpressionSide(join,leftSide);
+   side2 = ExpressionSide(join,rightSide);
+
+   if ((side1 == LEFT_SIDE) && (side2 == RIGHT_SIDE))
+     { /* Do Nothing */ }
+   else if ((side1 == RIGHT_SIDE) && (side2 == LEFT_SIDE))
+     {
+      leftSide = rightSide;
+      rightSide = theTest->argList;
+      switch (relation)
+        {
+         case RANGE_LT: relation = RANGE_GT; break;
+         case RANGE_LE: relation = RANGE_GE; break;
+         case RANGE_GT: relation = RANGE_LT; break;
+         case RANGE_GE: relation = RANGE_LE; break;
+        }
+     }
+   else
+     { return; }
+
+   /*===================================================*/
+   /* If leftSide < rightSide, the left key is bounded  */
+   /* from above by the RHS value and the right key is  */
+   /* bounded from below by the LHS value. An offset    */
+   /* added to a key is subtracted from its bound.      */
+   /*===================================================*/
+
+   theVariable = OffsetVariable(leftSide,&offset);
+   if ((theIndex->left.key != NULL) && (theVariable != NULL) &&
+       SameVariable(theIndex->left.key,theVariable))
+     {
+      AddRangeBound(theEnv,execStatus,&theIndex->left,rightSide,offset,
+                    (relation == RANGE_GT) || (relation == RANGE_GE) || (relation == RANGE_EQ),
+                    (relation == RANGE_LT) || (relation == RANGE_LE) || (relation == RANGE_EQ));
+     }
+
+   theVariable = OffsetVariable(rightSide,&offset);
+   if ((theIndex->right.key != NULL) && (theVariable != NULL) &&
+       SameVariable(theIndex->right.key,theVariable))
+     {
+      AddRangeBound(theEnv,execStatus,&theIndex->right,leftSide,offset,
+                    (relation == RANGE_LT) || (relation == RANGE_LE) || (relation == RANGE_EQ),
+                    (relation == RANGE_GT) || (relation == RANGE_GE) || (relation == RANGE_EQ));
+     }
+  }
+
+/*****************************************************/
+/* AddRangeBound: Adds a bound to an ordered memory. */
+/*****************************************************/
+static void AddRangeBound(
+  void *theEnv,
+  EXEC_STATUS,
+  struct orderedMemory *theMemory,
+  struct expr *theExpression,
+  double offset,
+  int lower,
+  int upper)
+  {
+   struct rangeBound *theBound;
+
+   theBound = (struct rangeBound *) genalloc(theEnv,execStatus,sizeof(struct rangeBound));
+   theBound->theExpression = theExpression;
+   theBound->offset = offset;
+   theBound->lower = lower;
+   theBound->upper = upper;
+   theBound->next = theMemory->bounds;
+   theMemory->bounds = theBound;
+  }
+
+/**********************************************************/
+/* RangeValue: Computes the value of a range expression   */
+/*   as a float. Sums and differences are computed here   */
+/*   rather than by calling + and - so that no error is   */
+/*   printed for a value which isn't a number: the join's */
+/*   network test reports it when it is evaluated.        */
+/**********************************************************/
+static intBool RangeValue(
+  void *theEnv,
+  EXEC_STATUS,
+  struct expr *theExpression,
+  double *theValue)
+  {
+   DATA_OBJECT result;
+   struct expr *theArgument;
+   double argValue;
+   int errorFlag;
+
+   if (theExpression->type == FCALL)
+     {
+      theArgument = theExpression->argList;
+      if (! RangeValue(theEnv,execStatus,theArgument,theValue)) return(FALSE);
+
+      for (theArgument = theArgument->nextArg;
+           theArgument != NULL;
+           theArgument = theArgument->nextArg)
+        {
+         if (! RangeValue(theEnv,execStatus,theArgument,&argValue)) return(FALSE);
+         if (strcmp(ValueToString(ExpressionFunctionCallName(theExpression)),"+") == 0)
+           { *theValue += argValue; }
+         else
+           { *theValue -= argValue; }
+        }
+
+      return(TRUE);
+     }
+
+   errorFlag = GetEvaluationError(theEnv,execStatus);
+   SetEvaluationError(theEnv,execStatus,FALSE);
+   EvaluateExpression(theEnv,execStatus,theExpression,&result);
+   if (GetEvaluationError(theEnv,execStatus))
+     {
+      SetEvaluationError(theEnv,execStatus,errorFlag);
+      return(FALSE);
+     }
+   SetEvaluationError(theEnv,execStatus,errorFlag);
+
+   if (result.type == INTEGER)
+     { *theValue = (double) ValueToLong(result.value); }
+   else if (result.type == FLOAT)
+     { *theValue = ValueToDouble(result.value); }
+   else
+     { return(FALSE); }
+
+   return(! isnan(*theValue));
+  }
+
+/**********************************************************/
+/* PartialMatchValue: Computes the value of an expression */
+/*   of the LHS or the RHS of a join for a partial match  */
+/*   entering the join from that side.                    */
+/**********************************************************/
+static intBool PartialMatchValue(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *join,
+  struct partialMatch *theMatch,
+  int side,
+  struct expr *theExpression,
+  double *theValue)
+  {
+   struct partialMatch *oldLHSBinds, *oldRHSBinds;
+   struct joinNode *oldJoin;
+   intBool rv;
+
+   oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
+   oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
+   oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
+
+   if (side == LHS)
+     {
+      LocalEngineData(theEnv,execStatus).LHSBinds = theMatch;
+      LocalEngineData(theEnv,execStatus).RHSBinds = NULL;
+     }
+   else
+     {
+      LocalEngineData(theEnv,execStatus).LHSBinds = NULL;
+      LocalEngineData(theEnv,execStatus).RHSBinds = theMatch;
+     }
+   LocalEngineData(theEnv,execStatus).GlobalJoin = join;
+
+   rv = RangeValue(theEnv,execStatus,theExpression,theValue);
+
+   LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
+   LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
+   LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
+
+   return(rv);
+  }
+
+/*******************************************************/
+/* LowerBound: Returns the position of the first entry */
+/*   of an ordered memory with a key not less than a   */
+/*   value.                                            */
+/*******************************************************/
+static unsigned long LowerBound(
+  struct orderedMemory *theMemory,
+  double value)
+  {
+   unsigned long low = 0, high = theMemory->count, middle;
+
+   while (low < high)
+     {
+      middle = low + (high - low) / 2;
+      if (theMemory->entries[middle].key < value)
+        { low = middle + 1; }
+      else
+        { high = middle; }
+     }
+
+   return(low);
+  }
+
+/*******************************************************/
+/* UpperBound: Returns the position of the first entry */
+/*   of an ordered memory with a key greater than a    */
+/*   value.                                            */
+/*******************************************************/
+static unsigned long UpperBound(
+  struct orderedMemory *theMemory,
+  double value)
+  {
+   unsigned long low = 0, high = theMemory->count, middle;
+
+   while (low < high)
+     {
+      middle = low + (high - low) / 2;
+      if (theMemory->entries[middle].key <= value)
+        { low = middle + 1; }
+      else
+        { high = middle; }
+     }
+
+   return(low);
+  }
+
+/**********************************************************/
+/* AddOrderedEntry: Inserts a partial match into the      */
+/*   sorted entries of an ordered memory after the others */
+/*   with the same key.                                   */
+/**********************************************************/
+static void AddOrderedEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct orderedMemory *theMemory,
+  double key,
+  struct partialMatch *theMatch)
+  {
+   struct orderedEntry *newEntries;
+   unsigned long position, newSize;
+
+   if (theMemory->count == theMemory->size)
+     {
+      newSize = (theMemory->size == 0) ? INITIAL_ORDERED_SIZE : (theMemory->size * 2);
+      newEntries = (struct orderedEntry *) genalloc(theEnv,execStatus,sizeof(struct orderedEntry) * newSize);
+      if (theMemory->entries != NULL)
+        {
+         memcpy(newEntries,theMemory->entries,sizeof(struct orderedEntry) * theMemory->count);
+         genfree(theEnv,execStatus,theMemory->entries,sizeof(struct orderedEntry) * theMemory->size);
+        }
+      theMemory->entries = newEntries;
+      theMemory->size = newSize;
+     }
+
+   position = UpperBound(theMemory,key);
+   memmove(&theMemory->entries[position+1],&theMemory->entries[position],
+           sizeof(struct orderedEntry) * (theMemory->count - position));
+   theMemory->entries[position].key = key;
+   theMemory->entries[position].theMatch = theMatch;
+   theMemory->count++;
+  }
+
+/*********************************************************/
+/* AddUnorderedEntry: Appends a partial match to the     */
+/*   unordered partial matches of an ordered memory.     */
+/*********************************************************/
+static void AddUnorderedEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct orderedMemory *theMemory,
+  struct partialMatch *theMatch)
+  {
+   struct partialMatch **newUnordered;
+   unsigned long newSize;
+
+   if (theMemory->unorderedCount == theMemory->unorderedSize)
+     {
+      newSize = (theMemory->unorderedSize == 0) ? INITIAL_ORDERED_SIZE : (theMemory->unorderedSize * 2);
+      newUnordered = (struct partialMatch **) genalloc(theEnv,execStatus,sizeof(struct partialMatch *) * newSize);
+      if (theMemory->unordered != NULL)
+        {
+         memcpy(newUnordered,theMemory->unordered,sizeof(struct partialMatch *) * theMemory->unorderedCount);
+         genfree(theEnv,execStatus,theMemory->unordered,sizeof(struct partialMatch *) * theMemory->unorderedSize);
+        }
+      theMemory->unordered = newUnordered;
+      theMemory->unorderedSize = newSize;
+     }
+
+   theMemory->unordered[theMemory->unorderedCount++] = theMatch;
+  }
+
+/***********************************************************/
+/* RemoveOrderedEntry: Removes a partial match from the    */
+/*   sorted entries of an ordered memory between two       */
+/*   positions. Its slot is emptied and the entries are    */
+/*   compacted once half of them are empty. Returns FALSE  */
+/*   if the partial match wasn't found.                    */
+/***********************************************************/
+static intBool RemoveOrderedEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct orderedMemory *theMemory,
+  unsigned long begin,
+  unsigned long end,
+  struct partialMatch *theMatch)
+  {
+   unsigned long i, j;
+
+   for (i = begin; i < end; i++)
+     {
+      if (theMemory->entries[i].theMatch == theMatch) break;
+     }
+
+   if (i >= end) return(FALSE);
+
+   theMemory->entries[i].theMatch = NULL;
+   theMemory->deleted++;
+
+   if (theMemory->deleted == theMemory->count)
+     {
+      genfree(theEnv,execStatus,theMemory->entries,sizeof(struct orderedEntry) * theMemory->size);
+      theMemory->entries = NULL;
+      theMemory->count = 0;
+      theMemory->deleted = 0;
+      theMemory->size = 0;
+     }
+   else if ((theMemory->deleted * 2) > theMemory->count)
+     {
+      for (i = 0, j = 0; i < theMemory->count; i++)
+        {
+         if (theMemory->entries[i].theMatch != NULL)
+           { theMemory->entries[j++] = theMemory->entries[i]; }
+        }
+      theMemory->count = j;
+      theMemory->deleted = 0;
+     }
+
+   return(TRUE);
+  }
+
+/***********************************************************/
+/* RemoveUnorderedEntry: Removes a partial match from the  */
+/*   unordered partial matches of an ordered memory. Since */
+/*   partial matches are mostly removed either first or    */
+/*   last in, the array is searched from both ends.        */
+/*   Returns FALSE if the partial match wasn't found.      */
+/***********************************************************/
+static intBool RemoveUnorderedEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct orderedMemory *theMemory,
+  struct partialMatch *theMatch)
+  {
+   unsigned long front, back, i, j;
+
+   if (theMemory->unorderedFirst >= theMemory->unorderedCount) return(FALSE);
+
+   front = theMemory->unorderedFirst;
+   back = theMemory->unorderedCount - 1;
+
+   while ((theMemory->unordered[front] != theMatch) &&
+          (theMemory->unordered[back] != theMatch))
+     {
+      if (front >= back) return(FALSE);
+      front++;
+      back--;
+     }
+
+   if (theMemory->unordered[front] == theMatch)
+     { i = front; }
+   else
+     { i = back; }
+
+   theMemory->unordered[i] = NULL;
+   theMemory->unorderedDeleted++;
+
+   while ((theMemory->unorderedFirst < theMemory->unorderedCount) &&
+          (theMemory->unordered[theMemory->unorderedFirst] == NULL))
+     { theMemory->unorderedFirst++; }
+
+   while ((theMemory->unorderedCount > theMemory->unorderedFirst) &&
+          (theMemory->unordered[theMemory->unorderedCount - 1] == NULL))
+     {
+      theMemory->unorderedCount--;
+      theMemory->unorderedDeleted--;
+     }
+
+   if (theMemory->unorderedFirst == theMemory->unorderedCount)
+     {
+      genfree(theEnv,execStatus,theMemory->unordered,sizeof(struct partialMatch *) * theMemory->unorderedSize);
+      theMemory->unordered = NULL;
+      theMemory->unorderedFirst = 0;
+      theMemory->unorderedCount = 0;
+      theMemory->unorderedDeleted = 0;
+      theMemory->unorderedSize = 0;
+     }
+   else if ((theMemory->unorderedDeleted * 2) > theMemory->unorderedCount)
+     {
+      for (i = theMemory->unorderedFirst, j = 0; i < theMemory->unorderedCount; i++)
+        {
+         if (theMemory->unordered[i] != NULL)
+           { theMemory->unordered[j++] = theMemory->unordered[i]; }
+        }
+      theMemory->unorderedFirst = 0;
+      theMemory->unorderedCount = j;
+      theMemory->unorderedDeleted = 0;
+     }
+
+   return(TRUE);
+  }
+
+/*******************************************************/
+/* ReturnOrderedMemory: Frees the entries and bounds   */
+/*   of an ordered memory.                             */
+/*******************************************************/
+static void ReturnOrderedMemory(
+  void *theEnv,
+  EXEC_STATUS,
+  struct orderedMemory *theMemory)
+  {
+   struct rangeBound *theBound;
+
+   while (theMemory->bounds != NULL)
+     {
+      theBound = theMemory->bounds->next;
+      genfree(theEnv,execStatus,theMemory->bounds,sizeof(struct rangeBound));
+      theMemory->bounds = theBound;
+     }
+
+   if (theMemory->entries != NULL)
+     { genfree(theEnv,execStatus,theMemory->entries,sizeof(struct orderedEntry) * theMemory->size); }
+
+   if (theMemory->unordered != NULL)
+     { genfree(theEnv,execStatus,theMemory->unordered,sizeof(struct partialMatch *) * theMemory->unorderedSize); }
+
+   memset(theMemory,0,sizeof(struct orderedMemory));
+  }
+
+#endif /* DEFRULE_CONSTRUCT */
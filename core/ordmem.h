@@ -0,0 +1,141 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*            ORDERED JOIN MEMORY HEADER FILE          */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Keeps the partial matches of joins with range    */
+/*   tests (<, >, <=, >=, or =) between the LHS and the RHS  */
+/*   sorted by the value tested, so that a partial match     */
+/*   entering the join is only compared with the partial     */
+/*   matches on the other side within the tested range.      */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_ordmem
+
+#define _H_ordmem
+
+struct orderedEntry;
+struct rangeBound;
+struct orderedMemory;
+struct joinRangeIndex;
+struct rangeScan;
+
+#ifndef _H_expressn
+#include "expressn.h"
+#endif
+#ifndef _H_match
+#include "match.h"
+#endif
+#ifndef _H_network
+#include "network.h"
+#endif
+
+# include "execution_status.h"
+
+/*************************************************/
+/* orderedEntry: A partial match of an ordered   */
+/*   memory and the numeric value it is sorted   */
+/*   by.                                         */
+/*************************************************/
+struct orderedEntry
+  {
+   double key;
+   struct partialMatch *theMatch;
+  };
+
+/**************************************************************/
+/* rangeBound: An expression evaluated for a partial match    */
+/*   entering a join which limits the keys of the partial     */
+/*   matches on the other side of the join from below, above, */
+/*   or both. The offset is subtracted from the value of the  */
+/*   expression when the key was tested with a number added.  */
+/**************************************************************/
+struct rangeBound
+  {
+   struct expr *theExpression;
+   double offset;
+   unsigned int lower : 1;
+   unsigned int upper : 1;
+   struct rangeBound *next;
+  };
+
+/**************************************************************/
+/* orderedMemory: The partial matches which have entered one  */
+/*   side of a join. Those for which the key expression gives */
+/*   a number are sorted by it, the others (and all of them   */
+/*   if the side has no key) are kept in order of arrival.    */
+/*   Removed partial matches leave an empty slot behind until */
+/*   half of the slots of the array are empty.                */
+/**************************************************************/
+struct orderedMemory
+  {
+   struct expr *key;
+   struct rangeBound *bounds;
+   struct orderedEntry *entries;
+   unsigned long count;
+   unsigned long deleted;
+   unsigned long size;
+   struct partialMatch **unordered;
+   unsigned long unorderedFirst;
+   unsigned long unorderedCount;
+   unsigned long unorderedDeleted;
+   unsigned long unorderedSize;
+  };
+
+/*************************************************************/
+/* joinRangeIndex: The ordered memories of a join. The left  */
+/*   memory is bounded by the values of the RHS partial      */
+/*   match entering the join and the right memory by those   */
+/*   of the LHS partial match.                               */
+/*************************************************************/
+struct joinRangeIndex
+  {
+   struct orderedMemory left;
+   struct orderedMemory right;
+  };
+
+/**************************************************/
+/* rangeScan: The position of a scan through the  */
+/*   partial matches of an ordered memory within  */
+/*   the range determined for a partial match.    */
+/**************************************************/
+struct rangeScan
+  {
+   struct orderedMemory *theMemory;
+   unsigned long nextUnordered;
+   unsigned long nextEntry;
+   unsigned long endEntry;
+  };
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _ORDMEM_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+   LOCALE void                           CreateJoinRangeIndex(void *,EXEC_STATUS,struct joinNode *);
+   LOCALE void                           ReturnJoinRangeIndex(void *,EXEC_STATUS,struct joinNode *);
+   LOCALE void                           AddToRangeIndex(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *,int);
+   LOCALE void                           RemoveFromRangeIndex(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *,int);
+   LOCALE void                           RemoveAlphaMatchFromRangeIndexes(void *,EXEC_STATUS,struct patternNodeHeader *,
+                                                                          struct partialMatch *);
+   LOCALE void                           StartRangeScan(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *,int,
+                                                        struct rangeScan *);
+   LOCALE struct partialMatch           *NextRangeMatch(struct rangeScan *);
+
+#endif
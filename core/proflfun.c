@@ -49,15 +49,39 @@
 #include "router.h"
 #include "sysdep.h"
 
+#if DEFRULE_CONSTRUCT
+#include "network.h"
+#include "reteutil.h"
+#include "ruledef.h"
+#include "fact/fact_scheduler.h"
+#endif
+
 #include "proflfun.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #define NO_PROFILE      0
 #define USER_FUNCTIONS  1
 #define CONSTRUCTS_CODE 2
+#define JOINS_CODE      3
 
 #define OUTPUT_STRING "%-40s %7ld %15.6f  %8.2f%%  %15.6f  %8.2f%%\n"
+#define JOIN_OUTPUT_STRING "%-40s %7lld %15.6f  %8.2f%%  %10lld %10lu %10lu %14.0f\n"
+
+#if DEFRULE_CONSTRUCT
+
+/***************************************************/
+/* joinProfileEntry: A join listed by profile-info */
+/*   with the rule and CE it is reported for.      */
+/***************************************************/
+struct joinProfileEntry
+  {
+   struct joinNode *theJoin;
+   struct defrule *theRule;
+  };
+
+#endif
 
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
@@ -67,6 +91,16 @@
                                                         char *,char *,char *,char **);
    static void                        OutputUserFunctionsInfo(void *,EXEC_STATUS);
    static void                        OutputConstructsCodeInfo(void *,EXEC_STATUS);
+#if DEFRULE_CONSTRUCT
+   static void                        OutputJoinsInfo(void *,EXEC_STATUS);
+   static long                        CollectProfiledJoins(struct joinNode *,struct defrule *,
+                                                           struct joinProfileEntry *,long);
+   static void                        UnmarkProfiledJoins(struct joinNode *);
+   static void                        ResetJoinProfiles(struct joinNode *);
+   static unsigned long               JoinMemoryCount(struct betaMemory *);
+   static unsigned long               AlphaMemoryCount(struct patternNodeHeader *);
+   static int                         CompareJoinProfiles(const void *,const void *);
+#endif
 #if (! RUN_TIME)
    static void                        ProfileClearFunction(void *,EXEC_STATUS);
 #endif
@@ -158,7 +192,7 @@ globle void ProfileCommand(
 
    if (! Profile(theEnv,execStatus,argument))
      {
-      ExpectedTypeError1(theEnv,execStatus,"profile",1,"symbol with value constructs, user-functions, or off");
+      ExpectedTypeError1(theEnv,execStatus,"profile",1,"symbol with value constructs, user-functions, joins, or off");
       return;
      }
 
@@ -179,7 +213,9 @@ globle intBool Profile(
    /* user-defined functions should be profiled. If the    */
    /* argument is the symbol "constructs", then            */
    /* deffunctions, generic functions, message-handlers,   */
-   /* and rule RHS actions are profiled.                   */
+   /* and rule RHS actions are profiled. If the argument   */
+   /* is the symbol "joins", then the time spent in the    */
+   /* joins of the rules is profiled.                      */
    /*======================================================*/
 
    if (strcmp(argument,"user-functions") == 0)
@@ -187,6 +223,7 @@ globle intBool Profile(
       ProfileFunctionData(theEnv,execStatus)->ProfileStartTime = gentime();
       ProfileFunctionData(theEnv,execStatus)->ProfileUserFunctions = TRUE;
       ProfileFunctionData(theEnv,execStatus)->ProfileConstructs = FALSE;
+      ProfileFunctionData(theEnv,execStatus)->ProfileJoins = FALSE;
       ProfileFunctionData(theEnv,execStatus)->LastProfileInfo = USER_FUNCTIONS;
      }
 
@@ -195,9 +232,22 @@ globle intBool Profile(
       ProfileFunctionData(theEnv,execStatus)->ProfileStartTime = gentime();
       ProfileFunctionData(theEnv,execStatus)->ProfileUserFunctions = FALSE;
       ProfileFunctionData(theEnv,execStatus)->ProfileConstructs = TRUE;
+      ProfileFunctionData(theEnv,execStatus)->ProfileJoins = FALSE;
       ProfileFunctionData(theEnv,execStatus)->LastProfileInfo = CONSTRUCTS_CODE;
      }
 
+#if DEFRULE_CONSTRUCT
+   else if (strcmp(argument,"joins") == 0)
+     {
+      WaitForMatchingTasks(theEnv,execStatus);
+      ProfileFunctionData(theEnv,execStatus)->ProfileStartTime = gentime();
+      ProfileFunctionData(theEnv,execStatus)->ProfileUserFunctions = FALSE;
+      ProfileFunctionData(theEnv,execStatus)->ProfileConstructs = FALSE;
+      ProfileFunctionData(theEnv,execStatus)->ProfileJoins = TRUE;
+      ProfileFunctionData(theEnv,execStatus)->LastProfileInfo = JOINS_CODE;
+     }
+#endif
+
    /*======================================================*/
    /* Otherwise, if the argument is the symbol "off", then */
    /* don't profile constructs and user-defined functions. */
@@ -205,10 +255,14 @@ globle intBool Profile(
 
    else if (strcmp(argument,"off") == 0)
      {
+#if DEFRULE_CONSTRUCT
+      WaitForMatchingTasks(theEnv,execStatus);
+#endif
       ProfileFunctionData(theEnv,execStatus)->ProfileEndTime = gentime();
       ProfileFunctionData(theEnv,execStatus)->ProfileTotalTime += (ProfileFunctionData(theEnv,execStatus)->ProfileEndTime - ProfileFunctionData(theEnv,execStatus)->ProfileStartTime);
       ProfileFunctionData(theEnv,execStatus)->ProfileUserFunctions = FALSE;
       ProfileFunctionData(theEnv,execStatus)->ProfileConstructs = FALSE;
+      ProfileFunctionData(theEnv,execStatus)->ProfileJoins = FALSE;
      }
 
    /*=====================================================*/
@@ -256,7 +310,8 @@ globle void ProfileInfoCommand(
    /* update the profile end time.     */
    /*==================================*/
 
-   if (ProfileFunctionData(theEnv,execStatus)->ProfileUserFunctions || ProfileFunctionData(theEnv,execStatus)->ProfileConstructs)
+   if (ProfileFunctionData(theEnv,execStatus)->ProfileUserFunctions || ProfileFunctionData(theEnv,execStatus)->ProfileConstructs ||
+       ProfileFunctionData(theEnv,execStatus)->ProfileJoins)
      {
       ProfileFunctionData(theEnv,execStatus)->ProfileEndTime = gentime();
       ProfileFunctionData(theEnv,execStatus)->ProfileTotalTime += (ProfileFunctionData(theEnv,execStatus)->ProfileEndTime - ProfileFunctionData(theEnv,execStatus)->ProfileStartTime);
@@ -271,6 +326,18 @@ globle void ProfileInfoCommand(
       gensprintf(buffer,"Profile elapsed time = %g seconds\n",
                       ProfileFunctionData(theEnv,execStatus)->ProfileTotalTime);
       EnvPrintRouter(theEnv,execStatus,WDISPLAY,buffer);
+     }
+
+#if DEFRULE_CONSTRUCT
+   if (ProfileFunctionData(theEnv,execStatus)->LastProfileInfo == JOINS_CODE)
+     {
+      OutputJoinsInfo(theEnv,execStatus);
+      return;
+     }
+#endif
+
+   if (ProfileFunctionData(theEnv,execStatus)->LastProfileInfo != NO_PROFILE)
+     {
 
       if (ProfileFunctionData(theEnv,execStatus)->LastProfileInfo == USER_FUNCTIONS)
         { EnvPrintRouter(theEnv,execStatus,WDISPLAY,"Function Name                            "); }
@@ -368,6 +435,61 @@ globle void EndProfile(
    ProfileFunctionData(theEnv,execStatus)->ActiveProfileFrame = theFrame->oldProfileFrame;
   }
 
+/**************************************************************/
+/* StartJoinProfile: Starts charging the time spent in a join */
+/*   to the join. The join which was being profiled on this   */
+/*   thread is charged with the time up to now and resumes    */
+/*   once the join is left. The comparisons made while in the */
+/*   join are charged to it as well.                          */
+/**************************************************************/
+globle void StartJoinProfile(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinProfileFrame *theFrame,
+  struct joinNode *theJoin)
+  {
+   double startTime;
+   struct joinProfileFrame *oldFrame;
+
+   startTime = gentime();
+   oldFrame = execStatus->ActiveJoinProfile;
+
+   if (oldFrame != NULL)
+     { oldFrame->theJoin->profileTime += startTime - oldFrame->startTime; }
+
+   theFrame->theJoin = theJoin;
+   theFrame->oldFrame = oldFrame;
+   theFrame->startTime = startTime;
+   theFrame->startCompares = theJoin->memoryCompares;
+
+   execStatus->ActiveJoinProfile = theFrame;
+  }
+
+/*************************************************************/
+/* EndJoinProfile: Stops charging the time spent in a join   */
+/*   to the join and resumes the join which was profiled     */
+/*   before it was entered.                                  */
+/*************************************************************/
+globle void EndJoinProfile(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinProfileFrame *theFrame)
+  {
+   double endTime;
+   struct joinNode *theJoin = theFrame->theJoin;
+
+   endTime = gentime();
+
+   theJoin->profileTime += endTime - theFrame->startTime;
+   theJoin->profileEntries++;
+   theJoin->profileCompares += theJoin->memoryCompares - theFrame->startCompares;
+
+   if (theFrame->oldFrame != NULL)
+     { theFrame->oldFrame->startTime = endTime; }
+
+   execStatus->ActiveJoinProfile = theFrame->oldFrame;
+  }
+
 /******************************************/
 /* OutputProfileInfo: Prints out a single */
 /*   line of profile information.         */
@@ -449,7 +571,7 @@ globle void ProfileResetCommand(
    DEFFUNCTION *theDeffunction;
 #endif
 #if DEFRULE_CONSTRUCT
-   struct defrule *theDefrule;
+   struct defrule *theDefrule, *theDisjunct;
 #endif
 #if DEFGENERIC_CONSTRUCT
    DEFGENERIC *theDefgeneric;
@@ -501,6 +623,10 @@ globle void ProfileResetCommand(
      { 
       ResetProfileInfo((struct constructProfileInfo *)
                        TestUserData(ProfileFunctionData(theEnv,execStatus)->ProfileDataID,theDefrule->header.usrData)); 
+      for (theDisjunct = theDefrule;
+           theDisjunct != NULL;
+           theDisjunct = theDisjunct->disjunct)
+        { ResetJoinProfiles(theDisjunct->lastJoin); }
      }
 #endif
 
@@ -718,6 +844,285 @@ static void OutputConstructsCodeInfo(
 
   }
 
+#if DEFRULE_CONSTRUCT
+
+/***********************************************************/
+/* OutputJoinsInfo: Prints the joins of the rules ranked   */
+/*   by the time spent in them. Each join is listed with   */
+/*   the rule and CE it was first found for (or as the     */
+/*   rule's activation for its last join), the number of   */
+/*   times it was entered, the comparisons made while in   */
+/*   it, and the number of partial matches on its left and */
+/*   right along with their product, which is the number   */
+/*   of comparisons an unindexed activation could require. */
+/***********************************************************/
+static void OutputJoinsInfo(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct defrule *theDefrule, *theDisjunct;
+   struct joinProfileEntry *theEntries;
+   struct joinNode *theJoin;
+   long count = 0, i;
+   unsigned long leftCount, rightCount;
+   double percent;
+   char itemName[512];
+   char buffer[512];
+
+   WaitForMatchingTasks(theEnv,execStatus);
+
+   /*===================================================*/
+   /* Count the joins. Joins shared by several rules or */
+   /* reached along several paths are counted once.     */
+   /*===================================================*/
+
+   for (theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,NULL);
+        theDefrule != NULL;
+        theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,theDefrule))
+     {
+      for (theDisjunct = theDefrule; theDisjunct != NULL; theDisjunct = theDisjunct->disjunct)
+        { count = CollectProfiledJoins(theDisjunct->lastJoin,theDisjunct,NULL,count); }
+     }
+
+   for (theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,NULL);
+        theDefrule != NULL;
+        theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,theDefrule))
+     {
+      for (theDisjunct = theDefrule; theDisjunct != NULL; theDisjunct = theDisjunct->disjunct)
+        { UnmarkProfiledJoins(theDisjunct->lastJoin); }
+     }
+
+   if (count == 0) return;
+
+   /*======================================*/
+   /* Gather the joins and rank them with  */
+   /* the most time consuming join first.  */
+   /*======================================*/
+
+   theEntries = (struct joinProfileEntry *)
+                genalloc(theEnv,execStatus,sizeof(struct joinProfileEntry) * (size_t) count);
+
+   count = 0;
+   for (theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,NULL);
+        theDefrule != NULL;
+        theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,theDefrule))
+     {
+      for (theDisjunct = theDefrule; theDisjunct != NULL; theDisjunct = theDisjunct->disjunct)
+        { count = CollectProfiledJoins(theDisjunct->lastJoin,theDisjunct,theEntries,count); }
+     }
+
+   for (theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,NULL);
+        theDefrule != NULL;
+        theDefrule = (struct defrule *) EnvGetNextDefrule(theEnv,execStatus,theDefrule))
+     {
+      for (theDisjunct = theDefrule; theDisjunct != NULL; theDisjunct = theDisjunct->disjunct)
+        { UnmarkProfiledJoins(theDisjunct->lastJoin); }
+     }
+
+   qsort(theEntries,(size_t) count,sizeof(struct joinProfileEntry),CompareJoinProfiles);
+
+   /*==================*/
+   /* Print the joins. */
+   /*==================*/
+
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,
+                  "Rule CE                                  Entries         Time           %"
+                  "     Compares       Left      Right  Left x Right\n");
+   EnvPrintRouter(theEnv,execStatus,WDISPLAY,
+                  "-------                                  -------        ------        -----"
+                  "     --------       ----      -----  ------------\n");
+
+   for (i = 0; i < count; i++)
+     {
+      theJoin = theEntries[i].theJoin;
+      if (theJoin->profileEntries == 0) continue;
+
+      percent = 0.0;
+      if (ProfileFunctionData(theEnv,execStatus)->ProfileTotalTime != 0.0)
+        {
+         percent = (theJoin->profileTime * 100.0) / ProfileFunctionData(theEnv,execStatus)->ProfileTotalTime;
+         if (percent < 0.005) percent = 0.0;
+        }
+
+      if (percent < ProfileFunctionData(theEnv,execStatus)->PercentThreshold) continue;
+
+      CompleteBetaMemoryResize(theEnv,execStatus,theJoin);
+
+      if (theJoin->firstJoin)
+        { leftCount = 1; }
+      else
+        { leftCount = JoinMemoryCount(theJoin->leftMemory); }
+
+      if (theJoin->joinFromTheRight)
+        { rightCount = JoinMemoryCount(theJoin->rightMemory); }
+      else
+        { rightCount = AlphaMemoryCount((struct patternNodeHeader *) theJoin->rightSideEntryStructure); }
+
+      if (theJoin->ruleToActivate != NULL)
+        { gensprintf(itemName,"%s activation",ValueToString(theEntries[i].theRule->header.name)); }
+      else
+        {
+         gensprintf(itemName,"%s CE %u",ValueToString(theEntries[i].theRule->header.name),
+                    (unsigned) theJoin->depth);
+        }
+      if (strlen(itemName) >= 40)
+        {
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,itemName);
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,"\n");
+         itemName[0] = EOS;
+        }
+
+      gensprintf(buffer,JOIN_OUTPUT_STRING,itemName,
+                 theJoin->profileEntries,theJoin->profileTime,percent,
+                 theJoin->profileCompares,leftCount,rightCount,
+                 (double) leftCount * (double) rightCount);
+      EnvPrintRouter(theEnv,execStatus,WDISPLAY,buffer);
+     }
+
+   genfree(theEnv,execStatus,theEntries,sizeof(struct joinProfileEntry) * (size_t) count);
+  }
+
+/***************************************************************/
+/* CollectProfiledJoins: Marks a join and the unmarked joins   */
+/*   preceding it and, if theEntries isn't NULL, stores them   */
+/*   with the rule they are listed for. Returns the new number */
+/*   of joins.                                                 */
+/***************************************************************/
+static long CollectProfiledJoins(
+  struct joinNode *theJoin,
+  struct defrule *theRule,
+  struct joinProfileEntry *theEntries,
+  long count)
+  {
+   if ((theJoin == NULL) || theJoin->marked)
+     { return(count); }
+
+   theJoin->marked = TRUE;
+
+   count = CollectProfiledJoins(theJoin->lastLevel,theRule,theEntries,count);
+
+   if (theJoin->joinFromTheRight)
+     {
+      count = CollectProfiledJoins((struct joinNode *) theJoin->rightSideEntryStructure,
+                                   theRule,theEntries,count);
+     }
+
+   if (theEntries != NULL)
+     {
+      theEntries[count].theJoin = theJoin;
+      theEntries[count].theRule = theRule;
+     }
+
+   return(count + 1);
+  }
+
+/*************************************************************/
+/* UnmarkProfiledJoins: Clears the marks set on a join and   */
+/*   the joins preceding it by CollectProfiledJoins.         */
+/*************************************************************/
+static void UnmarkProfiledJoins(
+  struct joinNode *theJoin)
+  {
+   if ((theJoin == NULL) || (! theJoin->marked))
+     { return; }
+
+   theJoin->marked = FALSE;
+
+   UnmarkProfiledJoins(theJoin->lastLevel);
+
+   if (theJoin->joinFromTheRight)
+     { UnmarkProfiledJoins((struct joinNode *) theJoin->rightSideEntryStructure); }
+  }
+
+/*********************************************************/
+/* ResetJoinProfiles: Clears the profile of a join and   */
+/*   of the joins preceding it.                          */
+/*********************************************************/
+static void ResetJoinProfiles(
+  struct joinNode *theJoin)
+  {
+   if (theJoin == NULL)
+     { return; }
+
+   theJoin->profileEntries = 0;
+   theJoin->profileCompares = 0;
+   theJoin->profileTime = 0.0;
+
+   ResetJoinProfiles(theJoin->lastLevel);
+
+   if (theJoin->joinFromTheRight)
+     { ResetJoinProfiles((struct joinNode *) theJoin->rightSideEntryStructure); }
+  }
+
+/********************************************************/
+/* JoinMemoryCount: Returns the number of partial       */
+/*   matches stored in a beta memory.                   */
+/********************************************************/
+static unsigned long JoinMemoryCount(
+  struct betaMemory *theMemory)
+  {
+   struct partialMatch *listOfMatches;
+   unsigned long b, count = 0;
+
+   if (theMemory == NULL)
+     { return(0); }
+
+   for (b = 0; b < theMemory->size; b++)
+     {
+      for (listOfMatches = theMemory->beta[b];
+           listOfMatches != NULL;
+           listOfMatches = listOfMatches->nextInMemory)
+        { count++; }
+     }
+
+   return(count);
+  }
+
+/*********************************************************/
+/* AlphaMemoryCount: Returns the number of partial       */
+/*   matches stored in the alpha memories of a pattern.  */
+/*********************************************************/
+static unsigned long AlphaMemoryCount(
+  struct patternNodeHeader *theHeader)
+  {
+   struct alphaMemoryHash *theAlphaMemory;
+   struct partialMatch *listOfMatches;
+   unsigned long count = 0;
+
+   if (theHeader == NULL)
+     { return(0); }
+
+   for (theAlphaMemory = theHeader->firstHash;
+        theAlphaMemory != NULL;
+        theAlphaMemory = theAlphaMemory->nextHash)
+     {
+      for (listOfMatches = theAlphaMemory->alphaMemory;
+           listOfMatches != NULL;
+           listOfMatches = listOfMatches->nextInMemory)
+        { count++; }
+     }
+
+   return(count);
+  }
+
+/*******************************************************/
+/* CompareJoinProfiles: qsort comparison function for  */
+/*   ranking joins with the most time consuming first. */
+/*******************************************************/
+static int CompareJoinProfiles(
+  const void *entry1,
+  const void *entry2)
+  {
+   double time1 = ((const struct joinProfileEntry *) entry1)->theJoin->profileTime;
+   double time2 = ((const struct joinProfileEntry *) entry2)->theJoin->profileTime;
+
+   if (time1 > time2) return(-1);
+   if (time1 < time2) return(1);
+   return(0);
+  }
+
+#endif /* DEFRULE_CONSTRUCT */
+
 /*********************************************************/
 /* SetProfilePercentThresholdCommand: H/L access routine */
 /*   for the set-profile-percent-threshold command.      */
@@ -36,6 +36,8 @@
 
 #include "userdata.h"
 
+struct joinNode;
+
 struct constructProfileInfo
   {
    struct userData usrData;
@@ -53,6 +55,14 @@ struct profileFrameInfo
    double parentStartTime;
    struct constructProfileInfo *oldProfileFrame;
   };
+
+struct joinProfileFrame
+  {
+   struct joinNode *theJoin;
+   struct joinProfileFrame *oldFrame;
+   double startTime;
+   long long startCompares;
+  };
   
 #define PROFLFUN_DATA 15
 
@@ -67,6 +77,7 @@ struct profileFunctionData
    unsigned char ProfileDataID;
    int ProfileUserFunctions;
    int ProfileConstructs;
+   int ProfileJoins;
    struct constructProfileInfo *ActiveProfileFrame;
    char *OutputString;
   };
@@ -81,6 +92,8 @@ struct profileFunctionData
                                                       struct userData **,
                                                       intBool);
    LOCALE void                           EndProfile(void *,EXEC_STATUS,struct profileFrameInfo *);
+   LOCALE void                           StartJoinProfile(void *,EXEC_STATUS,struct joinProfileFrame *,struct joinNode *);
+   LOCALE void                           EndJoinProfile(void *,EXEC_STATUS,struct joinProfileFrame *);
    LOCALE void                           ProfileResetCommand(void *,EXEC_STATUS);
    LOCALE void                           ResetProfileInfo(struct constructProfileInfo *);
 
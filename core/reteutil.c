@@ -43,13 +43,24 @@
 #include "incrrset.h"
 #include "match.h"
 #include "memalloc.h"
+#include "multifld.h"
+#include "ordmem.h"
 #include "moduldef.h"
+#include "fact/fact_manager.h"
 #include "pattern.h"
+#include "prntutil.h"
 #include "retract.h"
 #include "router.h"
 
+#if OBJECT_SYSTEM
+#include "object.h"
+#endif
+
 #include "reteutil.h"
 
+# include <apr_atomic.h>
+# include <apr_pools.h>
+
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
@@ -59,11 +70,27 @@
    static unsigned long               AlphaMemoryHashValue(struct patternNodeHeader *,unsigned long);
    static void                        UnlinkAlphaMemory(void *,EXEC_STATUS,struct patternNodeHeader *,struct alphaMemoryHash *);
    static void                        UnlinkAlphaMemoryBucketSiblings(void *,EXEC_STATUS,struct alphaMemoryHash *);
+   static unsigned long               HashJoinField(unsigned short,void *);
    static void                        InitializePMLinks(struct partialMatch *);
+   static void                        UnlinkBlockedPM(struct partialMatch *);
    static void                        UnlinkBetaPartialMatchfromAlphaAndBetaLineage(struct partialMatch *);
    static int                         CountPriorPatterns(struct joinNode *);
-   static void                        ResizeBetaMemory(void *,EXEC_STATUS,struct betaMemory *);
    static void                        ResetBetaMemory(void *,EXEC_STATUS,struct betaMemory *);
+   static void                        ResizeJoinMemory(void *,EXEC_STATUS,struct joinNode *,struct betaMemory *);
+   static void                        LockJoinMemories(struct joinNode *);
+   static void                        UnlockJoinMemories(struct joinNode *);
+   static struct partialMatch       **BetaMemoryBucket(struct betaMemory *,unsigned long,struct partialMatch ***);
+   static intBool                     MoveBetaBuckets(struct betaMemory *,unsigned long,unsigned long);
+   static void                        StartBetaMemoryResize(void *,EXEC_STATUS,struct betaMemory *,unsigned long);
+   static void                        FinishBetaMemoryResize(void *,EXEC_STATUS,struct betaMemory *);
+   static void                        EndJoinMemoryResize(void *,EXEC_STATUS,struct joinNode *,struct betaMemory *);
+   static void                        UpdateBetaMemorySize(void *,EXEC_STATUS,struct joinNode *,
+                                                           struct betaMemory *,unsigned long);
+   static apr_thread_mutex_t         *JoinMemoryLock(struct joinNode *,unsigned long);
+   static apr_thread_mutex_t         *PartialMatchLock(void *,EXEC_STATUS,struct partialMatch *);
+   static void                        StampPartialMatch(void *,EXEC_STATUS,struct partialMatch *,
+                                                        struct joinNode *,struct betaMemory *);
+   static void                        ReturnJoinLocks(void *,EXEC_STATUS,struct joinNode *);
 #if (CONSTRUCT_COMPILER || BLOAD_AND_BSAVE) && (! RUN_TIME)
    static void                        TagNetworkTraverseJoins(void *,EXEC_STATUS,long int *,long int *,struct joinNode *);
 #endif
@@ -117,6 +144,7 @@ globle struct partialMatch *CopyPartialMatch(
    linker->rhsMemory = FALSE;
    linker->bcount = list->bcount;
    linker->hashValue = 0;
+   linker->memoryTag = 0;
 
    for (i = 0; i < linker->bcount; i++) linker->binds[i] = list->binds[i];
 
@@ -140,6 +168,7 @@ globle struct partialMatch *CreateEmptyPartialMatch(
    linker->rhsMemory = FALSE;
    linker->bcount = 1;
    linker->hashValue = 0;
+   linker->memoryTag = 0;
    linker->binds[0].gm.theValue = NULL;
 
    return(linker);
@@ -160,15 +189,60 @@ static void InitializePMLinks(
    theMatch->children = NULL;
    theMatch->rightParent = NULL;
    theMatch->leftParent = NULL;
-   theMatch->blockList = NULL;
-   theMatch->nextBlocked = NULL;
-   theMatch->prevBlocked = NULL;
    theMatch->marker = NULL;
-   theMatch->dependents = NULL;
+   theMatch->links = NULL;
+  }
+
+/*************************************************************/
+/* GetPartialMatchLinks: Returns the block list and logical  */
+/*   dependency links of a partial match, allocating them if */
+/*   the partial match has not used them before.             */
+/*************************************************************/
+globle struct partialMatchLinks *GetPartialMatchLinks(
+  void *theEnv,
+  EXEC_STATUS,
+  struct partialMatch *thePM)
+  {
+   struct partialMatchLinks *theLinks;
+
+   if (thePM->links != NULL)
+     { return(thePM->links); }
+
+   theLinks = get_struct(theEnv,execStatus,partialMatchLinks);
+   theLinks->dependents = NULL;
+   theLinks->blockList = NULL;
+   theLinks->nextBlocked = NULL;
+   theLinks->prevBlocked = NULL;
+
+   thePM->links = theLinks;
+
+   return(theLinks);
+  }
+
+/*************************************************************/
+/* ReturnPartialMatchLinks: Returns the block list and       */
+/*   logical dependency links of a partial match (if any) to */
+/*   the pool of free memory.                                */
+/*************************************************************/
+globle void ReturnPartialMatchLinks(
+  void *theEnv,
+  EXEC_STATUS,
+  struct partialMatch *thePM)
+  {
+   if (thePM->links == NULL) return;
+
+   rtn_struct(theEnv,execStatus,partialMatchLinks,thePM->links);
+   thePM->links = NULL;
   }
   
 /***********************************************************/
-/* UpdateBetaPMLinks: . */
+/* UpdateBetaPMLinks: Stores a partial match in the left   */
+/*   or right beta memory of a join and links it to its    */
+/*   parents. Matcher workers add partial matches to the   */
+/*   same memories concurrently: the memory is updated     */
+/*   while holding the lock of the partial match's bucket, */
+/*   the children lists of the parents while holding the   */
+/*   lock of the respective parent.                        */
 /***********************************************************/
 globle void UpdateBetaPMLinks(
   void *theEnv,
@@ -180,8 +254,10 @@ globle void UpdateBetaPMLinks(
   unsigned long hashValue,
   int side)
   {
-   unsigned long betaLocation;
+   struct partialMatch **theBucket, **theLast;
    struct betaMemory *theMemory;
+   apr_thread_mutex_t *theLock;
+   intBool resizeDone = FALSE;
    
    if (side == LHS)
      { 
@@ -195,37 +271,50 @@ globle void UpdateBetaPMLinks(
      }
    
    thePM->hashValue = hashValue;
+   thePM->owner = join;
      
    /*================================*/
    /* Update the node's linked list. */
    /*================================*/
 
-   betaLocation = hashValue % theMemory->size;
+   LockJoinMemory(join,hashValue);
+
+   StampPartialMatch(theEnv,execStatus,thePM,join,theMemory);
+
+   theBucket = BetaMemoryBucket(theMemory,hashValue,&theLast);
    
    if (side == LHS)
      {
-      thePM->nextInMemory = theMemory->beta[betaLocation];
-      if (theMemory->beta[betaLocation] != NULL)
-        { theMemory->beta[betaLocation]->prevInMemory = thePM; }
-      theMemory->beta[betaLocation] = thePM;
+      thePM->nextInMemory = *theBucket;
+      if (*theBucket != NULL)
+        { (*theBucket)->prevInMemory = thePM; }
+      *theBucket = thePM;
      }
    else
      {
-      if (theMemory->last[betaLocation] != NULL)
+      if (*theLast != NULL)
         {
-         theMemory->last[betaLocation]->nextInMemory = thePM;
-         thePM->prevInMemory = theMemory->last[betaLocation];
+         (*theLast)->nextInMemory = thePM;
+         thePM->prevInMemory = *theLast;
         }
       else
-        { theMemory->beta[betaLocation] = thePM; }
+        { *theBucket = thePM; }
 
-      theMemory->last[betaLocation] = thePM;
+      *theLast = thePM;
      }
+
+   /*===============================================*/
+   /* If the memory is being resized, move a few    */
+   /* more of the old buckets guarded by this lock. */
+   /*===============================================*/
+
+   if (theMemory->resize != NULL)
+     { resizeDone = MoveBetaBuckets(theMemory,hashValue % BETA_MEMORY_LOCKS,BETA_RESIZE_STEP); }
      
-   theMemory->count++;
-   join->memoryAdds++;
-   
-   thePM->owner = join;
+   UnlockJoinMemory(join,hashValue);
+
+   if (resizeDone)
+     { EndJoinMemoryResize(theEnv,execStatus,join,theMemory); }
 
    /*======================================*/
    /* Update the alpha memory linked list. */
@@ -233,11 +322,14 @@ globle void UpdateBetaPMLinks(
       
    if (rhsBinds != NULL)
      {
+      theLock = PartialMatchLock(theEnv,execStatus,rhsBinds);
+      apr_thread_mutex_lock(theLock);
       thePM->nextRightChild = rhsBinds->children;
       if (rhsBinds->children != NULL)
         { rhsBinds->children->prevRightChild = thePM; }
       rhsBinds->children = thePM;
       thePM->rightParent = rhsBinds;
+      apr_thread_mutex_unlock(theLock);
     }
       
    /*=====================================*/
@@ -246,19 +338,23 @@ globle void UpdateBetaPMLinks(
 
    if (lhsBinds != NULL)
      {
+      theLock = PartialMatchLock(theEnv,execStatus,lhsBinds);
+      apr_thread_mutex_lock(theLock);
       thePM->nextLeftChild = lhsBinds->children;
       if (lhsBinds->children != NULL)
         { lhsBinds->children->prevLeftChild = thePM; }
       lhsBinds->children = thePM;
       thePM->leftParent = lhsBinds;
+      apr_thread_mutex_unlock(theLock);
      }
 
    if (! DefruleData(theEnv,execStatus)->BetaMemoryResizingFlag)
      { return; }
 
    if ((theMemory->size > 1) &&
-       (theMemory->count > (theMemory->size * 11)))
-     { ResizeBetaMemory(theEnv,execStatus,theMemory); }
+       (theMemory->resize == NULL) &&
+       (theMemory->count > (theMemory->size * BETA_MEMORY_LOAD_FACTOR)))
+     { ResizeJoinMemory(theEnv,execStatus,join,theMemory); }
   }
 
 /**********************************************************/
@@ -266,17 +362,32 @@ globle void UpdateBetaPMLinks(
 /*   the beta memory of a join (with a negated RHS) and a */
 /*   partial match in its right memory that prevents the  */
 /*   partial match from being satisfied and propagated to */
-/*   the next join in the rule.                           */
+/*   the next join in the rule. Since an alpha memory     */
+/*   partial match can block partial matches of several   */
+/*   joins, its block list is updated under its lock.     */
 /**********************************************************/
 globle void AddBlockedLink(
+  void *theEnv,
+  EXEC_STATUS,
   struct partialMatch *thePM,
   struct partialMatch *rhsBinds)
   {
+   apr_thread_mutex_t *theLock;
+   struct partialMatchLinks *theLinks, *blockerLinks;
+
+   theLock = PartialMatchLock(theEnv,execStatus,rhsBinds);
+   apr_thread_mutex_lock(theLock);
+
+   theLinks = GetPartialMatchLinks(theEnv,execStatus,thePM);
+   blockerLinks = GetPartialMatchLinks(theEnv,execStatus,rhsBinds);
+
    thePM->marker = rhsBinds;
-   thePM->nextBlocked = rhsBinds->blockList;
-   if (rhsBinds->blockList != NULL)
-     { rhsBinds->blockList->prevBlocked = thePM; }
-   rhsBinds->blockList = thePM;
+   theLinks->nextBlocked = blockerLinks->blockList;
+   if (blockerLinks->blockList != NULL)
+     { blockerLinks->blockList->links->prevBlocked = thePM; }
+   blockerLinks->blockList = thePM;
+
+   apr_thread_mutex_unlock(theLock);
   }
 
 /*************************************************************/
@@ -289,22 +400,37 @@ globle void AddBlockedLink(
 globle void RemoveBlockedLink(
   struct partialMatch *thePM)
   {
+   UnlinkBlockedPM(thePM);
+   thePM->marker = NULL;
+  }
+
+/*************************************************************/
+/* UnlinkBlockedPM: Removes a partial match from the block   */
+/*   list of the partial match blocking it (if any).         */
+/*************************************************************/
+static void UnlinkBlockedPM(
+  struct partialMatch *thePM)
+  {
+   struct partialMatchLinks *theLinks = thePM->links;
    struct partialMatch *blocker;
-   
-   if (thePM->prevBlocked == NULL)
+
+   if (theLinks == NULL) return;
+
+   if (theLinks->prevBlocked == NULL)
      { 
       blocker = (struct partialMatch *) thePM->marker;
-      blocker->blockList = thePM->nextBlocked; 
-     } 
+      
+      if ((blocker != NULL) && (blocker->links != NULL))
+        { blocker->links->blockList = theLinks->nextBlocked; } 
+     }
    else
-     { thePM->prevBlocked->nextBlocked = thePM->nextBlocked; }
+     { theLinks->prevBlocked->links->nextBlocked = theLinks->nextBlocked; }
 
-   if (thePM->nextBlocked != NULL)
-     { thePM->nextBlocked->prevBlocked = thePM->prevBlocked; }
+   if (theLinks->nextBlocked != NULL)
+     { theLinks->nextBlocked->links->prevBlocked = theLinks->prevBlocked; }
 
-   thePM->nextBlocked = NULL;
-   thePM->prevBlocked = NULL;
-   thePM->marker = NULL;
+   theLinks->nextBlocked = NULL;
+   theLinks->prevBlocked = NULL;
   }
          
 /***********************************************************/
@@ -317,7 +443,7 @@ globle void UnlinkBetaPMFromNodeAndLineage(
   struct partialMatch *thePM,
   int side)
   {
-   unsigned long betaLocation;
+   struct partialMatch **theBucket, **theLast;
    struct betaMemory *theMemory;
 
    if (side == LHS)
@@ -332,17 +458,17 @@ globle void UnlinkBetaPMFromNodeAndLineage(
    theMemory->count--;
    join->memoryDeletes++;
 
-   betaLocation = thePM->hashValue % theMemory->size;
+   if ((side == LHS) && (join->rangeIndex != NULL))
+     { RemoveFromRangeIndex(theEnv,execStatus,join,thePM,LHS); }
+
+   theBucket = BetaMemoryBucket(theMemory,thePM->hashValue,&theLast);
    
-   if ((side == RHS) &&
-       (theMemory->last[betaLocation] == thePM))
-     { theMemory->last[betaLocation] = thePM->prevInMemory; }
+   if ((theLast != NULL) &&
+       (*theLast == thePM))
+     { *theLast = thePM->prevInMemory; }
      
    if (thePM->prevInMemory == NULL)
-     { 
-      betaLocation = thePM->hashValue % theMemory->size;
-      theMemory->beta[betaLocation] = thePM->nextInMemory; 
-     }
+     { *theBucket = thePM->nextInMemory; }
    else
      { thePM->prevInMemory->nextInMemory = thePM->nextInMemory; }
 
@@ -354,11 +480,7 @@ globle void UnlinkBetaPMFromNodeAndLineage(
    
    UnlinkBetaPartialMatchfromAlphaAndBetaLineage(thePM);
 
-   if (! DefruleData(theEnv,execStatus)->BetaMemoryResizingFlag)
-     { return; }
-
-   if ((theMemory->count == 0) && (theMemory->size > 1))
-     { ResetBetaMemory(theEnv,execStatus,theMemory); }
+   UpdateBetaMemorySize(theEnv,execStatus,join,theMemory,thePM->hashValue);
   } 
 
 /***********************************************************/
@@ -371,9 +493,8 @@ globle void UnlinkNonLeftLineage(
   struct partialMatch *thePM,
   int side)
   {
-   unsigned long betaLocation;
+   struct partialMatch **theBucket, **theLast;
    struct betaMemory *theMemory;
-   struct partialMatch *tempPM;
 
    if (side == LHS)
      { theMemory = join->leftMemory; }
@@ -387,17 +508,17 @@ globle void UnlinkNonLeftLineage(
    theMemory->count--;
    join->memoryDeletes++;
 
-   betaLocation = thePM->hashValue % theMemory->size;
+   if ((side == LHS) && (join->rangeIndex != NULL))
+     { RemoveFromRangeIndex(theEnv,execStatus,join,thePM,LHS); }
+
+   theBucket = BetaMemoryBucket(theMemory,thePM->hashValue,&theLast);
    
-   if ((side == RHS) &&
-       (theMemory->last[betaLocation] == thePM))
-     { theMemory->last[betaLocation] = thePM->prevInMemory; }
+   if ((theLast != NULL) &&
+       (*theLast == thePM))
+     { *theLast = thePM->prevInMemory; }
      
    if (thePM->prevInMemory == NULL)
-     { 
-      betaLocation = thePM->hashValue % theMemory->size;
-      theMemory->beta[betaLocation] = thePM->nextInMemory; 
-     }
+     { *theBucket = thePM->nextInMemory; }
    else
      { thePM->prevInMemory->nextInMemory = thePM->nextInMemory; }
 
@@ -430,24 +551,9 @@ globle void UnlinkNonLeftLineage(
    /* Update the blocked lists. */
    /*===========================*/
 
-   if (thePM->prevBlocked == NULL)
-     { 
-      tempPM = (struct partialMatch *) thePM->marker;
-      
-      if (tempPM != NULL)
-        { tempPM->blockList = thePM->nextBlocked; } 
-     }
-   else
-     { thePM->prevBlocked->nextBlocked = thePM->nextBlocked; }
-
-   if (thePM->nextBlocked != NULL)
-     { thePM->nextBlocked->prevBlocked = thePM->prevBlocked; }
-
-   if (! DefruleData(theEnv,execStatus)->BetaMemoryResizingFlag)
-     { return; }
+   UnlinkBlockedPM(thePM);
 
-   if ((theMemory->count == 0) && (theMemory->size > 1))
-     { ResetBetaMemory(theEnv,execStatus,theMemory); }
+   UpdateBetaMemorySize(theEnv,execStatus,join,theMemory,thePM->hashValue);
   } 
 
 /*******************************************************************/
@@ -504,22 +610,8 @@ static void UnlinkBetaPartialMatchfromAlphaAndBetaLineage(
    /* Update the blocked lists. */
    /*===========================*/
 
-   if (thePM->prevBlocked == NULL)
-     { 
-      tempPM = (struct partialMatch *) thePM->marker;
-      
-      if (tempPM != NULL)
-        { tempPM->blockList = thePM->nextBlocked; } 
-     }
-   else
-     { thePM->prevBlocked->nextBlocked = thePM->nextBlocked; }
-
-   if (thePM->nextBlocked != NULL)
-     { thePM->nextBlocked->prevBlocked = thePM->prevBlocked; }
-
+   UnlinkBlockedPM(thePM);
    thePM->marker = NULL;
-   thePM->nextBlocked = NULL;
-   thePM->prevBlocked = NULL;
       
    /*===============================================*/
    /* Remove parent reference from the child links. */
@@ -638,6 +730,7 @@ globle struct partialMatch *CreateAlphaMatch(
    struct alphaMatch *afbtemp;
    unsigned long hashValue;
    struct alphaMemoryHash *theAlphaMemory;
+   apr_thread_mutex_t *theLock;
 
    /*==================================================*/
    /* Create the alpha match and intialize its values. */
@@ -666,9 +759,13 @@ globle struct partialMatch *CreateAlphaMatch(
    /*============================================*/
 
    hashValue = AlphaMemoryHashValue(theHeader,hashOffset);
-   theAlphaMemory = FindAlphaMemory(theEnv,execStatus,theHeader,hashValue);
    afbtemp->bucket = hashValue;
 
+   theLock = DefruleData(theEnv,execStatus)->AlphaMemoryLocks[hashValue % ALPHA_MEMORY_LOCKS];
+   apr_thread_mutex_lock(theLock);
+
+   theAlphaMemory = FindAlphaMemory(theEnv,execStatus,theHeader,hashValue);
+
    /*============================================*/
    /* Create an alpha memory if it wasn't found. */
    /*============================================*/
@@ -689,6 +786,13 @@ globle struct partialMatch *CreateAlphaMatch(
       theAlphaMemory->prev = NULL; 
       DefruleData(theEnv,execStatus)->AlphaMemoryTable[hashValue] = theAlphaMemory;
       
+      /*====================================================*/
+      /* The alpha memories of a pattern node are spread    */
+      /* over several buckets (and locks), so the list of   */
+      /* the pattern node's memories has a lock of its own. */
+      /*====================================================*/
+
+      apr_thread_mutex_lock(DefruleData(theEnv,execStatus)->AlphaHeaderLock);
       if (theHeader->firstHash == NULL)
         {
          theHeader->firstHash = theAlphaMemory;
@@ -701,25 +805,32 @@ globle struct partialMatch *CreateAlphaMatch(
          theAlphaMemory->prevHash = theHeader->lastHash;
          theHeader->lastHash = theAlphaMemory;
         }
+      apr_thread_mutex_unlock(DefruleData(theEnv,execStatus)->AlphaHeaderLock);
      }
 
-   /*====================================*/
-   /* Store the alpha match in the alpha */
-   /* memory of the pattern node.        */
-   /*====================================*/
+   /*====================================================*/
+   /* Store the alpha match in the alpha memory of the   */
+   /* pattern node. Joins scan alpha memories without    */
+   /* holding their lock, so the alpha match is appended */
+   /* with a barrier once it has been fully initialized. */
+   /*====================================================*/
  
-    theMatch->prevInMemory = theAlphaMemory->endOfQueue;
-    if (theAlphaMemory->endOfQueue == NULL)
+   StampPartialMatch(theEnv,execStatus,theMatch,NULL,NULL);
+
+   theMatch->prevInMemory = theAlphaMemory->endOfQueue;
+   if (theAlphaMemory->endOfQueue == NULL)
      {
-      theAlphaMemory->alphaMemory = theMatch;
+      apr_atomic_xchgptr((volatile void **) &theAlphaMemory->alphaMemory,theMatch);
       theAlphaMemory->endOfQueue = theMatch;
      }
    else
      {
-      theAlphaMemory->endOfQueue->nextInMemory = theMatch;
+      apr_atomic_xchgptr((volatile void **) &theAlphaMemory->endOfQueue->nextInMemory,theMatch);
       theAlphaMemory->endOfQueue = theMatch;
      }
 
+   apr_thread_mutex_unlock(theLock);
+
    /*===================================================*/
    /* Return a pointer to the newly create alpha match. */
    /*===================================================*/
@@ -1021,15 +1132,26 @@ globle struct partialMatch *GetAlphaMemory(
   unsigned long hashOffset)
   {
    struct alphaMemoryHash *theAlphaMemory;
+   struct partialMatch *theMatches = NULL;
    unsigned long hashValue;
+   apr_thread_mutex_t *theLock;
+
+   /*=======================================================*/
+   /* Taking the lock makes sure that the alpha matches     */
+   /* stamped before the caller's partial match are visible */
+   /* (see StampPartialMatch).                              */
+   /*=======================================================*/
 
    hashValue = AlphaMemoryHashValue(theHeader,hashOffset);
-   theAlphaMemory = FindAlphaMemory(theEnv,execStatus,theHeader,hashValue);
+   theLock = DefruleData(theEnv,execStatus)->AlphaMemoryLocks[hashValue % ALPHA_MEMORY_LOCKS];
 
-   if (theAlphaMemory == NULL)
-     { return NULL; }
+   apr_thread_mutex_lock(theLock);
+   theAlphaMemory = FindAlphaMemory(theEnv,execStatus,theHeader,hashValue);
+   if (theAlphaMemory != NULL)
+     { theMatches = theAlphaMemory->alphaMemory; }
+   apr_thread_mutex_unlock(theLock);
 
-   return theAlphaMemory->alphaMemory;
+   return theMatches;
   }
 
 /*****************************************/
@@ -1040,11 +1162,7 @@ globle struct partialMatch *GetLeftBetaMemory(
   struct joinNode *theJoin,
   unsigned long hashValue)
   {
-   unsigned long betaLocation;
-   
-   betaLocation = hashValue % theJoin->leftMemory->size;
-
-   return theJoin->leftMemory->beta[betaLocation];
+   return *BetaMemoryBucket(theJoin->leftMemory,hashValue,NULL);
   }
 
 /******************************************/
@@ -1055,11 +1173,7 @@ globle struct partialMatch *GetRightBetaMemory(
   struct joinNode *theJoin,
   unsigned long hashValue)
   {
-   unsigned long betaLocation;
-   
-   betaLocation = hashValue % theJoin->rightMemory->size;
-
-   return theJoin->rightMemory->beta[betaLocation];
+   return *BetaMemoryBucket(theJoin->rightMemory,hashValue,NULL);
   }
     
 /***************************************/
@@ -1071,10 +1185,16 @@ globle void ReturnLeftMemory(
   EXEC_STATUS,
   struct joinNode *theJoin)
   {
+   ReturnJoinRangeIndex(theEnv,execStatus,theJoin);
+
    if (theJoin->leftMemory == NULL) return;
+   FinishBetaMemoryResize(theEnv,execStatus,theJoin->leftMemory);
    genfree(theEnv,execStatus,theJoin->leftMemory->beta,sizeof(struct partialMatch *) * theJoin->leftMemory->size);
    rtn_struct(theEnv,execStatus,betaMemory,theJoin->leftMemory);
    theJoin->leftMemory = NULL;
+
+   if (theJoin->rightMemory == NULL)
+     { ReturnJoinLocks(theEnv,execStatus,theJoin); }
   }
 
 /***************************************/
@@ -1087,10 +1207,14 @@ globle void ReturnRightMemory(
   struct joinNode *theJoin)
   {
    if (theJoin->rightMemory == NULL) return;
+   FinishBetaMemoryResize(theEnv,execStatus,theJoin->rightMemory);
    genfree(theEnv,execStatus,theJoin->rightMemory->beta,sizeof(struct partialMatch *) * theJoin->rightMemory->size);
    genfree(theEnv,execStatus,theJoin->rightMemory->last,sizeof(struct partialMatch *) * theJoin->rightMemory->size);
    rtn_struct(theEnv,execStatus,betaMemory,theJoin->rightMemory);
    theJoin->rightMemory = NULL;
+
+   if (theJoin->leftMemory == NULL)
+     { ReturnJoinLocks(theEnv,execStatus,theJoin); }
   }
   
 /****************************************************************/
@@ -1108,6 +1232,8 @@ globle void DestroyBetaMemory(
   int side)
   {  
    unsigned long i;
+
+   CompleteBetaMemoryResize(theEnv,execStatus,theJoin);
        
    if (side == LHS)
      {
@@ -1139,6 +1265,8 @@ globle void FlushBetaMemory(
   int side)
   {
    unsigned long i;
+
+   CompleteBetaMemoryResize(theEnv,execStatus,theJoin);
    
    if (side == LHS)
      {
@@ -1207,6 +1335,8 @@ globle void RemoveAlphaMemoryMatches(
    else
      { theAlphaMemory->endOfQueue = theMatch->prevInMemory; }
 
+   RemoveAlphaMatchFromRangeIndexes(theEnv,execStatus,theHeader,theMatch);
+
    /*====================================*/
    /* Add the match to the garbage list. */
    /*====================================*/
@@ -1397,84 +1527,591 @@ unsigned long ComputeRightHashValue(
        (*EvaluationData(theEnv,execStatus)->PrimitivesArray[tempExpr->type]->evaluateFunction)(theEnv,execStatus,tempExpr->value,&theResult);
        execStatus->CurrentExpression = oldArgument;
         
-       switch (theResult.type)
-         {
-          case STRING:
-          case SYMBOL:
-          case INSTANCE_NAME:
-            hashValue += (((SYMBOL_HN *) theResult.value)->bucket * multiplier);
-            break;
-             
-          case INTEGER:
-            hashValue += (((INTEGER_HN *) theResult.value)->bucket * multiplier);
-            break;
-             
-          case FLOAT:
-            hashValue += (((FLOAT_HN *) theResult.value)->bucket * multiplier);
-            break;
-          }
-       }
+       hashValue += HashJoinValue(&theResult) * multiplier;
+      }
        
      return hashValue;
     }
 
+/*************************************************************/
+/* HashJoinValue: Returns the hash value of a value compared */
+/*   for equality by a join. The alpha and beta memories of  */
+/*   the join are hashed with this value on both sides, so   */
+/*   equal values must hash alike. A multifield combines the */
+/*   hash values of the fields in its range, a fact address  */
+/*   hashes by the fact-index, and an instance address by    */
+/*   its location since the name of a deleted instance is    */
+/*   released. Values of other types hash to zero.           */
+/*************************************************************/
+globle unsigned long HashJoinValue(
+  DATA_OBJECT *theValue)
+  {
+   struct field *theFields;
+   unsigned long hashValue;
+   long i;
+
+   if (theValue->type != MULTIFIELD)
+     { return(HashJoinField(theValue->type,theValue->value)); }
+
+   theFields = ((struct multifield *) theValue->value)->theFields;
+   hashValue = (unsigned long) (theValue->end - theValue->begin + 1);
+
+   for (i = theValue->begin; i <= theValue->end; i++)
+     { hashValue = (hashValue * 31) + HashJoinField(theFields[i].type,theFields[i].value); }
+
+   return(hashValue);
+  }
+
+/*********************************************************/
+/* HashJoinField: Returns the hash value of a single     */
+/*   field value for HashJoinValue.                      */
+/*********************************************************/
+static unsigned long HashJoinField(
+  unsigned short theType,
+  void *theValue)
+  {
+   switch (theType)
+     {
+      case STRING:
+      case SYMBOL:
+      case INSTANCE_NAME:
+        return(((SYMBOL_HN *) theValue)->bucket);
+
+      case INTEGER:
+        return(((INTEGER_HN *) theValue)->bucket);
+
+      case FLOAT:
+        return(((FLOAT_HN *) theValue)->bucket);
+
+      case FACT_ADDRESS:
+        return((unsigned long) ((struct fact *) theValue)->factIndex);
+
+#if OBJECT_SYSTEM
+      case INSTANCE_ADDRESS:
+        return((unsigned long) ((((size_t) theValue) / sizeof(INSTANCE_TYPE)) * 2654435761UL));
+#endif
+     }
+
+   return(0);
+  }
+
+/**********************************************************/
+/* InitializeJoinNetworkLocks: Creates the locks which    */
+/*   allow the matcher workers to add partial matches to  */
+/*   the alpha and beta memories concurrently.            */
+/**********************************************************/
+globle void InitializeJoinNetworkLocks(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct defruleData *theData = DefruleData(theEnv,execStatus);
+   apr_pool_t *thePool = Env(theEnv,execStatus)->memoryPool;
+   apr_status_t rv = APR_SUCCESS;
+   int i;
+
+   for (i = 0; (i < ALPHA_MEMORY_LOCKS) && (rv == APR_SUCCESS); i++)
+     { rv = apr_thread_mutex_create(&theData->AlphaMemoryLocks[i],APR_THREAD_MUTEX_DEFAULT,thePool); }
+
+   for (i = 0; (i < PARTIAL_MATCH_LOCKS) && (rv == APR_SUCCESS); i++)
+     { rv = apr_thread_mutex_create(&theData->PartialMatchLocks[i],APR_THREAD_MUTEX_DEFAULT,thePool); }
+
+   if (rv == APR_SUCCESS)
+     { rv = apr_thread_mutex_create(&theData->AlphaHeaderLock,APR_THREAD_MUTEX_DEFAULT,thePool); }
+   if (rv == APR_SUCCESS)
+     { rv = apr_thread_mutex_create(&theData->MemoryTagLock,APR_THREAD_MUTEX_DEFAULT,thePool); }
+
+   if (rv != APR_SUCCESS)
+     {
+      SystemError(theEnv,execStatus,"RETEUTIL",1);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
+
+   theData->CurrentMemoryTag = 0;
+   theData->FreeJoinLocks = NULL;
+  }
+
+/*********************************************************/
+/* AttachJoinLocks: Gives a join with beta memories the  */
+/*   locks guarding them. The locks are recycled when    */
+/*   the memories of a join are returned, since they are */
+/*   allocated from the environment's memory pool.       */
+/*********************************************************/
+globle void AttachJoinLocks(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin)
+  {
+   struct joinLocks *theLocks;
+   apr_pool_t *thePool = Env(theEnv,execStatus)->memoryPool;
+   int i;
+
+   if (theJoin->memoryLocks != NULL) return;
+
+   theLocks = DefruleData(theEnv,execStatus)->FreeJoinLocks;
+   if (theLocks != NULL)
+     { DefruleData(theEnv,execStatus)->FreeJoinLocks = theLocks->next; }
+   else
+     {
+      theLocks = (struct joinLocks *) apr_palloc(thePool,sizeof(struct joinLocks));
+      for (i = 0; i < BETA_MEMORY_LOCKS; i++)
+        {
+         if ((theLocks == NULL) ||
+             (apr_thread_mutex_create(&theLocks->shard[i],APR_THREAD_MUTEX_NESTED,thePool) != APR_SUCCESS))
+           {
+            SystemError(theEnv,execStatus,"RETEUTIL",2);
+            EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+           }
+        }
+     }
+
+   theLocks->next = NULL;
+   theJoin->memoryLocks = theLocks;
+  }
+
+/******************************************************/
+/* ReturnJoinLocks: Puts the locks of a join which no */
+/*   longer has beta memories on the freelist.        */
+/******************************************************/
+static void ReturnJoinLocks(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin)
+  {
+   struct joinLocks *theLocks = theJoin->memoryLocks;
+
+   if (theLocks == NULL) return;
+
+   theLocks->next = DefruleData(theEnv,execStatus)->FreeJoinLocks;
+   DefruleData(theEnv,execStatus)->FreeJoinLocks = theLocks;
+   theJoin->memoryLocks = NULL;
+  }
+
 /***********************************************************/
-/* ResizeBetaMemory:                                */
+/* JoinMemoryLock: Returns the lock guarding the bucket of */
+/*   a join's beta memories for the given hash value. The  */
+/*   buckets of unhashed memories share a single lock.     */
 /***********************************************************/
-globle void ResizeBetaMemory(
+static apr_thread_mutex_t *JoinMemoryLock(
+  struct joinNode *theJoin,
+  unsigned long hashValue)
+  {
+   if (theJoin->memoryLocks == NULL) return(NULL);
+
+   if (theJoin->leftHash == NULL)
+     { return(theJoin->memoryLocks->shard[0]); }
+
+   return(theJoin->memoryLocks->shard[hashValue % BETA_MEMORY_LOCKS]);
+  }
+
+/*************************************************************/
+/* LockJoinMemory: Locks the bucket of the beta memories of  */
+/*   a join for the given hash value. The lock is held while */
+/*   a partial match entering the join is compared against   */
+/*   the opposite memory and while its descendants are       */
+/*   propagated. Since the joins below only lock their own   */
+/*   buckets, locks are always taken in network order.       */
+/*************************************************************/
+globle void LockJoinMemory(
+  struct joinNode *theJoin,
+  unsigned long hashValue)
+  {
+   apr_thread_mutex_t *theLock = JoinMemoryLock(theJoin,hashValue);
+
+   if (theLock != NULL) apr_thread_mutex_lock(theLock);
+  }
+
+/*****************************************************/
+/* UnlockJoinMemory: Releases a lock acquired with   */
+/*   LockJoinMemory.                                 */
+/*****************************************************/
+globle void UnlockJoinMemory(
+  struct joinNode *theJoin,
+  unsigned long hashValue)
+  {
+   apr_thread_mutex_t *theLock = JoinMemoryLock(theJoin,hashValue);
+
+   if (theLock != NULL) apr_thread_mutex_unlock(theLock);
+  }
+
+/************************************************************/
+/* PartialMatchLock: Returns the lock guarding the children */
+/*   and block lists of a partial match.                    */
+/************************************************************/
+static apr_thread_mutex_t *PartialMatchLock(
+  void *theEnv,
+  EXEC_STATUS,
+  struct partialMatch *thePM)
+  {
+   unsigned long theLocation;
+
+   theLocation = (((unsigned long) thePM) >> 6) % PARTIAL_MATCH_LOCKS;
+
+   return(DefruleData(theEnv,execStatus)->PartialMatchLocks[theLocation]);
+  }
+
+/*****************************************************************/
+/* StampPartialMatch: Gives a partial match which is about to be */
+/*   stored in an alpha or beta memory the next memory tag and,  */
+/*   for beta memories, updates the memory's counters. The       */
+/*   caller holds the lock of the memory's bucket until the      */
+/*   partial match has been linked into the memory. A partial    */
+/*   match entering a join is compared on a matcher worker only  */
+/*   with partial matches of the opposite memory stamped before  */
+/*   it: since each side locks the other side's bucket after     */
+/*   being stamped, those are visible, while a pair of partial   */
+/*   matches added at the same time is joined by exactly one of  */
+/*   the two workers.                                            */
+/*****************************************************************/
+static void StampPartialMatch(
   void *theEnv,
   EXEC_STATUS,
+  struct partialMatch *thePM,
+  struct joinNode *theJoin,
   struct betaMemory *theMemory)
   {
-   struct partialMatch **oldArray, **lastAdd, *thePM, *nextPM;
-   unsigned long i, oldSize, betaLocation;
-   
-   oldSize = theMemory->size;
-   oldArray = theMemory->beta;
-   
-   theMemory->size = oldSize * 11;
-   theMemory->beta = (struct partialMatch **) genalloc(theEnv,execStatus,sizeof(struct partialMatch *) * theMemory->size);
-     
-   lastAdd = (struct partialMatch **) genalloc(theEnv,execStatus,sizeof(struct partialMatch *) * theMemory->size);
-   memset(theMemory->beta,0,sizeof(struct partialMatch *) * theMemory->size);
-   memset(lastAdd,0,sizeof(struct partialMatch *) * theMemory->size);
-   
-   for (i = 0; i < oldSize; i++)
+   struct defruleData *theData = DefruleData(theEnv,execStatus);
+
+   apr_thread_mutex_lock(theData->MemoryTagLock);
+
+   thePM->memoryTag = ++theData->CurrentMemoryTag;
+
+   if (theMemory != NULL)
      {
-      thePM = oldArray[i];
+      theMemory->count++;
+      theJoin->memoryAdds++;
+     }
+
+   apr_thread_mutex_unlock(theData->MemoryTagLock);
+  }
+
+/*************************************************************/
+/* LockJoinMemories: Takes all of the bucket locks of the    */
+/*   beta memories of a join (in order).                     */
+/*************************************************************/
+static void LockJoinMemories(
+  struct joinNode *theJoin)
+  {
+   int i;
+
+   if (theJoin->memoryLocks == NULL) return;
+
+   for (i = 0; i < BETA_MEMORY_LOCKS; i++)
+     { apr_thread_mutex_lock(theJoin->memoryLocks->shard[i]); }
+  }
+
+/*************************************************************/
+/* UnlockJoinMemories: Releases the locks acquired with      */
+/*   LockJoinMemories.                                       */
+/*************************************************************/
+static void UnlockJoinMemories(
+  struct joinNode *theJoin)
+  {
+   int i;
+
+   if (theJoin->memoryLocks == NULL) return;
+
+   for (i = BETA_MEMORY_LOCKS - 1; i >= 0; i--)
+     { apr_thread_mutex_unlock(theJoin->memoryLocks->shard[i]); }
+  }
+
+/*************************************************************/
+/* BetaMemoryBucket: Returns the location of the bucket of a */
+/*   beta memory for the given hash value and, for memories  */
+/*   which keep track of the last partial match of each      */
+/*   bucket, the location of that partial match. While the   */
+/*   memory is being resized, the buckets which have not yet */
+/*   been moved are found in the old table.                  */
+/*************************************************************/
+static struct partialMatch **BetaMemoryBucket(
+  struct betaMemory *theMemory,
+  unsigned long hashValue,
+  struct partialMatch ***lastPtr)
+  {
+   struct betaResize *theResize = theMemory->resize;
+   unsigned long betaLocation;
+
+   if (theResize != NULL)
+     {
+      betaLocation = hashValue % theResize->oldSize;
+
+      if ((betaLocation / BETA_MEMORY_LOCKS) >= theResize->moved[betaLocation % BETA_MEMORY_LOCKS])
+        {
+         if (lastPtr != NULL)
+           { *lastPtr = (theResize->oldLast == NULL) ? NULL : &theResize->oldLast[betaLocation]; }
+
+         return(&theResize->oldBeta[betaLocation]);
+        }
+     }
+
+   betaLocation = hashValue % theMemory->size;
+
+   if (lastPtr != NULL)
+     { *lastPtr = (theMemory->last == NULL) ? NULL : &theMemory->last[betaLocation]; }
+
+   return(&theMemory->beta[betaLocation]);
+  }
+
+/***************************************************************/
+/* MoveBetaBuckets: Moves up to maxBuckets of the old buckets  */
+/*   of a stripe of a beta memory being resized to the new     */
+/*   table. The caller holds the lock of the stripe. Partial   */
+/*   matches are appended to their new buckets in order, so a  */
+/*   memory which has been grown lists its partial matches in  */
+/*   the same order as if it had been rehashed all at once.    */
+/*   Returns TRUE if the last unfinished stripe was completed. */
+/***************************************************************/
+static intBool MoveBetaBuckets(
+  struct betaMemory *theMemory,
+  unsigned long stripe,
+  unsigned long maxBuckets)
+  {
+   struct betaResize *theResize = theMemory->resize;
+   struct partialMatch *thePM, *nextPM, *lastPM;
+   unsigned long stripeSize, oldLocation, betaLocation;
+
+   stripeSize = theResize->oldSize / BETA_MEMORY_LOCKS;
+
+   if (theResize->moved[stripe] >= stripeSize)
+     { return(FALSE); }
+
+   while ((maxBuckets > 0) && (theResize->moved[stripe] < stripeSize))
+     {
+      oldLocation = (theResize->moved[stripe] * BETA_MEMORY_LOCKS) + stripe;
+
+      thePM = theResize->oldBeta[oldLocation];
+      theResize->oldBeta[oldLocation] = NULL;
+      if (theResize->oldLast != NULL)
+        { theResize->oldLast[oldLocation] = NULL; }
+
       while (thePM != NULL)
         {
          nextPM = thePM->nextInMemory;
-         
-         thePM->nextInMemory = NULL;
-         
+
          betaLocation = thePM->hashValue % theMemory->size;
-         thePM->prevInMemory = lastAdd[betaLocation];
-         
-         if (lastAdd[betaLocation] != NULL)
-           { lastAdd[betaLocation]->nextInMemory = thePM; }
+
+         if (theMemory->last != NULL)
+           { lastPM = theMemory->last[betaLocation]; }
+         else
+           {
+            lastPM = theMemory->beta[betaLocation];
+            while ((lastPM != NULL) && (lastPM->nextInMemory != NULL))
+              { lastPM = lastPM->nextInMemory; }
+           }
+
+         thePM->nextInMemory = NULL;
+         thePM->prevInMemory = lastPM;
+
+         if (lastPM != NULL)
+           { lastPM->nextInMemory = thePM; }
          else
            { theMemory->beta[betaLocation] = thePM; }
-           
-         lastAdd[betaLocation] = thePM;
-         
+
+         if (theMemory->last != NULL)
+           { theMemory->last[betaLocation] = thePM; }
+
          thePM = nextPM;
-        } 
+        }
+
+      theResize->moved[stripe]++;
+      maxBuckets--;
      }
-  
-   if (theMemory->last != NULL)
-     { 
-      genfree(theEnv,execStatus,theMemory->last,sizeof(struct partialMatch *) * oldSize);
-      theMemory->last = lastAdd;
+
+   if (theResize->moved[stripe] < stripeSize)
+     { return(FALSE); }
+
+   return(apr_atomic_dec32(&theResize->pendingStripes) == 0);
+  }
+
+/*************************************************************/
+/* StartBetaMemoryResize: Allocates the new table of a beta  */
+/*   memory and keeps the old one until all of its buckets   */
+/*   have been moved. The caller holds all of the locks of   */
+/*   the memory's join.                                      */
+/*************************************************************/
+static void StartBetaMemoryResize(
+  void *theEnv,
+  EXEC_STATUS,
+  struct betaMemory *theMemory,
+  unsigned long newSize)
+  {
+   struct betaResize *theResize;
+
+   theResize = get_struct(theEnv,execStatus,betaResize);
+   theResize->oldSize = theMemory->size;
+   theResize->oldBeta = theMemory->beta;
+   theResize->oldLast = theMemory->last;
+   memset(theResize->moved,0,sizeof(theResize->moved));
+   apr_atomic_set32(&theResize->pendingStripes,BETA_MEMORY_LOCKS);
+
+   theMemory->size = newSize;
+   theMemory->beta = (struct partialMatch **) genalloc(theEnv,execStatus,sizeof(struct partialMatch *) * newSize);
+   memset(theMemory->beta,0,sizeof(struct partialMatch *) * newSize);
+
+   if (theResize->oldLast != NULL)
+     {
+      theMemory->last = (struct partialMatch **) genalloc(theEnv,execStatus,sizeof(struct partialMatch *) * newSize);
+      memset(theMemory->last,0,sizeof(struct partialMatch *) * newSize);
      }
-   else
-     { genfree(theEnv,execStatus,lastAdd,sizeof(struct partialMatch *) * theMemory->size); }
-     
-   genfree(theEnv,execStatus,oldArray,sizeof(struct partialMatch *) * oldSize);
+
+   theMemory->resize = theResize;
+  }
+
+/*************************************************************/
+/* FinishBetaMemoryResize: Releases the old table of a beta  */
+/*   memory once all of its buckets have been moved (or the  */
+/*   memory is empty or being returned).                     */
+/*************************************************************/
+static void FinishBetaMemoryResize(
+  void *theEnv,
+  EXEC_STATUS,
+  struct betaMemory *theMemory)
+  {
+   struct betaResize *theResize = theMemory->resize;
+
+   if (theResize == NULL) return;
+
+   genfree(theEnv,execStatus,theResize->oldBeta,sizeof(struct partialMatch *) * theResize->oldSize);
+   if (theResize->oldLast != NULL)
+     { genfree(theEnv,execStatus,theResize->oldLast,sizeof(struct partialMatch *) * theResize->oldSize); }
+
+   rtn_struct(theEnv,execStatus,betaResize,theResize);
+   theMemory->resize = NULL;
+  }
+
+/*************************************************************/
+/* EndJoinMemoryResize: Called by the thread which moved the */
+/*   last old bucket of a beta memory once it has released   */
+/*   the lock of the bucket's stripe.                        */
+/*************************************************************/
+static void EndJoinMemoryResize(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin,
+  struct betaMemory *theMemory)
+  {
+   LockJoinMemories(theJoin);
+
+   if ((theMemory->resize != NULL) &&
+       (apr_atomic_read32(&theMemory->resize->pendingStripes) == 0))
+     { FinishBetaMemoryResize(theEnv,execStatus,theMemory); }
+
+   UnlockJoinMemories(theJoin);
+  }
+
+/*************************************************************/
+/* CompleteBetaMemoryResize: Moves the remaining old buckets */
+/*   of both beta memories of a join. Called before all of   */
+/*   the buckets of a memory are traversed.                  */
+/*************************************************************/
+globle void CompleteBetaMemoryResize(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin)
+  {
+   struct betaMemory *theMemory;
+   unsigned long stripe;
+   int side;
+
+   LockJoinMemories(theJoin);
+
+   for (side = 0; side < 2; side++)
+     {
+      theMemory = (side == 0) ? theJoin->leftMemory : theJoin->rightMemory;
+      if ((theMemory == NULL) || (theMemory->resize == NULL)) continue;
+
+      for (stripe = 0; stripe < BETA_MEMORY_LOCKS; stripe++)
+        { MoveBetaBuckets(theMemory,stripe,theMemory->resize->oldSize); }
+
+      FinishBetaMemoryResize(theEnv,execStatus,theMemory);
+     }
+
+   UnlockJoinMemories(theJoin);
   }
 
 /***********************************************************/
-/* ResetBetaMemory:                                */
+/* ResizeJoinMemory: Starts growing (or, if enabled,       */
+/*   shrinking) one of the beta memories of a join. All of */
+/*   the join's bucket locks are taken since the memory's  */
+/*   table is replaced. The buckets are then moved a few   */
+/*   at a time by the threads which update the memory.     */
+/***********************************************************/
+static void ResizeJoinMemory(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin,
+  struct betaMemory *theMemory)
+  {
+   struct defruleData *theData = DefruleData(theEnv,execStatus);
+   unsigned long newSize;
+
+   LockJoinMemories(theJoin);
+
+   if (theMemory->resize == NULL)
+     {
+      if (theMemory->count > (theMemory->size * BETA_MEMORY_LOAD_FACTOR))
+        { StartBetaMemoryResize(theEnv,execStatus,theMemory,theMemory->size * theData->BetaMemoryGrowthFactor); }
+      else if (theData->BetaMemoryShrinkingFlag &&
+               (theMemory->size > INITIAL_BETA_HASH_SIZE) &&
+               ((theMemory->count * theData->BetaMemoryGrowthFactor) < theMemory->size))
+        {
+         newSize = theMemory->size / theData->BetaMemoryGrowthFactor;
+         newSize -= newSize % INITIAL_BETA_HASH_SIZE;
+         if (newSize < INITIAL_BETA_HASH_SIZE)
+           { newSize = INITIAL_BETA_HASH_SIZE; }
+
+         StartBetaMemoryResize(theEnv,execStatus,theMemory,newSize);
+        }
+     }
+
+   /*==============================================*/
+   /* Without locks the memory is only updated by  */
+   /* a single thread, so all buckets are moved at */
+   /* once.                                        */
+   /*==============================================*/
+
+   UnlockJoinMemories(theJoin);
+
+   if ((theJoin->memoryLocks == NULL) && (theMemory->resize != NULL))
+     { CompleteBetaMemoryResize(theEnv,execStatus,theJoin); }
+  }
+
+/*************************************************************/
+/* UpdateBetaMemorySize: Called after a partial match has    */
+/*   been removed from a beta memory (which only happens     */
+/*   while the matcher workers are idle). Continues a resize */
+/*   in progress, resets an empty memory to its initial size */
+/*   and, if enabled, starts shrinking a sparse memory.      */
+/*************************************************************/
+static void UpdateBetaMemorySize(
+  void *theEnv,
+  EXEC_STATUS,
+  struct joinNode *theJoin,
+  struct betaMemory *theMemory,
+  unsigned long hashValue)
+  {
+   struct defruleData *theData = DefruleData(theEnv,execStatus);
+
+   if (theMemory->resize != NULL)
+     {
+      if (MoveBetaBuckets(theMemory,hashValue % BETA_MEMORY_LOCKS,BETA_RESIZE_STEP))
+        { EndJoinMemoryResize(theEnv,execStatus,theJoin,theMemory); }
+     }
+
+   if (! theData->BetaMemoryResizingFlag)
+     { return; }
+
+   if ((theMemory->count == 0) && (theMemory->size > 1))
+     { ResetBetaMemory(theEnv,execStatus,theMemory); }
+   else if (theData->BetaMemoryShrinkingFlag &&
+            (theMemory->resize == NULL) &&
+            (theMemory->size > INITIAL_BETA_HASH_SIZE) &&
+            ((theMemory->count * theData->BetaMemoryGrowthFactor) < theMemory->size))
+     { ResizeJoinMemory(theEnv,execStatus,theJoin,theMemory); }
+  }
+
+/***********************************************************/
+/* ResetBetaMemory: Returns an empty beta memory to its    */
+/*   initial size, dropping any resize in progress.        */
 /***********************************************************/
 static void ResetBetaMemory(
   void *theEnv,
@@ -1484,6 +2121,8 @@ static void ResetBetaMemory(
    struct partialMatch **oldArray, **lastAdd;
    unsigned long oldSize;
 
+   FinishBetaMemoryResize(theEnv,execStatus,theMemory);
+
    if ((theMemory->size == 1) ||
        (theMemory->size == INITIAL_BETA_HASH_SIZE))
      { return; }
@@ -58,6 +58,7 @@
    LOCALE void                           ReturnRightMemory(void *,EXEC_STATUS,struct joinNode *);
    LOCALE void                           DestroyBetaMemory(void *,EXEC_STATUS,struct joinNode *,int);
    LOCALE void                           FlushBetaMemory(void *,EXEC_STATUS,struct joinNode *,int);
+   LOCALE void                           CompleteBetaMemoryResize(void *,EXEC_STATUS,struct joinNode *);
    LOCALE intBool                        BetaMemoryNotEmpty(struct joinNode *);
    LOCALE void                           RemoveAlphaMemoryMatches(void *,EXEC_STATUS,struct patternNodeHeader *,struct partialMatch *,
                                                                   struct alphaMatch *); 
@@ -75,14 +76,21 @@
    LOCALE void                           TagRuleNetwork(void *,EXEC_STATUS,long *,long *,long *,long *);
    LOCALE int                            FindEntityInPartialMatch(struct patternEntity *,struct partialMatch *);
    LOCALE unsigned long                  ComputeRightHashValue(void *,EXEC_STATUS,struct patternNodeHeader *);
+   LOCALE unsigned long                  HashJoinValue(DATA_OBJECT *);
    LOCALE void                           UpdateBetaPMLinks(void *,EXEC_STATUS,struct partialMatch *,struct partialMatch *,struct partialMatch *,
                                                        struct joinNode *,unsigned long,int);
    LOCALE void                           UnlinkBetaPMFromNodeAndLineage(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *,int);
    LOCALE void                           UnlinkNonLeftLineage(void *,EXEC_STATUS,struct joinNode *,struct partialMatch *,int);
    LOCALE struct partialMatch           *CreateEmptyPartialMatch(void *,EXEC_STATUS);
+   LOCALE struct partialMatchLinks      *GetPartialMatchLinks(void *,EXEC_STATUS,struct partialMatch *);
+   LOCALE void                           ReturnPartialMatchLinks(void *,EXEC_STATUS,struct partialMatch *);
    LOCALE void                           MarkRuleJoins(struct joinNode *,int);
-   LOCALE void                           AddBlockedLink(struct partialMatch *,struct partialMatch *);
+   LOCALE void                           AddBlockedLink(void *,EXEC_STATUS,struct partialMatch *,struct partialMatch *);
    LOCALE void                           RemoveBlockedLink(struct partialMatch *);
+   LOCALE void                           InitializeJoinNetworkLocks(void *,EXEC_STATUS);
+   LOCALE void                           AttachJoinLocks(void *,EXEC_STATUS,struct joinNode *);
+   LOCALE void                           LockJoinMemory(struct joinNode *,unsigned long);
+   LOCALE void                           UnlockJoinMemory(struct joinNode *,unsigned long);
 #endif
 
 
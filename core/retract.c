@@ -54,6 +54,7 @@
 #include "match.h"
 #include "memalloc.h"
 #include "network.h"
+#include "prntutil.h"
 #include "reteutil.h"
 #include "router.h"
 #include "symbol.h"
@@ -94,7 +95,7 @@ globle void NetworkRetract(
       if (tempMatch->theMatch->children != NULL)
         { PosEntryRetractAlpha(theEnv,execStatus,tempMatch->theMatch); }
 
-      if (tempMatch->theMatch->blockList != NULL)
+      if (get_pm_block_list(tempMatch->theMatch) != NULL)
         { NegEntryRetractAlpha(theEnv,execStatus,tempMatch->theMatch); }
       
       /*===================================================*/
@@ -163,7 +164,7 @@ static void NegEntryRetractAlpha(
    struct partialMatch *betaMatch;
    struct joinNode *joinPtr;
    
-   betaMatch = alphaMatch->blockList;
+   betaMatch = get_pm_block_list(alphaMatch);
    while (betaMatch != NULL)
      {
       joinPtr = (struct joinNode *) betaMatch->owner;
@@ -173,12 +174,12 @@ static void NegEntryRetractAlpha(
           (! joinPtr->joinFromTheRight))
         {               
          SystemError(theEnv,execStatus,"RETRACT",117);
-         betaMatch = betaMatch->nextBlocked;
+         betaMatch = get_pm_next_blocked(betaMatch);
          continue;
         }
 
       NegEntryRetractBeta(theEnv,execStatus,joinPtr,alphaMatch,betaMatch);
-      betaMatch = alphaMatch->blockList;
+      betaMatch = get_pm_block_list(alphaMatch);
      }
   }
 
@@ -267,7 +268,7 @@ globle void PosEntryRetractBeta(
          betaMatch->leftParent->children = NULL; 
         }
 
-      if (betaMatch->blockList != NULL)
+      if (get_pm_block_list(betaMatch) != NULL)
         { NegEntryRetractAlpha(theEnv,execStatus,betaMatch); }
       else if ((((struct joinNode *) betaMatch->owner)->ruleToActivate != NULL) ?
                (betaMatch->marker != NULL) : FALSE)
@@ -278,7 +279,7 @@ globle void PosEntryRetractBeta(
       else
         { UnlinkNonLeftLineage(theEnv,execStatus,(struct joinNode *) betaMatch->owner,betaMatch,LHS); } 
 
-      if (betaMatch->dependents != NULL) RemoveLogicalSupport(theEnv,execStatus,betaMatch);
+      if (get_pm_dependents(betaMatch) != NULL) RemoveLogicalSupport(theEnv,execStatus,betaMatch);
       ReturnPartialMatch(theEnv,execStatus,betaMatch);
     
       if (tempMatch == parentMatch) return;
@@ -321,9 +322,9 @@ static intBool FindNextConflictingMatch(
      {
       oldLHSBinds = LocalEngineData(theEnv,execStatus).LHSBinds;
       oldRHSBinds = LocalEngineData(theEnv,execStatus).RHSBinds;
-      oldJoin = EngineData(theEnv,execStatus)->GlobalJoin;
+      oldJoin = LocalEngineData(theEnv,execStatus).GlobalJoin;
       LocalEngineData(theEnv,execStatus).LHSBinds = theBind;
-      EngineData(theEnv,execStatus)->GlobalJoin = theJoin;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = theJoin;
       restore = TRUE;
      }
 
@@ -403,10 +404,10 @@ static intBool FindNextConflictingMatch(
 
       if (result != FALSE)
         {
-         AddBlockedLink(theBind,possibleConflicts);
+         AddBlockedLink(theEnv,execStatus,theBind,possibleConflicts);
          LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
          LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-         EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+         LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
          return(TRUE);
         }
      }
@@ -415,7 +416,7 @@ static intBool FindNextConflictingMatch(
      {
       LocalEngineData(theEnv,execStatus).LHSBinds = oldLHSBinds;
       LocalEngineData(theEnv,execStatus).RHSBinds = oldRHSBinds;
-      EngineData(theEnv,execStatus)->GlobalJoin = oldJoin;
+      LocalEngineData(theEnv,execStatus).GlobalJoin = oldJoin;
      }
 
    /*========================*/
@@ -475,7 +476,7 @@ void DeletePartialMatches(
       /* result of a logical CE.                        */
       /*================================================*/
 
-      if (listOfPMs->dependents != NULL) RemoveLogicalSupport(theEnv,execStatus,listOfPMs);
+      if (get_pm_dependents(listOfPMs) != NULL) RemoveLogicalSupport(theEnv,execStatus,listOfPMs);
 
       /*==========================================================*/
       /* If the partial match is being deleted from a beta memory */
@@ -542,12 +543,13 @@ globle void ReturnPartialMatch(
    /* the logical CE.                                 */
    /*=================================================*/
 
-   if (waste->dependents != NULL) RemovePMDependencies(theEnv,execStatus,waste);
+   if (get_pm_dependents(waste) != NULL) RemovePMDependencies(theEnv,execStatus,waste);
 
    /*======================================================*/
    /* Return the partial match to the pool of free memory. */
    /*======================================================*/
 
+   ReturnPartialMatchLinks(theEnv,execStatus,waste);
    rtn_var_struct(theEnv,execStatus,partialMatch,(int) sizeof(struct genericMatch *) *
                   (waste->bcount - 1),
                   waste);
@@ -582,12 +584,13 @@ globle void DestroyPartialMatch(
    /* the logical CE.                                 */
    /*=================================================*/
 
-   if (waste->dependents != NULL) DestroyPMDependencies(theEnv,execStatus,waste);
+   if (get_pm_dependents(waste) != NULL) DestroyPMDependencies(theEnv,execStatus,waste);
 
    /*======================================================*/
    /* Return the partial match to the pool of free memory. */
    /*======================================================*/
 
+   ReturnPartialMatchLinks(theEnv,execStatus,waste);
    rtn_var_struct(theEnv,execStatus,partialMatch,(int) sizeof(struct genericMatch *) *
                   (waste->bcount - 1),
                   waste);
@@ -664,5 +667,103 @@ globle void FlushGarbagePartialMatches(
      }
   }
 
+/****************************************************************/
+/* DeferRetractBeta: Called by a matcher worker for a partial   */
+/*   match which has just been blocked by a not CE or a join    */
+/*   from the right while it still has children. Since partial */
+/*   matches are only removed from the join network while no    */
+/*   worker is running, the retraction of the children is      */
+/*   queued until the matching tasks have completed. The        */
+/*   partial match is marked busy so that it is not freed if    */
+/*   it is retracted itself in the meantime.                    */
+/****************************************************************/
+globle void DeferRetractBeta(
+  void *theEnv,
+  EXEC_STATUS,
+  struct partialMatch *theMatch)
+  {
+   struct engineData *theData = EngineData(theEnv,execStatus);
+   struct deferredRetraction *newList;
+   unsigned long newMax;
+
+   apr_thread_mutex_lock(theData->DeferredRetractionLock);
+
+   if (theData->DeferredRetractionCount == theData->DeferredRetractionMax)
+     {
+      if (theData->DeferredRetractionMax == 0)
+        { newMax = INITIAL_DEFERRED_RETRACTIONS; }
+      else
+        { newMax = theData->DeferredRetractionMax * 2; }
+
+      newList = (struct deferredRetraction *)
+                realloc(theData->DeferredRetractions,sizeof(struct deferredRetraction) * newMax);
+      if (newList == NULL)
+        {
+         apr_thread_mutex_unlock(theData->DeferredRetractionLock);
+         SystemError(theEnv,execStatus,"RETRACT",1);
+         EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+         return;
+        }
+
+      theData->DeferredRetractions = newList;
+      theData->DeferredRetractionMax = newMax;
+     }
+
+   theData->DeferredRetractions[theData->DeferredRetractionCount].theMatch = theMatch;
+   theData->DeferredRetractions[theData->DeferredRetractionCount].wasBusy = theMatch->busy;
+   theData->DeferredRetractionCount++;
+   theMatch->busy = TRUE;
+
+   apr_thread_mutex_unlock(theData->DeferredRetractionLock);
+  }
+
+/**************************************************************/
+/* FlushDeferredRetractions: Retracts the children of the     */
+/*   partial matches queued by DeferRetractBeta. Must only be */
+/*   called while the join network is locked for writing.     */
+/*   Returns TRUE if any retraction was queued.               */
+/**************************************************************/
+globle intBool FlushDeferredRetractions(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct engineData *theData = EngineData(theEnv,execStatus);
+   struct deferredRetraction *theList;
+   struct partialMatch *theMatch;
+   unsigned long i, theCount;
+
+   apr_thread_mutex_lock(theData->DeferredRetractionLock);
+   theList = theData->DeferredRetractions;
+   theCount = theData->DeferredRetractionCount;
+   if (theCount != 0)
+     {
+      theData->DeferredRetractions = NULL;
+      theData->DeferredRetractionCount = 0;
+      theData->DeferredRetractionMax = 0;
+     }
+   apr_thread_mutex_unlock(theData->DeferredRetractionLock);
+
+   if (theCount == 0) return(FALSE);
+
+   /*=====================================================*/
+   /* A queued partial match which has been retracted by */
+   /* an earlier entry no longer has children and is on  */
+   /* the garbage list, where restoring its busy flag    */
+   /* allows it to be returned.                          */
+   /*=====================================================*/
+
+   for (i = 0; i < theCount; i++)
+     {
+      theMatch = theList[i].theMatch;
+      if (theMatch->children != NULL)
+        { PosEntryRetractBeta(theEnv,execStatus,theMatch,theMatch->children); }
+      theMatch->busy = theList[i].wasBusy;
+     }
+
+   free(theList);
+
+   return(TRUE);
+  }
+
 #endif /* DEFRULE_CONSTRUCT */
 
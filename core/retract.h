@@ -62,6 +62,8 @@ LOCALE void                           FlushGarbagePartialMatches(void *,EXEC_STA
 LOCALE void                           DeletePartialMatches(void *,EXEC_STATUS,struct partialMatch *);
 LOCALE void                           PosEntryRetractBeta(void *,EXEC_STATUS,struct partialMatch *,struct partialMatch *);
 LOCALE void                           PosEntryRetractAlpha(void *,EXEC_STATUS,struct partialMatch *);
+LOCALE void                           DeferRetractBeta(void *,EXEC_STATUS,struct partialMatch *);
+LOCALE intBool                        FlushDeferredRetractions(void *,EXEC_STATUS);
 
 #endif
 
@@ -48,11 +48,13 @@
 #include "envrnmnt.h"
 #include "reteutil.h"
 #include "agenda.h"
+#include "crstrtgy.h"
 #include "engine.h"
 #include "retract.h"
 #include "rulebsc.h"
 #include "pattern.h"
 #include "moduldef.h"
+#include "ordmem.h"
 
 #include "rulebin.h"
 
@@ -81,6 +83,7 @@
    static void                    UpdateLink(void *,EXEC_STATUS,void *,long);
    static void                    ClearBload(void *,EXEC_STATUS);
    static void                    DeallocateDefruleBloadData(void *,EXEC_STATUS);
+   static void                    CreateBloadRangeIndexes(void *,EXEC_STATUS);
 
 /*****************************************************/
 /* DefruleBinarySetup: Installs the binary save/load */
@@ -102,6 +105,9 @@ globle void DefruleBinarySetup(
    AddBinaryItem(theEnv,execStatus,"defrule",20,NULL,NULL,NULL,NULL,
                              BloadStorage,BloadBinaryItem,
                              ClearBload);
+#endif
+#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE
+   AddAfterBloadFunction(theEnv,execStatus,"defrule",CreateBloadRangeIndexes,0);
 #endif
   }
 
@@ -119,6 +125,7 @@ static void DeallocateDefruleBloadData(
    struct defruleModule *theModuleItem;
    struct activation *theActivation, *tmpActivation;
    struct salienceGroup *theGroup, *tmpGroup;
+   struct defrule *theRule;
 
    for (i = 0; i < DefruleBinaryData(theEnv,execStatus)->NumberOfJoins; i++)
      { 
@@ -131,12 +138,26 @@ static void DeallocateDefruleBloadData(
    for (i = 0; i < DefruleBinaryData(theEnv,execStatus)->NumberOfDefruleModules; i++)
      {
       theModuleItem = &DefruleBinaryData(theEnv,execStatus)->ModuleArray[i];
+
+      for (theRule = theModuleItem->pendingRules;
+           theRule != NULL;
+           theRule = theRule->nextPending)
+        {
+         theActivation = theRule->pendingActivations;
+         while (theActivation != NULL)
+           {
+            tmpActivation = theActivation->next;
+            rtn_struct(theEnv,execStatus,activation,theActivation);
+            theActivation = tmpActivation;
+           }
+        }
       
       theActivation = theModuleItem->agenda;
       while (theActivation != NULL)
         {
          tmpActivation = theActivation->next;
          
+         ReturnActivationIndex(theEnv,execStatus,theActivation);
          rtn_struct(theEnv,execStatus,activation,theActivation);
          
          theActivation = tmpActivation;
@@ -916,6 +937,7 @@ static void UpdateDefruleModule(
                              (void *) DefruleBinaryData(theEnv,execStatus)->DefruleArray);
    DefruleBinaryData(theEnv,execStatus)->ModuleArray[obji].agenda = NULL;
    DefruleBinaryData(theEnv,execStatus)->ModuleArray[obji].groupings = NULL;
+   DefruleBinaryData(theEnv,execStatus)->ModuleArray[obji].pendingRules = NULL;
 
   }
 
@@ -948,6 +970,9 @@ static void UpdateDefrule(
    DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].autoFocus = br->autoFocus;
    DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].executing = 0;
    DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].afterBreakpoint = 0;
+   DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].pendingActivations = NULL;
+   DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].prevPending = NULL;
+   DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].nextPending = NULL;
 #if DEBUGGING_FUNCTIONS
    DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].watchActivation = AgendaData(theEnv,execStatus)->WatchActivations;
    DefruleBinaryData(theEnv,execStatus)->DefruleArray[obji].watchFiring = DefruleData(theEnv,execStatus)->WatchRules;
@@ -991,12 +1016,37 @@ static void UpdateJoin(
    DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].initialize = 0;
    DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].marked = 0;
    DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].bsaveID = 0L;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].memoryAdds = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].memoryDeletes = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].memoryCompares = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].leftActivations = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].rightActivations = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].profileEntries = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].profileCompares = 0;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].profileTime = 0.0;
    DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].leftMemory = NULL;
    DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].rightMemory = NULL;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].memoryLocks = NULL;
+   DefruleBinaryData(theEnv,execStatus)->JoinArray[obji].rangeIndex = NULL;
 
    AddBetaMemoriesToJoin(theEnv,execStatus,&DefruleBinaryData(theEnv,execStatus)->JoinArray[obji]);
   }
 
+/************************************************************/
+/* CreateBloadRangeIndexes: Creates the ordered memories of */
+/*   the joins of a binary image once the pattern headers   */
+/*   entering them from the right have been refreshed.      */
+/************************************************************/
+static void CreateBloadRangeIndexes(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   long i;
+
+   for (i = 0; i < DefruleBinaryData(theEnv,execStatus)->NumberOfJoins; i++)
+     { CreateJoinRangeIndex(theEnv,execStatus,&DefruleBinaryData(theEnv,execStatus)->JoinArray[i]); }
+  }
+
 /*************************************/
 /* UpdateLink: Bload refresh routine */
 /*   for joinLink data structures.   */
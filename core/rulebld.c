@@ -46,6 +46,7 @@
 #include "drive.h"
 #include "incrrset.h"
 #include "memalloc.h"
+#include "ordmem.h"
 #include "pattern.h"
 #include "reteutil.h"
 #include "router.h"
@@ -603,6 +604,8 @@ static struct joinNode *CreateNewJoin(
          newJoin->leftMemory->beta[0] = NULL;
          newJoin->leftMemory->size = 1;
          newJoin->leftMemory->count = 0;
+         newJoin->leftMemory->last = NULL;
+         newJoin->leftMemory->resize = NULL;
          }
       else
         {
@@ -611,6 +614,8 @@ static struct joinNode *CreateNewJoin(
          memset(newJoin->leftMemory->beta,0,sizeof(struct partialMatch *) * INITIAL_BETA_HASH_SIZE);
          newJoin->leftMemory->size = INITIAL_BETA_HASH_SIZE;
          newJoin->leftMemory->count = 0;
+         newJoin->leftMemory->last = NULL;
+         newJoin->leftMemory->resize = NULL;
         }
       
       /*===========================================================*/
@@ -641,6 +646,7 @@ static struct joinNode *CreateNewJoin(
          newJoin->rightMemory->last[0] = NULL;
          newJoin->rightMemory->size = 1;
          newJoin->rightMemory->count = 0;
+         newJoin->rightMemory->resize = NULL;
          }
       else
         {
@@ -651,6 +657,7 @@ static struct joinNode *CreateNewJoin(
          memset(newJoin->rightMemory->last,0,sizeof(struct partialMatch *) * INITIAL_BETA_HASH_SIZE);
          newJoin->rightMemory->size = INITIAL_BETA_HASH_SIZE;
          newJoin->rightMemory->count = 0;
+         newJoin->rightMemory->resize = NULL;
         }     
      }
    else if ((lhsEntryStruct == NULL) && (rhsEntryStruct == NULL))
@@ -664,9 +671,16 @@ static struct joinNode *CreateNewJoin(
       newJoin->rightMemory->last[0] = newJoin->rightMemory->beta[0];
       newJoin->rightMemory->size = 1;
       newJoin->rightMemory->count = 1;    
+      newJoin->rightMemory->resize = NULL;
      }
    else
      { newJoin->rightMemory = NULL; }
+
+   newJoin->memoryLocks = NULL;
+   if ((newJoin->leftMemory != NULL) || (newJoin->rightMemory != NULL))
+     { AttachJoinLocks(theEnv,execStatus,newJoin); }
+
+   newJoin->rangeIndex = NULL;
      
    newJoin->nextLinks = NULL;
    newJoin->joinFromTheRight = joinFromTheRight;
@@ -684,6 +698,11 @@ static struct joinNode *CreateNewJoin(
    newJoin->memoryAdds = 0;
    newJoin->memoryDeletes = 0;
    newJoin->memoryCompares = 0;
+   newJoin->leftActivations = 0;
+   newJoin->rightActivations = 0;
+   newJoin->profileEntries = 0;
+   newJoin->profileCompares = 0;
+   newJoin->profileTime = 0.0;
 
    /*==============================================*/
    /* Install the expressions used to determine    */
@@ -781,6 +800,14 @@ static struct joinNode *CreateNewJoin(
      {
       newJoin->rightMatchNode = ((struct patternNodeHeader *) rhsEntryStruct)->entryJoin;
       ((struct patternNodeHeader *) rhsEntryStruct)->entryJoin = newJoin;
+
+      /*=====================================================*/
+      /* A join comparing its LHS and RHS with range tests   */
+      /* keeps ordered memories of the partial matches which */
+      /* have entered it.                                    */
+      /*=====================================================*/
+
+      CreateJoinRangeIndex(theEnv,execStatus,newJoin);
      }
 
    /*================================*/
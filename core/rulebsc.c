@@ -157,7 +157,7 @@ static void ResetDefrules(
          if (notParent->children != NULL)
            { PosEntryRetractBeta(theEnv,execStatus,notParent,notParent->children); }
            /*
-         if (notParent->dependents != NULL) 
+         if (get_pm_dependents(notParent) != NULL) 
            { RemoveLogicalSupport(theEnv,execStatus,notParent); } */
         }
      }
@@ -503,7 +503,7 @@ static void JoinToCode(
    /* Flags and Integer Values. */
    /*===========================*/
 
-   fprintf(joinFile,"{%d,%d,%d,%d,%d,0,0,%d,%d,0,0,0,0,",
+   fprintf(joinFile,"{%d,%d,%d,%d,%d,0,0,%d,%d,0,0,0,0,0,0,0,0,0.0,",
                    theJoin->firstJoin,theJoin->logicalJoin,
                    theJoin->joinFromTheRight,theJoin->patternIsNegated,
                    theJoin->patternIsExists,
@@ -513,7 +513,7 @@ static void JoinToCode(
    /* Left and right Memories. */
    /*==========================*/
 
-   fprintf(joinFile,"NULL,NULL,");
+   fprintf(joinFile,"NULL,NULL,NULL,NULL,");
 
    /*====================*/
    /* Network Expression */
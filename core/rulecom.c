@@ -55,6 +55,7 @@
 #include "incrrset.h"
 #include "lgcldpnd.h"
 #include "memalloc.h"
+#include "netstats.h"
 #include "pattern.h"
 #include "reteutil.h"
 #include "router.h"
@@ -128,10 +129,20 @@ globle void DefruleCommands(
                    GetBetaMemoryResizingCommand,"GetBetaMemoryResizingCommand","00");
    EnvDefineFunction2(theEnv,execStatus,"set-beta-memory-resizing",'b',
                    SetBetaMemoryResizingCommand,"SetBetaMemoryResizingCommand","11");
+   EnvDefineFunction2(theEnv,execStatus,"get-beta-memory-growth-factor",'g',
+                   PTIEF GetBetaMemoryGrowthFactorCommand,"GetBetaMemoryGrowthFactorCommand","00");
+   EnvDefineFunction2(theEnv,execStatus,"set-beta-memory-growth-factor",'g',
+                   PTIEF SetBetaMemoryGrowthFactorCommand,"SetBetaMemoryGrowthFactorCommand","11i");
+   EnvDefineFunction2(theEnv,execStatus,"get-beta-memory-shrinking",'b',
+                   GetBetaMemoryShrinkingCommand,"GetBetaMemoryShrinkingCommand","00");
+   EnvDefineFunction2(theEnv,execStatus,"set-beta-memory-shrinking",'b',
+                   SetBetaMemoryShrinkingCommand,"SetBetaMemoryShrinkingCommand","11");
 
    EnvDefineFunction2(theEnv,execStatus,"get-strategy", 'w', PTIEF GetStrategyCommand,  "GetStrategyCommand", "00");
    EnvDefineFunction2(theEnv,execStatus,"set-strategy", 'w', PTIEF SetStrategyCommand,  "SetStrategyCommand", "11w");
 
+   NetworkStatisticsCommands(theEnv,execStatus);
+
 #if DEVELOPER && (! BLOAD_ONLY)
    EnvDefineFunction2(theEnv,execStatus,"rule-complexity",'l', PTIEF RuleComplexityCommand,"RuleComplexityCommand", "11w");
    EnvDefineFunction2(theEnv,execStatus,"show-joins",   'v', PTIEF ShowJoinsCommand,    "ShowJoinsCommand", "11w");
@@ -234,6 +245,165 @@ globle int GetBetaMemoryResizingCommand(
    return(oldValue);
   }
 
+/****************************************************/
+/* EnvGetBetaMemoryGrowthFactor: C access routine   */
+/*   for the get-beta-memory-growth-factor command. */
+/****************************************************/
+globle unsigned long EnvGetBetaMemoryGrowthFactor(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(DefruleData(theEnv,execStatus)->BetaMemoryGrowthFactor);
+  }
+
+/****************************************************/
+/* EnvSetBetaMemoryGrowthFactor: C access routine   */
+/*   for the set-beta-memory-growth-factor command. */
+/*   Factors smaller than 2 are ignored. Returns    */
+/*   the old factor.                                */
+/****************************************************/
+globle unsigned long EnvSetBetaMemoryGrowthFactor(
+  void *theEnv,
+  EXEC_STATUS,
+  unsigned long value)
+  {
+   unsigned long ov;
+
+   ov = DefruleData(theEnv,execStatus)->BetaMemoryGrowthFactor;
+
+   if (value >= 2)
+     { DefruleData(theEnv,execStatus)->BetaMemoryGrowthFactor = value; }
+
+   return(ov);
+  }
+
+/*********************************************************/
+/* SetBetaMemoryGrowthFactorCommand: H/L access routine  */
+/*   for the set-beta-memory-growth-factor command.      */
+/*********************************************************/
+globle long long SetBetaMemoryGrowthFactorCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   long long oldValue, newValue;
+   DATA_OBJECT argPtr;
+
+   oldValue = (long long) EnvGetBetaMemoryGrowthFactor(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"set-beta-memory-growth-factor",EXACTLY,1) == -1)
+     { return(oldValue); }
+
+   if (EnvArgTypeCheck(theEnv,execStatus,"set-beta-memory-growth-factor",1,INTEGER,&argPtr) == FALSE)
+     { return(oldValue); }
+
+   newValue = DOToLong(argPtr);
+   if (newValue < 2LL)
+     {
+      ExpectedTypeError1(theEnv,execStatus,"set-beta-memory-growth-factor",1,"integer (greater than or equal to 2)");
+      return(oldValue);
+     }
+
+   EnvSetBetaMemoryGrowthFactor(theEnv,execStatus,(unsigned long) newValue);
+
+   return(oldValue);
+  }
+
+/*********************************************************/
+/* GetBetaMemoryGrowthFactorCommand: H/L access routine  */
+/*   for the get-beta-memory-growth-factor command.      */
+/*********************************************************/
+globle long long GetBetaMemoryGrowthFactorCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   long long oldValue;
+
+   oldValue = (long long) EnvGetBetaMemoryGrowthFactor(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"get-beta-memory-growth-factor",EXACTLY,0) == -1)
+     { return(oldValue); }
+
+   return(oldValue);
+  }
+
+/************************************************/
+/* EnvGetBetaMemoryShrinking: C access routine  */
+/*   for the get-beta-memory-shrinking command. */
+/************************************************/
+globle intBool EnvGetBetaMemoryShrinking(
+  void *theEnv,
+  EXEC_STATUS)
+  {   
+   return(DefruleData(theEnv,execStatus)->BetaMemoryShrinkingFlag);
+  }
+
+/************************************************/
+/* EnvSetBetaMemoryShrinking: C access routine  */
+/*   for the set-beta-memory-shrinking command. */
+/************************************************/
+globle intBool EnvSetBetaMemoryShrinking(
+  void *theEnv,
+  EXEC_STATUS,
+  int value)
+  {
+   int ov;
+
+   ov = DefruleData(theEnv,execStatus)->BetaMemoryShrinkingFlag;
+
+   DefruleData(theEnv,execStatus)->BetaMemoryShrinkingFlag = value;
+
+   return(ov);
+  }
+
+/*****************************************************/
+/* SetBetaMemoryShrinkingCommand: H/L access routine */
+/*   for the set-beta-memory-shrinking command.      */
+/*****************************************************/
+globle int SetBetaMemoryShrinkingCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   int oldValue;
+   DATA_OBJECT argPtr;
+
+   oldValue = EnvGetBetaMemoryShrinking(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"set-beta-memory-shrinking",EXACTLY,1) == -1)
+     { return(oldValue); }
+
+   /*=================================================*/
+   /* The symbol FALSE disables beta memory shrinking */
+   /* after retractions. Any other value enables it.  */
+   /*=================================================*/
+
+   EnvRtnUnknown(theEnv,execStatus,1,&argPtr);
+
+   if ((argPtr.value == EnvFalseSymbol(theEnv,execStatus)) && (argPtr.type == SYMBOL))
+     { EnvSetBetaMemoryShrinking(theEnv,execStatus,FALSE); }
+   else
+     { EnvSetBetaMemoryShrinking(theEnv,execStatus,TRUE); }
+
+   return(oldValue);
+  }
+
+/*****************************************************/
+/* GetBetaMemoryShrinkingCommand: H/L access routine */
+/*   for the get-beta-memory-shrinking command.      */
+/*****************************************************/
+globle int GetBetaMemoryShrinkingCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   int oldValue;
+
+   oldValue = EnvGetBetaMemoryShrinking(theEnv,execStatus);
+
+   if (EnvArgCountCheck(theEnv,execStatus,"get-beta-memory-shrinking",EXACTLY,0) == -1)
+     { return(oldValue); }
+
+   return(oldValue);
+  }
+
 #if DEBUGGING_FUNCTIONS
 
 /****************************************/
@@ -462,9 +632,6 @@ static void PrintMatchesMemory(
   int startCE, 
   int endCE)  
   {
-#if MAC_MCW || WIN_MCW || MAC_XCD
-#pragma unused(theJoin)
-#endif
    struct partialMatch *listOfMatches;
    unsigned long b;
    int matchesDisplayed;
@@ -480,6 +647,8 @@ static void PrintMatchesMemory(
    
    EnvPrintRouter(theEnv,execStatus,WDISPLAY,"\n");
 
+   CompleteBetaMemoryResize(theEnv,execStatus,theJoin);
+
    for (b = 0; b < theMemory->size; b++)
      {
       listOfMatches = theMemory->beta[b];
@@ -709,7 +878,16 @@ globle intBool EnvMatchesCount(
            { theJoin = (struct joinNode *) theJoin->rightSideEntryStructure; }
          else
            {
-            theAlphaStorage[i] = ((struct patternNodeHeader *) theJoin->rightSideEntryStructure)->firstHash;
+            /*============================================*/
+            /* A join without a pattern on its right side */
+            /* (e.g. for a rule beginning with a not CE)  */
+            /* has no alpha memory.                       */
+            /*============================================*/
+
+            if (theJoin->rightSideEntryStructure == NULL)
+              { theAlphaStorage[i] = NULL; }
+            else
+              { theAlphaStorage[i] = ((struct patternNodeHeader *) theJoin->rightSideEntryStructure)->firstHash; }
             i--;
             theJoin = theJoin->lastLevel;
            }
@@ -53,11 +53,23 @@
 #define MatchesCount(a) EnvMatchesCount(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 #define GetBetaMemoryResizing() EnvGetBetaMemoryResizing(GetCurrentEnvironment(),GetCurrentExecutionStatus())
 #define SetBetaMemoryResizing(a) EnvSetBetaMemoryResizing(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
+#define GetBetaMemoryGrowthFactor() EnvGetBetaMemoryGrowthFactor(GetCurrentEnvironment(),GetCurrentExecutionStatus())
+#define SetBetaMemoryGrowthFactor(a) EnvSetBetaMemoryGrowthFactor(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
+#define GetBetaMemoryShrinking() EnvGetBetaMemoryShrinking(GetCurrentEnvironment(),GetCurrentExecutionStatus())
+#define SetBetaMemoryShrinking(a) EnvSetBetaMemoryShrinking(GetCurrentEnvironment(),GetCurrentExecutionStatus(),a)
 
    LOCALE intBool                        EnvGetBetaMemoryResizing(void *,EXEC_STATUS);
    LOCALE intBool                        EnvSetBetaMemoryResizing(void *,EXEC_STATUS,intBool);
    LOCALE int                            GetBetaMemoryResizingCommand(void *,EXEC_STATUS);
    LOCALE int                            SetBetaMemoryResizingCommand(void *,EXEC_STATUS);
+   LOCALE unsigned long                  EnvGetBetaMemoryGrowthFactor(void *,EXEC_STATUS);
+   LOCALE unsigned long                  EnvSetBetaMemoryGrowthFactor(void *,EXEC_STATUS,unsigned long);
+   LOCALE long long                      GetBetaMemoryGrowthFactorCommand(void *,EXEC_STATUS);
+   LOCALE long long                      SetBetaMemoryGrowthFactorCommand(void *,EXEC_STATUS);
+   LOCALE intBool                        EnvGetBetaMemoryShrinking(void *,EXEC_STATUS);
+   LOCALE intBool                        EnvSetBetaMemoryShrinking(void *,EXEC_STATUS,intBool);
+   LOCALE int                            GetBetaMemoryShrinkingCommand(void *,EXEC_STATUS);
+   LOCALE int                            SetBetaMemoryShrinkingCommand(void *,EXEC_STATUS);
 
    LOCALE intBool                        EnvMatches(void *,EXEC_STATUS,void *);
    LOCALE long long                      EnvJoinActivity(void *,EXEC_STATUS,void *,int);
@@ -47,6 +47,7 @@
 #define _STDIO_INCLUDED_
 
 #include "agenda.h"
+#include "crstrtgy.h"
 #include "drive.h"
 #include "engine.h"
 #include "envrnmnt.h"
@@ -123,9 +124,13 @@ globle void InitializeDefrules(
    for (i = 0; i < ALPHA_MEMORY_HASH_SIZE; i++) DefruleData(theEnv,execStatus)->AlphaMemoryTable[i] = NULL;
 
    DefruleData(theEnv,execStatus)->BetaMemoryResizingFlag = TRUE;
+   DefruleData(theEnv,execStatus)->BetaMemoryGrowthFactor = BETA_MEMORY_GROWTH_FACTOR;
+   DefruleData(theEnv,execStatus)->BetaMemoryShrinkingFlag = FALSE;
    
    DefruleData(theEnv,execStatus)->RightPrimeJoins = NULL;
    DefruleData(theEnv,execStatus)->LeftPrimeJoins = NULL;   
+
+   InitializeJoinNetworkLocks(theEnv,execStatus);
   }
   
 /**************************************************/
@@ -140,11 +145,39 @@ static void DeallocateDefruleData(
    void *theModule;
    struct activation *theActivation, *tmpActivation;
    struct salienceGroup *theGroup, *tmpGroup;
+   struct defrule *theRule;
 
 #if BLOAD || BLOAD_AND_BSAVE
    if (Bloaded(theEnv,execStatus))
      { return; }
 #endif
+
+   /*===============================================*/
+   /* Pending activations are kept on their rules,  */
+   /* so they are returned before the rules are.    */
+   /*===============================================*/
+
+   for (theModule = EnvGetNextDefmodule(theEnv,execStatus,NULL);
+        theModule != NULL;
+        theModule = EnvGetNextDefmodule(theEnv,execStatus,theModule))
+     {
+      theModuleItem = (struct defruleModule *)
+                      GetModuleItem(theEnv,execStatus,(struct defmodule *) theModule,
+                                    DefruleData(theEnv,execStatus)->DefruleModuleIndex);
+
+      for (theRule = theModuleItem->pendingRules;
+           theRule != NULL;
+           theRule = theRule->nextPending)
+        {
+         theActivation = theRule->pendingActivations;
+         while (theActivation != NULL)
+           {
+            tmpActivation = theActivation->next;
+            rtn_struct(theEnv,execStatus,activation,theActivation);
+            theActivation = tmpActivation;
+           }
+        }
+     }
    
    DoForAllConstructs(theEnv,execStatus,DestroyDefruleAction,DefruleData(theEnv,execStatus)->DefruleModuleIndex,FALSE,NULL);
 
@@ -161,6 +194,7 @@ static void DeallocateDefruleData(
         {
          tmpActivation = theActivation->next;
          
+         ReturnActivationIndex(theEnv,execStatus,theActivation);
          rtn_struct(theEnv,execStatus,activation,theActivation);
          
          theActivation = tmpActivation;
@@ -241,6 +275,7 @@ static void *AllocateModule(
    theItem = get_struct(theEnv,execStatus,defruleModule);
    theItem->agenda = NULL;
    theItem->groupings = NULL;
+   theItem->pendingRules = NULL;
    return((void *) theItem);
   }
 
@@ -401,6 +436,7 @@ globle void AddBetaMemoriesToJoin(
          theNode->leftMemory->beta[0] = NULL;
          theNode->leftMemory->size = 1;
          theNode->leftMemory->count = 0;
+         theNode->leftMemory->resize = NULL;
          theNode->leftMemory->last = NULL;
         }
       else
@@ -410,6 +446,7 @@ globle void AddBetaMemoriesToJoin(
          memset(theNode->leftMemory->beta,0,sizeof(struct partialMatch *) * INITIAL_BETA_HASH_SIZE);
          theNode->leftMemory->size = INITIAL_BETA_HASH_SIZE;
          theNode->leftMemory->count = 0;
+         theNode->leftMemory->resize = NULL;
          theNode->leftMemory->last = NULL;
         }
 
@@ -434,6 +471,7 @@ globle void AddBetaMemoriesToJoin(
          theNode->rightMemory->last[0] = NULL;
          theNode->rightMemory->size = 1;
          theNode->rightMemory->count = 0;
+         theNode->rightMemory->resize = NULL;
         }
       else
         {
@@ -444,6 +482,7 @@ globle void AddBetaMemoriesToJoin(
          memset(theNode->rightMemory->last,0,sizeof(struct partialMatch **) * INITIAL_BETA_HASH_SIZE);
          theNode->rightMemory->size = INITIAL_BETA_HASH_SIZE;
          theNode->rightMemory->count = 0;
+         theNode->rightMemory->resize = NULL;
         }
      }
 
@@ -458,10 +497,14 @@ globle void AddBetaMemoriesToJoin(
       theNode->rightMemory->last[0] = theNode->rightMemory->beta[0];
       theNode->rightMemory->size = 1;
       theNode->rightMemory->count = 1;    
+      theNode->rightMemory->resize = NULL;
      }
 
    else
      { theNode->rightMemory = NULL; }
+
+   if ((theNode->leftMemory != NULL) || (theNode->rightMemory != NULL))
+     { AttachJoinLocks(theEnv,execStatus,theNode); }
   }
 
 #endif
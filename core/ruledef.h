@@ -90,19 +90,50 @@ struct defrule
    struct joinNode *logicalJoin;
    struct joinNode *lastJoin;
    struct defrule *disjunct;
+   struct activation *pendingActivations;
+   struct defrule *prevPending;
+   struct defrule *nextPending;
   };
 
+/*==========================================================*/
+/* In lazy agenda mode, the activations of a rule are kept  */
+/* on the rule until the agenda of its module is needed.    */
+/* The rules of a module with such pending activations are  */
+/* linked from the module.                                  */
+/*==========================================================*/
+
 struct defruleModule
   {
    struct defmoduleItemHeader header;
    struct salienceGroup *groupings;
    struct activation *agenda;
+   struct defrule *pendingRules;
   };
 
 #ifndef ALPHA_MEMORY_HASH_SIZE
 #define ALPHA_MEMORY_HASH_SIZE       63559L
 #endif
 
+/*=========================================================*/
+/* Number of locks guarding the alpha memories (selected   */
+/* by the alpha memory hash bucket) and the lineage links  */
+/* of partial matches (selected by the parent's address).  */
+/*=========================================================*/
+
+#define ALPHA_MEMORY_LOCKS           64
+#define PARTIAL_MATCH_LOCKS          64
+
+/*=========================================================*/
+/* A beta memory is grown by the growth factor once it     */
+/* holds more than BETA_MEMORY_LOAD_FACTOR partial matches */
+/* per bucket. If shrinking is enabled, it is shrunk by    */
+/* the same factor once it holds fewer partial matches     */
+/* than 1/factor per bucket.                               */
+/*=========================================================*/
+
+#define BETA_MEMORY_LOAD_FACTOR      11
+#define BETA_MEMORY_GROWTH_FACTOR    11
+
 #define DEFRULE_DATA 16
 
 struct defruleData
@@ -112,8 +143,16 @@ struct defruleData
    long long CurrentEntityTimeTag;
    struct alphaMemoryHash **AlphaMemoryTable;
    intBool BetaMemoryResizingFlag;
+   unsigned long BetaMemoryGrowthFactor;
+   intBool BetaMemoryShrinkingFlag;
    struct joinLink *RightPrimeJoins;
    struct joinLink *LeftPrimeJoins;
+   apr_thread_mutex_t *AlphaMemoryLocks[ALPHA_MEMORY_LOCKS];
+   apr_thread_mutex_t *AlphaHeaderLock;
+   apr_thread_mutex_t *PartialMatchLocks[PARTIAL_MATCH_LOCKS];
+   apr_thread_mutex_t *MemoryTagLock;
+   unsigned long long CurrentMemoryTag;
+   struct joinLocks *FreeJoinLocks;
 
 #if DEBUGGING_FUNCTIONS
     unsigned WatchRules;
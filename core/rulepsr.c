@@ -503,6 +503,9 @@ static struct defrule *CreateNewDisjunct(
    newDisjunct->autoFocus = PatternData(theEnv,execStatus)->GlobalAutoFocus;
    newDisjunct->dynamicSalience = PatternData(theEnv,execStatus)->SalienceExpression;
    newDisjunct->localVarCnt = localVarCnt;
+   newDisjunct->pendingActivations = NULL;
+   newDisjunct->prevPending = NULL;
+   newDisjunct->nextPending = NULL;
 
    /*=====================================*/
    /* Add a pointer to the rule's module. */
@@ -192,6 +192,22 @@
 #define FACT_SET_QUERIES        0
 #endif
 
+/**************************************************************/
+/* DEFINDEX_CONSTRUCT: Determines whether the defindex        */
+/*   construct is included. A defindex keeps a hash or        */
+/*   ordered index on a deftemplate slot, which the fact-set  */
+/*   query functions use to select their candidate facts.     */
+/**************************************************************/
+
+#ifndef DEFINDEX_CONSTRUCT
+#define DEFINDEX_CONSTRUCT 1
+#endif
+
+#if ! DEFTEMPLATE_CONSTRUCT
+#undef DEFINDEX_CONSTRUCT
+#define DEFINDEX_CONSTRUCT      0
+#endif
+
 /****************************************************/
 /* DEFFACTS_CONSTRUCT:  Determines whether deffacts */
 /*   construct is included.                         */
@@ -271,6 +287,22 @@
 #define INSTANCE_SET_QUERIES        0
 #endif
 
+/**************************************************************/
+/* DEFCLASS_SLOT_INDEXES: Determines whether the index slot   */
+/*   facet is supported. An indexed slot keeps a hash or      */
+/*   ordered index of the instances of its class, which the   */
+/*   instance-set query functions use to select candidates.   */
+/**************************************************************/
+
+#ifndef DEFCLASS_SLOT_INDEXES
+#define DEFCLASS_SLOT_INDEXES 1
+#endif
+
+#if ! INSTANCE_SET_QUERIES
+#undef DEFCLASS_SLOT_INDEXES
+#define DEFCLASS_SLOT_INDEXES       0
+#endif
+
 /******************************************************************/
 /* Check for consistencies associated with the defrule construct. */
 /******************************************************************/
@@ -300,6 +332,26 @@
 #define BSAVE_INSTANCES             0
 #endif
 
+/*****************************************************************/
+/* BLOAD/BSAVE_FACTS: Determines if the load-facts-binary and    */
+/*  save-facts-binary functions are available for saving facts   */
+/*  to and restoring facts from binary files                     */
+/*****************************************************************/
+
+#ifndef BLOAD_FACTS
+#define BLOAD_FACTS 1
+#endif
+#ifndef BSAVE_FACTS
+#define BSAVE_FACTS 1
+#endif
+
+#if (! DEFTEMPLATE_CONSTRUCT) || (! DEFRULE_CONSTRUCT)
+#undef BLOAD_FACTS
+#undef BSAVE_FACTS
+#define BLOAD_FACTS                 0
+#define BSAVE_FACTS                 0
+#endif
+
 /****************************************************************/
 /* EXTENDED MATH PACKAGE FLAG: If this is on, then the extended */
 /* math package functions will be available for use, (normal    */
@@ -360,6 +412,32 @@
 #define BLOAD_AND_BSAVE 0
 #endif
 
+/*******************************************************************/
+/* BLOAD_MMAP: Determines if binary files read by bload,           */
+/*   bload-instances and load-facts-binary are memory mapped on    */
+/*   systems supporting it, so that the records of the file are    */
+/*   used in place instead of being copied into temporary buffers. */
+/*******************************************************************/
+
+#ifndef BLOAD_MMAP
+#define BLOAD_MMAP 1
+#endif
+
+/*****************************************************************/
+/* LOAD_FACTS_PIPELINE: Determines if large files read by the    */
+/*  load-facts function are tokenized by the fact threads while  */
+/*  the facts read so far are asserted in batches                */
+/*****************************************************************/
+
+#ifndef LOAD_FACTS_PIPELINE
+#define LOAD_FACTS_PIPELINE 1
+#endif
+
+#if (! DEFTEMPLATE_CONSTRUCT) || (! DEFRULE_CONSTRUCT) || RUN_TIME || BLOAD_ONLY
+#undef LOAD_FACTS_PIPELINE
+#define LOAD_FACTS_PIPELINE         0
+#endif
+
 /****************************************************************/
 /* EMACS_EDITOR: If this flag is turned on, an integrated EMACS */
 /*   style editor can be utilized on supported machines.        */
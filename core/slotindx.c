@@ -0,0 +1,735 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                  SLOT INDEX MODULE                  */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Maintains secondary indexes from the value of a  */
+/*   single field slot to the facts or instances holding it. */
+/*                                                           */
+/*   Every distinct value is a key found through a hash      */
+/*   table on the type and address of the value, which is    */
+/*   exactly the test made by eq. The owners holding a value */
+/*   are chained to its key in the order they were added.    */
+/*   An ordered index also keeps its numeric keys in a skip  */
+/*   list so that ranges can be read off in value order.     */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _SLOTINDX_SOURCE_
+
+#include <stdio.h>
+#define _STDIO_INCLUDED_
+#include <stdlib.h>
+
+#include "setup.h"
+
+#if DEFINDEX_CONSTRUCT || DEFCLASS_SLOT_INDEXES
+
+#include "constant.h"
+#include "envrnmnt.h"
+#include "memalloc.h"
+#include "symbol.h"
+
+#include "slotindx.h"
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+   static unsigned long           HashSlotIndexValue(int,void *);
+   static struct slotIndexKey    *FindSlotIndexKey(struct slotIndex *,int,void *,unsigned long);
+   static void                    ResizeSlotIndex(void *,EXEC_STATUS,struct slotIndex *);
+   static intBool                 IsNumericKey(int);
+   static int                     CompareSlotIndexKeys(struct slotIndexKey *,struct slotIndexKey *);
+   static int                     CompareNumericValues(int,void *,int,void *);
+   static int                     RandomSkipLevel(struct slotIndex *);
+   static void                    InsertOrderedKey(void *,EXEC_STATUS,struct slotIndex *,struct slotIndexKey *);
+   static void                    RemoveOrderedKey(void *,EXEC_STATUS,struct slotIndex *,struct slotIndexKey *);
+   static intBool                 KeyWithinBounds(struct slotIndexKey *,struct slotIndexProbe *);
+   static int                     CompareEntryOrder(const void *,const void *);
+
+/*******************************************************/
+/* CreateSlotIndex: Creates an empty slot index. If    */
+/*   ordered is TRUE the numeric keys are also kept in */
+/*   value order so the index can answer ranges.       */
+/*******************************************************/
+globle struct slotIndex *CreateSlotIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  int ordered)
+  {
+   struct slotIndex *theIndex;
+   unsigned long i;
+   int level;
+
+   theIndex = get_struct(theEnv,execStatus,slotIndex);
+   theIndex->ordered = (ordered ? TRUE : FALSE);
+   theIndex->bucketCount = SLOT_INDEX_INITIAL_BUCKETS;
+   theIndex->buckets = (struct slotIndexKey **)
+                       gm3(theEnv,execStatus,sizeof(struct slotIndexKey *) * theIndex->bucketCount);
+   for (i = 0; i < theIndex->bucketCount; i++)
+     { theIndex->buckets[i] = NULL; }
+
+   theIndex->keyCount = 0;
+   theIndex->entryCount = 0;
+   theIndex->nonNumericCount = 0;
+
+   for (level = 0; level < SLOT_INDEX_MAX_LEVEL; level++)
+     { theIndex->skipHead[level] = NULL; }
+   theIndex->skipLevel = 1;
+   theIndex->skipSeed = 2463534242UL;
+
+   return(theIndex);
+  }
+
+/**********************************************************/
+/* ReturnSlotIndex: Returns a slot index and its keys to  */
+/*   free memory. The entries belong to their owners and  */
+/*   are released by them.                                */
+/**********************************************************/
+globle void ReturnSlotIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndex *theIndex)
+  {
+   struct slotIndexKey *theKey, *nextKey;
+   unsigned long i;
+
+   if (theIndex == NULL) return;
+
+   for (i = 0; i < theIndex->bucketCount; i++)
+     {
+      for (theKey = theIndex->buckets[i]; theKey != NULL; theKey = nextKey)
+        {
+         nextKey = theKey->nextInBucket;
+
+         if (theKey->forward != NULL)
+           { rm(theEnv,execStatus,theKey->forward,sizeof(struct slotIndexKey *) * theKey->level); }
+         rtn_struct(theEnv,execStatus,slotIndexKey,theKey);
+        }
+     }
+
+   rm3(theEnv,execStatus,theIndex->buckets,sizeof(struct slotIndexKey *) * theIndex->bucketCount);
+   rtn_struct(theEnv,execStatus,slotIndex,theIndex);
+  }
+
+/************************************************************/
+/* AddSlotIndexEntry: Enters an owner holding the specified */
+/*   value into an index. The order value is used to return */
+/*   the owners of a probe in the order they were created.  */
+/*   The new entry is returned so that the caller can chain */
+/*   it to the owner.                                       */
+/************************************************************/
+globle struct slotIndexEntry *AddSlotIndexEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndex *theIndex,
+  void *owner,
+  long long order,
+  int type,
+  void *value)
+  {
+   struct slotIndexKey *theKey;
+   struct slotIndexEntry *theEntry;
+   unsigned long hashValue, bucket;
+
+   hashValue = HashSlotIndexValue(type,value);
+   theKey = FindSlotIndexKey(theIndex,type,value,hashValue);
+
+   /*=====================================*/
+   /* The first owner holding a value     */
+   /* creates the key for the value.      */
+   /*=====================================*/
+
+   if (theKey == NULL)
+     {
+      if (theIndex->keyCount >= (theIndex->bucketCount * 2))
+        { ResizeSlotIndex(theEnv,execStatus,theIndex); }
+
+      theKey = get_struct(theEnv,execStatus,slotIndexKey);
+      theKey->type = (unsigned short) type;
+      theKey->value = value;
+      theKey->numericValue = 0.0;
+      theKey->hashValue = hashValue;
+      theKey->count = 0;
+      theKey->firstEntry = NULL;
+      theKey->lastEntry = NULL;
+      theKey->forward = NULL;
+      theKey->level = 0;
+
+      bucket = hashValue & (theIndex->bucketCount - 1);
+      theKey->nextInBucket = theIndex->buckets[bucket];
+      theIndex->buckets[bucket] = theKey;
+      theIndex->keyCount++;
+
+      if (IsNumericKey(type))
+        {
+         theKey->numericValue = CoerceToDouble(type,value);
+         if (theIndex->ordered)
+           { InsertOrderedKey(theEnv,execStatus,theIndex,theKey); }
+        }
+     }
+
+   /*==========================================*/
+   /* Chain the entry at the end of the key so */
+   /* the owners of a key stay in the order in */
+   /* which they were added.                   */
+   /*==========================================*/
+
+   theEntry = get_struct(theEnv,execStatus,slotIndexEntry);
+   theEntry->owner = owner;
+   theEntry->order = order;
+   theEntry->theIndex = theIndex;
+   theEntry->theKey = theKey;
+   theEntry->nextInKey = NULL;
+   theEntry->nextInOwner = NULL;
+   theEntry->previousInKey = theKey->lastEntry;
+
+   if (theKey->lastEntry == NULL)
+     { theKey->firstEntry = theEntry; }
+   else
+     { theKey->lastEntry->nextInKey = theEntry; }
+   theKey->lastEntry = theEntry;
+
+   theKey->count++;
+   theIndex->entryCount++;
+   if (! IsNumericKey(type))
+     { theIndex->nonNumericCount++; }
+
+   return(theEntry);
+  }
+
+/**************************************************************/
+/* RemoveSlotIndexEntry: Removes an entry from its index and  */
+/*   returns it to free memory. The key of the value is freed */
+/*   along with the last entry holding it. The entry must     */
+/*   already have been unchained from its owner.              */
+/**************************************************************/
+globle void RemoveSlotIndexEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndexEntry *theEntry)
+  {
+   struct slotIndex *theIndex = theEntry->theIndex;
+   struct slotIndexKey *theKey = theEntry->theKey, *keyPtr, *lastKey;
+   unsigned long bucket;
+
+   if (theEntry->previousInKey == NULL)
+     { theKey->firstEntry = theEntry->nextInKey; }
+   else
+     { theEntry->previousInKey->nextInKey = theEntry->nextInKey; }
+
+   if (theEntry->nextInKey == NULL)
+     { theKey->lastEntry = theEntry->previousInKey; }
+   else
+     { theEntry->nextInKey->previousInKey = theEntry->previousInKey; }
+
+   theKey->count--;
+   theIndex->entryCount--;
+   if (! IsNumericKey(theKey->type))
+     { theIndex->nonNumericCount--; }
+
+   rtn_struct(theEnv,execStatus,slotIndexEntry,theEntry);
+
+   if (theKey->count > 0) return;
+
+   /*=================================*/
+   /* Release the key of a value that */
+   /* is no longer held by any owner. */
+   /*=================================*/
+
+   bucket = theKey->hashValue & (theIndex->bucketCount - 1);
+   lastKey = NULL;
+   for (keyPtr = theIndex->buckets[bucket];
+        keyPtr != theKey;
+        keyPtr = keyPtr->nextInBucket)
+     { lastKey = keyPtr; }
+
+   if (lastKey == NULL)
+     { theIndex->buckets[bucket] = theKey->nextInBucket; }
+   else
+     { lastKey->nextInBucket = theKey->nextInBucket; }
+   theIndex->keyCount--;
+
+   if (theKey->forward != NULL)
+     {
+      RemoveOrderedKey(theEnv,execStatus,theIndex,theKey);
+      rm(theEnv,execStatus,theKey->forward,sizeof(struct slotIndexKey *) * theKey->level);
+     }
+
+   rtn_struct(theEnv,execStatus,slotIndexKey,theKey);
+  }
+
+/************************************************************/
+/* SlotIndexProbeApplies: Determines whether an index can   */
+/*   answer a probe exactly. An eq probe needs a single     */
+/*   field key. A range probe needs numeric bounds and an   */
+/*   ordered index holding only numbers, since comparing a  */
+/*   number with anything else is an error in the query the */
+/*   probe was taken from and must be left to signal it.    */
+/************************************************************/
+globle intBool SlotIndexProbeApplies(
+  struct slotIndex *theIndex,
+  struct slotIndexProbe *theProbe)
+  {
+   if (theProbe->kind == SLOT_INDEX_PROBE_EQ)
+     { return((theProbe->key.type != MULTIFIELD) ? TRUE : FALSE); }
+
+   if ((! theIndex->ordered) || (theIndex->nonNumericCount != 0))
+     { return(FALSE); }
+
+   if ((theProbe->lowerTest != SLOT_INDEX_NO_BOUND) &&
+       (! IsNumericKey(theProbe->lower.type)))
+     { return(FALSE); }
+
+   if ((theProbe->upperTest != SLOT_INDEX_NO_BOUND) &&
+       (! IsNumericKey(theProbe->upper.type)))
+     { return(FALSE); }
+
+   return(TRUE);
+  }
+
+/*************************************************************/
+/* SlotIndexCandidates: Returns an array of the owners which */
+/*   satisfy a probe, in the order they were added, and sets */
+/*   count to its length. The array is NULL if no owner      */
+/*   qualifies and must otherwise be released with           */
+/*   ReturnSlotIndexCandidates. SlotIndexProbeApplies must   */
+/*   have been checked for the probe.                        */
+/*************************************************************/
+globle void **SlotIndexCandidates(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndex *theIndex,
+  struct slotIndexProbe *theProbe,
+  unsigned long *count)
+  {
+   struct slotIndexKey *theKey, *firstKey, *lastKey;
+   struct slotIndexEntry *theEntry;
+   void **candidates;
+   unsigned long total, i;
+   intBool sorted;
+   double lowerValue = 0.0, upperValue = 0.0;
+   int level;
+
+   *count = 0;
+   firstKey = lastKey = NULL;
+   total = 0;
+
+   /*==========================================*/
+   /* An eq probe reads the entries of one key */
+   /* and a range probe those of a run of keys */
+   /* in the skip list.                        */
+   /*==========================================*/
+
+   if (theProbe->kind == SLOT_INDEX_PROBE_EQ)
+     {
+      firstKey = FindSlotIndexKey(theIndex,theProbe->key.type,theProbe->key.value,
+                                  HashSlotIndexValue(theProbe->key.type,theProbe->key.value));
+      if (firstKey == NULL) return(NULL);
+      total = firstKey->count;
+     }
+   else
+     {
+      if (theProbe->lowerTest != SLOT_INDEX_NO_BOUND)
+        { lowerValue = CoerceToDouble(theProbe->lower.type,theProbe->lower.value); }
+      if (theProbe->upperTest != SLOT_INDEX_NO_BOUND)
+        { upperValue = CoerceToDouble(theProbe->upper.type,theProbe->upper.value); }
+
+      /*===================================================*/
+      /* Find the first key which is not below the lower   */
+      /* bound when both are converted to a float. Keys    */
+      /* whose float value equals a bound are compared     */
+      /* exactly the way the comparison functions do.      */
+      /*===================================================*/
+
+      theKey = NULL;
+      for (level = theIndex->skipLevel - 1; level >= 0; level--)
+        {
+         while (((theKey == NULL) ? theIndex->skipHead[level] : theKey->forward[level]) != NULL)
+           {
+            firstKey = (theKey == NULL) ? theIndex->skipHead[level] : theKey->forward[level];
+            if ((theProbe->lowerTest == SLOT_INDEX_NO_BOUND) ||
+                (firstKey->numericValue >= lowerValue))
+              { break; }
+            theKey = firstKey;
+           }
+        }
+      firstKey = (theKey == NULL) ? theIndex->skipHead[0] : theKey->forward[0];
+
+      for (theKey = firstKey; theKey != NULL; theKey = theKey->forward[0])
+        {
+         if ((theProbe->upperTest != SLOT_INDEX_NO_BOUND) &&
+             (theKey->numericValue > upperValue))
+           { break; }
+         if (KeyWithinBounds(theKey,theProbe))
+           { total += theKey->count; }
+         lastKey = theKey;
+        }
+     }
+
+   if (total == 0) return(NULL);
+
+   /*==============================================*/
+   /* Gather the entries, then put them back into  */
+   /* the order the owners were added if a range   */
+   /* spanned several keys, or an owner was moved  */
+   /* from one key to another.                     */
+   /*==============================================*/
+
+   candidates = (void **) gm3(theEnv,execStatus,sizeof(void *) * total);
+   i = 0;
+   sorted = TRUE;
+
+   for (theKey = firstKey; theKey != NULL; theKey = theKey->forward[0])
+     {
+      if ((theProbe->kind == SLOT_INDEX_PROBE_EQ) || KeyWithinBounds(theKey,theProbe))
+        {
+         for (theEntry = theKey->firstEntry; theEntry != NULL; theEntry = theEntry->nextInKey)
+           {
+            if ((i > 0) && (((struct slotIndexEntry *) candidates[i-1])->order > theEntry->order))
+              { sorted = FALSE; }
+            candidates[i++] = (void *) theEntry;
+           }
+        }
+
+      if ((theProbe->kind == SLOT_INDEX_PROBE_EQ) || (theKey == lastKey))
+        { break; }
+     }
+
+   if (! sorted)
+     { qsort(candidates,(size_t) total,sizeof(void *),CompareEntryOrder); }
+
+   for (i = 0; i < total; i++)
+     { candidates[i] = ((struct slotIndexEntry *) candidates[i])->owner; }
+
+   *count = total;
+   return(candidates);
+  }
+
+/*********************************************************/
+/* ReturnSlotIndexCandidates: Releases an array returned */
+/*   by SlotIndexCandidates.                             */
+/*********************************************************/
+globle void ReturnSlotIndexCandidates(
+  void *theEnv,
+  EXEC_STATUS,
+  void **candidates,
+  unsigned long count)
+  {
+   if (candidates == NULL) return;
+
+   rm3(theEnv,execStatus,candidates,sizeof(void *) * count);
+  }
+
+/*****************************************************/
+/* HashSlotIndexValue: Values are atoms, so the type */
+/*   and address of a value identify it exactly.     */
+/*****************************************************/
+static unsigned long HashSlotIndexValue(
+  int type,
+  void *value)
+  {
+   unsigned long hashValue;
+
+   hashValue = ((unsigned long) value) >> 3;
+   hashValue ^= ((unsigned long) type) * 0x9e3779b1UL;
+   hashValue ^= hashValue >> 16;
+   hashValue *= 0x45d9f3bUL;
+   hashValue ^= hashValue >> 16;
+
+   return(hashValue);
+  }
+
+/*************************************************/
+/* FindSlotIndexKey: Returns the key of a value, */
+/*   or NULL if no owner holds the value.        */
+/*************************************************/
+static struct slotIndexKey *FindSlotIndexKey(
+  struct slotIndex *theIndex,
+  int type,
+  void *value,
+  unsigned long hashValue)
+  {
+   struct slotIndexKey *theKey;
+
+   for (theKey = theIndex->buckets[hashValue & (theIndex->bucketCount - 1)];
+        theKey != NULL;
+        theKey = theKey->nextInBucket)
+     {
+      if ((theKey->value == value) && (theKey->type == type))
+        { return(theKey); }
+     }
+
+   return(NULL);
+  }
+
+/*****************************************************/
+/* ResizeSlotIndex: Doubles the number of buckets of */
+/*   an index and moves every key to its new bucket. */
+/*****************************************************/
+static void ResizeSlotIndex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndex *theIndex)
+  {
+   struct slotIndexKey **newBuckets, *theKey, *nextKey;
+   unsigned long newCount, i, bucket;
+
+   newCount = theIndex->bucketCount * 2;
+   newBuckets = (struct slotIndexKey **) gm3(theEnv,execStatus,sizeof(struct slotIndexKey *) * newCount);
+   for (i = 0; i < newCount; i++)
+     { newBuckets[i] = NULL; }
+
+   for (i = 0; i < theIndex->bucketCount; i++)
+     {
+      for (theKey = theIndex->buckets[i]; theKey != NULL; theKey = nextKey)
+        {
+         nextKey = theKey->nextInBucket;
+         bucket = theKey->hashValue & (newCount - 1);
+         theKey->nextInBucket = newBuckets[bucket];
+         newBuckets[bucket] = theKey;
+        }
+     }
+
+   rm3(theEnv,execStatus,theIndex->buckets,sizeof(struct slotIndexKey *) * theIndex->bucketCount);
+   theIndex->buckets = newBuckets;
+   theIndex->bucketCount = newCount;
+  }
+
+/*****************************************/
+/* IsNumericKey: Determines whether keys */
+/*   of a type go in the skip list.      */
+/*****************************************/
+static intBool IsNumericKey(
+  int type)
+  {
+   return(((type == INTEGER) || (type == FLOAT)) ? TRUE : FALSE);
+  }
+
+/*************************************************************/
+/* CompareSlotIndexKeys: Orders numeric keys by their float  */
+/*   value. Keys with the same float value are ordered by    */
+/*   type, integers by their exact value, and finally by     */
+/*   address, so that every key has a unique place.          */
+/*************************************************************/
+static int CompareSlotIndexKeys(
+  struct slotIndexKey *key1,
+  struct slotIndexKey *key2)
+  {
+   if (key1->numericValue < key2->numericValue) return(-1);
+   if (key1->numericValue > key2->numericValue) return(1);
+
+   if (key1->type != key2->type)
+     { return((key1->type == INTEGER) ? -1 : 1); }
+
+   if (key1->type == INTEGER)
+     {
+      if (ValueToLong(key1->value) < ValueToLong(key2->value)) return(-1);
+      if (ValueToLong(key1->value) > ValueToLong(key2->value)) return(1);
+     }
+
+   if (key1->value < key2->value) return(-1);
+   if (key1->value > key2->value) return(1);
+
+   return(0);
+  }
+
+/***********************************************************/
+/* CompareNumericValues: Compares two numbers the way the  */
+/*   =, <, <=, > and >= functions do: two integers exactly */
+/*   and anything else after conversion to a float.        */
+/***********************************************************/
+static int CompareNumericValues(
+  int type1,
+  void *value1,
+  int type2,
+  void *value2)
+  {
+   double float1, float2;
+
+   if ((type1 == INTEGER) && (type2 == INTEGER))
+     {
+      if (ValueToLong(value1) < ValueToLong(value2)) return(-1);
+      if (ValueToLong(value1) > ValueToLong(value2)) return(1);
+      return(0);
+     }
+
+   float1 = CoerceToDouble(type1,value1);
+   float2 = CoerceToDouble(type2,value2);
+
+   if (float1 < float2) return(-1);
+   if (float1 > float2) return(1);
+   return(0);
+  }
+
+/**************************************************/
+/* RandomSkipLevel: Picks the height of a new key */
+/*   in the skip list, each level being a quarter */
+/*   as likely as the one below it.               */
+/**************************************************/
+static int RandomSkipLevel(
+  struct slotIndex *theIndex)
+  {
+   unsigned long bits;
+   int level = 1;
+
+   bits = theIndex->skipSeed;
+   bits ^= bits << 13;
+   bits ^= bits >> 17;
+   bits ^= bits << 5;
+   bits &= 0xFFFFFFFFUL;
+   theIndex->skipSeed = bits;
+
+   while (((bits & 3) == 0) && (level < SLOT_INDEX_MAX_LEVEL))
+     {
+      level++;
+      bits >>= 2;
+     }
+
+   return(level);
+  }
+
+/**************************************************/
+/* InsertOrderedKey: Links a new numeric key into */
+/*   the skip list of an ordered index.           */
+/**************************************************/
+static void InsertOrderedKey(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndex *theIndex,
+  struct slotIndexKey *theKey)
+  {
+   struct slotIndexKey *update[SLOT_INDEX_MAX_LEVEL];
+   struct slotIndexKey *keyPtr, *nextKey;
+   int level, newLevel;
+
+   keyPtr = NULL;
+   for (level = theIndex->skipLevel - 1; level >= 0; level--)
+     {
+      while ((nextKey = ((keyPtr == NULL) ? theIndex->skipHead[level] : keyPtr->forward[level])) != NULL)
+        {
+         if (CompareSlotIndexKeys(nextKey,theKey) >= 0) break;
+         keyPtr = nextKey;
+        }
+      update[level] = keyPtr;
+     }
+
+   newLevel = RandomSkipLevel(theIndex);
+   if (newLevel > theIndex->skipLevel)
+     {
+      for (level = theIndex->skipLevel; level < newLevel; level++)
+        { update[level] = NULL; }
+      theIndex->skipLevel = newLevel;
+     }
+
+   theKey->level = newLevel;
+   theKey->forward = (struct slotIndexKey **) gm2(theEnv,execStatus,sizeof(struct slotIndexKey *) * newLevel);
+
+   for (level = 0; level < newLevel; level++)
+     {
+      if (update[level] == NULL)
+        {
+         theKey->forward[level] = theIndex->skipHead[level];
+         theIndex->skipHead[level] = theKey;
+        }
+      else
+        {
+         theKey->forward[level] = update[level]->forward[level];
+         update[level]->forward[level] = theKey;
+        }
+     }
+  }
+
+/****************************************************/
+/* RemoveOrderedKey: Unlinks a numeric key from the */
+/*   skip list of an ordered index.                 */
+/****************************************************/
+static void RemoveOrderedKey(
+  void *theEnv,
+  EXEC_STATUS,
+  struct slotIndex *theIndex,
+  struct slotIndexKey *theKey)
+  {
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus)
+#endif
+   struct slotIndexKey *keyPtr, *nextKey;
+   int level;
+
+   keyPtr = NULL;
+   for (level = theIndex->skipLevel - 1; level >= 0; level--)
+     {
+      while ((nextKey = ((keyPtr == NULL) ? theIndex->skipHead[level] : keyPtr->forward[level])) != NULL)
+        {
+         if (CompareSlotIndexKeys(nextKey,theKey) >= 0) break;
+         keyPtr = nextKey;
+        }
+
+      if ((level < theKey->level) && (nextKey == theKey))
+        {
+         if (keyPtr == NULL)
+           { theIndex->skipHead[level] = theKey->forward[level]; }
+         else
+           { keyPtr->forward[level] = theKey->forward[level]; }
+        }
+     }
+
+   while ((theIndex->skipLevel > 1) && (theIndex->skipHead[theIndex->skipLevel - 1] == NULL))
+     { theIndex->skipLevel--; }
+  }
+
+/*********************************************************/
+/* KeyWithinBounds: Determines whether the value of a    */
+/*   numeric key satisfies the bounds of a range probe.  */
+/*********************************************************/
+static intBool KeyWithinBounds(
+  struct slotIndexKey *theKey,
+  struct slotIndexProbe *theProbe)
+  {
+   int rv;
+
+   if (theProbe->lowerTest != SLOT_INDEX_NO_BOUND)
+     {
+      rv = CompareNumericValues(theKey->type,theKey->value,theProbe->lower.type,theProbe->lower.value);
+      if ((rv < 0) || ((rv == 0) && (theProbe->lowerTest == SLOT_INDEX_EXCLUSIVE)))
+        { return(FALSE); }
+     }
+
+   if (theProbe->upperTest != SLOT_INDEX_NO_BOUND)
+     {
+      rv = CompareNumericValues(theKey->type,theKey->value,theProbe->upper.type,theProbe->upper.value);
+      if ((rv > 0) || ((rv == 0) && (theProbe->upperTest == SLOT_INDEX_EXCLUSIVE)))
+        { return(FALSE); }
+     }
+
+   return(TRUE);
+  }
+
+/********************************************/
+/* CompareEntryOrder: qsort routine putting */
+/*   entries in the order of their owners.  */
+/********************************************/
+static int CompareEntryOrder(
+  const void *entry1,
+  const void *entry2)
+  {
+   long long order1 = (* (struct slotIndexEntry * const *) entry1)->order;
+   long long order2 = (* (struct slotIndexEntry * const *) entry2)->order;
+
+   if (order1 < order2) return(-1);
+   if (order1 > order2) return(1);
+   return(0);
+  }
+
+#endif /* DEFINDEX_CONSTRUCT || DEFCLASS_SLOT_INDEXES */
@@ -0,0 +1,134 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                SLOT INDEX HEADER FILE               */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Secondary indexes mapping the value of a single  */
+/*   field slot to the facts or instances holding it.        */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_slotindx
+
+#define _H_slotindx
+
+struct slotIndex;
+struct slotIndexKey;
+struct slotIndexEntry;
+struct slotIndexProbe;
+
+#ifndef _H_evaluatn
+#include "evaluatn.h"
+#endif
+
+# include "execution_status.h"
+
+/*=====================================================*/
+/* Initial number of key buckets of an index, and the  */
+/* maximum height of the list which keeps the numeric  */
+/* keys of an ordered index sorted.                    */
+/*=====================================================*/
+
+#define SLOT_INDEX_INITIAL_BUCKETS 64
+#define SLOT_INDEX_MAX_LEVEL       24
+
+/*==================================================*/
+/* An entry ties one owner (a fact or an instance)  */
+/* to the key of its slot value. The entries of an  */
+/* owner are chained through nextInOwner so they    */
+/* can be found again when the owner is removed.    */
+/*==================================================*/
+
+struct slotIndexEntry
+  {
+   void *owner;
+   long long order;
+   struct slotIndex *theIndex;
+   struct slotIndexKey *theKey;
+   struct slotIndexEntry *previousInKey;
+   struct slotIndexEntry *nextInKey;
+   struct slotIndexEntry *nextInOwner;
+  };
+
+struct slotIndexKey
+  {
+   unsigned short type;
+   void *value;
+   double numericValue;
+   unsigned long hashValue;
+   unsigned long count;
+   struct slotIndexEntry *firstEntry;
+   struct slotIndexEntry *lastEntry;
+   struct slotIndexKey *nextInBucket;
+   struct slotIndexKey **forward;
+   int level;
+  };
+
+struct slotIndex
+  {
+   unsigned int ordered : 1;
+   struct slotIndexKey **buckets;
+   unsigned long bucketCount;
+   unsigned long keyCount;
+   unsigned long entryCount;
+   unsigned long nonNumericCount;
+   struct slotIndexKey *skipHead[SLOT_INDEX_MAX_LEVEL];
+   int skipLevel;
+   unsigned long skipSeed;
+  };
+
+/*=======================================================*/
+/* A probe selects the owners whose value is eq to key,  */
+/* or whose numeric value lies between the lower and the */
+/* upper bound. A bound test of SLOT_INDEX_NO_BOUND      */
+/* leaves that side of the range open.                   */
+/*=======================================================*/
+
+#define SLOT_INDEX_PROBE_EQ    0
+#define SLOT_INDEX_PROBE_RANGE 1
+
+#define SLOT_INDEX_NO_BOUND  0
+#define SLOT_INDEX_INCLUSIVE 1
+#define SLOT_INDEX_EXCLUSIVE 2
+
+struct slotIndexProbe
+  {
+   int kind;
+   DATA_OBJECT key;
+   DATA_OBJECT lower;
+   DATA_OBJECT upper;
+   int lowerTest;
+   int upperTest;
+  };
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _SLOTINDX_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+   LOCALE struct slotIndex              *CreateSlotIndex(void *,EXEC_STATUS,int);
+   LOCALE void                           ReturnSlotIndex(void *,EXEC_STATUS,struct slotIndex *);
+   LOCALE struct slotIndexEntry         *AddSlotIndexEntry(void *,EXEC_STATUS,struct slotIndex *,
+                                                           void *,long long,int,void *);
+   LOCALE void                           RemoveSlotIndexEntry(void *,EXEC_STATUS,struct slotIndexEntry *);
+   LOCALE intBool                        SlotIndexProbeApplies(struct slotIndex *,struct slotIndexProbe *);
+   LOCALE void                         **SlotIndexCandidates(void *,EXEC_STATUS,struct slotIndex *,
+                                                             struct slotIndexProbe *,unsigned long *);
+   LOCALE void                           ReturnSlotIndexCandidates(void *,EXEC_STATUS,void **,unsigned long);
+
+#endif
@@ -22,9 +22,11 @@
 
 #define _BSAVE_SOURCE_
 
+#include <string.h>
+
 #include "setup.h"
 
-#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES
+#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES || BLOAD_FACTS || BSAVE_FACTS
 
 #include "argacces.h"
 #include "bload.h"
@@ -43,11 +45,11 @@
 /***************************************/
 
    static void                        ReadNeededBitMaps(void *,EXEC_STATUS);
-#if BLOAD_AND_BSAVE || BSAVE_INSTANCES
+#if BLOAD_AND_BSAVE || BSAVE_INSTANCES || BSAVE_FACTS
    static void                        WriteNeededBitMaps(void *,EXEC_STATUS,FILE *);
 #endif
 
-#if BLOAD_AND_BSAVE || BSAVE_INSTANCES
+#if BLOAD_AND_BSAVE || BSAVE_INSTANCES || BSAVE_FACTS
 
 /**********************************************/
 /* WriteNeededAtomicValues: Save all symbols, */
@@ -74,7 +76,7 @@ globle void InitAtomicValueNeededFlags(
   void *theEnv,
   EXEC_STATUS)
   {
-   unsigned long i;
+   unsigned long i, tableSize;
    SYMBOL_HN *symbolPtr, **symbolArray;
    FLOAT_HN *floatPtr, **floatArray;
    INTEGER_HN *integerPtr, **integerArray;
@@ -85,15 +87,13 @@ globle void InitAtomicValueNeededFlags(
    /*===============*/
 
    symbolArray = GetSymbolTable(theEnv,execStatus);
+   tableSize = GetSymbolTableSize(theEnv,execStatus);
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
       symbolPtr = symbolArray[i];
-      while (symbolPtr != NULL)
-        {
-         symbolPtr->neededSymbol = FALSE;
-         symbolPtr = symbolPtr->next;
-        }
+      if (symbolPtr != NULL)
+        { symbolPtr->neededSymbol = FALSE; }
      }
 
    /*==============*/
@@ -101,15 +101,13 @@ globle void InitAtomicValueNeededFlags(
    /*==============*/
 
    floatArray = GetFloatTable(theEnv,execStatus);
+   tableSize = GetFloatTableSize(theEnv,execStatus);
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
       floatPtr = floatArray[i];
-      while (floatPtr != NULL)
-        {
-         floatPtr->neededFloat = FALSE;
-         floatPtr = floatPtr->next;
-        }
+      if (floatPtr != NULL)
+        { floatPtr->neededFloat = FALSE; }
      }
 
    /*================*/
@@ -117,15 +115,13 @@ globle void InitAtomicValueNeededFlags(
    /*================*/
 
    integerArray = GetIntegerTable(theEnv,execStatus);
+   tableSize = GetIntegerTableSize(theEnv,execStatus);
 
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
       integerPtr = integerArray[i];
-      while (integerPtr != NULL)
-        {
-         integerPtr->neededInteger = FALSE;
-         integerPtr = integerPtr->next;
-        }
+      if (integerPtr != NULL)
+        { integerPtr->neededInteger = FALSE; }
      }
 
    /*===============*/
@@ -133,15 +129,13 @@ globle void InitAtomicValueNeededFlags(
    /*===============*/
 
    bitMapArray = GetBitMapTable(theEnv,execStatus);
+   tableSize = GetBitMapTableSize(theEnv,execStatus);
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
       bitMapPtr = bitMapArray[i];
-      while (bitMapPtr != NULL)
-        {
-         bitMapPtr->neededBitMap = FALSE;
-         bitMapPtr = bitMapPtr->next;
-        }
+      if (bitMapPtr != NULL)
+        { bitMapPtr->neededBitMap = FALSE; }
      }
   }
 
@@ -154,34 +148,31 @@ globle void WriteNeededSymbols(
   EXEC_STATUS,
   FILE *fp)
   {
-   unsigned long i;
+   unsigned long i, tableSize;
    size_t length;
    SYMBOL_HN **symbolArray;
    SYMBOL_HN *symbolPtr;
    unsigned long int numberOfUsedSymbols = 0;
-   size_t size = 0;
+   size_t size = 0, written = 0;
 
    /*=================================*/
    /* Get a copy of the symbol table. */
    /*=================================*/
 
    symbolArray = GetSymbolTable(theEnv,execStatus);
+   tableSize = GetSymbolTableSize(theEnv,execStatus);
 
    /*======================================================*/
    /* Get the number of symbols and the total string size. */
    /*======================================================*/
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (symbolPtr = symbolArray[i];
-           symbolPtr != NULL;
-           symbolPtr = symbolPtr->next)
+      symbolPtr = symbolArray[i];
+      if ((symbolPtr != NULL) && symbolPtr->neededSymbol)
         {
-         if (symbolPtr->neededSymbol)
-           {
-            numberOfUsedSymbols++;
-            size += strlen(symbolPtr->contents) + 1;
-           }
+         numberOfUsedSymbols++;
+         size += strlen(symbolPtr->contents) + 1;
         }
      }
 
@@ -189,22 +180,22 @@ globle void WriteNeededSymbols(
    /* Write out the symbols and the string sizes. */
    /*=============================================*/
 
+   size = BinaryAlignedSize(size);
    GenWrite((void *) &numberOfUsedSymbols,(unsigned long) sizeof(unsigned long int),fp);
    GenWrite((void *) &size,(unsigned long) sizeof(unsigned long int),fp);
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (symbolPtr = symbolArray[i];
-           symbolPtr != NULL;
-           symbolPtr = symbolPtr->next)
+      symbolPtr = symbolArray[i];
+      if ((symbolPtr != NULL) && symbolPtr->neededSymbol)
         {
-         if (symbolPtr->neededSymbol)
-           {
-            length = strlen(symbolPtr->contents) + 1;
-            GenWrite((void *) symbolPtr->contents,(unsigned long) length,fp);
-           }
+         length = strlen(symbolPtr->contents) + 1;
+         GenWrite((void *) symbolPtr->contents,(unsigned long) length,fp);
+         written += length;
         }
      }
+
+   WriteBinaryPadding(fp,written);
   }
 
 /*****************************************************************/
@@ -216,7 +207,7 @@ globle void WriteNeededFloats(
   EXEC_STATUS,
   FILE *fp)
   {
-   int i;
+   unsigned long i, tableSize;
    FLOAT_HN **floatArray;
    FLOAT_HN *floatPtr;
    unsigned long int numberOfUsedFloats = 0;
@@ -226,17 +217,17 @@ globle void WriteNeededFloats(
    /*================================*/
 
    floatArray = GetFloatTable(theEnv,execStatus);
+   tableSize = GetFloatTableSize(theEnv,execStatus);
 
    /*===========================*/
    /* Get the number of floats. */
    /*===========================*/
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (floatPtr = floatArray[i];
-           floatPtr != NULL;
-           floatPtr = floatPtr->next)
-        { if (floatPtr->neededFloat) numberOfUsedFloats++; }
+      floatPtr = floatArray[i];
+      if ((floatPtr != NULL) && floatPtr->neededFloat)
+        { numberOfUsedFloats++; }
      }
 
    /*======================================================*/
@@ -245,16 +236,12 @@ globle void WriteNeededFloats(
 
    GenWrite(&numberOfUsedFloats,(unsigned long) sizeof(unsigned long int),fp);
 
-   for (i = 0 ; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (floatPtr = floatArray[i];
-           floatPtr != NULL;
-           floatPtr = floatPtr->next)
-        {
-         if (floatPtr->neededFloat)
-           { GenWrite(&floatPtr->contents,
-                      (unsigned long) sizeof(floatPtr->contents),fp); }
-        }
+      floatPtr = floatArray[i];
+      if ((floatPtr != NULL) && floatPtr->neededFloat)
+        { GenWrite(&floatPtr->contents,
+                   (unsigned long) sizeof(floatPtr->contents),fp); }
      }
   }
 
@@ -267,7 +254,7 @@ globle void WriteNeededIntegers(
   EXEC_STATUS,
   FILE *fp)
   {
-   int i;
+   unsigned long i, tableSize;
    INTEGER_HN **integerArray;
    INTEGER_HN *integerPtr;
    unsigned long int numberOfUsedIntegers = 0;
@@ -277,19 +264,17 @@ globle void WriteNeededIntegers(
    /*==================================*/
 
    integerArray = GetIntegerTable(theEnv,execStatus);
+   tableSize = GetIntegerTableSize(theEnv,execStatus);
 
    /*=============================*/
    /* Get the number of integers. */
    /*=============================*/
 
-   for (i = 0 ; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (integerPtr = integerArray[i];
-           integerPtr != NULL;
-           integerPtr = integerPtr->next)
-        {
-         if (integerPtr->neededInteger) numberOfUsedIntegers++;
-        }
+      integerPtr = integerArray[i];
+      if ((integerPtr != NULL) && integerPtr->neededInteger)
+        { numberOfUsedIntegers++; }
      }
 
    /*==========================================================*/
@@ -298,17 +283,13 @@ globle void WriteNeededIntegers(
 
    GenWrite(&numberOfUsedIntegers,(unsigned long) sizeof(unsigned long int),fp);
 
-   for (i = 0 ; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (integerPtr = integerArray[i];
-           integerPtr != NULL;
-           integerPtr = integerPtr->next)
+      integerPtr = integerArray[i];
+      if ((integerPtr != NULL) && integerPtr->neededInteger)
         {
-         if (integerPtr->neededInteger)
-           {
-            GenWrite(&integerPtr->contents,
-                     (unsigned long) sizeof(integerPtr->contents),fp);
-           }
+         GenWrite(&integerPtr->contents,
+                  (unsigned long) sizeof(integerPtr->contents),fp);
         }
      }
   }
@@ -322,10 +303,10 @@ static void WriteNeededBitMaps(
   EXEC_STATUS,
   FILE *fp)
   {
-   int i;
+   unsigned long i, tableSize;
    BITMAP_HN **bitMapArray;
    BITMAP_HN *bitMapPtr;
-   unsigned long int numberOfUsedBitMaps = 0, size = 0;
+   unsigned long int numberOfUsedBitMaps = 0, size = 0, written;
    unsigned short tempSize;
 
    /*=================================*/
@@ -333,22 +314,19 @@ static void WriteNeededBitMaps(
    /*=================================*/
 
    bitMapArray = GetBitMapTable(theEnv,execStatus);
+   tableSize = GetBitMapTableSize(theEnv,execStatus);
 
    /*======================================================*/
    /* Get the number of bitmaps and the total bitmap size. */
    /*======================================================*/
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (bitMapPtr = bitMapArray[i];
-           bitMapPtr != NULL;
-           bitMapPtr = bitMapPtr->next)
+      bitMapPtr = bitMapArray[i];
+      if ((bitMapPtr != NULL) && bitMapPtr->neededBitMap)
         {
-         if (bitMapPtr->neededBitMap)
-           {
-            numberOfUsedBitMaps++;
-            size += (unsigned long) (bitMapPtr->size + sizeof(unsigned short));
-           }
+         numberOfUsedBitMaps++;
+         size += (unsigned long) (bitMapPtr->size + sizeof(unsigned short));
         }
      }
 
@@ -356,26 +334,43 @@ static void WriteNeededBitMaps(
    /* Write out the bitmaps and their sizes. */
    /*========================================*/
 
+   written = size;
+   size = (unsigned long) BinaryAlignedSize(size);
    GenWrite((void *) &numberOfUsedBitMaps,(unsigned long) sizeof(unsigned long int),fp);
    GenWrite((void *) &size,(unsigned long) sizeof(unsigned long int),fp);
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (bitMapPtr = bitMapArray[i];
-           bitMapPtr != NULL;
-           bitMapPtr = bitMapPtr->next)
+      bitMapPtr = bitMapArray[i];
+      if ((bitMapPtr != NULL) && bitMapPtr->neededBitMap)
         {
-         if (bitMapPtr->neededBitMap)
-           {
-            tempSize = (unsigned short) bitMapPtr->size;
-            GenWrite((void *) &tempSize,(unsigned long) sizeof(unsigned short),fp);
-            GenWrite((void *) bitMapPtr->contents,(unsigned long) bitMapPtr->size,fp);
-           }
+         tempSize = (unsigned short) bitMapPtr->size;
+         GenWrite((void *) &tempSize,(unsigned long) sizeof(unsigned short),fp);
+         GenWrite((void *) bitMapPtr->contents,(unsigned long) bitMapPtr->size,fp);
         }
      }
+
+   WriteBinaryPadding(fp,written);
   }
 
-#endif /* BLOAD_AND_BSAVE || BSAVE_INSTANCES */
+/*******************************************************/
+/* WriteBinaryPadding: Writes the zero bytes needed to */
+/*   round the given number of bytes just written up   */
+/*   to a multiple of BINARY_ALIGNMENT.                */
+/*******************************************************/
+globle void WriteBinaryPadding(
+  FILE *fp,
+  size_t size)
+  {
+   char padding[BINARY_ALIGNMENT];
+
+   if (BinaryAlignedSize(size) == size) return;
+
+   memset(padding,0,sizeof(padding));
+   GenWrite(padding,(unsigned long) (BinaryAlignedSize(size) - size),fp);
+  }
+
+#endif /* BLOAD_AND_BSAVE || BSAVE_INSTANCES || BSAVE_FACTS */
 
 /*********************************************/
 /* ReadNeededAtomicValues: Read all symbols, */
@@ -403,6 +398,7 @@ globle void ReadNeededSymbols(
    char *symbolNames, *namePtr;
    unsigned long space;
    long i;
+   intBool bufferAllocated = FALSE;
 
    /*=================================================*/
    /* Determine the number of symbol names to be read */
@@ -417,12 +413,19 @@ globle void ReadNeededSymbols(
       return;
      }
 
-   /*=======================================*/
-   /* Allocate area for strings to be read. */
-   /*=======================================*/
+   /*===============================================*/
+   /* Use the strings in place if the binary file   */
+   /* is memory mapped, otherwise allocate an area  */
+   /* for them and read them.                       */
+   /*===============================================*/
 
-   symbolNames = (char *) gm3(theEnv,execStatus,(long) space);
-   GenReadBinary(theEnv,execStatus,(void *) symbolNames,space);
+   symbolNames = (char *) GenReadBinaryInPlace(theEnv,execStatus,space,1);
+   if (symbolNames == NULL)
+     {
+      symbolNames = (char *) gm3(theEnv,execStatus,(long) space);
+      GenReadBinary(theEnv,execStatus,(void *) symbolNames,space);
+      bufferAllocated = TRUE;
+     }
 
    /*================================================*/
    /* Store the symbol pointers in the symbol array. */
@@ -441,7 +444,8 @@ globle void ReadNeededSymbols(
    /* Free the name buffer. */
    /*=======================*/
 
-   rm3(theEnv,execStatus,(void *) symbolNames,(long) space);
+   if (bufferAllocated)
+     { rm3(theEnv,execStatus,(void *) symbolNames,(long) space); }
   }
 
 /*****************************************/
@@ -454,6 +458,7 @@ globle void ReadNeededFloats(
   {
    double *floatValues;
    long i;
+   intBool bufferAllocated = FALSE;
 
    /*============================================*/
    /* Determine the number of floats to be read. */
@@ -466,12 +471,20 @@ globle void ReadNeededFloats(
       return;
      }
 
-   /*===============================*/
-   /* Allocate area for the floats. */
-   /*===============================*/
+   /*=============================================*/
+   /* Use the floats in place if the binary file  */
+   /* is memory mapped, otherwise read them into  */
+   /* an area allocated for them.                 */
+   /*=============================================*/
 
-   floatValues = (double *) gm3(theEnv,execStatus,(long) sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats);
-   GenReadBinary(theEnv,execStatus,(void *) floatValues,(unsigned long) (sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats));
+   floatValues = (double *) GenReadBinaryInPlace(theEnv,execStatus,sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats,
+                                                 BinaryRecordAlignment(sizeof(double)));
+   if (floatValues == NULL)
+     {
+      floatValues = (double *) gm3(theEnv,execStatus,(long) sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats);
+      GenReadBinary(theEnv,execStatus,(void *) floatValues,(unsigned long) (sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats));
+      bufferAllocated = TRUE;
+     }
 
    /*======================================*/
    /* Store the floats in the float array. */
@@ -486,7 +499,8 @@ globle void ReadNeededFloats(
    /* Free the float buffer. */
    /*========================*/
 
-   rm3(theEnv,execStatus,(void *) floatValues,(long) (sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats));
+   if (bufferAllocated)
+     { rm3(theEnv,execStatus,(void *) floatValues,(long) (sizeof(double) * SymbolData(theEnv,execStatus)->NumberOfFloats)); }
   }
 
 /*********************************************/
@@ -499,6 +513,7 @@ globle void ReadNeededIntegers(
   {
    long long *integerValues;
    long i;
+   intBool bufferAllocated = FALSE;
 
    /*==============================================*/
    /* Determine the number of integers to be read. */
@@ -511,12 +526,20 @@ globle void ReadNeededIntegers(
       return;
      }
 
-   /*=================================*/
-   /* Allocate area for the integers. */
-   /*=================================*/
+   /*=============================================*/
+   /* Use the integers in place if the binary     */
+   /* file is memory mapped, otherwise read them  */
+   /* into an area allocated for them.            */
+   /*=============================================*/
 
-   integerValues = (long long *) gm3(theEnv,execStatus,(long) (sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers));
-   GenReadBinary(theEnv,execStatus,(void *) integerValues,(unsigned long) (sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers));
+   integerValues = (long long *) GenReadBinaryInPlace(theEnv,execStatus,sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers,
+                                                      BinaryRecordAlignment(sizeof(long long)));
+   if (integerValues == NULL)
+     {
+      integerValues = (long long *) gm3(theEnv,execStatus,(long) (sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers));
+      GenReadBinary(theEnv,execStatus,(void *) integerValues,(unsigned long) (sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers));
+      bufferAllocated = TRUE;
+     }
 
    /*==========================================*/
    /* Store the integers in the integer array. */
@@ -531,7 +554,8 @@ globle void ReadNeededIntegers(
    /* Free the integer buffer. */
    /*==========================*/
 
-   rm3(theEnv,execStatus,(void *) integerValues,(long) (sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers));
+   if (bufferAllocated)
+     { rm3(theEnv,execStatus,(void *) integerValues,(long) (sizeof(long long) * SymbolData(theEnv,execStatus)->NumberOfIntegers)); }
   }
 
 /*******************************************/
@@ -616,4 +640,4 @@ globle void FreeAtomicValueStorage(
    SymbolData(theEnv,execStatus)->NumberOfBitMaps = 0;
   }
 
-#endif /* BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES */
+#endif /* BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES || BLOAD_FACTS || BSAVE_FACTS */
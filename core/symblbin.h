@@ -55,6 +55,7 @@
    LOCALE void                    WriteNeededSymbols(void *,EXEC_STATUS,FILE *);
    LOCALE void                    WriteNeededFloats(void *,EXEC_STATUS,FILE *);
    LOCALE void                    WriteNeededIntegers(void *,EXEC_STATUS,FILE *);
+   LOCALE void                    WriteBinaryPadding(FILE *,size_t);
    LOCALE void                    ReadNeededSymbols(void *,EXEC_STATUS);
    LOCALE void                    ReadNeededFloats(void *,EXEC_STATUS);
    LOCALE void                    ReadNeededIntegers(void *,EXEC_STATUS);
@@ -101,7 +101,7 @@ static int SymbolHashNodesToCode(
   char *fileNameBuffer,
   int version)
   {
-   unsigned long i, j;
+   unsigned long i, j, tableSize;
    struct symbolHashNode *hashPtr;
    int count;
    int numberOfEntries;
@@ -115,14 +115,15 @@ static int SymbolHashNodesToCode(
    /*====================================*/
 
    symbolTable = GetSymbolTable(theEnv,execStatus);
+   tableSize = GetSymbolTableSize(theEnv,execStatus);
    count = numberOfEntries = 0;
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = symbolTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        { numberOfEntries++; }
+      hashPtr = symbolTable[i];
+      if (hashPtr == NULL) continue;
+
+      numberOfEntries++;
      }
 
    if (numberOfEntries == 0) return(version);
@@ -142,50 +143,39 @@ static int SymbolHashNodesToCode(
 
    j = 0;
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = symbolTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        {
-         if (newHeader)
-           {
-            fprintf(fp,"struct symbolHashNode S%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
-            newHeader = FALSE;
-           }
+      hashPtr = symbolTable[i];
+      if (hashPtr == NULL) continue;
 
-         if (hashPtr->next == NULL)
-           { fprintf(fp,"{NULL,"); }
-         else
-           {
-            if ((j + 1) >= (unsigned long) ConstructCompilerData(theEnv,execStatus)->MaxIndices)
-              { fprintf(fp,"{&S%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion + 1,0); }
-            else
-              { fprintf(fp,"{&S%d_%d[%ld],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion,j + 1); }
-           }
+      if (newHeader)
+        {
+         fprintf(fp,"struct symbolHashNode S%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
+         newHeader = FALSE;
+        }
 
-         fprintf(fp,"%ld,0,1,0,0,%ld,",hashPtr->count + 1,i);
-         PrintCString(fp,hashPtr->contents);
+      fprintf(fp,"{%lu,0,0,1,0,%lu,%uU,%u,",(unsigned long) hashPtr->count + 1,
+                 HashSymbol(hashPtr->contents,SYMBOL_HASH_SIZE),hashPtr->hashValue,hashPtr->length);
+      PrintCString(fp,hashPtr->contents);
 
-         count++;
-         j++;
+      count++;
+      j++;
 
-         if ((count == numberOfEntries) || (j >= (unsigned) ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+      if ((count == numberOfEntries) || (j >= (unsigned) ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+        {
+         fprintf(fp,"}};\n");
+         GenClose(theEnv,execStatus,fp);
+         j = 0;
+         arrayVersion++;
+         version++;
+         if (count < numberOfEntries)
            {
-            fprintf(fp,"}};\n");
-            GenClose(theEnv,execStatus,fp);
-            j = 0;
-            arrayVersion++;
-            version++;
-            if (count < numberOfEntries)
-              {
-               if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
-               newHeader = TRUE;
-              }
+            if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
+            newHeader = TRUE;
            }
-         else
-           { fprintf(fp,"},\n"); }
         }
+      else
+        { fprintf(fp,"},\n"); }
      }
 
    return(version);
@@ -205,6 +195,7 @@ static int BitMapHashNodesToCode(
   int version)
   {
    int i, j;
+   unsigned long tableSize;
    struct bitMapHashNode *hashPtr;
    int count;
    int numberOfEntries;
@@ -219,14 +210,15 @@ static int BitMapHashNodesToCode(
    /*====================================*/
 
    bitMapTable = GetBitMapTable(theEnv,execStatus);
+   tableSize = GetBitMapTableSize(theEnv,execStatus);
    count = numberOfEntries = 0;
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = bitMapTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        { numberOfEntries++; }
+      hashPtr = bitMapTable[i];
+      if (hashPtr == NULL) continue;
+
+      numberOfEntries++;
      }
 
    if (numberOfEntries == 0) return(version);
@@ -246,61 +238,49 @@ static int BitMapHashNodesToCode(
 
    j = 0;
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = bitMapTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        {
-         if (newHeader)
-           {
-            fprintf(fp,"struct bitMapHashNode B%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
-            newHeader = FALSE;
-           }
+      hashPtr = bitMapTable[i];
+      if (hashPtr == NULL) continue;
 
-         if (hashPtr->next == NULL)
-           { fprintf(fp,"{NULL,"); }
-         else
-           {
-            if ((j + 1) >= ConstructCompilerData(theEnv,execStatus)->MaxIndices)
-              { fprintf(fp,"{&B%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion + 1,0); }
-            else
-              { fprintf(fp,"{&B%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion,j + 1); }
-           }
+      if (newHeader)
+        {
+         fprintf(fp,"struct bitMapHashNode B%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
+         newHeader = FALSE;
+        }
 
-         fprintf(fp,"%ld,0,1,0,0,%d,(char *) &L%d_%d[%d],%d",
-                     hashPtr->count + 1,i,
-                     ConstructCompilerData(theEnv,execStatus)->ImageID,longsReqdPartition,longsReqdPartitionCount,
-                     hashPtr->size);
+      fprintf(fp,"{%lu,0,0,1,0,%lu,(char *) &L%d_%d[%d],%d",
+                  (unsigned long) hashPtr->count + 1,HashBitMap(hashPtr->contents,BITMAP_HASH_SIZE,hashPtr->size),
+                  ConstructCompilerData(theEnv,execStatus)->ImageID,longsReqdPartition,longsReqdPartitionCount,
+                  hashPtr->size);
 
-         longsReqdPartitionCount += (int) (hashPtr->size / sizeof(unsigned long));
-         if ((hashPtr->size % sizeof(unsigned long)) != 0)
-           longsReqdPartitionCount++;
-         if (longsReqdPartitionCount >= ConstructCompilerData(theEnv,execStatus)->MaxIndices)
-           {
-            longsReqdPartitionCount = 0;
-            longsReqdPartition++;
-           }
+      longsReqdPartitionCount += (int) (hashPtr->size / sizeof(unsigned long));
+      if ((hashPtr->size % sizeof(unsigned long)) != 0)
+        longsReqdPartitionCount++;
+      if (longsReqdPartitionCount >= ConstructCompilerData(theEnv,execStatus)->MaxIndices)
+        {
+         longsReqdPartitionCount = 0;
+         longsReqdPartition++;
+        }
 
-         count++;
-         j++;
+      count++;
+      j++;
 
-         if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+      if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+        {
+         fprintf(fp,"}};\n");
+         GenClose(theEnv,execStatus,fp);
+         j = 0;
+         arrayVersion++;
+         version++;
+         if (count < numberOfEntries)
            {
-            fprintf(fp,"}};\n");
-            GenClose(theEnv,execStatus,fp);
-            j = 0;
-            arrayVersion++;
-            version++;
-            if (count < numberOfEntries)
-              {
-               if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
-               newHeader = TRUE;
-              }
+            if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
+            newHeader = TRUE;
            }
-         else
-           { fprintf(fp,"},\n"); }
         }
+      else
+        { fprintf(fp,"},\n"); }
      }
 
    return(version);
@@ -321,6 +301,7 @@ static int BitMapValuesToCode(
   {
    int i, j, k;
    unsigned l;
+   unsigned long tableSize;
    struct bitMapHashNode *hashPtr;
    int count;
    int numberOfEntries;
@@ -336,18 +317,17 @@ static int BitMapValuesToCode(
    /*====================================*/
 
    bitMapTable = GetBitMapTable(theEnv,execStatus);
+   tableSize = GetBitMapTableSize(theEnv,execStatus);
    count = numberOfEntries = 0;
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = bitMapTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        {
-         numberOfEntries += (int) (hashPtr->size / sizeof(unsigned long));
-         if ((hashPtr->size % sizeof(unsigned long)) != 0)
-           { numberOfEntries++; }
-        }
+      hashPtr = bitMapTable[i];
+      if (hashPtr == NULL) continue;
+
+      numberOfEntries += (int) (hashPtr->size / sizeof(unsigned long));
+      if ((hashPtr->size % sizeof(unsigned long)) != 0)
+        { numberOfEntries++; }
      }
 
    if (numberOfEntries == 0) return(version);
@@ -367,54 +347,52 @@ static int BitMapValuesToCode(
 
    j = 0;
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = bitMapTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
+      hashPtr = bitMapTable[i];
+      if (hashPtr == NULL) continue;
+
+      if (newHeader)
         {
-         if (newHeader)
-           {
-            fprintf(fp,"unsigned long L%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
-            newHeader = FALSE;
-           }
+         fprintf(fp,"unsigned long L%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
+         newHeader = FALSE;
+        }
 
-         longsReqd = (int) (hashPtr->size / sizeof(unsigned long));
-         if ((hashPtr->size % sizeof(unsigned long)) != 0)
-           longsReqd++;
+      longsReqd = (int) (hashPtr->size / sizeof(unsigned long));
+      if ((hashPtr->size % sizeof(unsigned long)) != 0)
+        longsReqd++;
 
-         for (k = 0 ; k < longsReqd ; k++)
-           {
-            if (k > 0)
-              fprintf(fp,",");
-            tmpLong = 0L;
-            for (l = 0 ;
-                 ((l < sizeof(unsigned long)) &&
-                 (((k * sizeof(unsigned long)) + l) < (size_t) hashPtr->size)) ;
-                 l++)
-              ((char *) &tmpLong)[l] = hashPtr->contents[(k * sizeof(unsigned long)) + l];
-            fprintf(fp,"0x%lxL",tmpLong);
-           }
+      for (k = 0 ; k < longsReqd ; k++)
+        {
+         if (k > 0)
+           fprintf(fp,",");
+         tmpLong = 0L;
+         for (l = 0 ;
+              ((l < sizeof(unsigned long)) &&
+              (((k * sizeof(unsigned long)) + l) < (size_t) hashPtr->size)) ;
+              l++)
+           ((char *) &tmpLong)[l] = hashPtr->contents[(k * sizeof(unsigned long)) + l];
+         fprintf(fp,"0x%lxL",tmpLong);
+        }
 
-         count += longsReqd;
-         j += longsReqd;
+      count += longsReqd;
+      j += longsReqd;
 
-         if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+      if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+        {
+         fprintf(fp,"};\n");
+         GenClose(theEnv,execStatus,fp);
+         j = 0;
+         arrayVersion++;
+         version++;
+         if (count < numberOfEntries)
            {
-            fprintf(fp,"};\n");
-            GenClose(theEnv,execStatus,fp);
-            j = 0;
-            arrayVersion++;
-            version++;
-            if (count < numberOfEntries)
-              {
-               if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
-               newHeader = TRUE;
-              }
+            if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
+            newHeader = TRUE;
            }
-         else
-           { fprintf(fp,",\n"); }
         }
+      else
+        { fprintf(fp,",\n"); }
      }
 
    return(version);
@@ -434,6 +412,7 @@ static int FloatHashNodesToCode(
   int version)
   {
    int i, j;
+   unsigned long tableSize;
    struct floatHashNode *hashPtr;
    int count;
    int numberOfEntries;
@@ -447,14 +426,15 @@ static int FloatHashNodesToCode(
    /*====================================*/
 
    floatTable = GetFloatTable(theEnv,execStatus);
+   tableSize = GetFloatTableSize(theEnv,execStatus);
    count = numberOfEntries = 0;
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = floatTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        { numberOfEntries++; }
+      hashPtr = floatTable[i];
+      if (hashPtr == NULL) continue;
+
+      numberOfEntries++;
      }
 
    if (numberOfEntries == 0) return(version);
@@ -474,50 +454,38 @@ static int FloatHashNodesToCode(
 
    j = 0;
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = floatTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        {
-         if (newHeader)
-           {
-            fprintf(fp,"struct floatHashNode F%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
-            newHeader = FALSE;
-           }
+      hashPtr = floatTable[i];
+      if (hashPtr == NULL) continue;
 
-         if (hashPtr->next == NULL)
-           { fprintf(fp,"{NULL,"); }
-         else
-           {
-            if ((j + 1) >= ConstructCompilerData(theEnv,execStatus)->MaxIndices)
-              { fprintf(fp,"{&F%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion + 1,0); }
-            else
-              { fprintf(fp,"{&F%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion,j + 1); }
-           }
+      if (newHeader)
+        {
+         fprintf(fp,"struct floatHashNode F%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
+         newHeader = FALSE;
+        }
 
-         fprintf(fp,"%ld,0,1,0,0,%d,",hashPtr->count + 1,i);
-         fprintf(fp,"%s",FloatToString(theEnv,execStatus,hashPtr->contents));
+      fprintf(fp,"{%lu,0,0,1,0,%lu,",(unsigned long) hashPtr->count + 1,HashFloat(hashPtr->contents,FLOAT_HASH_SIZE));
+      fprintf(fp,"%s",FloatToString(theEnv,execStatus,hashPtr->contents));
 
-         count++;
-         j++;
+      count++;
+      j++;
 
-         if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+      if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+        {
+         fprintf(fp,"}};\n");
+         GenClose(theEnv,execStatus,fp);
+         j = 0;
+         version++;
+         arrayVersion++;
+         if (count < numberOfEntries)
            {
-            fprintf(fp,"}};\n");
-            GenClose(theEnv,execStatus,fp);
-            j = 0;
-            version++;
-            arrayVersion++;
-            if (count < numberOfEntries)
-              {
-               if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
-               newHeader = TRUE;
-              }
+            if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
+            newHeader = TRUE;
            }
-         else
-           { fprintf(fp,"},\n"); }
         }
+      else
+        { fprintf(fp,"},\n"); }
      }
 
    return(version);
@@ -537,6 +505,7 @@ static int IntegerHashNodesToCode(
   int version)
   {
    int i, j;
+   unsigned long tableSize;
    struct integerHashNode *hashPtr;
    int count;
    int numberOfEntries;
@@ -550,14 +519,15 @@ static int IntegerHashNodesToCode(
    /*====================================*/
 
    integerTable = GetIntegerTable(theEnv,execStatus);
+   tableSize = GetIntegerTableSize(theEnv,execStatus);
    count = numberOfEntries = 0;
 
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = integerTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        { numberOfEntries++; }
+      hashPtr = integerTable[i];
+      if (hashPtr == NULL) continue;
+
+      numberOfEntries++;
      }
 
    if (numberOfEntries == 0) return(version);
@@ -577,50 +547,38 @@ static int IntegerHashNodesToCode(
 
    j = 0;
 
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < tableSize; i++)
      {
-      for (hashPtr = integerTable[i];
-           hashPtr != NULL;
-           hashPtr = hashPtr->next)
-        {
-         if (newHeader)
-           {
-            fprintf(fp,"struct integerHashNode I%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
-            newHeader = FALSE;
-           }
+      hashPtr = integerTable[i];
+      if (hashPtr == NULL) continue;
 
-         if (hashPtr->next == NULL)
-           { fprintf(fp,"{NULL,"); }
-         else
-           {
-            if ((j + 1) >= ConstructCompilerData(theEnv,execStatus)->MaxIndices)
-              { fprintf(fp,"{&I%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion + 1,0); }
-            else
-              { fprintf(fp,"{&I%d_%d[%d],",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion,j + 1); }
-           }
+      if (newHeader)
+        {
+         fprintf(fp,"struct integerHashNode I%d_%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,arrayVersion);
+         newHeader = FALSE;
+        }
 
-         fprintf(fp,"%ld,0,1,0,0,%d,",hashPtr->count + 1,i);
-         fprintf(fp,"%lldLL",hashPtr->contents);
+      fprintf(fp,"{%lu,0,0,1,0,%lu,",(unsigned long) hashPtr->count + 1,HashInteger(hashPtr->contents,INTEGER_HASH_SIZE));
+      fprintf(fp,"%lldLL",hashPtr->contents);
 
-         count++;
-         j++;
+      count++;
+      j++;
 
-         if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+      if ((count == numberOfEntries) || (j >= ConstructCompilerData(theEnv,execStatus)->MaxIndices))
+        {
+         fprintf(fp,"}};\n");
+         GenClose(theEnv,execStatus,fp);
+         j = 0;
+         version++;
+         arrayVersion++;
+         if (count < numberOfEntries)
            {
-            fprintf(fp,"}};\n");
-            GenClose(theEnv,execStatus,fp);
-            j = 0;
-            version++;
-            arrayVersion++;
-            if (count < numberOfEntries)
-              {
-               if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
-               newHeader = TRUE;
-              }
+            if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,version,FALSE)) == NULL) return(0);
+            newHeader = TRUE;
            }
-         else
-           { fprintf(fp,"},\n"); }
         }
+      else
+        { fprintf(fp,"},\n"); }
      }
 
    return(version);
@@ -629,7 +587,9 @@ static int IntegerHashNodesToCode(
 /****************************************************************/
 /* HashTablesToCode: Produces the code for the symbol, integer, */
 /*   float, and bitmap hash tables for a run-time module        */
-/*   created using the constructs-to-c function.                */
+/*   created using the constructs-to-c function. Each table is  */
+/*   a NULL terminated list of its entries, which are hashed    */
+/*   into growable tables when the run-time module starts.      */
 /****************************************************************/
 static int HashTablesToCode(
   void *theEnv,
@@ -638,7 +598,7 @@ static int HashTablesToCode(
   char *pathName,
   char *fileNameBuffer)
   {
-   unsigned long i;
+   unsigned long i, tableSize;
    FILE *fp;
    struct symbolHashNode **symbolTable;
    struct floatHashNode **floatTable;
@@ -654,16 +614,18 @@ static int HashTablesToCode(
    if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,1,FALSE)) == NULL) return(0);
 
    fprintf(ConstructCompilerData(theEnv,execStatus)->HeaderFP,"extern struct symbolHashNode *sht%d[];\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
-   fprintf(fp,"struct symbolHashNode *sht%d[%ld] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,SYMBOL_HASH_SIZE);
+   fprintf(fp,"struct symbolHashNode *sht%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   tableSize = GetSymbolTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
       {
-       PrintSymbolReference(theEnv,execStatus,fp,symbolTable[i]);
+       if (symbolTable[i] == NULL) continue;
 
-       if (i + 1 != SYMBOL_HASH_SIZE) fprintf(fp,",\n");
+       PrintSymbolReference(theEnv,execStatus,fp,symbolTable[i]);
+       fprintf(fp,",\n");
       }
 
-    fprintf(fp,"};\n");
+    fprintf(fp,"NULL};\n");
 
     GenClose(theEnv,execStatus,fp);
 
@@ -676,17 +638,18 @@ static int HashTablesToCode(
    if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,2,FALSE)) == NULL) return(0);
 
    fprintf(ConstructCompilerData(theEnv,execStatus)->HeaderFP,"extern struct floatHashNode *fht%d[];\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
-   fprintf(fp,"struct floatHashNode *fht%d[%d] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,FLOAT_HASH_SIZE);
+   fprintf(fp,"struct floatHashNode *fht%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   tableSize = GetFloatTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
       {
-       if (floatTable[i] == NULL) { fprintf(fp,"NULL"); }
-       else PrintFloatReference(theEnv,execStatus,fp,floatTable[i]);
+       if (floatTable[i] == NULL) continue;
 
-       if (i + 1 != FLOAT_HASH_SIZE) fprintf(fp,",\n");
+       PrintFloatReference(theEnv,execStatus,fp,floatTable[i]);
+       fprintf(fp,",\n");
       }
 
-    fprintf(fp,"};\n");
+    fprintf(fp,"NULL};\n");
 
     GenClose(theEnv,execStatus,fp);
 
@@ -699,17 +662,18 @@ static int HashTablesToCode(
    if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,3,FALSE)) == NULL) return(0);
 
    fprintf(ConstructCompilerData(theEnv,execStatus)->HeaderFP,"extern struct integerHashNode *iht%d[];\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
-   fprintf(fp,"struct integerHashNode *iht%d[%d] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,INTEGER_HASH_SIZE);
+   fprintf(fp,"struct integerHashNode *iht%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
 
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   tableSize = GetIntegerTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
       {
-       if (integerTable[i] == NULL) { fprintf(fp,"NULL"); }
-       else PrintIntegerReference(theEnv,execStatus,fp,integerTable[i]);
+       if (integerTable[i] == NULL) continue;
 
-       if (i + 1 != INTEGER_HASH_SIZE) fprintf(fp,",\n");
+       PrintIntegerReference(theEnv,execStatus,fp,integerTable[i]);
+       fprintf(fp,",\n");
       }
 
-    fprintf(fp,"};\n");
+    fprintf(fp,"NULL};\n");
 
     GenClose(theEnv,execStatus,fp);
 
@@ -722,16 +686,18 @@ static int HashTablesToCode(
    if ((fp = NewCFile(theEnv,execStatus,fileName,pathName,fileNameBuffer,1,4,FALSE)) == NULL) return(0);
 
    fprintf(ConstructCompilerData(theEnv,execStatus)->HeaderFP,"extern struct bitMapHashNode *bmht%d[];\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
-   fprintf(fp,"struct bitMapHashNode *bmht%d[%d] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID,BITMAP_HASH_SIZE);
+   fprintf(fp,"struct bitMapHashNode *bmht%d[] = {\n",ConstructCompilerData(theEnv,execStatus)->ImageID);
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   tableSize = GetBitMapTableSize(theEnv,execStatus);
+   for (i = 0; i < tableSize; i++)
       {
-       PrintBitMapReference(theEnv,execStatus,fp,bitMapTable[i]);
+       if (bitMapTable[i] == NULL) continue;
 
-       if (i + 1 != BITMAP_HASH_SIZE) fprintf(fp,",\n");
+       PrintBitMapReference(theEnv,execStatus,fp,bitMapTable[i]);
+       fprintf(fp,",\n");
       }
 
-    fprintf(fp,"};\n");
+    fprintf(fp,"NULL};\n");
 
     GenClose(theEnv,execStatus,fp);
 
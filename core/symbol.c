@@ -70,15 +70,38 @@
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
 
-   static void                    RemoveHashNode(void *,EXEC_STATUS,GENERIC_HN *,GENERIC_HN **,int,int);
-   static void                    AddEphemeralHashNode(void *,EXEC_STATUS,GENERIC_HN *,struct ephemeron **,
-                                                       int,int);
-   static void                    RemoveEphemeralHashNodes(void *,EXEC_STATUS,struct ephemeron **,
-                                                           GENERIC_HN **,
+   static void                    RemoveHashNode(void *,EXEC_STATUS,GENERIC_HN *,struct atomTable *,int,int);
+   static void                    AddEphemeralHashNode(void *,EXEC_STATUS,GENERIC_HN *,int,int,int);
+   static intBool                 RemoveEphemeralHashNodes(void *,EXEC_STATUS,struct ephemeralAtoms *,
+                                                           struct atomTable *,
                                                            int,int,int);
+   static void                    StartEphemeralScan(void *,EXEC_STATUS,struct ephemeralAtoms *);
+   static void                    MergeThreadEphemerons(void *,EXEC_STATUS);
+   static struct ephemeron       *AppendEphemerons(struct ephemeron *,struct ephemeron *);
+   static void                    ReturnEphemerons(void *,EXEC_STATUS,struct ephemeron *);
+   static void                    ReturnEphemeralAtoms(void *,EXEC_STATUS,struct ephemeralAtoms *);
    static char                   *StringWithinString(char *,char *);
    static size_t                  CommonPrefixLength(char *,char *);
    static void                    DeallocateSymbolData(void *,EXEC_STATUS);
+   static void                    CreateAtomTable(void *,EXEC_STATUS,struct atomTable *,unsigned long);
+   static struct atomSlots       *CreateAtomSlots(void *,EXEC_STATUS,unsigned long);
+   static void                    ReturnAtomSlots(void *,EXEC_STATUS,struct atomSlots *);
+   static void                    ReturnRetiredAtomSlots(void *,EXEC_STATUS,struct atomTable *);
+   static void                    ReturnAtomTable(void *,EXEC_STATUS,struct atomTable *);
+   static void                    LoadAtomTable(void *,EXEC_STATUS,struct atomTable *,unsigned long,
+                                                GENERIC_HN **,int);
+   static unsigned int            AtomTag(unsigned long);
+   static unsigned long           AtomSlot(struct atomSlots *,unsigned int);
+   static unsigned long           EmptyAtomSlot(struct atomSlots *,unsigned int);
+   static unsigned long           AtomHashValue(GENERIC_HN *,int);
+   static SYMBOL_HN              *FindSymbolEntry(struct atomSlots *,char *,size_t,unsigned int);
+   static FLOAT_HN               *FindFloatEntry(struct atomSlots *,double,unsigned int);
+   static INTEGER_HN             *FindIntegerEntry(struct atomSlots *,long long,unsigned int);
+   static BITMAP_HN              *FindBitMapEntry(struct atomSlots *,char *,unsigned,unsigned int);
+   static EXTERNAL_ADDRESS_HN    *FindExternalAddressEntry(struct atomSlots *,void *,unsigned,unsigned int);
+   static void                    AddAtomTableEntry(void *,EXEC_STATUS,struct atomTable *,GENERIC_HN *,unsigned int);
+   static void                    GrowAtomTable(void *,EXEC_STATUS,struct atomTable *);
+   static void                    RemoveAtomTableEntry(void *,EXEC_STATUS,struct atomTable *,GENERIC_HN *,unsigned int);
 
 /*******************************************************/
 /* InitializeAtomTables: Initializes the SymbolTable,  */
@@ -104,39 +127,26 @@ globle void InitializeAtomTables(
 #pragma unused(bitmapTable)
 #pragma unused(externalAddressTable)
 #endif
-   unsigned long i;
    
    AllocateEnvironmentData(theEnv,execStatus,SYMBOL_DATA,sizeof(struct symbolData),DeallocateSymbolData);
 
+   if (apr_thread_rwlock_create(&SymbolData(theEnv,execStatus)->AtomTablesLock,
+                                Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+     {
+      SystemError(theEnv,execStatus,"SYMBOL",17);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
+
 #if ! RUN_TIME
    /*=========================*/
    /* Create the hash tables. */
    /*=========================*/
 
-   SymbolData(theEnv,execStatus)->SymbolTable = (SYMBOL_HN **)
-                  gm3(theEnv,execStatus,sizeof (SYMBOL_HN *) * SYMBOL_HASH_SIZE);
-
-   SymbolData(theEnv,execStatus)->FloatTable = (FLOAT_HN **)
-                  gm2(theEnv,execStatus,(int) sizeof (FLOAT_HN *) * FLOAT_HASH_SIZE);
-
-   SymbolData(theEnv,execStatus)->IntegerTable = (INTEGER_HN **)
-                   gm2(theEnv,execStatus,(int) sizeof (INTEGER_HN *) * INTEGER_HASH_SIZE);
-
-   SymbolData(theEnv,execStatus)->BitMapTable = (BITMAP_HN **)
-                   gm2(theEnv,execStatus,(int) sizeof (BITMAP_HN *) * BITMAP_HASH_SIZE);
-
-   SymbolData(theEnv,execStatus)->ExternalAddressTable = (EXTERNAL_ADDRESS_HN **)
-                   gm2(theEnv,execStatus,(int) sizeof (EXTERNAL_ADDRESS_HN *) * EXTERNAL_ADDRESS_HASH_SIZE);
-
-   /*===================================================*/
-   /* Initialize all of the hash table entries to NULL. */
-   /*===================================================*/
-
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++) SymbolData(theEnv,execStatus)->SymbolTable[i] = NULL;
-   for (i = 0; i < FLOAT_HASH_SIZE; i++) SymbolData(theEnv,execStatus)->FloatTable[i] = NULL;
-   for (i = 0; i < INTEGER_HASH_SIZE; i++) SymbolData(theEnv,execStatus)->IntegerTable[i] = NULL;
-   for (i = 0; i < BITMAP_HASH_SIZE; i++) SymbolData(theEnv,execStatus)->BitMapTable[i] = NULL;
-   for (i = 0; i < EXTERNAL_ADDRESS_HASH_SIZE; i++) SymbolData(theEnv,execStatus)->ExternalAddressTable[i] = NULL;
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->SymbolTable,INITIAL_SYMBOL_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->FloatTable,INITIAL_ATOM_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->IntegerTable,INITIAL_ATOM_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->BitMapTable,INITIAL_ATOM_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->ExternalAddressTable,INITIAL_ATOM_TABLE_SIZE);
 
    /*========================*/
    /* Predefine some values. */
@@ -153,15 +163,22 @@ globle void InitializeAtomTables(
    SymbolData(theEnv,execStatus)->Zero = EnvAddLong(theEnv,execStatus,0LL);
    IncrementIntegerCount(SymbolData(theEnv,execStatus)->Zero);
 #else
+   /*===================================================*/
+   /* The tables of a run-time program are NULL         */
+   /* terminated lists of the values it was created     */
+   /* with, which are hashed into growable tables here. */
+   /*===================================================*/
+
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->SymbolTable,INITIAL_SYMBOL_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->FloatTable,INITIAL_ATOM_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->IntegerTable,INITIAL_ATOM_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->BitMapTable,INITIAL_ATOM_TABLE_SIZE);
+   CreateAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->ExternalAddressTable,INITIAL_ATOM_TABLE_SIZE);
+
    SetSymbolTable(theEnv,execStatus,symbolTable);
    SetFloatTable(theEnv,execStatus,floatTable);
    SetIntegerTable(theEnv,execStatus,integerTable);
    SetBitMapTable(theEnv,execStatus,bitmapTable);
-   
-   SymbolData(theEnv,execStatus)->ExternalAddressTable = (EXTERNAL_ADDRESS_HN **)
-                gm2(theEnv,execStatus,(int) sizeof (EXTERNAL_ADDRESS_HN *) * EXTERNAL_ADDRESS_HASH_SIZE);
-
-   for (i = 0; i < EXTERNAL_ADDRESS_HASH_SIZE; i++) SymbolData(theEnv,execStatus)->ExternalAddressTable[i] = NULL;
 #endif
   }
 
@@ -173,164 +190,103 @@ static void DeallocateSymbolData(
   void *theEnv,
   EXEC_STATUS)
   {
-   int i;
-   SYMBOL_HN *shPtr, *nextSHPtr;
-   INTEGER_HN *ihPtr, *nextIHPtr;
-   FLOAT_HN *fhPtr, *nextFHPtr;
-   BITMAP_HN *bmhPtr, *nextBMHPtr;
-   EXTERNAL_ADDRESS_HN *eahPtr, *nextEAHPtr;
-   struct ephemeron *edPtr, *nextEDPtr;
-
-   if ((SymbolData(theEnv,execStatus)->SymbolTable == NULL) ||
-       (SymbolData(theEnv,execStatus)->FloatTable == NULL) ||
-       (SymbolData(theEnv,execStatus)->IntegerTable == NULL) ||
-       (SymbolData(theEnv,execStatus)->BitMapTable == NULL) ||
-       (SymbolData(theEnv,execStatus)->ExternalAddressTable == NULL))
+   unsigned long i;
+   struct atomSlots *theSlots;
+   SYMBOL_HN *shPtr;
+   BITMAP_HN *bmhPtr;
+   GENERIC_HN *theEntry;
+   struct threadEphemerons *theBlock, *nextBlock;
+
+   if ((SymbolData(theEnv,execStatus)->SymbolTable.slots == NULL) ||
+       (SymbolData(theEnv,execStatus)->FloatTable.slots == NULL) ||
+       (SymbolData(theEnv,execStatus)->IntegerTable.slots == NULL) ||
+       (SymbolData(theEnv,execStatus)->BitMapTable.slots == NULL) ||
+       (SymbolData(theEnv,execStatus)->ExternalAddressTable.slots == NULL))
      { return; }
      
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++) 
+   theSlots = SymbolData(theEnv,execStatus)->SymbolTable.slots;
+   for (i = 0; i < theSlots->size; i++) 
      {
-      shPtr = SymbolData(theEnv,execStatus)->SymbolTable[i];
+      shPtr = (SYMBOL_HN *) theSlots->entries[i];
       
-      while (shPtr != NULL)
-        {
-         nextSHPtr = shPtr->next;
-         if (! shPtr->permanent)
-           {
-            rm(theEnv,execStatus,shPtr->contents,strlen(shPtr->contents)+1);
-            rtn_struct(theEnv,execStatus,symbolHashNode,shPtr);
-           }  
-         shPtr = nextSHPtr;
-        } 
+      if ((shPtr != NULL) && (! shPtr->permanent))
+        { rtn_var_struct(theEnv,execStatus,symbolHashNode,shPtr->length + 1,shPtr); }
      }
       
-   for (i = 0; i < FLOAT_HASH_SIZE; i++) 
+   theSlots = SymbolData(theEnv,execStatus)->FloatTable.slots;
+   for (i = 0; i < theSlots->size; i++) 
      {
-      fhPtr = SymbolData(theEnv,execStatus)->FloatTable[i];
+      theEntry = theSlots->entries[i];
 
-      while (fhPtr != NULL)
-        {
-         nextFHPtr = fhPtr->next;
-         if (! fhPtr->permanent)
-           { rtn_struct(theEnv,execStatus,floatHashNode,fhPtr); }
-         fhPtr = nextFHPtr;
-        }
+      if ((theEntry != NULL) && (! theEntry->permanent))
+        { rtn_struct(theEnv,execStatus,floatHashNode,theEntry); }
      }
      
-   for (i = 0; i < INTEGER_HASH_SIZE; i++) 
+   theSlots = SymbolData(theEnv,execStatus)->IntegerTable.slots;
+   for (i = 0; i < theSlots->size; i++) 
      {
-      ihPtr = SymbolData(theEnv,execStatus)->IntegerTable[i];
+      theEntry = theSlots->entries[i];
 
-      while (ihPtr != NULL)
-        {
-         nextIHPtr = ihPtr->next;
-         if (! ihPtr->permanent)
-           { rtn_struct(theEnv,execStatus,integerHashNode,ihPtr); }
-         ihPtr = nextIHPtr;
-        }
+      if ((theEntry != NULL) && (! theEntry->permanent))
+        { rtn_struct(theEnv,execStatus,integerHashNode,theEntry); }
      }
      
-   for (i = 0; i < BITMAP_HASH_SIZE; i++) 
+   theSlots = SymbolData(theEnv,execStatus)->BitMapTable.slots;
+   for (i = 0; i < theSlots->size; i++) 
      {
-      bmhPtr = SymbolData(theEnv,execStatus)->BitMapTable[i];
+      bmhPtr = (BITMAP_HN *) theSlots->entries[i];
 
-      while (bmhPtr != NULL)
-        {
-         nextBMHPtr = bmhPtr->next;
-         if (! bmhPtr->permanent)
-           {
-            rm(theEnv,execStatus,bmhPtr->contents,bmhPtr->size);
-            rtn_struct(theEnv,execStatus,bitMapHashNode,bmhPtr); 
-           } 
-         bmhPtr = nextBMHPtr;
-        }
+      if ((bmhPtr != NULL) && (! bmhPtr->permanent))
+        { rtn_var_struct(theEnv,execStatus,bitMapHashNode,bmhPtr->size,bmhPtr); }
      }
 
-   for (i = 0; i < EXTERNAL_ADDRESS_HASH_SIZE; i++) 
+   theSlots = SymbolData(theEnv,execStatus)->ExternalAddressTable.slots;
+   for (i = 0; i < theSlots->size; i++) 
      {
-      eahPtr = SymbolData(theEnv,execStatus)->ExternalAddressTable[i];
+      theEntry = theSlots->entries[i];
 
-      while (eahPtr != NULL)
-        {
-         nextEAHPtr = eahPtr->next;
-         if (! eahPtr->permanent)
-           {
-            rtn_struct(theEnv,execStatus,externalAddressHashNode,eahPtr); 
-           } 
-         eahPtr = nextEAHPtr;
-        }
+      if ((theEntry != NULL) && (! theEntry->permanent))
+        { rtn_struct(theEnv,execStatus,externalAddressHashNode,theEntry); }
      }
 
    /*=========================================*/
    /* Remove the ephemeral symbol structures. */
    /*=========================================*/
    
-   edPtr = SymbolData(theEnv,execStatus)->EphemeralSymbolList;
-
-   while (edPtr != NULL)
-     {
-      nextEDPtr = edPtr->next;
-      rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-      edPtr = nextEDPtr;
-     }
-
-   edPtr = SymbolData(theEnv,execStatus)->EphemeralFloatList;
-
-   while (edPtr != NULL)
-     {
-      nextEDPtr = edPtr->next;
-      rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-      edPtr = nextEDPtr;
-     }
-
-   edPtr = SymbolData(theEnv,execStatus)->EphemeralIntegerList;
-
-   while (edPtr != NULL)
-     {
-      nextEDPtr = edPtr->next;
-      rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-      edPtr = nextEDPtr;
-     }
-
-   edPtr = SymbolData(theEnv,execStatus)->EphemeralBitMapList;
-
-   while (edPtr != NULL)
-     {
-      nextEDPtr = edPtr->next;
-      rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-      edPtr = nextEDPtr;
-     }
-
-   edPtr = SymbolData(theEnv,execStatus)->EphemeralExternalAddressList;
-
-   while (edPtr != NULL)
+   ReturnEphemeralAtoms(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralSymbols);
+   ReturnEphemeralAtoms(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralFloats);
+   ReturnEphemeralAtoms(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralIntegers);
+   ReturnEphemeralAtoms(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralBitMaps);
+   ReturnEphemeralAtoms(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralExternalAddresses);
+
+   for (theBlock = SymbolData(theEnv,execStatus)->HandedOverEphemerons;
+        theBlock != NULL;
+        theBlock = nextBlock)
      {
-      nextEDPtr = edPtr->next;
-      rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-      edPtr = nextEDPtr;
+      nextBlock = theBlock->next;
+      ReturnEphemerons(theEnv,execStatus,theBlock->symbolList);
+      ReturnEphemerons(theEnv,execStatus,theBlock->floatList);
+      ReturnEphemerons(theEnv,execStatus,theBlock->integerList);
+      ReturnEphemerons(theEnv,execStatus,theBlock->bitMapList);
+      ReturnEphemerons(theEnv,execStatus,theBlock->externalAddressList);
+      rtn_struct(theEnv,execStatus,threadEphemerons,theBlock);
      }
 
    /*================================*/
    /* Remove the symbol hash tables. */
    /*================================*/
    
- #if ! RUN_TIME  
-   rm3(theEnv,execStatus,SymbolData(theEnv,execStatus)->SymbolTable,sizeof (SYMBOL_HN *) * SYMBOL_HASH_SIZE);
-
-   genfree(theEnv,execStatus,SymbolData(theEnv,execStatus)->FloatTable,(int) sizeof (FLOAT_HN *) * FLOAT_HASH_SIZE);
-
-   genfree(theEnv,execStatus,SymbolData(theEnv,execStatus)->IntegerTable,(int) sizeof (INTEGER_HN *) * INTEGER_HASH_SIZE);
-
-   genfree(theEnv,execStatus,SymbolData(theEnv,execStatus)->BitMapTable,(int) sizeof (BITMAP_HN *) * BITMAP_HASH_SIZE);
-#endif
-   
-   genfree(theEnv,execStatus,SymbolData(theEnv,execStatus)->ExternalAddressTable,(int) sizeof (EXTERNAL_ADDRESS_HN *) * EXTERNAL_ADDRESS_HASH_SIZE);
+   ReturnAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->SymbolTable);
+   ReturnAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->FloatTable);
+   ReturnAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->IntegerTable);
+   ReturnAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->BitMapTable);
+   ReturnAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->ExternalAddressTable);
 
    /*==============================*/
    /* Remove binary symbol tables. */
    /*==============================*/
    
-#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES
+#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES || BLOAD_FACTS || BSAVE_FACTS
    if (SymbolData(theEnv,execStatus)->SymbolArray != NULL)
      rm3(theEnv,execStatus,(void *) SymbolData(theEnv,execStatus)->SymbolArray,(long) sizeof(SYMBOL_HN *) * SymbolData(theEnv,execStatus)->NumberOfSymbols);
    if (SymbolData(theEnv,execStatus)->FloatArray != NULL)
@@ -354,13 +310,15 @@ globle void *EnvAddSymbol(
   EXEC_STATUS,
   char *str)
   {
-   unsigned long tally;
+   unsigned long tally = 0;
    size_t length;
-   SYMBOL_HN *past = NULL, *peek;
+   unsigned int tag;
+   struct atomTable *theTable;
+   SYMBOL_HN *peek;
 
-    /*====================================*/
-    /* Get the hash value for the string. */
-    /*====================================*/
+    /*==================================================*/
+    /* Get the hash value and the length of the string. */
+    /*==================================================*/
 
     if (str == NULL)
       {
@@ -368,48 +326,60 @@ globle void *EnvAddSymbol(
        EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
       }
 
-    tally = HashSymbol(str,SYMBOL_HASH_SIZE);
-    peek = SymbolData(theEnv,execStatus)->SymbolTable[tally];
+    for (length = 0; str[length]; length++)
+      { tally = tally * 127 + str[length]; }
 
-    /*==================================================*/
-    /* Search for the string in the list of entries for */
-    /* this symbol table location.  If the string is    */
-    /* found, then return the address of the string.    */
-    /*==================================================*/
+    /*================================================*/
+    /* Search for the string without locking the      */
+    /* table. If the string is found, return its      */
+    /* address.                                       */
+    /*================================================*/
 
-    while (peek != NULL)
-      {
-       if (strcmp(str,peek->contents) == 0)
-         { return((void *) peek); }
-       past = peek;
-       peek = peek->next;
-      }
+    theTable = &SymbolData(theEnv,execStatus)->SymbolTable;
+    tag = AtomTag(tally);
 
-    /*==================================================*/
-    /* Add the string at the end of the list of entries */
-    /* for this symbol table location.                  */
-    /*==================================================*/
+    peek = FindSymbolEntry(theTable->slots,str,length,tag);
+    if (peek != NULL) return((void *) peek);
+
+    /*=====================================================*/
+    /* Otherwise search again while holding the lock of    */
+    /* the table, since another thread may have added the  */
+    /* string in the meantime, and add the string if it's  */
+    /* still missing. The characters are stored following  */
+    /* the entry.                                          */
+    /*=====================================================*/
 
-    peek = get_struct(theEnv,execStatus,symbolHashNode);
+    apr_thread_mutex_lock(theTable->lock);
+
+    peek = FindSymbolEntry(theTable->slots,str,length,tag);
+    if (peek != NULL)
+      {
+       apr_thread_mutex_unlock(theTable->lock);
+       return((void *) peek);
+      }
 
-    if (past == NULL) SymbolData(theEnv,execStatus)->SymbolTable[tally] = peek;
-    else past->next = peek;
+    peek = get_var_struct(theEnv,execStatus,symbolHashNode,length + 1);
 
-    length = strlen(str) + 1;
-    peek->contents = (char *) gm2(theEnv,execStatus,length);
-    peek->next = NULL;
-    peek->bucket = tally;
+    peek->contents = (char *) (peek + 1);
+    peek->hashValue = (unsigned int) tally;
+    peek->length = (unsigned int) length;
+    peek->bucket = tally % SYMBOL_HASH_SIZE;
     peek->count = 0;
+    peek->markedEphemeral = FALSE;
+    peek->depth = execStatus->CurrentEvaluationDepth;
     peek->permanent = FALSE;
-    genstrcpy(peek->contents,str);
+    memcpy(peek->contents,str,length + 1);
+
+    AddAtomTableEntry(theEnv,execStatus,theTable,(GENERIC_HN *) peek,tag);
+
+    apr_thread_mutex_unlock(theTable->lock);
       
     /*================================================*/
     /* Add the string to the list of ephemeral items. */
     /*================================================*/
 
-    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,&SymbolData(theEnv,execStatus)->EphemeralSymbolList,
+    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,SYMBOL,
                          sizeof(SYMBOL_HN),AVERAGE_STRING_SIZE);
-    peek->depth = execStatus->CurrentEvaluationDepth;
 
     /*===================================*/
     /* Return the address of the symbol. */
@@ -427,20 +397,8 @@ globle SYMBOL_HN *FindSymbolHN(
   EXEC_STATUS,
   char *str)
   {
-   unsigned long tally;
-   SYMBOL_HN *peek;
-
-    tally = HashSymbol(str,SYMBOL_HASH_SIZE);
-
-    for (peek = SymbolData(theEnv,execStatus)->SymbolTable[tally];
-         peek != NULL;
-         peek = peek->next)
-      { 
-       if (strcmp(str,peek->contents) == 0) 
-         { return(peek); }
-      }
-
-    return(NULL);
+   return(FindSymbolEntry(SymbolData(theEnv,execStatus)->SymbolTable.slots,
+                          str,strlen(str),AtomTag(HashSymbol(str,0))));
    }
 
 /*******************************************************************/
@@ -455,52 +413,59 @@ globle void *EnvAddDouble(
   double number)
   {
    unsigned long tally;
-   FLOAT_HN *past = NULL, *peek;
+   unsigned int tag;
+   struct atomTable *theTable;
+   FLOAT_HN *peek;
 
     /*====================================*/
     /* Get the hash value for the double. */
     /*====================================*/
 
-    tally = HashFloat(number,FLOAT_HASH_SIZE);
-    peek = SymbolData(theEnv,execStatus)->FloatTable[tally];
+    tally = HashFloat(number,0);
+    theTable = &SymbolData(theEnv,execStatus)->FloatTable;
+    tag = AtomTag(tally);
 
     /*==================================================*/
-    /* Search for the double in the list of entries for */
-    /* this hash location.  If the double is found,     */
-    /* then return the address of the double.           */
+    /* Search for the double without locking the table, */
+    /* then again while holding the lock. If the double */
+    /* is found, then return the address of the double. */
     /*==================================================*/
 
-    while (peek != NULL)
+    peek = FindFloatEntry(theTable->slots,number,tag);
+    if (peek != NULL) return((void *) peek);
+
+    apr_thread_mutex_lock(theTable->lock);
+
+    peek = FindFloatEntry(theTable->slots,number,tag);
+    if (peek != NULL)
       {
-       if (number == peek->contents)
-         { return((void *) peek); }
-       past = peek;
-       peek = peek->next;
+       apr_thread_mutex_unlock(theTable->lock);
+       return((void *) peek);
       }
 
-    /*=================================================*/
-    /* Add the float at the end of the list of entries */
-    /* for this hash location.                         */
-    /*=================================================*/
+    /*=============================*/
+    /* Add the float to the table. */
+    /*=============================*/
 
     peek = get_struct(theEnv,execStatus,floatHashNode);
 
-    if (past == NULL) SymbolData(theEnv,execStatus)->FloatTable[tally] = peek;
-    else past->next = peek;
-
     peek->contents = number;
-    peek->next = NULL;
-    peek->bucket = tally;
+    peek->bucket = tally % FLOAT_HASH_SIZE;
     peek->count = 0;
+    peek->markedEphemeral = FALSE;
+    peek->depth = execStatus->CurrentEvaluationDepth;
     peek->permanent = FALSE;
 
+    AddAtomTableEntry(theEnv,execStatus,theTable,(GENERIC_HN *) peek,tag);
+
+    apr_thread_mutex_unlock(theTable->lock);
+
     /*===============================================*/
     /* Add the float to the list of ephemeral items. */
     /*===============================================*/
 
-    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,&SymbolData(theEnv,execStatus)->EphemeralFloatList,
+    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,FLOAT,
                          sizeof(FLOAT_HN),0);
-    peek->depth = execStatus->CurrentEvaluationDepth;
 
     /*==================================*/
     /* Return the address of the float. */
@@ -521,51 +486,59 @@ globle void *EnvAddLong(
   long long number)
   {
    unsigned long tally;
-   INTEGER_HN *past = NULL, *peek;
+   unsigned int tag;
+   struct atomTable *theTable;
+   INTEGER_HN *peek;
 
     /*==================================*/
     /* Get the hash value for the long. */
     /*==================================*/
 
-    tally = HashInteger(number,INTEGER_HASH_SIZE);
-    peek = SymbolData(theEnv,execStatus)->IntegerTable[tally];
+    tally = HashInteger(number,0);
+    theTable = &SymbolData(theEnv,execStatus)->IntegerTable;
+    tag = AtomTag(tally);
 
     /*================================================*/
-    /* Search for the long in the list of entries for */
-    /* this hash location. If the long is found, then */
-    /* return the address of the long.                */
+    /* Search for the long without locking the table, */
+    /* then again while holding the lock. If the long */
+    /* is found, then return the address of the long. */
     /*================================================*/
 
-    while (peek != NULL)
+    peek = FindIntegerEntry(theTable->slots,number,tag);
+    if (peek != NULL) return((void *) peek);
+
+    apr_thread_mutex_lock(theTable->lock);
+
+    peek = FindIntegerEntry(theTable->slots,number,tag);
+    if (peek != NULL)
       {
-       if (number == peek->contents)
-         { return((void *) peek); }
-       past = peek;
-       peek = peek->next;
+       apr_thread_mutex_unlock(theTable->lock);
+       return((void *) peek);
       }
 
-    /*================================================*/
-    /* Add the long at the end of the list of entries */
-    /* for this hash location.                        */
-    /*================================================*/
+    /*============================*/
+    /* Add the long to the table. */
+    /*============================*/
 
     peek = get_struct(theEnv,execStatus,integerHashNode);
-    if (past == NULL) SymbolData(theEnv,execStatus)->IntegerTable[tally] = peek;
-    else past->next = peek;
 
     peek->contents = number;
-    peek->next = NULL;
-    peek->bucket = tally;
+    peek->bucket = tally % INTEGER_HASH_SIZE;
     peek->count = 0;
+    peek->markedEphemeral = FALSE;
+    peek->depth = execStatus->CurrentEvaluationDepth;
     peek->permanent = FALSE;
 
+    AddAtomTableEntry(theEnv,execStatus,theTable,(GENERIC_HN *) peek,tag);
+
+    apr_thread_mutex_unlock(theTable->lock);
+
     /*=================================================*/
     /* Add the integer to the list of ephemeral items. */
     /*=================================================*/
 
-    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,&SymbolData(theEnv,execStatus)->EphemeralIntegerList,
+    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,INTEGER,
                          sizeof(INTEGER_HN),0);
-    peek->depth = execStatus->CurrentEvaluationDepth;
 
     /*====================================*/
     /* Return the address of the integer. */
@@ -583,17 +556,8 @@ globle INTEGER_HN *FindLongHN(
   EXEC_STATUS,
   long long theLong)
   {
-   unsigned long tally;
-   INTEGER_HN *peek;
-
-   tally = HashInteger(theLong,INTEGER_HASH_SIZE);
-
-   for (peek = SymbolData(theEnv,execStatus)->IntegerTable[tally];
-        peek != NULL;
-        peek = peek->next)
-     { if (peek->contents == theLong) return(peek); }
-
-   return(NULL);
+   return(FindIntegerEntry(SymbolData(theEnv,execStatus)->IntegerTable.slots,
+                           theLong,AtomTag(HashInteger(theLong,0))));
   }
 
 /*******************************************************************/
@@ -610,8 +574,9 @@ globle void *EnvAddBitMap(
   {
    char *theBitMap = (char *) vTheBitMap;
    unsigned long tally;
-   unsigned i;
-   BITMAP_HN *past = NULL, *peek;
+   unsigned int tag;
+   struct atomTable *theTable;
+   BITMAP_HN *peek;
 
     /*====================================*/
     /* Get the hash value for the bitmap. */
@@ -623,54 +588,54 @@ globle void *EnvAddBitMap(
        EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
       }
 
-    tally = HashBitMap(theBitMap,BITMAP_HASH_SIZE,size);
-    peek = SymbolData(theEnv,execStatus)->BitMapTable[tally];
+    tally = HashBitMap(theBitMap,0,size);
+    theTable = &SymbolData(theEnv,execStatus)->BitMapTable;
+    tag = AtomTag(tally);
 
     /*==================================================*/
-    /* Search for the bitmap in the list of entries for */
-    /* this hash table location.  If the bitmap is      */
-    /* found, then return the address of the bitmap.    */
+    /* Search for the bitmap without locking the table, */
+    /* then again while holding the lock. If the bitmap */
+    /* is found, then return the address of the bitmap. */
     /*==================================================*/
 
-    while (peek != NULL)
-      {
-	   if (peek->size == (unsigned short) size)
-         {
-          for (i = 0; i < size ; i++)
-            { if (peek->contents[i] != theBitMap[i]) break; }
+    peek = FindBitMapEntry(theTable->slots,theBitMap,size,tag);
+    if (peek != NULL) return((void *) peek);
 
-          if (i == size) return((void *) peek);
-         }
+    apr_thread_mutex_lock(theTable->lock);
 
-       past = peek;
-       peek = peek->next;
+    peek = FindBitMapEntry(theTable->slots,theBitMap,size,tag);
+    if (peek != NULL)
+      {
+       apr_thread_mutex_unlock(theTable->lock);
+       return((void *) peek);
       }
 
-    /*==================================================*/
-    /* Add the bitmap at the end of the list of entries */
-    /* for this hash table location.  Return the        */
-    /*==================================================*/
+    /*==============================================*/
+    /* Add the bitmap to the table. The bitmap is   */
+    /* stored following the entry.                  */
+    /*==============================================*/
 
-    peek = get_struct(theEnv,execStatus,bitMapHashNode);
-    if (past == NULL) SymbolData(theEnv,execStatus)->BitMapTable[tally] = peek;
-    else past->next = peek;
+    peek = get_var_struct(theEnv,execStatus,bitMapHashNode,size);
 
-    peek->contents = (char *) gm2(theEnv,execStatus,size);
-    peek->next = NULL;
-    peek->bucket = tally;
+    peek->contents = (char *) (peek + 1);
+    peek->bucket = tally % BITMAP_HASH_SIZE;
     peek->count = 0;
+    peek->markedEphemeral = FALSE;
+    peek->depth = execStatus->CurrentEvaluationDepth;
     peek->permanent = FALSE;
     peek->size = (unsigned short) size;
+    memcpy(peek->contents,theBitMap,size);
+
+    AddAtomTableEntry(theEnv,execStatus,theTable,(GENERIC_HN *) peek,tag);
 
-    for (i = 0; i < size ; i++) peek->contents[i] = theBitMap[i];
+    apr_thread_mutex_unlock(theTable->lock);
 
     /*================================================*/
     /* Add the bitmap to the list of ephemeral items. */
     /*================================================*/
 
-    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,&SymbolData(theEnv,execStatus)->EphemeralBitMapList,
+    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,BITMAPARRAY,
                          sizeof(BITMAP_HN),sizeof(long));
-    peek->depth = execStatus->CurrentEvaluationDepth;
 
     /*===================================*/
     /* Return the address of the bitmap. */
@@ -693,55 +658,60 @@ globle void *EnvAddExternalAddress(
   unsigned theType)
   {
    unsigned long tally;
-   EXTERNAL_ADDRESS_HN *past = NULL, *peek;
-
-    /*====================================*/
-    /* Get the hash value for the bitmap. */
-    /*====================================*/
+   unsigned int tag;
+   struct atomTable *theTable;
+   EXTERNAL_ADDRESS_HN *peek;
 
-    tally = HashExternalAddress(theExternalAddress,EXTERNAL_ADDRESS_HASH_SIZE);
+    /*==============================================*/
+    /* Get the hash value for the external address. */
+    /*==============================================*/
 
-    peek = SymbolData(theEnv,execStatus)->ExternalAddressTable[tally];
+    tally = HashExternalAddress(theExternalAddress,0);
+    theTable = &SymbolData(theEnv,execStatus)->ExternalAddressTable;
+    tag = AtomTag(tally);
 
     /*=============================================================*/
-    /* Search for the external address in the list of entries for  */
-    /* this hash table location.  If the external addressis found, */
-    /* then return the address of the external address.            */
+    /* Search for the external address without locking the table,  */
+    /* then again while holding the lock. If the external address  */
+    /* is found, then return the address of the external address.  */
     /*=============================================================*/
 
-    while (peek != NULL)
-      {
-       if ((peek->type == (unsigned short) theType) &&
-           (peek->externalAddress == theExternalAddress))
-         { return((void *) peek); }
+    peek = FindExternalAddressEntry(theTable->slots,theExternalAddress,theType,tag);
+    if (peek != NULL) return((void *) peek);
 
-       past = peek;
-       peek = peek->next;
+    apr_thread_mutex_lock(theTable->lock);
+
+    peek = FindExternalAddressEntry(theTable->slots,theExternalAddress,theType,tag);
+    if (peek != NULL)
+      {
+       apr_thread_mutex_unlock(theTable->lock);
+       return((void *) peek);
       }
 
-    /*=================================================*/
-    /* Add the external address at the end of the list */
-    /* of entries for this hash table location.        */
-    /*=================================================*/
+    /*========================================*/
+    /* Add the external address to the table. */
+    /*========================================*/
 
     peek = get_struct(theEnv,execStatus,externalAddressHashNode);
-    if (past == NULL) SymbolData(theEnv,execStatus)->ExternalAddressTable[tally] = peek;
-    else past->next = peek;
 
     peek->externalAddress = theExternalAddress;
     peek->type = (unsigned short) theType;
-    peek->next = NULL;
-    peek->bucket = tally;
+    peek->bucket = tally % EXTERNAL_ADDRESS_HASH_SIZE;
     peek->count = 0;
+    peek->markedEphemeral = FALSE;
+    peek->depth = execStatus->CurrentEvaluationDepth;
     peek->permanent = FALSE;
 
+    AddAtomTableEntry(theEnv,execStatus,theTable,(GENERIC_HN *) peek,tag);
+
+    apr_thread_mutex_unlock(theTable->lock);
+
     /*================================================*/
     /* Add the bitmap to the list of ephemeral items. */
     /*================================================*/
 
-    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,&SymbolData(theEnv,execStatus)->EphemeralExternalAddressList,
+    AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) peek,EXTERNAL_ADDRESS,
                          sizeof(EXTERNAL_ADDRESS_HN),sizeof(long));
-    peek->depth = execStatus->CurrentEvaluationDepth;
 
     /*=============================================*/
     /* Return the address of the external address. */
@@ -803,15 +773,15 @@ globle unsigned long HashInteger(
 #if WIN_MVC
    if (number < 0)
      { number = - number; }
-   tally = (((unsigned) number) % range);
+   tally = ((unsigned) number);
 #else
-   tally = (((unsigned) llabs(number)) % range);
+   tally = ((unsigned) llabs(number));
 #endif
 
    if (range == 0)
      { return tally; }
      
-   return(tally);
+   return(tally % range);
   }
 
 /****************************************/
@@ -895,29 +865,16 @@ globle void DecrementSymbolCount(
   EXEC_STATUS,
   SYMBOL_HN *theValue)
   {
-   if (theValue->count < 0)
-     {
-      SystemError(theEnv,execStatus,"SYMBOL",3);
-      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
-     }
-
    if (theValue->count == 0)
      {
       SystemError(theEnv,execStatus,"SYMBOL",4);
       EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
      }
 
-   theValue->count--;
-
-   if (theValue->count != 0) return;
-
-   if (theValue->markedEphemeral == FALSE)
-     {
-      AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,&SymbolData(theEnv,execStatus)->EphemeralSymbolList,
-                           sizeof(SYMBOL_HN),AVERAGE_STRING_SIZE);
-     }
+   if (apr_atomic_dec32(&theValue->count) != 0) return;
 
-   return;
+   AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,SYMBOL,
+                        sizeof(SYMBOL_HN),AVERAGE_STRING_SIZE);
   }
 
 /***************************************************/
@@ -930,23 +887,16 @@ globle void DecrementFloatCount(
   EXEC_STATUS,
   FLOAT_HN *theValue)
   {
-   if (theValue->count <= 0)
+   if (theValue->count == 0)
      {
       SystemError(theEnv,execStatus,"SYMBOL",5);
       EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
      }
 
-   theValue->count--;
-
-   if (theValue->count != 0) return;
+   if (apr_atomic_dec32(&theValue->count) != 0) return;
 
-   if (theValue->markedEphemeral == FALSE)
-     {
-      AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,&SymbolData(theEnv,execStatus)->EphemeralFloatList,
-                           sizeof(FLOAT_HN),0);
-     }
-
-   return;
+   AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,FLOAT,
+                        sizeof(FLOAT_HN),0);
   }
 
 /*********************************************************/
@@ -959,23 +909,16 @@ globle void DecrementIntegerCount(
   EXEC_STATUS,
   INTEGER_HN *theValue)
   {
-   if (theValue->count <= 0)
+   if (theValue->count == 0)
      {
       SystemError(theEnv,execStatus,"SYMBOL",6);
       EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
      }
 
-   theValue->count--;
-
-   if (theValue->count != 0) return;
-
-   if (theValue->markedEphemeral == FALSE)
-     {
-      AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,&SymbolData(theEnv,execStatus)->EphemeralIntegerList,
-                           sizeof(INTEGER_HN),0);
-     }
+   if (apr_atomic_dec32(&theValue->count) != 0) return;
 
-   return;
+   AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,INTEGER,
+                        sizeof(INTEGER_HN),0);
   }
 
 /*****************************************************/
@@ -988,29 +931,16 @@ globle void DecrementBitMapCount(
   EXEC_STATUS,
   BITMAP_HN *theValue)
   {
-   if (theValue->count < 0)
-     {
-      SystemError(theEnv,execStatus,"SYMBOL",7);
-      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
-     }
-
    if (theValue->count == 0)
      {
       SystemError(theEnv,execStatus,"SYMBOL",8);
       EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
      }
 
-   theValue->count--;
-
-   if (theValue->count != 0) return;
-
-   if (theValue->markedEphemeral == FALSE)
-     {
-      AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,&SymbolData(theEnv,execStatus)->EphemeralBitMapList,
-                           sizeof(BITMAP_HN),sizeof(long));
-     }
+   if (apr_atomic_dec32(&theValue->count) != 0) return;
 
-   return;
+   AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,BITMAPARRAY,
+                        sizeof(BITMAP_HN),sizeof(long));
   }
 
 /*************************************************************/
@@ -1023,29 +953,16 @@ globle void DecrementExternalAddressCount(
   EXEC_STATUS,
   EXTERNAL_ADDRESS_HN *theValue)
   {
-   if (theValue->count < 0)
-     {
-      SystemError(theEnv,execStatus,"SYMBOL",9);
-      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
-     }
-
    if (theValue->count == 0)
      {
       SystemError(theEnv,execStatus,"SYMBOL",10);
       EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
      }
 
-   theValue->count--;
-
-   if (theValue->count != 0) return;
-
-   if (theValue->markedEphemeral == FALSE)
-     {
-      AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,&SymbolData(theEnv,execStatus)->EphemeralExternalAddressList,
-                           sizeof(EXTERNAL_ADDRESS_HN),sizeof(long));
-     }
+   if (apr_atomic_dec32(&theValue->count) != 0) return;
 
-   return;
+   AddEphemeralHashNode(theEnv,execStatus,(GENERIC_HN *) theValue,EXTERNAL_ADDRESS,
+                        sizeof(EXTERNAL_ADDRESS_HN),sizeof(long));
   }
   
 /************************************************/
@@ -1057,41 +974,17 @@ static void RemoveHashNode(
   void *theEnv,
   EXEC_STATUS,
   GENERIC_HN *theValue,
-  GENERIC_HN **theTable,
+  struct atomTable *theTable,
   int size,
   int type)
   {
-   GENERIC_HN *previousNode, *currentNode;
    struct externalAddressHashNode *theAddress;
 
-   /*=============================================*/
-   /* Find the entry in the specified hash table. */
-   /*=============================================*/
-
-   previousNode = NULL;
-   currentNode = theTable[theValue->bucket];
-
-   while (currentNode != theValue)
-     {
-      previousNode = currentNode;
-      currentNode = currentNode->next;
-
-      if (currentNode == NULL)
-        {
-         SystemError(theEnv,execStatus,"SYMBOL",11);
-         EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
-        }
-     }
-
-   /*===========================================*/
-   /* Remove the entry from the list of entries */
-   /* stored in the hash table bucket.          */
-   /*===========================================*/
+   /*=================================================*/
+   /* Remove the entry from the specified hash table. */
+   /*=================================================*/
 
-   if (previousNode == NULL)
-     { theTable[theValue->bucket] = theValue->next; }
-   else
-     { previousNode->next = currentNode->next; }
+   RemoveAtomTableEntry(theEnv,execStatus,theTable,theValue,AtomTag(AtomHashValue(theValue,type)));
 
    /*=================================================*/
    /* Symbol and bit map nodes have additional memory */
@@ -1099,15 +992,9 @@ static void RemoveHashNode(
    /*=================================================*/
 
    if (type == SYMBOL)
-     {
-      rm(theEnv,execStatus,((SYMBOL_HN *) theValue)->contents,
-         strlen(((SYMBOL_HN *) theValue)->contents) + 1);
-     }
+     { size += (int) ((SYMBOL_HN *) theValue)->length + 1; }
    else if (type == BITMAPARRAY)
-     {
-      rm(theEnv,execStatus,((BITMAP_HN *) theValue)->contents,
-         ((BITMAP_HN *) theValue)->size);
-     }
+     { size += ((BITMAP_HN *) theValue)->size; }
    else if (type == EXTERNAL_ADDRESS)
      {       
       theAddress = (struct externalAddressHashNode *) theValue;
@@ -1129,40 +1016,67 @@ static void RemoveHashNode(
 /* AddEphemeralHashNode: Adds a symbol, integer, float, or */
 /*   bit map table entry to the list of ephemeral atomic   */
 /*   values. These entries have a zero count indicating    */
-/*   that no structure is using the data value.            */
+/*   that no structure is using the data value. A thread   */
+/*   sharing the atom tables adds the entry to its own     */
+/*   list, which is handed over when it leaves the tables. */
 /***********************************************************/
 static void AddEphemeralHashNode(
   void *theEnv,
   EXEC_STATUS,
   GENERIC_HN *theHashNode,
-  struct ephemeron **theEphemeralList,
+  int type,
   int hashNodeSize,
   int averageContentsSize)
   {
-   struct ephemeron *temp;
-
-   /*===========================================*/
-   /* If the count isn't zero then this routine */
-   /* should never have been called.            */
-   /*===========================================*/
-
-   if (theHashNode->count != 0)
-     {
-      SystemError(theEnv,execStatus,"SYMBOL",12);
-      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
-     }
-
-   /*=====================================*/
-   /* Mark the atomic value as ephemeral. */
-   /*=====================================*/
-
-   theHashNode->markedEphemeral = TRUE;
+   struct ephemeron *temp, **theEphemeralList;
+   struct threadEphemerons *theThreadEphemerons;
+
+   /*=====================================================*/
+   /* Mark the atomic value as ephemeral. If it's already */
+   /* marked, it's on the list of this or another thread, */
+   /* and must not be added to a second list (even if two */
+   /* threads released their last references at once).    */
+   /*=====================================================*/
+
+   if (theHashNode->markedEphemeral ||
+       (apr_atomic_cas32(&theHashNode->markedEphemeral,TRUE,FALSE) != FALSE))
+     { return; }
 
    /*=============================*/
    /* Add the atomic value to the */
    /* list of ephemeral values.   */
    /*=============================*/
 
+   theThreadEphemerons = execStatus->Ephemerons;
+
+   switch (type)
+     {
+      case SYMBOL:
+        theEphemeralList = (theThreadEphemerons != NULL) ? &theThreadEphemerons->symbolList :
+                                                           &SymbolData(theEnv,execStatus)->EphemeralSymbols.nursery;
+        break;
+
+      case FLOAT:
+        theEphemeralList = (theThreadEphemerons != NULL) ? &theThreadEphemerons->floatList :
+                                                           &SymbolData(theEnv,execStatus)->EphemeralFloats.nursery;
+        break;
+
+      case INTEGER:
+        theEphemeralList = (theThreadEphemerons != NULL) ? &theThreadEphemerons->integerList :
+                                                           &SymbolData(theEnv,execStatus)->EphemeralIntegers.nursery;
+        break;
+
+      case BITMAPARRAY:
+        theEphemeralList = (theThreadEphemerons != NULL) ? &theThreadEphemerons->bitMapList :
+                                                           &SymbolData(theEnv,execStatus)->EphemeralBitMaps.nursery;
+        break;
+
+      default:
+        theEphemeralList = (theThreadEphemerons != NULL) ? &theThreadEphemerons->externalAddressList :
+                                                           &SymbolData(theEnv,execStatus)->EphemeralExternalAddresses.nursery;
+        break;
+     }
+
    temp = get_struct(theEnv,execStatus,ephemeron);
    temp->associatedValue = theHashNode;
    temp->next = *theEphemeralList;
@@ -1174,80 +1088,296 @@ static void AddEphemeralHashNode(
    /* to determine when garbage collection should occur.      */
    /*=========================================================*/
 
-   UtilityData(theEnv,execStatus)->EphemeralItemCount++;
-   UtilityData(theEnv,execStatus)->EphemeralItemSize += sizeof(struct ephemeron) + hashNodeSize +
-                        averageContentsSize;
+   if (theThreadEphemerons != NULL)
+     {
+      theThreadEphemerons->itemCount++;
+      theThreadEphemerons->itemSize += sizeof(struct ephemeron) + hashNodeSize +
+                                       averageContentsSize;
+     }
+   else
+     {
+      UtilityData(theEnv,execStatus)->EphemeralItemCount++;
+      UtilityData(theEnv,execStatus)->EphemeralItemSize += sizeof(struct ephemeron) + hashNodeSize +
+                           averageContentsSize;
+     }
   }
 
-/***************************************************/
-/* RemoveEphemeralAtoms: Causes the removal of all */
-/*   ephemeral symbols, integers, floats, and bit  */
-/*   maps that still have a count value of zero,   */
-/*   from their respective storage tables.         */
-/***************************************************/
-globle void RemoveEphemeralAtoms(
+/*************************************************************/
+/* RemoveEphemeralAtoms: Causes the removal of ephemeral     */
+/*   symbols, integers, floats, and bit maps that still have */
+/*   a count value of zero from their respective storage     */
+/*   tables. A garbage collection cycle starts by taking the */
+/*   nurseries over as the values to scan. When the garbage  */
+/*   collection is bounded, the scan may be continued by     */
+/*   later calls. Returns TRUE if the values of the cycle    */
+/*   have all been scanned.                                  */
+/*************************************************************/
+globle intBool RemoveEphemeralAtoms(
   void *theEnv,
   EXEC_STATUS)
   {
-   RemoveEphemeralHashNodes(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralSymbolList,(GENERIC_HN **) SymbolData(theEnv,execStatus)->SymbolTable,
-                            sizeof(SYMBOL_HN),SYMBOL,AVERAGE_STRING_SIZE);
-   RemoveEphemeralHashNodes(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralFloatList,(GENERIC_HN **) SymbolData(theEnv,execStatus)->FloatTable,
-                            sizeof(FLOAT_HN),FLOAT,0);
-   RemoveEphemeralHashNodes(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralIntegerList,(GENERIC_HN **) SymbolData(theEnv,execStatus)->IntegerTable,
-                            sizeof(INTEGER_HN),INTEGER,0);
-   RemoveEphemeralHashNodes(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralBitMapList,(GENERIC_HN **) SymbolData(theEnv,execStatus)->BitMapTable,
-                            sizeof(BITMAP_HN),BITMAPARRAY,AVERAGE_BITMAP_SIZE);
-   RemoveEphemeralHashNodes(theEnv,execStatus,&SymbolData(theEnv,execStatus)->EphemeralExternalAddressList,(GENERIC_HN **) SymbolData(theEnv,execStatus)->ExternalAddressTable,
-                            sizeof(EXTERNAL_ADDRESS_HN),EXTERNAL_ADDRESS,0);
+   struct symbolData *theData = SymbolData(theEnv,execStatus);
+   intBool complete;
+
+   /*=====================================================*/
+   /* Entries are only removed while no other thread uses */
+   /* the atom tables (a thread using them can't take the */
+   /* lock either). Otherwise the ephemeral values are    */
+   /* left for a later garbage collection.                */
+   /*=====================================================*/
+
+   if (apr_thread_rwlock_trywrlock(theData->AtomTablesLock) != APR_SUCCESS)
+     { return(FALSE); }
+
+   MergeThreadEphemerons(theEnv,execStatus);
+
+   if (GarbageCollectionCycleStart(theEnv,execStatus))
+     {
+      StartEphemeralScan(theEnv,execStatus,&theData->EphemeralSymbols);
+      StartEphemeralScan(theEnv,execStatus,&theData->EphemeralFloats);
+      StartEphemeralScan(theEnv,execStatus,&theData->EphemeralIntegers);
+      StartEphemeralScan(theEnv,execStatus,&theData->EphemeralBitMaps);
+      StartEphemeralScan(theEnv,execStatus,&theData->EphemeralExternalAddresses);
+     }
+
+   complete = (RemoveEphemeralHashNodes(theEnv,execStatus,&theData->EphemeralSymbols,&theData->SymbolTable,
+                                        sizeof(SYMBOL_HN),SYMBOL,AVERAGE_STRING_SIZE) &&
+               RemoveEphemeralHashNodes(theEnv,execStatus,&theData->EphemeralFloats,&theData->FloatTable,
+                                        sizeof(FLOAT_HN),FLOAT,0) &&
+               RemoveEphemeralHashNodes(theEnv,execStatus,&theData->EphemeralIntegers,&theData->IntegerTable,
+                                        sizeof(INTEGER_HN),INTEGER,0) &&
+               RemoveEphemeralHashNodes(theEnv,execStatus,&theData->EphemeralBitMaps,&theData->BitMapTable,
+                                        sizeof(BITMAP_HN),BITMAPARRAY,AVERAGE_BITMAP_SIZE) &&
+               RemoveEphemeralHashNodes(theEnv,execStatus,&theData->EphemeralExternalAddresses,
+                                        &theData->ExternalAddressTable,
+                                        sizeof(EXTERNAL_ADDRESS_HN),EXTERNAL_ADDRESS,0));
+
+   /*=================================================*/
+   /* No thread can still be searching the slots left */
+   /* behind when a table was grown.                  */
+   /*=================================================*/
+
+   ReturnRetiredAtomSlots(theEnv,execStatus,&theData->SymbolTable);
+   ReturnRetiredAtomSlots(theEnv,execStatus,&theData->FloatTable);
+   ReturnRetiredAtomSlots(theEnv,execStatus,&theData->IntegerTable);
+   ReturnRetiredAtomSlots(theEnv,execStatus,&theData->BitMapTable);
+   ReturnRetiredAtomSlots(theEnv,execStatus,&theData->ExternalAddressTable);
+
+   apr_thread_rwlock_unlock(theData->AtomTablesLock);
+
+   return(complete);
   }
 
-/****************************************************************/
-/* RemoveEphemeralHashNodes: Removes symbols from the ephemeral */
-/*   symbol list that have a count of zero and were placed on   */
-/*   the list at a higher level than the current evaluation     */
-/*   depth. Since symbols are ordered in the list in descending */
-/*   order, the removal process can end when a depth is reached */
-/*   less than the current evaluation depth. Because ephemeral  */
-/*   symbols can be "pulled" up through an evaluation depth,    */
-/*   this routine needs to check through both the previous and  */
-/*   current evaluation depth.                                  */
-/****************************************************************/
-static void RemoveEphemeralHashNodes(
+/**************************************************************/
+/* StartEphemeralScan: Adds the nursery of ephemeral values   */
+/*   to the values scanned by the garbage collection. So are  */
+/*   the tenured values if the evaluation depth has dropped   */
+/*   below the deepest of them, since some of them may now be */
+/*   removed.                                                 */
+/**************************************************************/
+static void StartEphemeralScan(
   void *theEnv,
   EXEC_STATUS,
-  struct ephemeron **theEphemeralList,
-  GENERIC_HN **theTable,
-  int hashNodeSize,
-  int hashNodeType,
-  int averageContentsSize)
+  struct ephemeralAtoms *theAtoms)
   {
-   struct ephemeron *edPtr, *lastPtr = NULL, *nextPtr;
+   theAtoms->scan = AppendEphemerons(theAtoms->nursery,theAtoms->scan);
+   theAtoms->nursery = NULL;
 
-   edPtr = *theEphemeralList;
+   if ((theAtoms->tenured != NULL) &&
+       (theAtoms->tenuredDepth > execStatus->CurrentEvaluationDepth))
+     {
+      theAtoms->scan = AppendEphemerons(theAtoms->tenured,theAtoms->scan);
+      theAtoms->tenured = NULL;
+     }
+  }
 
-   while (edPtr != NULL)
+/******************************************************************/
+/* EnterAtomTables: Called by a thread other than the one running */
+/*   the environment before it adds or releases atomic values.    */
+/*   Until the thread leaves the tables again, no entries are     */
+/*   removed from them, and the values it leaves without          */
+/*   references are kept on a list of its own. Calls may be       */
+/*   nested.                                                      */
+/******************************************************************/
+globle void EnterAtomTables(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct threadEphemerons *theBlock;
+
+   if (execStatus->Ephemerons != NULL)
      {
-      /*======================================================*/
-      /* Check through previous and current evaluation depth  */
-      /* because these symbols can be interspersed, otherwise */
-      /* symbols are stored in descending evaluation depth.   */
-      /*======================================================*/
+      execStatus->Ephemerons->nesting++;
+      return;
+     }
 
-      nextPtr = edPtr->next;
+   apr_thread_rwlock_rdlock(SymbolData(theEnv,execStatus)->AtomTablesLock);
 
-      /*==================================================*/
-      /* Remove any symbols that have a count of zero and */
-      /* were added to the ephemeral list at a higher     */
-      /* evaluation depth.                                */
-      /*==================================================*/
+   theBlock = get_struct(theEnv,execStatus,threadEphemerons);
+   memset(theBlock,0,sizeof(struct threadEphemerons));
+   theBlock->nesting = 1;
 
-      if ((edPtr->associatedValue->count == 0) &&
-          (edPtr->associatedValue->depth > execStatus->CurrentEvaluationDepth))
+   execStatus->Ephemerons = theBlock;
+  }
+
+/***************************************************************/
+/* LeaveAtomTables: Hands the values a thread left without     */
+/*   references over to the environment, where they are merged */
+/*   into the ephemeral lists by the next garbage collection,  */
+/*   and allows entries to be removed from the tables again.   */
+/***************************************************************/
+globle void LeaveAtomTables(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct symbolData *theData = SymbolData(theEnv,execStatus);
+   struct threadEphemerons *theBlock = execStatus->Ephemerons;
+
+   if (theBlock == NULL) return;
+
+   if (--theBlock->nesting > 0) return;
+
+   execStatus->Ephemerons = NULL;
+
+   if (theBlock->itemCount == 0)
+     { rtn_struct(theEnv,execStatus,threadEphemerons,theBlock); }
+   else
+     {
+      do
+        { theBlock->next = theData->HandedOverEphemerons; }
+      while (apr_atomic_casptr((volatile void **) &theData->HandedOverEphemerons,
+                               theBlock,theBlock->next) != theBlock->next);
+     }
+
+   apr_thread_rwlock_unlock(theData->AtomTablesLock);
+  }
+
+/***************************************************************/
+/* MergeThreadEphemerons: Adds the values handed over by other */
+/*   threads to the ephemeral lists of the environment.        */
+/***************************************************************/
+static void MergeThreadEphemerons(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct symbolData *theData = SymbolData(theEnv,execStatus);
+   struct threadEphemerons *theBlock, *nextBlock;
+
+   theBlock = (struct threadEphemerons *)
+              apr_atomic_xchgptr((volatile void **) &theData->HandedOverEphemerons,NULL);
+
+   for (; theBlock != NULL; theBlock = nextBlock)
+     {
+      nextBlock = theBlock->next;
+
+      theData->EphemeralSymbols.nursery = AppendEphemerons(theBlock->symbolList,theData->EphemeralSymbols.nursery);
+      theData->EphemeralFloats.nursery = AppendEphemerons(theBlock->floatList,theData->EphemeralFloats.nursery);
+      theData->EphemeralIntegers.nursery = AppendEphemerons(theBlock->integerList,theData->EphemeralIntegers.nursery);
+      theData->EphemeralBitMaps.nursery = AppendEphemerons(theBlock->bitMapList,theData->EphemeralBitMaps.nursery);
+      theData->EphemeralExternalAddresses.nursery = AppendEphemerons(theBlock->externalAddressList,
+                                                                     theData->EphemeralExternalAddresses.nursery);
+
+      UtilityData(theEnv,execStatus)->EphemeralItemCount += theBlock->itemCount;
+      UtilityData(theEnv,execStatus)->EphemeralItemSize += theBlock->itemSize;
+
+      rtn_struct(theEnv,execStatus,threadEphemerons,theBlock);
+     }
+  }
+
+/**********************************************************/
+/* AppendEphemerons: Appends the second list of ephemeral */
+/*   values to the first and returns the combined list.   */
+/**********************************************************/
+static struct ephemeron *AppendEphemerons(
+  struct ephemeron *theList,
+  struct ephemeron *theTail)
+  {
+   struct ephemeron *edPtr;
+
+   if (theList == NULL) return(theTail);
+   if (theTail == NULL) return(theList);
+
+   for (edPtr = theList; edPtr->next != NULL; edPtr = edPtr->next)
+     { /* Do Nothing */ }
+
+   edPtr->next = theTail;
+
+   return(theList);
+  }
+
+/*************************************************************/
+/* ReturnEphemeralAtoms: Returns the ephemeral value records */
+/*   of all generations of one type of atom.                 */
+/*************************************************************/
+static void ReturnEphemeralAtoms(
+  void *theEnv,
+  EXEC_STATUS,
+  struct ephemeralAtoms *theAtoms)
+  {
+   ReturnEphemerons(theEnv,execStatus,theAtoms->nursery);
+   ReturnEphemerons(theEnv,execStatus,theAtoms->scan);
+   ReturnEphemerons(theEnv,execStatus,theAtoms->tenured);
+  }
+
+/*****************************************************/
+/* ReturnEphemerons: Returns a list of ephemeral     */
+/*   value records (but not the values themselves).  */
+/*****************************************************/
+static void ReturnEphemerons(
+  void *theEnv,
+  EXEC_STATUS,
+  struct ephemeron *edPtr)
+  {
+   struct ephemeron *nextEDPtr;
+
+   while (edPtr != NULL)
+     {
+      nextEDPtr = edPtr->next;
+      rtn_struct(theEnv,execStatus,ephemeron,edPtr);
+      edPtr = nextEDPtr;
+     }
+  }
+
+/****************************************************************/
+/* RemoveEphemeralHashNodes: Scans the ephemeral values of one  */
+/*   type of atom taken over by the garbage collection cycle.   */
+/*   Values with a count of zero which were created at a higher */
+/*   level than the current evaluation depth are removed from   */
+/*   their table. Values in use again are no longer ephemeral.  */
+/*   The others are tenured. Returns FALSE if the budget of the */
+/*   garbage collection ran out before the scan was completed.  */
+/****************************************************************/
+static intBool RemoveEphemeralHashNodes(
+  void *theEnv,
+  EXEC_STATUS,
+  struct ephemeralAtoms *theAtoms,
+  struct atomTable *theTable,
+  int hashNodeSize,
+  int hashNodeType,
+  int averageContentsSize)
+  {
+   struct ephemeron *edPtr;
+   GENERIC_HN *theValue;
+
+   while ((edPtr = theAtoms->scan) != NULL)
+     {
+      if (! GarbageCollectionBudgetLeft(theEnv,execStatus))
+        { return(FALSE); }
+
+      theAtoms->scan = edPtr->next;
+      theValue = edPtr->associatedValue;
+
+      /*==================================================*/
+      /* Remove any symbols that have a count of zero and */
+      /* were added to the ephemeral list at a higher     */
+      /* evaluation depth.                                */
+      /*==================================================*/
+
+      if ((theValue->count == 0) &&
+          (theValue->depth > execStatus->CurrentEvaluationDepth))
         {
-         RemoveHashNode(theEnv,execStatus,edPtr->associatedValue,theTable,hashNodeSize,hashNodeType);
+         RemoveHashNode(theEnv,execStatus,theValue,theTable,hashNodeSize,hashNodeType);
          rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-         if (lastPtr == NULL) *theEphemeralList = nextPtr;
-         else lastPtr->next = nextPtr;
          UtilityData(theEnv,execStatus)->EphemeralItemCount--;
          UtilityData(theEnv,execStatus)->EphemeralItemSize -= sizeof(struct ephemeron) + hashNodeSize +
                               averageContentsSize;
@@ -1258,28 +1388,34 @@ static void RemoveEphemeralHashNodes(
       /* with a count greater than zero.       */
       /*=======================================*/
 
-      else if (edPtr->associatedValue->count > 0)
+      else if (theValue->count > 0)
         {
-         edPtr->associatedValue->markedEphemeral = FALSE;
+         theValue->markedEphemeral = FALSE;
 
          rtn_struct(theEnv,execStatus,ephemeron,edPtr);
-
-         if (lastPtr == NULL) *theEphemeralList = nextPtr;
-         else lastPtr->next = nextPtr;
          UtilityData(theEnv,execStatus)->EphemeralItemCount--;
          UtilityData(theEnv,execStatus)->EphemeralItemSize -= sizeof(struct ephemeron) + hashNodeSize +
                               averageContentsSize;
         }
 
-      /*==================================================*/
-      /* Otherwise keep the symbol in the ephemeral list. */
-      /*==================================================*/
+      /*================================================*/
+      /* Otherwise the symbol can't be removed until    */
+      /* the evaluation depth drops below the one it    */
+      /* was created at, so it's not scanned again till */
+      /* then.                                          */
+      /*================================================*/
 
       else
-        { lastPtr = edPtr; }
+        {
+         if ((theAtoms->tenured == NULL) || (theValue->depth > theAtoms->tenuredDepth))
+           { theAtoms->tenuredDepth = theValue->depth; }
 
-      edPtr = nextPtr;
+         edPtr->next = theAtoms->tenured;
+         theAtoms->tenured = edPtr;
+        }
      }
+
+   return(TRUE);
   }
 
 /*********************************************************/
@@ -1289,18 +1425,31 @@ globle SYMBOL_HN **GetSymbolTable(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(SymbolData(theEnv,execStatus)->SymbolTable);
+   return((SYMBOL_HN **) SymbolData(theEnv,execStatus)->SymbolTable.slots->entries);
   }
 
-/******************************************************/
-/* SetSymbolTable: Sets the value of the SymbolTable. */
-/******************************************************/
+/****************************************************/
+/* GetSymbolTableSize: Returns the number of slots  */
+/*   of the SymbolTable, some of which are empty.   */
+/****************************************************/
+globle unsigned long GetSymbolTableSize(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(SymbolData(theEnv,execStatus)->SymbolTable.slots->size);
+  }
+
+/*******************************************************/
+/* SetSymbolTable: Replaces the SymbolTable with one   */
+/*   holding the symbols of a NULL terminated list.    */
+/*******************************************************/
 globle void SetSymbolTable(
   void *theEnv,
   EXEC_STATUS,
   SYMBOL_HN **value)
   {
-   SymbolData(theEnv,execStatus)->SymbolTable = value;
+   LoadAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->SymbolTable,
+                 INITIAL_SYMBOL_TABLE_SIZE,(GENERIC_HN **) value,SYMBOL);
   }
 
 /*******************************************************/
@@ -1310,18 +1459,31 @@ globle FLOAT_HN **GetFloatTable(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(SymbolData(theEnv,execStatus)->FloatTable);
+   return((FLOAT_HN **) SymbolData(theEnv,execStatus)->FloatTable.slots->entries);
+  }
+
+/**************************************************/
+/* GetFloatTableSize: Returns the number of slots */
+/*   of the FloatTable, some of which are empty.  */
+/**************************************************/
+globle unsigned long GetFloatTableSize(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(SymbolData(theEnv,execStatus)->FloatTable.slots->size);
   }
 
 /****************************************************/
-/* SetFloatTable: Sets the value of the FloatTable. */
+/* SetFloatTable: Replaces the FloatTable with one  */
+/*   holding the floats of a NULL terminated list.  */
 /****************************************************/
 globle void SetFloatTable(
   void *theEnv,
   EXEC_STATUS,
   FLOAT_HN **value)
   {
-   SymbolData(theEnv,execStatus)->FloatTable = value;
+   LoadAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->FloatTable,
+                 INITIAL_ATOM_TABLE_SIZE,(GENERIC_HN **) value,FLOAT);
   }
 
 /***********************************************************/
@@ -1331,18 +1493,31 @@ globle INTEGER_HN **GetIntegerTable(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(SymbolData(theEnv,execStatus)->IntegerTable);
+   return((INTEGER_HN **) SymbolData(theEnv,execStatus)->IntegerTable.slots->entries);
+  }
+
+/****************************************************/
+/* GetIntegerTableSize: Returns the number of slots */
+/*   of the IntegerTable, some of which are empty.  */
+/****************************************************/
+globle unsigned long GetIntegerTableSize(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(SymbolData(theEnv,execStatus)->IntegerTable.slots->size);
   }
 
 /********************************************************/
-/* SetIntegerTable: Sets the value of the IntegerTable. */
+/* SetIntegerTable: Replaces the IntegerTable with one  */
+/*   holding the integers of a NULL terminated list.    */
 /********************************************************/
 globle void SetIntegerTable(
   void *theEnv,
   EXEC_STATUS,
   INTEGER_HN **value)
   {
-   SymbolData(theEnv,execStatus)->IntegerTable = value;
+   LoadAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->IntegerTable,
+                 INITIAL_ATOM_TABLE_SIZE,(GENERIC_HN **) value,INTEGER);
   }
 
 /*********************************************************/
@@ -1352,18 +1527,31 @@ globle BITMAP_HN **GetBitMapTable(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(SymbolData(theEnv,execStatus)->BitMapTable);
+   return((BITMAP_HN **) SymbolData(theEnv,execStatus)->BitMapTable.slots->entries);
+  }
+
+/***************************************************/
+/* GetBitMapTableSize: Returns the number of slots */
+/*   of the BitMapTable, some of which are empty.  */
+/***************************************************/
+globle unsigned long GetBitMapTableSize(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(SymbolData(theEnv,execStatus)->BitMapTable.slots->size);
   }
 
 /******************************************************/
-/* SetBitMapTable: Sets the value of the BitMapTable. */
+/* SetBitMapTable: Replaces the BitMapTable with one  */
+/*   holding the bitmaps of a NULL terminated list.   */
 /******************************************************/
 globle void SetBitMapTable(
   void *theEnv,
   EXEC_STATUS,
   BITMAP_HN **value)
   {
-   SymbolData(theEnv,execStatus)->BitMapTable = value;
+   LoadAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->BitMapTable,
+                 INITIAL_ATOM_TABLE_SIZE,(GENERIC_HN **) value,BITMAPARRAY);
   }
 
 /***************************************************************************/
@@ -1373,18 +1561,488 @@ globle EXTERNAL_ADDRESS_HN **GetExternalAddressTable(
   void *theEnv,
   EXEC_STATUS)
   {
-   return(SymbolData(theEnv,execStatus)->ExternalAddressTable);
+   return((EXTERNAL_ADDRESS_HN **) SymbolData(theEnv,execStatus)->ExternalAddressTable.slots->entries);
   }
 
-/************************************************************************/
-/* SetExternalAddressTable: Sets the value of the ExternalAddressTable. */
-/************************************************************************/
+/*************************************************************/
+/* GetExternalAddressTableSize: Returns the number of slots  */
+/*   of the ExternalAddressTable, some of which are empty.   */
+/*************************************************************/
+globle unsigned long GetExternalAddressTableSize(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(SymbolData(theEnv,execStatus)->ExternalAddressTable.slots->size);
+  }
+
+/****************************************************************/
+/* SetExternalAddressTable: Replaces the ExternalAddressTable   */
+/*   with one holding the addresses of a NULL terminated list.  */
+/****************************************************************/
 globle void SetExternalAddressTable(
   void *theEnv,
   EXEC_STATUS,
   EXTERNAL_ADDRESS_HN **value)
   {
-   SymbolData(theEnv,execStatus)->ExternalAddressTable = value;
+   LoadAtomTable(theEnv,execStatus,&SymbolData(theEnv,execStatus)->ExternalAddressTable,
+                 INITIAL_ATOM_TABLE_SIZE,(GENERIC_HN **) value,EXTERNAL_ADDRESS);
+  }
+
+/**********************************************************/
+/* CreateAtomTable: Creates the lock and the slots of an  */
+/*   empty atom table. The size must be a power of two.   */
+/**********************************************************/
+static void CreateAtomTable(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable,
+  unsigned long size)
+  {
+   if (apr_thread_mutex_create(&theTable->lock,APR_THREAD_MUTEX_DEFAULT,
+                               Env(theEnv,execStatus)->memoryPool) != APR_SUCCESS)
+     {
+      SystemError(theEnv,execStatus,"SYMBOL",18);
+      EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+     }
+
+   theTable->slots = CreateAtomSlots(theEnv,execStatus,size);
+   theTable->count = 0;
+   theTable->retired = NULL;
+  }
+
+/********************************************************/
+/* CreateAtomSlots: Allocates the given number of empty */
+/*   slots. The size must be a power of two.            */
+/********************************************************/
+static struct atomSlots *CreateAtomSlots(
+  void *theEnv,
+  EXEC_STATUS,
+  unsigned long size)
+  {
+   struct atomSlots *theSlots;
+   unsigned long bits;
+
+   theSlots = get_struct(theEnv,execStatus,atomSlots);
+   theSlots->entries = (GENERIC_HN * volatile *) gm3(theEnv,execStatus,sizeof(GENERIC_HN *) * size);
+   theSlots->tags = (volatile apr_uint32_t *) gm3(theEnv,execStatus,sizeof(apr_uint32_t) * size);
+   memset((void *) theSlots->entries,0,sizeof(GENERIC_HN *) * size);
+   memset((void *) theSlots->tags,0,sizeof(apr_uint32_t) * size);
+
+   for (bits = 0; (1UL << bits) < size; bits++)
+     { /* Do Nothing */ }
+
+   theSlots->size = size;
+   theSlots->shift = (unsigned int) (32 - bits);
+   theSlots->nextRetired = NULL;
+
+   return(theSlots);
+  }
+
+/*****************************************************/
+/* ReturnAtomSlots: Deallocates the slots of a table */
+/*   (but not the entries stored in them).           */
+/*****************************************************/
+static void ReturnAtomSlots(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomSlots *theSlots)
+  {
+   rm3(theEnv,execStatus,(void *) theSlots->entries,sizeof(GENERIC_HN *) * theSlots->size);
+   rm3(theEnv,execStatus,(void *) theSlots->tags,sizeof(apr_uint32_t) * theSlots->size);
+   rtn_struct(theEnv,execStatus,atomSlots,theSlots);
+  }
+
+/**********************************************************/
+/* ReturnRetiredAtomSlots: Deallocates the slots an atom  */
+/*   table used before it was grown. May only be called   */
+/*   when no other thread can be searching the table.     */
+/**********************************************************/
+static void ReturnRetiredAtomSlots(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable)
+  {
+   struct atomSlots *theSlots;
+
+   while (theTable->retired != NULL)
+     {
+      theSlots = theTable->retired;
+      theTable->retired = theSlots->nextRetired;
+      ReturnAtomSlots(theEnv,execStatus,theSlots);
+     }
+  }
+
+/*******************************************************/
+/* ReturnAtomTable: Deallocates the slots of an atom   */
+/*   table (but not the entries stored in the table).  */
+/*******************************************************/
+static void ReturnAtomTable(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable)
+  {
+   ReturnRetiredAtomSlots(theEnv,execStatus,theTable);
+
+   if (theTable->slots == NULL) return;
+
+   ReturnAtomSlots(theEnv,execStatus,theTable->slots);
+   theTable->slots = NULL;
+   theTable->count = 0;
+  }
+
+/******************************************************/
+/* LoadAtomTable: Replaces the slots of an atom table */
+/*   with ones holding the entries of a NULL          */
+/*   terminated list.                                 */
+/******************************************************/
+static void LoadAtomTable(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable,
+  unsigned long size,
+  GENERIC_HN **theList,
+  int type)
+  {
+   ReturnAtomTable(theEnv,execStatus,theTable);
+   theTable->slots = CreateAtomSlots(theEnv,execStatus,size);
+
+   if (theList == NULL) return;
+
+   for (; *theList != NULL; theList++)
+     { AddAtomTableEntry(theEnv,execStatus,theTable,*theList,AtomTag(AtomHashValue(*theList,type))); }
+  }
+
+/*********************************************************/
+/* AtomTag: Returns the tag stored in the slot of a hash */
+/*   value. The high bit is set so that the tag of an    */
+/*   occupied slot is never zero.                        */
+/*********************************************************/
+static unsigned int AtomTag(
+  unsigned long hashValue)
+  {
+   return((unsigned int) (hashValue & 0x7FFFFFFFUL) | 0x80000000U);
+  }
+
+/************************************************************/
+/* AtomSlot: Returns the first slot probed for a tag. The   */
+/*   tag is multiplied by the golden ratio so that values   */
+/*   whose hash values only differ in their high bits, or   */
+/*   which are regularly spaced, are spread over the table. */
+/************************************************************/
+static unsigned long AtomSlot(
+  struct atomSlots *theSlots,
+  unsigned int tag)
+  {
+   return((unsigned long) ((unsigned int) (tag * 2654435769U) >> theSlots->shift));
+  }
+
+/*********************************************************/
+/* EmptyAtomSlot: Returns the first empty slot probed    */
+/*   for a tag.                                          */
+/*********************************************************/
+static unsigned long EmptyAtomSlot(
+  struct atomSlots *theSlots,
+  unsigned int tag)
+  {
+   unsigned long slot;
+
+   for (slot = AtomSlot(theSlots,tag);
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & (theSlots->size - 1))
+     { /* Do Nothing */ }
+
+   return(slot);
+  }
+
+/**************************************************************/
+/* AtomHashValue: Returns the hash value of an entry of the   */
+/*   table for the given type of atomic value. The hash value */
+/*   of a symbol is stored with it.                           */
+/**************************************************************/
+static unsigned long AtomHashValue(
+  GENERIC_HN *theValue,
+  int type)
+  {
+   switch (type)
+     {
+      case SYMBOL:
+        return(((SYMBOL_HN *) theValue)->hashValue);
+
+      case FLOAT:
+        return(HashFloat(((FLOAT_HN *) theValue)->contents,0));
+
+      case INTEGER:
+        return(HashInteger(((INTEGER_HN *) theValue)->contents,0));
+
+      case BITMAPARRAY:
+        return(HashBitMap(((BITMAP_HN *) theValue)->contents,0,((BITMAP_HN *) theValue)->size));
+
+      case EXTERNAL_ADDRESS:
+        return(HashExternalAddress(((EXTERNAL_ADDRESS_HN *) theValue)->externalAddress,0));
+     }
+
+   return(0);
+  }
+
+/************************************************************/
+/* FindSymbolEntry: Searches the slots probed for a tag for */
+/*   the symbol with the given string. Only the entries     */
+/*   with the same tag and length are compared with the     */
+/*   string. A slot whose tag is set while its entry isn't  */
+/*   yet visible belongs to an entry still being added.     */
+/************************************************************/
+static SYMBOL_HN *FindSymbolEntry(
+  struct atomSlots *theSlots,
+  char *str,
+  size_t length,
+  unsigned int tag)
+  {
+   unsigned long slot;
+   SYMBOL_HN *peek;
+
+   for (slot = AtomSlot(theSlots,tag);
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & (theSlots->size - 1))
+     {
+      if (theSlots->tags[slot] != tag) continue;
+
+      peek = (SYMBOL_HN *) theSlots->entries[slot];
+      if ((peek != NULL) &&
+          (peek->length == length) &&
+          (memcmp(str,peek->contents,length) == 0))
+        { return(peek); }
+     }
+
+   return(NULL);
+  }
+
+/*******************************************************/
+/* FindFloatEntry: Searches the slots probed for a tag */
+/*   for the float with the given value.               */
+/*******************************************************/
+static FLOAT_HN *FindFloatEntry(
+  struct atomSlots *theSlots,
+  double number,
+  unsigned int tag)
+  {
+   unsigned long slot;
+   FLOAT_HN *peek;
+
+   for (slot = AtomSlot(theSlots,tag);
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & (theSlots->size - 1))
+     {
+      if (theSlots->tags[slot] != tag) continue;
+
+      peek = (FLOAT_HN *) theSlots->entries[slot];
+      if ((peek != NULL) && (peek->contents == number))
+        { return(peek); }
+     }
+
+   return(NULL);
+  }
+
+/*********************************************************/
+/* FindIntegerEntry: Searches the slots probed for a tag */
+/*   for the integer with the given value.               */
+/*********************************************************/
+static INTEGER_HN *FindIntegerEntry(
+  struct atomSlots *theSlots,
+  long long number,
+  unsigned int tag)
+  {
+   unsigned long slot;
+   INTEGER_HN *peek;
+
+   for (slot = AtomSlot(theSlots,tag);
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & (theSlots->size - 1))
+     {
+      if (theSlots->tags[slot] != tag) continue;
+
+      peek = (INTEGER_HN *) theSlots->entries[slot];
+      if ((peek != NULL) && (peek->contents == number))
+        { return(peek); }
+     }
+
+   return(NULL);
+  }
+
+/********************************************************/
+/* FindBitMapEntry: Searches the slots probed for a tag */
+/*   for the bitmap with the given contents.            */
+/********************************************************/
+static BITMAP_HN *FindBitMapEntry(
+  struct atomSlots *theSlots,
+  char *theBitMap,
+  unsigned size,
+  unsigned int tag)
+  {
+   unsigned long slot;
+   BITMAP_HN *peek;
+
+   for (slot = AtomSlot(theSlots,tag);
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & (theSlots->size - 1))
+     {
+      if (theSlots->tags[slot] != tag) continue;
+
+      peek = (BITMAP_HN *) theSlots->entries[slot];
+      if ((peek != NULL) &&
+          (peek->size == (unsigned short) size) &&
+          (memcmp(peek->contents,theBitMap,size) == 0))
+        { return(peek); }
+     }
+
+   return(NULL);
+  }
+
+/*****************************************************************/
+/* FindExternalAddressEntry: Searches the slots probed for a tag */
+/*   for the external address with the given address and type.   */
+/*****************************************************************/
+static EXTERNAL_ADDRESS_HN *FindExternalAddressEntry(
+  struct atomSlots *theSlots,
+  void *theExternalAddress,
+  unsigned theType,
+  unsigned int tag)
+  {
+   unsigned long slot;
+   EXTERNAL_ADDRESS_HN *peek;
+
+   for (slot = AtomSlot(theSlots,tag);
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & (theSlots->size - 1))
+     {
+      if (theSlots->tags[slot] != tag) continue;
+
+      peek = (EXTERNAL_ADDRESS_HN *) theSlots->entries[slot];
+      if ((peek != NULL) &&
+          (peek->type == (unsigned short) theType) &&
+          (peek->externalAddress == theExternalAddress))
+        { return(peek); }
+     }
+
+   return(NULL);
+  }
+
+/**************************************************************/
+/* AddAtomTableEntry: Stores an entry in the first empty slot */
+/*   probed for its tag. If the table would become more than  */
+/*   three quarters full, its size is doubled first. The      */
+/*   entry is stored before the tag, so that a thread which   */
+/*   finds the tag also finds the completed entry (or none).  */
+/*   Must be called while holding the lock of the table.      */
+/**************************************************************/
+static void AddAtomTableEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable,
+  GENERIC_HN *theEntry,
+  unsigned int tag)
+  {
+   struct atomSlots *theSlots;
+   unsigned long slot;
+
+   if (((theTable->count + 1) * 4) > (theTable->slots->size * 3))
+     { GrowAtomTable(theEnv,execStatus,theTable); }
+
+   theSlots = theTable->slots;
+   slot = EmptyAtomSlot(theSlots,tag);
+
+   apr_atomic_casptr((volatile void **) &theSlots->entries[slot],theEntry,NULL);
+   apr_atomic_set32(&theSlots->tags[slot],tag);
+   theTable->count++;
+  }
+
+/**************************************************************/
+/* GrowAtomTable: Doubles the size of an atom table. Since    */
+/*   the first slot probed for an entry only depends on its   */
+/*   tag, the entries are moved without being examined. The   */
+/*   new slots are filled before they replace the old ones,   */
+/*   which are kept for the threads still searching them.     */
+/**************************************************************/
+static void GrowAtomTable(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable)
+  {
+   struct atomSlots *oldSlots, *newSlots;
+   unsigned long i, slot;
+
+   oldSlots = theTable->slots;
+   newSlots = CreateAtomSlots(theEnv,execStatus,oldSlots->size * 2);
+
+   for (i = 0; i < oldSlots->size; i++)
+     {
+      if (oldSlots->tags[i] == 0) continue;
+
+      slot = EmptyAtomSlot(newSlots,oldSlots->tags[i]);
+      newSlots->entries[slot] = oldSlots->entries[i];
+      newSlots->tags[slot] = oldSlots->tags[i];
+     }
+
+   apr_atomic_casptr((volatile void **) &theTable->slots,newSlots,oldSlots);
+
+   oldSlots->nextRetired = theTable->retired;
+   theTable->retired = oldSlots;
+  }
+
+/****************************************************************/
+/* RemoveAtomTableEntry: Removes an entry from an atom table.   */
+/*   The entries probed after it are moved back to fill the     */
+/*   emptied slot whenever their first probed slot allows it,   */
+/*   so that no probe sequence is ever broken by an empty slot. */
+/****************************************************************/
+static void RemoveAtomTableEntry(
+  void *theEnv,
+  EXEC_STATUS,
+  struct atomTable *theTable,
+  GENERIC_HN *theEntry,
+  unsigned int tag)
+  {
+   struct atomSlots *theSlots = theTable->slots;
+   unsigned long mask = theSlots->size - 1;
+   unsigned long emptied, slot, first;
+
+   /*=========================*/
+   /* Find the entry's slot.  */
+   /*=========================*/
+
+   for (emptied = AtomSlot(theSlots,tag);
+        theSlots->entries[emptied] != theEntry;
+        emptied = (emptied + 1) & mask)
+     {
+      if (theSlots->tags[emptied] == 0)
+        {
+         SystemError(theEnv,execStatus,"SYMBOL",11);
+         EnvExitRouter(theEnv,execStatus,EXIT_FAILURE);
+        }
+     }
+
+   /*===================================================*/
+   /* Move back each following entry of the same run of */
+   /* occupied slots whose first probed slot does not   */
+   /* lie between the emptied slot and its own slot.    */
+   /*===================================================*/
+
+   for (slot = (emptied + 1) & mask;
+        theSlots->tags[slot] != 0;
+        slot = (slot + 1) & mask)
+     {
+      first = AtomSlot(theSlots,theSlots->tags[slot]);
+
+      if (((slot - first) & mask) >= ((slot - emptied) & mask))
+        {
+         theSlots->entries[emptied] = theSlots->entries[slot];
+         theSlots->tags[emptied] = theSlots->tags[slot];
+         emptied = slot;
+        }
+     }
+
+   theSlots->entries[emptied] = NULL;
+   theSlots->tags[emptied] = 0;
+   theTable->count--;
   }
 
 /******************************************************/
@@ -1484,7 +2142,7 @@ globle SYMBOL_HN *GetNextSymbolMatch(
   {
    register unsigned long i;
    SYMBOL_HN *hashPtr;
-   int flag = TRUE;
+   struct atomSlots *theSlots;
    size_t prefixLength;
 
    /*==========================================*/
@@ -1500,102 +2158,93 @@ globle SYMBOL_HN *GetNextSymbolMatch(
    /* symbol table, the previous symbol argument is NULL.    */
    /*========================================================*/
 
+   theSlots = SymbolData(theEnv,execStatus)->SymbolTable.slots;
+
    if (prevSymbol == NULL)
-     {
-      i = 0;
-      hashPtr = SymbolData(theEnv,execStatus)->SymbolTable[0];
-     }
+     { i = 0; }
 
    /*==========================================*/
-   /* Otherwise start the search at the symbol */
-   /* after the last symbol found.             */
+   /* Otherwise start the search at the slot   */
+   /* after the one of the last symbol found.  */
    /*==========================================*/
 
    else
      {
-      i = prevSymbol->bucket;
-      hashPtr = prevSymbol->next;
+      for (i = AtomSlot(theSlots,AtomTag(prevSymbol->hashValue));
+           theSlots->entries[i] != (GENERIC_HN *) prevSymbol;
+           i = (i + 1) & (theSlots->size - 1))
+        { if (theSlots->tags[i] == 0) return(NULL); }
+      i++;
      }
 
-   /*==============================================*/
-   /* Search through all the symbol table buckets. */
-   /*==============================================*/
+   /*============================================*/
+   /* Search through the remaining slots of the  */
+   /* symbol table.                              */
+   /*============================================*/
 
-   while (flag)
+   for (; i < theSlots->size; i++)
      {
-      /*===================================*/
-      /* Search through all of the entries */
-      /* in the bucket being examined.     */
-      /*===================================*/
+      hashPtr = (SYMBOL_HN *) theSlots->entries[i];
+
+      /*================================================*/
+      /* Skip empty slots and symbols that being with ( */
+      /* since these are typically symbols for internal */
+      /* use. Also skip any symbols that are marked     */
+      /* ephemeral since these aren't in use.           */
+      /*================================================*/
+
+      if ((hashPtr == NULL) ||
+          (hashPtr->contents[0] == '(') ||
+          (hashPtr->markedEphemeral))
+        { continue; }
 
-      for (; hashPtr != NULL; hashPtr = hashPtr->next)
+      /*==================================================*/
+      /* Two types of matching can be performed: the type */
+      /* comparing just to the beginning of the string    */
+      /* and the type which looks for the substring       */
+      /* anywhere within the string being examined.       */
+      /*==================================================*/
+
+      if (! anywhere)
         {
-         /*================================================*/
-         /* Skip symbols that being with ( since these are */
-         /* typically symbols for internal use. Also skip  */
-         /* any symbols that are marked ephemeral since    */
-         /* these aren't in use.                           */
-         /*================================================*/
-
-         if ((hashPtr->contents[0] == '(') ||
-             (hashPtr->markedEphemeral))
-           { continue; }
-
-         /*==================================================*/
-         /* Two types of matching can be performed: the type */
-         /* comparing just to the beginning of the string    */
-         /* and the type which looks for the substring       */
-         /* anywhere within the string being examined.       */
-         /*==================================================*/
-
-         if (! anywhere)
+         /*=============================================*/
+         /* Determine the common prefix length between  */
+         /* the previously found match (if available or */
+         /* the search string if not) and the symbol    */
+         /* table entry.                                */
+         /*=============================================*/
+
+         if (prevSymbol != NULL)
+           prefixLength = CommonPrefixLength(prevSymbol->contents,hashPtr->contents);
+         else
+           prefixLength = CommonPrefixLength(searchString,hashPtr->contents);
+
+         /*===================================================*/
+         /* If the prefix length is greater than or equal to  */
+         /* the length of the search string, then we've found */
+         /* a match. If this is the first match, the common   */
+         /* prefix length is set to the length of the first   */
+         /* match, otherwise the common prefix length is the  */
+         /* smallest prefix length found among all matches.   */
+         /*===================================================*/
+
+         if (prefixLength >= searchLength)
            {
-            /*=============================================*/
-            /* Determine the common prefix length between  */
-            /* the previously found match (if available or */
-            /* the search string if not) and the symbol    */
-            /* table entry.                                */
-            /*=============================================*/
-
-            if (prevSymbol != NULL)
-              prefixLength = CommonPrefixLength(prevSymbol->contents,hashPtr->contents);
-            else
-              prefixLength = CommonPrefixLength(searchString,hashPtr->contents);
-
-            /*===================================================*/
-            /* If the prefix length is greater than or equal to  */
-            /* the length of the search string, then we've found */
-            /* a match. If this is the first match, the common   */
-            /* prefix length is set to the length of the first   */
-            /* match, otherwise the common prefix length is the  */
-            /* smallest prefix length found among all matches.   */
-            /*===================================================*/
-
-            if (prefixLength >= searchLength)
+            if (commonPrefixLength != NULL)
               {
-               if (commonPrefixLength != NULL)
-                 {
-                  if (prevSymbol == NULL)
-                    *commonPrefixLength = strlen(hashPtr->contents);
-                  else if (prefixLength < *commonPrefixLength)
-                    *commonPrefixLength = prefixLength;
-                 }
-               return(hashPtr);
+               if (prevSymbol == NULL)
+                 *commonPrefixLength = strlen(hashPtr->contents);
+               else if (prefixLength < *commonPrefixLength)
+                 *commonPrefixLength = prefixLength;
               }
-           }
-         else
-           {
-            if (StringWithinString(hashPtr->contents,searchString) != NULL)
-              { return(hashPtr); }
+            return(hashPtr);
            }
         }
-
-      /*=================================================*/
-      /* Move on to the next bucket in the symbol table. */
-      /*=================================================*/
-
-      if (++i >= SYMBOL_HASH_SIZE) flag = FALSE;
-      else hashPtr = SymbolData(theEnv,execStatus)->SymbolTable[i];
+      else
+        {
+         if (StringWithinString(hashPtr->contents,searchString) != NULL)
+           { return(hashPtr); }
+        }
      }
 
    /*=====================================*/
@@ -1640,7 +2289,7 @@ static size_t CommonPrefixLength(
    return(i);
   }
 
-#if BLOAD_AND_BSAVE || CONSTRUCT_COMPILER || BSAVE_INSTANCES
+#if BLOAD_AND_BSAVE || CONSTRUCT_COMPILER || BSAVE_INSTANCES || BSAVE_FACTS
 
 /****************************************************************/
 /* SetAtomicValueIndices: Sets the bucket values for hash table */
@@ -1654,7 +2303,7 @@ globle void SetAtomicValueIndices(
   int setAll)
   {
    unsigned long count;
-   unsigned long i;
+   unsigned long i, size;
    SYMBOL_HN *symbolPtr, **symbolArray;
    FLOAT_HN *floatPtr, **floatArray;
    INTEGER_HN *integerPtr, **integerArray;
@@ -1666,19 +2315,18 @@ globle void SetAtomicValueIndices(
 
    count = 0;
    symbolArray = GetSymbolTable(theEnv,execStatus);
+   size = GetSymbolTableSize(theEnv,execStatus);
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (symbolPtr = symbolArray[i];
-           symbolPtr != NULL;
-           symbolPtr = symbolPtr->next)
+      symbolPtr = symbolArray[i];
+      if (symbolPtr == NULL) continue;
+
+      if ((symbolPtr->neededSymbol == TRUE) || setAll)
         {
-         if ((symbolPtr->neededSymbol == TRUE) || setAll)
-           {
-            symbolPtr->bucket = count++;
-            if (symbolPtr->bucket != (count - 1))
-              { SystemError(theEnv,execStatus,"SYMBOL",13); }
-           }
+         symbolPtr->bucket = count++;
+         if (symbolPtr->bucket != (count - 1))
+           { SystemError(theEnv,execStatus,"SYMBOL",13); }
         }
      }
 
@@ -1688,19 +2336,18 @@ globle void SetAtomicValueIndices(
 
    count = 0;
    floatArray = GetFloatTable(theEnv,execStatus);
+   size = GetFloatTableSize(theEnv,execStatus);
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (floatPtr = floatArray[i];
-           floatPtr != NULL;
-           floatPtr = floatPtr->next)
+      floatPtr = floatArray[i];
+      if (floatPtr == NULL) continue;
+
+      if ((floatPtr->neededFloat == TRUE) || setAll)
         {
-         if ((floatPtr->neededFloat == TRUE) || setAll)
-           {
-            floatPtr->bucket = count++;
-            if (floatPtr->bucket != (count - 1))
-              { SystemError(theEnv,execStatus,"SYMBOL",14); }
-           }
+         floatPtr->bucket = count++;
+         if (floatPtr->bucket != (count - 1))
+           { SystemError(theEnv,execStatus,"SYMBOL",14); }
         }
      }
 
@@ -1710,19 +2357,18 @@ globle void SetAtomicValueIndices(
 
    count = 0;
    integerArray = GetIntegerTable(theEnv,execStatus);
+   size = GetIntegerTableSize(theEnv,execStatus);
 
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (integerPtr = integerArray[i];
-           integerPtr != NULL;
-           integerPtr = integerPtr->next)
+      integerPtr = integerArray[i];
+      if (integerPtr == NULL) continue;
+
+      if ((integerPtr->neededInteger == TRUE) || setAll)
         {
-         if ((integerPtr->neededInteger == TRUE) || setAll)
-           {
-            integerPtr->bucket = count++;
-            if (integerPtr->bucket != (count - 1))
-              { SystemError(theEnv,execStatus,"SYMBOL",15); }
-           }
+         integerPtr->bucket = count++;
+         if (integerPtr->bucket != (count - 1))
+           { SystemError(theEnv,execStatus,"SYMBOL",15); }
         }
      }
 
@@ -1732,19 +2378,18 @@ globle void SetAtomicValueIndices(
 
    count = 0;
    bitMapArray = GetBitMapTable(theEnv,execStatus);
+   size = GetBitMapTableSize(theEnv,execStatus);
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (bitMapPtr = bitMapArray[i];
-           bitMapPtr != NULL;
-           bitMapPtr = bitMapPtr->next)
+      bitMapPtr = bitMapArray[i];
+      if (bitMapPtr == NULL) continue;
+
+      if ((bitMapPtr->neededBitMap == TRUE) || setAll)
         {
-         if ((bitMapPtr->neededBitMap == TRUE) || setAll)
-           {
-            bitMapPtr->bucket = count++;
-            if (bitMapPtr->bucket != (count - 1))
-              { SystemError(theEnv,execStatus,"SYMBOL",16); }
-           }
+         bitMapPtr->bucket = count++;
+         if (bitMapPtr->bucket != (count - 1))
+           { SystemError(theEnv,execStatus,"SYMBOL",16); }
         }
      }
   }
@@ -1758,7 +2403,7 @@ globle void RestoreAtomicValueBuckets(
   void *theEnv,
   EXEC_STATUS)
   {
-   unsigned long i;
+   unsigned long i, size;
    SYMBOL_HN *symbolPtr, **symbolArray;
    FLOAT_HN *floatPtr, **floatArray;
    INTEGER_HN *integerPtr, **integerArray;
@@ -1769,13 +2414,13 @@ globle void RestoreAtomicValueBuckets(
    /*================================================*/
 
    symbolArray = GetSymbolTable(theEnv,execStatus);
+   size = GetSymbolTableSize(theEnv,execStatus);
 
-   for (i = 0; i < SYMBOL_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (symbolPtr = symbolArray[i];
-           symbolPtr != NULL;
-           symbolPtr = symbolPtr->next)
-        { symbolPtr->bucket = i; }
+      symbolPtr = symbolArray[i];
+      if (symbolPtr != NULL)
+        { symbolPtr->bucket = HashSymbol(symbolPtr->contents,SYMBOL_HASH_SIZE); }
      }
 
    /*===============================================*/
@@ -1783,13 +2428,13 @@ globle void RestoreAtomicValueBuckets(
    /*===============================================*/
 
    floatArray = GetFloatTable(theEnv,execStatus);
+   size = GetFloatTableSize(theEnv,execStatus);
 
-   for (i = 0; i < FLOAT_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (floatPtr = floatArray[i];
-           floatPtr != NULL;
-           floatPtr = floatPtr->next)
-        { floatPtr->bucket = i; }
+      floatPtr = floatArray[i];
+      if (floatPtr != NULL)
+        { floatPtr->bucket = HashFloat(floatPtr->contents,FLOAT_HASH_SIZE); }
      }
 
    /*=================================================*/
@@ -1797,13 +2442,13 @@ globle void RestoreAtomicValueBuckets(
    /*=================================================*/
 
    integerArray = GetIntegerTable(theEnv,execStatus);
+   size = GetIntegerTableSize(theEnv,execStatus);
 
-   for (i = 0; i < INTEGER_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (integerPtr = integerArray[i];
-           integerPtr != NULL;
-           integerPtr = integerPtr->next)
-        { integerPtr->bucket = i; }
+      integerPtr = integerArray[i];
+      if (integerPtr != NULL)
+        { integerPtr->bucket = HashInteger(integerPtr->contents,INTEGER_HASH_SIZE); }
      }
 
    /*================================================*/
@@ -1811,14 +2456,14 @@ globle void RestoreAtomicValueBuckets(
    /*================================================*/
 
    bitMapArray = GetBitMapTable(theEnv,execStatus);
+   size = GetBitMapTableSize(theEnv,execStatus);
 
-   for (i = 0; i < BITMAP_HASH_SIZE; i++)
+   for (i = 0; i < size; i++)
      {
-      for (bitMapPtr = bitMapArray[i];
-           bitMapPtr != NULL;
-           bitMapPtr = bitMapPtr->next)
-        { bitMapPtr->bucket = i; }
+      bitMapPtr = bitMapArray[i];
+      if (bitMapPtr != NULL)
+        { bitMapPtr->bucket = HashBitMap(bitMapPtr->contents,BITMAP_HASH_SIZE,bitMapPtr->size); }
      }
   }
 
-#endif /* BLOAD_AND_BSAVE || CONSTRUCT_COMPILER || BSAVE_INSTANCES */
+#endif /* BLOAD_AND_BSAVE || CONSTRUCT_COMPILER || BSAVE_INSTANCES || BSAVE_FACTS */
@@ -41,6 +41,17 @@
 
 #include <stdlib.h>
 
+# include <apr_atomic.h>
+# include <apr_thread_mutex.h>
+# include <apr_thread_rwlock.h>
+
+/*=============================================================*/
+/* The bucket of an atomic value is its hash value reduced to  */
+/* the range given below. It is used by the pattern and join   */
+/* networks to hash values and does not depend on the size of  */
+/* the atom tables, which grow as entries are added.           */
+/*=============================================================*/
+
 #ifndef SYMBOL_HASH_SIZE
 #define SYMBOL_HASH_SIZE       63559L
 #endif
@@ -61,18 +72,27 @@
 #define EXTERNAL_ADDRESS_HASH_SIZE        8191
 #endif
 
+#ifndef INITIAL_SYMBOL_TABLE_SIZE
+#define INITIAL_SYMBOL_TABLE_SIZE    8192L
+#endif
+
+#ifndef INITIAL_ATOM_TABLE_SIZE
+#define INITIAL_ATOM_TABLE_SIZE      1024L
+#endif
+
 /************************************************************/
 /* symbolHashNode STRUCTURE:                                */
 /************************************************************/
 struct symbolHashNode
   {
-   struct symbolHashNode *next;
-   long count;
+   volatile apr_uint32_t count;
+   volatile apr_uint32_t markedEphemeral;
    int depth;
    unsigned int permanent : 1;
-   unsigned int markedEphemeral : 1;
    unsigned int neededSymbol : 1;
    unsigned int bucket : 29;
+   unsigned int hashValue;
+   unsigned int length;
    char *contents;
   };
 
@@ -81,11 +101,10 @@ struct symbolHashNode
 /************************************************************/
 struct floatHashNode
   {
-   struct floatHashNode *next;
-   long count;
+   volatile apr_uint32_t count;
+   volatile apr_uint32_t markedEphemeral;
    int depth;
    unsigned int permanent : 1;
-   unsigned int markedEphemeral : 1;
    unsigned int neededFloat : 1;
    unsigned int bucket : 29;
    double contents;
@@ -96,11 +115,10 @@ struct floatHashNode
 /************************************************************/
 struct integerHashNode
   {
-   struct integerHashNode *next;
-   long count;
+   volatile apr_uint32_t count;
+   volatile apr_uint32_t markedEphemeral;
    int depth;
    unsigned int permanent : 1;
-   unsigned int markedEphemeral : 1;
    unsigned int neededInteger : 1;
    unsigned int bucket : 29;
    long long contents;
@@ -111,11 +129,10 @@ struct integerHashNode
 /************************************************************/
 struct bitMapHashNode
   {
-   struct bitMapHashNode *next;
-   long count;
+   volatile apr_uint32_t count;
+   volatile apr_uint32_t markedEphemeral;
    int depth;
    unsigned int permanent : 1;
-   unsigned int markedEphemeral : 1;
    unsigned int neededBitMap : 1;
    unsigned int bucket : 29;
    char *contents;
@@ -127,11 +144,10 @@ struct bitMapHashNode
 /************************************************************/
 struct externalAddressHashNode
   {
-   struct externalAddressHashNode *next;
-   long count;
+   volatile apr_uint32_t count;
+   volatile apr_uint32_t markedEphemeral;
    int depth;
    unsigned int permanent : 1;
-   unsigned int markedEphemeral : 1;
    unsigned int neededPointer : 1;
    unsigned int bucket : 29;
    void *externalAddress;
@@ -143,11 +159,10 @@ struct externalAddressHashNode
 /************************************************************/
 struct genericHashNode
   {
-   struct genericHashNode *next;
-   long count;
+   volatile apr_uint32_t count;
+   volatile apr_uint32_t markedEphemeral;
    int depth;
    unsigned int permanent : 1;
-   unsigned int markedEphemeral : 1;
    unsigned int needed : 1;
    unsigned int bucket : 29;
   };
@@ -159,6 +174,42 @@ typedef struct bitMapHashNode BITMAP_HN;
 typedef struct externalAddressHashNode EXTERNAL_ADDRESS_HN;
 typedef struct genericHashNode GENERIC_HN;
 
+/************************************************************/
+/* atomSlots STRUCTURE: The slots of an atom table. The tag */
+/*   of a slot holds the low bits of the hash value of its  */
+/*   entry with the high bit set (a zero tag marks an empty */
+/*   slot), so most entries are rejected without being      */
+/*   examined. The size is a power of two.                  */
+/************************************************************/
+struct atomSlots
+  {
+   GENERIC_HN * volatile *entries;
+   volatile apr_uint32_t *tags;
+   unsigned long size;
+   unsigned int shift;
+   struct atomSlots *nextRetired;
+  };
+
+/*************************************************************/
+/* atomTable STRUCTURE: An open addressed hash table of      */
+/*   atomic values, probed linearly. The slots are searched  */
+/*   without a lock. Entries are only added while holding    */
+/*   the lock of the table, and a slot is filled before its  */
+/*   tag is set. When the table becomes three quarters full, */
+/*   the entries are copied to twice as many slots and the   */
+/*   old slots are retired, since other threads may still be */
+/*   searching them. Entries are only removed (and retired   */
+/*   slots released) by the garbage collection, which no     */
+/*   other thread using the table runs concurrently with.    */
+/*************************************************************/
+struct atomTable
+  {
+   struct atomSlots * volatile slots;
+   unsigned long count;
+   struct atomSlots *retired;
+   apr_thread_mutex_t *lock;
+  };
+
 /**********************************************************/
 /* EPHEMERON STRUCTURE: Data structure used to keep track */
 /*   of ephemeral symbols, floats, and integers.          */
@@ -176,6 +227,45 @@ struct ephemeron
    struct ephemeron *next;
   };
 
+/*************************************************************/
+/* ephemeralAtoms STRUCTURE: The ephemeral values of one     */
+/*   type of atom, kept in generations. Values left without  */
+/*   references are added to the nursery. A garbage          */
+/*   collection cycle takes the nursery over as the values   */
+/*   to scan, which may take several calls to complete. A    */
+/*   value which can't be removed yet because it was created */
+/*   at or below the current evaluation depth is moved to    */
+/*   the tenured values, which aren't scanned again until    */
+/*   the evaluation depth drops below the deepest of them.   */
+/*************************************************************/
+struct ephemeralAtoms
+  {
+   struct ephemeron *nursery;
+   struct ephemeron *scan;
+   struct ephemeron *tenured;
+   int tenuredDepth;
+  };
+
+/*************************************************************/
+/* threadEphemerons STRUCTURE: The atomic values which had   */
+/*   no references left on a thread sharing the atom tables  */
+/*   of an environment with the thread running it. They are  */
+/*   handed over to the environment when the thread is done  */
+/*   with the atom tables and collected from there.          */
+/*************************************************************/
+struct threadEphemerons
+  {
+   struct ephemeron *symbolList;
+   struct ephemeron *floatList;
+   struct ephemeron *integerList;
+   struct ephemeron *bitMapList;
+   struct ephemeron *externalAddressList;
+   long itemCount;
+   long itemSize;
+   int nesting;
+   struct threadEphemerons *next;
+  };
+
 /************************************************************/
 /* symbolMatch STRUCTURE:                               */
 /************************************************************/
@@ -199,11 +289,11 @@ struct symbolMatch
 #define EnvValueToBitMap(theEnv,execStatus,target) ((void *) ((struct bitMapHashNode *) (target))->contents)
 #define EnvValueToExternalAddress(theEnv,execStatus,target) ((void *) ((struct externalAddressHashNode *) (target))->externalAddress)
 
-#define IncrementSymbolCount(theValue) (((SYMBOL_HN *) theValue)->count++)
-#define IncrementFloatCount(theValue) (((FLOAT_HN *) theValue)->count++)
-#define IncrementIntegerCount(theValue) (((INTEGER_HN *) theValue)->count++)
-#define IncrementBitMapCount(theValue) (((BITMAP_HN *) theValue)->count++)
-#define IncrementExternalAddressCount(theValue) (((EXTERNAL_ADDRESS_HN *) theValue)->count++)
+#define IncrementSymbolCount(theValue) apr_atomic_inc32(&((SYMBOL_HN *) theValue)->count)
+#define IncrementFloatCount(theValue) apr_atomic_inc32(&((FLOAT_HN *) theValue)->count)
+#define IncrementIntegerCount(theValue) apr_atomic_inc32(&((INTEGER_HN *) theValue)->count)
+#define IncrementBitMapCount(theValue) apr_atomic_inc32(&((BITMAP_HN *) theValue)->count)
+#define IncrementExternalAddressCount(theValue) apr_atomic_inc32(&((EXTERNAL_ADDRESS_HN *) theValue)->count)
 
 /*==================*/
 /* ENVIRONMENT DATA */
@@ -218,17 +308,19 @@ struct symbolData
    void *PositiveInfinity;
    void *NegativeInfinity;
    void *Zero;
-   SYMBOL_HN **SymbolTable;
-   FLOAT_HN **FloatTable;
-   INTEGER_HN **IntegerTable;
-   BITMAP_HN **BitMapTable;
-   EXTERNAL_ADDRESS_HN **ExternalAddressTable;
-   struct ephemeron *EphemeralSymbolList;
-   struct ephemeron *EphemeralFloatList;
-   struct ephemeron *EphemeralIntegerList;
-   struct ephemeron *EphemeralBitMapList;
-   struct ephemeron *EphemeralExternalAddressList;
-#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES
+   struct atomTable SymbolTable;
+   struct atomTable FloatTable;
+   struct atomTable IntegerTable;
+   struct atomTable BitMapTable;
+   struct atomTable ExternalAddressTable;
+   struct ephemeralAtoms EphemeralSymbols;
+   struct ephemeralAtoms EphemeralFloats;
+   struct ephemeralAtoms EphemeralIntegers;
+   struct ephemeralAtoms EphemeralBitMaps;
+   struct ephemeralAtoms EphemeralExternalAddresses;
+   struct threadEphemerons * volatile HandedOverEphemerons;
+   apr_thread_rwlock_t *AtomTablesLock;
+#if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE || BLOAD_INSTANCES || BSAVE_INSTANCES || BLOAD_FACTS || BSAVE_FACTS
    long NumberOfSymbols;
    long NumberOfFloats;
    long NumberOfIntegers;
@@ -274,17 +366,24 @@ struct symbolData
    LOCALE void                           DecrementIntegerCount(void *,EXEC_STATUS,struct integerHashNode *);
    LOCALE void                           DecrementBitMapCount(void *,EXEC_STATUS,struct bitMapHashNode *);
    LOCALE void                           DecrementExternalAddressCount(void *,EXEC_STATUS,struct externalAddressHashNode *);
-   LOCALE void                           RemoveEphemeralAtoms(void *,EXEC_STATUS);
+   LOCALE intBool                        RemoveEphemeralAtoms(void *,EXEC_STATUS);
+   LOCALE void                           EnterAtomTables(void *,EXEC_STATUS);
+   LOCALE void                           LeaveAtomTables(void *,EXEC_STATUS);
    LOCALE struct symbolHashNode        **GetSymbolTable(void *,EXEC_STATUS);
+   LOCALE unsigned long                  GetSymbolTableSize(void *,EXEC_STATUS);
    LOCALE void                           SetSymbolTable(void *,EXEC_STATUS,struct symbolHashNode **);
    LOCALE struct floatHashNode          **GetFloatTable(void *,EXEC_STATUS);
+   LOCALE unsigned long                  GetFloatTableSize(void *,EXEC_STATUS);
    LOCALE void                           SetFloatTable(void *,EXEC_STATUS,struct floatHashNode **);
    LOCALE struct integerHashNode       **GetIntegerTable(void *,EXEC_STATUS);
+   LOCALE unsigned long                  GetIntegerTableSize(void *,EXEC_STATUS);
    LOCALE void                           SetIntegerTable(void *,EXEC_STATUS,struct integerHashNode **);
    LOCALE struct bitMapHashNode        **GetBitMapTable(void *,EXEC_STATUS);
+   LOCALE unsigned long                  GetBitMapTableSize(void *,EXEC_STATUS);
    LOCALE void                           SetBitMapTable(void *,EXEC_STATUS,struct bitMapHashNode **);
    LOCALE struct externalAddressHashNode        
                                        **GetExternalAddressTable(void *,EXEC_STATUS);
+   LOCALE unsigned long                  GetExternalAddressTableSize(void *,EXEC_STATUS);
    LOCALE void                           SetExternalAddressTable(void *,EXEC_STATUS,struct externalAddressHashNode **);
    LOCALE void                           RefreshSpecialSymbols(void *,EXEC_STATUS);
    LOCALE struct symbolMatch            *FindSymbolMatches(void *,EXEC_STATUS,char *,unsigned *,size_t *);
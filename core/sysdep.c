@@ -104,6 +104,10 @@ extern int LIB$SPAWN();
 #include <signal.h>
 #endif
 
+#if   UNIX_V || LINUX || DARWIN || GENERIC
+#include <unistd.h>
+#endif
+
 #if   UNIX_V || LINUX || DARWIN
 #include <sys/types.h>
 #include <sys/time.h>
@@ -112,6 +116,15 @@ extern int LIB$SPAWN();
 #include <signal.h>
 #endif
 
+#if BLOAD_MMAP && (UNIX_V || LINUX || DARWIN || GENERIC) && defined(_POSIX_MAPPED_FILES)
+#define MAP_BINARY_FILES 1
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define MAP_BINARY_FILES 0
+#endif
+
 #include "argacces.h"
 #include "bmathfun.h"
 #include "commline.h"
@@ -219,6 +232,11 @@ struct systemDependentData
 #endif
 #if (! WIN_BTC) && (! WIN_MVC)
    FILE *BinaryFP;
+#endif
+#if MAP_BINARY_FILES
+   char *BinaryMap;
+   size_t BinaryMapSize;
+   size_t BinaryMapPosition;
 #endif
    int (*BeforeOpenFunction)(void *,EXEC_STATUS);
    int (*AfterOpenFunction)(void *,EXEC_STATUS);
@@ -242,6 +260,10 @@ struct systemDependentData
    static void                    SystemFunctionDefinitions(void *,EXEC_STATUS);
    static void                    InitializeKeywords(void *,EXEC_STATUS);
    static void                    InitializeNonportableFeatures(void *);
+#if MAP_BINARY_FILES
+   static void                    MapBinaryFile(void *,EXEC_STATUS);
+   static void                    SetBinaryMapPosition(void *,EXEC_STATUS,long);
+#endif
 #if   (VAX_VMS || UNIX_V || LINUX || DARWIN || UNIX_7 || WIN_GCC || WIN_BTC || WIN_MVC) && (! WINDOW_INTERFACE)
    static void                    CatchCtrlC(int);
 #endif
@@ -1159,6 +1181,30 @@ globle void genseed(
    srand((unsigned) seed);
   }
 
+/*****************************************************/
+/* genonlinecpus: Generic function for returning the */
+/*   number of processors currently online. Used to  */
+/*   size the thread pools of the parallel matcher.  */
+/*****************************************************/
+globle unsigned int genonlinecpus()
+  {
+#if WIN_MVC || WIN_BTC
+   SYSTEM_INFO systemInfo;
+
+   GetSystemInfo(&systemInfo);
+   if (systemInfo.dwNumberOfProcessors > 0)
+     { return((unsigned int) systemInfo.dwNumberOfProcessors); }
+#elif defined(_SC_NPROCESSORS_ONLN)
+   long count;
+
+   count = sysconf(_SC_NPROCESSORS_ONLN);
+   if (count > 0)
+     { return((unsigned int) count); }
+#endif
+
+   return(1);
+  }
+
 /*********************************************/
 /* gengetcwd: Generic function for returning */
 /*   the current directory.                  */
@@ -1323,12 +1369,57 @@ globle int GenOpenReadBinary(
      }
 #endif
 
+#if MAP_BINARY_FILES
+   MapBinaryFile(theEnv,execStatus);
+#endif
+
    if (SystemDependentData(theEnv,execStatus)->AfterOpenFunction != NULL)
      { (*SystemDependentData(theEnv,execStatus)->AfterOpenFunction)(theEnv,execStatus); }
 
    return(TRUE);
   }
 
+#if MAP_BINARY_FILES
+
+/*****************************************************/
+/* MapBinaryFile: Maps the file opened for binary    */
+/*   access into memory. The pages are shared with   */
+/*   the file cache and with any other process       */
+/*   mapping the same file. If the file can't be     */
+/*   mapped, it is read through its file pointer.    */
+/*****************************************************/
+static void MapBinaryFile(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct stat fileInfo;
+   void *theMap;
+
+   SystemDependentData(theEnv,execStatus)->BinaryMap = NULL;
+   SystemDependentData(theEnv,execStatus)->BinaryMapSize = 0;
+   SystemDependentData(theEnv,execStatus)->BinaryMapPosition = 0;
+
+   if (fstat(fileno(SystemDependentData(theEnv,execStatus)->BinaryFP),&fileInfo) != 0)
+     { return; }
+
+   if ((fileInfo.st_size <= 0) ||
+       ((unsigned long long) fileInfo.st_size > (unsigned long long) ((size_t) -1)))
+     { return; }
+
+   theMap = mmap(NULL,(size_t) fileInfo.st_size,PROT_READ,MAP_SHARED,
+                 fileno(SystemDependentData(theEnv,execStatus)->BinaryFP),0);
+   if (theMap == MAP_FAILED) return;
+
+#ifdef MADV_SEQUENTIAL
+   madvise(theMap,(size_t) fileInfo.st_size,MADV_SEQUENTIAL);
+#endif
+
+   SystemDependentData(theEnv,execStatus)->BinaryMap = (char *) theMap;
+   SystemDependentData(theEnv,execStatus)->BinaryMapSize = (size_t) fileInfo.st_size;
+  }
+
+#endif
+
 /***********************************************/
 /* GenReadBinary: Generic and machine specific */
 /*   code for reading from a file.             */
@@ -1369,11 +1460,62 @@ globle void GenReadBinary(
      { read(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,tempPtr,(STD_SIZE) size); }
 #endif
 
+#if MAP_BINARY_FILES
+   struct systemDependentData *theData = SystemDependentData(theEnv,execStatus);
+
+   if (theData->BinaryMap != NULL)
+     {
+      if (size > theData->BinaryMapSize - theData->BinaryMapPosition)
+        { size = theData->BinaryMapSize - theData->BinaryMapPosition; }
+      memcpy(dataPtr,theData->BinaryMap + theData->BinaryMapPosition,size);
+      theData->BinaryMapPosition += size;
+      return;
+     }
+#endif
+
 #if (! WIN_BTC) && (! WIN_MVC)
    fread(dataPtr,size,1,SystemDependentData(theEnv,execStatus)->BinaryFP); 
 #endif
   }
 
+/********************************************************/
+/* GenReadBinaryInPlace: Returns a pointer to the next  */
+/*   size bytes of a memory mapped binary file and      */
+/*   skips them, so the caller can use them without     */
+/*   copying. Returns NULL if the file isn't mapped, if */
+/*   fewer bytes remain, or if the bytes don't start at */
+/*   a multiple of the given alignment. The caller must */
+/*   then read the bytes with GenReadBinary.            */
+/********************************************************/
+globle void *GenReadBinaryInPlace(
+  void *theEnv,
+  EXEC_STATUS,
+  size_t size,
+  size_t alignment)
+  {
+#if MAP_BINARY_FILES
+   struct systemDependentData *theData = SystemDependentData(theEnv,execStatus);
+   char *thePtr;
+
+   if (theData->BinaryMap == NULL) return(NULL);
+
+   if (size > theData->BinaryMapSize - theData->BinaryMapPosition)
+     { return(NULL); }
+
+   thePtr = theData->BinaryMap + theData->BinaryMapPosition;
+   if ((alignment > 1) && ((((size_t) thePtr) % alignment) != 0))
+     { return(NULL); }
+
+   theData->BinaryMapPosition += size;
+   return((void *) thePtr);
+#else
+#if MAC_MCW || WIN_MCW || MAC_XCD
+#pragma unused(theEnv,execStatus,size,alignment)
+#endif
+   return(NULL);
+#endif
+  }
+
 /***************************************************/
 /* GetSeekCurBinary:  Generic and machine specific */
 /*   code for seeking a position in a file.        */
@@ -1391,6 +1533,15 @@ globle void GetSeekCurBinary(
    _lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,offset,SEEK_CUR);
 #endif
 
+#if MAP_BINARY_FILES
+   if (SystemDependentData(theEnv,execStatus)->BinaryMap != NULL)
+     {
+      SetBinaryMapPosition(theEnv,execStatus,
+                           (long) SystemDependentData(theEnv,execStatus)->BinaryMapPosition + offset);
+      return;
+     }
+#endif
+
 #if (! WIN_BTC) && (! WIN_MVC)
    fseek(SystemDependentData(theEnv,execStatus)->BinaryFP,offset,SEEK_CUR);
 #endif
@@ -1413,6 +1564,14 @@ globle void GetSeekSetBinary(
    _lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,offset,SEEK_SET);
 #endif
 
+#if MAP_BINARY_FILES
+   if (SystemDependentData(theEnv,execStatus)->BinaryMap != NULL)
+     {
+      SetBinaryMapPosition(theEnv,execStatus,offset);
+      return;
+     }
+#endif
+
 #if (! WIN_BTC) && (! WIN_MVC)
    fseek(SystemDependentData(theEnv,execStatus)->BinaryFP,offset,SEEK_SET);
 #endif
@@ -1435,11 +1594,79 @@ globle void GenTellBinary(
    *offset = _lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,0,SEEK_CUR);
 #endif
 
+#if MAP_BINARY_FILES
+   if (SystemDependentData(theEnv,execStatus)->BinaryMap != NULL)
+     {
+      *offset = (long) SystemDependentData(theEnv,execStatus)->BinaryMapPosition;
+      return;
+     }
+#endif
+
 #if (! WIN_BTC) && (! WIN_MVC)
    *offset = ftell(SystemDependentData(theEnv,execStatus)->BinaryFP);
 #endif
   }
 
+/************************************************/
+/* GenSizeBinary:  Generic and machine specific */
+/*   code for telling the size of a file.       */
+/************************************************/
+globle void GenSizeBinary(
+  void *theEnv,
+  EXEC_STATUS,
+  long *size)
+  {
+   long offset;
+
+#if WIN_BTC
+   offset = lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,0,SEEK_CUR);
+   *size = lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,0,SEEK_END);
+   lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,offset,SEEK_SET);
+#endif
+
+#if WIN_MVC
+   offset = _lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,0,SEEK_CUR);
+   *size = _lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,0,SEEK_END);
+   _lseek(SystemDependentData(theEnv,execStatus)->BinaryFileHandle,offset,SEEK_SET);
+#endif
+
+#if MAP_BINARY_FILES
+   if (SystemDependentData(theEnv,execStatus)->BinaryMap != NULL)
+     {
+      *size = (long) SystemDependentData(theEnv,execStatus)->BinaryMapSize;
+      return;
+     }
+#endif
+
+#if (! WIN_BTC) && (! WIN_MVC)
+   offset = ftell(SystemDependentData(theEnv,execStatus)->BinaryFP);
+   fseek(SystemDependentData(theEnv,execStatus)->BinaryFP,0,SEEK_END);
+   *size = ftell(SystemDependentData(theEnv,execStatus)->BinaryFP);
+   fseek(SystemDependentData(theEnv,execStatus)->BinaryFP,offset,SEEK_SET);
+#endif
+  }
+
+#if MAP_BINARY_FILES
+
+/*******************************************************/
+/* SetBinaryMapPosition: Moves the read position of a  */
+/*   memory mapped binary file, keeping it within the  */
+/*   file as fseek would for a file being read.        */
+/*******************************************************/
+static void SetBinaryMapPosition(
+  void *theEnv,
+  EXEC_STATUS,
+  long position)
+  {
+   if (position < 0) position = 0;
+   if ((size_t) position > SystemDependentData(theEnv,execStatus)->BinaryMapSize)
+     { position = (long) SystemDependentData(theEnv,execStatus)->BinaryMapSize; }
+
+   SystemDependentData(theEnv,execStatus)->BinaryMapPosition = (size_t) position;
+  }
+
+#endif
+
 /****************************************/
 /* GenCloseBinary:  Generic and machine */
 /*   specific code for closing a file.  */
@@ -1459,6 +1686,15 @@ globle void GenCloseBinary(
    _close(SystemDependentData(theEnv,execStatus)->BinaryFileHandle);
 #endif
 
+#if MAP_BINARY_FILES
+   if (SystemDependentData(theEnv,execStatus)->BinaryMap != NULL)
+     {
+      munmap(SystemDependentData(theEnv,execStatus)->BinaryMap,
+             SystemDependentData(theEnv,execStatus)->BinaryMapSize);
+      SystemDependentData(theEnv,execStatus)->BinaryMap = NULL;
+     }
+#endif
+
 #if (! WIN_BTC) && (! WIN_MVC)
    fclose(SystemDependentData(theEnv,execStatus)->BinaryFP);
 #endif
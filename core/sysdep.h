@@ -73,13 +73,16 @@
    LOCALE void                        GetSeekCurBinary(void *,EXEC_STATUS,long);
    LOCALE void                        GetSeekSetBinary(void *,EXEC_STATUS,long);
    LOCALE void                        GenTellBinary(void *,EXEC_STATUS,long *);
+   LOCALE void                        GenSizeBinary(void *,EXEC_STATUS,long *);
    LOCALE void                        GenCloseBinary(void *,EXEC_STATUS);
    LOCALE void                        GenReadBinary(void *,EXEC_STATUS,void *,size_t);
+   LOCALE void                       *GenReadBinaryInPlace(void *,EXEC_STATUS,size_t,size_t);
    LOCALE FILE                       *GenOpen(void *,EXEC_STATUS,char *,char *);
    LOCALE int                         GenClose(void *,EXEC_STATUS,FILE *);
    LOCALE void                        genexit(void *,EXEC_STATUS,int);
    LOCALE int                         genrand(void);
    LOCALE void                        genseed(int);
+   LOCALE unsigned int                genonlinecpus(void);
    LOCALE int                         genremove(char *);
    LOCALE int                         genrename(char *,char *);
    LOCALE char                       *gengetcwd(char *,int);
@@ -41,6 +41,7 @@
 #include "tmpltdef.h"
 #include "tmpltutl.h"
 #include "envrnmnt.h"
+#include "tmpltidx.h"
 
 #include "tmpltbin.h"
 
@@ -92,6 +93,12 @@ static void DeallocateDeftemplateBloadData(
   EXEC_STATUS)
   {
    size_t space;
+#if DEFINDEX_CONSTRUCT
+   long i;
+
+   for (i = 0; i < DeftemplateBinaryData(theEnv,execStatus)->NumberOfDeftemplates; i++)
+     { DestroyDefindexes(theEnv,execStatus,&DeftemplateBinaryData(theEnv,execStatus)->DeftemplateArray[i]); }
+#endif
 
    space =  DeftemplateBinaryData(theEnv,execStatus)->NumberOfTemplateModules * sizeof(struct deftemplateModule);
    if (space != 0) genfree(theEnv,execStatus,(void *) DeftemplateBinaryData(theEnv,execStatus)->ModuleArray,space);
@@ -505,6 +512,8 @@ static void UpdateDeftemplate(
    theDeftemplate->numberOfSlots = (unsigned short) bdtPtr->numberOfSlots;
    theDeftemplate->factList = NULL;
    theDeftemplate->lastFact = NULL;
+   theDeftemplate->indexList = NULL;
+   ClearDeftemplateStatistics(theDeftemplate);
   }
 
 /************************************************/
@@ -559,6 +568,16 @@ static void ClearBload(
    for (i = 0; i < DeftemplateBinaryData(theEnv,execStatus)->NumberOfDeftemplates; i++)
      { UnmarkConstructHeader(theEnv,execStatus,&DeftemplateBinaryData(theEnv,execStatus)->DeftemplateArray[i].header); }
 
+#if DEFINDEX_CONSTRUCT
+   /*=====================================*/
+   /* Release the indexes defined for the */
+   /* loaded deftemplates.                */
+   /*=====================================*/
+
+   for (i = 0; i < DeftemplateBinaryData(theEnv,execStatus)->NumberOfDeftemplates; i++)
+     { ReturnDefindexes(theEnv,execStatus,&DeftemplateBinaryData(theEnv,execStatus)->DeftemplateArray[i]); }
+#endif
+
    /*=======================================*/
    /* Decrement in use counters for symbols */
    /* used as slot names.                   */
@@ -301,12 +301,13 @@ static void DeftemplateToCode(
    else
      { FactPatternNodeReference(theEnv,execStatus,theTemplate->patternNetwork,theFile,imageID,maxIndices); }
 
-   /*============================================*/
-   /* Print the factList and lastFact references */
-   /* and close the structure.                   */
-   /*============================================*/
+   /*==============================================*/
+   /* Print the factList, lastFact, and indexList  */
+   /* references and the statistics and close the  */
+   /* structure.                                   */
+   /*==============================================*/
    
-   fprintf(theFile,",NULL,NULL}");
+   fprintf(theFile,",NULL,NULL,NULL,{0,0,0,0,0.0}}");
   }
 
 /*****************************************************/
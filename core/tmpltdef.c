@@ -50,6 +50,7 @@
 #include "modulutl.h"
 #include "cstrnchk.h"
 #include "envrnmnt.h"
+#include "tmpltidx.h"
 
 #if BLOAD || BLOAD_ONLY || BLOAD_AND_BSAVE
 #include "bload.h"
@@ -106,6 +107,10 @@ globle void InitializeDeftemplates(
 
    DeftemplateFunctions(theEnv,execStatus);
 
+#if DEFINDEX_CONSTRUCT
+   InitializeDefindexes(theEnv,execStatus);
+#endif
+
    DeftemplateData(theEnv,execStatus)->DeftemplateConstruct =
       AddConstruct(theEnv,execStatus,"deftemplate","deftemplates",ParseDeftemplate,EnvFindDeftemplate,
                    GetConstructNamePointer,GetConstructPPForm,
@@ -325,6 +330,10 @@ static void ReturnDeftemplate(
 
    ReturnSlots(theEnv,execStatus,theConstruct->slotList);
 
+#if DEFINDEX_CONSTRUCT
+   ReturnDefindexes(theEnv,execStatus,theConstruct);
+#endif
+
    /*==================================*/
    /* Free storage used by the header. */
    /*==================================*/
@@ -366,6 +375,10 @@ static void DestroyDeftemplate(
 #endif
 
    DestroyFactPatternNetwork(theEnv,execStatus,theConstruct->patternNetwork);
+
+#if DEFINDEX_CONSTRUCT
+   DestroyDefindexes(theEnv,execStatus,theConstruct);
+#endif
    
    /*==================================*/
    /* Free storage used by the header. */
@@ -29,6 +29,8 @@
 struct deftemplate;
 struct templateSlot;
 struct deftemplateModule;
+struct deftemplateStatistics;
+struct defindex;
 
 #ifndef _H_conscomp
 #include "conscomp.h"
@@ -59,6 +61,15 @@ struct deftemplateModule;
 #include "cstrccom.h"
 #endif
 
+struct deftemplateStatistics
+  {
+   long long asserts;
+   long long retracts;
+   long long modifies;
+   long long alphaMatches;
+   double matchTime;
+  };
+
 struct deftemplate
   {
    struct constructHeader header;
@@ -71,6 +82,8 @@ struct deftemplate
    struct factPatternNode *patternNetwork;
    struct fact *factList;
    struct fact *lastFact;
+   struct defindex *indexList;
+   struct deftemplateStatistics statistics;
   };
 
 struct templateSlot
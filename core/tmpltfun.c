@@ -159,7 +159,9 @@ globle void DuplicateCommand(
 /*   copied to a new fact. Replacements to the fields of the   */
 /*   new fact are then made. If a modify command is being      */
 /*   performed, the original fact is retracted. Lastly, the    */
-/*   new fact is asserted.                                     */
+/*   new fact is asserted. If modify-in-place is enabled, the  */
+/*   original fact is instead given the new values whenever    */
+/*   ModifyFactInPlace allows it.                              */
 /***************************************************************/
 static void DuplicateModifyCommand(
   void *theEnv,
@@ -192,7 +194,7 @@ static void DuplicateModifyCommand(
 
    /*==============================================================*/
    /* If an integer is supplied, then treat it as a fact-index and */
-   /* search the fact-list for the fact with that fact-index.      */
+   /* look up the fact with that fact-index.                       */
    /*==============================================================*/
 
    if (computeResult.type == INTEGER)
@@ -206,14 +208,7 @@ static void DuplicateModifyCommand(
          return;
         }
 
-      oldFact = (struct fact *) EnvGetNextFact(theEnv,execStatus,NULL);
-      while (oldFact != NULL)
-        {
-         if (oldFact->factIndex == factNum)
-           { break; }
-         else
-           { oldFact = oldFact->nextFact; }
-        }
+      oldFact = FindIndexedFact(theEnv,execStatus,factNum);
 
       if (oldFact == NULL)
         {
@@ -410,8 +405,14 @@ static void DuplicateModifyCommand(
    /*======================================*/
 
 # warning STEFAN: check back here, whether we need to use DuplicateModifyCommand and want to do EnvAssert with (..,.., TRUE)
-   if (retractIt) EnvRetract(theEnv,execStatus,oldFact);
-   theFact = (struct fact *) EnvAssert(theEnv,execStatus,newFact, FALSE);
+   if (retractIt && EnvGetModifyInPlace(theEnv,execStatus) &&
+       ModifyFactInPlace(theEnv,execStatus,oldFact,newFact))
+     { theFact = oldFact; }
+   else
+     {
+      if (retractIt) EnvRetract(theEnv,execStatus,oldFact);
+      theFact = (struct fact *) EnvAssert(theEnv,execStatus,newFact, FALSE);
+     }
 
    /*========================================*/
    /* The asserted fact is the return value. */
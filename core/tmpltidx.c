@@ -0,0 +1,696 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                  DEFINDEX MODULE                    */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Parses and maintains the defindex construct.     */
+/*                                                           */
+/*   (defindex <deftemplate-name> <slot-name> [hash|ordered])*/
+/*                                                           */
+/*   A defindex keeps the facts of a deftemplate in a slot   */
+/*   index on the value of one of its single field slots.    */
+/*   A hash index finds the facts whose slot is eq to a      */
+/*   value, an ordered index also finds the facts whose slot */
+/*   lies in a numeric range. The indexes of a deftemplate   */
+/*   are updated whenever one of its facts is asserted or    */
+/*   retracted and are released along with the deftemplate.  */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#define _TMPLTIDX_SOURCE_
+
+#include "setup.h"
+
+#if DEFINDEX_CONSTRUCT
+
+#include <stdio.h>
+#define _STDIO_INCLUDED_
+#include <string.h>
+
+#include "argacces.h"
+#include "constant.h"
+#include "constrct.h"
+#include "envrnmnt.h"
+#include "extnfunc.h"
+#include "memalloc.h"
+#include "moduldef.h"
+#include "modulutl.h"
+#include "prntutil.h"
+#include "router.h"
+#include "scanner.h"
+#include "tmpltutl.h"
+#include "watch.h"
+
+#include "tmpltidx.h"
+
+/***************************************/
+/* LOCAL INTERNAL FUNCTION DEFINITIONS */
+/***************************************/
+
+#if (! RUN_TIME) && (! BLOAD_ONLY)
+   static int                     ParseDefindex(void *,EXEC_STATUS,char *);
+   static void                    SaveDefindexes(void *,EXEC_STATUS,void *,char *);
+#endif
+   static void                    IndexTemplateFacts(void *,EXEC_STATUS,struct deftemplate *,struct defindex *);
+   static void                    DropDefindex(void *,EXEC_STATUS,struct deftemplate *,struct defindex *);
+
+/*****************************************************/
+/* InitializeDefindexes: Initializes the defindex    */
+/*   construct and the commands which operate on it. */
+/*****************************************************/
+globle void InitializeDefindexes(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+#if (! RUN_TIME) && (! BLOAD_ONLY)
+   AddConstruct(theEnv,execStatus,"defindex","defindexes",ParseDefindex,NULL,NULL,NULL,NULL,
+                                                     NULL,NULL,NULL,NULL,NULL);
+   AddSaveFunction(theEnv,execStatus,"defindex",SaveDefindexes,5);
+#endif
+
+#if ! RUN_TIME
+   EnvDefineFunction2(theEnv,execStatus,"undefindex",'v',PTIEF UndefindexCommand,"UndefindexCommand","22w");
+#if DEBUGGING_FUNCTIONS
+   EnvDefineFunction2(theEnv,execStatus,"list-defindexes",'v',PTIEF ListDefindexesCommand,"ListDefindexesCommand","00");
+#endif
+#endif
+  }
+
+#if (! RUN_TIME) && (! BLOAD_ONLY)
+
+/**************************************************************/
+/* ParseDefindex: Coordinates all actions necessary for the   */
+/*   addition of a defindex construct. Returns TRUE if errors */
+/*   were detected, otherwise FALSE.                          */
+/**************************************************************/
+static int ParseDefindex(
+  void *theEnv,
+  EXEC_STATUS,
+  char *readSource)
+  {
+   struct token inputToken;
+   struct deftemplate *theDeftemplate;
+   struct templateSlot *theSlot;
+   SYMBOL_HN *templateName, *slotName;
+   short position;
+   int count, ordered = FALSE;
+
+   SetPPBufferStatus(theEnv,execStatus,OFF);
+
+   /*==============================*/
+   /* Find the indexed deftemplate */
+   /* among the visible ones.      */
+   /*==============================*/
+
+   GetToken(theEnv,execStatus,readSource,&inputToken);
+   if (inputToken.type != SYMBOL)
+     {
+      SyntaxErrorMessage(theEnv,execStatus,"defindex");
+      return(TRUE);
+     }
+   templateName = (SYMBOL_HN *) inputToken.value;
+
+   theDeftemplate = (struct deftemplate *)
+                    FindImportedConstruct(theEnv,execStatus,"deftemplate",NULL,ValueToString(templateName),
+                                          &count,TRUE,NULL);
+   if (theDeftemplate == NULL)
+     {
+      CantFindItemErrorMessage(theEnv,execStatus,"deftemplate",ValueToString(templateName));
+      return(TRUE);
+     }
+
+   if (count > 1)
+     {
+      AmbiguousReferenceErrorMessage(theEnv,execStatus,"deftemplate",ValueToString(templateName));
+      return(TRUE);
+     }
+
+   if (theDeftemplate->implied)
+     {
+      PrintErrorID(theEnv,execStatus,"TMPLTIDX",1,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"The facts of the implied deftemplate ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,ValueToString(templateName));
+      EnvPrintRouter(theEnv,execStatus,WERROR," can not be indexed.\n");
+      return(TRUE);
+     }
+
+   /*==================================*/
+   /* The indexed slot must be defined */
+   /* and hold a single field.         */
+   /*==================================*/
+
+   GetToken(theEnv,execStatus,readSource,&inputToken);
+   if (inputToken.type != SYMBOL)
+     {
+      SyntaxErrorMessage(theEnv,execStatus,"defindex");
+      return(TRUE);
+     }
+   slotName = (SYMBOL_HN *) inputToken.value;
+
+   theSlot = FindSlot(theDeftemplate,slotName,&position);
+   if (theSlot == NULL)
+     {
+      InvalidDeftemplateSlotMessage(theEnv,execStatus,ValueToString(slotName),
+                                    ValueToString(templateName),TRUE);
+      return(TRUE);
+     }
+
+   if (theSlot->multislot)
+     {
+      PrintErrorID(theEnv,execStatus,"TMPLTIDX",2,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"The multislot ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,ValueToString(slotName));
+      EnvPrintRouter(theEnv,execStatus,WERROR," of deftemplate ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,ValueToString(templateName));
+      EnvPrintRouter(theEnv,execStatus,WERROR," can not be indexed.\n");
+      return(TRUE);
+     }
+
+   /*=============================*/
+   /* Parse the optional kind of  */
+   /* index, which defaults to a  */
+   /* hash index.                 */
+   /*=============================*/
+
+   GetToken(theEnv,execStatus,readSource,&inputToken);
+   if (inputToken.type == SYMBOL)
+     {
+      if (strcmp(ValueToString(inputToken.value),"ordered") == 0)
+        { ordered = TRUE; }
+      else if (strcmp(ValueToString(inputToken.value),"hash") != 0)
+        {
+         SyntaxErrorMessage(theEnv,execStatus,"defindex");
+         return(TRUE);
+        }
+      GetToken(theEnv,execStatus,readSource,&inputToken);
+     }
+
+   if (inputToken.type != RPAREN)
+     {
+      SyntaxErrorMessage(theEnv,execStatus,"defindex");
+      return(TRUE);
+     }
+
+   if (ConstructData(theEnv,execStatus)->CheckSyntaxMode)
+     { return(FALSE); }
+
+#if DEBUGGING_FUNCTIONS
+   if ((EnvGetWatchItem(theEnv,execStatus,"compilations") == TRUE) &&
+       GetPrintWhileLoading(theEnv,execStatus))
+     {
+      EnvPrintRouter(theEnv,execStatus,WDIALOG,"Defining defindex: ");
+      EnvPrintRouter(theEnv,execStatus,WDIALOG,ValueToString(templateName));
+      EnvPrintRouter(theEnv,execStatus,WDIALOG," ");
+      EnvPrintRouter(theEnv,execStatus,WDIALOG,ValueToString(slotName));
+      EnvPrintRouter(theEnv,execStatus,WDIALOG,"\n");
+     }
+   else
+#endif
+     {
+      if (GetPrintWhileLoading(theEnv,execStatus))
+        { EnvPrintRouter(theEnv,execStatus,WDIALOG,"~"); }
+     }
+
+   EnvAddDefindex(theEnv,execStatus,theDeftemplate,ValueToString(slotName),ordered);
+
+   return(FALSE);
+  }
+
+/***********************************************/
+/* SaveDefindexes: Defindex save routine for   */
+/*   use with the save command. The indexes    */
+/*   follow the deftemplates of their module.  */
+/***********************************************/
+static void SaveDefindexes(
+  void *theEnv,
+  EXEC_STATUS,
+  void *theModule,
+  char *logicalName)
+  {
+   struct deftemplate *theDeftemplate;
+   struct defindex *theDefindex;
+
+   SaveCurrentModule(theEnv,execStatus);
+   EnvSetCurrentModule(theEnv,execStatus,theModule);
+
+   for (theDeftemplate = (struct deftemplate *) EnvGetNextDeftemplate(theEnv,execStatus,NULL);
+        theDeftemplate != NULL;
+        theDeftemplate = (struct deftemplate *) EnvGetNextDeftemplate(theEnv,execStatus,theDeftemplate))
+     {
+      for (theDefindex = theDeftemplate->indexList;
+           theDefindex != NULL;
+           theDefindex = theDefindex->next)
+        {
+         EnvPrintRouter(theEnv,execStatus,logicalName,"(defindex ");
+         EnvPrintRouter(theEnv,execStatus,logicalName,EnvGetDeftemplateName(theEnv,execStatus,theDeftemplate));
+         EnvPrintRouter(theEnv,execStatus,logicalName," ");
+         EnvPrintRouter(theEnv,execStatus,logicalName,ValueToString(theDefindex->slotName));
+         EnvPrintRouter(theEnv,execStatus,logicalName,
+                        theDefindex->theIndex->ordered ? " ordered)\n\n" : " hash)\n\n");
+        }
+     }
+
+   RestoreCurrentModule(theEnv,execStatus);
+  }
+
+#endif /* (! RUN_TIME) && (! BLOAD_ONLY) */
+
+/*************************************************************/
+/* EnvAddDefindex: C access routine for adding an index on a */
+/*   slot of a deftemplate. The facts of the deftemplate are */
+/*   entered into the index right away. An existing index on */
+/*   the slot is replaced if it is of the other kind.        */
+/*   Returns FALSE if the slot can not be indexed.           */
+/*************************************************************/
+globle intBool EnvAddDefindex(
+  void *theEnv,
+  EXEC_STATUS,
+  void *vTheDeftemplate,
+  char *slotName,
+  int ordered)
+  {
+   struct deftemplate *theDeftemplate = (struct deftemplate *) vTheDeftemplate;
+   struct templateSlot *theSlot;
+   struct defindex *theDefindex, *lastDefindex;
+   SYMBOL_HN *slotSymbol;
+   short position;
+
+   if (theDeftemplate->implied) return(FALSE);
+
+   slotSymbol = FindSymbolHN(theEnv,execStatus,slotName);
+   if (slotSymbol == NULL) return(FALSE);
+
+   theSlot = FindSlot(theDeftemplate,slotSymbol,&position);
+   if ((theSlot == NULL) || theSlot->multislot) return(FALSE);
+
+   theDefindex = FindDefindex(theDeftemplate,slotSymbol);
+   if (theDefindex != NULL)
+     {
+      if (theDefindex->theIndex->ordered == (ordered ? TRUE : FALSE))
+        { return(TRUE); }
+      DropDefindex(theEnv,execStatus,theDeftemplate,theDefindex);
+     }
+
+   theDefindex = get_struct(theEnv,execStatus,defindex);
+   theDefindex->slotName = slotSymbol;
+   IncrementSymbolCount(slotSymbol);
+   theDefindex->whichField = (unsigned short) (position - 1);
+   theDefindex->theIndex = CreateSlotIndex(theEnv,execStatus,ordered);
+   theDefindex->next = NULL;
+
+   if (theDeftemplate->indexList == NULL)
+     { theDeftemplate->indexList = theDefindex; }
+   else
+     {
+      for (lastDefindex = theDeftemplate->indexList;
+           lastDefindex->next != NULL;
+           lastDefindex = lastDefindex->next)
+        { /* Do Nothing */ }
+      lastDefindex->next = theDefindex;
+     }
+
+   IndexTemplateFacts(theEnv,execStatus,theDeftemplate,theDefindex);
+
+   return(TRUE);
+  }
+
+/**********************************************************/
+/* EnvRemoveDefindex: C access routine for removing the   */
+/*   index on a slot of a deftemplate. Returns FALSE if   */
+/*   the slot is not indexed.                             */
+/**********************************************************/
+globle intBool EnvRemoveDefindex(
+  void *theEnv,
+  EXEC_STATUS,
+  void *vTheDeftemplate,
+  char *slotName)
+  {
+   struct deftemplate *theDeftemplate = (struct deftemplate *) vTheDeftemplate;
+   struct defindex *theDefindex;
+   SYMBOL_HN *slotSymbol;
+
+   slotSymbol = FindSymbolHN(theEnv,execStatus,slotName);
+   if (slotSymbol == NULL) return(FALSE);
+
+   theDefindex = FindDefindex(theDeftemplate,slotSymbol);
+   if (theDefindex == NULL) return(FALSE);
+
+   DropDefindex(theEnv,execStatus,theDeftemplate,theDefindex);
+
+   return(TRUE);
+  }
+
+/**************************************************/
+/* FindDefindex: Returns the index of a slot of a */
+/*   deftemplate, or NULL if it is not indexed.   */
+/**************************************************/
+globle struct defindex *FindDefindex(
+  struct deftemplate *theDeftemplate,
+  SYMBOL_HN *slotName)
+  {
+   struct defindex *theDefindex;
+
+   for (theDefindex = theDeftemplate->indexList;
+        theDefindex != NULL;
+        theDefindex = theDefindex->next)
+     {
+      if (theDefindex->slotName == slotName)
+        { return(theDefindex); }
+     }
+
+   return(NULL);
+  }
+
+/************************************************************/
+/* AddFactToDefindexes: Enters a fact which is being        */
+/*   asserted into every index of its deftemplate. The      */
+/*   entries are chained to the fact so that they can be    */
+/*   removed when the fact is retracted.                    */
+/************************************************************/
+globle void AddFactToDefindexes(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct defindex *theDefindex;
+   struct slotIndexEntry *theEntry;
+   struct field *theField;
+
+   for (theDefindex = theFact->whichDeftemplate->indexList;
+        theDefindex != NULL;
+        theDefindex = theDefindex->next)
+     {
+      theField = &theFact->theProposition.theFields[theDefindex->whichField];
+      theEntry = AddSlotIndexEntry(theEnv,execStatus,theDefindex->theIndex,(void *) theFact,
+                                   theFact->factIndex,theField->type,theField->value);
+      theEntry->nextInOwner = theFact->indexEntries;
+      theFact->indexEntries = theEntry;
+     }
+  }
+
+/***************************************************/
+/* RemoveFactFromDefindexes: Removes a fact which  */
+/*   is being retracted from the indexes of its    */
+/*   deftemplate.                                  */
+/***************************************************/
+globle void RemoveFactFromDefindexes(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct slotIndexEntry *theEntry, *nextEntry;
+
+   for (theEntry = theFact->indexEntries; theEntry != NULL; theEntry = nextEntry)
+     {
+      nextEntry = theEntry->nextInOwner;
+      RemoveSlotIndexEntry(theEnv,execStatus,theEntry);
+     }
+
+   theFact->indexEntries = NULL;
+  }
+
+/***************************************************************/
+/* ReturnFactIndexEntries: Releases the index entries of a     */
+/*   fact which is freed without being retracted, which only   */
+/*   happens when the environment is deallocated. The indexes  */
+/*   themselves may already be gone and are left untouched.    */
+/***************************************************************/
+globle void ReturnFactIndexEntries(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact *theFact)
+  {
+   struct slotIndexEntry *theEntry, *nextEntry;
+
+   for (theEntry = theFact->indexEntries; theEntry != NULL; theEntry = nextEntry)
+     {
+      nextEntry = theEntry->nextInOwner;
+      rtn_struct(theEnv,execStatus,slotIndexEntry,theEntry);
+     }
+
+   theFact->indexEntries = NULL;
+  }
+
+/***********************************************************/
+/* ReturnDefindexes: Releases the indexes of a deftemplate */
+/*   which is being deleted.                               */
+/***********************************************************/
+globle void ReturnDefindexes(
+  void *theEnv,
+  EXEC_STATUS,
+  struct deftemplate *theDeftemplate)
+  {
+   struct defindex *theDefindex, *nextDefindex;
+
+   for (theDefindex = theDeftemplate->indexList;
+        theDefindex != NULL;
+        theDefindex = nextDefindex)
+     {
+      nextDefindex = theDefindex->next;
+      ReturnSlotIndex(theEnv,execStatus,theDefindex->theIndex);
+      DecrementSymbolCount(theEnv,execStatus,theDefindex->slotName);
+      rtn_struct(theEnv,execStatus,defindex,theDefindex);
+     }
+
+   theDeftemplate->indexList = NULL;
+  }
+
+/**************************************************************/
+/* DestroyDefindexes: Releases the indexes of a deftemplate   */
+/*   when the environment is deallocated. Unlike              */
+/*   ReturnDefindexes, the slot name symbols are left alone.  */
+/**************************************************************/
+globle void DestroyDefindexes(
+  void *theEnv,
+  EXEC_STATUS,
+  struct deftemplate *theDeftemplate)
+  {
+   struct defindex *theDefindex, *nextDefindex;
+
+   for (theDefindex = theDeftemplate->indexList;
+        theDefindex != NULL;
+        theDefindex = nextDefindex)
+     {
+      nextDefindex = theDefindex->next;
+      ReturnSlotIndex(theEnv,execStatus,theDefindex->theIndex);
+      rtn_struct(theEnv,execStatus,defindex,theDefindex);
+     }
+
+   theDeftemplate->indexList = NULL;
+  }
+
+/***************************************************************/
+/* DefindexCandidates: Returns the facts selected by a probe   */
+/*   of an index in the order they were asserted, and sets     */
+/*   count to their number. Each fact is made busy so that it  */
+/*   stays valid while a query action retracts facts; it must  */
+/*   still be checked for being garbage before it is used.     */
+/***************************************************************/
+globle struct fact **DefindexCandidates(
+  void *theEnv,
+  EXEC_STATUS,
+  struct defindex *theDefindex,
+  struct slotIndexProbe *theProbe,
+  unsigned long *count)
+  {
+   struct fact **candidates;
+   unsigned long i;
+
+   candidates = (struct fact **)
+                SlotIndexCandidates(theEnv,execStatus,theDefindex->theIndex,theProbe,count);
+
+   for (i = 0; i < *count; i++)
+     { candidates[i]->factHeader.busyCount++; }
+
+   return(candidates);
+  }
+
+/****************************************************/
+/* ReturnDefindexCandidates: Releases the facts     */
+/*   returned by DefindexCandidates.                */
+/****************************************************/
+globle void ReturnDefindexCandidates(
+  void *theEnv,
+  EXEC_STATUS,
+  struct fact **candidates,
+  unsigned long count)
+  {
+   unsigned long i;
+
+   for (i = 0; i < count; i++)
+     { candidates[i]->factHeader.busyCount--; }
+
+   ReturnSlotIndexCandidates(theEnv,execStatus,(void **) candidates,count);
+  }
+
+#if ! RUN_TIME
+
+/***************************************************************/
+/* UndefindexCommand: H/L access routine for the undefindex    */
+/*   command.                                                  */
+/*   Syntax: (undefindex <deftemplate-name> <slot-name>)       */
+/***************************************************************/
+globle void UndefindexCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   DATA_OBJECT templateName, slotName;
+   struct deftemplate *theDeftemplate;
+   int count;
+
+   if (EnvArgTypeCheck(theEnv,execStatus,"undefindex",1,SYMBOL,&templateName) == FALSE) return;
+   if (EnvArgTypeCheck(theEnv,execStatus,"undefindex",2,SYMBOL,&slotName) == FALSE) return;
+
+   theDeftemplate = (struct deftemplate *)
+                    FindImportedConstruct(theEnv,execStatus,"deftemplate",NULL,DOToString(templateName),
+                                          &count,TRUE,NULL);
+   if (theDeftemplate == NULL)
+     {
+      CantFindItemErrorMessage(theEnv,execStatus,"deftemplate",DOToString(templateName));
+      return;
+     }
+
+   if (EnvRemoveDefindex(theEnv,execStatus,theDeftemplate,DOToString(slotName)) == FALSE)
+     {
+      PrintErrorID(theEnv,execStatus,"TMPLTIDX",3,TRUE);
+      EnvPrintRouter(theEnv,execStatus,WERROR,"Slot ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,DOToString(slotName));
+      EnvPrintRouter(theEnv,execStatus,WERROR," of deftemplate ");
+      EnvPrintRouter(theEnv,execStatus,WERROR,DOToString(templateName));
+      EnvPrintRouter(theEnv,execStatus,WERROR," is not indexed.\n");
+     }
+  }
+
+#if DEBUGGING_FUNCTIONS
+
+/*******************************************************/
+/* ListDefindexesCommand: H/L access routine for the   */
+/*   list-defindexes command. Lists the indexes of the */
+/*   deftemplates in the current module along with the */
+/*   number of distinct values and facts they hold.    */
+/*******************************************************/
+globle void ListDefindexesCommand(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct deftemplate *theDeftemplate;
+   struct defindex *theDefindex;
+   long long count = 0;
+
+   for (theDeftemplate = (struct deftemplate *) EnvGetNextDeftemplate(theEnv,execStatus,NULL);
+        theDeftemplate != NULL;
+        theDeftemplate = (struct deftemplate *) EnvGetNextDeftemplate(theEnv,execStatus,theDeftemplate))
+     {
+      for (theDefindex = theDeftemplate->indexList;
+           theDefindex != NULL;
+           theDefindex = theDefindex->next)
+        {
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,EnvGetDeftemplateName(theEnv,execStatus,theDeftemplate));
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY," ");
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,ValueToString(theDefindex->slotName));
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY,
+                        theDefindex->theIndex->ordered ? " ordered (" : " hash (");
+         PrintLongInteger(theEnv,execStatus,WDISPLAY,(long long) theDefindex->theIndex->keyCount);
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY," values, ");
+         PrintLongInteger(theEnv,execStatus,WDISPLAY,(long long) theDefindex->theIndex->entryCount);
+         EnvPrintRouter(theEnv,execStatus,WDISPLAY," facts)\n");
+         count++;
+        }
+     }
+
+   PrintTally(theEnv,execStatus,WDISPLAY,count,"defindex","defindexes");
+  }
+
+#endif /* DEBUGGING_FUNCTIONS */
+
+#endif /* ! RUN_TIME */
+
+/*********************************************************/
+/* IndexTemplateFacts: Enters the facts which were       */
+/*   asserted before an index was added into the index.  */
+/*********************************************************/
+static void IndexTemplateFacts(
+  void *theEnv,
+  EXEC_STATUS,
+  struct deftemplate *theDeftemplate,
+  struct defindex *theDefindex)
+  {
+   struct fact *theFact;
+   struct slotIndexEntry *theEntry;
+   struct field *theField;
+
+   for (theFact = theDeftemplate->factList;
+        theFact != NULL;
+        theFact = theFact->nextTemplateFact)
+     {
+      theField = &theFact->theProposition.theFields[theDefindex->whichField];
+      theEntry = AddSlotIndexEntry(theEnv,execStatus,theDefindex->theIndex,(void *) theFact,
+                                   theFact->factIndex,theField->type,theField->value);
+      theEntry->nextInOwner = theFact->indexEntries;
+      theFact->indexEntries = theEntry;
+     }
+  }
+
+/**********************************************************/
+/* DropDefindex: Removes an index from its deftemplate,   */
+/*   taking the entries of the index off the facts first. */
+/**********************************************************/
+static void DropDefindex(
+  void *theEnv,
+  EXEC_STATUS,
+  struct deftemplate *theDeftemplate,
+  struct defindex *theDefindex)
+  {
+   struct fact *theFact;
+   struct slotIndexEntry *theEntry, *lastEntry;
+   struct defindex *defindexPtr, *lastDefindex = NULL;
+
+   for (theFact = theDeftemplate->factList;
+        theFact != NULL;
+        theFact = theFact->nextTemplateFact)
+     {
+      lastEntry = NULL;
+      for (theEntry = theFact->indexEntries;
+           theEntry != NULL;
+           theEntry = theEntry->nextInOwner)
+        {
+         if (theEntry->theIndex == theDefindex->theIndex) break;
+         lastEntry = theEntry;
+        }
+
+      if (theEntry == NULL) continue;
+
+      if (lastEntry == NULL)
+        { theFact->indexEntries = theEntry->nextInOwner; }
+      else
+        { lastEntry->nextInOwner = theEntry->nextInOwner; }
+
+      RemoveSlotIndexEntry(theEnv,execStatus,theEntry);
+     }
+
+   for (defindexPtr = theDeftemplate->indexList;
+        defindexPtr != theDefindex;
+        defindexPtr = defindexPtr->next)
+     { lastDefindex = defindexPtr; }
+
+   if (lastDefindex == NULL)
+     { theDeftemplate->indexList = theDefindex->next; }
+   else
+     { lastDefindex->next = theDefindex->next; }
+
+   ReturnSlotIndex(theEnv,execStatus,theDefindex->theIndex);
+   DecrementSymbolCount(theEnv,execStatus,theDefindex->slotName);
+   rtn_struct(theEnv,execStatus,defindex,theDefindex);
+  }
+
+#endif /* DEFINDEX_CONSTRUCT */
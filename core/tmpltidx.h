@@ -0,0 +1,77 @@
+   /*******************************************************/
+   /*      "C" Language Integrated Production System      */
+   /*                                                     */
+   /*             CLIPS Version 6.30  10/19/06            */
+   /*                                                     */
+   /*                DEFINDEX HEADER FILE                 */
+   /*******************************************************/
+
+/*************************************************************/
+/* Purpose: Parses and maintains the defindex construct,     */
+/*   which keeps a hash or ordered index of the facts of a   */
+/*   deftemplate on the value of one of its slots.           */
+/*                                                           */
+/* Principal Programmer(s):                                  */
+/*                                                           */
+/* Contributing Programmer(s):                               */
+/*                                                           */
+/* Revision History:                                         */
+/*                                                           */
+/*************************************************************/
+
+#ifndef _H_tmpltidx
+
+#define _H_tmpltidx
+
+struct defindex;
+
+#ifndef _H_symbol
+#include "symbol.h"
+#endif
+#ifndef _H_tmpltdef
+#include "tmpltdef.h"
+#endif
+#ifndef _H_slotindx
+#include "slotindx.h"
+#endif
+
+# include "execution_status.h"
+
+struct defindex
+  {
+   struct symbolHashNode *slotName;
+   unsigned short whichField;
+   struct slotIndex *theIndex;
+   struct defindex *next;
+  };
+
+#ifdef LOCALE
+#undef LOCALE
+#endif
+
+#ifdef _TMPLTIDX_SOURCE_
+#define LOCALE
+#else
+#define LOCALE extern
+#endif
+
+   LOCALE void                           InitializeDefindexes(void *,EXEC_STATUS);
+   LOCALE intBool                        EnvAddDefindex(void *,EXEC_STATUS,void *,char *,int);
+   LOCALE intBool                        EnvRemoveDefindex(void *,EXEC_STATUS,void *,char *);
+   LOCALE struct defindex               *FindDefindex(struct deftemplate *,SYMBOL_HN *);
+   LOCALE void                           AddFactToDefindexes(void *,EXEC_STATUS,struct fact *);
+   LOCALE void                           RemoveFactFromDefindexes(void *,EXEC_STATUS,struct fact *);
+   LOCALE void                           ReturnFactIndexEntries(void *,EXEC_STATUS,struct fact *);
+   LOCALE void                           ReturnDefindexes(void *,EXEC_STATUS,struct deftemplate *);
+   LOCALE void                           DestroyDefindexes(void *,EXEC_STATUS,struct deftemplate *);
+   LOCALE struct fact                  **DefindexCandidates(void *,EXEC_STATUS,struct defindex *,
+                                                            struct slotIndexProbe *,unsigned long *);
+   LOCALE void                           ReturnDefindexCandidates(void *,EXEC_STATUS,struct fact **,unsigned long);
+#if ! RUN_TIME
+   LOCALE void                           UndefindexCommand(void *,EXEC_STATUS);
+#if DEBUGGING_FUNCTIONS
+   LOCALE void                           ListDefindexesCommand(void *,EXEC_STATUS);
+#endif
+#endif
+
+#endif
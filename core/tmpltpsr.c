@@ -52,6 +52,7 @@
 
 #include "tmpltdef.h"
 #include "tmpltbsc.h"
+#include "tmpltutl.h"
 
 #include "tmpltpsr.h"
 
@@ -159,6 +160,8 @@ globle int ParseDeftemplate(
    newDeftemplate->patternNetwork = NULL;
    newDeftemplate->factList = NULL;
    newDeftemplate->lastFact = NULL;
+   newDeftemplate->indexList = NULL;
+   ClearDeftemplateStatistics(newDeftemplate);
    newDeftemplate->header.whichModule = (struct defmoduleItemHeader *)
                                         GetModuleItem(theEnv,execStatus,NULL,DeftemplateData(theEnv,execStatus)->DeftemplateModuleIndex);
 
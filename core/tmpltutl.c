@@ -473,6 +473,20 @@ globle struct templateSlot *FindSlot(
    return(NULL);
   }
 
+/***********************************************************/
+/* ClearDeftemplateStatistics: Resets the assert, retract, */
+/*   and match counters kept for a deftemplate.            */
+/***********************************************************/
+globle void ClearDeftemplateStatistics(
+  struct deftemplate *theDeftemplate)
+  {
+   theDeftemplate->statistics.asserts = 0;
+   theDeftemplate->statistics.retracts = 0;
+   theDeftemplate->statistics.modifies = 0;
+   theDeftemplate->statistics.alphaMatches = 0;
+   theDeftemplate->statistics.matchTime = 0.0;
+  }
+
 #if (! RUN_TIME) && (! BLOAD_ONLY)
 
 /************************************************************/
@@ -498,6 +512,8 @@ globle struct deftemplate *CreateImpliedDeftemplate(
    newDeftemplate->patternNetwork = NULL;
    newDeftemplate->factList = NULL;
    newDeftemplate->lastFact = NULL;
+   newDeftemplate->indexList = NULL;
+   ClearDeftemplateStatistics(newDeftemplate);
    newDeftemplate->busyCount = 0;
    newDeftemplate->watch = FALSE;
    newDeftemplate->header.next = NULL;
@@ -66,6 +66,7 @@
    LOCALE void                           PrintTemplateFact(void *,EXEC_STATUS,char *,struct fact *,int,int);
    LOCALE void                           UpdateDeftemplateScope(void *,EXEC_STATUS);
    LOCALE struct templateSlot           *FindSlot(struct deftemplate *,struct symbolHashNode *,short *);
+   LOCALE void                           ClearDeftemplateStatistics(struct deftemplate *);
    LOCALE struct deftemplate            *CreateImpliedDeftemplate(void *,EXEC_STATUS,SYMBOL_HN *,int);
 
 #endif
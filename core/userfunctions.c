@@ -98,7 +98,7 @@ void EnvUserFunctions(
     
     // STEFAN: try to add a new primitive which enters a event/fact into our
     //         parallel processing system
-    EnvDefineFunction(theEnv,execStatus, "proc-event", 'v', PTIEF ProcessEventCommand,
+    EnvDefineFunction(theEnv,execStatus, "proc-event", 'b', PTIEF ProcessEventCommand,
                       "ProcessEventCommand"); 
 
     AddFunctionParser(theEnv,execStatus,"proc-event",ProcessEventParse);
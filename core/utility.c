@@ -54,11 +54,16 @@
 #define COUNT_INCREMENT 1000L
 #define SIZE_INCREMENT 10240L
 
+#define GC_TIME_BUDGET 1000L
+#define GC_MINIMUM_WORK (2 * COUNT_INCREMENT)
+#define GC_CLOCK_INTERVAL 256L
+
 /***************************************/
 /* LOCAL INTERNAL FUNCTION DEFINITIONS */
 /***************************************/
 
    static void                    DeallocateUtilityData(void *,EXEC_STATUS);
+   static void                    RecordGarbageCollection(void *,EXEC_STATUS,double,intBool);
 
 /************************************************/
 /* InitializeUtilityData: Allocates environment */
@@ -78,6 +83,7 @@ globle void InitializeUtilityData(
    UtilityData(theEnv,execStatus)->CurrentEphemeralCountMax = MAX_EPHEMERAL_COUNT;
    UtilityData(theEnv,execStatus)->CurrentEphemeralSizeMax = MAX_EPHEMERAL_SIZE;
    UtilityData(theEnv,execStatus)->LastEvaluationDepth = -1;
+   UtilityData(theEnv,execStatus)->GarbageCollectionTimeBudget = GC_TIME_BUDGET;
   }
   
 /**************************************************/
@@ -123,7 +129,11 @@ static void DeallocateUtilityData(
 /*   cleanup is normally deferred so that an executing rule  */
 /*   can still access these data structures. Always calls a  */
 /*   series of functions that should be called periodically. */
-/*   Usually used by interfaces to update displays.          */
+/*   Usually used by interfaces to update displays. When     */
+/*   heuristics are used, the garbage is collected in steps  */
+/*   bounded by the garbage collection time budget, and once */
+/*   a cycle of steps has been started, each call continues  */
+/*   it until all of its garbage has been scanned.           */
 /*************************************************************/
 globle void PeriodicCleanup(
   void *theEnv,
@@ -133,21 +143,24 @@ globle void PeriodicCleanup(
   {
    int oldDepth = -1;
    struct callFunctionItem *cleanupPtr,*periodPtr;
+   struct utilityData *theData = UtilityData(theEnv,execStatus);
+   intBool complete;
+   double startTime;
 
    /*===================================*/
    /* Don't use heuristics if disabled. */
    /*===================================*/
    
-   if (! UtilityData(theEnv,execStatus)->GarbageCollectionHeuristicsEnabled) 
+   if (! theData->GarbageCollectionHeuristicsEnabled) 
      { useHeuristics = FALSE; }
      
    /*=============================================*/
    /* Call functions for handling periodic tasks. */
    /*=============================================*/
 
-   if (UtilityData(theEnv,execStatus)->PeriodicFunctionsEnabled)
+   if (theData->PeriodicFunctionsEnabled)
      {
-      for (periodPtr = UtilityData(theEnv,execStatus)->ListOfPeriodicFunctions;
+      for (periodPtr = theData->ListOfPeriodicFunctions;
            periodPtr != NULL;
            periodPtr = periodPtr->next)
         { 
@@ -169,26 +182,43 @@ globle void PeriodicCleanup(
    /* them when we go back to a lower evaluation depth. */
    /*===================================================*/
 
-   if (UtilityData(theEnv,execStatus)->LastEvaluationDepth > execStatus->CurrentEvaluationDepth)
+   if (theData->LastEvaluationDepth > execStatus->CurrentEvaluationDepth)
      {
-      UtilityData(theEnv,execStatus)->LastEvaluationDepth = execStatus->CurrentEvaluationDepth;
-      UtilityData(theEnv,execStatus)->CurrentEphemeralCountMax = MAX_EPHEMERAL_COUNT;
-      UtilityData(theEnv,execStatus)->CurrentEphemeralSizeMax = MAX_EPHEMERAL_SIZE;
+      theData->LastEvaluationDepth = execStatus->CurrentEvaluationDepth;
+      theData->CurrentEphemeralCountMax = MAX_EPHEMERAL_COUNT;
+      theData->CurrentEphemeralSizeMax = MAX_EPHEMERAL_SIZE;
      }
 
    /*======================================================*/
    /* If we're using heuristics to determine if garbage    */
    /* collection to occur, then check to see if enough     */
-   /* garbage has been created to make cleanup worthwhile. */
+   /* garbage has been created to make cleanup worthwhile  */
+   /* (unless a garbage collection cycle is in progress).  */
    /*======================================================*/
 
-   if (UtilityData(theEnv,execStatus)->GarbageCollectionLocks > 0)  return;
+   if (theData->GarbageCollectionLocks > 0)  return;
    
    if (useHeuristics &&
-       (UtilityData(theEnv,execStatus)->EphemeralItemCount < UtilityData(theEnv,execStatus)->CurrentEphemeralCountMax) &&
-       (UtilityData(theEnv,execStatus)->EphemeralItemSize < UtilityData(theEnv,execStatus)->CurrentEphemeralSizeMax))
+       (! theData->GarbageCollectionInProgress) &&
+       (theData->EphemeralItemCount < theData->CurrentEphemeralCountMax) &&
+       (theData->EphemeralItemSize < theData->CurrentEphemeralSizeMax))
      { return; }
 
+   /*===========================================================*/
+   /* A garbage collection using heuristics is bounded: having  */
+   /* scanned a minimum number of items, which ensures that the */
+   /* garbage is collected faster than it is created, it stops  */
+   /* once the time budget runs out. Other garbage collections  */
+   /* complete the cycle in progress and collect all garbage.   */
+   /*===========================================================*/
+
+   startTime = gentime();
+
+   theData->GarbageCollectionBounded = (short) (useHeuristics && (! cleanupAllDepths) &&
+                                                (theData->GarbageCollectionTimeBudget > 0));
+   theData->GarbageCollectionWorkLeft = GC_MINIMUM_WORK;
+   theData->GarbageCollectionDeadline = startTime + (theData->GarbageCollectionTimeBudget / 1000000.0);
+
    /*==========================================================*/
    /* If cleanup is being performed at all depths, rather than */
    /* just the current evaluation depth, then temporarily set  */
@@ -206,13 +236,13 @@ globle void PeriodicCleanup(
    /* Free up multifield values no longer in use. */
    /*=============================================*/
 
-   FlushMultifields(theEnv,execStatus);
+   complete = FlushMultifields(theEnv,execStatus);
 
    /*=====================================*/
    /* Call the list of cleanup functions. */
    /*=====================================*/
 
-   for (cleanupPtr = UtilityData(theEnv,execStatus)->ListOfCleanupFunctions;
+   for (cleanupPtr = theData->ListOfCleanupFunctions;
         cleanupPtr != NULL;
         cleanupPtr = cleanupPtr->next)
      {
@@ -226,7 +256,8 @@ globle void PeriodicCleanup(
    /* Free up atomic values that are no longer used. */
    /*================================================*/
 
-   RemoveEphemeralAtoms(theEnv,execStatus);
+   if (! RemoveEphemeralAtoms(theEnv,execStatus))
+     { complete = FALSE; }
 
    /*=========================================*/
    /* Restore the evaluation depth if cleanup */
@@ -235,17 +266,24 @@ globle void PeriodicCleanup(
 
    if (cleanupAllDepths) execStatus->CurrentEvaluationDepth = oldDepth;
 
+   RecordGarbageCollection(theEnv,execStatus,startTime,complete);
+
+   theData->GarbageCollectionBounded = FALSE;
+   theData->GarbageCollectionInProgress = (short) (! complete);
+
+   if (! complete) return;
+
    /*============================================================*/
    /* If very little memory was freed up, then increment the     */
    /* values used by the heuristics so that we don't continually */
    /* try to free up memory that isn't being released.           */
    /*============================================================*/
 
-   if ((UtilityData(theEnv,execStatus)->EphemeralItemCount + COUNT_INCREMENT) > UtilityData(theEnv,execStatus)->CurrentEphemeralCountMax)
-     { UtilityData(theEnv,execStatus)->CurrentEphemeralCountMax = UtilityData(theEnv,execStatus)->EphemeralItemCount + COUNT_INCREMENT; }
+   if ((theData->EphemeralItemCount + COUNT_INCREMENT) > theData->CurrentEphemeralCountMax)
+     { theData->CurrentEphemeralCountMax = theData->EphemeralItemCount + COUNT_INCREMENT; }
 
-   if ((UtilityData(theEnv,execStatus)->EphemeralItemSize + SIZE_INCREMENT) > UtilityData(theEnv,execStatus)->CurrentEphemeralSizeMax)
-     { UtilityData(theEnv,execStatus)->CurrentEphemeralSizeMax = UtilityData(theEnv,execStatus)->EphemeralItemSize + SIZE_INCREMENT; }
+   if ((theData->EphemeralItemSize + SIZE_INCREMENT) > theData->CurrentEphemeralSizeMax)
+     { theData->CurrentEphemeralSizeMax = theData->EphemeralItemSize + SIZE_INCREMENT; }
 
    /*===============================================================*/
    /* Remember the evaluation depth at which garbage collection was */
@@ -253,7 +291,129 @@ globle void PeriodicCleanup(
    /* ephemeral count and size numbers used by the heuristics.      */
    /*===============================================================*/
 
-   UtilityData(theEnv,execStatus)->LastEvaluationDepth = execStatus->CurrentEvaluationDepth;
+   theData->LastEvaluationDepth = execStatus->CurrentEvaluationDepth;
+  }
+
+/************************************************************/
+/* RecordGarbageCollection: Adds a garbage collection and   */
+/*   the time it took to the garbage collection statistics. */
+/************************************************************/
+static void RecordGarbageCollection(
+  void *theEnv,
+  EXEC_STATUS,
+  double startTime,
+  intBool complete)
+  {
+   struct utilityData *theData = UtilityData(theEnv,execStatus);
+   struct garbageCollectionStatistics *theStatistics = &theData->GarbageCollectionStatistics;
+   double pause, limit = 0.0001;
+   int i;
+
+   pause = gentime() - startTime;
+
+   if (theData->GarbageCollectionBounded)
+     { theStatistics->incrementalSteps++; }
+   else
+     { theStatistics->fullCollections++; }
+
+   if (complete)
+     { theStatistics->completedCycles++; }
+
+   theStatistics->totalPause += pause;
+   theStatistics->lastPause = pause;
+   if (pause > theStatistics->longestPause)
+     { theStatistics->longestPause = pause; }
+
+   for (i = 0; (i < GC_PAUSE_CLASSES - 1) && (pause > limit); i++)
+     { limit *= 10.0; }
+
+   theStatistics->pauses[i]++;
+  }
+
+/*************************************************************/
+/* GarbageCollectionCycleStart: Returns TRUE if the garbage  */
+/*   collection running starts a new cycle, or collects all  */
+/*   garbage, so that the ephemeral items created since the  */
+/*   last cycle are to be scanned.                           */
+/*************************************************************/
+globle intBool GarbageCollectionCycleStart(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return((! UtilityData(theEnv,execStatus)->GarbageCollectionInProgress) ||
+          (! UtilityData(theEnv,execStatus)->GarbageCollectionBounded));
+  }
+
+/*************************************************************/
+/* GarbageCollectionBudgetLeft: Called before the garbage    */
+/*   collection scans an ephemeral item. Returns FALSE if    */
+/*   the garbage collection is bounded and has run out of    */
+/*   time, otherwise counts the item and returns TRUE. The   */
+/*   clock is only read every GC_CLOCK_INTERVAL items.       */
+/*************************************************************/
+globle intBool GarbageCollectionBudgetLeft(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   struct utilityData *theData = UtilityData(theEnv,execStatus);
+
+   if (theData->GarbageCollectionBounded &&
+       (--theData->GarbageCollectionWorkLeft <= 0))
+     {
+      if (gentime() >= theData->GarbageCollectionDeadline)
+        {
+         theData->GarbageCollectionWorkLeft = 0;
+         return(FALSE);
+        }
+
+      theData->GarbageCollectionWorkLeft = GC_CLOCK_INTERVAL;
+     }
+
+   theData->GarbageCollectionStatistics.itemsScanned++;
+
+   return(TRUE);
+  }
+
+/***************************************************************/
+/* EnvGetGarbageCollectionTimeBudget: C access routine for the */
+/*   get-gc-time-budget command. The budget is given in        */
+/*   microseconds, zero meaning that garbage collections are   */
+/*   never bounded.                                            */
+/***************************************************************/
+globle long EnvGetGarbageCollectionTimeBudget(
+  void *theEnv,
+  EXEC_STATUS)
+  {
+   return(UtilityData(theEnv,execStatus)->GarbageCollectionTimeBudget);
+  }
+
+/***************************************************************/
+/* EnvSetGarbageCollectionTimeBudget: C access routine for the */
+/*   set-gc-time-budget command. Returns the old budget.       */
+/***************************************************************/
+globle long EnvSetGarbageCollectionTimeBudget(
+  void *theEnv,
+  EXEC_STATUS,
+  long newBudget)
+  {
+   long oldBudget;
+
+   oldBudget = UtilityData(theEnv,execStatus)->GarbageCollectionTimeBudget;
+   UtilityData(theEnv,execStatus)->GarbageCollectionTimeBudget = newBudget;
+
+   return(oldBudget);
+  }
+
+/***************************************************************/
+/* EnvGetGarbageCollectionStatistics: C access routine for the */
+/*   statistics reported by the gc-stats command.              */
+/***************************************************************/
+globle void EnvGetGarbageCollectionStatistics(
+  void *theEnv,
+  EXEC_STATUS,
+  struct garbageCollectionStatistics *theStatistics)
+  {
+   *theStatistics = UtilityData(theEnv,execStatus)->GarbageCollectionStatistics;
   }
 
 /***************************************************/
@@ -50,6 +50,28 @@ struct trackedMemory
    size_t memSize;
   };
   
+/***************************************************************/
+/* garbageCollectionStatistics: The garbage collections run    */
+/*   since the environment was created and the time they took. */
+/*   A full collection removes all garbage which can be        */
+/*   removed, an incremental step stops when its budget runs   */
+/*   out. The pauses are counted by their length: up to 0.1,   */
+/*   1, 10, and 100 milliseconds, and longer.                  */
+/***************************************************************/
+#define GC_PAUSE_CLASSES 5
+
+struct garbageCollectionStatistics
+  {
+   long long fullCollections;
+   long long incrementalSteps;
+   long long completedCycles;
+   long long itemsScanned;
+   double totalPause;
+   double longestPause;
+   double lastPause;
+   long long pauses[GC_PAUSE_CLASSES];
+  };
+
 #define UTILITY_DATA 55
 
 struct utilityData
@@ -64,6 +86,12 @@ struct utilityData
    long EphemeralItemSize;
    long CurrentEphemeralCountMax;
    long CurrentEphemeralSizeMax;
+   long GarbageCollectionTimeBudget;
+   short GarbageCollectionInProgress;
+   short GarbageCollectionBounded;
+   long GarbageCollectionWorkLeft;
+   double GarbageCollectionDeadline;
+   struct garbageCollectionStatistics GarbageCollectionStatistics;
    void (*YieldTimeFunction)(void);
    int LastEvaluationDepth ;
    struct trackedMemory *trackList;
@@ -111,6 +139,12 @@ struct utilityData
    LOCALE unsigned long                  ItemHashValue(void *,EXEC_STATUS,unsigned short,void *,unsigned long);
    LOCALE void                           YieldTime(void *,EXEC_STATUS);
    LOCALE short                          SetGarbageCollectionHeuristics(void *,EXEC_STATUS,short);
+   LOCALE intBool                        GarbageCollectionCycleStart(void *,EXEC_STATUS);
+   LOCALE intBool                        GarbageCollectionBudgetLeft(void *,EXEC_STATUS);
+   LOCALE long                           EnvGetGarbageCollectionTimeBudget(void *,EXEC_STATUS);
+   LOCALE long                           EnvSetGarbageCollectionTimeBudget(void *,EXEC_STATUS,long);
+   LOCALE void                           EnvGetGarbageCollectionStatistics(void *,EXEC_STATUS,
+                                                                           struct garbageCollectionStatistics *);
    LOCALE void                           EnvIncrementGCLocks(void *,EXEC_STATUS);
    LOCALE void                           EnvDecrementGCLocks(void *,EXEC_STATUS);
    LOCALE short                          EnablePeriodicFunctions(void *,EXEC_STATUS,short);
@@ -0,0 +1,7 @@
+(clear)
+(unwatch all)
+(watch statistics)
+(load "electrnc.clp")
+(load "circuit3.clp")
+(reset)
+(run)
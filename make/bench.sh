@@ -0,0 +1,179 @@
+#!/bin/sh
+#
+# Pattern-match benchmark driver, run by "make bench".
+#
+# Runs the example workloads in batch mode with the sequential assert path
+# (seq: load-facts), the goParallel assert path (event: every fact handed
+# to proc-event, followed by await-events) and the batch assert path
+# (batch: the facts handed to assert-batch in chunks), each with 1..N
+# matcher threads. A CSV line is written to stdout for every run:
+#
+#   workload,mode,threads,wall_s,rules_fired,rules_per_s,peak_mem_used,
+#   alpha_matches,beta_matches,speedup,verified
+#
+# peak_mem_used is the largest value of mem-used sampled after the reset,
+# after the facts have been asserted and after each run. The partial-match
+# counts are summed over the matches-count output of all rules after the
+# last run. speedup is relative to the seq run with one thread, which is
+# also the golden run: every other run must produce the same output,
+# otherwise verified is "no" and the driver exits with a non-zero status.
+# Workloads without a load-facts command are only run with seq.
+#
+# Environment:
+#   CLIPS            the clips executable               (./clips)
+#   EXAMPLES_DIR     directory with the example programs (../examples)
+#   BENCH_THREADS    highest matcher thread count        (online cores)
+#   BENCH_REPEAT     runs per configuration, fastest one is reported (1)
+#   BENCH_MODES      modes to run                        (seq event batch)
+#   BATCH_CHUNK      facts per assert-batch command       (64)
+#   BENCH_WORKLOADS  workloads as <dir>/<batch file> without the .bat
+#
+
+CLIPS=${CLIPS:-./clips}
+EXAMPLES_DIR=${EXAMPLES_DIR:-../examples}
+BENCH_THREADS=${BENCH_THREADS:-$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1)}
+BENCH_REPEAT=${BENCH_REPEAT:-1}
+BENCH_MODES=${BENCH_MODES:-"seq event batch"}
+BATCH_CHUNK=${BATCH_CHUNK:-64}
+BENCH_WORKLOADS=${BENCH_WORKLOADS:-"manners/manners8 manners/manners16 manners/manners32 \
+manners/manners64 manners/manners128 waltz/waltz12 waltz/waltz25 waltz/waltz37 \
+waltz/waltz50 sudoku/runbench circuit/runbench"}
+
+case $CLIPS in
+  /*) ;;
+  *) CLIPS=$(pwd)/$CLIPS ;;
+esac
+
+if [ ! -x "$CLIPS" ]; then
+  echo "bench: $CLIPS is not executable" >&2
+  exit 1
+fi
+
+WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/clipsbench.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIR"' 0 1 2 15
+
+# Thread counts 1, 2, 4, ... up to and including BENCH_THREADS.
+thread_counts() {
+  t=1
+  while [ $t -lt "$BENCH_THREADS" ]; do
+    echo $t
+    t=$((t * 2))
+  done
+  echo "$BENCH_THREADS"
+}
+
+# Writes the batch file for a workload, mode and thread count to stdout.
+# The facts of a load-facts command are asserted through the assert path
+# of the mode, and mem-used is sampled after reset, load-facts and run.
+make_batch() {
+  workload_dir=$1 batch_file=$2 mode=$3 threads=$4
+  echo "(set-matcher-threads $threads)"
+  sed 's/\r$//' "$batch_file" | while read -r line; do
+    case $line in
+      "(load-facts "*)
+        fact_file=$(echo "$line" | sed 's/^(load-facts *"\{0,1\}\([^")]*\)"\{0,1\} *)$/\1/')
+        case $mode in
+          seq)
+            echo "$line" ;;
+          event)
+            sed -n 's/^[ \t]*\((.*)\)[ \t\r]*$/(proc-event \1)/p' "$workload_dir/$fact_file"
+            echo "(await-events)" ;;
+          batch)
+            # Chunks of BATCH_CHUNK facts, one command per line, since
+            # batch rescans a command each time a character is added to it.
+            sed -n 's/^[ \t]*\((.*)\)[ \t\r]*$/\1/p' "$workload_dir/$fact_file" |
+              awk -v n="$BATCH_CHUNK" '
+                { line = line " " $0 }
+                NR % n == 0 { print "(assert-batch" line ")"; line = "" }
+                END { if (line != "") print "(assert-batch" line ")" }' ;;
+        esac
+        echo '(printout t "@mem " (mem-used) crlf)' ;;
+      "(reset)"*|"(run"*)
+        echo "$line"
+        echo '(printout t "@mem " (mem-used) crlf)' ;;
+      *)
+        echo "$line" ;;
+    esac
+  done
+  echo '(progn$ (?r (get-defrule-list)) (matches-count ?r))'
+}
+
+# Output of a run without the values which legitimately differ between runs.
+normalize() {
+  sed -e 's/^\(CLIPS> \)*//' -e '/^@/d' -e '/^$/d' "$1"
+}
+
+failed=0
+
+echo "workload,mode,threads,wall_s,rules_fired,rules_per_s,peak_mem_used,alpha_matches,beta_matches,speedup,verified"
+
+for workload in $BENCH_WORKLOADS; do
+  workload_dir=$EXAMPLES_DIR/$(dirname "$workload")
+  batch_file=$EXAMPLES_DIR/$workload.bat
+  name=$(basename "$workload")
+  [ "$name" = runbench ] && name=$(dirname "$workload")
+
+  if [ ! -f "$batch_file" ]; then
+    echo "bench: $batch_file not found" >&2
+    failed=1
+    continue
+  fi
+
+  golden=$WORK_DIR/$name.golden
+  base_wall=
+
+  # The golden run has to come first.
+  modes="seq"
+  for mode in $BENCH_MODES; do
+    [ "$mode" = seq ] && continue
+    grep -q "^(load-facts " "$batch_file" && modes="$modes $mode"
+  done
+
+  for mode in $modes; do
+    for threads in $(thread_counts); do
+      bat=$WORK_DIR/$name-$mode-$threads.bat
+      out=$WORK_DIR/$name-$mode-$threads.out
+      make_batch "$workload_dir" "$batch_file" $mode $threads > "$bat"
+
+      best=
+      run=0
+      while [ $run -lt "$BENCH_REPEAT" ]; do
+        start=$(date +%s%N)
+        (cd "$workload_dir" && printf '(batch* "%s")\n(exit)\n' "$bat" | "$CLIPS" > "$out" 2>&1)
+        end=$(date +%s%N)
+        elapsed=$((end - start))
+        if [ -z "$best" ] || [ $elapsed -lt $best ]; then best=$elapsed; fi
+        run=$((run + 1))
+      done
+
+      normalize "$out" > "$out.norm"
+      if [ ! -f "$golden" ]; then
+        mv "$out.norm" "$golden"
+        base_wall=$best
+        verified=golden
+      elif cmp -s "$golden" "$out.norm"; then
+        verified=yes
+      else
+        verified=no
+        failed=1
+        echo "bench: $name $mode $threads threads differs from the golden run" >&2
+      fi
+
+      awk -v name="$name" -v mode="$mode" -v threads="$threads" \
+          -v wall="$best" -v base="$base_wall" -v verified="$verified" '
+        { sub(/^(CLIPS> )*/, "") }
+        /rules fired/  { fired += $1 }
+        /^@mem /       { if ($2 > peak) peak = $2 }
+        /^Matches for Pattern [0-9]+: /         { alpha += $NF }
+        /^Partial matches for CEs 1 - [0-9]+: / { beta += $NF }
+        END {
+          secs = wall / 1e9
+          printf "%s,%s,%d,%.3f,%d,%.0f,%d,%d,%d,%.2f,%s\n",
+                 name, mode, threads, secs, fired, (secs > 0) ? fired / secs : 0,
+                 peak, alpha, beta, (wall > 0) ? base / wall : 0, verified
+        }' "$out"
+    done
+  done
+done
+
+exit $failed
@@ -0,0 +1,98 @@
+(clear) ; Errors
+(assert-batch)
+(assert-batch 3)
+(clear) ; Mixed templates compared with a sequence of asserts
+(deftemplate point (slot x) (slot y))
+(deftemplate tag (multislot names))
+(defrule show-point
+   (point (x ?x) (y ?y))
+   =>
+   (printout t "point " ?x " " ?y crlf))
+(defrule show-tag
+   (tag (names $?n))
+   =>
+   (printout t "tag " ?n crlf))
+(defrule show-ordered
+   (data ?v)
+   =>
+   (printout t "data " ?v crlf))
+(watch facts)
+(watch activations)
+(assert (point (x 1) (y 2)))
+(assert (tag (names a b)))
+(assert (data 1))
+(assert (point (x 3) (y 4)))
+(assert (data 2))
+(facts)
+(agenda)
+(run)
+(reset)
+(assert-batch (point (x 1) (y 2))
+              (tag (names a b))
+              (data 1)
+              (point (x 3) (y 4))
+              (data 2))
+(facts)
+(agenda)
+(run)
+(unwatch all)
+(clear) ; Duplicates within a batch
+(deftemplate point (slot x) (slot y))
+(watch facts)
+(assert (point (x 1) (y 1)))
+(assert (data 1))
+(assert (point (x 1) (y 1)))
+(assert (data 1))
+(facts)
+(reset)
+(assert-batch (point (x 1) (y 1)) (data 1) (point (x 1) (y 1)) (data 1))
+(facts)
+(unwatch all)
+(clear) ; Duplicates of existing facts
+(deftemplate point (slot x) (slot y))
+(assert (point (x 1) (y 1)) (data 1))
+(watch facts)
+(assert (point (x 1) (y 1)))
+(assert (data 1))
+(assert (data 2))
+(facts)
+(reset)
+(assert (point (x 1) (y 1)) (data 1))
+(assert-batch (point (x 1) (y 1)) (data 1) (data 2))
+(facts)
+(assert-batch (point (x 1) (y 1)) (data 1))
+(facts)
+(unwatch all)
+(clear) ; Duplicates with fact-duplication enabled
+(set-fact-duplication TRUE)
+(assert-batch (data 1) (data 1) (data 2))
+(facts)
+(set-fact-duplication FALSE)
+(clear) ; Several matcher threads
+(deftemplate point (slot x) (slot y))
+(defrule pair
+   (point (x ?x) (y ?y))
+   (data ?x)
+   =>
+   (printout t "pair " ?x " " ?y crlf))
+(assert (point (x 1) (y 2)))
+(assert (data 1))
+(assert (point (x 3) (y 4)))
+(assert (data 3))
+(assert (point (x 5) (y 6)))
+(assert (data 7))
+(agenda)
+(run)
+(reset)
+(set-matcher-threads 4)
+(assert-batch (point (x 1) (y 2))
+              (data 1)
+              (point (x 3) (y 4))
+              (data 3)
+              (point (x 5) (y 6))
+              (data 7))
+(facts)
+(agenda)
+(run)
+(set-matcher-threads 1)
+(clear)
@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//asrtbtch.out")
+(batch "asrtbtch.bat")
+(dribble-off)
+(clear)
+(open "Results//asrtbtch.rsl" asrtbtch "w")
+(load "compline.clp")
+(printout asrtbtch "asrtbtch.bat differences are as follows:" crlf)
+(compare-files "Expected//asrtbtch.out" "Actual//asrtbtch.out" asrtbtch)
+(close asrtbtch)
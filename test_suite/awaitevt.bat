@@ -0,0 +1,44 @@
+(clear) ; Event queue limit commands
+(get-event-queue-limit)
+(set-event-queue-limit 8)
+(get-event-queue-limit)
+(set-event-queue-limit 4 block)
+(set-event-queue-limit -1)
+(set-event-queue-limit 4 drop)
+(set-event-queue-limit)
+(await-events 1)
+(clear) ; Events queued past the high-water mark
+(defglobal ?*count* = 0 ?*total* = 0)
+(deftemplate event (slot id) (slot kind))
+(defrule count-event
+   (event (id ?i) (kind ?k))
+   =>
+   (bind ?*count* (+ ?*count* 1))
+   (bind ?*total* (+ ?*total* ?i)))
+(defrule pair-event
+   (event (id ?i) (kind a))
+   (event (id ?j&:(= ?j (+ ?i 1))) (kind b))
+   =>
+   (bind ?*count* (+ ?*count* 1)))
+(set-event-queue-limit 8 block)
+(loop-for-count (?i 1 500) do
+   (proc-event (event (id ?i) (kind (if (oddp ?i) then a else b)))))
+(await-events)
+(length$ (find-all-facts ((?e event)) TRUE))
+(run)
+?*count*
+?*total*
+(reset)
+(bind ?*count* 0)
+(bind ?*total* 0)
+(set-event-queue-limit 1)
+(loop-for-count (?i 1 200) do
+   (proc-event (event (id ?i) (kind a))))
+(proc-event (event (id 1) (kind a)))
+(await-events)
+(run)
+?*count*
+?*total*
+(await-events)
+(set-event-queue-limit 10000 block)
+(clear)
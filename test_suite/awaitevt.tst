@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//awaitevt.out")
+(batch "awaitevt.bat")
+(dribble-off)
+(clear)
+(open "Results//awaitevt.rsl" awaitevt "w")
+(load "compline.clp")
+(printout awaitevt "awaitevt.bat differences are as follows:" crlf)
+(compare-files "Expected//awaitevt.out" "Actual//awaitevt.out" awaitevt)
+(close awaitevt)
@@ -0,0 +1,57 @@
+(clear) ; Defaults and valid values
+(get-beta-memory-growth-factor)
+(get-beta-memory-shrinking)
+(set-beta-memory-growth-factor 2)
+(get-beta-memory-growth-factor)
+(set-beta-memory-growth-factor 64)
+(get-beta-memory-growth-factor)
+(set-beta-memory-shrinking FALSE)
+(get-beta-memory-shrinking)
+(set-beta-memory-shrinking yes)
+(get-beta-memory-shrinking)
+(clear) ; Out of range and malformed values
+(set-beta-memory-growth-factor 1)
+(set-beta-memory-growth-factor 0)
+(set-beta-memory-growth-factor -3)
+(set-beta-memory-growth-factor 2.5)
+(set-beta-memory-growth-factor two)
+(set-beta-memory-growth-factor)
+(set-beta-memory-growth-factor 2 3)
+(get-beta-memory-growth-factor 2)
+(get-beta-memory-growth-factor)
+(set-beta-memory-shrinking)
+(set-beta-memory-shrinking TRUE FALSE)
+(get-beta-memory-shrinking TRUE)
+(get-beta-memory-shrinking)
+(clear) ; Memories grown and shrunk with each setting
+(deftemplate item (slot id) (slot group))
+(defrule same-group
+   (logical (item (id ?i) (group ?g))
+            (item (id ?j&:(< ?i ?j)) (group ?g)))
+   =>
+   (assert (pair ?i ?j)))
+(deffunction load-items (?n ?groups)
+   (loop-for-count (?i 1 ?n)
+      (assert (item (id ?i) (group (mod ?i ?groups))))))
+(deffunction pair-count ()
+   (length$ (find-all-facts ((?f pair)) TRUE)))
+(deffunction check (?factor ?shrink)
+   (set-beta-memory-growth-factor ?factor)
+   (set-beta-memory-shrinking ?shrink)
+   (reset)
+   (load-items 600 20)
+   (run)
+   (bind ?full (pair-count))
+   (do-for-all-facts ((?f item)) (<> ?f:group 0) (retract ?f))
+   (bind ?dropped (pair-count))
+   (load-items 100 20)
+   (run)
+   (create$ ?full ?dropped (pair-count)))
+(check 2 TRUE)
+(check 2 FALSE)
+(check 11 TRUE)
+(check 1000 TRUE)
+(check 1000 FALSE)
+(set-beta-memory-growth-factor 11)
+(set-beta-memory-shrinking FALSE)
+(clear)
@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//betagrow.out")
+(batch "betagrow.bat")
+(dribble-off)
+(clear)
+(open "Results//betagrow.rsl" betagrow "w")
+(load "compline.clp")
+(printout betagrow "betagrow.bat differences are as follows:" crlf)
+(compare-files "Expected//betagrow.out" "Actual//betagrow.out" betagrow)
+(close betagrow)
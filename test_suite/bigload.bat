@@ -0,0 +1,69 @@
+(clear) ; Fact files loaded whole and in pieces
+(deftemplate item (slot id) (slot name) (multislot tags) (slot x (type FLOAT)))
+(defglobal ?*whole* = (create$) ?*pieces* = (create$))
+(set-reset-globals FALSE)
+(deffunction write-facts (?file ?from ?to ?bad)
+   (open ?file fct "w")
+   (printout fct "; items and points" crlf)
+   (loop-for-count (?i ?from ?to)
+      (if (= ?i ?bad)
+         then
+         (printout fct "(item (id " ?i ") (bogus 1))" crlf)
+         else
+         (printout fct "(item (id " ?i ") (name n" ?i ") (tags a \"b c\" " ?i ") (x " (/ ?i 4) "))" crlf)
+         (printout fct "(point " ?i " " (- 0 ?i) " " (* ?i 1.5) " \"s\\\"" ?i "\")" crlf)))
+   (close fct))
+(deffunction fingerprint ()
+   (bind ?items 0)
+   (bind ?points 0)
+   (bind ?ids 0)
+   (bind ?xs 0.0)
+   (progn$ (?f (get-fact-list))
+      (if (eq (fact-relation ?f) item)
+         then
+         (bind ?items (+ ?items 1))
+         (bind ?ids (+ ?ids (fact-slot-value ?f id)))
+         (bind ?xs (+ ?xs (fact-slot-value ?f x))))
+      (if (eq (fact-relation ?f) point)
+         then
+         (bind ?points (+ ?points 1))
+         (bind ?v (fact-slot-value ?f implied))
+         (bind ?ids (+ ?ids (nth$ 1 ?v) (nth$ 2 ?v)))
+         (bind ?xs (+ ?xs (nth$ 3 ?v)))))
+   (create$ ?items ?points ?ids ?xs))
+(deffunction item-count ()
+   (length$ (find-all-facts ((?f item)) TRUE)))
+(write-facts "Temp//bigload.fct" 1 1500 0)
+(write-facts "Temp//bigload1.fct" 1 500 0)
+(write-facts "Temp//bigload2.fct" 501 1000 0)
+(write-facts "Temp//bigload3.fct" 1001 1500 0)
+(reset)
+(load-facts "Temp//bigload.fct")
+(bind ?*whole* (fingerprint))
+(ppfact 1999)
+(ppfact 2000)
+(reset)
+(load-facts "Temp//bigload1.fct")
+(load-facts "Temp//bigload2.fct")
+(load-facts "Temp//bigload3.fct")
+(bind ?*pieces* (fingerprint))
+(ppfact 1999)
+(ppfact 2000)
+(eq ?*whole* ?*pieces*)
+(reset) ; An error names its line only in a large fact file
+(write-facts "Temp//bigload.fct" 1 1500 1200)
+(write-facts "Temp//bigload3.fct" 1001 1500 1200)
+(reset)
+(load-facts "Temp//bigload.fct")
+(item-count)
+(reset)
+(load-facts "Temp//bigload1.fct")
+(load-facts "Temp//bigload2.fct")
+(load-facts "Temp//bigload3.fct")
+(item-count)
+(set-reset-globals TRUE)
+(clear)
+(remove "Temp//bigload.fct")
+(remove "Temp//bigload1.fct")
+(remove "Temp//bigload2.fct")
+(remove "Temp//bigload3.fct")
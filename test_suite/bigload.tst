@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//bigload.out")
+(batch "bigload.bat")
+(dribble-off)
+(clear)
+(open "Results//bigload.rsl" bigload "w")
+(load "compline.clp")
+(printout bigload "bigload.bat differences are as follows:" crlf)
+(compare-files "Expected//bigload.out" "Actual//bigload.out" bigload)
+(close bigload)
@@ -0,0 +1,149 @@
+(clear) ; Errors
+(defindex)
+(defindex foo x)
+(deftemplate item (slot id) (slot v) (multislot tags))
+(defindex item)
+(defindex item w)
+(defindex item tags)
+(defindex item v sorted)
+(defindex item v hash extra)
+(assert (data 1))
+(defindex data implied)
+(undefindex)
+(undefindex foo v)
+(undefindex item v)
+(list-defindexes 3)
+(clear) ; Defining, listing, saving and removing defindexes
+(deftemplate item (slot id) (slot v) (multislot tags))
+(deftemplate other (slot key))
+(defindex item v ordered)
+(defindex item id)
+(defindex other key hash)
+(list-defindexes)
+(save "Temp//defindex.clp")
+(undefindex item id)
+(list-defindexes)
+(clear)
+(list-defindexes)
+(load "Temp//defindex.clp")
+(list-defindexes)
+(assert (item (id 1) (v 2)) (item (id 2) (v 2)) (other (key k)))
+(list-defindexes)
+(undefindex item v)
+(undefindex other key)
+(list-defindexes)
+(clear) ; Equality probes
+(defglobal ?*tests* = 0)
+(deffunction tested ()
+   (bind ?*tests* (+ ?*tests* 1))
+   TRUE)
+(deftemplate item (slot id) (slot v))
+(deffacts items
+   (item (id 1) (v 1))
+   (item (id 2) (v a))
+   (item (id 3) (v 1.0))
+   (item (id 4) (v "a"))
+   (item (id 5) (v 1))
+   (item (id 6) (v 2))
+   (item (id 7) (v a)))
+(reset)
+(find-all-facts ((?f item)) (and (tested) (eq ?f:v 1)))
+?*tests*
+(bind ?*tests* 0)
+(find-all-facts ((?f item)) (and (tested) (eq ?f:v a)))
+?*tests*
+(defindex item v)
+(bind ?*tests* 0)
+(find-all-facts ((?f item)) (and (tested) (eq ?f:v 1)))
+?*tests*
+(bind ?*tests* 0)
+(find-all-facts ((?f item)) (and (tested) (eq ?f:v a)))
+?*tests*
+(find-all-facts ((?f item)) (eq ?f:v "a"))
+(find-all-facts ((?f item)) (eq ?f:v missing))
+(bind ?v 2)
+(find-all-facts ((?f item)) (eq ?f:v ?v))
+(find-all-facts ((?f item)) (eq ?v ?f:v))
+(find-fact ((?f item)) (eq ?f:v a))
+(any-factp ((?f item)) (eq ?f:v 2))
+(any-factp ((?f item)) (eq ?f:v 3))
+(do-for-fact ((?f item)) (eq ?f:v 1) (printout t "first " ?f:id crlf))
+(retract 5)
+(assert (item (id 8) (v 1)))
+(find-all-facts ((?f item)) (eq ?f:v 1))
+(clear) ; Range probes
+(defglobal ?*tests* = 0)
+(deffunction tested ()
+   (bind ?*tests* (+ ?*tests* 1))
+   TRUE)
+(deftemplate item (slot id) (slot v))
+(defindex item v ordered)
+(deffacts items
+   (item (id 1) (v 5))
+   (item (id 2) (v 1))
+   (item (id 3) (v 9.5))
+   (item (id 4) (v 3))
+   (item (id 5) (v 7))
+   (item (id 6) (v 3.0))
+   (item (id 7) (v -2)))
+(reset)
+(find-all-facts ((?f item)) (and (tested) (< ?f:v 4)))
+?*tests*
+(find-all-facts ((?f item)) (<= ?f:v 3))
+(find-all-facts ((?f item)) (> ?f:v 5))
+(find-all-facts ((?f item)) (>= ?f:v 5))
+(find-all-facts ((?f item)) (= ?f:v 3))
+(find-all-facts ((?f item)) (and (>= ?f:v 1) (< ?f:v 7)))
+(find-all-facts ((?f item)) (eq ?f:v 3))
+(find-all-facts ((?f item)) (> ?f:v 100))
+(find-all-facts ((?f item)) (or (< ?f:v 0) (> ?f:v 9)))
+(assert (item (id 8) (v four)))
+(find-all-facts ((?f item)) (eq ?f:v four))
+(find-all-facts ((?f item)) (< ?f:v 4))
+(clear) ; Several query templates
+(deftemplate person (slot name) (slot age))
+(deftemplate pet (slot owner) (slot kind))
+(defindex person age ordered)
+(defindex pet owner)
+(deffacts people
+   (person (name ann) (age 30))
+   (person (name bob) (age 12))
+   (person (name cy) (age 45))
+   (pet (owner ann) (kind cat))
+   (pet (owner cy) (kind dog))
+   (pet (owner bob) (kind fish))
+   (pet (owner cy) (kind bird)))
+(reset)
+(do-for-all-facts ((?p person) (?q pet))
+   (and (> ?p:age 18) (eq ?q:owner ?p:name))
+   (printout t ?p:name " " ?q:kind crlf))
+(clear) ; Facts asserted and retracted by the query action
+(deftemplate item (slot id) (slot v))
+(deffacts items
+   (item (id 1) (v 1))
+   (item (id 2) (v 2))
+   (item (id 3) (v 1))
+   (item (id 4) (v 5)))
+(deffunction copy (?f)
+   (printout t "visit " (fact-slot-value ?f id) crlf)
+   (if (< (fact-slot-value ?f id) 10)
+      then
+      (assert (item (id (+ (fact-slot-value ?f id) 10)) (v 1)))))
+(deffunction drop (?f)
+   (printout t "visit " (fact-slot-value ?f id) crlf)
+   (if (= (fact-slot-value ?f id) 1)
+      then
+      (do-for-all-facts ((?g item)) (= ?g:id 3) (retract ?g))))
+(reset)
+(do-for-all-facts ((?f item)) (eq ?f:v 1) (copy ?f))
+(do-for-all-facts ((?f item)) (>= ?f:v 1) (drop ?f))
+(find-all-facts ((?f item)) TRUE)
+(defindex item v ordered)
+(reset)
+(do-for-all-facts ((?f item)) (eq ?f:v 1) (copy ?f))
+(do-for-all-facts ((?f item)) (>= ?f:v 1) (drop ?f))
+(find-all-facts ((?f item)) TRUE)
+(reset)
+(delayed-do-for-all-facts ((?f item)) (eq ?f:v 1) (copy ?f))
+(find-all-facts ((?f item)) TRUE)
+(clear)
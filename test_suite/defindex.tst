@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//defindex.out")
+(batch "defindex.bat")
+(dribble-off)
+(clear)
+(open "Results//defindex.rsl" defindex "w")
+(load "compline.clp")
+(printout defindex "defindex.bat differences are as follows:" crlf)
+(compare-files "Expected//defindex.out" "Actual//defindex.out" defindex)
+(close defindex)
@@ -0,0 +1,97 @@
+(clear) ; Test error conditions for save-facts-binary/load-facts-binary
+(save-facts-binary)
+(save-facts-binary 7)
+(save-facts-binary "Temp//fctbin0.bin" bogus)
+(load-facts-binary)
+(load-facts-binary 7)
+(load-facts-binary "Temp//fctbin0.bin" bogus)
+(load-facts-binary "factbin.tst")
+(clear) ; Round trip ordered and deftemplate facts
+(deftemplate point
+   (slot x (default 0))
+   (slot y)
+   (multislot tags))
+(assert (point (x 1) (y 2) (tags a "b c" 3.5)))
+(assert (point (x -7) (y abc) (tags)))
+(assert (point (y [inst]) (tags 1 2 3 4 5 6 7 8 9 10)))
+(assert (numbers 1 2.5 -3 "four" five))
+(assert (empty))
+(facts)
+(save-facts-binary "Temp//fctbin1.bin")
+(reset)
+(deftemplate point
+   (slot x (default 0))
+   (slot y)
+   (multislot tags))
+(load-facts-binary "Temp//fctbin1.bin")
+(facts)
+(load-facts-binary "Temp//fctbin1.bin")
+(facts)
+(clear) ; Slots missing from the file get their defaults
+(deftemplate point
+   (slot x (default 0))
+   (slot y))
+(assert (point (x 1) (y 2)))
+(assert (point (x 3) (y 4)))
+(save-facts-binary "Temp//fctbin2.bin")
+(clear)
+(deftemplate point
+   (slot x (default 0))
+   (slot y)
+   (slot z (default none))
+   (multislot tags (default q r)))
+(load-facts-binary "Temp//fctbin2.bin")
+(facts)
+(clear) ; Saving selected deftemplates
+(deftemplate a (slot x))
+(deftemplate b (slot x))
+(assert (a (x 1)) (b (x 2)) (c 3))
+(save-facts-binary "Temp//fctbin3.bin" visible b c)
+(clear)
+(deftemplate a (slot x))
+(deftemplate b (slot x))
+(load-facts-binary "Temp//fctbin3.bin")
+(facts)
+(clear) ; Unknown deftemplate
+(deftemplate point (slot x) (slot y))
+(assert (point (x 1) (y 2)))
+(save-facts-binary "Temp//fctbin4.bin")
+(clear)
+(load-facts-binary "Temp//fctbin4.bin")
+(facts)
+(clear) ; Unknown slot
+(deftemplate point (slot x))
+(load-facts-binary "Temp//fctbin4.bin")
+(facts)
+(clear) ; Explicit deftemplate in the file, ordered facts expected
+(assert (point 1 2))
+(load-facts-binary "Temp//fctbin4.bin")
+(facts)
+(clear) ; Ordered facts in the file, explicit deftemplate defined
+(assert (pair 1 2))
+(save-facts-binary "Temp//fctbin5.bin")
+(clear)
+(deftemplate pair (slot x) (slot y))
+(load-facts-binary "Temp//fctbin5.bin")
+(facts)
+(clear) ; Truncated record
+(deffunction file-size (?name)
+   (open ?name in "r")
+   (bind ?n 0)
+   (while (neq (get-char in) -1) do (bind ?n (+ ?n 1)))
+   (close in)
+   ?n)
+(deffunction copy-prefix (?from ?to ?n)
+   (open ?from in "r")
+   (open ?to out "w")
+   (loop-for-count ?n do (put-char out (get-char in)))
+   (close in)
+   (close out))
+(deftemplate point (slot x) (slot y) (multislot tags))
+(assert (point (x 1) (y 2) (tags a b c d e f g h)))
+(save-facts-binary "Temp//fctbin6.bin")
+(copy-prefix "Temp//fctbin6.bin" "Temp//fctbin7.bin" (- (file-size "Temp//fctbin6.bin") 48))
+(reset)
+(load-facts-binary "Temp//fctbin7.bin")
+(facts)
+(clear)
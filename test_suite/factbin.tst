@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//factbin.out")
+(batch "factbin.bat")
+(dribble-off)
+(clear)
+(open "Results//factbin.rsl" factbin "w")
+(load "compline.clp")
+(printout factbin "factbin.bat differences are as follows:" crlf)
+(compare-files "Expected//factbin.out" "Actual//factbin.out" factbin)
+(close factbin)
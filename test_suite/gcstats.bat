@@ -0,0 +1,44 @@
+(clear) ; Time budget of the garbage collector
+(get-gc-time-budget)
+(set-gc-time-budget 500)
+(get-gc-time-budget)
+(set-gc-time-budget 0)
+(get-gc-time-budget)
+(clear) ; Out of range and malformed budgets
+(set-gc-time-budget -1)
+(get-gc-time-budget)
+(set-gc-time-budget 1.5)
+(set-gc-time-budget fast)
+(set-gc-time-budget)
+(set-gc-time-budget 1 2)
+(get-gc-time-budget 1)
+(gc-stats 1)
+(get-gc-time-budget)
+(clear) ; Results are the same with any budget
+(deftemplate item (slot id) (multislot tags))
+(defrule tagged
+   (item (id ?i) (tags $? ?t $?))
+   =>
+   (assert (tag ?t ?i)))
+(deffunction churn (?n)
+   (bind ?total 0)
+   (loop-for-count (?i 1 ?n)
+      (bind ?m (create$ ?i (str-cat "s" ?i) (sym-cat t (mod ?i 7))))
+      (bind ?total (+ ?total (length$ (subseq$ ?m 2 3)))))
+   ?total)
+(deffunction check (?budget)
+   (set-gc-time-budget ?budget)
+   (reset)
+   (loop-for-count (?i 1 200)
+      (assert (item (id ?i) (tags (sym-cat t (mod ?i 3)) (sym-cat u (mod ?i 5))))))
+   (run)
+   (bind ?tags (length$ (find-all-facts ((?f tag)) TRUE)))
+   (do-for-all-facts ((?f item)) (evenp ?f:id) (retract ?f))
+   (implode$ (create$ ?tags (length$ (find-all-facts ((?f item)) TRUE)) (churn 5000))))
+(check 0)
+(check 1)
+(check 100)
+(check 10000)
+(set-gc-time-budget 1000)
+(gc-stats)
+(clear)
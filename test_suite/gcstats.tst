@@ -0,0 +1,14 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//gcstats.out")
+(batch "gcstats.bat")
+(dribble-off)
+(clear)
+(load "timemask.clp")
+(mask-counts "Actual//gcstats.out")
+(clear)
+(open "Results//gcstats.rsl" gcstats "w")
+(load "compline.clp")
+(printout gcstats "gcstats.bat differences are as follows:" crlf)
+(compare-files "Expected//gcstats.out" "Actual//gcstats.out" gcstats)
+(close gcstats)
@@ -0,0 +1,100 @@
+(clear) ; The same queries with and without slot indexes
+(defglobal ?*seen* = (create$))
+(defclass PLAIN (is-a USER) (slot id) (slot v))
+(defclass HASHED (is-a USER) (slot id) (slot v (index hash)))
+(defclass SORTED (is-a USER) (slot id) (slot v (index ordered)))
+(deffunction name-of (?c ?id) (sym-cat ?c - ?id))
+(deffunction populate (?c)
+   (do-for-all-instances ((?x ?c)) TRUE (unmake-instance ?x))
+   (make-instance (name-of ?c 1) of ?c (id 1) (v 1))
+   (make-instance (name-of ?c 2) of ?c (id 2) (v 2))
+   (make-instance (name-of ?c 3) of ?c (id 3) (v 1))
+   (make-instance (name-of ?c 4) of ?c (id 4) (v 3))
+   (make-instance (name-of ?c 5) of ?c (id 5) (v 1))
+   (make-instance (name-of ?c 6) of ?c (id 6) (v 2))
+   (bind ?*seen* (create$)))
+(deffunction seen (?x)
+   (bind ?*seen* (create$ ?*seen* (send ?x get-id))))
+(deffunction final (?c)
+   (bind ?r (create$))
+   (do-for-all-instances ((?x ?c)) TRUE
+      (bind ?r (create$ ?r (create$ ?x:id ?x:v))))
+   ?r)
+(deffunction make-more (?c)
+   (populate ?c)
+   (do-for-all-instances ((?x ?c)) (eq ?x:v 1)
+      (seen ?x)
+      (if (< ?x:id 10)
+         then
+         (make-instance (name-of ?c (+ ?x:id 10)) of ?c (id (+ ?x:id 10)) (v 1))))
+   (create$ ?*seen* / (final ?c)))
+(deffunction put-later (?c)
+   (populate ?c)
+   (do-for-all-instances ((?x ?c)) (eq ?x:v 1)
+      (seen ?x)
+      (if (= ?x:id 1)
+         then
+         (send (instance-address (name-of ?c 2)) put-v 1)
+         (send (instance-address (name-of ?c 5)) put-v 9)
+         (send (instance-address (name-of ?c 6)) put-v 1)))
+   (create$ ?*seen* / (final ?c)))
+(deffunction modify-later (?c)
+   (populate ?c)
+   (do-for-all-instances ((?x ?c)) (eq ?x:v 1)
+      (seen ?x)
+      (if (= ?x:id 3)
+         then
+         (modify-instance (name-of ?c 4) (v 1))
+         (modify-instance (name-of ?c 5) (v 0))
+         (modify-instance ?x (v 7))))
+   (create$ ?*seen* / (final ?c)))
+(deffunction unmake-later (?c)
+   (populate ?c)
+   (do-for-all-instances ((?x ?c)) (eq ?x:v 1)
+      (seen ?x)
+      (if (= ?x:id 1)
+         then
+         (unmake-instance (name-of ?c 3))
+         (make-instance (name-of ?c 3) of ?c (id 33) (v 1))
+         (unmake-instance ?x)))
+   (create$ ?*seen* / (final ?c)))
+(deffunction range-put (?c)
+   (populate ?c)
+   (do-for-all-instances ((?x ?c)) (and (>= ?x:v 1) (< ?x:v 3))
+      (seen ?x)
+      (if (= ?x:id 2)
+         then
+         (send (instance-address (name-of ?c 4)) put-v 2.5)
+         (send (instance-address (name-of ?c 5)) put-v 3)
+         (make-instance (name-of ?c 7) of ?c (id 7) (v 1.5))))
+   (create$ ?*seen* / (final ?c)))
+(deffunction delayed (?c)
+   (populate ?c)
+   (delayed-do-for-all-instances ((?x ?c)) (eq ?x:v 1)
+      (seen ?x)
+      (send (instance-address (name-of ?c 6)) put-v 1)
+      (if (= ?x:id 3) then (modify-instance (name-of ?c 5) (v 8))))
+   (create$ ?*seen* / (final ?c)))
+(deffunction others (?c)
+   (populate ?c)
+   (create$ (length$ (find-all-instances ((?x ?c)) (eq ?x:v 1)))
+            (send (nth$ 1 (find-instance ((?x ?c)) (eq ?x:v 2))) get-id)
+            (any-instancep ((?x ?c)) (eq ?x:v 3))
+            (any-instancep ((?x ?c)) (eq ?x:v 4))
+            (do-for-instance ((?x ?c)) (> ?x:v 1) ?x:id)
+            (length$ (find-all-instances ((?x ?c) (?y ?c)) (and (eq ?x:v ?y:v) (< ?x:id ?y:id))))))
+(deffunction compare (?f)
+   (bind ?plain (funcall ?f PLAIN))
+   (bind ?hashed (funcall ?f HASHED))
+   (bind ?sorted (funcall ?f SORTED))
+   (printout t ?f ": " ?plain crlf)
+   (printout t ?f " hashed same: " (eq ?plain ?hashed) crlf)
+   (printout t ?f " sorted same: " (eq ?plain ?sorted) crlf))
+(compare make-more)
+(compare put-later)
+(compare modify-later)
+(compare unmake-later)
+(compare range-put)
+(compare delayed)
+(compare others)
+(clear)
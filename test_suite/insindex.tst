@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//insindex.out")
+(batch "insindex.bat")
+(dribble-off)
+(clear)
+(open "Results//insindex.rsl" insindex "w")
+(load "compline.clp")
+(printout insindex "insindex.bat differences are as follows:" crlf)
+(compare-files "Expected//insindex.out" "Actual//insindex.out" insindex)
+(close insindex)
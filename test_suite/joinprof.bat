@@ -0,0 +1,45 @@
+(clear) ; Profiling the joins of rules
+(deftemplate item (slot id) (slot kind))
+(deftemplate order (slot item) (slot qty))
+(defrule ordered
+   (item (id ?i) (kind widget))
+   (order (item ?i) (qty ?q&:(> ?q 1)))
+   =>)
+(defrule unordered
+   (item (id ?i))
+   (not (order (item ?i)))
+   =>)
+(defrule points
+   (point ?x)
+   (item (id ?x))
+   =>)
+(profile joins)
+(assert (item (id 1) (kind widget))
+        (item (id 2) (kind widget))
+        (item (id 3) (kind gadget)))
+(assert (order (item 1) (qty 5))
+        (order (item 2) (qty 1))
+        (order (item 3) (qty 7)))
+(run)
+(profile off)
+(profile-info)
+(profile-reset)
+(profile-info)
+(clear) ; Rule names too long for their column
+(deftemplate item (slot id))
+(defrule a-rule-whose-name-is-too-long-for-its-column
+   (point ?x)
+   (test (> ?x 5))
+   (item (id ?x))
+   =>)
+(profile joins)
+(assert (point 1) (point 2))
+(profile off)
+(profile-info)
+(profile-reset)
+(clear) ; Errors
+(profile bogus)
+(profile "joins")
+(profile)
+(profile joins off)
+(profile off)
@@ -0,0 +1,14 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//joinprof.out")
+(batch "joinprof.bat")
+(dribble-off)
+(clear)
+(load "timemask.clp")
+(mask-timings "Actual//joinprof.out" TRUE)
+(clear)
+(open "Results//joinprof.rsl" joinprof "w")
+(load "compline.clp")
+(printout joinprof "joinprof.bat differences are as follows:" crlf)
+(compare-files "Expected//joinprof.out" "Actual//joinprof.out" joinprof)
+(close joinprof)
@@ -0,0 +1,83 @@
+(clear) ; Commands
+(get-lazy-agenda)
+(set-lazy-agenda TRUE)
+(get-lazy-agenda)
+(set-lazy-agenda FALSE)
+(set-lazy-agenda)
+(get-lazy-agenda 1)
+(clear) ; The same program with and without the lazy agenda
+(defglobal ?*fired* = (create$))
+(deftemplate item (slot id) (slot v))
+(deffacts start
+   (item (id 1) (v 3))
+   (item (id 2) (v 1))
+   (item (id 3) (v 2))
+   (flag on))
+(deffunction fired (?what)
+   (bind ?*fired* (create$ ?*fired* ?what)))
+(defrule high
+   (declare (salience 10))
+   (item (id ?i) (v 3))
+   =>
+   (fired (sym-cat high- ?i)))
+(defrule single
+   (item (id ?i))
+   =>
+   (fired (sym-cat single- ?i)))
+(defrule pair
+   (item (id ?i) (v ?v))
+   (item (id ?j&~?i) (v ?w&:(> ?w ?v)))
+   =>
+   (fired (sym-cat pair- ?i - ?j)))
+(defrule flagged
+   (flag on)
+   (item (id ?i) (v 1))
+   (not (item (v 4)))
+   =>
+   (fired (sym-cat flagged- ?i)))
+(defrule computed
+   (declare (salience (+ 1 1)))
+   (item (id ?i) (v 2))
+   =>
+   (fired (sym-cat computed- ?i)))
+(defrule low
+   (declare (salience -5))
+   (flag ?x)
+   =>
+   (fired (sym-cat low- ?x)))
+(defrule add
+   (declare (salience 5))
+   ?f <- (flag on)
+   (item (id 5))
+   =>
+   (retract ?f)
+   (assert (flag off))
+   (assert (item (id 4) (v 4))))
+(deffunction trial (?strategy ?lazy)
+   (set-strategy ?strategy)
+   (set-lazy-agenda ?lazy)
+   (bind ?*fired* (create$))
+   (reset)
+   (seed 42)
+   (assert (item (id 5) (v 2)))
+   (assert (item (id 6) (v 0)))
+   (retract 6)
+   (printout t ?strategy " " ?lazy crlf)
+   (agenda)
+   (run)
+   (printout t ?*fired* crlf)
+   (set-lazy-agenda FALSE)
+   ?*fired*)
+(deffunction compare (?strategy)
+   (bind ?eager (trial ?strategy FALSE))
+   (bind ?lazy (trial ?strategy TRUE))
+   (printout t ?strategy " same: " (eq ?eager ?lazy) crlf))
+(compare depth)
+(compare breadth)
+(compare lex)
+(compare mea)
+(compare complexity)
+(compare simplicity)
+(compare random)
+(set-strategy depth)
+(clear)
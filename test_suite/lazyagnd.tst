@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//lazyagnd.out")
+(batch "lazyagnd.bat")
+(dribble-off)
+(clear)
+(open "Results//lazyagnd.rsl" lazyagnd "w")
+(load "compline.clp")
+(printout lazyagnd "lazyagnd.bat differences are as follows:" crlf)
+(compare-files "Expected//lazyagnd.out" "Actual//lazyagnd.out" lazyagnd)
+(close lazyagnd)
@@ -0,0 +1,30 @@
+(clear) ; Valid matcher thread counts
+(set-matcher-threads 1)
+(get-matcher-threads)
+(set-matcher-threads 2)
+(get-matcher-threads)
+(set-matcher-threads 4)
+(get-matcher-threads)
+(defrule count-them (item ?x) => (assert (seen ?x)))
+(assert (item 1) (item 2) (item 3))
+(run)
+(length$ (find-all-facts ((?f seen)) TRUE))
+(clear) ; Zero uses one thread per online processor
+(set-matcher-threads 0)
+(> (get-matcher-threads) 0)
+(> (set-matcher-threads 1) 0)
+(get-matcher-threads)
+(clear) ; Out of range and malformed counts
+(set-matcher-threads -1)
+(get-matcher-threads)
+(set-matcher-threads 100000000)
+(get-matcher-threads)
+(set-matcher-threads 2.0)
+(set-matcher-threads abc)
+(set-matcher-threads)
+(set-matcher-threads 1 2)
+(get-matcher-threads 1)
+(get-matcher-threads)
+(clear) ; Restore the default
+(set-matcher-threads 1)
+(get-matcher-threads)
@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//matthrds.out")
+(batch "matthrds.bat")
+(dribble-off)
+(clear)
+(open "Results//matthrds.rsl" matthrds "w")
+(load "compline.clp")
+(printout matthrds "matthrds.bat differences are as follows:" crlf)
+(compare-files "Expected//matthrds.out" "Actual//matthrds.out" matthrds)
+(close matthrds)
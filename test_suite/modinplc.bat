@@ -0,0 +1,83 @@
+(clear) ; Changed and unchanged slots with modify-in-place
+(get-modify-in-place)
+(set-modify-in-place TRUE)
+(get-modify-in-place)
+(deftemplate item (slot id) (slot count) (slot note))
+(defrule by-count
+   (item (id ?i) (count ?c&:(> ?c 0)))
+   =>
+   (printout t "by-count " ?i " " ?c crlf))
+(defrule by-id
+   (item (id ?i))
+   =>
+   (printout t "by-id " ?i crlf))
+(watch facts)
+(watch activations)
+(assert (item (id a) (count 1) (note x)))
+(run)
+(modify 1 (count 2))
+(run)
+(modify 1 (note y))
+(run)
+(modify 1 (note y))
+(run)
+(facts)
+(unwatch all)
+(clear) ; Modify in place from the RHS of a rule
+(set-modify-in-place TRUE)
+(deftemplate counter (slot id) (slot value) (slot note))
+(defrule bump
+   ?f <- (counter (id ?i) (value ?v&:(< ?v 3)))
+   =>
+   (modify ?f (value (+ ?v 1))))
+(defrule show
+   (counter (id ?i) (value ?v))
+   =>
+   (printout t "show " ?i " " ?v crlf))
+(watch facts)
+(watch rules)
+(assert (counter (id a) (value 0) (note x)))
+(run)
+(facts)
+(unwatch all)
+(clear) ; New values duplicating another fact
+(set-modify-in-place TRUE)
+(deftemplate item (slot id) (slot count))
+(watch facts)
+(assert (item (id a) (count 1)))
+(assert (item (id b) (count 1)))
+(modify 2 (id a))
+(facts)
+(set-fact-duplication TRUE)
+(assert (item (id b) (count 1)))
+(modify 3 (id a))
+(facts)
+(set-fact-duplication FALSE)
+(unwatch all)
+(clear) ; Facts with logical support or dependents
+(set-modify-in-place TRUE)
+(deftemplate item (slot id) (slot count))
+(defrule supported
+   (logical (trigger))
+   =>
+   (assert (item (id s) (count 1))))
+(defrule dependent
+   (logical (item (id a)))
+   =>
+   (assert (derived a)))
+(watch facts)
+(assert (trigger))
+(assert (item (id a) (count 1)))
+(run)
+(modify 2 (count 2))
+(facts)
+(modify 4 (count 2))
+(facts)
+(run)
+(retract 1)
+(facts)
+(modify 2 (id b))
+(facts)
+(unwatch all)
+(set-modify-in-place FALSE)
+(clear)
@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//modinplc.out")
+(batch "modinplc.bat")
+(dribble-off)
+(clear)
+(open "Results//modinplc.rsl" modinplc "w")
+(load "compline.clp")
+(printout modinplc "modinplc.bat differences are as follows:" crlf)
+(compare-files "Expected//modinplc.out" "Actual//modinplc.out" modinplc)
+(close modinplc)
@@ -0,0 +1,32 @@
+(clear) ; No facts and no rules
+(network-stats)
+(clear) ; Counters of deftemplates and joins
+(deftemplate item (slot id) (slot kind))
+(deftemplate order (slot item) (slot qty))
+(defrule ordered
+   (item (id ?i) (kind widget))
+   (order (item ?i) (qty ?q&:(> ?q 1)))
+   =>)
+(defrule unordered
+   (item (id ?i))
+   (not (order (item ?i)))
+   =>)
+(reset)
+(assert (item (id 1) (kind widget))
+        (item (id 2) (kind widget))
+        (item (id 3) (kind gadget)))
+(assert (order (item 1) (qty 5))
+        (order (item 2) (qty 1))
+        (order (item 3) (qty 7)))
+(network-stats)
+(modify 1 (kind gadget))
+(retract 5)
+(assert (point 1 2))
+(set-modify-in-place TRUE)
+(modify 6 (qty 9))
+(set-modify-in-place FALSE)
+(network-stats)
+(reset) ; Counters are kept across a reset
+(network-stats)
+(network-stats 1)
+(clear)
@@ -0,0 +1,14 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//netstats.out")
+(batch "netstats.bat")
+(dribble-off)
+(clear)
+(load "timemask.clp")
+(mask-timings "Actual//netstats.out" FALSE)
+(clear)
+(open "Results//netstats.rsl" netstats "w")
+(load "compline.clp")
+(printout netstats "netstats.bat differences are as follows:" crlf)
+(compare-files "Expected//netstats.out" "Actual//netstats.out" netstats)
+(close netstats)
@@ -0,0 +1,54 @@
+(clear) ; Range joins with and without ordered memories
+(defglobal ?*values* =
+   (create$ -9007199254740993 -3 -2.5 -1 -0.5 0 0.0 0.5 1 1.0
+            2 2.0000000000000004 3 9007199254740992.0 9007199254740993 9007199254740994))
+(deftemplate pair (slot relation) (slot kind) (slot a) (slot b))
+(defrule lt-indexed ?a <- (a ?x) ?b <- (b ?y&:(< ?x ?y)) => (assert (pair (relation lt) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule lt-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (< ?x ?y) TRUE)) => (assert (pair (relation lt) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule le-indexed ?a <- (a ?x) ?b <- (b ?y&:(<= ?x ?y)) => (assert (pair (relation le) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule le-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (<= ?x ?y) TRUE)) => (assert (pair (relation le) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule gt-indexed ?a <- (a ?x) ?b <- (b ?y&:(> ?x ?y)) => (assert (pair (relation gt) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule gt-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (> ?x ?y) TRUE)) => (assert (pair (relation gt) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule ge-indexed ?a <- (a ?x) ?b <- (b ?y&:(>= ?y ?x)) => (assert (pair (relation ge) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule ge-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (>= ?y ?x) TRUE)) => (assert (pair (relation ge) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule eq-indexed ?a <- (a ?x) ?b <- (b ?y&:(= ?x ?y)) => (assert (pair (relation eq) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule eq-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (= ?x ?y) TRUE)) => (assert (pair (relation eq) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule band-indexed ?a <- (a ?x) ?b <- (b ?y&:(< ?x ?y)&:(<= ?y (+ ?x 1))) => (assert (pair (relation band) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule band-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (< ?x ?y) TRUE)&:(eq (<= ?y (+ ?x 1)) TRUE)) => (assert (pair (relation band) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule offset-indexed ?a <- (a ?x) ?b <- (b ?y&:(>= (- ?y 0.5) (+ ?x 1))) => (assert (pair (relation offset) (kind indexed) (a (fact-index ?a)) (b (fact-index ?b)))))
+(defrule offset-plain ?a <- (a ?x) ?b <- (b ?y&:(eq (>= (- ?y 0.5) (+ ?x 1)) TRUE)) => (assert (pair (relation offset) (kind plain) (a (fact-index ?a)) (b (fact-index ?b)))))
+(deffunction string> (?a ?b)
+   (> (str-compare ?a ?b) 0))
+(deffunction pairs (?relation ?kind)
+   (bind ?result (create$))
+   (do-for-all-facts ((?p pair)) (and (eq ?p:relation ?relation) (eq ?p:kind ?kind))
+      (bind ?result (create$ ?result (str-cat ?p:a " " ?p:b))))
+   (sort string> ?result))
+(deffunction compare-pairs ($?relations)
+   (progn$ (?r ?relations)
+      (bind ?indexed (pairs ?r indexed))
+      (bind ?plain (pairs ?r plain))
+      (printout t ?r " " (length$ ?indexed) " " (eq (implode$ ?indexed) (implode$ ?plain)) crlf)))
+(deffunction assert-a ()
+   (progn$ (?v ?*values*) (assert (a ?v))))
+(deffunction assert-b ()
+   (progn$ (?v ?*values*) (assert (b ?v))))
+(reset) ; LHS values first
+(assert-a)
+(assert-b)
+(run)
+(compare-pairs lt le gt ge eq band offset)
+(reset) ; RHS values first
+(assert-b)
+(assert-a)
+(run)
+(compare-pairs lt le gt ge eq band offset)
+(reset) ; Retracted values leave the ordered memories
+(assert-a)
+(assert-b)
+(do-for-all-facts ((?f a b)) (or (= (nth$ 1 ?f:implied) 1) (< (nth$ 1 ?f:implied) -2)) (retract ?f))
+(do-for-all-facts ((?f pair)) TRUE (retract ?f))
+(assert (a 1.0) (b 1) (a -3) (b -3))
+(run)
+(compare-pairs lt le gt ge eq band offset)
+(clear)
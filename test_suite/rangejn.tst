@@ -0,0 +1,11 @@
+(unwatch all)
+(clear)
+(dribble-on "Actual//rangejn.out")
+(batch "rangejn.bat")
+(dribble-off)
+(clear)
+(open "Results//rangejn.rsl" rangejn "w")
+(load "compline.clp")
+(printout rangejn "rangejn.bat differences are as follows:" crlf)
+(compare-files "Expected//rangejn.out" "Actual//rangejn.out" rangejn)
+(close rangejn)
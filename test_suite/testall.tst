@@ -467,6 +467,76 @@
 (clear)
 (release-mem)
 (printout testall "Memory use: " (mem-used) crlf)
+(batch "factbin.tst")
+(printout testall "Completed factbin.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "modinplc.tst")
+(printout testall "Completed modinplc.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "asrtbtch.tst")
+(printout testall "Completed asrtbtch.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "defindex.tst")
+(printout testall "Completed defindex.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "lazyagnd.tst")
+(printout testall "Completed lazyagnd.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "awaitevt.tst")
+(printout testall "Completed awaitevt.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "insindex.tst")
+(printout testall "Completed insindex.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "matthrds.tst")
+(printout testall "Completed matthrds.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "bigload.tst")
+(printout testall "Completed bigload.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "netstats.tst")
+(printout testall "Completed netstats.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "joinprof.tst")
+(printout testall "Completed joinprof.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "rangejn.tst")
+(printout testall "Completed rangejn.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "betagrow.tst")
+(printout testall "Completed betagrow.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
+(batch "gcstats.tst")
+(printout testall "Completed gcstats.tst test" crlf)
+(clear)
+(release-mem)
+(printout testall "Memory use: " (mem-used) crlf)
 (printout testall "*** FEATURE TESTS COMPLETED ***" crlf)
 (close testall)
 ;(exit)